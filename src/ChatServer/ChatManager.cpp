@@ -122,6 +122,13 @@ ChatManager::~ChatManager()
         mvChannels.erase(index);
         index = mvChannels.begin();
     }
+    SystemMailList::iterator mailIt = mSystemMails.begin();
+    while(mailIt != mSystemMails.end())
+    {
+        delete((*mailIt).second);
+        ++mailIt;
+    }
+
     _destroyDatabindings();
     _unregisterCallbacks();
 
@@ -447,36 +454,11 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
             asContainer->mSender = asyncContainer->mSender;
             asContainer->mReceiverId = receiverId;
 
-            int8 sql[20000],*sqlPointer;
-            int8 footer[64];
-            int8 receiverStr[64];
-            sprintf(receiverStr,"',%"PRIu64",'",receiverId);
-            sprintf(footer,",%u,%"PRIu32")",(asyncContainer->mMail->mAttachments.getLength() << 1),asyncContainer->mMail->mTime);
-            sprintf(sql,"SELECT sf_MailCreate('");
-
-            sqlPointer = sql + strlen(sql);
-
-            //if a system send Mail, the sender may be NULL
-
-
-            sqlPointer += mDatabase->escapeString(sqlPointer,asyncContainer->mMail->getSender().getAnsi(),asyncContainer->mMail->getSender().getLength());
+            int8 sql[20000];
+            sprintf(sql,"SELECT ");
+            _writeMailCreate(sql + strlen(sql),asyncContainer->mMail,receiverId);
 
-            strcat(sql,receiverStr);
-            sqlPointer = sql + strlen(sql);
-            sqlPointer += mDatabase->escapeString(sqlPointer,asyncContainer->mMail->mSubject.getAnsi(),asyncContainer->mMail->mSubject.getLength());
-            *sqlPointer++ = '\'';
-            *sqlPointer++ = ',';
-            *sqlPointer++ = '\'';
-            sqlPointer += mDatabase->escapeString(sqlPointer,asyncContainer->mMail->mText.getAnsi(),asyncContainer->mMail->mText.getLength());
-            *sqlPointer++ = '\'';
-            *sqlPointer++ = ',';
-            *sqlPointer++ = '\'';
-            sqlPointer += mDatabase->escapeString(sqlPointer,asyncContainer->mMail->mAttachments.getRawData(),(asyncContainer->mMail->mAttachments.getLength() << 1));
-            *sqlPointer++ = '\'';
-            *sqlPointer++ = '\0';
-            strcat(sql,footer);
-
-            mDatabase->executeSqlAsync(this,asContainer,sql);
+            mDatabase->executeSqlAsyncNoArguments(this,asContainer,sql);
         }
         else
         {
@@ -499,17 +481,40 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
 
         result->getNextRow(binding,&dbMailId);
 
-        // query ignoreslist
-        ChatAsyncContainer* asContainer = new ChatAsyncContainer(ChatMailQuery_PlayerIgnores);
+        Player* receiver = getPlayerbyId(asyncContainer->mReceiverId);
 
-        asContainer->mMail = asyncContainer->mMail;
-        asContainer->mSender = asyncContainer->mSender;
-        asContainer->mRequestId = dbMailId;
-        asContainer->mMailCounter = asyncContainer->mMailCounter;
-        asContainer->mReceiverId = asyncContainer->mReceiverId;
+        if(receiver)
+        {
+            // online receivers have their ignore list in memory, it may have changed since the mail was sent
+            BString ignoreName = asyncContainer->mMail->getSender();
+            ignoreName.toLower();
+
+            if(asyncContainer->mSender && receiver->checkIgnore(ignoreName.getCrc()))
+            {
+                mDatabase->executeProcedureAsync(NULL, NULL, "CALL sp_DeleteMail(%u);", dbMailId);
+                SAFE_DELETE(asyncContainer->mMail);
+            }
+            else
+            {
+                _deliverMail(receiver,asyncContainer->mMail,dbMailId,asyncContainer->mMailCounter);
+            }
+
+            _confirmMailSent(asyncContainer->mSender,asyncContainer->mMailCounter);
+        }
+        else
+        {
+            // query ignoreslist
+            ChatAsyncContainer* asContainer = new ChatAsyncContainer(ChatMailQuery_PlayerIgnores);
+
+            asContainer->mMail = asyncContainer->mMail;
+            asContainer->mSender = asyncContainer->mSender;
+            asContainer->mRequestId = dbMailId;
+            asContainer->mMailCounter = asyncContainer->mMailCounter;
+            asContainer->mReceiverId = asyncContainer->mReceiverId;
+
+            mDatabase->executeProcedureAsync(this,asContainer,"CALL swganh.sp_ReturnChatIgnoreList(%"PRIu64");", asyncContainer->mReceiverId);
+        }
 
-        mDatabase->executeProcedureAsync(this,asContainer,"CALL swganh.sp_ReturnChatIgnoreList(%"PRIu64");", asyncContainer->mReceiverId);
-        
         mDatabase->destroyDataBinding(binding);
     }
     break;
@@ -517,7 +522,6 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
 
     case ChatMailQuery_PlayerIgnores:
     {
-        Message* newMessage;
         BString	name;
         DataBinding* binding = mDatabase->createDataBinding(1);
         binding->addField(DFT_bstring,0,64);
@@ -559,27 +563,50 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
         if ((receiver != NULL) && (!bIgnore))
         {
             // send out new mail notification, if not receiving mail from Ignored player.
-            asyncContainer->mMail->mSubject.convert(BSTRType_Unicode16);
             // Note: asyncContainer->mRequestId is the mailId...
-            gChatMessageLib->sendChatPersistantMessagetoClient(receiver->getClient(),asyncContainer->mMail, asyncContainer->mRequestId,asyncContainer->mMailCounter,MailStatus_New);
+            _deliverMail(receiver,asyncContainer->mMail,asyncContainer->mRequestId,asyncContainer->mMailCounter);
+            asyncContainer->mMail = NULL;
         }
 
         //when we send a system Mail there will be no sender
-        if (asyncContainer->mSender != NULL)
-        {
-            //NEVER END A MESSAGE AND THEN DONT SEND IT !!!!!!!!!!!!!!!!!!!!!!!!!!!
-            // send status to sender
-            gMessageFactory->StartMessage();
-            gMessageFactory->addUint32(opChatOnSendPersistentMessage);
-            gMessageFactory->addUint32(0);
-            gMessageFactory->addUint32(asyncContainer->mMailCounter);
-            newMessage = gMessageFactory->EndMessage();
+        _confirmMailSent(asyncContainer->mSender,asyncContainer->mMailCounter);
 
+        SAFE_DELETE(asyncContainer->mMail);
 
-            ((asyncContainer->mSender)->getClient())->SendChannelA(newMessage,((asyncContainer->mSender)->getClient())->getAccountId(),CR_Client,3);
+        mDatabase->destroyDataBinding(binding);
+    }
+    break;
+
+    case ChatQuery_SystemMails:
+    {
+        // one row, one new mail id per column
+        SystemMailList&		mails = asyncContainer->mSystemMails;
+        std::vector<uint32>	mailIds(mails.size(),0);
+        DataBinding*		binding = mDatabase->createDataBinding(static_cast<uint16>(mails.size()));
+
+        for(uint32 i = 0; i < mails.size(); i++)
+        {
+            binding->addField(DFT_uint32,i * sizeof(uint32),4,i);
         }
 
-        SAFE_DELETE(asyncContainer->mMail);
+        if(result->getRowCount())
+        {
+            result->getNextRow(binding,&mailIds[0]);
+        }
+
+        for(uint32 i = 0; i < mails.size(); i++)
+        {
+            Player* receiver = getPlayerbyId(mails[i].first);
+
+            if(receiver && mailIds[i])
+            {
+                _deliverMail(receiver,mails[i].second,mailIds[i],1);
+            }
+            else
+            {
+                delete(mails[i].second);
+            }
+        }
 
         mDatabase->destroyDataBinding(binding);
     }
@@ -607,9 +634,20 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
 
         gChatMessageLib->sendChatPersistantMessagetoClient(asyncContainer->mClient,&mail);
 
-        //mDatabase->ExecuteSqlAsync(NULL,NULL,"UPDATE chat_mail SET status = 1 WHERE id=%u", mail.mId);
-        mDatabase->executeProcedureAsync(NULL, NULL, "CALL sp_MailStatusUpdate(%u)", mail.mId);
-        
+        Player*		player = getPlayerbyId(asyncContainer->mReceiverId);
+        MailHeader*	header = player ? player->getMailbox()->getHeader(mail.mId) : NULL;
+
+        // the status only has to be written the first time a mail is opened
+        if(!header || header->mStatus == MailStatus_New)
+        {
+            mDatabase->executeProcedureAsync(NULL, NULL, "CALL sp_MailStatusUpdate(%u)", mail.mId);
+        }
+
+        if(header)
+        {
+            header->mStatus = MailStatus_Read;
+            player->getMailbox()->cacheBody(mail.mId,new Mail(mail));
+        }
 
     }
     break;
@@ -618,6 +656,7 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
     {
         Mail		mail;
         uint64		count = result->getRowCount();
+        Player*		receiver = getPlayerbyId(asyncContainer->mReceiverId);
 
         // Update client with all mail.
         for(uint64 i = 0; i < count; i++)
@@ -627,11 +666,19 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
 
             if(!mail.mStatus)
             {
-                gChatMessageLib->sendChatPersistantMessagetoClient(asyncContainer->mClient,&mail, mail.mId,1,MailStatus_New);
+                mail.mStatus = MailStatus_New;
             }
             else
             {
-                gChatMessageLib->sendChatPersistantMessagetoClient(asyncContainer->mClient,&mail, mail.mId,1,MailStatus_Read);
+                mail.mStatus = MailStatus_Read;
+            }
+
+            gChatMessageLib->sendChatPersistantMessagetoClient(asyncContainer->mClient,&mail, mail.mId,1,mail.mStatus);
+
+            // bodies are fetched when the mail is opened
+            if(receiver)
+            {
+                receiver->getMailbox()->addHeader(&mail);
             }
         }
     }
@@ -689,7 +736,7 @@ void ChatManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
         {
             result->getNextRow(binding,&name);
             name.toLower();
-            player->getIgnoreList()->insert(std::make_pair(name.getCrc(),name.getAnsi()));
+            player->addIgnore(name);
         }
 
         mDatabase->destroyDataBinding(binding);
@@ -1053,6 +1100,7 @@ void ChatManager::_processWhenLoaded(Message* message,DispatchClient* client)
                 ChatAsyncContainer* asContainer = new ChatAsyncContainer(ChatQuery_MailHeaders);
                 asContainer->mClient = client;
                 asContainer->mReceiver = (*accIt).second;
+                asContainer->mReceiverId = asContainer->mReceiver->getCharId();
 
                 // Update friends list
                 updateFriendsOnline(asContainer->mReceiver,true);
@@ -2266,23 +2314,129 @@ void ChatManager::_processAvatarId(Message* message,DispatchClient* client)
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 void ChatManager::sendSystemMailMessage(Mail* mail,uint64 recipient)
 {
-    int8 sql[100];
-    sprintf(sql, "SELECT firstname FROM characters WHERE id LIKE %"PRIu64"", recipient);
+    // auctions ending and structures decaying come in bursts, they are written together on the next tick
+    mSystemMails.push_back(std::make_pair(recipient,mail));
+}
 
-    mDatabase->executeAsyncSql(sql, [this, mail, recipient] (DatabaseResult* result) {       
-        std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
-        
-        if (!result_set->next()) {
-            LOG(WARNING) << "Unable to find the firstname for character with the id [" << recipient << "]";
-            return;
+//======================================================================================================================
+
+void ChatManager::Process()
+{
+    if(!mSystemMails.empty())
+    {
+        _flushSystemMails();
+    }
+}
+
+//======================================================================================================================
+//
+// writes the queued system mails, as many as fit into one SELECT sf_MailCreate(..),sf_MailCreate(..) statement
+//
+
+void ChatManager::_flushSystemMails()
+{
+    SystemMailList::iterator it = mSystemMails.begin();
+
+    while(it != mSystemMails.end())
+    {
+        ChatAsyncContainer* asyncContainer = new ChatAsyncContainer(ChatQuery_SystemMails);
+
+        int8	sql[20000],*sqlPointer;
+        sprintf(sql,"SELECT ");
+        sqlPointer = sql + strlen(sql);
+
+        while(it != mSystemMails.end() && asyncContainer->mSystemMails.size() < 64)
+        {
+            Mail* mail = (*it).second;
+
+            // worst case, every character escaped
+            uint32 size = ((mail->mSender.getLength() + mail->mSubject.getLength() + mail->mText.getLength()) << 1)
+                          + (mail->mAttachments.getLength() << 2) + 128;
+
+            if(!asyncContainer->mSystemMails.empty())
+            {
+                if(static_cast<uint32>(sqlPointer - sql) + size >= sizeof(sql))
+                {
+                    break;
+                }
+
+                *sqlPointer++ = ',';
+            }
+
+            sqlPointer += _writeMailCreate(sqlPointer,mail,(*it).first);
+
+            asyncContainer->mSystemMails.push_back(*it);
+            ++it;
         }
 
-        std::string name = result_set->getString(1);
+        mDatabase->executeSqlAsyncNoArguments(this,asyncContainer,sql);
+    }
 
-        _PersistentMessagebySystem(mail, 0, name.c_str());
-    });
+    mSystemMails.clear();
 }
 
+//======================================================================================================================
+//
+// appends sf_MailCreate(sender,receiver,subject,text,attachments,attachment size,time) for an ansi mail
+//
+
+uint32 ChatManager::_writeMailCreate(int8* sql,Mail* mail,uint64 receiverId)
+{
+    int8* sqlPointer = sql;
+
+    sqlPointer += sprintf(sqlPointer,"sf_MailCreate('");
+    sqlPointer += mDatabase->escapeString(sqlPointer,mail->mSender.getAnsi(),mail->mSender.getLength());
+    sqlPointer += sprintf(sqlPointer,"',%"PRIu64",'",receiverId);
+    sqlPointer += mDatabase->escapeString(sqlPointer,mail->mSubject.getAnsi(),mail->mSubject.getLength());
+    sqlPointer += sprintf(sqlPointer,"','");
+    sqlPointer += mDatabase->escapeString(sqlPointer,mail->mText.getAnsi(),mail->mText.getLength());
+    sqlPointer += sprintf(sqlPointer,"','");
+    sqlPointer += mDatabase->escapeString(sqlPointer,mail->mAttachments.getRawData(),(mail->mAttachments.getLength() << 1));
+    sqlPointer += sprintf(sqlPointer,"',%u,%"PRIu32")",(mail->mAttachments.getLength() << 1),mail->mTime);
+
+    return(static_cast<uint32>(sqlPointer - sql));
+}
+
+//======================================================================================================================
+//
+// new mail stored, notify the online receiver and keep it in their mailbox, takes ownership of the mail
+//
+
+void ChatManager::_deliverMail(Player* receiver,Mail* mail,uint32 mailId,uint32 mailCounter)
+{
+    mail->mId		= mailId;
+    mail->mStatus	= MailStatus_New;
+    mail->mSubject.convert(BSTRType_Unicode16);
+    mail->mText.convert(BSTRType_Unicode16);
+
+    gChatMessageLib->sendChatPersistantMessagetoClient(receiver->getClient(),mail,mailId,mailCounter,MailStatus_New);
+
+    // most mails are opened soon after they arrive, so the body stays cached
+    Mailbox* mailbox = receiver->getMailbox();
+    mailbox->addHeader(mail);
+    mailbox->cacheBody(mailId,mail);
+}
+
+//======================================================================================================================
+
+void ChatManager::_confirmMailSent(Player* sender,uint32 mailCounter)
+{
+    //when we send a system Mail there will be no sender
+    if(!sender)
+    {
+        return;
+    }
+
+    //NEVER END A MESSAGE AND THEN DONT SEND IT !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    // send status to sender
+    gMessageFactory->StartMessage();
+    gMessageFactory->addUint32(opChatOnSendPersistentMessage);
+    gMessageFactory->addUint32(0);
+    gMessageFactory->addUint32(mailCounter);
+    Message* newMessage = gMessageFactory->EndMessage();
+
+    (sender->getClient())->SendChannelA(newMessage,(sender->getClient())->getAccountId(),CR_Client,3);
+}
 
 //======================================================================================================================
 //
@@ -2314,101 +2468,15 @@ void ChatManager::_processSystemMailMessage(Message* message,DispatchClient* cli
     mail->setSender(Sender);
     mail->setSubject(msgSubject);
     mail->setText(msgText);
+    mail->mText.convert(BSTRType_ANSI);
     mail->setStatus(MailStatus_New);
     mail->setTime(static_cast<uint32>(time(NULL)));
     mail->setAttachments(attachmentData);
 
-
-    //ok we will enter now a db call in order to get the recipients name
-
-    ChatAsyncContainer* asyncContainer = new ChatAsyncContainer(ChatQuery_QueryFirstName);
-    asyncContainer->mMail = mail;
-    asyncContainer->mMailCounter = 1;
-    asyncContainer->mReceiverId = ReceiverID;
-    asyncContainer->mClient = client;
-
-    int8 sql[100];
-    sprintf(sql, "SELECT firstname FROM characters WHERE id LIKE %"PRIu64"", ReceiverID);
-
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
-
-
-}
-void ChatManager::_PersistentMessagebySystem(Mail* mail,DispatchClient* client, BString receiverStr)
-{
-    Player* sender		= NULL;
-    Player* receiver	= NULL;
-    uint32 mailId		= 1;       // mail count of sender, sent in this session
-
-    // get our receiver
-
-    receiver = getPlayerByName(receiverStr);
-
-    // Doing a change here, if not pleased with that, please fix the mail related addIgnore implementation.
-    // Reason for change:
-    // We must have the AddIgnore list and we can't be sure that a client that is online when we do out first test
-    // also is online when we do the next async sql, so better treat ALL mail receivers as OFFLINE, then we get a persistent behaviour.
-
-    // Update: If receiver IS online we could take the charId and skip one database access.
-    // That have to be a TODO for optimizations when mail is stable.
-
-    // Update: Let's go for that optimization. It's also more in line with the original implementation.
-
-    if (receiver != NULL)
-    {
-
-        ChatAsyncContainer* asyncContainer = new ChatAsyncContainer(ChatQuery_CreateMail);
-        asyncContainer->mMail = mail;
-        asyncContainer->mSender = sender;
-        asyncContainer->mMailCounter = mailId;
-        asyncContainer->mReceiverId = receiver->getCharId();
-
-        int8 sql[20000],*sqlPointer;
-        int8 footer[64];
-        int8 receiverStr[64];
-        sprintf(receiverStr,"',%"PRIu64",'",receiver->getCharId());
-        sprintf(footer,",%u,%"PRIu32")",(mail->mAttachments.getLength() << 1),mail->mTime);
-        sprintf(sql,"SELECT sf_MailCreate('");
-        sqlPointer = sql + strlen(sql);
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->getSender().getAnsi(),mail->getSender().getLength());
-        strcat(sql,receiverStr);
-        sqlPointer = sql + strlen(sql);
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->mSubject.getAnsi(),mail->mSubject.getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = ',';
-        *sqlPointer++ = '\'';
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->mText.getAnsi(),mail->mText.getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = ',';
-        *sqlPointer++ = '\'';
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->mAttachments.getRawData(),(mail->mAttachments.getLength() << 1));
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = '\0';
-        strcat(sql,footer);
-
-        mDatabase->executeSqlAsyncNoArguments(this, asyncContainer, sql);
-
-    }
-    else
-    {
-
-        ChatAsyncContainer* asyncContainer = new ChatAsyncContainer(ChatQuery_CheckCharacter);
-        asyncContainer->mMail = mail;
-        asyncContainer->mSender = sender;
-        asyncContainer->mMailCounter = mailId;
-
-        int8 sql[256],*sqlPointer;
-        sprintf(sql,"SELECT id FROM characters WHERE LOWER(firstname) LIKE '");
-        sqlPointer = sql + strlen(sql);
-        sqlPointer += mDatabase->escapeString(sqlPointer, receiverStr.getAnsi(), receiverStr.getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = '\0';
-
-        mDatabase->executeSqlAsyncNoArguments(this, asyncContainer, sql);
-    }
+    sendSystemMailMessage(mail,ReceiverID);
 }
 
-
+//======================================================================================================================
 
 void ChatManager::_processPersistentMessageToServer(Message* message,DispatchClient* client)
 {
@@ -2464,39 +2532,31 @@ void ChatManager::_processPersistentMessageToServer(Message* message,DispatchCli
     mail->mTime = static_cast<uint32>(time(NULL));
     mail->setAttachments(attachmentData);
 
-    // See comment at _PersistentMessagebySystem for this part of the code.
+    // If receiver is online we can take the charId and skip one database access.
     if (receiver != NULL)
     {
+        // and check the ignore list we already have, an ignored mail is not stored at all
+        BString ignoreName = sender->getName();
+        ignoreName.toLower();
+
+        if(receiver->checkIgnore(ignoreName.getCrc()))
+        {
+            _confirmMailSent(sender,mailId);
+            delete(mail);
+            return;
+        }
+
         ChatAsyncContainer* asyncContainer = new ChatAsyncContainer(ChatQuery_CreateMail);
         asyncContainer->mMail = mail;
         asyncContainer->mSender = sender;
         asyncContainer->mMailCounter = mailId;
         asyncContainer->mReceiverId = receiver->getCharId();
 
-        int8 sql[20000],*sqlPointer;
-        int8 footer[64];
-        int8 receiverStr[64];
-        sprintf(receiverStr,"',%"PRIu64",'",receiver->getCharId());
-        sprintf(footer,",%u,%"PRIu32")",(mail->mAttachments.getLength() << 1),mail->mTime);
-        sprintf(sql,"SELECT sf_MailCreate('%s",sender->getName().getAnsi());
-        sqlPointer = sql + strlen(sql);
-        sqlPointer += mDatabase->escapeString(sqlPointer,sender->getName().getAnsi(),sender->getName().getLength());
-        strcat(sql,receiverStr);
-        sqlPointer = sql + strlen(sql);
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->mSubject.getAnsi(),mail->mSubject.getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = ',';
-        *sqlPointer++ = '\'';
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->mText.getAnsi(),mail->mText.getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = ',';
-        *sqlPointer++ = '\'';
-        sqlPointer += mDatabase->escapeString(sqlPointer,mail->mAttachments.getRawData(),(mail->mAttachments.getLength() << 1));
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = '\0';
-        strcat(sql,footer);
+        int8 sql[20000];
+        sprintf(sql,"SELECT ");
+        _writeMailCreate(sql + strlen(sql),mail,receiver->getCharId());
 
-        mDatabase->executeSqlAsync(this,asyncContainer,sql);
+        mDatabase->executeSqlAsyncNoArguments(this,asyncContainer,sql);
     }
     else
     {
@@ -2518,7 +2578,7 @@ void ChatManager::_processPersistentMessageToServer(Message* message,DispatchCli
 
 //======================================================================================================================
 //
-// mail request, retrieves and returns requested mail contents from db
+// mail request, returns requested mail contents from the mailbox or the db
 //
 
 void ChatManager::_processRequestPersistentMessage(Message* message,DispatchClient* client)
@@ -2530,9 +2590,32 @@ void ChatManager::_processRequestPersistentMessage(Message* message,DispatchClie
     dbMailId = message->getUint32();
     message->getUint8();             // unknown, attachments ?
 
+    Player* player = getPlayerByAccId(client->getAccountId());
+
+    if(player)
+    {
+        Mailbox*	mailbox = player->getMailbox();
+        Mail*		mail = mailbox->getBody(dbMailId);
+
+        if(mail)
+        {
+            gChatMessageLib->sendChatPersistantMessagetoClient(client,mail);
+
+            MailHeader* header = mailbox->getHeader(dbMailId);
+
+            if(header->mStatus == MailStatus_New)
+            {
+                header->mStatus = MailStatus_Read;
+                mDatabase->executeProcedureAsync(NULL, NULL, "CALL sp_MailStatusUpdate(%u)", dbMailId);
+            }
+            return;
+        }
+    }
+
     ChatAsyncContainer* asyncContainer = new ChatAsyncContainer(ChatQuery_MailById);
     asyncContainer->mClient = client;
     asyncContainer->mRequestId = dbMailId;
+    asyncContainer->mReceiverId = player ? player->getCharId() : 0;
 
     int8 sql[256];
     sprintf(sql,"CALL sp_ReturnChatMailById(%"PRIu32");",dbMailId);
@@ -2552,6 +2635,11 @@ void ChatManager::_processDeletePersistentMessage(Message* message,DispatchClien
 
     message->getUint8();             // unknown, attachments ?
 
+    if(Player* player = getPlayerByAccId(client->getAccountId()))
+    {
+        player->getMailbox()->removeMail(dbMailId);
+    }
+
     mDatabase->executeProcedureAsync(NULL, NULL, "CALL sp_DeleteMail(%u);", dbMailId);
 
     // acknowledge
@@ -57,6 +57,9 @@ typedef std::map<uint32,Channel*>	ChannelMap;
 typedef std::map<uint32,Channel*>	ChannelNameMap;
 typedef std::vector<Channel*>			ChannelList;
 
+// system mails waiting for the next batched insert, recipient id and mail
+typedef std::vector<std::pair<uint64,Mail*> >	SystemMailList;
+
 #define	gChatManager	ChatManager::getSingletonPtr()
 
 //======================================================================================================================
@@ -73,7 +76,7 @@ enum ChatQuery
     ChatQuery_PlayerChannels	= 7,
     ChatQuery_PlayerFriends		= 8,
     ChatQuery_PlayerIgnores		= 9,
-    ChatQuery_QueryFirstName	= 10,
+    ChatQuery_SystemMails		= 10,
     ChatQuery_PlanetNames		= 11,
     ChatQuery_FindFriend		= 12,
     ChatQuery_AddChannel		= 13,
@@ -109,6 +112,7 @@ public:
     uint32			mRequestId;
     uint32			mMailCounter;
     BString			mName;
+    SystemMailList	mSystemMails;
 };
 
 //======================================================================================================================
@@ -155,8 +159,11 @@ public:
     void				updateFriendsOnline(Player* player,bool action);
 
     //send a system EMail without the need of a logged in player
+    //queued and written with the other system mails of this tick, takes ownership of the mail
     void				sendSystemMailMessage(Mail* mail,uint64 recipient);
 
+    void				Process();
+
 
     PlayerAccountMap	getPlayerAccountMap() {
         return mPlayerAccountMap;
@@ -201,8 +208,11 @@ private:
     void			_processPersistentMessageToServer(Message* message,DispatchClient* client);
     void			_processRequestPersistentMessage(Message* message,DispatchClient* client);
     void			_processDeletePersistentMessage(Message* message,DispatchClient* client);
-    void			_PersistentMessagebySystem(Mail* mail,DispatchClient* client, BString sender);
     void			_processSystemMailMessage(Message* message,DispatchClient* client);
+    uint32			_writeMailCreate(int8* sql,Mail* mail,uint64 receiverId);
+    void			_deliverMail(Player* receiver,Mail* mail,uint32 mailId,uint32 mailCounter);
+    void			_confirmMailSent(Player* sender,uint32 mailCounter);
+    void			_flushSystemMails();
 
     // friendlist
     void			_processFriendlistUpdate(Message* message,DispatchClient* client);
@@ -249,6 +259,8 @@ private:
     PlayerIdMap				mPlayerIdMap;
     PlayerList				mPlayerList;
 
+    SystemMailList			mSystemMails;
+
     DataBinding*			mPlayerBinding;
     DataBinding*			mChannelBinding;
     DataBinding*			mMailBinding;
@@ -145,7 +145,7 @@ public:
     void sendChatOnDestroyRoom(DispatchClient* client, Channel* channel, uint32 requestId) const;
     void sendChatQueryRoomResults(DispatchClient* client, Channel* channel, uint32 requestId) const;
     void sendChatOnLeaveRoom(DispatchClient* client, ChatAvatarId* avatar, Channel* channel, uint32 requestId, uint32 errorCode=0) const;
-    void sendChatRoomMessage(Channel* channel, BString galaxy, BString sender, BString message) const;
+    void sendChatRoomMessage(Channel* channel, const BString& galaxy, BString sender, const BString& message) const;
     void sendChatOnSendRoomMessage(DispatchClient* client, uint32 errorcode, uint32 requestId) const;
     void sendChatOnRemoveModeratorFromRoom(DispatchClient* client, BString galaxy, BString sender, BString target, Channel* channel, uint32 requestId) const;
     void sendChatOnAddModeratorToRoom(DispatchClient* client, BString galaxy, BString sender, BString target, Channel* channel, uint32 requestId) const;
@@ -1302,10 +1302,8 @@ void ChatMessageLib::sendChatFailedToAddMod(DispatchClient* client, BString gala
 
 //======================================================================================================================
 
-void ChatMessageLib::sendChatRoomMessage(Channel* channel, BString galaxy, BString sender, BString message) const
+void ChatMessageLib::sendChatRoomMessage(Channel* channel, const BString& galaxy, BString sender, const BString& message) const
 {
-    ChatAvatarIdList::iterator iter = channel->getUserList()->begin();
-
 #ifdef DISP_REAL_FIRST_NAME
 #else
     sender.toLower();
@@ -1316,6 +1314,21 @@ void ChatMessageLib::sendChatRoomMessage(Channel* channel, BString galaxy, BStri
     loweredName.toLower();
     uint32 loweredNameCrc = loweredName.getCrc();
 
+    // The line is the same for everyone in the room, build it once and only copy it per recipient.
+    gMessageFactory->StartMessage();
+    gMessageFactory->addUint32(opChatRoomMessage);
+
+    gMessageFactory->addString(SWG);
+    gMessageFactory->addString(galaxy);
+    gMessageFactory->addString(sender);
+
+    gMessageFactory->addUint32(channel->getId());
+    gMessageFactory->addString(message);
+    gMessageFactory->addUint32(0);
+    Message* roomMessage = gMessageFactory->EndMessage();
+
+    ChatAvatarIdList::iterator iter = channel->getUserList()->begin();
+
     while (iter != channel->getUserList()->end())
     {
         // If sender present at recievers ignore list, don't send.
@@ -1335,15 +1348,7 @@ void ChatMessageLib::sendChatRoomMessage(Channel* channel, BString galaxy, BStri
             else
             {
                 gMessageFactory->StartMessage();
-                gMessageFactory->addUint32(opChatRoomMessage);
-
-                gMessageFactory->addString(SWG);
-                gMessageFactory->addString(galaxy);
-                gMessageFactory->addString(sender);
-
-                gMessageFactory->addUint32(channel->getId());
-                gMessageFactory->addString(message);
-                gMessageFactory->addUint32(0);
+                gMessageFactory->addData(roomMessage->getData(), roomMessage->getSize());
                 Message* response = gMessageFactory->EndMessage();
                 client->SendChannelA(response, client->getAccountId(), CR_Client, 5);
 
@@ -1351,6 +1356,8 @@ void ChatMessageLib::sendChatRoomMessage(Channel* channel, BString galaxy, BStri
         }
         ++iter;
     }
+
+    gMessageFactory->DestroyMessage(roomMessage);
 }
 
 //======================================================================================================================
@@ -52,6 +52,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/utils.h"
 #include "Utils/clock.h"
+#include "Utils/EventLoop.h"
 
 #include <boost/thread/thread.hpp>
 #include <cstring>
@@ -65,6 +66,7 @@ ChatServer* gChatServer;
 ChatServer::ChatServer() : mNetworkManager(0),mDatabaseManager(0),mRouterService(0),mDatabase(0), mLastHeartbeat(0)
 {
     Anh_Utils::Clock::Init();
+    Anh_Utils::EventLoop::Init();
     //gLogger->printSmallLogo();
     LOG(WARNING) << "Chat Server Startup";
 
@@ -172,6 +174,8 @@ void ChatServer::Process()
     mPlanetMapHandler->Process();
     mTradeManagerChatHandler->Process();
     mStructureManagerChatHandler->Process();
+    // after the handlers, so system mails queued this tick go out in one batch
+    mChatManager->Process();
 
 
     // Heartbeat once in awhile
@@ -266,6 +270,11 @@ int main(int argc, char* argv[])
 
     gChatServer = new ChatServer();
 
+    // nothing here runs on deadlines, the handlers poll their own timers, so sleeping that long at most is fine
+    uint32 maxWait = 20;
+    if(gConfig->keyExists("MainLoopMaxWait"))
+        maxWait = gConfig->read<uint32>("MainLoopMaxWait");
+
     // Since startup completed successfully, now set the atexit().  Otherwise we try to gracefully shutdown a failed startup, which usually fails anyway.
     //atexit(handleExit);
 
@@ -280,12 +289,15 @@ int main(int argc, char* argv[])
                 break;
         }
 
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        // sleep until network / database work comes in
+        gEventLoop->wait(maxWait);
     }
 
     // Shutdown things
     delete gChatServer;
 
+    Anh_Utils::EventLoop::destroySingleton();
+
     delete ConfigManager::getSingletonPtr();
 
     return 0;
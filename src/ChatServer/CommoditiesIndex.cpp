@@ -0,0 +1,435 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "CommoditiesIndex.h"
+#include "TradeManagerHelp.h"
+
+#include <cstring>
+
+//======================================================================================================================
+
+CommoditiesIndex::CommoditiesIndex()
+{
+}
+
+//======================================================================================================================
+
+CommoditiesIndex::~CommoditiesIndex()
+{
+    clear();
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::add(const CommodityListing& listing)
+{
+    ListingMap::iterator it = mListings.find(listing.mId);
+
+    if(it != mListings.end())
+    {
+        CommodityListing* indexed = (*it).second;
+
+        _unlink(indexed);
+        *indexed = listing;
+        _link(indexed);
+        return;
+    }
+
+    CommodityListing* indexed = new CommodityListing(listing);
+    mListings.insert(std::make_pair(indexed->mId, indexed));
+    _link(indexed);
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::remove(uint64 id)
+{
+    ListingMap::iterator it = mListings.find(id);
+
+    if(it == mListings.end())
+        return;
+
+    _unlink((*it).second);
+    delete((*it).second);
+    mListings.erase(it);
+    mBids.erase(id);
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::clear()
+{
+    ListingMap::iterator it = mListings.begin();
+    while(it != mListings.end())
+    {
+        delete((*it).second);
+        ++it;
+    }
+
+    mListings.clear();
+    mBids.clear();
+    mAll.clear();
+    mByItemType.clear();
+    mByCategory.clear();
+    mByRegion.clear();
+    mByPlanet.clear();
+    mByBazaar.clear();
+    mByOwner.clear();
+}
+
+//======================================================================================================================
+
+const CommodityListing* CommoditiesIndex::find(uint64 id) const
+{
+    ListingMap::const_iterator it = mListings.find(id);
+
+    if(it == mListings.end())
+        return(NULL);
+
+    return((*it).second);
+}
+
+//======================================================================================================================
+
+const CommodityBid* CommoditiesIndex::getBid(uint64 id, const int8* name) const
+{
+    BidMap::const_iterator it = mBids.find(id);
+
+    if(it == mBids.end())
+        return(NULL);
+
+    CommodityBidList::const_iterator bidIt = (*it).second.begin();
+    while(bidIt != (*it).second.end())
+    {
+        if(strcmp((*bidIt).mName, name) == 0)
+            return(&(*bidIt));
+        ++bidIt;
+    }
+    return(NULL);
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::setHighBid(uint64 id, const int8* name, uint64 bidderId, uint32 maxBid, uint32 proxy)
+{
+    ListingMap::iterator it = mListings.find(id);
+
+    if(it == mListings.end())
+        return;
+
+    CommodityListing* listing = (*it).second;
+
+    strncpy(listing->mBidderName, name, sizeof(listing->mBidderName) - 1);
+    listing->mBidderName[sizeof(listing->mBidderName) - 1] = 0;
+    listing->mBidderId = bidderId;
+
+    setBid(id, name, maxBid, proxy);
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::setBid(uint64 id, const int8* name, uint32 maxBid, uint32 proxy)
+{
+    if(mListings.find(id) == mListings.end())
+        return;
+
+    CommodityBid* bid = const_cast<CommodityBid*>(getBid(id, name));
+
+    if(!bid)
+    {
+        CommodityBid newBid;
+        strncpy(newBid.mName, name, sizeof(newBid.mName) - 1);
+        newBid.mName[sizeof(newBid.mName) - 1] = 0;
+
+        CommodityBidList& bids = mBids[id];
+        bids.push_back(newBid);
+        bid = &bids.back();
+    }
+
+    bid->mMaxBid = maxBid;
+    bid->mProxy = proxy;
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::setProxy(uint64 id, const int8* name, uint32 proxy)
+{
+    CommodityBid* bid = const_cast<CommodityBid*>(getBid(id, name));
+
+    if(bid)
+        bid->mProxy = proxy;
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::setSold(uint64 id, uint64 buyerId, const int8* buyerName, uint32 type, uint64 endTime)
+{
+    const CommodityListing* indexed = find(id);
+
+    if(!indexed)
+        return;
+
+    // the owner is part of the key, so go through add()
+    CommodityListing listing = *indexed;
+    listing.mOwnerId = buyerId;
+    listing.mType = type;
+    listing.mEndTime = endTime;
+    strncpy(listing.mSellerName, buyerName, sizeof(listing.mSellerName) - 1);
+    listing.mSellerName[sizeof(listing.mSellerName) - 1] = 0;
+
+    add(listing);
+}
+
+//======================================================================================================================
+
+uint32 CommoditiesIndex::search(const CommoditySearch& search, CommodityResultList& results) const
+{
+    const PriceIndex* index = _selectIndex(search);
+
+    if(!index)
+        return(0);
+
+    PriceKey first;
+    first.mPrice = search.mMinPrice;
+    first.mId = 0;
+    first.mListing = NULL;
+
+    uint32 skipped = 0;
+    uint32 found = 0;
+
+    PriceIndex::const_iterator it = index->lower_bound(first);
+    while(it != index->end() && found < search.mCount)
+    {
+        if(search.mMaxPrice && (*it).mPrice > search.mMaxPrice)
+            break;
+
+        if(_matches((*it).mListing, search))
+        {
+            if(skipped < search.mStart)
+            {
+                ++skipped;
+            }
+            else
+            {
+                results.push_back((*it).mListing);
+                ++found;
+            }
+        }
+        ++it;
+    }
+
+    return(found);
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::_link(CommodityListing* listing)
+{
+    PriceKey key;
+    key.mPrice = listing->mPrice;
+    key.mId = listing->mId;
+    key.mListing = listing;
+
+    mAll.insert(key);
+    mByItemType[listing->mItemType].insert(key);
+    mByCategory[_getMainCategory(listing->mCategory)].insert(key);
+    mByRegion[listing->mRegionId].insert(key);
+    mByPlanet[listing->mPlanetId].insert(key);
+    mByBazaar[listing->mBazaarId].insert(key);
+    mByOwner[listing->mOwnerId].insert(key);
+}
+
+//======================================================================================================================
+
+void CommoditiesIndex::_unlink(CommodityListing* listing)
+{
+    PriceKey key;
+    key.mPrice = listing->mPrice;
+    key.mId = listing->mId;
+    key.mListing = listing;
+
+    mAll.erase(key);
+    mByItemType[listing->mItemType].erase(key);
+    mByCategory[_getMainCategory(listing->mCategory)].erase(key);
+    mByRegion[listing->mRegionId].erase(key);
+    mByPlanet[listing->mPlanetId].erase(key);
+    mByBazaar[listing->mBazaarId].erase(key);
+    mByOwner[listing->mOwnerId].erase(key);
+}
+
+//======================================================================================================================
+
+template<typename Map, typename Key>
+const CommoditiesIndex::PriceIndex* CommoditiesIndex::_findIndex(const Map& map, Key key)
+{
+    typename Map::const_iterator it = map.find(key);
+
+    if(it == map.end())
+        return(NULL);
+
+    return(&(*it).second);
+}
+
+//======================================================================================================================
+//
+// every filter that has an index of its own narrows the scan, take the smallest
+// returns NULL when one of them has no listings at all
+//
+
+const CommoditiesIndex::PriceIndex* CommoditiesIndex::_selectIndex(const CommoditySearch& search) const
+{
+    const PriceIndex* candidates[4];
+    uint32 count = 0;
+
+    switch(search.mRegionType)
+    {
+    case TRMVendor:
+        candidates[count++] = _findIndex(mByBazaar, search.mBazaarId);
+        break;
+    case TRMRegion:
+        candidates[count++] = _findIndex(mByRegion, search.mRegionId);
+        break;
+    case TRMPlanet:
+        candidates[count++] = _findIndex(mByPlanet, search.mPlanetId);
+        break;
+    default:
+        break;
+    }
+
+    switch(search.mWindow)
+    {
+    case TRMVendor_MySales:
+    case TRMVendor_AvailableItems:
+        candidates[count++] = _findIndex(mByOwner, search.mCharId);
+        break;
+    case TRMVendor_Offers:
+    case TRMVendor_ForSale:
+        candidates[count++] = _findIndex(mByBazaar, search.mBazaarId);
+        break;
+    default:
+        break;
+    }
+
+    if(search.mItemType)
+        candidates[count++] = _findIndex(mByItemType, search.mItemType);
+
+    if(search.mCategory)
+        candidates[count++] = _findIndex(mByCategory, _getMainCategory(search.mCategory));
+
+    const PriceIndex* index = &mAll;
+
+    for(uint32 i = 0; i < count; i++)
+    {
+        if(!candidates[i])
+            return(NULL);
+
+        if(candidates[i]->size() < index->size())
+            index = candidates[i];
+    }
+
+    return(index);
+}
+
+//======================================================================================================================
+//
+// the same conditions the old AuctionQueryHeaders sql put together
+//
+
+bool CommoditiesIndex::_matches(const CommodityListing* listing, const CommoditySearch& search) const
+{
+    if(listing->mEndTime <= search.mNow)
+        return(false);
+
+    switch(search.mRegionType)
+    {
+    case TRMVendor:
+        if(listing->mBazaarId != search.mBazaarId)
+            return(false);
+        break;
+    case TRMRegion:
+        if(listing->mRegionId != search.mRegionId)
+            return(false);
+        break;
+    case TRMPlanet:
+        if(listing->mPlanetId != search.mPlanetId)
+            return(false);
+        break;
+    default:
+        break;
+    }
+
+    bool forSale = (listing->mType == TRMVendor_Auction) || (listing->mType == TRMVendor_Instant);
+
+    switch(search.mWindow)
+    {
+    case TRMVendor_AllAuctions:
+        if(!forSale)
+            return(false);
+        break;
+    case TRMVendor_MySales:
+        if(!forSale || listing->mOwnerId != search.mCharId)
+            return(false);
+        break;
+    case TRMVendor_MyBids:
+        if(!forSale || !getBid(listing->mId, search.mCharName))
+            return(false);
+        break;
+    case TRMVendor_AvailableItems:
+        if(listing->mType != TRMVendor_Ended || listing->mOwnerId != search.mCharId)
+            return(false);
+        break;
+    case TRMVendor_Offers:
+        if(listing->mType != TRMVendor_Offer || listing->mBazaarId != search.mBazaarId || strcmp(listing->mBidderName, search.mCharName) != 0)
+            return(false);
+        break;
+    case TRMVendor_ForSale:
+        if(!forSale || listing->mBazaarId != search.mBazaarId || strcmp(listing->mBidderName, search.mCharName) != 0)
+            return(false);
+        break;
+    default:
+        break;
+    }
+
+    if(search.mCategory)
+    {
+        // a main category has no subcategory bits set
+        if((search.mCategory << 24) == 0)
+        {
+            if(_getMainCategory(listing->mCategory) != _getMainCategory(search.mCategory))
+                return(false);
+        }
+        else if(listing->mCategory != search.mCategory)
+            return(false);
+    }
+
+    if(search.mItemType && listing->mItemType != search.mItemType)
+        return(false);
+
+    return(true);
+}
+
+//======================================================================================================================
@@ -0,0 +1,188 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_CHATSERVER_COMMODITIESINDEX_H
+#define ANH_CHATSERVER_COMMODITIESINDEX_H
+
+#include "Utils/typedefs.h"
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+//======================================================================================================================
+//
+// one bidder on a live auction, mirrors a commerce_bidhistory row
+//
+
+struct CommodityBid
+{
+    int8			mName[32];
+    uint32			mProxy;
+    uint32			mMaxBid;
+};
+
+typedef std::vector<CommodityBid> CommodityBidList;
+
+//======================================================================================================================
+//
+// the part of a commerce_auction row the bazaar and vendor windows show
+//
+
+struct CommodityListing
+{
+    uint64				mId;
+    uint64				mOwnerId;
+    uint64				mBazaarId;
+    uint64				mBidderId;
+    uint64				mEndTime;
+    uint32				mType;
+    uint32				mPremium;
+    uint32				mCategory;
+    uint32				mItemType;
+    uint32				mPrice;
+    uint32				mRegionId;
+    uint32				mPlanetId;
+    int8				mName[128];
+    int8				mSellerName[32];
+    int8				mBazaarName[128];
+    int8				mBidderName[32];
+};
+
+//======================================================================================================================
+//
+// what a AuctionQueryHeaders request filters on, see TRMRegionType / TRMAuctionWindowType
+//
+
+struct CommoditySearch
+{
+    uint32			mRegionType;
+    uint64			mBazaarId;
+    uint32			mRegionId;
+    uint32			mPlanetId;
+    uint32			mWindow;
+    uint64			mCharId;
+    const int8*		mCharName;
+    uint32			mCategory;
+    uint32			mItemType;
+    uint32			mMinPrice;
+    uint32			mMaxPrice;
+    uint64			mNow;
+    uint32			mStart;
+    uint32			mCount;
+};
+
+typedef std::vector<const CommodityListing*> CommodityResultList;
+
+//======================================================================================================================
+//
+// Holds every listing of the galaxy in memory, so browsing the bazaar and vendors
+// never has to go to the database. Each listing is kept in price order in one
+// index per item type, main category, region, planet, bazaar and owner, a search
+// picks the smallest one that applies and scans it from the lowest price on.
+//
+
+class CommoditiesIndex
+{
+public:
+
+    CommoditiesIndex();
+    ~CommoditiesIndex();
+
+    // adds the listing, or replaces it when it is already indexed, bids are kept
+    void					add(const CommodityListing& listing);
+    void					remove(uint64 id);
+    void					clear();
+
+    const CommodityListing*	find(uint64 id) const;
+    const CommodityBid*		getBid(uint64 id, const int8* name) const;
+
+    // mirror what sf_BidAuction / sf_BidUpdate do to the listing
+    void					setHighBid(uint64 id, const int8* name, uint64 bidderId, uint32 maxBid, uint32 proxy);
+    void					setBid(uint64 id, const int8* name, uint32 maxBid, uint32 proxy);
+    void					setProxy(uint64 id, const int8* name, uint32 proxy);
+
+    // an instant sale changed hands, the buyer still has to pick it up
+    void					setSold(uint64 id, uint64 buyerId, const int8* buyerName, uint32 type, uint64 endTime);
+
+    // appends up to search.mCount matches after skipping search.mStart, cheapest first
+    // the client pages by offset, so the skipped matches are walked again for every page
+    uint32					search(const CommoditySearch& search, CommodityResultList& results) const;
+
+    uint32					size() const { return static_cast<uint32>(mListings.size()); }
+
+private:
+
+    struct PriceKey
+    {
+        uint32				mPrice;
+        uint64				mId;
+        CommodityListing*	mListing;
+
+        bool operator<(const PriceKey& other) const
+        {
+            if(mPrice != other.mPrice)
+                return(mPrice < other.mPrice);
+
+            return(mId < other.mId);
+        }
+    };
+
+    typedef std::set<PriceKey>								PriceIndex;
+    typedef std::map<uint32, PriceIndex>					PriceIndexMap;
+    typedef std::map<uint64, PriceIndex>					PriceIndex64Map;
+    typedef std::unordered_map<uint64, CommodityListing*>	ListingMap;
+    typedef std::unordered_map<uint64, CommodityBidList>	BidMap;
+
+    void					_link(CommodityListing* listing);
+    void					_unlink(CommodityListing* listing);
+
+    const PriceIndex*		_selectIndex(const CommoditySearch& search) const;
+    bool					_matches(const CommodityListing* listing, const CommoditySearch& search) const;
+
+    template<typename Map, typename Key>
+    static const PriceIndex* _findIndex(const Map& map, Key key);
+
+    static uint32			_getMainCategory(uint32 category) { return(category >> 8); }
+
+    ListingMap				mListings;
+    BidMap					mBids;
+
+    PriceIndex				mAll;
+    PriceIndexMap			mByItemType;
+    PriceIndexMap			mByCategory;
+    PriceIndexMap			mByRegion;
+    PriceIndexMap			mByPlanet;
+    PriceIndex64Map			mByBazaar;
+    PriceIndex64Map			mByOwner;
+};
+
+//======================================================================================================================
+
+#endif
+
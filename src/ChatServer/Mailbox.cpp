@@ -0,0 +1,171 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "Mailbox.h"
+#include "Mail.h"
+
+#include <algorithm>
+
+//======================================================================================================================
+
+Mailbox::Mailbox()
+{
+}
+
+//======================================================================================================================
+
+Mailbox::~Mailbox()
+{
+    MailHeaderMap::iterator it = mHeaders.begin();
+
+    while(it != mHeaders.end())
+    {
+        delete((*it).second.mBody);
+        ++it;
+    }
+}
+
+//======================================================================================================================
+
+void Mailbox::addHeader(Mail* mail)
+{
+    MailHeaderMap::iterator it = mHeaders.find(mail->getId());
+
+    // an existing entry keeps its cached body
+    if(it == mHeaders.end())
+    {
+        it = mHeaders.insert(std::make_pair(mail->getId(),MailHeader())).first;
+        (*it).second.mBody = NULL;
+    }
+
+    MailHeader& header = (*it).second;
+
+    header.mId		= mail->getId();
+    header.mTime	= mail->getTime();
+    header.mStatus	= mail->getStatus();
+    header.mSender	= mail->getSender();
+    header.mSubject	= mail->getSubject();
+}
+
+//======================================================================================================================
+
+MailHeader* Mailbox::getHeader(uint32 mailId)
+{
+    MailHeaderMap::iterator it = mHeaders.find(mailId);
+
+    if(it == mHeaders.end())
+    {
+        return(NULL);
+    }
+
+    return(&(*it).second);
+}
+
+//======================================================================================================================
+
+void Mailbox::removeMail(uint32 mailId)
+{
+    MailHeaderMap::iterator it = mHeaders.find(mailId);
+
+    if(it == mHeaders.end())
+    {
+        return;
+    }
+
+    _dropBody(&(*it).second);
+    mHeaders.erase(it);
+}
+
+//======================================================================================================================
+
+void Mailbox::cacheBody(uint32 mailId,Mail* body)
+{
+    MailHeader* header = getHeader(mailId);
+
+    if(!header)
+    {
+        delete(body);
+        return;
+    }
+
+    _dropBody(header);
+
+    header->mBody = body;
+    mCachedBodies.push_back(mailId);
+
+    while(mCachedBodies.size() > MaxCachedBodies)
+    {
+        MailHeader* oldest = getHeader(mCachedBodies.front());
+
+        // _dropBody pops the front
+        if(oldest)
+        {
+            _dropBody(oldest);
+        }
+        else
+        {
+            mCachedBodies.pop_front();
+        }
+    }
+}
+
+//======================================================================================================================
+
+Mail* Mailbox::getBody(uint32 mailId)
+{
+    MailHeader* header = getHeader(mailId);
+
+    if(!header)
+    {
+        return(NULL);
+    }
+
+    return(header->mBody);
+}
+
+//======================================================================================================================
+
+void Mailbox::_dropBody(MailHeader* header)
+{
+    if(!header->mBody)
+    {
+        return;
+    }
+
+    delete(header->mBody);
+    header->mBody = NULL;
+
+    std::deque<uint32>::iterator it = std::find(mCachedBodies.begin(),mCachedBodies.end(),header->mId);
+
+    if(it != mCachedBodies.end())
+    {
+        mCachedBodies.erase(it);
+    }
+}
+
+//======================================================================================================================
+
@@ -0,0 +1,102 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_CHATSERVER_MAILBOX_H
+#define ANH_CHATSERVER_MAILBOX_H
+
+#include "Utils/typedefs.h"
+#include "Utils/bstring.h"
+
+#include <deque>
+#include <map>
+
+class Mail;
+
+//======================================================================================================================
+//
+// what the mail window lists of a mail, subject is kept in unicode16 the way it goes out
+//
+
+struct MailHeader
+{
+    uint32			mId;
+    uint32			mTime;
+    uint8			mStatus;
+    BString			mSender;
+    BString			mSubject;
+    Mail*			mBody;
+};
+
+typedef std::map<uint32,MailHeader> MailHeaderMap;
+
+//======================================================================================================================
+//
+// the mails of an online player
+// filled by the header query on login and kept current as mails arrive, get read and deleted.
+// bodies are loaded on first read, only the last few read or delivered ones stay in memory
+//
+
+class Mailbox
+{
+public:
+
+    Mailbox();
+    ~Mailbox();
+
+    // mail is copied, a header with the same id is replaced
+    void			addHeader(Mail* mail);
+    MailHeader*		getHeader(uint32 mailId);
+    void			removeMail(uint32 mailId);
+
+    // takes ownership of the body, deleted right away when the mail is not in the box
+    void			cacheBody(uint32 mailId,Mail* body);
+    Mail*			getBody(uint32 mailId);
+
+    uint32			getMailCount() const {
+        return(static_cast<uint32>(mHeaders.size()));
+    }
+    uint32			getCachedBodyCount() const {
+        return(static_cast<uint32>(mCachedBodies.size()));
+    }
+
+private:
+
+    enum
+    {
+        MaxCachedBodies = 16
+    };
+
+    void			_dropBody(MailHeader* header);
+
+    MailHeaderMap		mHeaders;
+
+    // ids of the mails holding a body, oldest first
+    std::deque<uint32>	mCachedBodies;
+};
+
+#endif
+
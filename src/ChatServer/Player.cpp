@@ -27,6 +27,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Player.h"
 
+#include <algorithm>
+
 //======================================================================================================================
 
 void Player::removeFriend(uint32 nameCrc)
@@ -56,6 +58,15 @@ bool Player::checkFriend(uint32 nameCrc)
 
 //======================================================================================================================
 
+void Player::addIgnore(BString name)
+{
+    mIgnoreList.insert(std::make_pair(name.getCrc(),name.getAnsi()));
+
+    _rebuildIgnoreFilter();
+}
+
+//======================================================================================================================
+
 void Player::removeIgnore(uint32 nameCrc)
 {
     ContactMap::iterator it = mIgnoreList.find(nameCrc);
@@ -63,22 +74,43 @@ void Player::removeIgnore(uint32 nameCrc)
     if(it != mIgnoreList.end())
     {
         mIgnoreList.erase(it);
+
+        _rebuildIgnoreFilter();
         return;
     }
 }
 
 //======================================================================================================================
 
-bool Player::checkIgnore(uint32 nameCrc)
+bool Player::checkIgnore(uint32 nameCrc) const
 {
-    ContactMap::iterator it = mIgnoreList.find(nameCrc);
+    uint64 bits = _getIgnoreFilterBits(nameCrc);
 
-    if(it != mIgnoreList.end())
+    if((mIgnoreFilter & bits) != bits)
     {
-        return(true);
+        return(false);
     }
 
-    return(false);
+    return(std::binary_search(mIgnoreCrcs.begin(),mIgnoreCrcs.end(),nameCrc));
+}
+
+//======================================================================================================================
+
+void Player::_rebuildIgnoreFilter()
+{
+    mIgnoreCrcs.clear();
+    mIgnoreFilter = 0;
+
+    // the map is ordered by crc already
+    ContactMap::iterator it = mIgnoreList.begin();
+
+    while(it != mIgnoreList.end())
+    {
+        mIgnoreCrcs.push_back((*it).first);
+        mIgnoreFilter |= _getIgnoreFilterBits((*it).first);
+
+        ++it;
+    }
 }
 
 //======================================================================================================================
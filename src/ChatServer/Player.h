@@ -29,10 +29,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_CHATSERVER_PLAYER_H
 
 #include <map>
+#include <vector>
 
 #include "Utils/typedefs.h"
 #include "Utils/bstring.h"
 
+#include "Mailbox.h"
+
 class DispatchClient;
 
 //======================================================================================================================
@@ -62,7 +65,8 @@ class Player
 {
 public:
     Player(uint64 charId,DispatchClient* client,uint32 planetId)
-        : mBazaar(nullptr)
+        : mIgnoreFilter(0)
+        , mBazaar(nullptr)
         , mClient(client)
         , mCharId(charId)
         , mGroupId(0)
@@ -140,14 +144,17 @@ public:
     void			removeFriend(uint32 nameCrc);
     bool			checkFriend(uint32 nameCrc);
 
-    ContactMap*		getIgnoreList() {
+    // changes have to go through add / removeIgnore, they keep the chat filter in sync
+    const ContactMap*	getIgnoreList() const {
         return &mIgnoreList;
     }
-    void			addIgnore(BString name) {
-        mIgnoreList.insert(std::make_pair(name.getCrc(),name.getAnsi()));
-    }
+    void			addIgnore(BString name);
     void			removeIgnore(uint32 nameCrc);
-    bool			checkIgnore(uint32 nameCrc);
+    bool			checkIgnore(uint32 nameCrc) const;
+
+    Mailbox*		getMailbox() {
+        return &mMailbox;
+    }
 
     uint16			getGroupMemberIndex() {
         return mGroupMemberIndex;
@@ -185,7 +192,20 @@ public:
     }
 
 private:
+
+    static uint64		_getIgnoreFilterBits(uint32 nameCrc) {
+        return((1ULL << (nameCrc & 63)) | (1ULL << ((nameCrc >> 6) & 63)));
+    }
+    void				_rebuildIgnoreFilter();
+
     ContactMap			mFriendsList,mIgnoreList;
+
+    // checked for every line of every chat room the player is in, most senders are
+    // turned away by the 64 bit bloom filter, the rest by a search of the sorted crcs
+    std::vector<uint32>	mIgnoreCrcs;
+    uint64				mIgnoreFilter;
+
+    Mailbox				mMailbox;
     PlayerData  		mPlayerData;
     Bazaar*		    	mBazaar;
     DispatchClient*		mClient;
@@ -97,16 +97,13 @@ StructureManagerChatHandler::StructureManagerChatHandler(Database* database, Mes
     //implement configmanager in the chatserver
 
     std::tr1::shared_ptr<Timer> factory_timer(new Timer(SRMTimer_CheckFactory,this,8000,NULL));
-    std::tr1::shared_ptr<Timer> hopper_timer(new Timer(SRMTimer_CheckHarvesterHopper,this,1000,NULL));
+    // harvesters, houses and factories pay their maintenance inside the zone that holds them
     std::tr1::shared_ptr<Timer> maintenance_timer(new Timer(SRMTimer_CheckHarvesterMaintenance,this,3600*1000,NULL));
-    std::tr1::shared_ptr<Timer> power_timer(new Timer(SRMTimer_CheckHarvesterPower,this,3600*1000,NULL));
     //std::tr1::shared_ptr<Timer> tick_preserve_timer(new Timer(CMTimer_TickPreserve,this,ServerTimeInterval*10000,NULL));
     //std::tr1::shared_ptr<Timer> check_auctions_timer(new Timer(CMTimer_CheckAuctions,this,ServerTimeInterval*10000,NULL));
 
     mTimers.push_back(factory_timer);
-    mTimers.push_back(hopper_timer);
     mTimers.push_back(maintenance_timer);
-    mTimers.push_back(power_timer);
 
 }
 
@@ -432,42 +429,6 @@ void StructureManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseRe
     }
     break;
 
-    case STRMQuery_DoneHarvesterUsePower:
-    {
-        uint32 exitCode;
-        DataBinding* binding = mDatabase->createDataBinding(1);
-        binding->addField(DFT_uint32,0,4);
-
-        if (!result->getRowCount()) {
-           	return;
-        }
-
-        //return codes :
-        // 0 everything ok
-        // 1 structure is out of power
-        // 2
-        // 3 unspecified db error
-
-
-        result->getNextRow(binding,&exitCode);
-
-        // cant notify zone when no player is online
-        // zone will update harvesterstatus once per hour
-
-        // only reason for us tzo handle this event here  would be if we wanted to inform the player
-
-        if(exitCode == 3)
-        {
-            //unspecified db error
-            LOG(WARNING) << "StructureManagerChat::HarvesterPowerUsage "<< asynContainer->harvesterID <<" unspecified db error" ;
-        }
-
-
-        mDatabase->destroyDataBinding(binding);
-
-    }
-    break;
-
     case STRMQuery_DoneFactoryUpdate:
     {
         uint32 exitCode;
@@ -509,49 +470,6 @@ void StructureManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseRe
     }
     break;
 
-    case STRMQuery_DoneHarvestUpdate:
-    {
-        uint32 exitCode;
-        DataBinding* binding = mDatabase->createDataBinding(1);
-        binding->addField(DFT_uint32,0,4);
-
-        uint64 count;
-        count = result->getRowCount();
-
-        //return codes :
-        // 0 everything ok
-        // 1 hopper full harvester turned of
-        // 2 resource isnt active anymore
-        // 3 resource doesnt exist in the first place
-
-
-        for(uint64 i=0; i <count; i++)
-        {
-            result->getNextRow(binding,&exitCode);
-
-            if(exitCode == 1)
-            {
-                //resource never existed in the first place
-				DLOG(INFO ) << "StructureMabagerChat::Harvester "<<asynContainer->harvesterID << " hopper full";
-            }
-            if(exitCode == 2)
-            {
-                //resource never existed in the first place
-                DLOG(INFO) << "StructureMabagerChat::Harvester "<< asynContainer->harvesterID << " resourcechange";
-            }
-            if(exitCode == 3)
-            {
-                //resource never existed in the first place
-               DLOG(INFO) << "StructureMabagerChat::Harvester "<< asynContainer->harvesterID <<" harvested an invalid resource";
-            }
-
-        }
-
-        mDatabase->destroyDataBinding(binding);
-
-    }
-    break;
-
     case STRMQuery_MaintenanceUpdate:
     {
         uint64 harvesterID;
@@ -580,41 +498,6 @@ void StructureManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseRe
     }
     break;
 
-    case STRMQuery_PowerUpdate:
-    {
-        uint64 harvesterID;
-        DataBinding* binding = mDatabase->createDataBinding(1);
-        binding->addField(DFT_uint64,0,8);
-
-        uint64 count;
-        count = result->getRowCount();
-
-        for(uint64 i=0; i <count; i++)
-        {
-            result->getNextRow(binding,&harvesterID);
-
-            int8 sql[100];
-
-            //start by using power
-            sprintf(sql,"SELECT sf_HarvesterUsePower(%"PRIu64")",harvesterID);
-            StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(STRMQuery_DoneHarvesterUsePower,0);
-            asyncContainer->harvesterID = harvesterID;
-
-            mDatabase->executeSqlAsync(this,asyncContainer,sql);
-
-            //return codes :
-            // 0 everything ok
-            // 1 hopper full harvester turned of
-            // 2 resource isnt active anymore
-            // 3 resource doesnt exist in the first place
-
-        }
-
-        mDatabase->destroyDataBinding(binding);
-
-    }
-    break;
-
     case STRMQuery_FactoryUpdate:
     {
         uint64 factoryID;
@@ -647,40 +530,6 @@ void StructureManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseRe
 
         mDatabase->destroyDataBinding(binding);
 
-    }
-
-    case STRMQuery_HopperUpdate:
-    {
-        uint64 harvesterID;
-        DataBinding* binding = mDatabase->createDataBinding(1);
-        binding->addField(DFT_uint64,0,8);
-
-        uint64 count;
-        count = result->getRowCount();
-
-        for(uint64 i=0; i <count; i++)
-        {
-            result->getNextRow(binding,&harvesterID);
-
-            int8 sql[100];
-
-            //now harvest
-            sprintf(sql,"SELECT sf_HarvestResource(%"PRIu64")",harvesterID);
-            StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(STRMQuery_DoneHarvestUpdate,0);
-            asyncContainer->harvesterID = harvesterID;
-
-            mDatabase->executeSqlAsync(this,asyncContainer,sql);
-
-            //return codes :
-            // 0 everything ok
-            // 1 hopper full harvester turned of
-            // 2 resource isnt active anymore
-            // 3 resource doesnt exist in the first place
-
-        }
-
-        mDatabase->destroyDataBinding(binding);
-
     }
     break;
 
@@ -723,25 +572,12 @@ void StructureManagerChatHandler::processTimerEvents()
         }
         break;
 
-        //handles the harvesters hopper and power -updates
-        case SRMTimer_CheckHarvesterHopper:
-        {
-            handleCheckHarvesterHopper();
-        }
-        break;
-
         case SRMTimer_CheckFactory:
         {
             handleFactoryUpdate();
         }
         break;
 
-        case SRMTimer_CheckHarvesterPower:
-        {
-            handleCheckHarvesterPower();
-        }
-        break;
-
         default:
             break;
         }
@@ -750,41 +586,6 @@ void StructureManagerChatHandler::processTimerEvents()
     }
 }
 
-//=======================================================================================================================
-//
-// iterates through the list of hoppers we need to update on a regular basis
-// and reads the relevant resource data - then sends it to the client
-//
-void StructureManagerChatHandler::handleCheckHarvesterPower()
-{
-
-    StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(STRMQuery_PowerUpdate,0);
-
-    int8 sql[100];
-    sprintf(sql,"SELECT h.ID FROM harvesters h WHERE h.active > 0 ");
-
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
-
-}
-
-
-//=======================================================================================================================
-//
-// iterates through the list of hoppers we need to update on a regular basis
-// and reads the relevant resource data - then sends it to the client
-//
-void StructureManagerChatHandler::handleCheckHarvesterHopper()
-{
-
-    StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(STRMQuery_HopperUpdate,0);
-
-    int8 sql[100];
-    sprintf(sql,"SELECT h.ID FROM harvesters h WHERE h.active > 0 ");
-
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
-
-}
-
 //=======================================================================================================================
 //
 // iterates through the list of hoppers we need to update on a regular basis
@@ -806,14 +607,16 @@ void StructureManagerChatHandler::handleFactoryUpdate()
 //=======================================================================================================================
 //
 // iterates through all structures in structures.sql to take off maintenance
+// harvesters, houses and factories are left out, the zones settle them
 //
 void StructureManagerChatHandler::handleCheckHarvesterMaintenance()
 {
 
     StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(STRMQuery_MaintenanceUpdate,0);
 
-    int8 sql[100];
-    sprintf(sql,"SELECT s.ID FROM structures s");
+    int8 sql[300];
+    sprintf(sql,"SELECT s.ID FROM structures s LEFT JOIN harvesters h ON (h.ID = s.ID) LEFT JOIN houses ho ON (ho.ID = s.ID) LEFT JOIN factories f ON (f.ID = s.ID)"
+            " WHERE h.ID IS NULL AND ho.ID IS NULL AND f.ID IS NULL");
 
     mDatabase->executeSqlAsync(this,asyncContainer,sql);
 
@@ -76,9 +76,7 @@ typedef std::vector<std::tr1::shared_ptr<Timer> >	TimerList;
 
 enum SRMTimer
 {
-    SRMTimer_CheckHarvesterHopper		=	1,
     SRMTimer_CheckHarvesterMaintenance	=	2,
-    SRMTimer_CheckHarvesterPower		=	3,
     SRMTimer_CheckFactory				=	4
 };
 
@@ -127,8 +125,6 @@ private:
     void				processTimerEvents();
     void				handleGlobalTickUpdate();
 
-    void				handleCheckHarvesterPower();
-    void				handleCheckHarvesterHopper();
     void				handleCheckHarvesterMaintenance();
 
     void				handleFactoryUpdate();
@@ -161,15 +157,11 @@ private:
 enum STRMQueryType
 {
     STRMQuery_NULL						=	0,
-    STRMQuery_HopperUpdate				=	1,
-    STRMQuery_DoneHarvestUpdate			=	2,
-    STRMQuery_DoneHarvesterUsePower		=	3,
     STRMQuery_DoneStructureMaintenance	=	4,
     STRMQuery_StructureMailOOFMaint		=	5,
     STRMQuery_StructureMailDamage		=	6,
     STRMQuery_StructureMailCondZero		=	7,
     STRMQuery_MaintenanceUpdate			=	8,
-    STRMQuery_PowerUpdate				=	9,
     STRMQuery_FactoryUpdate				=	10,
     STRMQuery_DoneFactoryUpdate			=	11
 };
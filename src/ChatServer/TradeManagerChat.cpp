@@ -59,6 +59,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 bool						TradeManagerChatHandler::mInsFlag    = false;
 TradeManagerChatHandler*		TradeManagerChatHandler::mSingleton  = NULL;
 
+// everything the commodities index keeps of a listing, filtered by auction_id when reindexing
+static const int8 CommoditiesSelect[] = "SELECT c.auction_id, c.owner_id, c.bazaar_id, IFNULL(hb.id, 0), c.start, c.type, c.premium, c.category, c.itemtype, c.price, c.region_id, c.planet_id, c.name, ch.firstname, cb.bazaar_string, c.bidder_name FROM swganh.commerce_auction c INNER JOIN swganh.characters ch ON (c.owner_id = ch.id) INNER JOIN swganh.commerce_bazaar cb ON (cb.bazaar_id = c.bazaar_id) LEFT JOIN swganh.characters hb ON (hb.firstname = c.bidder_name AND c.bidder_name <> '')";
+
 uint32 TradeManagerChatHandler::getBazaarRegion(uint64 ID)
 {
     //uint32 Region = 0;
@@ -112,6 +115,9 @@ TradeManagerChatHandler::TradeManagerChatHandler(Database* database, MessageDisp
     mBazaarsLoaded = false;
     mBazaarCount = 0;
     mBazaarMaxBid = 20000;
+    mCommoditiesLoaded = false;
+    mCommodityWriteInFlight = false;
+    mCheckAuctionsQueued = false;
 
     mDatabase = database;
     mChatManager = chatManager;
@@ -132,7 +138,10 @@ TradeManagerChatHandler::TradeManagerChatHandler(Database* database, MessageDisp
     // load our bazaar terminals
     asyncContainer = new TradeManagerAsyncContainer(TRMQuery_LoadBazaar, 0);
     mDatabase->executeProcedureAsync(this, asyncContainer, "CALL sp_BazaarTerminalsGet();");
-    
+
+    // load all listings into the commodities index, their bids follow once they are in
+    asyncContainer = new TradeManagerAsyncContainer(TRMQuery_LoadCommodities, 0);
+    mDatabase->executeSqlAsync(this, asyncContainer, CommoditiesSelect);
 
     // load our global tick
     asyncContainer = new TradeManagerAsyncContainer(TRMQuery_LoadGlobalTick, 0);
@@ -200,7 +209,13 @@ void TradeManagerChatHandler::Shutdown()
 
     // @todo Hardcoded galaxy at this time, to be changed.
     mDatabase->executeProcedureAsync(this, NULL, "CALL sp_ServerGlobalTickUpdate(%u, '%"PRIu64"');", 2, getGlobalTickCount());
-    
+
+    // whatever is still in the commodities write log has to reach the db before we go
+    while(mCommodityWrites.size())
+    {
+        mDatabase->destroyResult(mDatabase->executeProcedure("%s", mCommodityWrites.front().mSql.c_str()));
+        mCommodityWrites.pop_front();
+    }
 
     mMessageDispatch->UnregisterMessageCallback(opIsVendorMessage);
     mMessageDispatch->UnregisterMessageCallback(opAuctionQueryHeadersMessage);
@@ -238,6 +253,13 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
 {
     TradeManagerAsyncContainer* asynContainer = (TradeManagerAsyncContainer*)ref;
     Player* player(0);
+
+    // the write log only has one write at the db at a time, send the next one
+    if(asynContainer->writeLog)
+    {
+        mCommodityWriteInFlight = false;
+        _writeNextCommodity();
+    }
     if (asynContainer->mClient) {
 
         PlayerAccountMap::iterator accIt = mPlayerAccountMap.find(asynContainer->mClient->getAccountId());
@@ -288,9 +310,10 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
 
     case TRMQuery_CreateAuction:
     {
-
+        // the zone put the listing in, now that it has its place and time it can be searched
+        std::vector<uint64> ids(1, asynContainer->AuctionID);
+        _indexCommodities(ids);
     }
-
     break;
     case TRMQuery_ACKRetrieval:
     {
@@ -544,13 +567,8 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
         }
         int8 sql[100];
         sprintf(sql,"SELECT sf_CancelLiveAuction ('%"PRIu64"')", asynContainer->AuctionID);
+        _queueCommodityWrite(TRMQuery_CancelAuction, asynContainer->mClient, asynContainer->AuctionID, false, sql);
 
-        TradeManagerAsyncContainer* asyncContainer;
-        asyncContainer = new TradeManagerAsyncContainer(TRMQuery_CancelAuction, asynContainer->mClient);
-
-        asyncContainer->AuctionID = asynContainer->AuctionID;
-        mDatabase->executeSqlAsync(this, asyncContainer, sql);
-        
         mDatabase->destroyDataBinding(binding);
     }
     break;
@@ -577,6 +595,9 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
             gChatMessageLib->sendCanceLiveAuctionResponseMessage(asynContainer->mClient, 1, asynContainer->AuctionID);
             LOG(INFO) << "TradeManager::TRMQuery_CancelAuction::Aucction not found : " << asynContainer->AuctionID;
         }
+
+        std::vector<uint64> ids(1, asynContainer->AuctionID);
+        _indexCommodities(ids);
     }
     break;
 
@@ -604,184 +625,6 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
     }
     break;
 
-    case TRMQuery_AuctionQuery:
-    {
-        //better check if theres a player???
-        //all auctions that fit the search criteria are loaded into memory - the query
-        //selects them based on the page count
-        //Lists are assembled of every single seller, bazaar and of the auctions
-        //every seller and bazaar name is only send once, regardlass how much
-        //auctions they have
-
-        DataBinding* binding = mDatabase->createDataBinding(18);
-        binding->addField(DFT_uint64,offsetof(AuctionItem,ItemID),8,0);
-        binding->addField(DFT_uint64,offsetof(AuctionItem,OwnerID),8,1);
-        binding->addField(DFT_uint64,offsetof(AuctionItem,BazaarID),8,2);
-        binding->addField(DFT_uint32,offsetof(AuctionItem,AuctionTyp),4,3);
-        binding->addField(DFT_uint64,offsetof(AuctionItem,EndTime),8,4);
-        binding->addField(DFT_uint32,offsetof(AuctionItem,Premium),4,5);
-        binding->addField(DFT_uint32,offsetof(AuctionItem,Category),4,6);
-        binding->addField(DFT_uint32,offsetof(AuctionItem,ItemTyp),4,7);
-        binding->addField(DFT_uint32,offsetof(AuctionItem,Price),4,8);
-        binding->addField(DFT_string,offsetof(AuctionItem,Name),128,9);
-        binding->addField(DFT_string,offsetof(AuctionItem,Description), 1024, 10);
-        binding->addField(DFT_uint16,offsetof(AuctionItem,RegionID), 2, 11);
-        binding->addField(DFT_string,offsetof(AuctionItem,bidder_name), 32, 12);
-        binding->addField(DFT_uint16,offsetof(AuctionItem,PlanetID), 2, 13);
-        binding->addField(DFT_string,offsetof(AuctionItem,SellerName), 32 ,14);
-        binding->addField(DFT_string,offsetof(AuctionItem,BazaarName), 128, 15);
-        binding->addField(DFT_string,offsetof(AuctionItem,HighProxyRaw), 8, 16);
-        binding->addField(DFT_string,offsetof(AuctionItem,HighBidRaw) ,8, 17);
-
-        uint64 count = result->getRowCount();
-
-        auction = new AuctionClass();
-
-        AuctionItem AuctionTemp;
-        //Not sure how to properly read this in. We perform a left join, because
-        //the data is not existing when nobody has bid on the item yet
-
-        strcpy(AuctionTemp.HighBidRaw,"0          ");
-        strcpy(AuctionTemp.HighProxyRaw,"0          ");
-
-        AuctionTemp.HighBid = 0;
-        AuctionTemp.HighProxy = 0;
-        for(uint64 i = 0; i < count; i++)
-        {
-            //assemble our string list
-            result->getNextRow(binding,&AuctionTemp);
-            AuctionTemp.HighBid = atoi(AuctionTemp.HighBidRaw);
-            AuctionTemp.HighProxy = atoi(AuctionTemp.HighProxyRaw);
-            auction->AddAuction(AuctionTemp);
-        }
-        //now that the lists are done we need to send the packet
-
-        gMessageFactory->StartMessage();
-        gMessageFactory->addUint32(opAuctionQueryHeadersResponseMessage);
-
-        gMessageFactory->addUint32(asynContainer->BazaarPage);//
-        gMessageFactory->addUint32(asynContainer->BazaarWindow );
-        //total of unique Terminals and unique sellers per terminal
-        //so here goes the total nr of strings
-        gMessageFactory->addUint32(auction->getStringCount());
-        ListStringList::iterator itL = auction->mListStringList.begin();
-        //that are all bazaars, sellers and bidders
-        while(itL != auction->mListStringList.end())
-        {
-            gMessageFactory->addString((*itL)->GetString());
-            itL++;
-        }
-
-        //Nr of unique Auction Names (no auction name more than once)
-        gMessageFactory->addUint32(auction->NameStringCount);
-
-        BString s;
-        NameStringList::iterator itD = auction->mNameStringList.begin();
-        while(itD != auction->mNameStringList.end())
-        {
-            s = (*itD)->GetName();
-            s.convert(BSTRType_Unicode16);
-            gMessageFactory->addString(s);
-            itD++;
-        }
-
-        //finally here the total Nr of auctions
-        gMessageFactory->addUint32(auction->AuctionStringCount);
-        AuctionStringList::iterator itA = auction->mAuctionStringList.begin();
-        while(itA != auction->mAuctionStringList.end())
-        {
-
-            //Item/AuctionID
-            gMessageFactory->addUint64((*itA)->GetAuctionID() );
-            //ListID of the Auctions name
-            gMessageFactory->addUint8(static_cast<uint8>((*itA)->GetNameListID()-1));
-
-            //the Items Price
-            gMessageFactory->addUint32((*itA)->GetPrice());
-
-            //remaining time in seconds
-            uint32 time = static_cast<uint32>((*itA)->GetTime()- (getGlobalTickCount()/1000));
-            gMessageFactory->addUint32(time);
-
-            //auction or instant??
-            gMessageFactory->addUint8((*itA)->GetType());
-
-            //List Id of the auctions bazaar string
-            gMessageFactory->addUint16(static_cast<uint16>((*itA)->GetBazaarListID()-1));
-
-            //Auction Owner ID
-            gMessageFactory->addUint64((*itA)->GetOwnerID());
-
-            //Auction Owner Namestring ID - first name is nr 1
-            gMessageFactory->addUint16(static_cast<uint16>((*itA)->GetSellerListID()-1));
-
-            //Category
-            gMessageFactory->addUint32((*itA)->GetCategory());
-
-            //listplace of the highbidder
-            gMessageFactory->addUint16(static_cast<uint16>((*itA)->GetBidderListID()));
-
-
-            gMessageFactory->addUint32((*itA)->GetBid());	// high bid My High Bid!!!!
-            gMessageFactory->addUint32((*itA)->GetProxy());	// my Proxy
-            gMessageFactory->addUint32((*itA)->GetBid());	// high bid My High Bid!!!!
-
-            gMessageFactory->addUint32((*itA)->GetCategory());// item type for proper text reference
-
-
-            gMessageFactory->addUint8(0);
-            //Ok now heres our bitmask
-            //1
-            //2
-            //4 = Premium
-            //8 = shows Accept bid AND Withdraw sale on own auctions
-            uint8 bitmap = 0;
-            bitmap = (bitmap | 8);//set bit
-            if (player->getCharId() == (*itA)->GetOwnerID()) {
-                //bitmap = (bitmap | 8);//set bit 4
-                if ((*itA)->GetType() == 2) {
-                    bitmap = (bitmap ^ 8);//unset bit 4 when not for sale anymore
-                }
-            }
-            if ((*itA)->GetPremium() == 1)
-                bitmap = (bitmap | 4);//set bit 2;
-            //bitmap = (bitmap | 2);//set bit
-
-
-            //	bitmap = (bitmap | 1);//set bit
-
-
-            gMessageFactory->addUint8(bitmap);//bitmask);
-            gMessageFactory->addUint8(0);
-            gMessageFactory->addUint8(0);
-            gMessageFactory->addUint32(0);
-
-            itA++;
-        }
-
-        gMessageFactory->addUint16(static_cast<uint16>(asynContainer->Itemsstart));
-
-        uint32 pages = asynContainer->Itemsstart + static_cast<uint32>(count);
-        if ((pages-asynContainer->Itemsstart) < 100) {
-            pages = 0;
-        }
-        gMessageFactory->addUint16(static_cast<uint16>(pages));
-
-        gMessageFactory->addUint32(0);
-        gMessageFactory->addUint32(0);
-        gMessageFactory->addUint32(0);
-        gMessageFactory->addUint32(0);
-
-        gMessageFactory->addUint32(0);
-        Message* newMessage = gMessageFactory->EndMessage();
-        asynContainer->mClient->SendChannelA(newMessage, asynContainer->mClient->getAccountId(),  CR_Client, 6);
-
-        delete(auction);
-        mDatabase->destroyDataBinding(binding);
-
-    }
-    break;
-
     case TRMQuery_ProcessBidAuction:
     {
 
@@ -806,6 +649,9 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
         }
         processAuctionBid(asynContainer,player);
 
+        SAFE_DELETE(asynContainer->AuctionTemp);
+        mDatabase->destroyDataBinding(binding);
+
     }
     break;
 
@@ -831,6 +677,7 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
 
 
         AuctionItem* auctionTemp;
+        AuctionList auctions;
         uint32 count = static_cast<uint32>(result->getRowCount());
 
         for(uint32 i = 0; i < count; i++)
@@ -856,12 +703,17 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
             }
 
             processAuctionEMails(auctionTemp);
-            mAuction.push_back(auctionTemp);
+            auctions.push_back(auctionTemp);
+
+            // reindexed once sp_CommerceFindExpiredListing moved them
+            mExpiredListings.push_back(auctionTemp->ItemID);
         }
 
-        AuctionList::iterator it = mAuction.begin();
+        mDatabase->destroyDataBinding(binding);
+
+        AuctionList::iterator it = auctions.begin();
 
-        while(it != mAuction.end())
+        while(it != auctions.end())
         {
             auctionTemp = (*it);
 
@@ -888,24 +740,25 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
             if((auctionTemp->AuctionTyp == TRMVendor_Auction) && (auctionTemp->BidderID != 0))
             {
                 //set the new Owner
-                TradeManagerAsyncContainer* asyncContainer;
-
                 sprintf(sql,"UPDATE swganh.commerce_auction SET owner_id = %"PRIu64", bidder_name = '' WHERE auction_id = %"PRIu64" ",auctionTemp->BidderID,auctionTemp->ItemID);
-                asyncContainer = new TradeManagerAsyncContainer(TRMQuery_NULL,NULL);
-                mDatabase->executeSqlAsync(this,asyncContainer,sql);
-                
+                _queueCommodityWrite(TRMQuery_CommodityWrite, NULL, auctionTemp->ItemID, false, sql);
             }
 
+            SAFE_DELETE(auctionTemp);
             it++;
         }
 
         //now move the auctions in their proper holding areas or delete the ones which have expired their holding date
-        TradeManagerAsyncContainer* asyncContainer = new TradeManagerAsyncContainer(TRMQuery_NULL,NULL);
+        _queueCommodityWrite(TRMQuery_ExpiredListingDone, NULL, 0, true, "CALL sp_CommerceFindExpiredListing();");
 
-        /*sprintf(sql,"CALL sp_CommerceFindExpiredListing()");*/
-        mDatabase->executeProcedureAsync(this, asyncContainer, "CALL sp_CommerceFindExpiredListing();");
-        
+    }
+    break;
 
+    case TRMQuery_ExpiredListingDone:
+    {
+        _indexCommodities(mExpiredListings);
+        mExpiredListings.clear();
+        mCheckAuctionsQueued = false;
     }
     break;
 
@@ -977,63 +830,40 @@ void TradeManagerChatHandler::handleDatabaseJobComplete(void* ref,DatabaseResult
 
         Player* player = gChatManager->getPlayerbyId(asynContainer->BuyerID);
 
-        Bazaar* bazaarInfo = getBazaarInfo(AuctionTemp->BazaarID);
-
-        //is it an auction or an instant
-        if (AuctionTemp->AuctionTyp == 0)
-        {
-            //now get additional Information - do we have an actual high bidder? - Who is it? and
-            //what is the highbid and the highproxy
-            //_processAuctionBid(AuctionTemp,asynContainer,player);
-            TradeManagerAsyncContainer* asyncContainer;
-
-            int8 name[40],*sqlPointer;
-            sqlPointer = name;
-            sqlPointer += mDatabase->escapeString(name,AuctionTemp->bidder_name,strlen(AuctionTemp->bidder_name));
-            *sqlPointer++ = '\0';
-
-            int8 sql[390];
-            sprintf(sql,"SELECT cbh.proxy_bid, cbh.max_bid, c.id FROM swganh.characters AS c INNER JOIN swganh.commerce_bidhistory AS cbh ON c.firstname = '%s' WHERE cbh.auction_id = %"PRIu64" AND cbh.bidder_name = '",name,AuctionTemp->ItemID);
-
-            sqlPointer = sql + strlen(sql);
-            sqlPointer += mDatabase->escapeString(sqlPointer,AuctionTemp->bidder_name, strlen(AuctionTemp->bidder_name));
-            *sqlPointer++ = '\'';
-            *sqlPointer++ = '\0';
-
-            asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ProcessBidAuction,asynContainer->mClient);
-            asyncContainer->MyBid = asynContainer->MyBid;
-            asyncContainer->MyProxy = asynContainer->MyProxy;
-            asyncContainer->AuctionID = asynContainer->AuctionID;
-
-            asyncContainer->BuyerID = player->getCharId();
-            asyncContainer->BazaarID = 0;//
-            asyncContainer->AuctionTemp = AuctionTemp;
-            mDatabase->executeSqlAsync(this,asyncContainer,sql);
-            
-            break;
-        }
+        _processBid(asynContainer, AuctionTemp, player);
+    }
+    break;
 
-        if (AuctionTemp->AuctionTyp == 1)
-        {
-            //instant
-            //the client checks for the money so we will check for cheating later in the zoneserver
-            //the client sends a retrieve message hereafter so this is only to buy the item
-            //flag it as bought, change the owner and the remaining Time
-            //retrieve is send by client after that
+    case TRMQuery_NULL:
+    {
+        break;
+    }
 
-            uint32 time = (3600*24*30)+(static_cast<uint32>(getGlobalTickCount())/1000);
+    case TRMQuery_LoadCommodities:
+    {
+        _loadCommodities(result);
 
-            //let the zoneserver deal with the transaction and send the relevant Emails
-            gChatMessageLib->sendBazaarTransactionMessage(asynContainer->mClient, *AuctionTemp, player->getCharId(), time, player, bazaarInfo);
+        TradeManagerAsyncContainer* asyncContainer = new TradeManagerAsyncContainer(TRMQuery_LoadCommodityBids, 0);
+        mDatabase->executeSqlAsync(this, asyncContainer, "SELECT auction_id, bidder_name, proxy_bid, max_bid FROM swganh.commerce_bidhistory");
+    }
+    break;
 
-            SAFE_DELETE(AuctionTemp);
+    case TRMQuery_LoadCommodityBids:
+    {
+        _loadCommodityBids(result);
 
-        }
-        break;
+        mCommoditiesLoaded = true;
+        LOG(WARNING) << "Loaded " << mCommodities.size() << " commodities";
     }
+    break;
 
+    case TRMQuery_IndexCommodities:
+    {
+        _loadCommodities(result);
+    }
     break;
-    case TRMQuery_NULL:
+
+    case TRMQuery_CommodityWrite:
     {
         break;
     }
@@ -1219,6 +1049,8 @@ void TradeManagerChatHandler::processAuctionBid(TradeManagerAsyncContainer* asyn
     sqlPointer += mDatabase->escapeString(sqlPointer,player->getName().getAnsi(),player->getName().getLength());
     *sqlPointer++ = '\0';
 
+    AuctionItem* auctionTemp = asynContainer->AuctionTemp;
+
     //Check the current add depending on the price
 
     uint32 TheBid;
@@ -1240,90 +1072,80 @@ void TradeManagerChatHandler::processAuctionBid(TradeManagerAsyncContainer* asyn
         // TODO is the 20000 really clientchecked for AuctionProxies?????
     }
     //are we bidding again while already being high bidder ???
-    if (asynContainer->AuctionTemp->BidderID == player->getCharId())
+    if (auctionTemp->BidderID == player->getCharId())
     {
         //yes AND we have a new high proxy
-        if (asynContainer->MyProxy > asynContainer->AuctionTemp->HighProxy)
+        if (asynContainer->MyProxy > auctionTemp->HighProxy)
         {
-
             //just update the high proxy
-            sprintf(sql,"UPDATE commerce_bidhistory SET proxy_bid = '%"PRIu32"'WHERE auction_id = '%"PRIu64"' AND bidder_name = '%s'", asynContainer->MyProxy, asynContainer->AuctionTemp->ItemID, PlayerName);
-
-            TradeManagerAsyncContainer* asyncContainer;
-            asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ACKRetrieval,asynContainer->mClient);
-
-            asyncContainer->AuctionID = asynContainer->AuctionTemp->ItemID;
-            mDatabase->executeSqlAsync(this,asyncContainer,sql);
-            
+            mCommodities.setProxy(auctionTemp->ItemID, player->getName().getAnsi(), asynContainer->MyProxy);
 
-            return;
-        }
-        else
-        {
-            // we are bidding on our own auction but our proxy is the same
-            //dont bid ourselfes unnecessarily up
-            gChatMessageLib->sendBidAuctionResponse(asynContainer->mClient,0,asynContainer->AuctionID);
-            return;
+            sprintf(sql,"UPDATE commerce_bidhistory SET proxy_bid = '%"PRIu32"'WHERE auction_id = '%"PRIu64"' AND bidder_name = '%s'", asynContainer->MyProxy, auctionTemp->ItemID, PlayerName);
+            _queueCommodityWrite(TRMQuery_CommodityWrite, NULL, auctionTemp->ItemID, false, sql);
         }
+
+        // if our proxy is the same dont bid ourselfes unnecessarily up
+        gChatMessageLib->sendBidAuctionResponse(asynContainer->mClient,0,auctionTemp->ItemID);
+        return;
     }
 
 
     //are we bidding enough to be the high bidder????
-    if (asynContainer->MyProxy > asynContainer->AuctionTemp->HighProxy) {
+    if (asynContainer->MyProxy > auctionTemp->HighProxy) {
         //we will be the new high bidder
 
-        // Inform the client
-        //gChatMessageLib->sendBidAuctionResponse(asynContainer->mClient,0, asynContainer->AuctionTemp->ItemID);
-
         //now send the Mail to the outbid bidder
         //unless of course this is the first bid
-        if (asynContainer->AuctionTemp->BidderID != 0)
+        if (auctionTemp->BidderID != 0)
         {
-            gChatMessageLib->sendAuctionOutbidMail(asynContainer->mClient, asynContainer->AuctionTemp->BidderID,asynContainer->AuctionTemp->BidderID, asynContainer->AuctionTemp->Name);
+            gChatMessageLib->sendAuctionOutbidMail(asynContainer->mClient, auctionTemp->BidderID,auctionTemp->BidderID, auctionTemp->Name);
         }
 
         //determine the new high Bid Proxy and bidder
-        TheBid = asynContainer->AuctionTemp->HighProxy+1;
+        TheBid = auctionTemp->HighProxy+1;
 
         //make sure the Bid resembles the items price should this be the first bid
-        if(TheBid < asynContainer->AuctionTemp->Price) {
-            TheBid = asynContainer->AuctionTemp->Price;
+        if(TheBid < auctionTemp->Price) {
+            TheBid = auctionTemp->Price;
         }
 
         TheProxy = asynContainer->MyProxy;
 
+        mCommodities.setHighBid(auctionTemp->ItemID, player->getName().getAnsi(), player->getCharId(), TheBid, TheProxy);
+
+        sprintf(sql,"SELECT sf_BidAuction ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", auctionTemp->ItemID, TheBid, TheProxy, PlayerName);
+        _queueCommodityWrite(TRMQuery_CommodityWrite, NULL, auctionTemp->ItemID, false, sql);
     }
     else
     {
         //nope we didnt bid high enough :(
-        //gChatMessageLib->sendBidAuctionResponse(asynContainer->mClient,0, asynContainer->AuctionTemp->ItemID);
-
         TheBid = asynContainer->MyProxy+1;
-        if (TheBid > asynContainer->AuctionTemp->HighProxy)
-            TheBid = asynContainer->AuctionTemp->HighProxy;
+        if (TheBid > auctionTemp->HighProxy)
+            TheBid = auctionTemp->HighProxy;
+
+        TheProxy = auctionTemp->HighProxy;
 
-        TheProxy = asynContainer->AuctionTemp->HighProxy;
         int8 BidderName[40];
-        strcpy(BidderName,asynContainer->AuctionTemp->bidder_name);
+        sqlPointer = BidderName;
+        sqlPointer += mDatabase->escapeString(sqlPointer,auctionTemp->bidder_name,strlen(auctionTemp->bidder_name));
+        *sqlPointer++ = '\0';
 
         // what do we do if this is our first bid and we are NOT the high bidder?
         // sf_BidAuction only updates the bid of the high bidder
+        mCommodities.setBid(auctionTemp->ItemID, player->getName().getAnsi(), asynContainer->MyBid, asynContainer->MyProxy);
 
-        sprintf(sql,"SELECT sf_BidUpdate ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", asynContainer->AuctionTemp->ItemID, asynContainer->MyBid, asynContainer->MyProxy, PlayerName);
-        TradeManagerAsyncContainer* asyncContainer;
-        asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ACKRetrieval, asynContainer->mClient);
-        mDatabase->executeSqlAsync(this, asyncContainer, sql);
-        
+        sprintf(sql,"SELECT sf_BidUpdate ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", auctionTemp->ItemID, asynContainer->MyBid, asynContainer->MyProxy, PlayerName);
+        _queueCommodityWrite(TRMQuery_CommodityWrite, NULL, auctionTemp->ItemID, false, sql);
 
-    }
+        // the high bidder stays, only their bid goes up
+        mCommodities.setBid(auctionTemp->ItemID, auctionTemp->bidder_name, TheBid, TheProxy);
 
-    sprintf(sql,"SELECT sf_BidAuction ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", asynContainer->AuctionTemp->ItemID, TheBid, TheProxy, PlayerName);
-    TradeManagerAsyncContainer* asyncContainer;
-    asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ACKRetrieval,asynContainer->mClient);
+        sprintf(sql,"SELECT sf_BidAuction ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", auctionTemp->ItemID, TheBid, TheProxy, BidderName);
+        _queueCommodityWrite(TRMQuery_CommodityWrite, NULL, auctionTemp->ItemID, false, sql);
+    }
 
-    asyncContainer->AuctionID = asynContainer->AuctionTemp->ItemID;
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
-    
+    // the index already has the bid, the db follows through the write log
+    gChatMessageLib->sendBidAuctionResponse(asynContainer->mClient, 0, auctionTemp->ItemID);
 }
 
 //=======================================================================================================================
@@ -1361,19 +1183,21 @@ void TradeManagerChatHandler::ProcessCreateAuction(Message* message,DispatchClie
     }
 
 
-    TradeManagerAsyncContainer* asyncContainer = new TradeManagerAsyncContainer(TRMQuery_CreateAuction,client);
-    asyncContainer->AuctionID = ItemID;
-    mDatabase->executeSqlAsync(this,asyncContainer,Query);
-    
+    _queueCommodityWrite(TRMQuery_CreateAuction, client, ItemID, false, Query);
 }
 
 //=======================================================================================================================
 void TradeManagerChatHandler::processRetrieveAuctionItemMessage(Message* message,DispatchClient* client)
 {
     TradeManagerAsyncContainer* asyncContainer;
+
+    Player* player;
     PlayerAccountMap::iterator accIt = mPlayerAccountMap.find(client->getAccountId());
 
-    if(accIt != mPlayerAccountMap.end()) {
+    if(accIt != mPlayerAccountMap.end())
+        player = (*accIt).second;
+    else
+    {
 		return;
     }
 
@@ -1384,11 +1208,33 @@ void TradeManagerChatHandler::processRetrieveAuctionItemMessage(Message* message
     uint64	TerminalID	= message->getUint64();
 
     int8 sql[200];
+
+    const CommodityListing* listing = mCommodities.find(ItemID);
+    if(listing)
+    {
+        //can we retrieve the item from our terminal???
+        uint32 error = 0;
+        if (TerminalRegionbyID(TerminalID) == TerminalRegionbyID(listing->mBazaarId)) {
+            uint32 itemType = listing->mItemType;
+            mCommodities.remove(ItemID);
+
+            // Delete from commerce_auction
+            sprintf(sql,"CALL sp_BazaarAuctionDelete('%"PRIu64"');", ItemID);
+            _queueCommodityWrite(TRMQuery_DeleteAuction, NULL, ItemID, true, sql);
+
+            //send relevant info to Zoneserver for Itemcreation
+            gChatMessageLib->processSendCreateItem(client, player->getCharId(), ItemID, itemType, player->getPlanetId());
+        } else {
+            error = 1;
+        }
+        gChatMessageLib->SendRetrieveAuctionItemResponseMessage(client, ItemID, error);
+        return;
+    }
+
     sprintf(sql,"SELECT auction_id, bazaar_id, itemtype FROM swganh.commerce_auction c  WHERE c.auction_id = %"PRIu64"", ItemID);
     asyncContainer = new TradeManagerAsyncContainer(TRMQuery_RetrieveAuction, client);
     asyncContainer->BazaarID = TerminalID;
     mDatabase->executeSqlAsync(this, asyncContainer, sql);
-    
 }
 
 //=======================================================================================================================
@@ -1433,8 +1279,20 @@ void TradeManagerChatHandler::processBidAuctionMessage(Message* message,Dispatch
     else
         asyncContainer->BazaarID = 0;//
 
+    // the index has everything the bid needs
+    const CommodityListing* listing = mCommodities.find(ItemID);
+    if(listing)
+    {
+        AuctionItem* auctionTemp = new(AuctionItem);
+        _fillAuctionItem(listing, *auctionTemp, listing->mBidderName);
+
+        _processBid(asyncContainer, auctionTemp, player);
+        SAFE_DELETE(asyncContainer);
+        return;
+    }
+
     mDatabase->executeSqlAsync(this,asyncContainer,sql);
-    
+
     // client checks if we have enough money
     // cheaters (bot modified client )will be flagged in the zoneserver
 }
@@ -1442,11 +1300,9 @@ void TradeManagerChatHandler::processBidAuctionMessage(Message* message,Dispatch
 //=======================================================================================================================
 void TradeManagerChatHandler::processCancelLiveAuctionMessage(Message* message,DispatchClient* client)
 {
-    TradeManagerAsyncContainer* asyncContainer;
-
     PlayerAccountMap::iterator accIt = mPlayerAccountMap.find(client->getAccountId());
 
-    if(accIt != mPlayerAccountMap.end()) {
+    if(accIt == mPlayerAccountMap.end()) {
 		return;
     }
 
@@ -1456,11 +1312,9 @@ void TradeManagerChatHandler::processCancelLiveAuctionMessage(Message* message,D
     //get all the bids on the auction and refunf the affected players
     //send the EMails
     int8 sql[300];
+    //goes through the write log so it sees the bids still waiting there
     sprintf(sql,"SELECT ch.id, ca.name, cbh.proxy_bid FROM swganh.commerce_auction AS ca INNER JOIN swganh.commerce_bidhistory AS cbh ON (cbh.bidder_name = ca.bidder_name)  INNER JOIN swganh.characters AS ch ON (cbh.bidder_name = ch.firstname)  WHERE ca.auction_id = %"PRIu64"",ItemID);
-    asyncContainer = new TradeManagerAsyncContainer(TRMQuery_CancelAuction_BidderMail, client);
-    asyncContainer->AuctionID = ItemID;
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
-    
+    _queueCommodityWrite(TRMQuery_CancelAuction_BidderMail, client, ItemID, false, sql);
 }
 
 //=======================================================================================================================
@@ -1487,13 +1341,6 @@ void TradeManagerChatHandler::processGetAuctionDetails(Message* message,Dispatch
 //=======================================================================================================================
 void TradeManagerChatHandler::processHandleopAuctionQueryHeadersMessage(Message* message,DispatchClient* client)
 {
-    TradeManagerAsyncContainer* asyncContainer;
-
-    //uint64 time = (getGlobalTickCount()/1000);
-
-    int8 sql[2024];
-    sprintf(sql,"SELECT c.auction_id, owner_id, c.bazaar_id, type, start, premium, category, itemtype, price, name, description, c.region_id, c.bidder_name, c.planet_id, firstname, bazaar_string, cbh.proxy_bid, cbh.max_bid FROM swganh.commerce_auction c INNER JOIN swganh.characters ch on (c.owner_id = ch.id) INNER join swganh.commerce_bazaar cb ON (cb.bazaar_id = c.bazaar_id) left join swganh.commerce_bidhistory cbh ON (cbh.bidder_name = c.bidder_name AND cbh.auction_id = c.auction_id) AND c.owner_id = ch.id  WHERE");
-
     Player* player;
     PlayerAccountMap::iterator accIt = mPlayerAccountMap.find(client->getAccountId());
 
@@ -1524,192 +1371,48 @@ void TradeManagerChatHandler::processHandleopAuctionQueryHeadersMessage(Message*
     query.start = message->getUint16();//nr of 1st auction to show
 
 
-    // build our db Query
-
-    // the region to display
-
-    switch(query.Region)
-    {
-    case TRMVendor:
-    {
-        sprintf(query.RegionQuery," (c.bazaar_id = %"PRIu64")",query.vendorID);
-
-    }
-    break;
-
-    case TRMRegion:
-    {
-        //for now Planet
-        sprintf(query.RegionQuery," (c.region_id = %"PRIu32")",TerminalRegionbyID(query.vendorID));
-    }
-    break;
-
-    case TRMPlanet:
-    {
-        sprintf(query.RegionQuery," (c.planet_id = %"PRIu32")",player->getPlanetId());
-
-    }
-    break;
-
-    case TRMGalaxy:
-    {
-        sprintf(query.RegionQuery," (c.planet_id >= 0)");
-
-    }
-    default:
-        sprintf(query.RegionQuery," ");
-    }
-
-    //need new table for bidding ??
-
-    // the kind of "hopper" to display auction hopper or stockroom or ownauctions or offers
-
-    switch (query.Windowtype)
+    // everything is answered from the commodities index, the db is not involved
+
+    CommoditySearch search;
+    search.mRegionType	= query.Region;
+    search.mBazaarId	= query.vendorID;
+    search.mRegionId	= (query.Region == TRMRegion) ? TerminalRegionbyID(query.vendorID) : 0;
+    search.mPlanetId	= player->getPlanetId();
+    search.mWindow		= query.Windowtype;
+    search.mCharId		= player->getCharId();
+    search.mCharName	= player->getName().getAnsi();
+    search.mCategory	= query.Category;
+    search.mItemType	= query.ItemTyp;
+    search.mMinPrice	= query.minprice;
+    search.mMaxPrice	= query.maxprice;
+    search.mNow			= getGlobalTickCount() / 1000;
+    search.mStart		= query.start;
+    search.mCount		= 100;
+
+    CommodityResultList results;
+    mCommodities.search(search, results);
+
+    //in my bids the bid and proxy shown are our own ones
+    const int8* bidderName = NULL;
+    if(query.Windowtype == TRMVendor_MyBids)
+        bidderName = search.mCharName;
+
+    AuctionClass* auction = new AuctionClass();
+    AuctionItem auctionTemp;
+
+    CommodityResultList::iterator it = results.begin();
+    while(it != results.end())
     {
-    case TRMVendor_AllAuctions: //open up bazaar and look at it without a category
-    {
-        sprintf(query.WindowQuery," ((c.type = %"PRIu32") or (c.type = %"PRIu32"))", TRMVendor_Auction, TRMVendor_Instant);
-
-    }
-    break;
-
-    case TRMVendor_MySales: //what Im selling at the bazaar
-    {
-        sprintf(query.WindowQuery," ((c.type = %"PRIu32") or (c.type = %"PRIu32"))AND", TRMVendor_Auction, TRMVendor_Instant);
-        int8 tmp[128];
-        sprintf(tmp," (c.owner_id = %"PRIu64")",player->getCharId());
-        strcat(query.WindowQuery,tmp);
-
-    }
-    break;
-
-    case TRMVendor_MyBids: //auctions Im bidding on currently at the bazaar
-    {
-        //sprintf(query.WindowQuery," ((c.type = %u) or (c.type = %u)) AND",TRMVendor_Auction,TRMVendor_Instant);
-        //int8 tmp[128];
-        //sprintf(tmp," (cbh.bidder_name = %s)",player->getName().getAnsi());
-        //strcat(query.WindowQuery,tmp);
-        //sprintf(sql,"SELECT c.auction_id, owner_id, c.bazaar_id, type, start, premium, category, itemtype, price, name, description, c.region_id, c.bidder_name, c.planet_id, firstname, bazaar_string, cbh.proxy_bid, cbh.max_bid FROM swganh.commerce_auction c INNER JOIN swganh.characters ch on (c.owner_id = ch.id) INNER join swganh.commerce_bazaar cb ON (cb.bazaar_id = c.bazaar_id) inner join swganh.commerce_bidhistory cbh ON (cbh.auction_id = c.auction_id) AND c.owner_id = ch.id WHERE");
-
-        sprintf(query.WindowQuery," ((c.type = %"PRIu32") or (c.type = %"PRIu32")) AND",TRMVendor_Auction,TRMVendor_Instant);
-        int8 tmp[128],end[128],*sqlPointer;
-        sprintf(tmp," (cbh.bidder_name = '");
-        sqlPointer = tmp + strlen(tmp);
-        sqlPointer += mDatabase->escapeString(sqlPointer,player->getName().getAnsi(),player->getName().getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = '\0';
-        strcat(query.WindowQuery,tmp);
-        sprintf(end," )");
-        strcat(query.WindowQuery,end);
-        sprintf(sql,"SELECT c.auction_id, owner_id, c.bazaar_id, type, start, premium, category, itemtype, price, name, description, c.region_id, c.bidder_name, c.planet_id, firstname, bazaar_string, cbh.proxy_bid, cbh.max_bid FROM swganh.commerce_auction c INNER JOIN swganh.characters ch on (c.owner_id = ch.id) INNER join swganh.commerce_bazaar cb ON (cb.bazaar_id = c.bazaar_id) inner join swganh.commerce_bidhistory cbh ON (cbh.auction_id = c.auction_id) AND c.owner_id = ch.id WHERE");
-
-    }
-    break;
-    case TRMVendor_AvailableItems:
-    {
-        sprintf(query.WindowQuery," (c.type = %"PRIu32") AND (c.owner_id = %"PRIu64") ",TRMVendor_Ended,player->getCharId());
-
-
-    }
-    break;
-    case TRMVendor_Offers:
-    {
-        sprintf(query.WindowQuery," (c.type = %"PRIu32") AND (c.bidder_name = %s) AND (c.bazaar_id = %"PRIu64")",TRMVendor_Offer,player->getName().getAnsi(),query.vendorID);
-
-
-    }
-    break;
-    case TRMVendor_ForSale:
-    {
-        sprintf(query.WindowQuery," ((c.type = %"PRIu32") or (c.type = %"PRIu32")) AND",TRMVendor_Auction,TRMVendor_Instant);
-        int8 tmp[128],end[128],*sqlPointer;
-        sprintf(tmp," (c.bidder_name = '");
-        sqlPointer = tmp + strlen(tmp);
-        sqlPointer += mDatabase->escapeString(sqlPointer,player->getName().getAnsi(),player->getName().getLength());
-        *sqlPointer++ = '\'';
-        *sqlPointer++ = '\0';
-        strcat(query.WindowQuery,tmp);
-        sprintf(end," ) AND");
-        strcat(query.WindowQuery,end);
-
-        sprintf(tmp," (c.bazaar_id = %"PRIu64")",query.vendorID);
-        strcat(query.WindowQuery,tmp);
-    }
-    break;
-    default:
-        sprintf(query.WindowQuery," ");
-    }
-
-    uint32 category;
-    category = query.Category;
-    //Were looking for a main category
-
-    if (category != 0)
-    {
-        if ((category << 24) == 0)
-        {
-            sprintf(query.CategoryQuery," ((c.category >> 8) = %"PRIu32")",(query.Category >> 8));
-
-        }
-        else
-        {
-            //were looking for a subcategory
-            sprintf(query.CategoryQuery," ((c.category) = %"PRIu32")",query.Category );
-        }
+        _fillAuctionItem((*it), auctionTemp, bidderName ? bidderName : (*it)->mBidderName);
+        auction->AddAuction(auctionTemp);
+        ++it;
     }
-    else sprintf(query.CategoryQuery," ");
 
-    if (query.ItemTyp != 0) {
-        sprintf(query.ItemTypQuery," (c.itemtype = %"PRIu32")",query.ItemTyp);
-    }
-    else
-        sprintf(query.ItemTypQuery," ");
-
-    int8 Limit[64];
-    uint32 StopTime;
-    StopTime = (static_cast<uint32>(getGlobalTickCount()) / 1000);
-    sprintf(Limit," AND (c.start > %"PRIu32") LIMIT %u, %u", StopTime,query.start, query.start+100);
-
-    //region or bazaar id
-
-    strcat(sql,query.RegionQuery); //
-    bool add = false;
-
-    if (strcmp(query.RegionQuery," ") != 0)
-        add = true;
-
-    if (strcmp(query.WindowQuery, " ") != 0) {
-        if (add == true)
-            strcat(sql," AND ");
-        add = true;
-    }
-    strcat(sql,query.WindowQuery);
-
-    if (strcmp(query.CategoryQuery, " ") !=0 ) {
-        if (add == true)
-            strcat(sql," AND ");
-        add = true;
-    }
-
-    strcat(sql,query.CategoryQuery); //
-
-    if (strcmp(query.ItemTypQuery, " ") !=0 ) {
-        if (add == true)
-            strcat(sql," AND ");
-        add = true;
-    }
-
-    strcat(sql,query.ItemTypQuery); //
-    strcat(sql,Limit); //
-
-    asyncContainer = new TradeManagerAsyncContainer(TRMQuery_AuctionQuery,client);
     div_t d;
     d = div(query.start,100);
-    asyncContainer->BazaarPage = d.quot+1 ;
-    asyncContainer->BazaarWindow = query.Windowtype;
-    asyncContainer->Itemsstart = query.start;
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
-    
+    _sendAuctionQueryHeaders(client, player, auction, d.quot+1, query.Windowtype, query.start);
+
+    delete(auction);
 }
 
 //=======================================================================================================================
@@ -1830,10 +1533,17 @@ void TradeManagerChatHandler::handleGlobalTickPreserve()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void TradeManagerChatHandler::handleCheckAuctions()
 {
-    TradeManagerAsyncContainer* asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ExpiredListing, NULL);
+    // the last pass is still on its way through the write log
+    if(mCheckAuctionsQueued)
+        return;
+
+    mCheckAuctionsQueued = true;
+
+    // queued behind the pending bids, so the winners are the ones the index has
+    int8 sql[64];
     uint32 time = static_cast<uint32>(getGlobalTickCount());
-    mDatabase->executeProcedureAsync(this, asyncContainer, "CALL sp_BazaarAuctionFindExpired(%"PRIu32");", time/1000);
-    
+    sprintf(sql, "CALL sp_BazaarAuctionFindExpired(%"PRIu32");", time/1000);
+    _queueCommodityWrite(TRMQuery_ExpiredListing, NULL, 0, true, sql);
 }
 
 //=======================================================================================================================
@@ -1937,3 +1647,387 @@ void TradeManagerChatHandler::ProcessBankTip(Message* message,DispatchClient* cl
 
 }
 
+
+//=======================================================================================================================
+//
+// commodities index
+//
+
+void TradeManagerChatHandler::_loadCommodities(DatabaseResult* result)
+{
+    DataBinding* binding = mDatabase->createDataBinding(16);
+    binding->addField(DFT_uint64,offsetof(CommodityListing,mId),8,0);
+    binding->addField(DFT_uint64,offsetof(CommodityListing,mOwnerId),8,1);
+    binding->addField(DFT_uint64,offsetof(CommodityListing,mBazaarId),8,2);
+    binding->addField(DFT_uint64,offsetof(CommodityListing,mBidderId),8,3);
+    binding->addField(DFT_uint64,offsetof(CommodityListing,mEndTime),8,4);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mType),4,5);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mPremium),4,6);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mCategory),4,7);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mItemType),4,8);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mPrice),4,9);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mRegionId),4,10);
+    binding->addField(DFT_uint32,offsetof(CommodityListing,mPlanetId),4,11);
+    binding->addField(DFT_string,offsetof(CommodityListing,mName),128,12);
+    binding->addField(DFT_string,offsetof(CommodityListing,mSellerName),32,13);
+    binding->addField(DFT_string,offsetof(CommodityListing,mBazaarName),128,14);
+    binding->addField(DFT_string,offsetof(CommodityListing,mBidderName),32,15);
+
+    CommodityListing listing;
+    uint64 count = result->getRowCount();
+
+    for(uint64 i = 0; i < count; i++)
+    {
+        result->getNextRow(binding,&listing);
+        mCommodities.add(listing);
+    }
+
+    mDatabase->destroyDataBinding(binding);
+}
+
+//=======================================================================================================================
+
+void TradeManagerChatHandler::_loadCommodityBids(DatabaseResult* result)
+{
+    struct BidRow
+    {
+        uint64	auctionId;
+        int8	name[32];
+        uint32	proxy;
+        uint32	maxBid;
+    };
+
+    DataBinding* binding = mDatabase->createDataBinding(4);
+    binding->addField(DFT_uint64,offsetof(BidRow,auctionId),8,0);
+    binding->addField(DFT_string,offsetof(BidRow,name),32,1);
+    binding->addField(DFT_uint32,offsetof(BidRow,proxy),4,2);
+    binding->addField(DFT_uint32,offsetof(BidRow,maxBid),4,3);
+
+    BidRow row;
+    uint64 count = result->getRowCount();
+
+    for(uint64 i = 0; i < count; i++)
+    {
+        result->getNextRow(binding,&row);
+        mCommodities.setBid(row.auctionId, row.name, row.maxBid, row.proxy);
+    }
+
+    mDatabase->destroyDataBinding(binding);
+}
+
+//=======================================================================================================================
+//
+// drops the listings and reads back whatever the db has for them now
+//
+
+void TradeManagerChatHandler::_indexCommodities(const std::vector<uint64>& ids)
+{
+    int8 sql[8192];
+    uint32 length = 0;
+    uint32 batch = 0;
+
+    std::vector<uint64>::const_iterator it = ids.begin();
+    while(it != ids.end())
+    {
+        mCommodities.remove(*it);
+
+        if(!batch)
+            length = sprintf(sql, "%s WHERE c.auction_id IN (%"PRIu64, CommoditiesSelect, *it);
+        else
+            length += sprintf(sql + length, ",%"PRIu64, *it);
+
+        ++it;
+
+        if(++batch == 200 || it == ids.end())
+        {
+            sprintf(sql + length, ")");
+
+            TradeManagerAsyncContainer* asyncContainer = new TradeManagerAsyncContainer(TRMQuery_IndexCommodities, 0);
+            mDatabase->executeSqlAsync(this, asyncContainer, sql);
+            batch = 0;
+        }
+    }
+}
+
+//=======================================================================================================================
+//
+// the bid and proxy shown are the ones of bidderName
+//
+
+void TradeManagerChatHandler::_fillAuctionItem(const CommodityListing* listing, AuctionItem& item, const int8* bidderName) const
+{
+    item.ItemID		= listing->mId;
+    item.OwnerID	= listing->mOwnerId;
+    item.BazaarID	= listing->mBazaarId;
+    item.BidderID	= listing->mBidderId;
+    item.AuctionTyp	= listing->mType;
+    item.EndTime	= listing->mEndTime;
+    item.Premium	= listing->mPremium;
+    item.Category	= listing->mCategory;
+    item.ItemTyp	= listing->mItemType;
+    item.Price		= listing->mPrice;
+    item.RegionID	= static_cast<uint16>(listing->mRegionId);
+    item.PlanetID	= static_cast<uint16>(listing->mPlanetId);
+
+    strcpy(item.Name, listing->mName);
+    strcpy(item.SellerName, listing->mSellerName);
+    strcpy(item.Owner, listing->mSellerName);
+    strcpy(item.BazaarName, listing->mBazaarName);
+    strcpy(item.bidder_name, listing->mBidderName);
+
+    item.HighBid = 0;
+    item.HighProxy = 0;
+
+    const CommodityBid* bid = mCommodities.getBid(listing->mId, bidderName);
+    if(bid)
+    {
+        item.HighBid = bid->mMaxBid;
+        item.HighProxy = bid->mProxy;
+    }
+}
+
+//=======================================================================================================================
+
+void TradeManagerChatHandler::_sendAuctionQueryHeaders(DispatchClient* client, Player* player, AuctionClass* auction, uint32 page, uint32 window, uint32 start)
+{
+    gMessageFactory->StartMessage();
+    gMessageFactory->addUint32(opAuctionQueryHeadersResponseMessage);
+
+    gMessageFactory->addUint32(page);//
+    gMessageFactory->addUint32(window);
+    //total of unique Terminals and unique sellers per terminal
+    //so here goes the total nr of strings
+    gMessageFactory->addUint32(auction->getStringCount());
+    ListStringList::iterator itL = auction->mListStringList.begin();
+    //that are all bazaars, sellers and bidders
+    while(itL != auction->mListStringList.end())
+    {
+        gMessageFactory->addString((*itL)->GetString());
+        itL++;
+    }
+
+    //Nr of unique Auction Names (no auction name more than once)
+    gMessageFactory->addUint32(auction->NameStringCount);
+
+    BString s;
+    NameStringList::iterator itD = auction->mNameStringList.begin();
+    while(itD != auction->mNameStringList.end())
+    {
+        s = (*itD)->GetName();
+        s.convert(BSTRType_Unicode16);
+        gMessageFactory->addString(s);
+        itD++;
+    }
+
+    //finally here the total Nr of auctions
+    gMessageFactory->addUint32(auction->AuctionStringCount);
+    AuctionStringList::iterator itA = auction->mAuctionStringList.begin();
+    while(itA != auction->mAuctionStringList.end())
+    {
+
+        //Item/AuctionID
+        gMessageFactory->addUint64((*itA)->GetAuctionID() );
+        //ListID of the Auctions name
+        gMessageFactory->addUint8(static_cast<uint8>((*itA)->GetNameListID()-1));
+
+        //the Items Price
+        gMessageFactory->addUint32((*itA)->GetPrice());
+
+        //remaining time in seconds
+        uint32 time = static_cast<uint32>((*itA)->GetTime()- (getGlobalTickCount()/1000));
+        gMessageFactory->addUint32(time);
+
+        //auction or instant??
+        gMessageFactory->addUint8((*itA)->GetType());
+
+        //List Id of the auctions bazaar string
+        gMessageFactory->addUint16(static_cast<uint16>((*itA)->GetBazaarListID()-1));
+
+        //Auction Owner ID
+        gMessageFactory->addUint64((*itA)->GetOwnerID());
+
+        //Auction Owner Namestring ID - first name is nr 1
+        gMessageFactory->addUint16(static_cast<uint16>((*itA)->GetSellerListID()-1));
+
+        //Category
+        gMessageFactory->addUint32((*itA)->GetCategory());
+
+        //listplace of the highbidder
+        gMessageFactory->addUint16(static_cast<uint16>((*itA)->GetBidderListID()));
+
+
+        gMessageFactory->addUint32((*itA)->GetBid());	// high bid My High Bid!!!!
+        gMessageFactory->addUint32((*itA)->GetProxy());	// my Proxy
+        gMessageFactory->addUint32((*itA)->GetBid());	// high bid My High Bid!!!!
+
+        gMessageFactory->addUint32((*itA)->GetCategory());// item type for proper text reference
+
+
+        gMessageFactory->addUint8(0);
+        //Ok now heres our bitmask
+        //1
+        //2
+        //4 = Premium
+        //8 = shows Accept bid AND Withdraw sale on own auctions
+        uint8 bitmap = 0;
+        bitmap = (bitmap | 8);//set bit
+        if (player->getCharId() == (*itA)->GetOwnerID()) {
+            //bitmap = (bitmap | 8);//set bit 4
+            if ((*itA)->GetType() == 2) {
+                bitmap = (bitmap ^ 8);//unset bit 4 when not for sale anymore
+            }
+        }
+        if ((*itA)->GetPremium() == 1)
+            bitmap = (bitmap | 4);//set bit 2;
+        //bitmap = (bitmap | 2);//set bit
+
+
+        //	bitmap = (bitmap | 1);//set bit
+
+
+        gMessageFactory->addUint8(bitmap);//bitmask);
+        gMessageFactory->addUint8(0);
+        gMessageFactory->addUint8(0);
+        gMessageFactory->addUint32(0);
+
+        itA++;
+    }
+
+    gMessageFactory->addUint16(static_cast<uint16>(start));
+
+    uint32 pages = start + auction->AuctionStringCount;
+    if ((pages-start) < 100) {
+        pages = 0;
+    }
+    gMessageFactory->addUint16(static_cast<uint16>(pages));
+
+    gMessageFactory->addUint32(0);
+    gMessageFactory->addUint32(0);
+    gMessageFactory->addUint32(0);
+    gMessageFactory->addUint32(0);
+
+    gMessageFactory->addUint32(0);
+    Message* newMessage = gMessageFactory->EndMessage();
+    client->SendChannelA(newMessage, client->getAccountId(),  CR_Client, 6);
+}
+
+//=======================================================================================================================
+
+void TradeManagerChatHandler::_processBid(TradeManagerAsyncContainer* asynContainer, AuctionItem* AuctionTemp, Player* player)
+{
+    Bazaar* bazaarInfo = getBazaarInfo(AuctionTemp->BazaarID);
+
+    //is it an auction or an instant
+    if (AuctionTemp->AuctionTyp == TRMVendor_Auction)
+    {
+        //do we have an actual high bidder? - Who is it? and what is the highbid and the highproxy
+        const CommodityListing* listing = mCommodities.find(AuctionTemp->ItemID);
+        if(listing)
+        {
+            const CommodityBid* bid = mCommodities.getBid(listing->mId, listing->mBidderName);
+
+            AuctionTemp->HighBid = 0;
+            AuctionTemp->HighProxy = 0;
+            AuctionTemp->BidderID = 0;
+            if(bid)
+            {
+                AuctionTemp->HighBid = bid->mMaxBid;
+                AuctionTemp->HighProxy = bid->mProxy;
+                AuctionTemp->BidderID = listing->mBidderId;
+            }
+
+            asynContainer->AuctionTemp = AuctionTemp;
+            processAuctionBid(asynContainer, player);
+
+            SAFE_DELETE(AuctionTemp);
+            return;
+        }
+
+        //not indexed yet, ask the db
+        TradeManagerAsyncContainer* asyncContainer;
+
+        int8 name[40],*sqlPointer;
+        sqlPointer = name;
+        sqlPointer += mDatabase->escapeString(name,AuctionTemp->bidder_name,strlen(AuctionTemp->bidder_name));
+        *sqlPointer++ = '\0';
+
+        int8 sql[390];
+        sprintf(sql,"SELECT cbh.proxy_bid, cbh.max_bid, c.id FROM swganh.characters AS c INNER JOIN swganh.commerce_bidhistory AS cbh ON c.firstname = '%s' WHERE cbh.auction_id = %"PRIu64" AND cbh.bidder_name = '",name,AuctionTemp->ItemID);
+
+        sqlPointer = sql + strlen(sql);
+        sqlPointer += mDatabase->escapeString(sqlPointer,AuctionTemp->bidder_name, strlen(AuctionTemp->bidder_name));
+        *sqlPointer++ = '\'';
+        *sqlPointer++ = '\0';
+
+        asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ProcessBidAuction,asynContainer->mClient);
+        asyncContainer->MyBid = asynContainer->MyBid;
+        asyncContainer->MyProxy = asynContainer->MyProxy;
+        asyncContainer->AuctionID = asynContainer->AuctionID;
+
+        asyncContainer->BuyerID = player->getCharId();
+        asyncContainer->BazaarID = 0;//
+        asyncContainer->AuctionTemp = AuctionTemp;
+        mDatabase->executeSqlAsync(this,asyncContainer,sql);
+        return;
+    }
+
+    if (AuctionTemp->AuctionTyp == TRMVendor_Instant)
+    {
+        //instant
+        //the client checks for the money so we will check for cheating later in the zoneserver
+        //the client sends a retrieve message hereafter so this is only to buy the item
+        //flag it as bought, change the owner and the remaining Time
+        //retrieve is send by client after that
+
+        uint32 time = (3600*24*30)+(static_cast<uint32>(getGlobalTickCount())/1000);
+
+        //let the zoneserver deal with the transaction and send the relevant Emails
+        gChatMessageLib->sendBazaarTransactionMessage(asynContainer->mClient, *AuctionTemp, player->getCharId(), time, player, bazaarInfo);
+
+        //the zone writes the new owner, take it off sale here right away
+        mCommodities.setSold(AuctionTemp->ItemID, player->getCharId(), player->getName().getAnsi(), TRMVendor_Cancelled, time);
+    }
+
+    SAFE_DELETE(AuctionTemp);
+}
+
+//=======================================================================================================================
+
+void TradeManagerChatHandler::_queueCommodityWrite(TRMQueryType queryType, DispatchClient* client, uint64 auctionId, bool procedure, const int8* sql)
+{
+    CommodityWrite write;
+    write.mQueryType = queryType;
+    write.mClient = client;
+    write.mAuctionId = auctionId;
+    write.mProcedure = procedure;
+    write.mSql = sql;
+
+    mCommodityWrites.push_back(write);
+
+    _writeNextCommodity();
+}
+
+//=======================================================================================================================
+
+void TradeManagerChatHandler::_writeNextCommodity()
+{
+    if(mCommodityWriteInFlight || mCommodityWrites.empty())
+        return;
+
+    const CommodityWrite& write = mCommodityWrites.front();
+
+    TradeManagerAsyncContainer* asyncContainer = new TradeManagerAsyncContainer(write.mQueryType, write.mClient);
+    asyncContainer->AuctionID = write.mAuctionId;
+    asyncContainer->writeLog = true;
+
+    // names and descriptions may carry a %
+    if(write.mProcedure)
+        mDatabase->executeProcedureAsync(this, asyncContainer, "%s", write.mSql.c_str());
+    else
+        mDatabase->executeSqlAsyncNoArguments(this, asyncContainer, write.mSql.c_str());
+
+    mCommodityWriteInFlight = true;
+    mCommodityWrites.pop_front();
+}
+
+//=======================================================================================================================
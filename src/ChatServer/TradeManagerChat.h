@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "ChatManager.h"
 #include "ChatMessageLib.h"
+#include "CommoditiesIndex.h"
 #include "TradeManagerHelp.h"
 
 #include "DatabaseManager/DatabaseCallback.h"
@@ -38,7 +39,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <boost/thread/mutex.hpp>
 
+#include <deque>
 #include <queue>
+#include <string>
 #include <vector>
 
 #if defined(__GNUC__)
@@ -73,6 +76,22 @@ typedef std::vector<Bazaar*>		BazaarList;
 typedef std::vector<std::tr1::shared_ptr<Timer> > TimerList;
 typedef std::vector<AuctionItem*>	AuctionList;
 
+//======================================================================================================================
+//
+// a commerce write that is already applied to the commodities index and waits for its turn at the db
+//
+
+struct CommodityWrite
+{
+    TRMQueryType		mQueryType;
+    DispatchClient*		mClient;
+    uint64				mAuctionId;
+    bool				mProcedure;
+    std::string			mSql;
+};
+
+typedef std::deque<CommodityWrite>	CommodityWriteLog;
+
 //======================================================================================================================
 
 class TradeManagerChatHandler : public DatabaseCallback, public TimerCallback
@@ -123,6 +142,18 @@ private:
     void				ProcessBankTip(Message* message,DispatchClient* client);
     void				processAuctionEMails(AuctionItem* AuctionTemp);
 
+    // commodities index
+    void				_loadCommodities(DatabaseResult* result);
+    void				_loadCommodityBids(DatabaseResult* result);
+    void				_indexCommodities(const std::vector<uint64>& ids);
+    void				_fillAuctionItem(const CommodityListing* listing, AuctionItem& item, const int8* bidderName) const;
+    void				_sendAuctionQueryHeaders(DispatchClient* client, Player* player, AuctionClass* auction, uint32 page, uint32 window, uint32 start);
+    void				_processBid(TradeManagerAsyncContainer* asynContainer, AuctionItem* auctionTemp, Player* player);
+
+    // every commerce write is applied to the index first and then goes to the db in order, one at a time
+    void				_queueCommodityWrite(TRMQueryType queryType, DispatchClient* client, uint64 auctionId, bool procedure, const int8* sql);
+    void				_writeNextCommodity();
+
     // process chat timers
     void				handleGlobalTickPreserve();
     void				processTimerEvents();
@@ -137,8 +168,6 @@ private:
     BazaarList					mBazaars;
     AttributesList				mAtrributesList;
 
-    AuctionClass*				auction;
-
     ListStringStruct*			ListStringHandler;
     ListStringList				mListStringList;
 
@@ -158,8 +187,12 @@ private:
     uint64						mTimerQueueProcessTimeLimit;
     uint32						mBazaarMaxBid;
 
-    AuctionList					mAuction;
-
+    CommoditiesIndex			mCommodities;
+    bool						mCommoditiesLoaded;
+    CommodityWriteLog			mCommodityWrites;
+    bool						mCommodityWriteInFlight;
+    bool						mCheckAuctionsQueued;
+    std::vector<uint64>			mExpiredListings;
 
 
 };
@@ -113,18 +113,10 @@ struct ListStringStruct
 struct Query
 {
     uint32 Region;
-    int8   RegionQuery[128];
-
     uint32 UpdateCounter;
     uint32 Windowtype;
-    int8   WindowQuery[256];
-
     uint32 Category;
-    int8   CategoryQuery[128];
-
     uint32 ItemTyp;
-    int8   ItemTypQuery[64];
-
     BString searchstring;
     uint32 unknown;
     uint32 minprice;
@@ -188,7 +180,12 @@ enum TRMQueryType
     TRMQuery_GetAttributeDetails		= 19,
     TRMQuery_ProcessBidAuction			= 20,
     TRMQuery_ProcessAuctionRefund		= 21,
-    TRMQuery_GetResAttributeDetails		= 22
+    TRMQuery_GetResAttributeDetails		= 22,
+    TRMQuery_LoadCommodities			= 23,
+    TRMQuery_LoadCommodityBids			= 24,
+    TRMQuery_IndexCommodities			= 25,
+    TRMQuery_CommodityWrite				= 26,
+    TRMQuery_ExpiredListingDone			= 27
 };
 
 struct AuctionItem
@@ -239,6 +236,7 @@ public:
     TradeManagerAsyncContainer(TRMQueryType qt,DispatchClient* client) {
         mQueryType = qt;
         mClient = client;
+        writeLog = false;
     }
     ~TradeManagerAsyncContainer() {}
 
@@ -251,6 +249,7 @@ public:
 
     TRMQueryType		mQueryType;
     DispatchClient*		mClient;
+    bool				writeLog;	// issued from the commodities write log
 
     uint64				AuctionID;
     uint32				BazaarWindow;
@@ -0,0 +1,195 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "ChatServer/Channel.h"
+#include "ChatServer/ChatAvatarId.h"
+#include "ChatServer/ChatMessageLib.h"
+#include "ChatServer/ChatOpcodes.h"
+#include "ChatServer/Player.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <gtest/gtest.h>
+
+#include "NetworkManager/DispatchClient.h"
+#include "NetworkManager/Message.h"
+#include "NetworkManager/MessageFactory.h"
+#include "Utils/clock.h"
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+// Takes the place of the connection server, keeps the first payload it gets
+// and drops every message the way the network layer would once it is sent.
+class CountingClient : public DispatchClient {
+public:
+    CountingClient() : messages_(0) {}
+
+    void SendChannelA(Message* message, uint32 account_id, uint8 server_id, uint8 priority) {
+        if (!messages_++) {
+            payload_.assign(message->getData(), message->getData() + message->getSize());
+        }
+        gMessageFactory->DestroyMessage(message);
+    }
+
+    uint32_t messages() const { return messages_; }
+    const std::vector<int8>& payload() const { return payload_; }
+
+private:
+    uint32_t messages_;
+    std::vector<int8> payload_;
+};
+
+class ChatRoomTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        Anh_Utils::Clock::Init();
+        MessageFactory::Init(64 * 1024 * 1024);
+        message_lib_ = new ChatMessageLib(NULL);
+        channel_.setId(42);
+    }
+
+    virtual void TearDown() {
+        for (uint32_t i = 0; i < avatars_.size(); ++i) {
+            delete avatars_[i];
+            delete players_[i];
+            delete clients_[i];
+        }
+        delete message_lib_;
+        MessageFactory::destroySingleton();
+    }
+
+    Player* AddMember(const std::string& name, uint32_t ignores) {
+        CountingClient* client = new CountingClient();
+        Player* player = new Player(players_.size() + 1, client, 0);
+        player->setName(BString(name.c_str()));
+
+        for (uint32_t i = 0; i < ignores; ++i) {
+            char ignored[32];
+            sprintf(ignored, "ignored%u", static_cast<uint32_t>(rand() % 100000));
+            player->addIgnore(BString(ignored));
+        }
+
+        ChatAvatarId* avatar = new ChatAvatarId();
+        avatar->setPlayer(player);
+        channel_.addUser(avatar);
+
+        clients_.push_back(client);
+        players_.push_back(player);
+        avatars_.push_back(avatar);
+
+        return player;
+    }
+
+    // A chat line as it was sent before the line was built once per room:
+    // encoded again for every member, ignores looked up in the std::map.
+    void SendPerMemberLine(const BString& sender, const BString& message) {
+        uint32 sender_crc = sender.getCrc();
+
+        ChatAvatarIdList::iterator it = channel_.getUserList()->begin();
+        while (it != channel_.getUserList()->end()) {
+            const ContactMap* ignores = (*it)->getPlayer()->getIgnoreList();
+
+            if (ignores->find(sender_crc) == ignores->end()) {
+                DispatchClient* client = (*it)->getPlayer()->getClient();
+
+                gMessageFactory->StartMessage();
+                gMessageFactory->addUint32(opChatRoomMessage);
+                gMessageFactory->addString(SWG);
+                gMessageFactory->addString(BString("galaxy"));
+                gMessageFactory->addString(sender);
+                gMessageFactory->addUint32(channel_.getId());
+                gMessageFactory->addString(message);
+                gMessageFactory->addUint32(0);
+                client->SendChannelA(gMessageFactory->EndMessage(), client->getAccountId(), CR_Client, 5);
+            }
+            ++it;
+        }
+    }
+
+    ChatMessageLib* message_lib_;
+    Channel channel_;
+    std::vector<CountingClient*> clients_;
+    std::vector<Player*> players_;
+    std::vector<ChatAvatarId*> avatars_;
+};
+
+TEST_F(ChatRoomTest, LineReachesEveryMemberNotIgnoringTheSender) {
+    for (uint32_t i = 0; i < 10; ++i) {
+        char name[32];
+        sprintf(name, "member%u", i);
+        AddMember(name, 3);
+    }
+    players_[4]->addIgnore(BString("sender"));
+
+    BString message(L"hello there");
+    message_lib_->sendChatRoomMessage(&channel_, BString("galaxy"), BString("Sender"), message);
+
+    for (uint32_t i = 0; i < clients_.size(); ++i) {
+        EXPECT_EQ(i == 4 ? 0u : 1u, clients_[i]->messages());
+    }
+}
+
+TEST_F(ChatRoomTest, EveryMemberGetsTheSamePayload) {
+    AddMember("first", 0);
+    AddMember("second", 5);
+    AddMember("third", 19);
+
+    BString message(L"same for everyone");
+    message_lib_->sendChatRoomMessage(&channel_, BString("galaxy"), BString("sender"), message);
+
+    ASSERT_FALSE(clients_[0]->payload().empty());
+    EXPECT_EQ(clients_[0]->payload(), clients_[1]->payload());
+    EXPECT_EQ(clients_[0]->payload(), clients_[2]->payload());
+}
+
+// Chat lines per second into a 1000 member room, members ignoring 0-19
+// other players. The shared line against encoding it for every member.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(ChatRoomTest, DISABLED_BenchmarkRoomLinesPerSecond) {
+    const uint32_t members = 1000;
+    const uint32_t lines = 2000;
+
+    srand(7);
+
+    for (uint32_t i = 0; i < members; ++i) {
+        char name[32];
+        sprintf(name, "member%u", i);
+        AddMember(name, rand() % 20);
+    }
+
+    BString sender("sender");
+    BString message(L"a line of about the usual length for a chat room");
+
+    boost::posix_time::ptime per_member_start = boost::posix_time::microsec_clock::universal_time();
+    for (uint32_t i = 0; i < lines; ++i) {
+        SendPerMemberLine(sender, message);
+        gMessageFactory->Process();
+    }
+    boost::posix_time::ptime per_member_end = boost::posix_time::microsec_clock::universal_time();
+
+    boost::posix_time::ptime shared_start = boost::posix_time::microsec_clock::universal_time();
+    for (uint32_t i = 0; i < lines; ++i) {
+        message_lib_->sendChatRoomMessage(&channel_, BString("galaxy"), sender, message);
+        gMessageFactory->Process();
+    }
+    boost::posix_time::ptime shared_end = boost::posix_time::microsec_clock::universal_time();
+
+    for (uint32_t i = 0; i < clients_.size(); ++i) {
+        EXPECT_EQ(2 * lines, clients_[i]->messages());
+    }
+
+    std::cout << members << " members: "
+              << lines * 1000000.0 / (per_member_end - per_member_start).total_microseconds() << " lines/s encoded per member, "
+              << lines * 1000000.0 / (shared_end - shared_start).total_microseconds() << " lines/s shared line" << std::endl;
+}
+
+}  // namespace
@@ -0,0 +1,385 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "ChatServer/CommoditiesIndex.h"
+#include "ChatServer/TradeManagerHelp.h"
+
+#include <cstring>
+#include <stdint.h>
+
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+const uint64_t kNow = 1000;
+
+CommodityListing MakeListing(uint64_t id, uint32_t price) {
+    CommodityListing listing;
+    memset(&listing, 0, sizeof(listing));
+
+    listing.mId = id;
+    listing.mOwnerId = 1;
+    listing.mBazaarId = 100;
+    listing.mEndTime = kNow + 500;
+    listing.mType = TRMVendor_Instant;
+    listing.mCategory = 0x101;
+    listing.mItemType = 7;
+    listing.mPrice = price;
+    listing.mRegionId = 10;
+    listing.mPlanetId = 5;
+    strcpy(listing.mSellerName, "seller");
+
+    return listing;
+}
+
+CommoditySearch MakeSearch() {
+    CommoditySearch search;
+    memset(&search, 0, sizeof(search));
+
+    search.mRegionType = TRMGalaxy;
+    search.mWindow = TRMVendor_AllAuctions;
+    search.mCharName = "";
+    search.mNow = kNow;
+    search.mCount = 100;
+
+    return search;
+}
+
+std::vector<uint64_t> Ids(const CommodityResultList& results) {
+    std::vector<uint64_t> ids;
+    for (uint32_t i = 0; i < results.size(); ++i) {
+        ids.push_back(results[i]->mId);
+    }
+    return ids;
+}
+
+std::vector<uint64_t> Search(const CommoditiesIndex& index, const CommoditySearch& search) {
+    CommodityResultList results;
+    index.search(search, results);
+    return Ids(results);
+}
+
+std::vector<uint64_t> Expect(uint64_t a) {
+    return std::vector<uint64_t>(1, a);
+}
+
+std::vector<uint64_t> Expect(uint64_t a, uint64_t b) {
+    std::vector<uint64_t> ids;
+    ids.push_back(a);
+    ids.push_back(b);
+    return ids;
+}
+
+TEST(CommoditiesIndexTests, SearchReturnsCheapestFirst) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 300));
+    index.add(MakeListing(2, 100));
+    index.add(MakeListing(3, 200));
+
+    CommodityResultList results;
+    EXPECT_EQ(3u, index.search(MakeSearch(), results));
+
+    ASSERT_EQ(3u, results.size());
+    EXPECT_EQ(uint64_t(2), results[0]->mId);
+    EXPECT_EQ(uint64_t(3), results[1]->mId);
+    EXPECT_EQ(uint64_t(1), results[2]->mId);
+}
+
+TEST(CommoditiesIndexTests, EqualPricesAreOrderedById) {
+    CommoditiesIndex index;
+    index.add(MakeListing(9, 100));
+    index.add(MakeListing(4, 100));
+
+    EXPECT_EQ(Expect(4, 9), Search(index, MakeSearch()));
+}
+
+TEST(CommoditiesIndexTests, SearchFiltersByRegionPlanetAndVendor) {
+    CommoditiesIndex index;
+
+    CommodityListing other_region = MakeListing(1, 100);
+    other_region.mRegionId = 11;
+    CommodityListing other_planet = MakeListing(2, 100);
+    other_planet.mPlanetId = 6;
+    other_planet.mRegionId = 20;
+    CommodityListing other_vendor = MakeListing(3, 100);
+    other_vendor.mBazaarId = 101;
+
+    index.add(other_region);
+    index.add(other_planet);
+    index.add(other_vendor);
+
+    CommoditySearch search = MakeSearch();
+
+    search.mRegionType = TRMRegion;
+    search.mRegionId = 11;
+    EXPECT_EQ(Expect(1), Search(index, search));
+
+    search.mRegionType = TRMPlanet;
+    search.mPlanetId = 6;
+    EXPECT_EQ(Expect(2), Search(index, search));
+
+    search.mRegionType = TRMVendor;
+    search.mBazaarId = 101;
+    EXPECT_EQ(Expect(3), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, SearchInAnEmptyRegionFindsNothing) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+
+    CommoditySearch search = MakeSearch();
+    search.mRegionType = TRMRegion;
+    search.mRegionId = 99;
+
+    EXPECT_TRUE(Search(index, search).empty());
+}
+
+TEST(CommoditiesIndexTests, ExpiredListingsAreNotFound) {
+    CommoditiesIndex index;
+
+    CommodityListing expired = MakeListing(1, 100);
+    expired.mEndTime = kNow;
+    index.add(expired);
+    index.add(MakeListing(2, 200));
+
+    EXPECT_EQ(Expect(2), Search(index, MakeSearch()));
+}
+
+TEST(CommoditiesIndexTests, AllAuctionsWindowOnlyShowsListingsForSale) {
+    CommoditiesIndex index;
+
+    CommodityListing auction = MakeListing(1, 100);
+    auction.mType = TRMVendor_Auction;
+    CommodityListing ended = MakeListing(2, 100);
+    ended.mType = TRMVendor_Ended;
+
+    index.add(auction);
+    index.add(ended);
+    index.add(MakeListing(3, 100));
+
+    EXPECT_EQ(Expect(1, 3), Search(index, MakeSearch()));
+}
+
+TEST(CommoditiesIndexTests, MySalesWindowOnlyShowsOwnListings) {
+    CommoditiesIndex index;
+
+    CommodityListing mine = MakeListing(1, 100);
+    mine.mOwnerId = 42;
+    index.add(mine);
+    index.add(MakeListing(2, 100));
+
+    CommoditySearch search = MakeSearch();
+    search.mWindow = TRMVendor_MySales;
+    search.mCharId = 42;
+
+    EXPECT_EQ(Expect(1), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, MyBidsWindowShowsListingsTheCharacterBidOn) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+    index.add(MakeListing(2, 200));
+    index.setBid(2, "bidder", 250, 0);
+
+    CommoditySearch search = MakeSearch();
+    search.mWindow = TRMVendor_MyBids;
+    search.mCharName = "bidder";
+
+    EXPECT_EQ(Expect(2), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, MainCategoryMatchesItsSubcategories) {
+    CommoditiesIndex index;
+
+    CommodityListing weapon = MakeListing(1, 100);
+    weapon.mCategory = 0x101;
+    CommodityListing other_weapon = MakeListing(2, 100);
+    other_weapon.mCategory = 0x102;
+    CommodityListing armor = MakeListing(3, 100);
+    armor.mCategory = 0x201;
+
+    index.add(weapon);
+    index.add(other_weapon);
+    index.add(armor);
+
+    CommoditySearch search = MakeSearch();
+
+    search.mCategory = 0x100;
+    EXPECT_EQ(Expect(1, 2), Search(index, search));
+
+    search.mCategory = 0x102;
+    EXPECT_EQ(Expect(2), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, SearchFiltersByItemType) {
+    CommoditiesIndex index;
+
+    CommodityListing other_type = MakeListing(1, 100);
+    other_type.mItemType = 8;
+    index.add(other_type);
+    index.add(MakeListing(2, 100));
+
+    CommoditySearch search = MakeSearch();
+    search.mItemType = 8;
+
+    EXPECT_EQ(Expect(1), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, PriceRangeIsInclusive) {
+    CommoditiesIndex index;
+    for (uint64_t id = 1; id <= 5; ++id) {
+        index.add(MakeListing(id, static_cast<uint32_t>(id * 100)));
+    }
+
+    CommoditySearch search = MakeSearch();
+    search.mMinPrice = 200;
+    search.mMaxPrice = 300;
+
+    EXPECT_EQ(Expect(2, 3), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, PagingSkipsStartAndStopsAtCount) {
+    CommoditiesIndex index;
+    for (uint64_t id = 1; id <= 10; ++id) {
+        index.add(MakeListing(id, static_cast<uint32_t>(id * 100)));
+    }
+
+    CommoditySearch search = MakeSearch();
+    search.mStart = 3;
+    search.mCount = 2;
+
+    CommodityResultList results;
+    EXPECT_EQ(2u, index.search(search, results));
+    EXPECT_EQ(Expect(4, 5), Ids(results));
+
+    // The last page is cut short.
+    search.mStart = 9;
+    EXPECT_EQ(Expect(10), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, PagingOnlyCountsMatches) {
+    CommoditiesIndex index;
+    for (uint64_t id = 1; id <= 6; ++id) {
+        CommodityListing listing = MakeListing(id, static_cast<uint32_t>(id * 100));
+        listing.mItemType = (id % 2) ? 7 : 8;
+        index.add(listing);
+    }
+
+    CommoditySearch search = MakeSearch();
+    search.mItemType = 8;
+    search.mStart = 1;
+    search.mCount = 1;
+
+    EXPECT_EQ(Expect(4), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, AddReplacesAnIndexedListing) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+
+    CommodityListing moved = MakeListing(1, 500);
+    moved.mRegionId = 12;
+    index.add(moved);
+
+    EXPECT_EQ(1u, index.size());
+    EXPECT_EQ(uint32_t(500), index.find(1)->mPrice);
+
+    CommoditySearch search = MakeSearch();
+    search.mRegionType = TRMRegion;
+    search.mRegionId = 10;
+    EXPECT_TRUE(Search(index, search).empty());
+
+    search.mRegionId = 12;
+    EXPECT_EQ(Expect(1), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, SetBidAddsAndUpdatesABid) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+
+    index.setBid(1, "bidder", 150, 10);
+
+    const CommodityBid* bid = index.getBid(1, "bidder");
+    ASSERT_TRUE(bid != NULL);
+    EXPECT_EQ(uint32_t(150), bid->mMaxBid);
+    EXPECT_EQ(uint32_t(10), bid->mProxy);
+
+    index.setBid(1, "bidder", 200, 20);
+    bid = index.getBid(1, "bidder");
+    ASSERT_TRUE(bid != NULL);
+    EXPECT_EQ(uint32_t(200), bid->mMaxBid);
+    EXPECT_EQ(uint32_t(20), bid->mProxy);
+
+    index.setProxy(1, "bidder", 30);
+    EXPECT_EQ(uint32_t(30), index.getBid(1, "bidder")->mProxy);
+
+    EXPECT_TRUE(index.getBid(1, "someone") == NULL);
+}
+
+TEST(CommoditiesIndexTests, SetBidOnAnUnknownListingIsIgnored) {
+    CommoditiesIndex index;
+
+    index.setBid(1, "bidder", 150, 10);
+
+    EXPECT_TRUE(index.getBid(1, "bidder") == NULL);
+}
+
+TEST(CommoditiesIndexTests, SetHighBidSetsTheBidder) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+
+    index.setHighBid(1, "bidder", 77, 150, 0);
+
+    EXPECT_EQ(uint64_t(77), index.find(1)->mBidderId);
+    EXPECT_STREQ("bidder", index.find(1)->mBidderName);
+    ASSERT_TRUE(index.getBid(1, "bidder") != NULL);
+}
+
+TEST(CommoditiesIndexTests, SetSoldHandsTheListingToTheBuyer) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+    index.setBid(1, "buyer", 100, 0);
+
+    index.setSold(1, 42, "buyer", TRMVendor_Ended, kNow + 100);
+
+    const CommodityListing* listing = index.find(1);
+    ASSERT_TRUE(listing != NULL);
+    EXPECT_EQ(uint64_t(42), listing->mOwnerId);
+    EXPECT_EQ(uint32_t(TRMVendor_Ended), listing->mType);
+    EXPECT_STREQ("buyer", listing->mSellerName);
+
+    // Bids survive the move.
+    EXPECT_TRUE(index.getBid(1, "buyer") != NULL);
+
+    // It is gone from the seller's sales and waits for the buyer.
+    CommoditySearch search = MakeSearch();
+    search.mWindow = TRMVendor_MySales;
+    search.mCharId = 1;
+    EXPECT_TRUE(Search(index, search).empty());
+
+    search.mWindow = TRMVendor_AvailableItems;
+    search.mCharId = 42;
+    EXPECT_EQ(Expect(1), Search(index, search));
+}
+
+TEST(CommoditiesIndexTests, RemoveDropsTheListingAndItsBids) {
+    CommoditiesIndex index;
+    index.add(MakeListing(1, 100));
+    index.add(MakeListing(2, 200));
+    index.setBid(1, "bidder", 150, 0);
+
+    index.remove(1);
+
+    EXPECT_EQ(1u, index.size());
+    EXPECT_TRUE(index.find(1) == NULL);
+    EXPECT_TRUE(index.getBid(1, "bidder") == NULL);
+    EXPECT_EQ(Expect(2), Search(index, MakeSearch()));
+
+    // Removing an unknown id does nothing.
+    index.remove(1);
+    EXPECT_EQ(1u, index.size());
+}
+
+}  // namespace
@@ -0,0 +1,162 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "ChatServer/Mail.h"
+#include "ChatServer/Mailbox.h"
+
+#include <stdint.h>
+
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+// The box keeps this many bodies, see Mailbox::MaxCachedBodies.
+const uint32_t kMaxCachedBodies = 16;
+
+Mail* MakeMail(uint32_t id, const char* subject = "subject") {
+    Mail* mail = new Mail();
+    mail->setId(id);
+    mail->setTime(1000 + id);
+    mail->setStatus(0);
+    mail->setSender(BString("sender"));
+    mail->setSubject(BString(subject));
+    mail->setText(BString("text"));
+    return mail;
+}
+
+void AddHeader(Mailbox& mailbox, uint32_t id, const char* subject = "subject") {
+    Mail* mail = MakeMail(id, subject);
+    mailbox.addHeader(mail);
+    delete mail;
+}
+
+TEST(MailboxTests, AddHeaderCopiesTheListedFields) {
+    Mailbox mailbox;
+    AddHeader(mailbox, 7, "hello");
+
+    MailHeader* header = mailbox.getHeader(7);
+    ASSERT_TRUE(header != NULL);
+    EXPECT_EQ(uint32_t(7), header->mId);
+    EXPECT_EQ(uint32_t(1007), header->mTime);
+    EXPECT_STREQ("sender", header->mSender.getAnsi());
+    EXPECT_STREQ("hello", header->mSubject.getAnsi());
+    EXPECT_TRUE(header->mBody == NULL);
+
+    EXPECT_EQ(1u, mailbox.getMailCount());
+    EXPECT_TRUE(mailbox.getHeader(8) == NULL);
+}
+
+TEST(MailboxTests, AddingAKnownMailReplacesTheHeaderAndKeepsTheBody) {
+    Mailbox mailbox;
+    AddHeader(mailbox, 7, "old");
+
+    Mail* body = MakeMail(7);
+    mailbox.cacheBody(7, body);
+
+    AddHeader(mailbox, 7, "new");
+
+    EXPECT_EQ(1u, mailbox.getMailCount());
+    EXPECT_STREQ("new", mailbox.getHeader(7)->mSubject.getAnsi());
+    EXPECT_EQ(body, mailbox.getBody(7));
+    EXPECT_EQ(1u, mailbox.getCachedBodyCount());
+}
+
+TEST(MailboxTests, BodyOfAMailNotInTheBoxIsNotCached) {
+    Mailbox mailbox;
+
+    mailbox.cacheBody(7, MakeMail(7));
+
+    EXPECT_TRUE(mailbox.getBody(7) == NULL);
+    EXPECT_EQ(0u, mailbox.getCachedBodyCount());
+}
+
+TEST(MailboxTests, CachingABodyAgainReplacesIt) {
+    Mailbox mailbox;
+    AddHeader(mailbox, 7);
+
+    mailbox.cacheBody(7, MakeMail(7));
+    Mail* body = MakeMail(7);
+    mailbox.cacheBody(7, body);
+
+    EXPECT_EQ(body, mailbox.getBody(7));
+    EXPECT_EQ(1u, mailbox.getCachedBodyCount());
+}
+
+TEST(MailboxTests, OldestBodyIsEvictedOnceTheCacheIsFull) {
+    Mailbox mailbox;
+    for (uint32_t id = 1; id <= kMaxCachedBodies + 1; ++id) {
+        AddHeader(mailbox, id);
+    }
+
+    for (uint32_t id = 1; id <= kMaxCachedBodies + 1; ++id) {
+        mailbox.cacheBody(id, MakeMail(id));
+    }
+
+    EXPECT_EQ(kMaxCachedBodies, mailbox.getCachedBodyCount());
+    EXPECT_TRUE(mailbox.getBody(1) == NULL);
+    EXPECT_TRUE(mailbox.getBody(2) != NULL);
+    EXPECT_TRUE(mailbox.getBody(kMaxCachedBodies + 1) != NULL);
+
+    // The header stays, only the body is gone.
+    EXPECT_TRUE(mailbox.getHeader(1) != NULL);
+    EXPECT_EQ(kMaxCachedBodies + 1, mailbox.getMailCount());
+}
+
+TEST(MailboxTests, RecachedBodyBecomesTheNewest) {
+    Mailbox mailbox;
+    for (uint32_t id = 1; id <= kMaxCachedBodies + 1; ++id) {
+        AddHeader(mailbox, id);
+    }
+
+    for (uint32_t id = 1; id <= kMaxCachedBodies; ++id) {
+        mailbox.cacheBody(id, MakeMail(id));
+    }
+
+    // Reading mail 1 again moves it to the back, mail 2 is the oldest now.
+    mailbox.cacheBody(1, MakeMail(1));
+    mailbox.cacheBody(kMaxCachedBodies + 1, MakeMail(kMaxCachedBodies + 1));
+
+    EXPECT_TRUE(mailbox.getBody(1) != NULL);
+    EXPECT_TRUE(mailbox.getBody(2) == NULL);
+    EXPECT_EQ(kMaxCachedBodies, mailbox.getCachedBodyCount());
+}
+
+TEST(MailboxTests, RemovingAMailDropsItsBody) {
+    Mailbox mailbox;
+    AddHeader(mailbox, 7);
+    AddHeader(mailbox, 8);
+    mailbox.cacheBody(7, MakeMail(7));
+
+    mailbox.removeMail(7);
+
+    EXPECT_TRUE(mailbox.getHeader(7) == NULL);
+    EXPECT_TRUE(mailbox.getBody(7) == NULL);
+    EXPECT_EQ(0u, mailbox.getCachedBodyCount());
+    EXPECT_EQ(1u, mailbox.getMailCount());
+
+    // Removing an unknown mail does nothing.
+    mailbox.removeMail(7);
+    EXPECT_EQ(1u, mailbox.getMailCount());
+}
+
+TEST(MailboxTests, RemovedMailMakesRoomInTheCache) {
+    Mailbox mailbox;
+    for (uint32_t id = 1; id <= kMaxCachedBodies + 1; ++id) {
+        AddHeader(mailbox, id);
+    }
+
+    for (uint32_t id = 1; id <= kMaxCachedBodies; ++id) {
+        mailbox.cacheBody(id, MakeMail(id));
+    }
+
+    mailbox.removeMail(5);
+    mailbox.cacheBody(kMaxCachedBodies + 1, MakeMail(kMaxCachedBodies + 1));
+
+    // Nothing had to be evicted.
+    EXPECT_TRUE(mailbox.getBody(1) != NULL);
+    EXPECT_EQ(kMaxCachedBodies, mailbox.getCachedBodyCount());
+}
+
+}  // namespace
@@ -27,234 +27,377 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Common/EventDispatcher.h"
 
+#include <algorithm>
+
 namespace common {
 
-EventDispatcher::EventDispatcher()
-    : current_timestep_(0)
-    , active_queue_(0) {}
+/**
+ * Single producer, single consumer ring holding the events one foreign thread
+ * notified since the last Tick. Only the owning producer pushes and only the
+ * dispatcher thread pops, so the head and tail are the only shared state.
+ */
+class EventDispatcher::ProducerRing {
+public:
+    enum { kCapacity = 1024 };
+
+    explicit ProducerRing(boost::thread::id producer)
+        : producer_(producer) {
+        head_ = 0;
+        tail_ = 0;
+    }
 
-EventDispatcher::EventDispatcher(uint64_t current_time)
-    : current_timestep_(current_time)
-    , active_queue_(0) {}
+    const boost::thread::id& producer() const { return producer_; }
 
-EventDispatcher::~EventDispatcher() {}
+    bool Push(const IEventPtr& triggered_event) {
+        uint32_t tail = tail_;
 
-void EventDispatcher::Connect(const EventType& event_type, EventListener listener) {
-    active_.Send([=] {
-        if (! ValidateEventType_(event_type)) {
-            return;
+        if (tail - head_ == kCapacity) {
+            return false;
         }
 
-        if (! AddEventType_(event_type)) {
-            return;
-        }
+        slots_[tail & (kCapacity - 1)] = triggered_event;
+        tail_ = tail + 1;
+
+        return true;
+    }
 
-        // Look for an entry and
-        auto map_it = event_listener_map_.find(event_type);
+    bool Pop(IEventPtr& triggered_event) {
+        uint32_t head = head_;
 
-        // Somehow the event type doesn't exist.
-        if (map_it == event_listener_map_.end()) {
-            return;
+        if (head == tail_) {
+            return false;
         }
 
-        // Lookup the listener in the list to see if it already exists.
-        EventListenerList& listener_list = (*map_it).second;
+        IEventPtr& slot = slots_[head & (kCapacity - 1)];
+        triggered_event = slot;
+        slot.reset();
+        head_ = head + 1;
 
-        for (auto list_it = listener_list.begin(), end = listener_list.end(); list_it != end; ++list_it) {
-            if ((*list_it).first.ident() == listener.first.ident()) {
-                return;
-            }
-        }
+        return true;
+    }
+
+private:
+    boost::thread::id producer_;
+    tbb::atomic<uint32_t> head_;
+    char pad_[CACHE_LINE_SIZE - sizeof(tbb::atomic<uint32_t>)];
+    tbb::atomic<uint32_t> tail_;
+    IEventPtr slots_[kCapacity];
+};
+
+EventDispatcher::EventDispatcher()
+    : wildcard_index_(kNoIndex)
+    , active_queue_(0)
+    , next_deadline_(kNoDeadline)
+    , owner_thread_(boost::this_thread::get_id())
+    , delivery_depth_(0) {
+    current_timestep_ = 0;
+    pending_events_ = 0;
+
+    for (uint32_t i = 0; i < kMaxProducers; ++i) {
+        producer_rings_[i] = nullptr;
+    }
+}
 
-        // EventType has been validated, the listener validated and doesn't already exist, add it.
-        listener_list.push_back(listener);
+EventDispatcher::EventDispatcher(uint64_t current_time)
+    : wildcard_index_(kNoIndex)
+    , active_queue_(0)
+    , next_deadline_(kNoDeadline)
+    , owner_thread_(boost::this_thread::get_id())
+    , delivery_depth_(0) {
+    current_timestep_ = current_time;
+    pending_events_ = 0;
+
+    for (uint32_t i = 0; i < kMaxProducers; ++i) {
+        producer_rings_[i] = nullptr;
+    }
+}
 
-    } );
+EventDispatcher::~EventDispatcher() {
+    for (uint32_t i = 0; i < kMaxProducers; ++i) {
+        delete producer_rings_[i];
+    }
 }
 
+void EventDispatcher::Connect(const EventType& event_type, EventListener listener) {
+    Call_(std::bind(&EventDispatcher::Connect_, this, event_type, listener));
+}
 
 void EventDispatcher::Disconnect(const EventType& event_type, const EventListenerType& event_listener_type) {
-    active_.Send(std::bind(&EventDispatcher::Disconnect_, this, event_type, event_listener_type));
+    Call_(std::bind(&EventDispatcher::Disconnect_, this, event_type, event_listener_type));
 }
 
 void EventDispatcher::DisconnectFromAll(const EventListenerType& event_listener_type) {
-    active_.Send([=] {
-        // Make sure a valid event listener type was passed in.
-        if (! ValidateEventListenerType_(event_listener_type)) {
-            return;
-        }
-
-        // Use the known type lists to loop and call Disconnect for each.
-        for (auto type_it = event_type_set_.begin(), end = event_type_set_.end(); type_it != end; ++type_it) {
-            // Call the internal disconnect method so that each disconnect doesn't get queued.
-            Disconnect_(*type_it, event_listener_type);
-        }
-    } );
+    Call_(std::bind(&EventDispatcher::DisconnectFromAll_, this, event_listener_type));
 }
 
 boost::unique_future<std::vector<EventListener>> EventDispatcher::GetListeners(const EventType& event_type) {
-    // Create a packaged task for retrieving the value.
-    auto task = std::make_shared<boost::packaged_task<std::vector<EventListener>>>([=]()->std::vector<EventListener> {
+    auto promise = std::make_shared<boost::promise<std::vector<EventListener>>>();
 
-        if (! ValidateEventType_(event_type)) {
-            return std::vector<EventListener>();
-        }
-
-        EventListenerMap::const_iterator map_it = event_listener_map_.find(event_type);
-
-        // no listeners currently for this event type, so sad
-        if (map_it == event_listener_map_.end()) {
-            return std::vector<EventListener>();
-        }
-
-        const EventListenerList& listener_list = map_it->second;
+    Query_([=] {
+        uint32_t index = ValidateEventType_(event_type) ? FindEventType_(event_type) : kNoIndex;
 
-        // there was, but is not now, any listeners currently for
-        // this event type, so sad
-        if (listener_list.size() == 0) {
-            return std::vector<EventListener>();
-        }
-
-        // Build up the result set to return.
-        std::vector<EventListener> result;
-
-        for (auto list_it = listener_list.begin(), end = listener_list.end(); list_it != end; ++list_it) {
-            result.push_back(*list_it);
+        if (index == kNoIndex) {
+            promise->set_value(std::vector<EventListener>());
+            return;
         }
 
-        return result;
-    } );
-
-    // Add the message to the active object's queue that runs the task which in turn
-    // updates the future.
-    active_.Send([task] {
-        (*task)();
+        promise->set_value(event_listeners_[index]);
     });
 
-    // Return the future to the caller.
-    return task->get_future();
+    return promise->get_future();
 }
 
 boost::unique_future<std::vector<EventType>> EventDispatcher::GetRegisteredEvents() {
-    // Create a packaged task for retrieving the value.
-    auto task = std::make_shared<boost::packaged_task<std::vector<EventType>>>([=]()->std::vector<EventType> {
+    auto promise = std::make_shared<boost::promise<std::vector<EventType>>>();
 
-        std::vector<EventType> event_types;
-        event_types.reserve(event_type_set_.size());
+    Query_([=] {
+        // Types are stored in registration order, callers have always seen them sorted.
+        std::vector<EventType> event_types(event_types_);
+        std::sort(event_types.begin(), event_types.end());
 
-        // Use the known type lists to loop and call Disconnect for each.
-        for (auto type_it = event_type_set_.begin(), end = event_type_set_.end(); type_it != end; ++type_it) {
-            event_types.push_back(*type_it);
-        }
-
-        return event_types;
-    } );
-
-    // Add the message to the active object's queue that runs the task which in turn
-    // updates the future.
-    active_.Send([task] {
-        (*task)();
+        promise->set_value(event_types);
     });
 
-    // Return the future to the caller.
-    return task->get_future();
+    return promise->get_future();
 }
 
 void EventDispatcher::Notify(IEventPtr triggered_event) {
     // Sanity check on the event itself.
     if (!triggered_event) return;
 
-    active_.Send([=] {
-        // If the timestamp for the event has not yet been set then set it.
-        if (!triggered_event->timestamp()) {
-            triggered_event->timestamp(current_timestep_);
-        }
+    if (IsOwnerThread_()) {
+        Enqueue_(triggered_event);
+        return;
+    }
 
-        event_queue_[active_queue_].push(triggered_event);
-    });
+    // Count it before it becomes visible so the dispatcher never sees a negative backlog.
+    ++pending_events_;
+
+    ProducerRing* ring = FindProducerRing_();
+
+    if (!ring || !ring->Push(triggered_event)) {
+        boost::lock_guard<boost::mutex> lock(producer_mutex_);
+        overflow_events_.push_back(triggered_event);
+    }
 }
 
 boost::unique_future<bool> EventDispatcher::Deliver(IEventPtr triggered_event) {
-    // Create a packaged task for retrieving the value.
-    auto task = std::make_shared<boost::packaged_task<bool>>(std::bind(&EventDispatcher::Deliver_, this, triggered_event));
+    auto promise = std::make_shared<boost::promise<bool>>();
+
+    if (IsOwnerThread_()) {
+        promise->set_value(Deliver_(triggered_event));
+    } else {
+        remote_calls_.push([=] {
+            promise->set_value(Deliver_(triggered_event));
+        });
+    }
 
-    // Add the message to the active object's queue that runs the task which in turn
-    // updates the future.
-    active_.Send([task] {
-        (*task)();
-    });
+    return promise->get_future();
+}
+
+bool EventDispatcher::DeliverNow(IEventPtr triggered_event) {
+    if (IsOwnerThread_()) {
+        return Deliver_(triggered_event);
+    }
 
-    // Return the future to the caller.
-    return task->get_future();
+    return Deliver(triggered_event).get();
 }
 
 boost::unique_future<bool> EventDispatcher::HasEvents() {
-    // Create a packaged task for retrieving the value.
-    auto task = std::make_shared<boost::packaged_task<bool>>([=] {
-        return (event_queue_[active_queue_].size() != 0);
-    } );
-
-    // Add the message to the active object's queue that runs the task which in turn
-    // updates the future.
-    active_.Send([task] {
-        (*task)();
-    });
+    boost::promise<bool> promise;
+    promise.set_value(HasPendingEvents());
+
+    return promise.get_future();
+}
+
+bool EventDispatcher::HasPendingEvents() const {
+    return pending_events_ != 0;
+}
+
+uint64_t EventDispatcher::NextDeadline() const {
+    // Events still sitting in the producer rings are counted but not queued yet.
+    if (pending_events_ > event_queue_[0].size() + event_queue_[1].size()) {
+        return current_timestep_;
+    }
 
-    // Return the future to the caller.
-    return task->get_future();
+    return next_deadline_;
 }
 
 boost::unique_future<bool> EventDispatcher::Tick(uint64_t new_timestep) {
-    // Create a packaged task for retrieving the value.
-    auto task = std::make_shared<boost::packaged_task<bool>>([=]()->bool {
-        // If we were passed the same time or a time in the past return false.
-        if (current_timestep_ >= new_timestep) return false;
-
-        current_timestep_ = new_timestep;
-
-        int queue_to_process = active_queue_;
-        active_queue_ = (active_queue_ + 1) % kNumQueues;
-
-        while(event_queue_[queue_to_process].size() > 0) {
-            IEventPtr event_to_process = event_queue_[queue_to_process].top();
-            event_queue_[queue_to_process].pop();
-
-            // Check to to see if the event is ready for processing yet. If so deliver it, if not put it on the new queue.
-            if ((event_to_process->timestamp() + event_to_process->delay_ms()) <= current_timestep_) {
-                Deliver_(event_to_process);
-            } else {
-                // Else push it back onto the next queue for processing.
-                event_queue_[active_queue_].push(event_to_process);
+    auto promise = std::make_shared<boost::promise<bool>>();
+
+    if (IsOwnerThread_()) {
+        promise->set_value(Tick_(new_timestep));
+    } else {
+        remote_calls_.push([=] {
+            promise->set_value(Tick_(new_timestep));
+        });
+    }
+
+    return promise->get_future();
+}
+
+boost::unique_future<uint64_t> EventDispatcher::current_timestep() {
+    boost::promise<uint64_t> promise;
+    promise.set_value(current_timestep_);
+
+    return promise.get_future();
+}
+
+bool EventDispatcher::IsOwnerThread_() const {
+    return boost::this_thread::get_id() == owner_thread_;
+}
+
+void EventDispatcher::Call_(Call call) {
+    if (!IsOwnerThread_()) {
+        remote_calls_.push(call);
+        return;
+    }
+
+    // Listeners are iterated in place, so changes to them wait for the delivery to finish.
+    if (delivery_depth_) {
+        deferred_calls_.push_back(call);
+        return;
+    }
+
+    call();
+}
+
+void EventDispatcher::Query_(Call call) {
+    // Reads are safe in the middle of a delivery, only other threads have to wait.
+    if (!IsOwnerThread_()) {
+        remote_calls_.push(call);
+        return;
+    }
+
+    call();
+}
+
+void EventDispatcher::RunRemoteCalls_() {
+    Call call;
+
+    while (remote_calls_.pop(call)) {
+        Call_(call);
+    }
+}
+
+EventDispatcher::ProducerRing* EventDispatcher::FindProducerRing_() {
+    boost::thread::id producer = boost::this_thread::get_id();
+
+    for (uint32_t i = 0; i < kMaxProducers; ++i) {
+        ProducerRing* ring = producer_rings_[i];
+
+        if (!ring) {
+            break;
+        }
+
+        if (ring->producer() == producer) {
+            return ring;
+        }
+    }
+
+    // First event from this thread, claim a ring for it. Rings are only ever
+    // appended so the scan above never needs the lock.
+    boost::lock_guard<boost::mutex> lock(producer_mutex_);
+
+    for (uint32_t i = 0; i < kMaxProducers; ++i) {
+        ProducerRing* ring = producer_rings_[i];
+
+        if (!ring) {
+            ring = new ProducerRing(producer);
+            producer_rings_[i] = ring;
+            return ring;
+        }
+
+        if (ring->producer() == producer) {
+            return ring;
+        }
+    }
+
+    // Out of rings, the caller falls back to the overflow list.
+    return nullptr;
+}
+
+void EventDispatcher::DrainProducerRings_() {
+    IEventPtr triggered_event;
+
+    for (uint32_t i = 0; i < kMaxProducers; ++i) {
+        ProducerRing* ring = producer_rings_[i];
+
+        if (!ring) {
+            break;
+        }
+
+        while (ring->Pop(triggered_event)) {
+            if (!triggered_event->timestamp()) {
+                triggered_event->timestamp(current_timestep_);
             }
+
+            Queue_(active_queue_, triggered_event);
         }
+    }
 
-        return true;
-    } );
+    std::vector<IEventPtr> overflow;
+    {
+        boost::lock_guard<boost::mutex> lock(producer_mutex_);
+        overflow.swap(overflow_events_);
+    }
 
-    // Add the message to the active object's queue that runs the task which in turn
-    // updates the future.
-    active_.Send([task] {
-        (*task)();
-    });
+    for (auto it = overflow.begin(), end = overflow.end(); it != end; ++it) {
+        if (!(*it)->timestamp()) {
+            (*it)->timestamp(current_timestep_);
+        }
 
-    // Return the future to the caller.
-    return task->get_future();
+        Queue_(active_queue_, *it);
+    }
 }
 
-boost::unique_future<uint64_t> EventDispatcher::current_timestep() {
-    // Create a packaged task for retrieving the value.
-    auto task = std::make_shared<boost::packaged_task<uint64_t>>([=] {
-        return current_timestep_;
-    } );
+void EventDispatcher::Enqueue_(IEventPtr triggered_event) {
+    // If the timestamp for the event has not yet been set then set it.
+    if (!triggered_event->timestamp()) {
+        triggered_event->timestamp(current_timestep_);
+    }
 
-    // Add the message to the active object's queue that runs the task which in turn
-    // updates the future.
-    active_.Send([task] {
-        (*task)();
-    });
+    ++pending_events_;
+    Queue_(active_queue_, triggered_event);
+}
+
+void EventDispatcher::Queue_(int queue, IEventPtr triggered_event) {
+    next_deadline_ = std::min(next_deadline_, triggered_event->timestamp() + triggered_event->delay_ms());
+    event_queue_[queue].push(triggered_event);
+}
+
+bool EventDispatcher::Tick_(uint64_t new_timestep) {
+    // Pick up whatever other threads asked for since the last tick.
+    RunRemoteCalls_();
+    DrainProducerRings_();
 
-    // Return the future to the caller.
-    return task->get_future();
+    // If we were passed the same time or a time in the past return false.
+    if (current_timestep_ >= new_timestep) return false;
+
+    current_timestep_ = new_timestep;
+
+    int queue_to_process = active_queue_;
+    active_queue_ = (active_queue_ + 1) % kNumQueues;
+
+    // Rebuilt from what is left over and what gets queued while delivering.
+    next_deadline_ = kNoDeadline;
+
+    while(event_queue_[queue_to_process].size() > 0) {
+        IEventPtr event_to_process = event_queue_[queue_to_process].top();
+        event_queue_[queue_to_process].pop();
+
+        // Check to to see if the event is ready for processing yet. If so deliver it, if not put it on the new queue.
+        if ((event_to_process->timestamp() + event_to_process->delay_ms()) <= current_timestep_) {
+            --pending_events_;
+            Deliver_(event_to_process);
+        } else {
+            // Else push it back onto the next queue for processing.
+            Queue_(active_queue_, event_to_process);
+        }
+    }
+
+    return true;
 }
 
 bool EventDispatcher::ValidateEventType_(const EventType& event_type) const {
@@ -265,14 +408,10 @@ bool EventDispatcher::ValidateEventType_(const EventType& event_type) const {
 
     // If an event_type already exists verify that the text is the same so
     // that no naming clashes occur.
-    EventTypeSet::const_iterator it = event_type_set_.find(event_type);
+    uint32_t index = FindEventType_(event_type);
 
-    // Check whether or not the event is known.
-    if (it != event_type_set_.end()) {
-        // If the ident's don't match for whatever reason we failed.
-        if ((*it).ident() != event_type.ident()) {
-            return false;
-        }
+    if (index != kNoIndex && event_types_[index].ident_string() != event_type.ident_string()) {
+        return false;
     }
 
     // If all the tests have passed then return true for validation.
@@ -289,45 +428,53 @@ bool EventDispatcher::ValidateEventListenerType_(const EventListenerType& event_
     return true;
 }
 
-bool EventDispatcher::AddEventType_(const EventType& event_type) {
-    // check / update type list
-    EventTypeSet::iterator it = event_type_set_.find(event_type);
+uint32_t EventDispatcher::AddEventType_(const EventType& event_type) {
+    uint32_t index = FindEventType_(event_type);
 
-    // EventType already exists. Return true to indicate so.
-    if (it != event_type_set_.end()) {
-        return true;
+    // EventType already exists.
+    if (index != kNoIndex) {
+        return index;
     }
 
-    // The EventType hasn't been registered before, attempt to insert it into the set.
-    std::pair<EventTypeSet::iterator, bool> set_insert_result = event_type_set_.insert(event_type);
+    index = static_cast<uint32_t>(event_types_.size());
 
-    // Insertion failed for some reason.
-    if (set_insert_result.second == false) {
-        return false;
+    event_type_indices_.insert(std::make_pair(event_type.ident(), index));
+    event_types_.push_back(event_type);
+    event_listeners_.push_back(EventListenerList());
+
+    if (event_type.ident() == EventType(kWildCardHashString).ident()) {
+        wildcard_index_ = index;
     }
 
-    // Somehow the insertion left the list empty, bail out.
-    if (set_insert_result.first == event_type_set_.end()) {
-        return false;
+    return index;
+}
+
+uint32_t EventDispatcher::FindEventType_(const EventType& event_type) const {
+    auto it = event_type_indices_.find(event_type.ident());
+
+    if (it == event_type_indices_.end()) {
+        return kNoIndex;
     }
 
-    // Now ensure an empty list exists in the listener map for this type.
-    std::pair<EventListenerMap::iterator, bool> map_insert_result = event_listener_map_.insert(
-                std::pair<EventType, EventListenerList>(event_type, EventListenerList()));
+    return it->second;
+}
 
-    // Could not insert into map.
-    if (map_insert_result.second == false) {
-        return false;
+void EventDispatcher::Connect_(const EventType& event_type, const EventListener& listener) {
+    if (! ValidateEventType_(event_type)) {
+        return;
     }
 
-    // Somehow the insertion left the map empty, bail out.
-    if (map_insert_result.first == event_listener_map_.end()) {
-        return false;
+    EventListenerList& listener_list = event_listeners_[AddEventType_(event_type)];
+
+    // Lookup the listener in the list to see if it already exists.
+    for (auto list_it = listener_list.begin(), end = listener_list.end(); list_it != end; ++list_it) {
+        if ((*list_it).first.ident() == listener.first.ident()) {
+            return;
+        }
     }
 
-    // The event type already existed or it was successfully inserted, either
-    // way it definitely exists in the set now.
-    return true;
+    // EventType has been validated, the listener validated and doesn't already exist, add it.
+    listener_list.push_back(listener);
 }
 
 void EventDispatcher::Disconnect_(const EventType& event_type, const EventListenerType& event_listener_type) {
@@ -340,16 +487,14 @@ void EventDispatcher::Disconnect_(const EventType& event_type, const EventListen
         return;
     }
 
-    // Look for an entry and
-    auto map_it = event_listener_map_.find(event_type);
+    uint32_t index = FindEventType_(event_type);
 
     // Somehow the event type doesn't exist.
-    if (map_it == event_listener_map_.end()) {
+    if (index == kNoIndex) {
         return;
     }
 
-    // Lookup the listener in the list to see if it already exists.
-    EventListenerList& listener_list = (*map_it).second;
+    EventListenerList& listener_list = event_listeners_[index];
 
     // Loop through until we find it, no need to worry about invalidating the iterator
     // because after the erase it's never used again.
@@ -361,6 +506,17 @@ void EventDispatcher::Disconnect_(const EventType& event_type, const EventListen
     }
 }
 
+void EventDispatcher::DisconnectFromAll_(const EventListenerType& event_listener_type) {
+    // Make sure a valid event listener type was passed in.
+    if (! ValidateEventListenerType_(event_listener_type)) {
+        return;
+    }
+
+    for (auto type_it = event_types_.begin(), end = event_types_.end(); type_it != end; ++type_it) {
+        Disconnect_(*type_it, event_listener_type);
+    }
+}
+
 bool EventDispatcher::Deliver_(IEventPtr triggered_event) {
     // Sanity check to make sure the event is valid.
     if (!triggered_event) {
@@ -380,43 +536,37 @@ bool EventDispatcher::Deliver_(IEventPtr triggered_event) {
     // By default if an event isn't handled this method returns true.
     bool delivered = true;
 
-    // Find the list of global listeners.
-    auto listener_it = event_listener_map_.find(EventType(kWildCardHashString));
+    // Listeners may deliver further events but can't change the lists underneath us.
+    ++delivery_depth_;
 
-    if (listener_it != event_listener_map_.end()) {
-        // Get the list of global listeners to iterate over.
-        auto listeners = listener_it->second;
+    // Allow each global listener the opportunity to process the event.
+    if (wildcard_index_ != kNoIndex) {
+        const EventListenerList& listeners = event_listeners_[wildcard_index_];
 
-        // Allow each global listener the opportunity to process the event.
         for (auto it = listeners.begin(), end = listeners.end(); it != end; ++it) {
             (*it).second(triggered_event);
         }
     }
 
-    // Find the list of listeners for this event type.
-    listener_it = event_listener_map_.find(triggered_event->event_type());
-
-    // If no listeners were found return false.
-    if (listener_it == event_listener_map_.end()) {
-        // Callbacks should be called here if no specific listeners were found.
-        triggered_event->consume(delivered);
+    uint32_t index = FindEventType_(triggered_event->event_type());
 
-        IEventPtr next_event = triggered_event->next();
+    // Allow each listener the opportunity to process the event, if one fails the delivery fails.
+    if (index != kNoIndex) {
+        const EventListenerList& listeners = event_listeners_[index];
 
-        if (next_event) {
-            Notify(next_event);
+        for (auto it = listeners.begin(), end = listeners.end(); it != end; ++it) {
+            if (!(*it).second(triggered_event)) {
+                delivered = false;
+            }
         }
-
-        return delivered;
     }
 
-    // Get the list of listeners to iterate over.
-    auto listeners = listener_it->second;
+    if (--delivery_depth_ == 0 && !deferred_calls_.empty()) {
+        std::vector<Call> deferred_calls;
+        deferred_calls.swap(deferred_calls_);
 
-    // Allow each listener the opportunity to process the event, if it does set processed to true.
-    for (auto it = listeners.begin(), end = listeners.end(); it != end; ++it) {
-        if (!(*it).second(triggered_event)) {
-            delivered = false;
+        for (auto it = deferred_calls.begin(), end = deferred_calls.end(); it != end; ++it) {
+            (*it)();
         }
     }
 
@@ -30,15 +30,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <cstdint>
 #include <functional>
-#include <list>
-#include <map>
+#include <memory>
 #include <queue>
-#include <set>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/thread.hpp>
+#include <tbb/atomic.h>
 
-#include "Utils/ActiveObject.h"
+#include "Utils/ConcurrentQueue.h"
 #include "Utils/Singleton.h"
 #include "Common/Event.h"
 
@@ -55,19 +55,22 @@ typedef std::function<bool (IEventPtr)> EventListenerCallback;
 // Use a HashString as the basis for EventListenerType's.
 typedef HashString EventListenerType;
 
-// Most of the time spent processing events will be iterating over a collection
-// of callbacks to notify about an event so we want to make use of std::list, however,
-// very infrequently we also want to be able to add and remove listeners and need a
-// way to identify them in the list so a std::pair is used as the node.
+// Most of the time spent processing events will be iterating over the callbacks
+// to notify about an event, so they are kept in a contiguous vector per event type.
+// Very infrequently we also want to be able to add and remove listeners and need a
+// way to identify them in the list so a std::pair is used as the element.
 typedef std::pair<EventListenerType, EventListenerCallback> EventListener;
-typedef std::list<EventListener> EventListenerList;
-typedef std::map<EventType, EventListenerList> EventListenerMap;
-typedef std::set<EventType> EventTypeSet;
+typedef std::vector<EventListener> EventListenerList;
 typedef std::priority_queue<IEventPtr, std::vector<IEventPtr>, CompareEventWeightLessThanPredicate> EventQueue;
 
 /*! \brief The event dispatcher is a facility for triggering events and passing messages
  * between different "modules" of code that may or may not be running on separate
  * processes or even separate physical machines.
+ *
+ * The dispatcher belongs to the thread that creates it, which is expected to drive
+ * it with Tick. Calls made from that thread are handled right away without any
+ * locking. Other threads notify through a lock-free ring per producer thread, and
+ * their other requests are queued and answered on the next Tick.
  */
 class EventDispatcher {
 public:
@@ -127,6 +130,17 @@ public:
      */
     boost::unique_future<bool> Deliver(IEventPtr triggered_event);
 
+    /**
+     * Delivers an event immediately on the calling thread, without a future.
+     *
+     * Meant for the dispatcher's own thread, from any other thread this waits
+     * for the next Tick.
+     *
+     * \param triggered_event The triggered event to be delivered.
+     * \returns True if all listeners handled the event.
+     */
+    bool DeliverNow(IEventPtr triggered_event);
+
     /**
      * A check to see if there are any events waiting to be processed.
      *
@@ -134,6 +148,23 @@ public:
      */
     boost::unique_future<bool> HasEvents();
 
+    /**
+     * Same as HasEvents without the future, safe to call from any thread.
+     */
+    bool HasPendingEvents() const;
+
+    /**
+     * Earliest time a queued event becomes due, the current timestep if events
+     * posted by other threads are still waiting to be picked up.
+     *
+     * Only meaningful on the dispatcher's own thread.
+     *
+     * \returns The next deadline, or kNoDeadline if nothing is queued.
+     */
+    uint64_t NextDeadline() const;
+
+    static const uint64_t kNoDeadline = 0xffffffffffffffffULL;
+
     /**
      * Processes all queued events.
      */
@@ -153,31 +184,66 @@ private:
     /// Disable the default assignment operator.
     EventDispatcher& operator=(const EventDispatcher&);
 
+    class ProducerRing;
+
+    typedef std::function<void ()> Call;
+
+    enum ClassConstants
+    {
+        // Uses a double buffered queue to prevent events that generate events from creating
+        // an infinite loop.
+        kNumQueues = 2,
+        kMaxProducers = 32,
+        kNoIndex = 0xffffffff
+    };
+
+    bool IsOwnerThread_() const;
+
+    // Runs a call right away on the owning thread and otherwise on its next Tick,
+    // registry changes made while listeners run are held back until the delivery is over.
+    void Call_(Call call);
+    void Query_(Call call);
+    void RunRemoteCalls_();
+
+    ProducerRing* FindProducerRing_();
+    void DrainProducerRings_();
+    void Enqueue_(IEventPtr triggered_event);
+    void Queue_(int queue, IEventPtr triggered_event);
+
+    bool Tick_(uint64_t new_timestep);
+
     bool ValidateEventType_(const EventType& event_type) const;
     bool ValidateEventListenerType_(const EventListenerType& event_listener_type) const;
-    bool AddEventType_(const EventType& event_type);
+    uint32_t AddEventType_(const EventType& event_type);
+    uint32_t FindEventType_(const EventType& event_type) const;
+    void Connect_(const EventType& event_type, const EventListener& listener);
     void Disconnect_(const EventType& event_type, const EventListenerType& event_listener_type);
+    void DisconnectFromAll_(const EventListenerType& event_listener_type);
     bool Deliver_(IEventPtr triggered_event);
-        
-    EventTypeSet event_type_set_;
 
-    EventListenerMap event_listener_map_;
+    // Event types are resolved to a dense index when the first listener connects,
+    // event_types_ and event_listeners_ are indexed by it.
+    std::unordered_map<uint32_t, uint32_t> event_type_indices_;
+    std::vector<EventType> event_types_;
+    std::vector<EventListenerList> event_listeners_;
+    uint32_t wildcard_index_;
 
-    uint64_t current_timestep_;
-    
-    // Uses a double buffered queue to prevent events that generate events from creating
-    // an infinite loop.
+    tbb::atomic<uint64_t> current_timestep_;
+    tbb::atomic<uint32_t> pending_events_;
 
-    enum ClassConstants
-    {
-        kNumQueues = 2
-    };
-        
     EventQueue event_queue_[kNumQueues];
-
     int active_queue_;
-    
-    utils::ActiveObject active_;
+    uint64_t next_deadline_;
+
+    boost::thread::id owner_thread_;
+    uint32_t delivery_depth_;
+    std::vector<Call> deferred_calls_;
+
+    // Filled by other threads, drained at the start of every Tick.
+    tbb::atomic<ProducerRing*> producer_rings_[kMaxProducers];
+    boost::mutex producer_mutex_;
+    std::vector<IEventPtr> overflow_events_;
+    utils::ConcurrentQueue<Call> remote_calls_;
 };
 
 }  // namespace common
@@ -25,6 +25,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ---------------------------------------------------------------------------------------
 */
 
+#include <iostream>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
 #include <gtest/gtest.h>
 
 #include "Common/EventDispatcher.h"
@@ -451,6 +456,26 @@ TEST(EventDispatcherTests, DelayedEventsAreOnlyProcessedAfterTimeoutHasBeenReach
     EXPECT_TRUE(listener.triggered());
 }
 
+TEST(EventDispatcherTests, NextDeadlineIsEarliestDelayedEvent) {
+    // Create the EventDispatcher and initialize it with a current timestamp.
+    EventDispatcher dispatcher(100);
+
+    // Nothing queued, nothing to wait for.
+    EXPECT_EQ(uint64_t(EventDispatcher::kNoDeadline), dispatcher.NextDeadline());
+
+    // Queue two delayed events, the earlier one decides.
+    dispatcher.Notify(std::make_shared<MockEvent>(0, 20));
+    dispatcher.Notify(std::make_shared<MockEvent>(0, 5));
+    EXPECT_EQ(uint64_t(105), dispatcher.NextDeadline());
+
+    // Once it has been delivered the later one is next.
+    dispatcher.Tick(110).get();
+    EXPECT_EQ(uint64_t(120), dispatcher.NextDeadline());
+
+    dispatcher.Tick(120).get();
+    EXPECT_EQ(uint64_t(EventDispatcher::kNoDeadline), dispatcher.NextDeadline());
+}
+
 TEST(EventDispatcherTests, DeliveringNullEventReturnsFalse) {
     // Create the EventDispatcher.
     EventDispatcher dispatcher;
@@ -494,4 +519,143 @@ TEST(EventDispatcherTests, DeliveringEventsSetsTimestamp) {
     EXPECT_EQ(uint64_t(100), my_event->timestamp());
 }
 
+TEST(EventDispatcherTests, DeliverNowReturnsListenerResult) {
+    EventDispatcher dispatcher(100);
+    MockListener listener;
+
+    EventListenerCallback callback(std::bind(&MockListener::HandleEvent, &listener, std::placeholders::_1));
+    dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("MockListener"), callback));
+
+    // A failing listener fails the whole delivery.
+    dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("Failing"), [] (IEventPtr) { return false; }));
+
+    auto my_event = std::make_shared<MockEvent>();
+    EXPECT_FALSE(dispatcher.DeliverNow(my_event));
+    EXPECT_TRUE(listener.triggered());
+    EXPECT_EQ(uint64_t(100), my_event->timestamp());
+
+    dispatcher.Disconnect(EventType("mock_event"), EventListenerType("Failing"));
+    EXPECT_TRUE(dispatcher.DeliverNow(std::make_shared<MockEvent>()));
+    EXPECT_FALSE(dispatcher.DeliverNow(nullptr));
+}
+
+TEST(EventDispatcherTests, ListenersChangedDuringDeliveryApplyAfterwards) {
+    EventDispatcher dispatcher;
+    int calls = 0;
+
+    // The first listener removes itself and a second one, both still run for this event.
+    dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("First"), [&] (IEventPtr) -> bool {
+        ++calls;
+        dispatcher.Disconnect(EventType("mock_event"), EventListenerType("First"));
+        dispatcher.Disconnect(EventType("mock_event"), EventListenerType("Second"));
+        dispatcher.Connect(EventType("other_event"), EventListener(EventListenerType("Third"), [] (IEventPtr) { return true; }));
+        return true;
+    }));
+    dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("Second"), [&] (IEventPtr) -> bool {
+        ++calls;
+        return true;
+    }));
+
+    EXPECT_TRUE(dispatcher.DeliverNow(std::make_shared<MockEvent>()));
+    EXPECT_EQ(2, calls);
+
+    EXPECT_EQ(0u, dispatcher.GetListeners(EventType("mock_event")).get().size());
+    EXPECT_EQ(1u, dispatcher.GetListeners(EventType("other_event")).get().size());
+
+    EXPECT_TRUE(dispatcher.DeliverNow(std::make_shared<MockEvent>()));
+    EXPECT_EQ(2, calls);
+}
+
+TEST(EventDispatcherTests, EventsFromOtherThreadsAreDeliveredOnTick) {
+    const int producers = 4;
+    const int events_per_producer = 5000;
+
+    EventDispatcher dispatcher(1);
+    int delivered = 0;
+
+    dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("Counter"), [&] (IEventPtr) -> bool {
+        ++delivered;
+        return true;
+    }));
+
+    std::vector<std::shared_ptr<boost::thread>> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.push_back(std::make_shared<boost::thread>([&dispatcher] {
+            // More than a ring holds, so some spill into the overflow list.
+            for (int j = 0; j < events_per_producer; ++j) {
+                dispatcher.Notify(std::make_shared<MockEvent>());
+            }
+        }));
+    }
+
+    // Keep ticking while the producers are running.
+    uint64_t timestep = 1;
+    for (auto it = threads.begin(); it != threads.end(); ++it) {
+        while (!(*it)->timed_join(boost::posix_time::milliseconds(1))) {
+            dispatcher.Tick(++timestep);
+        }
+    }
+
+    dispatcher.Tick(++timestep);
+
+    EXPECT_EQ(producers * events_per_producer, delivered);
+    EXPECT_FALSE(dispatcher.HasPendingEvents());
+}
+
+TEST(EventDispatcherTests, CallsFromOtherThreadsAreAnsweredOnTick) {
+    EventDispatcher dispatcher;
+    MockListener listener;
+
+    EventListenerCallback callback(std::bind(&MockListener::HandleEvent, &listener, std::placeholders::_1));
+
+    boost::unique_future<bool> result;
+    boost::thread producer([&] {
+        dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("MockListener"), callback));
+        result = dispatcher.Deliver(std::make_shared<MockEvent>());
+    });
+    producer.join();
+
+    EXPECT_FALSE(result.is_ready());
+    EXPECT_FALSE(listener.triggered());
+
+    dispatcher.Tick(1);
+
+    ASSERT_TRUE(result.is_ready());
+    EXPECT_TRUE(result.get());
+    EXPECT_TRUE(listener.triggered());
+}
+
+// Same thread delivery, the way the object controller uses it, against the
+// old round trip through the dispatcher thread and a future.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST(EventDispatcherTests, DISABLED_BenchmarkSameThreadDelivery) {
+    const int iterations = 200000;
+
+    EventDispatcher dispatcher;
+    int delivered = 0;
+
+    dispatcher.Connect(EventType("mock_event"), EventListener(EventListenerType("Counter"), [&] (IEventPtr) -> bool {
+        ++delivered;
+        return true;
+    }));
+
+    auto my_event = std::make_shared<MockEvent>(0, 0);
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (int i = 0; i < iterations; ++i) {
+        dispatcher.DeliverNow(my_event);
+    }
+    boost::posix_time::ptime direct = boost::posix_time::microsec_clock::universal_time();
+    for (int i = 0; i < iterations; ++i) {
+        dispatcher.Deliver(my_event).get();
+    }
+    boost::posix_time::ptime future = boost::posix_time::microsec_clock::universal_time();
+
+    std::cout << "DeliverNow " << (direct - start).total_microseconds() * 1000.0 / iterations << " ns, "
+              << "Deliver().get() " << (future - direct).total_microseconds() * 1000.0 / iterations << " ns per event"
+              << std::endl;
+
+    EXPECT_EQ(2 * iterations, delivered);
+}
+
 }
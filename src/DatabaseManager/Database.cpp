@@ -38,9 +38,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdlib>
 #include <cstdio>
 #include <algorithm>
+#include <sstream>
+#include <vector>
 
 #include <glog/logging.h>
 
+#include <cppconn/resultset.h>
+
 #include "Common/ConfigManager.h"
 
 #include "DatabaseManager/DataBinding.h"
@@ -51,8 +55,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/DatabaseJob.h"
 #include "DatabaseManager/DatabaseType.h"
 #include "DatabaseManager/DatabaseWorkerThread.h"
+#include "DatabaseManager/StaticDataImage.h"
 #include "DatabaseManager/Transaction.h"
 
+#include "Utils/EventLoop.h"
+
 
 Database::Database(DBType type, const std::string& host, uint16_t port, const std::string& user, const std::string& pass, const std::string& schema) 
     : database_impl_(nullptr)
@@ -104,7 +111,7 @@ void Database::executeAsyncSql(const std::string& sql) {
     job->multi_job = false;
 
     // Add the job to our processList;
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
 }
 void Database::executeAsyncSql(const std::stringstream& sql, AsyncDatabaseCallback callback) {    
     // just pass the stringstream string
@@ -119,7 +126,7 @@ void Database::executeAsyncSql(const std::string& sql, AsyncDatabaseCallback cal
     job->multi_job = false;
 
     // Add the job to our processList;
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
 }
 
 void Database::executeAsyncProcedure(const std::stringstream& sql) {    
@@ -133,7 +140,7 @@ void Database::executeAsyncProcedure(const std::string& sql) {
     job->multi_job = true;
 
     // Add the job to our processList;
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
 }
 
 void Database::executeAsyncProcedure(const std::stringstream& sql, AsyncDatabaseCallback callback) {    
@@ -148,7 +155,7 @@ void Database::executeAsyncProcedure(const std::string& sql, AsyncDatabaseCallba
     job->multi_job = true;
 
     // Add the job to our processList;
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
 }
 
 
@@ -192,6 +199,13 @@ void Database::process() {
     for (int i = 0; i < completed; ++i) {
         // let our client handle the result, if theres a callback
         if( job_complete_queue_.try_pop(job)) {
+            // static data that came from the database goes into the next image
+            if (job->static_data && static_image_ && job->result && job->result->getResultSet()) {
+                if (static_image_->recordTable(job->query, job->result->getResultSet().get())) {
+                    checksumStaticSources();
+                }
+            }
+
             if (job->old_callback) {
                 job->old_callback->handleDatabaseJobComplete(job->client_reference, job->result);
             }
@@ -252,7 +266,7 @@ void Database::executeSqlAsync(DatabaseCallback* callback,
     job->multi_job = false;
 
     // Add the job to our processList;
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
 }
 
 //the reasoning behind this is the following
@@ -277,7 +291,118 @@ void Database::executeSqlAsyncNoArguments(DatabaseCallback* callback,
     job->multi_job = false;
 
     // Add the job to our processList;
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
+}
+
+
+void Database::executeAsyncInsert(const std::string& sql, AsyncDatabaseCallback callback) {
+    // Setup our job.
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->callback = callback;
+    job->query = sql;
+    job->multi_job = false;
+    job->read_back = "SELECT ROW_COUNT(), LAST_INSERT_ID()";
+
+    pushDatabaseJobPending(job);
+}
+
+
+void Database::executeAsyncUpdate(const std::string& sql, const std::string& read_back, AsyncDatabaseCallback callback) {
+    // Setup our job.
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->callback = callback;
+    job->query = sql;
+    job->multi_job = false;
+    job->read_back = read_back;
+
+    pushDatabaseJobPending(job);
+}
+
+
+void Database::executeStaticSqlAsync(DatabaseCallback* callback, 
+                                     void* ref, const char* sql, ...)
+{
+    // format our sql string
+    va_list args;
+    va_start(args, sql);
+    char localSql[20192];
+    vsnprintf(localSql, sizeof(localSql), sql, args);
+    va_end(args);
+
+    // Setup our job.
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->old_callback = callback;
+    job->client_reference = ref;
+    job->query = localSql;
+    job->multi_job = false;
+    job->static_data = true;
+
+    pushStaticDatabaseJob(job);
+}
+
+
+void Database::executeStaticAsyncSql(const std::string& sql, AsyncDatabaseCallback callback) {
+    // Setup our job.
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->callback = callback;
+    job->query = sql;
+    job->multi_job = false;
+    job->static_data = true;
+
+    pushStaticDatabaseJob(job);
+}
+
+
+void Database::openStaticDataImage(const std::string& filename, bool rebuild) {
+    static_image_.reset(new StaticDataImage());
+    static_image_filename_ = filename;
+
+    if (rebuild || !static_image_->map(filename)) {
+        LOG(INFO) << "Static data is loaded from the database and recorded to [" << filename << "]";
+        return;
+    }
+
+    // tables whose database content changed since the image was written are loaded again
+    checksumStaticSources();
+
+    if (uint32_t dropped = static_image_->dropStaleTables()) {
+        LOG(INFO) << "Static data image: " << dropped << " tables changed in the database, they are loaded again";
+    }
+}
+
+
+void Database::checksumStaticSources() {
+    std::vector<std::string> sources = static_image_->getUncheckedSources();
+
+    if (sources.empty()) {
+        return;
+    }
+
+    std::stringstream query;
+    query << "CHECKSUM TABLE ";
+    for (size_t i = 0; i < sources.size(); ++i) {
+        query << (i ? ", " : "") << sources[i];
+    }
+
+    DatabaseResult* result = database_impl_->executeSql(query.str());
+
+    // rows come back as schema.table in the order they were asked for, a
+    // missing table has a NULL checksum
+    std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+    for (size_t i = 0; result_set && i < sources.size() && result_set->next(); ++i) {
+        static_image_->setChecksum(sources[i], result_set->isNull(2) ? 0 : result_set->getUInt64(2));
+    }
+
+    database_impl_->destroyResult(result);
+}
+
+
+bool Database::saveStaticDataImage() {
+    if (!static_image_ || !static_image_->getRecordedCount()) {
+        return false;
+    }
+
+    return static_image_->write(static_image_filename_);
 }
 
 
@@ -313,7 +438,7 @@ void Database::executeProcedureAsync(DatabaseCallback* callback,
     job->multi_job = true;
 
     // Add the job to our processList
-    job_pending_queue_.push(job);
+    pushDatabaseJobPending(job);
 }
 
 
@@ -376,6 +501,36 @@ bool Database::releaseBindingPoolMemory() {
     return(binding_factory_.releasePoolMemory());
 }
 
+void Database::pushDatabaseJobPending(DatabaseJob* job) {
+    job_pending_queue_.push(job);
+
+    // jobs are only handed to the workers from process()
+    if (Anh_Utils::EventLoop* loop = gEventLoop) {
+        loop->wakeup();
+    }
+}
+
+void Database::pushStaticDatabaseJob(DatabaseJob* job) {
+    uint32_t table;
+
+    if (!static_image_ || !static_image_->findTable(job->query, table)) {
+        pushDatabaseJobPending(job);
+        return;
+    }
+
+    // answered right away, the callback still runs from process() like any
+    // other completed query
+    job->result = new(ResultPool::ordered_malloc()) DatabaseResult(*database_impl_, nullptr, nullptr, false);
+    job->result->setStaticTable(static_image_.get(), table);
+    job->static_data = false;
+
+    pushDatabaseJobComplete(job);
+}
+
 void Database::pushDatabaseJobComplete(DatabaseJob* job) {
     job_complete_queue_.push(job);
+
+    if (Anh_Utils::EventLoop* loop = gEventLoop) {
+        loop->wakeup();
+    }
 }
@@ -49,6 +49,7 @@ class DataBinding;
 class DatabaseWorkerThread;
 class DatabaseImplementation;
 class DatabaseResult;
+class StaticDataImage;
 class Transaction;
 
 typedef tbb::concurrent_queue<DatabaseJob*> DatabaseJobQueue;
@@ -98,6 +99,25 @@ public:
     */
     void executeAsyncSql(const std::string& sql, AsyncDatabaseCallback callback);
 
+    /*! Executes an asynchronus INSERT and invokes the specified callback with
+    * a single row holding the number of rows it affected and the auto
+    * increment id it generated, both read on the connection that ran it.
+    *
+    * \param sql The insert to run.
+    * \param callback The callback to invoke once the insert has been executed.
+    */
+    void executeAsyncInsert(const std::string& sql, AsyncDatabaseCallback callback);
+
+    /*! Executes an asynchronus UPDATE followed by a query on the same connection,
+    * so the query sees the session state the update left behind, such as
+    * ROW_COUNT() or user variables. The callback gets the query's result.
+    *
+    * \param sql The update to run.
+    * \param read_back The query to run after it.
+    * \param callback The callback to invoke once both have been executed.
+    */
+    void executeAsyncUpdate(const std::string& sql, const std::string& read_back, AsyncDatabaseCallback callback);
+
     /*! Executes an asynchronus stored procedure.
     *
     * \param sql The sql query to run.
@@ -160,6 +180,41 @@ public:
     */
     void executeProcedureAsync(DatabaseCallback* callback, void* ref, const char* sql, ...);
 
+    /*! Executes a query for static game data asynchronusly. If the query is
+    * in the static data image it is answered from there, otherwise it is run
+    * on the database and its rows are recorded for the next image. Results
+    * must be read with getNextRow, they have no result set.
+    *
+    * \param callback The database callback to invoke once the query has been answered.
+    * \param ref State data needed for the callback to process the result.
+    * \param sql The sql query to run, queries are matched by their text.
+    */
+    void executeStaticSqlAsync(DatabaseCallback* callback, void* ref, const char* sql, ...);
+
+    /*! Executes a query for static game data asynchronusly and invokes the
+    * specified callback on completion, see executeStaticSqlAsync.
+    *
+    * \param sql The sql query to run.
+    * \param callback The callback to invoke once the sql query has been executed.
+    */
+    void executeStaticAsyncSql(const std::string& sql, AsyncDatabaseCallback callback);
+
+    /*! Maps the static data image shared by all zones on this host. Tables
+    * whose database tables changed since they were recorded are dropped from
+    * it, their queries go to the database again.
+    *
+    * \param filename The image file.
+    * \param rebuild Ignore an existing image and record a new one.
+    */
+    void openStaticDataImage(const std::string& filename, bool rebuild);
+
+    /*! Writes the static data image if queries were recorded since it was
+    * mapped or last written.
+    *
+    * \return Returns true if a new image was written.
+    */
+    bool saveStaticDataImage();
+
     /*! Escapes a string to prepare for storage in a database.
     *
     * \param target The container to hold the escaped string.
@@ -243,7 +298,10 @@ private:
 
     DatabaseResult* executeSql(const char* sql, ...);
     
+    void pushDatabaseJobPending(DatabaseJob* job);
     void pushDatabaseJobComplete(DatabaseJob* job);
+    void pushStaticDatabaseJob(DatabaseJob* job);
+    void checksumStaticSources();
 
     DataBindingFactory binding_factory_;
 
@@ -252,6 +310,8 @@ private:
     DatabaseWorkerThreadQueue idle_worker_queue_;
 
     std::unique_ptr<DatabaseImplementation> database_impl_;  // Use this implementation for any syncronous calls.
+    std::unique_ptr<StaticDataImage> static_image_;
+    std::string static_image_filename_;
     
     boost::pool<boost::default_user_allocator_malloc_free> job_pool_;
     boost::pool<boost::default_user_allocator_malloc_free> transaction_pool_;
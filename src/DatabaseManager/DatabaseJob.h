@@ -45,6 +45,7 @@ public:
         , result(NULL)
         , client_reference(NULL)
         , multi_job(false) 
+        , static_data(false)
     {}
 
     boost::optional<AsyncDatabaseCallback> callback;
@@ -53,6 +54,9 @@ public:
     void* client_reference;
     std::string query;
     bool multi_job;
+    bool static_data;
+    // run after the query on the same connection, its result is handed on instead
+    std::string read_back;
 };
 
 #endif // ANH_DATABASEMANAGER_DATABASEJOB_H
@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "DatabaseResult.h"
 #include "DatabaseImplementation.h"
+#include "StaticDataImage.h"
 
 #include <cppconn/resultset.h>
 #include <cppconn/statement.h>
@@ -45,7 +46,10 @@ DatabaseResult::DatabaseResult(const DatabaseImplementation& impl, sql::Statemen
 	, statement_(statement)
     , impl_(impl)
     , worker_(nullptr)
-    , multi_result_(multi_result) {}
+    , multi_result_(multi_result)
+    , static_image_(nullptr)
+    , static_table_(0)
+    , static_row_(0) {}
 
 
 DatabaseResult::~DatabaseResult() {}
@@ -62,12 +66,22 @@ std::unique_ptr<sql::ResultSet>& DatabaseResult::getResultSet() {
 
 
 void DatabaseResult::getNextRow(DataBinding* dataBinding, void* object) {
+    if (static_image_) {
+        static_image_->getRow(static_table_, static_row_++, dataBinding, object);
+        return;
+    }
+
     // Just shunt this method to the actual implementation method.  This might have thread problems right now.
     impl_.getNextRow(this, dataBinding, object);
 }
 
 
 void DatabaseResult::resetRowIndex(int index) {
+    if (static_image_) {
+        static_row_ = index;
+        return;
+    }
+
     impl_.resetRowIndex(this,index);
 }
 
@@ -82,12 +96,23 @@ DatabaseWorkerThread* DatabaseResult::getWorkerReference() {
 }
 
 
+void DatabaseResult::setStaticTable(const StaticDataImage* image, uint32_t table) {
+    static_image_ = image;
+    static_table_ = table;
+    static_row_ = 0;
+}
+
+
 bool DatabaseResult::isMultiResult() {
     return multi_result_;
 }
 
 
 uint64_t DatabaseResult::getRowCount() { 
+    if (static_image_) {
+        return static_image_->getRowCount(static_table_);
+    }
+
     return result_set_ ? result_set_->rowsCount() : 0; 
 }
 
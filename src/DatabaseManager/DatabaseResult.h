@@ -42,6 +42,7 @@ class Database;
 class DatabaseImplementation;
 class DataBinding;
 class DatabaseWorkerThread;
+class StaticDataImage;
 
 /*! A container class for database results. 
 */
@@ -98,6 +99,10 @@ private:
     void setWorkerReference(DatabaseWorkerThread* worker);
     DatabaseWorkerThread* getWorkerReference();
 
+    // Rows of results answered from a static data image are read from the
+    // image, these results have no statement or result set.
+    void setStaticTable(const StaticDataImage* image, uint32_t table);
+
     std::unique_ptr<sql::ResultSet> result_set_;
     std::unique_ptr<sql::Statement> statement_;
 
@@ -105,6 +110,9 @@ private:
 
     DatabaseWorkerThread* worker_;
     bool multi_result_;
+    const StaticDataImage* static_image_;
+    uint32_t static_table_;
+    uint64_t static_row_;
 };
 
 #endif //MMOSERVER_DATABASEMANAGER_DATABASERESULT_H
@@ -44,6 +44,13 @@ DatabaseWorkerThread::DatabaseWorkerThread(DBType type, const std::string& host,
 void DatabaseWorkerThread::executeJob(DatabaseJob* job, Callback callback) { 
     active_.Send([=] {
         job->result = database_impl_->executeSql(job->query.c_str(), job->multi_job);
+
+        // what a statement left in the session can only be read on the connection that ran it
+        if (!job->read_back.empty() && job->result) {
+            database_impl_->destroyResult(job->result);
+            job->result = database_impl_->executeSql(job->read_back.c_str());
+        }
+
         callback(this, job);
     }); 
 }
@@ -0,0 +1,692 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "DatabaseManager/StaticDataImage.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Fix for issues with glog redefining this constant
+#ifdef ERROR
+#undef ERROR
+#endif
+
+#include <glog/logging.h>
+
+#include <cppconn/resultset.h>
+#include <cppconn/resultset_metadata.h>
+
+#include "Utils/bstring.h"
+
+#include "DatabaseManager/DataBinding.h"
+
+using namespace boost::interprocess;
+
+namespace {
+
+const uint32_t kImageMagic   = 0x4d494453;  // "SDIM"
+const uint32_t kImageVersion = 3;
+const uint32_t kNullCell     = 0xffffffff;
+
+// Everything after the header is addressed by byte offsets from the start of
+// the image. Strings live in a pool as a 32 bit length followed by the bytes
+// and a terminating zero, padded to 4 bytes, identical strings are stored once.
+struct ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t created;
+    uint64_t size;
+    uint32_t table_count;
+    uint32_t pool_offset;
+    uint32_t pool_size;
+    uint32_t reserved;
+};
+
+struct ImageTable {
+    uint32_t query;         // pool offset of the query text
+    uint32_t column_count;
+    uint32_t row_count;
+    uint32_t cells;         // row major pool offsets, kNullCell for NULL
+    uint32_t sources;       // pool offset of the comma separated source tables
+    uint32_t reserved;
+    uint64_t content;       // key over the checksums of the source tables
+};
+
+// Collects the string pool of a new image.
+class PoolWriter {
+public:
+    uint32_t add(const std::string& value) {
+        std::map<std::string, uint32_t>::iterator it = offsets_.find(value);
+        if (it != offsets_.end()) {
+            return it->second;
+        }
+
+        uint32_t offset = static_cast<uint32_t>(pool_.size());
+        uint32_t length = static_cast<uint32_t>(value.size());
+
+        pool_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        pool_.append(value);
+        pool_.append(4 - (value.size() % 4), '\0');
+
+        offsets_.insert(std::make_pair(value, offset));
+        return offset;
+    }
+
+    const std::string& getPool() const {
+        return pool_;
+    }
+
+private:
+    std::map<std::string, uint32_t> offsets_;
+    std::string                     pool_;
+};
+
+// Splits a query into words, backtick quoted names and the punctuation that
+// separates table references. String literals are skipped.
+std::vector<std::string> tokenizeQuery(const std::string& query) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+
+    while (i < query.size()) {
+        char c = query[i];
+
+        if (c == '\'' || c == '"') {
+            size_t end = i + 1;
+            while (end < query.size() && query[end] != c) {
+                end += (query[end] == '\\') ? 2 : 1;
+            }
+            i = end + 1;
+        } else if (c == '`') {
+            size_t end = query.find('`', i + 1);
+            if (end == std::string::npos) {
+                end = query.size();
+            }
+            tokens.push_back(query.substr(i + 1, end - i - 1));
+            i = end + 1;
+        } else if (isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$') {
+            size_t end = i;
+            while (end < query.size() && (isalnum(static_cast<unsigned char>(query[end])) || query[end] == '_' || query[end] == '$' || query[end] == '.' || query[end] == '`')) {
+                ++end;
+            }
+
+            std::string word = query.substr(i, end - i);
+            word.erase(std::remove(word.begin(), word.end(), '`'), word.end());
+            tokens.push_back(word);
+            i = end;
+        } else if (c == '(' || c == ')' || c == ',' || c == ';') {
+            tokens.push_back(std::string(1, c));
+            ++i;
+        } else {
+            ++i;
+        }
+    }
+
+    return tokens;
+}
+
+bool isKeyword(const std::string& token, const char* keyword) {
+    if (token.size() != strlen(keyword)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (toupper(static_cast<unsigned char>(token[i])) != keyword[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Words that end a table reference, anything else after a table name is its alias.
+bool endsTableReference(const std::string& token) {
+    static const char* keywords[] = {
+        "WHERE", "ON", "USING", "JOIN", "INNER", "LEFT", "RIGHT", "CROSS", "NATURAL", "OUTER",
+        "STRAIGHT_JOIN", "ORDER", "GROUP", "HAVING", "LIMIT", "UNION", "FOR", "LOCK", "INTO",
+        "PROCEDURE", "FORCE", "USE", "IGNORE", "PARTITION", NULL
+    };
+
+    if (token.empty() || !(isalnum(static_cast<unsigned char>(token[0])) || token[0] == '_' || token[0] == '$')) {
+        return true;
+    }
+
+    for (const char** keyword = keywords; *keyword; ++keyword) {
+        if (isKeyword(token, *keyword)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Collects the tables named in the FROM and JOIN clauses of a query, those
+// of its subqueries included. A query that reads no table, like a procedure
+// call, collects nothing.
+void collectSources(const std::string& query, std::set<std::string>& sources) {
+    std::vector<std::string> tokens = tokenizeQuery(query);
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        bool from = isKeyword(tokens[i], "FROM");
+
+        if (!from && !isKeyword(tokens[i], "JOIN") && !isKeyword(tokens[i], "STRAIGHT_JOIN")) {
+            continue;
+        }
+
+        // a FROM takes a comma separated list, a JOIN a single table
+        size_t next = i + 1;
+        while (next < tokens.size() && !endsTableReference(tokens[next])) {
+            if (!isKeyword(tokens[next], "DUAL")) {
+                sources.insert(tokens[next]);
+            }
+            ++next;
+
+            if (next < tokens.size() && isKeyword(tokens[next], "AS")) {
+                ++next;
+            }
+            if (next < tokens.size() && !endsTableReference(tokens[next])) {
+                ++next;
+            }
+
+            if (!from || next >= tokens.size() || tokens[next] != ",") {
+                break;
+            }
+            ++next;
+        }
+    }
+}
+
+}
+
+
+StaticDataImage::StaticDataImage()
+    : image_(nullptr)
+    , image_size_(0)
+{}
+
+
+StaticDataImage::~StaticDataImage() {}
+
+
+bool StaticDataImage::map(const std::string& filename) {
+    TableIndex tables;
+
+    try {
+        file_mapping mapping(filename.c_str(), read_only);
+        mapped_region region(mapping, read_only);
+
+        const unsigned char* image = static_cast<const unsigned char*>(region.get_address());
+        uint64_t image_size = region.get_size();
+
+        const ImageHeader* header = reinterpret_cast<const ImageHeader*>(image);
+
+        if ((image_size < sizeof(ImageHeader))
+                || (header->magic != kImageMagic)
+                || (header->version != kImageVersion)
+                || (header->size != image_size)
+                || (header->pool_offset < sizeof(ImageHeader) + (uint64_t)header->table_count * sizeof(ImageTable))
+                || ((uint64_t)header->pool_offset + header->pool_size > image_size)) {
+            LOG(WARNING) << "StaticDataImage: [" << filename << "] is invalid, it will be rebuilt";
+            return false;
+        }
+
+        // check every offset once here, so reads never have to
+        const ImageTable* table_list = reinterpret_cast<const ImageTable*>(image + sizeof(ImageHeader));
+        const unsigned char* pool = image + header->pool_offset;
+
+        for (uint32_t i = 0; i < header->table_count; ++i) {
+            const ImageTable& table = table_list[i];
+            uint64_t cell_count = (uint64_t)table.row_count * table.column_count;
+
+            bool valid = ((uint64_t)table.cells + cell_count * sizeof(uint32_t) <= header->pool_offset);
+
+            const uint32_t* cells = reinterpret_cast<const uint32_t*>(image + table.cells);
+
+            for (uint64_t cell = 0; valid && cell < cell_count + 2; ++cell) {
+                // the query text and the source tables are checked as the last cells
+                uint32_t offset = (cell < cell_count) ? cells[cell] : (cell == cell_count) ? table.query : table.sources;
+
+                if (offset == kNullCell && cell < cell_count) {
+                    continue;
+                }
+
+                uint32_t length;
+                valid = ((uint64_t)offset + sizeof(length) <= header->pool_size);
+
+                if (valid) {
+                    memcpy(&length, pool + offset, sizeof(length));
+                    valid = ((uint64_t)offset + sizeof(length) + length < header->pool_size)
+                        && (pool[offset + sizeof(length) + length] == 0);
+                }
+            }
+
+            if (!valid) {
+                LOG(WARNING) << "StaticDataImage: [" << filename << "] table " << i << " is corrupt, it will be rebuilt";
+                return false;
+            }
+
+            tables.insert(std::make_pair(std::string(reinterpret_cast<const char*>(pool + table.query + sizeof(uint32_t))), i));
+        }
+
+        file_mapping_.swap(mapping);
+        mapped_region_.swap(region);
+
+        image_      = image;
+        image_size_ = image_size;
+    } catch (interprocess_exception& e) {
+        LOG(INFO) << "StaticDataImage: unable to map [" << filename << "]: " << e.what();
+        return false;
+    }
+
+    tables_.swap(tables);
+
+    LOG(INFO) << "StaticDataImage: mapped [" << filename << "], " << tables_.size() << " tables, " << image_size_ / 1024 << " kb";
+    return true;
+}
+
+
+bool StaticDataImage::isMapped() const {
+    return image_ != nullptr;
+}
+
+
+bool StaticDataImage::findTable(const std::string& query, uint32_t& table) const {
+    TableIndex::const_iterator it = tables_.find(query);
+
+    if (it == tables_.end()) {
+        return false;
+    }
+
+    table = it->second;
+    return true;
+}
+
+
+uint64_t StaticDataImage::getRowCount(uint32_t table) const {
+    const ImageTable* table_list = reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader));
+    return table_list[table].row_count;
+}
+
+
+const char* StaticDataImage::getCell_(uint32_t table, uint64_t row, uint32_t column, uint32_t& length) const {
+    const ImageHeader* header = reinterpret_cast<const ImageHeader*>(image_);
+    const ImageTable& entry = reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader))[table];
+
+    length = 0;
+
+    if (column >= entry.column_count) {
+        return "";
+    }
+
+    uint32_t offset = reinterpret_cast<const uint32_t*>(image_ + entry.cells)[row * entry.column_count + column];
+
+    // NULL reads like the connector reports it, 0 or an empty string
+    if (offset == kNullCell) {
+        return "";
+    }
+
+    const unsigned char* cell = image_ + header->pool_offset + offset;
+    memcpy(&length, cell, sizeof(length));
+
+    return reinterpret_cast<const char*>(cell + sizeof(length));
+}
+
+
+const char* StaticDataImage::getSources_(uint32_t table) const {
+    const ImageHeader* header = reinterpret_cast<const ImageHeader*>(image_);
+    const ImageTable& entry = reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader))[table];
+
+    return reinterpret_cast<const char*>(image_ + header->pool_offset + entry.sources + sizeof(uint32_t));
+}
+
+
+uint64_t StaticDataImage::getContentKey_(const std::string& sources) const {
+    // FNV-1a over "name=checksum" of every source, 0 while one isn't known
+    uint64_t key = 14695981039346656037ULL;
+
+    std::stringstream stream(sources);
+    std::string source;
+
+    while (std::getline(stream, source, ',')) {
+        Checksums::const_iterator it = checksums_.find(source);
+        if (it == checksums_.end()) {
+            return 0;
+        }
+
+        std::stringstream entry;
+        entry << source << "=" << it->second << ";";
+
+        const std::string& bytes = entry.str();
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            key = (key ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ULL;
+        }
+    }
+
+    return key ? key : 1;
+}
+
+
+void StaticDataImage::getRow(uint32_t table, uint64_t row, DataBinding* binding, void* object) const {
+    if (row >= getRowCount(table)) {
+        return;
+    }
+
+    char* target = static_cast<char*>(object);
+
+    for (uint32_t i = 0, field_count = binding->getFieldCount(); i < field_count; ++i) {
+        const DataField& field = binding->getField(i);
+
+        uint32_t length;
+        const char* cell = getCell_(table, row, field.column, length);
+
+        switch (field.type) {
+            case DFT_int8:   *((char*)&target[field.offset])               = static_cast<char>(strtol(cell, NULL, 10)); break;
+            case DFT_uint8:  *((unsigned char*)&target[field.offset])      = static_cast<unsigned char>(strtoul(cell, NULL, 10)); break;
+            case DFT_int16:  *((short*)&target[field.offset])              = static_cast<short>(strtol(cell, NULL, 10)); break;
+            case DFT_uint16: *((unsigned short*)&target[field.offset])     = static_cast<unsigned short>(strtoul(cell, NULL, 10)); break;
+            case DFT_int32:  *((int*)&target[field.offset])                = static_cast<int>(strtol(cell, NULL, 10)); break;
+            case DFT_uint32: *((uint32_t*)&target[field.offset])           = static_cast<uint32_t>(strtoul(cell, NULL, 10)); break;
+            case DFT_int64:  *((long long*)&target[field.offset])          = strtoll(cell, NULL, 10); break;
+            case DFT_uint64: *((unsigned long long*)&target[field.offset]) = strtoull(cell, NULL, 10); break;
+            case DFT_float:  *((float*)&target[field.offset])              = static_cast<float>(strtod(cell, NULL)); break;
+            case DFT_double: *((double*)&target[field.offset])             = strtod(cell, NULL); break;
+
+            case DFT_string: {
+                memcpy(&target[field.offset], cell, length);
+                target[field.offset + length] = 0;
+                break;
+            }
+
+            case DFT_bstring: {
+                BString* binding_string = reinterpret_cast<BString*>(target + field.offset);
+                *binding_string = cell;
+                break;
+            }
+
+            case DFT_raw: {
+                memcpy(&target[field.offset], cell, length);
+                break;
+            }
+
+            default: { break; }
+        }
+    }
+}
+
+
+bool StaticDataImage::recordTable(const std::string& query, sql::ResultSet* result_set) {
+    if (!result_set) {
+        return false;
+    }
+
+    uint32_t column_count = result_set->getMetaData()->getColumnCount();
+
+    // every table the query reads, the ones it only joins or filters on included
+    std::set<std::string> source_set;
+    collectSources(query, source_set);
+
+    if (source_set.empty()) {
+        LOG(INFO) << "StaticDataImage: [" << query << "] reads no table, it is not recorded";
+        return false;
+    }
+
+    RecordedTable& table = recorded_[query];
+
+    table.sources.clear();
+    for (std::set<std::string>::const_iterator it = source_set.begin(); it != source_set.end(); ++it) {
+        table.sources += (table.sources.empty() ? "" : ",") + *it;
+    }
+
+    table.column_count = column_count;
+    table.cells.clear();
+    table.nulls.clear();
+
+    while (result_set->next()) {
+        // connector columns start at 1
+        for (uint32_t column = 1; column <= table.column_count; ++column) {
+            bool null = result_set->isNull(column);
+
+            table.cells.push_back(null ? std::string() : std::string(result_set->getString(column)));
+            table.nulls.push_back(null);
+        }
+    }
+
+    result_set->beforeFirst();
+    return true;
+}
+
+
+std::vector<std::string> StaticDataImage::getUncheckedSources() const {
+    std::set<std::string> unchecked;
+    std::string source;
+
+    TableIndex::const_iterator mapped = tables_.begin();
+    while (mapped != tables_.end()) {
+        std::stringstream stream(getSources_(mapped->second));
+        while (std::getline(stream, source, ',')) {
+            if (checksums_.find(source) == checksums_.end()) {
+                unchecked.insert(source);
+            }
+        }
+        ++mapped;
+    }
+
+    RecordedTables::const_iterator recorded = recorded_.begin();
+    while (recorded != recorded_.end()) {
+        std::stringstream stream(recorded->second.sources);
+        while (std::getline(stream, source, ',')) {
+            if (checksums_.find(source) == checksums_.end()) {
+                unchecked.insert(source);
+            }
+        }
+        ++recorded;
+    }
+
+    return std::vector<std::string>(unchecked.begin(), unchecked.end());
+}
+
+
+void StaticDataImage::setChecksum(const std::string& source, uint64_t checksum) {
+    checksums_[source] = checksum;
+}
+
+
+uint32_t StaticDataImage::dropStaleTables() {
+    const ImageTable* table_list = reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader));
+    uint32_t dropped = 0;
+
+    TableIndex::iterator it = tables_.begin();
+    while (it != tables_.end()) {
+        if (table_list[it->second].content != getContentKey_(getSources_(it->second))) {
+            tables_.erase(it++);
+            ++dropped;
+        } else {
+            ++it;
+        }
+    }
+
+    return dropped;
+}
+
+
+uint32_t StaticDataImage::getRecordedCount() const {
+    return static_cast<uint32_t>(recorded_.size());
+}
+
+
+uint32_t StaticDataImage::getTableCount() const {
+    return static_cast<uint32_t>(tables_.size());
+}
+
+
+uint64_t StaticDataImage::getImageSize() const {
+    return image_size_;
+}
+
+
+bool StaticDataImage::write(const std::string& filename) {
+    PoolWriter pool;
+    std::vector<ImageTable> table_list;
+    std::vector<uint32_t> cells;
+
+    // tables of the current image, unless they were recorded again
+    TableIndex::const_iterator mapped = tables_.begin();
+    while (mapped != tables_.end()) {
+        if (recorded_.find(mapped->first) == recorded_.end()) {
+            ImageTable table;
+            table.query        = pool.add(mapped->first);
+            table.column_count = reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader))[mapped->second].column_count;
+            table.row_count    = static_cast<uint32_t>(getRowCount(mapped->second));
+            table.cells        = static_cast<uint32_t>(cells.size());
+            table.sources      = pool.add(getSources_(mapped->second));
+            table.reserved     = 0;
+            table.content      = reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader))[mapped->second].content;
+
+            const uint32_t* source = reinterpret_cast<const uint32_t*>(image_ + reinterpret_cast<const ImageTable*>(image_ + sizeof(ImageHeader))[mapped->second].cells);
+
+            for (uint64_t cell = 0; cell < (uint64_t)table.row_count * table.column_count; ++cell) {
+                if (source[cell] == kNullCell) {
+                    cells.push_back(kNullCell);
+                    continue;
+                }
+
+                uint32_t length;
+                const char* value = getCell_(mapped->second, cell / table.column_count, static_cast<uint32_t>(cell % table.column_count), length);
+                cells.push_back(pool.add(std::string(value, length)));
+            }
+
+            table_list.push_back(table);
+        }
+
+        ++mapped;
+    }
+
+    RecordedTables::const_iterator recorded = recorded_.begin();
+    while (recorded != recorded_.end()) {
+        const RecordedTable& source = recorded->second;
+
+        // a source without a checksum can't be checked later, load it again next time
+        uint64_t content = getContentKey_(source.sources);
+        if (!content) {
+            ++recorded;
+            continue;
+        }
+
+        ImageTable table;
+        table.query        = pool.add(recorded->first);
+        table.column_count = source.column_count;
+        table.row_count    = source.column_count ? static_cast<uint32_t>(source.cells.size() / source.column_count) : 0;
+        table.cells        = static_cast<uint32_t>(cells.size());
+        table.sources      = pool.add(source.sources);
+        table.reserved     = 0;
+        table.content      = content;
+
+        for (size_t cell = 0; cell < source.cells.size(); ++cell) {
+            cells.push_back(source.nulls[cell] ? kNullCell : pool.add(source.cells[cell]));
+        }
+
+        table_list.push_back(table);
+        ++recorded;
+    }
+
+    // turn the cell indices into image offsets
+    uint32_t cells_offset = static_cast<uint32_t>(sizeof(ImageHeader) + table_list.size() * sizeof(ImageTable));
+    for (size_t i = 0; i < table_list.size(); ++i) {
+        table_list[i].cells = cells_offset + table_list[i].cells * sizeof(uint32_t);
+    }
+
+    ImageHeader header;
+    header.magic       = kImageMagic;
+    header.version     = kImageVersion;
+    header.created     = (uint64_t)time(NULL);
+    header.table_count = static_cast<uint32_t>(table_list.size());
+    header.pool_offset = static_cast<uint32_t>(cells_offset + cells.size() * sizeof(uint32_t));
+    header.pool_size   = static_cast<uint32_t>(pool.getPool().size());
+    header.size        = (uint64_t)header.pool_offset + header.pool_size;
+    header.reserved    = 0;
+
+    // zones starting at the same time may both write, each uses its own file
+    std::stringstream temp_filename;
+#ifdef _WIN32
+    temp_filename << filename << "." << _getpid() << ".tmp";
+#else
+    temp_filename << filename << "." << getpid() << ".tmp";
+#endif
+
+    std::ofstream out(temp_filename.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!out) {
+        LOG(WARNING) << "StaticDataImage: unable to create [" << temp_filename.str() << "]";
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!table_list.empty()) {
+        out.write(reinterpret_cast<const char*>(&table_list[0]), table_list.size() * sizeof(ImageTable));
+    }
+    if (!cells.empty()) {
+        out.write(reinterpret_cast<const char*>(&cells[0]), cells.size() * sizeof(uint32_t));
+    }
+    out.write(pool.getPool().data(), pool.getPool().size());
+    out.close();
+
+    if (out.fail()) {
+        LOG(WARNING) << "StaticDataImage: failed writing [" << temp_filename.str() << "]";
+        remove(temp_filename.str().c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(filename.c_str());
+#endif
+    if (rename(temp_filename.str().c_str(), filename.c_str()) != 0) {
+        LOG(WARNING) << "StaticDataImage: unable to rename [" << temp_filename.str() << "]";
+        remove(temp_filename.str().c_str());
+        return false;
+    }
+
+    LOG(INFO) << "StaticDataImage: wrote [" << filename << "], " << table_list.size() << " tables, " << header.size / 1024 << " kb";
+
+    // switch over to the new image, the recorded rows are in there now
+    if (map(filename)) {
+        recorded_.clear();
+    }
+
+    return true;
+}
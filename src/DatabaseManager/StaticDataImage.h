@@ -0,0 +1,170 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_DATABASEMANAGER_STATICDATAIMAGE_H
+#define ANH_DATABASEMANAGER_STATICDATAIMAGE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace sql {
+    class ResultSet;
+}
+
+class DataBinding;
+
+/*! A read only image of the static game data tables (skills, schematics,
+* conversations, ...), shared by all zone processes on a host.
+*
+* The image is a flat file of offsets only, so it can be mapped anywhere and
+* its pages are shared between every process mapping it. Each table is keyed by
+* the query that produced it and stores the rows as text cells, exactly what
+* the database would have returned. Queries the image does not know are
+* recorded from their database results and written into the next image.
+*
+* Every table also stores the database tables named in the FROM and JOIN
+* clauses of its query and a key over their CHECKSUM TABLE values. A table
+* whose sources changed since it was recorded is dropped when the image is
+* opened and loaded from the database again.
+*/
+class StaticDataImage : private boost::noncopyable {
+public:
+    StaticDataImage();
+    ~StaticDataImage();
+
+    /*! Maps an image read only.
+    *
+    * \param filename The image to map.
+    *
+    * \return Returns false if the image is missing or invalid.
+    */
+    bool map(const std::string& filename);
+
+    /*! Returns whether an image is mapped.
+    */
+    bool isMapped() const;
+
+    /*! Looks up the table produced by a query.
+    *
+    * \param query The query text, it has to match the one the table was recorded from.
+    * \param table Receives the table index.
+    */
+    bool findTable(const std::string& query, uint32_t& table) const;
+
+    /*! Returns the number of rows of a table.
+    */
+    uint64_t getRowCount(uint32_t table) const;
+
+    /*! Binds a row of a table to an object, like DatabaseResult::getNextRow does
+    * for a database row.
+    *
+    * \param table The table to read from.
+    * \param row The row to bind, rows past the end leave the object untouched.
+    * \param binding The binding rules to be used when processing the row.
+    * \param object The object to bind the row to.
+    */
+    void getRow(uint32_t table, uint64_t row, DataBinding* binding, void* object) const;
+
+    /*! Copies all rows of a database result so the query can be answered from
+    * the next image. The result set is left positioned before its first row.
+    *
+    * \param query The query that produced the result.
+    * \param result_set The result to copy.
+    *
+    * \return Returns false if the query reads no table, such a result
+    *         can't be checked against the database and is not recorded.
+    */
+    bool recordTable(const std::string& query, sql::ResultSet* result_set);
+
+    /*! Returns the database tables of the mapped and recorded tables that
+    * have no checksum yet.
+    */
+    std::vector<std::string> getUncheckedSources() const;
+
+    /*! Sets the current CHECKSUM TABLE value of a database table.
+    */
+    void setChecksum(const std::string& source, uint64_t checksum);
+
+    /*! Drops the mapped tables whose database tables changed since they were
+    * recorded, the checksums of their sources have to be set first.
+    *
+    * \return Returns the number of tables dropped.
+    */
+    uint32_t dropStaleTables();
+
+    /*! Returns the number of tables recorded since the last write.
+    */
+    uint32_t getRecordedCount() const;
+
+    /*! Returns the number of tables in the mapped image.
+    */
+    uint32_t getTableCount() const;
+
+    /*! Returns the size of the mapped image in bytes.
+    */
+    uint64_t getImageSize() const;
+
+    /*! Writes the mapped tables together with the recorded ones to a new image.
+    * The image is written under a temporary name and renamed into place, so
+    * processes mapping the old image are not affected.
+    *
+    * \param filename The image to write.
+    */
+    bool write(const std::string& filename);
+
+private:
+    struct RecordedTable {
+        std::string              sources;
+        uint32_t                 column_count;
+        std::vector<std::string> cells;
+        std::vector<bool>        nulls;
+    };
+
+    typedef std::map<std::string, uint32_t>      TableIndex;
+    typedef std::map<std::string, RecordedTable> RecordedTables;
+    typedef std::map<std::string, uint64_t>      Checksums;
+
+    const char* getCell_(uint32_t table, uint64_t row, uint32_t column, uint32_t& length) const;
+    const char* getSources_(uint32_t table) const;
+    uint64_t getContentKey_(const std::string& sources) const;
+
+    boost::interprocess::file_mapping  file_mapping_;
+    boost::interprocess::mapped_region mapped_region_;
+    const unsigned char*               image_;
+    uint64_t                           image_size_;
+    TableIndex                         tables_;
+    RecordedTables                     recorded_;
+    Checksums                          checksums_;
+};
+
+#endif // ANH_DATABASEMANAGER_STATICDATAIMAGE_H
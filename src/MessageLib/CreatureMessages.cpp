@@ -1001,18 +1001,7 @@ bool MessageLib::sendUpdatePvpStatus(CreatureObject* creatureObject,PlayerObject
 
 void MessageLib::sendMoodUpdate(CreatureObject* srcObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(srcObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-
-    mMessageFactory->addUint32(5);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(10);
-    mMessageFactory->addUint8(srcObject->getMoodId());
-
-    _sendToInRange(mMessageFactory->EndMessage(),srcObject,5);
+    mDeltaBatch.mark(srcObject->getId(),DeltaPage_Creo6,10);
 }
 
 //======================================================================================================================
@@ -1023,17 +1012,7 @@ void MessageLib::sendMoodUpdate(CreatureObject* srcObject)
 
 void MessageLib::sendPostureUpdate(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(3);
-    mMessageFactory->addUint32(5);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(11);
-    mMessageFactory->addUint8(creatureObject->states.getPosture());
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5,true);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,11);
 }
 
 //======================================================================================================================
@@ -1047,19 +1026,8 @@ void MessageLib::sendPostureAndStateUpdate(CreatureObject* creatureObject)
     // Test code for npc combat with objects that can have no states, like debris.
     if (creatureObject->getCreoGroup() != CreoGroup_AttackableObject)
     {
-        mMessageFactory->StartMessage();
-        mMessageFactory->addUint32(opDeltasMessage);
-        mMessageFactory->addUint64(creatureObject->getId());
-        mMessageFactory->addUint32(opCREO);
-        mMessageFactory->addUint8(3);
-        mMessageFactory->addUint32(15);
-        mMessageFactory->addUint16(2);
-        mMessageFactory->addUint16(11);
-        mMessageFactory->addUint8(creatureObject->states.getPosture());
-        mMessageFactory->addUint16(16);
-        mMessageFactory->addUint64(creatureObject->states.getAction());
-
-        _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+        mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,11);
+        mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,16);
     }
 }
 
@@ -1074,17 +1042,7 @@ void MessageLib::sendStateUpdate(CreatureObject* creatureObject)
     // Test code for npc combat with objects that can have no states, like debris.
     if (creatureObject->getCreoGroup() != CreoGroup_AttackableObject)
     {
-        mMessageFactory->StartMessage();
-        mMessageFactory->addUint32(opDeltasMessage);
-        mMessageFactory->addUint64(creatureObject->getId());
-        mMessageFactory->addUint32(opCREO);
-        mMessageFactory->addUint8(3);
-        mMessageFactory->addUint32(12);
-        mMessageFactory->addUint16(1);
-        mMessageFactory->addUint16(16);
-        mMessageFactory->addUint64(creatureObject->states.getAction());
-
-        _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+        mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,16);
     }
 }
 
@@ -1099,26 +1057,8 @@ void MessageLib::sendSingleBarUpdate(CreatureObject* creatureObject)
     // Test code for npc combat with objects that can have no states, like debris.
     if (creatureObject->getCreoGroup() == CreoGroup_AttackableObject)
     {
-        Ham* ham = creatureObject->getHam();
-
-        if (ham == NULL)
-        {
-            return;
-        }
-
-        mMessageFactory->StartMessage();
-        mMessageFactory->addUint32(opDeltasMessage);
-        mMessageFactory->addUint64(creatureObject->getId());
-        mMessageFactory->addUint32(opCREO);
-        mMessageFactory->addUint8(3);
-        mMessageFactory->addUint32(8); // bytes
-        mMessageFactory->addUint16(1);	// No of items
-        mMessageFactory->addUint16(8);	// Index 8 condition damage (vehicle)
-        uint32 damage = ham->getPropertyValue(HamBar_Health,HamProperty_MaxHitpoints);
-        damage -= ham->getPropertyValue(HamBar_Health,HamProperty_CurrentHitpoints);
-        // mMessageFactory->addUint32(ham->getPropertyValue(HamBar_Health,HamProperty_CurrentHitpoints));
-        mMessageFactory->addUint32(damage);
-        _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+        // Index 8 condition damage (vehicle)
+        mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,8);
     }
 }
 
@@ -1134,25 +1074,7 @@ bool MessageLib::sendBankCreditsUpdate(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(1);
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(0);
-
-    if(Bank* bank = dynamic_cast<Bank*>(playerObject->getEquipManager()->getEquippedObject(CreatureEquipSlot_Bank)))
-    {
-        mMessageFactory->addUint32(bank->getCredits());
-    }
-    else
-    {
-        mMessageFactory->addUint32(0);
-    }
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo1,0);
 
     return(true);
 }
@@ -1168,25 +1090,7 @@ bool MessageLib::sendInventoryCreditsUpdate(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(1);
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(1);
-
-    if(Inventory* inventory = dynamic_cast<Inventory*>(playerObject->getEquipManager()->getEquippedObject(CreatureEquipSlot_Inventory)))
-    {
-        mMessageFactory->addUint32(inventory->getCredits());
-    }
-    else
-    {
-        mMessageFactory->addUint32(0);
-    }
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo1,1);
 
     return(true);
 }
@@ -1202,34 +1106,11 @@ bool MessageLib::sendUpdateMovementProperties(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    MovingObject* object = dynamic_cast<MovingObject*>(playerObject);
-
-    if (playerObject->checkIfMounted()) {
-        object = dynamic_cast<MovingObject*>(playerObject->getMount());
-    }
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(4);
-    mMessageFactory->addUint32(26);
-
-    mMessageFactory->addUint16(4);
-
-    mMessageFactory->addUint16(5);
-    mMessageFactory->addFloat(object->getCurrentSpeedModifier());
-
-    mMessageFactory->addUint16(7);
-    mMessageFactory->addFloat(object->getCurrentRunSpeedLimit());
-
-    mMessageFactory->addUint16(10);
-    mMessageFactory->addFloat(object->getCurrentTurnRate());
-
-    mMessageFactory->addUint16(11);
-    mMessageFactory->addFloat(object->getCurrentAcceleration());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    // speed modifier, run speed, turn rate and acceleration
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo4,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo4,7);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo4,10);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo4,11);
 
     return(true);
 }
@@ -1325,31 +1206,7 @@ bool MessageLib::sendSkillModDeltasCREO_4(SkillModsList smList,uint8 remove,Crea
 
 void MessageLib::sendCurrentHitpointDeltasCreo6_Single(CreatureObject* creatureObject,uint8 barIndex)
 {
-    Ham*	ham = creatureObject->getHam();
-
-    if(ham == NULL)
-        return;
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-
-    mMessageFactory->addUint32(19);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(13);
-
-    // advance by 1 (overload for bigger increment)
-    ham->advanceCurrentHitpointsUpdateCounter();
-    mMessageFactory->addUint32(1);
-    mMessageFactory->addUint32(ham->getCurrentHitpointsUpdateCounter());
-
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(barIndex);
-    mMessageFactory->addInt32(ham->getPropertyValue(barIndex,HamProperty_CurrentHitpoints));
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,13).mCurrentBars |= (1 << barIndex);
 }
 
 //======================================================================================================================
@@ -1360,31 +1217,7 @@ void MessageLib::sendCurrentHitpointDeltasCreo6_Single(CreatureObject* creatureO
 
 void MessageLib::sendMaxHitpointDeltasCreo6_Single(CreatureObject* creatureObject,uint8 barIndex)
 {
-    Ham* ham = creatureObject->getHam();
-
-    if(ham == NULL)
-        return;
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-
-    mMessageFactory->addUint32(19);
-
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(14);//delta nr
-
-    mMessageFactory->addUint32(1);
-    ham->advanceMaxHitpointsUpdateCounter();  // increment list up counter by 1
-    mMessageFactory->addUint32(ham->getMaxHitpointsUpdateCounter());
-
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(barIndex);
-    mMessageFactory->addInt32(ham->getPropertyValue(barIndex,HamProperty_MaxHitpoints));
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,14).mMaxBars |= (1 << barIndex);
 }
 
 //======================================================================================================================
@@ -1395,31 +1228,7 @@ void MessageLib::sendMaxHitpointDeltasCreo6_Single(CreatureObject* creatureObjec
 
 void MessageLib::sendBaseHitpointDeltasCreo1_Single(CreatureObject* creatureObject,uint8 barIndex)
 {
-    Ham* ham = creatureObject->getHam();
-
-    if(ham == NULL)
-        return;
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(1);
-
-    mMessageFactory->addUint32(19);
-
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(2);//delta nr
-
-    mMessageFactory->addUint32(1);
-    ham->advanceBaseHitpointsUpdateCounter();
-    mMessageFactory->addUint32(ham->getBaseHitpointsUpdateCounter());  // increment list up counter by 1
-
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(barIndex);
-    mMessageFactory->addInt32(ham->getPropertyValue(barIndex,HamProperty_BaseHitpoints));
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo1,2).mBaseBars |= (1 << barIndex);
 }
 
 //======================================================================================================================
@@ -1430,30 +1239,7 @@ void MessageLib::sendBaseHitpointDeltasCreo1_Single(CreatureObject* creatureObje
 
 void MessageLib::sendWoundUpdateCreo3(CreatureObject* creatureObject,uint8 barIndex)
 {
-    Ham* ham = creatureObject->getHam();
-
-    if(ham == NULL)
-        return;
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(19);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(17);
-
-    ham->advanceWoundsUpdateCounter();
-    mMessageFactory->addUint32(1);
-    mMessageFactory->addUint32(ham->getWoundsUpdateCounter());
-
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(barIndex);
-    mMessageFactory->addInt32(ham->getPropertyValue(barIndex,HamProperty_Wounds));
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,17).mWoundBars |= (1 << barIndex);
 }
 
 //======================================================================================================================
@@ -1464,40 +1250,21 @@ void MessageLib::sendWoundUpdateCreo3(CreatureObject* creatureObject,uint8 barIn
 
 void MessageLib::sendCurrentHitpointDeltasCreo6_Full(CreatureObject* creatureObject)
 {
-    Ham* ham = creatureObject->getHam();
-
-    if(ham == NULL)
-        return;
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-
-    mMessageFactory->addUint32(33);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(13);
-
-    mMessageFactory->addUint32(3);
-
-    ham->advanceCurrentHitpointsUpdateCounter(3);
-
-    mMessageFactory->addUint32(ham->getCurrentHitpointsUpdateCounter());
-
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(HamBar_Health);
-    mMessageFactory->addInt32(ham->getPropertyValue(HamBar_Health,HamProperty_CurrentHitpoints));
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,13).mCurrentBars |= (1 << HamBar_Health) | (1 << HamBar_Action) | (1 << HamBar_Mind);
+}
 
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(HamBar_Action);
-    mMessageFactory->addInt32(ham->getPropertyValue(HamBar_Action,HamProperty_CurrentHitpoints));
+//======================================================================================================================
+//
+// Creature Deltas Type 6
+// update: current hitpoints of every bar set in barMask (1 << barIndex), one message instead of one per bar
+//
 
-    mMessageFactory->addUint8(2);
-    mMessageFactory->addUint16(HamBar_Mind);
-    mMessageFactory->addInt32(ham->getPropertyValue(HamBar_Mind,HamProperty_CurrentHitpoints));
+void MessageLib::sendCurrentHitpointDeltasCreo6_Multi(CreatureObject* creatureObject,uint16 barMask)
+{
+    if(!barMask)
+        return;
 
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,13).mCurrentBars |= barMask;
 }
 
 //======================================================================================================================
@@ -1508,25 +1275,12 @@ void MessageLib::sendCurrentHitpointDeltasCreo6_Full(CreatureObject* creatureObj
 
 void MessageLib::sendBFUpdateCreo3(CreatureObject* playerObject)
 {
-    Ham*			ham = playerObject->getHam();
     PlayerObject*	pObject = dynamic_cast<PlayerObject*>(playerObject);
 
-    if(!ham || !pObject || !(pObject->isConnected()))
+    if(!pObject || !(pObject->isConnected()))
         return;
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(15);
-
-    mMessageFactory->addInt32(ham->getBattleFatigue());
-
-    (pObject)->getClient()->SendChannelA(mMessageFactory->EndMessage(),pObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo3,15);
 }
 
 //======================================================================================================================
@@ -1562,17 +1316,7 @@ void MessageLib::sendOwnerUpdateCreo3(MountObject* mount)
 
 void MessageLib::sendTargetUpdateDeltasCreo6(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-    mMessageFactory->addUint32(12); // Size, short short long
-    mMessageFactory->addUint16(1);  // Update count
-    mMessageFactory->addUint16(9);  // CREO6 TargetID
-    mMessageFactory->addUint64(creatureObject->getTargetId());  // new target
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,9);
 }
 
 //======================================================================================================================
@@ -1633,18 +1377,7 @@ void MessageLib::sendGroupIdUpdateDeltasCreo6(uint64 groupId, const PlayerObject
 
 void MessageLib::sendTerrainNegotiation(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(4);
-    mMessageFactory->addUint32(8);
-
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(9);
-    mMessageFactory->addFloat(creatureObject->getCurrentTerrainNegotiation());
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo4,9);
 }
 
 //======================================================================================================================
@@ -1655,18 +1388,7 @@ void MessageLib::sendTerrainNegotiation(CreatureObject* creatureObject)
 
 void MessageLib::sendListenToId(PlayerObject* playerObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(4);
-    mMessageFactory->addUint32(12);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(6);
-    mMessageFactory->addUint64(playerObject->getEntertainerListenToId());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
-    //_sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo4,6);
 }
 
 //======================================================================================================================
@@ -1698,17 +1420,7 @@ void MessageLib::UpdateEntertainerPerfomanceCounter(CreatureObject* creatureObje
 
 void MessageLib::sendPerformanceId(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(12);
-    mMessageFactory->addUint32(creatureObject->getPerformanceId());
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,12);
 }
 
 //======================================================================================================================
@@ -1759,18 +1471,7 @@ void MessageLib::sendMoodString(CreatureObject* creatureObject,BString animation
 
 void MessageLib::sendCustomizationUpdateCreo3(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(6 + creatureObject->getCustomizationStr().getLength());
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(4);
-    mMessageFactory->addString(creatureObject->getCustomizationStr());
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,4);
 }
 
 //======================================================================================================================
@@ -1781,18 +1482,7 @@ void MessageLib::sendCustomizationUpdateCreo3(CreatureObject* creatureObject)
 
 void MessageLib::sendScaleUpdateCreo3(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(14);
-    mMessageFactory->addFloat(creatureObject->getScale());
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,14);
 }
 
 //======================================================================================================================
@@ -1803,25 +1493,7 @@ void MessageLib::sendScaleUpdateCreo3(CreatureObject* creatureObject)
 
 void MessageLib::sendWeaponIdUpdate(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-    mMessageFactory->addUint32(12);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(5);
-
-    if(Object* weapon = creatureObject->getEquipManager()->getEquippedObject(CreatureEquipSlot_Hold_Left))
-    {
-        mMessageFactory->addUint64(weapon->getId());
-    }
-    else
-    {
-        mMessageFactory->addUint64(0);
-    }
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo6,5);
 }
 
 //======================================================================================================================
@@ -1832,18 +1504,7 @@ void MessageLib::sendWeaponIdUpdate(CreatureObject* creatureObject)
 
 void MessageLib::sendIncapTimerUpdate(CreatureObject* creatureObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(creatureObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(3);
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(7);
-
-    mMessageFactory->addUint32((uint32)(creatureObject->getCurrentIncapTime() / 1000));
-
-    _sendToInRange(mMessageFactory->EndMessage(),creatureObject,5);
+    mDeltaBatch.mark(creatureObject->getId(),DeltaPage_Creo3,7);
 }
 
 //======================================================================================================================
@@ -1921,20 +1582,5 @@ bool MessageLib::sendSkillModUpdateCreo4(PlayerObject* playerObject)
 
 void MessageLib::sendStationaryFlagUpdate(PlayerObject* playerObject)
 {
-    mMessageFactory->StartMessage();
-
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getId());
-    mMessageFactory->addUint32(opCREO);
-    mMessageFactory->addUint8(6);
-    mMessageFactory->addUint32(5);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(17);
-
-    if(playerObject->isStationary())
-        mMessageFactory->addUint8(1);
-    else
-        mMessageFactory->addUint8(0);
-
-    playerObject->getClient()->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Creo6,17);
 }
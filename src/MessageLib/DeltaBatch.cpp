@@ -0,0 +1,129 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "DeltaBatch.h"
+
+#include <algorithm>
+#include <functional>
+
+//======================================================================================================================
+
+DeltaRecord::DeltaRecord(uint64 objectId)
+    : mObjectId(objectId)
+    , mObserverId(0)
+    , mCurrentBars(0)
+    , mMaxBars(0)
+    , mBaseBars(0)
+    , mWoundBars(0)
+{
+    for(uint32 page = 0; page < DeltaPage_Count; page++)
+    {
+        mDirty[page] = 0;
+    }
+}
+
+//======================================================================================================================
+
+bool DeltaRecord::isDirty() const
+{
+    uint32 dirty = 0;
+
+    for(uint32 page = 0; page < DeltaPage_Count; page++)
+    {
+        dirty |= mDirty[page];
+    }
+
+    return(dirty != 0);
+}
+
+//======================================================================================================================
+
+DeltaBatch::DeltaBatch()
+    : mMarkCount(0)
+{
+}
+
+//======================================================================================================================
+
+DeltaRecord& DeltaBatch::getRecord(uint64 objectId)
+{
+    std::pair<RecordIndexMap::iterator,bool> result = mRecordIndices.insert(std::make_pair(objectId,static_cast<uint32>(mRecords.size())));
+
+    if(result.second)
+    {
+        mRecords.push_back(DeltaRecord(objectId));
+    }
+
+    return(mRecords[result.first->second]);
+}
+
+//======================================================================================================================
+
+DeltaRecord& DeltaBatch::mark(uint64 objectId, uint8 page, uint16 index)
+{
+    DeltaRecord& record = getRecord(objectId);
+
+    record.mDirty[page] |= (1 << index);
+    mMarkCount++;
+
+    return(record);
+}
+
+//======================================================================================================================
+
+void DeltaBatch::forget(uint64 objectId)
+{
+    RecordIndexMap::iterator it = mRecordIndices.find(objectId);
+
+    if(it == mRecordIndices.end())
+        return;
+
+    // the record keeps its place until take, a new mark for the id starts a fresh one
+    DeltaRecord& record = mRecords[it->second];
+
+    for(uint32 page = 0; page < DeltaPage_Count; page++)
+    {
+        record.mDirty[page] = 0;
+    }
+
+    mRecordIndices.erase(it);
+}
+
+//======================================================================================================================
+
+void DeltaBatch::take(std::vector<DeltaRecord>& records)
+{
+    records.clear();
+    records.swap(mRecords);
+
+    mRecordIndices.clear();
+
+    records.erase(std::remove_if(records.begin(),records.end(),std::not1(std::mem_fun_ref(&DeltaRecord::isDirty))),records.end());
+}
+
+//======================================================================================================================
+
@@ -0,0 +1,117 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_MESSAGELIB_DELTABATCH_H
+#define ANH_MESSAGELIB_DELTABATCH_H
+
+#include "Utils/typedefs.h"
+
+#include <unordered_map>
+#include <vector>
+
+//======================================================================================================================
+
+// the baseline pages whose property deltas get merged until the end of the tick
+enum DeltaPage
+{
+    DeltaPage_Creo1	= 0,
+    DeltaPage_Creo3	= 1,
+    DeltaPage_Creo4	= 2,
+    DeltaPage_Creo6	= 3,
+    DeltaPage_Play3	= 4,
+    DeltaPage_Play8	= 5,
+    DeltaPage_Play9	= 6,
+    DeltaPage_Tano3	= 7,
+
+    DeltaPage_Count	= 8
+};
+
+//======================================================================================================================
+//
+// the dirty properties of one object, bit n of a page mask stands for delta index n of that page
+// the values itself are read when the delta is built, so marking a property twice costs nothing
+//
+
+class DeltaRecord
+{
+public:
+
+    DeltaRecord(uint64 objectId);
+
+    bool	isDirty() const;
+
+    uint64	mObjectId;
+    uint64	mObserverId;	// TANO 3 deltas only go to the player they were marked for
+    uint32	mDirty[DeltaPage_Count];
+
+    // the ham lists are sent per bar, 1 << barIndex
+    uint16	mCurrentBars;	// CREO 6 current hitpoints
+    uint16	mMaxBars;		// CREO 6 max hitpoints
+    uint16	mBaseBars;		// CREO 1 base hitpoints
+    uint16	mWoundBars;		// CREO 3 wounds
+};
+
+//======================================================================================================================
+//
+// collects the deltas marked during a tick, one record per object in the order the objects were first marked
+//
+
+class DeltaBatch
+{
+public:
+
+    DeltaBatch();
+
+    DeltaRecord&	getRecord(uint64 objectId);
+    DeltaRecord&	mark(uint64 objectId, uint8 page, uint16 index);
+
+    // drops whatever was marked for an object that is going away
+    void			forget(uint64 objectId);
+
+    // hands the marked records to the caller and starts a new batch
+    void			take(std::vector<DeltaRecord>& records);
+
+    uint32			size() const {
+        return(static_cast<uint32>(mRecords.size()));
+    }
+    uint64			getMarkCount() const {
+        return(mMarkCount);
+    }
+
+private:
+
+    typedef std::unordered_map<uint64,uint32> RecordIndexMap;
+
+    RecordIndexMap				mRecordIndices;
+    std::vector<DeltaRecord>	mRecords;
+    uint64						mMarkCount;
+};
+
+//======================================================================================================================
+
+#endif
+
@@ -0,0 +1,538 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "MessageLib.h"
+
+#include "ZoneServer/Bank.h"
+#include "ZoneServer/Inventory.h"
+#include "ZoneServer/MountObject.h"
+#include "ZoneServer/PlayerObject.h"
+#include "ZoneServer/Stomach.h"
+#include "ZoneServer/TangibleObject.h"
+#include "ZoneServer/WorldManager.h"
+#include "ZoneServer/ZoneOpcodes.h"
+
+#include "Common/byte_buffer.h"
+#include "NetworkManager/DispatchClient.h"
+#include "NetworkManager/Message.h"
+#include "NetworkManager/MessageFactory.h"
+#include "NetworkManager/MessageOpcodes.h"
+
+#include <cassert>
+
+using common::ByteBuffer;
+
+//======================================================================================================================
+
+namespace {
+
+// how a page goes out, its header and the properties only the owner gets to see
+struct DeltaPageInfo
+{
+    uint32	mOpcode;
+    uint8	mPageNr;
+    uint32	mOwnerMask;
+};
+
+const DeltaPageInfo gDeltaPages[DeltaPage_Count] =
+{
+    { opCREO, 1, (1 << 0) | (1 << 1) },										// credits
+    { opCREO, 3, (1 << 15) },												// battle fatigue
+    { opCREO, 4, (1 << 5) | (1 << 6) | (1 << 7) | (1 << 10) | (1 << 11) },	// movement, listen to
+    { opCREO, 6, (1 << 17) },												// stationary flag
+    { opPLAY, 3, (1 << 6) },												// matchmaking
+    { opPLAY, 8, 0xffffffff },
+    { opPLAY, 9, ~(1u << 9) },												// all but the language
+    { opTANO, 3, 0xffffffff }												// only the player it was marked for
+};
+
+//======================================================================================================================
+
+uint32 countBars(uint16 bars)
+{
+    uint32 count = 0;
+
+    for(uint8 barIndex = HamBar_Health; barIndex <= HamBar_Willpower; barIndex++)
+    {
+        if(bars & (1 << barIndex))
+            count++;
+    }
+
+    return(count);
+}
+
+//======================================================================================================================
+//
+// the ham lists, one change entry per bar
+//
+
+void writeBars(ByteBuffer& body,Ham* ham,uint16 bars,uint32 count,uint32 updateCounter,uint8 property)
+{
+    body.write<uint32>(count);
+    body.write<uint32>(updateCounter);
+
+    for(uint8 barIndex = HamBar_Health; barIndex <= HamBar_Willpower; barIndex++)
+    {
+        if(!(bars & (1 << barIndex)))
+            continue;
+
+        body.write<uint8>(2);
+        body.write<uint16>(barIndex);
+        body.write<int32>(ham->getPropertyValue(barIndex,property));
+    }
+}
+
+//======================================================================================================================
+
+void writeString(ByteBuffer& body,const BString& string)
+{
+    body.write<uint16>(static_cast<uint16>(string.getLength()));
+    body.write(reinterpret_cast<const unsigned char*>(string.getRawData()),string.getLength());
+}
+
+//======================================================================================================================
+
+Message* buildDelta(MessageFactory* factory,const DeltaPageInfo& info,uint64 objectId,const ByteBuffer& body,uint16 count,const ByteBuffer* ownerBody,uint16 ownerCount)
+{
+    uint32 size = body.size() + (ownerBody ? ownerBody->size() : 0);
+
+    factory->StartMessage();
+    factory->addUint32(opDeltasMessage);
+    factory->addUint64(objectId);
+    factory->addUint32(info.mOpcode);
+    factory->addUint8(info.mPageNr);
+
+    factory->addUint32(2 + size);
+    factory->addUint16(count + ownerCount);
+
+    if(body.size())
+        factory->addData(body.data(),static_cast<uint16>(body.size()));
+
+    if(ownerBody && ownerBody->size())
+        factory->addData(ownerBody->data(),static_cast<uint16>(ownerBody->size()));
+
+    return(factory->EndMessage());
+}
+
+}
+
+//======================================================================================================================
+//
+// sends everything marked since the last call, one delta per object and page
+// called once at the end of every zone tick
+//
+
+void MessageLib::sendDeltas()
+{
+    if(!mDeltaBatch.size())
+        return;
+
+    mDeltaBatch.take(mDeltaRecords);
+
+    std::vector<DeltaRecord>::iterator recordIt = mDeltaRecords.begin();
+
+    while(recordIt != mDeltaRecords.end())
+    {
+        // it may have been destroyed after it was marked
+        if(Object* object = gWorldManager->getObjectById((*recordIt).mObjectId))
+        {
+            for(uint8 page = 0; page < DeltaPage_Count; page++)
+            {
+                if((*recordIt).mDirty[page])
+                    _sendDeltaPage(object,*recordIt,page);
+            }
+        }
+
+        ++recordIt;
+    }
+
+    mDeltaRecords.clear();
+}
+
+//======================================================================================================================
+//
+// tangible deltas are only ever meant for one player, if another one marks the same object
+// before the tick ends the pending page goes out to the first one right away
+//
+
+bool MessageLib::_markTangibleDelta(TangibleObject* tangibleObject,PlayerObject* playerObject,uint16 index)
+{
+    if(!(playerObject->isConnected()))
+        return(false);
+
+    DeltaRecord& record = mDeltaBatch.getRecord(tangibleObject->getId());
+
+    if(record.mDirty[DeltaPage_Tano3] && record.mObserverId != playerObject->getId())
+    {
+        _sendDeltaPage(tangibleObject,record,DeltaPage_Tano3);
+    }
+
+    record.mObserverId = playerObject->getId();
+
+    mDeltaBatch.mark(tangibleObject->getId(),DeltaPage_Tano3,index);
+
+    return(true);
+}
+
+//======================================================================================================================
+//
+// the owner gets all properties of the page in one message, everyone else in range the public ones
+//
+
+void MessageLib::_sendDeltaPage(Object* object,DeltaRecord& record,uint8 page)
+{
+    const DeltaPageInfo&	info		= gDeltaPages[page];
+    uint32					dirty		= record.mDirty[page];
+    uint64					objectId	= object->getId();
+    PlayerObject*			owner		= NULL;
+
+    record.mDirty[page] = 0;
+
+    switch(page)
+    {
+        case DeltaPage_Play3:
+        case DeltaPage_Play8:
+        case DeltaPage_Play9:
+        {
+            owner = dynamic_cast<PlayerObject*>(object);
+
+            if(!owner)
+                return;
+
+            objectId = owner->getPlayerObjId();
+        }
+        break;
+
+        case DeltaPage_Tano3:
+        {
+            if(!dynamic_cast<TangibleObject*>(object))
+                return;
+
+            owner = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(record.mObserverId));
+        }
+        break;
+
+        default:
+        {
+            if(!dynamic_cast<CreatureObject*>(object))
+                return;
+
+            owner = dynamic_cast<PlayerObject*>(object);
+        }
+        break;
+    }
+
+    if(owner && !(_checkPlayer(owner) && owner->isConnected()))
+        owner = NULL;
+
+    ByteBuffer	body;
+    ByteBuffer	ownerBody;
+    uint16		count		= _writeDeltas(body,object,record,page,dirty & ~info.mOwnerMask);
+    uint16		ownerCount	= 0;
+
+    if(owner)
+        ownerCount = _writeDeltas(ownerBody,object,record,page,dirty & info.mOwnerMask);
+
+    if(count)
+        _sendToInRange(buildDelta(mMessageFactory,info,objectId,body,count,NULL,0),object,5,ownerCount == 0);
+
+    if(ownerCount)
+        (owner->getClient())->SendChannelA(buildDelta(mMessageFactory,info,objectId,body,count,&ownerBody,ownerCount),owner->getAccountId(),CR_Client,5);
+}
+
+//======================================================================================================================
+
+uint16 MessageLib::_writeDeltas(ByteBuffer& body,Object* object,DeltaRecord& record,uint8 page,uint32 mask)
+{
+    uint16 count = 0;
+
+    for(uint16 index = 0; mask; index++, mask >>= 1)
+    {
+        if(!(mask & 1))
+            continue;
+
+        body.write<uint16>(index);
+
+        switch(page)
+        {
+            case DeltaPage_Play3:
+            case DeltaPage_Play8:
+            case DeltaPage_Play9:
+                _writePlayerDelta(body,static_cast<PlayerObject*>(object),page,index);
+                break;
+
+            case DeltaPage_Tano3:
+                _writeTangibleDelta(body,static_cast<TangibleObject*>(object),index);
+                break;
+
+            default:
+                _writeCreatureDelta(body,static_cast<CreatureObject*>(object),record,page,index);
+                break;
+        }
+
+        count++;
+    }
+
+    return(count);
+}
+
+//======================================================================================================================
+//
+// Creature Deltas Type 1, 3, 4 and 6
+//
+
+void MessageLib::_writeCreatureDelta(ByteBuffer& body,CreatureObject* creatureObject,DeltaRecord& record,uint8 page,uint16 index)
+{
+    Ham* ham = creatureObject->getHam();
+
+    switch(page)
+    {
+        case DeltaPage_Creo1:
+        {
+            switch(index)
+            {
+                // bank credits
+                case 0:
+                {
+                    Bank* bank = dynamic_cast<Bank*>(creatureObject->getEquipManager()->getEquippedObject(CreatureEquipSlot_Bank));
+                    body.write<uint32>(bank ? bank->getCredits() : 0);
+                }
+                return;
+
+                // inventory credits
+                case 1:
+                {
+                    Inventory* inventory = dynamic_cast<Inventory*>(creatureObject->getEquipManager()->getEquippedObject(CreatureEquipSlot_Inventory));
+                    body.write<uint32>(inventory ? inventory->getCredits() : 0);
+                }
+                return;
+
+                // base hitpoints
+                case 2:
+                {
+                    uint32 count = countBars(record.mBaseBars);
+
+                    ham->advanceBaseHitpointsUpdateCounter(count);
+                    writeBars(body,ham,record.mBaseBars,count,ham->getBaseHitpointsUpdateCounter(),HamProperty_BaseHitpoints);
+                    record.mBaseBars = 0;
+                }
+                return;
+            }
+        }
+        break;
+
+        case DeltaPage_Creo3:
+        {
+            switch(index)
+            {
+                case 4:		writeString(body,creatureObject->getCustomizationStr());							return;
+                case 7:		body.write<uint32>(static_cast<uint32>(creatureObject->getCurrentIncapTime() / 1000));	return;
+                case 11:	body.write<uint8>(creatureObject->states.getPosture());								return;
+                case 14:	body.write<float>(creatureObject->getScale());										return;
+                case 15:	body.write<int32>(ham->getBattleFatigue());											return;
+                case 16:	body.write<uint64>(creatureObject->states.getAction());								return;
+
+                // condition damage, statics like debris and vehicles only have this one bar
+                case 8:
+                {
+                    uint32 damage = ham->getPropertyValue(HamBar_Health,HamProperty_MaxHitpoints);
+                    damage -= ham->getPropertyValue(HamBar_Health,HamProperty_CurrentHitpoints);
+                    body.write<uint32>(damage);
+                }
+                return;
+
+                // wounds
+                case 17:
+                {
+                    uint32 count = countBars(record.mWoundBars);
+
+                    ham->advanceWoundsUpdateCounter(count);
+                    writeBars(body,ham,record.mWoundBars,count,ham->getWoundsUpdateCounter(),HamProperty_Wounds);
+                    record.mWoundBars = 0;
+                }
+                return;
+            }
+        }
+        break;
+
+        case DeltaPage_Creo4:
+        {
+            // the movement properties come from the mount while riding
+            MovingObject* movingObject = creatureObject;
+
+            if(PlayerObject* player = dynamic_cast<PlayerObject*>(creatureObject))
+            {
+                if(player->checkIfMounted() && player->getMount())
+                    movingObject = player->getMount();
+            }
+
+            switch(index)
+            {
+                case 5:		body.write<float>(movingObject->getCurrentSpeedModifier());			return;
+                case 6:		body.write<uint64>(creatureObject->getEntertainerListenToId());		return;
+                case 7:		body.write<float>(movingObject->getCurrentRunSpeedLimit());			return;
+                case 9:		body.write<float>(creatureObject->getCurrentTerrainNegotiation());	return;
+                case 10:	body.write<float>(movingObject->getCurrentTurnRate());				return;
+                case 11:	body.write<float>(movingObject->getCurrentAcceleration());			return;
+            }
+        }
+        break;
+
+        case DeltaPage_Creo6:
+        {
+            switch(index)
+            {
+                case 9:		body.write<uint64>(creatureObject->getTargetId());			return;
+                case 10:	body.write<uint8>(creatureObject->getMoodId());				return;
+                case 12:	body.write<uint32>(creatureObject->getPerformanceId());		return;
+                case 17:	body.write<uint8>(creatureObject->isStationary() ? 1 : 0);	return;
+
+                // weapon id
+                case 5:
+                {
+                    Object* weapon = creatureObject->getEquipManager()->getEquippedObject(CreatureEquipSlot_Hold_Left);
+                    body.write<uint64>(weapon ? weapon->getId() : 0);
+                }
+                return;
+
+                // current hitpoints
+                case 13:
+                {
+                    uint32 count = countBars(record.mCurrentBars);
+
+                    ham->advanceCurrentHitpointsUpdateCounter(count);
+                    writeBars(body,ham,record.mCurrentBars,count,ham->getCurrentHitpointsUpdateCounter(),HamProperty_CurrentHitpoints);
+                    record.mCurrentBars = 0;
+                }
+                return;
+
+                // max hitpoints
+                case 14:
+                {
+                    uint32 count = countBars(record.mMaxBars);
+
+                    ham->advanceMaxHitpointsUpdateCounter(count);
+                    writeBars(body,ham,record.mMaxBars,count,ham->getMaxHitpointsUpdateCounter(),HamProperty_MaxHitpoints);
+                    record.mMaxBars = 0;
+                }
+                return;
+            }
+        }
+        break;
+    }
+
+    assert(false && "MessageLib::_writeCreatureDelta unknown delta index");
+}
+
+//======================================================================================================================
+//
+// Player Deltas Type 3, 8 and 9
+//
+
+void MessageLib::_writePlayerDelta(ByteBuffer& body,PlayerObject* playerObject,uint8 page,uint16 index)
+{
+    switch(page)
+    {
+        case DeltaPage_Play3:
+        {
+            switch(index)
+            {
+                // flags
+                case 5:
+                {
+                    body.write<uint32>(4);
+                    body.write<uint32>(playerObject->getPlayerFlags());
+                    body.write<uint32>(0);
+                    body.write<uint32>(0);
+                    body.write<uint32>(0);
+                }
+                return;
+
+                // matchmaking
+                case 6:
+                {
+                    body.write<uint32>(4);
+                    body.write<uint32>(playerObject->getPlayerMatch(0));
+                    body.write<uint32>(playerObject->getPlayerMatch(1));
+                    body.write<uint32>(playerObject->getPlayerMatch(2));
+                    body.write<uint32>(playerObject->getPlayerMatch(3));
+                }
+                return;
+
+                case 7:	writeString(body,playerObject->getTitle());	return;
+            }
+        }
+        break;
+
+        case DeltaPage_Play8:
+        {
+            switch(index)
+            {
+                case 2:	body.write<uint32>(playerObject->getHam()->getCurrentForce());	return;
+                case 3:	body.write<uint32>(playerObject->getHam()->getMaxForce());		return;
+            }
+        }
+        break;
+
+        case DeltaPage_Play9:
+        {
+            switch(index)
+            {
+                case 1:		body.write<uint32>(playerObject->getExperimentationFlag());		return;
+                case 2:		body.write<uint32>(playerObject->getCraftingStage());			return;
+                case 3:		body.write<uint64>(playerObject->getNearestCraftingStation());	return;
+                case 5:		body.write<uint32>(playerObject->getExperimentationPoints());	return;
+                case 9:		body.write<uint32>(playerObject->getLanguage());				return;
+                case 10:	body.write<uint32>(playerObject->getStomach()->getFood());		return;
+                case 12:	body.write<uint32>(playerObject->getStomach()->getDrink());		return;
+            }
+        }
+        break;
+    }
+
+    assert(false && "MessageLib::_writePlayerDelta unknown delta index");
+}
+
+//======================================================================================================================
+//
+// Tangible Deltas Type 3
+//
+
+void MessageLib::_writeTangibleDelta(ByteBuffer& body,TangibleObject* tangibleObject,uint16 index)
+{
+    switch(index)
+    {
+        case 0:	body.write<float>(tangibleObject->getComplexity());		return;
+        case 6:	body.write<uint32>(tangibleObject->getTypeOptions());	return;
+        case 7:	body.write<uint32>(tangibleObject->getTimer());			return;
+    }
+
+    assert(false && "MessageLib::_writeTangibleDelta unknown delta index");
+}
+
+//======================================================================================================================
+
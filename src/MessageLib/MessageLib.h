@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/typedefs.h"
 //#include "Utils/typedefs.h"
+#include "MessageLib/DeltaBatch.h"
 //#include "ZoneServer/ObjectFactory.h"
 #include "ZoneServer/ObjectController.h"
 #include "ZoneServer/Skill.h"   //for skillmodslist
@@ -76,6 +77,10 @@ class ConversationOption;
 class CraftingTool;
 class ActiveConversation;
 
+namespace common {
+class ByteBuffer;
+}
+
 typedef struct tagResourceLocation ResourceLocation;
 
 typedef std::set<PlayerObject*>			PlayerObjectSetML;
@@ -97,6 +102,17 @@ public:
     static MessageLib*	getSingletonPtr() { return mSingleton; }
     static MessageLib*	Init();
 
+    // merged deltas, deltamessages.cpp
+    // the single property delta senders only mark their property, once per tick sendDeltas
+    // builds one delta per object and baseline page out of everything marked since
+    void				sendDeltas();
+    void				forgetDeltas(uint64 objectId) {
+        mDeltaBatch.forget(objectId);
+    }
+    uint64				getDeltaMarkCount() const {
+        return(mDeltaBatch.getMarkCount());
+    }
+
     // multiple messages, messagelib.cpp
     bool				sendCreateObject(Object* object,PlayerObject* player,bool sendSelftoTarget = true);
     bool				sendCreateManufacturingSchematic(ManufacturingSchematic* manSchem,PlayerObject* playerObject,bool attributes = true);
@@ -334,6 +350,7 @@ public:
 
     void				sendCurrentHitpointDeltasCreo6_Single(CreatureObject* creatureObject,uint8 barIndex);
     void				sendCurrentHitpointDeltasCreo6_Full(CreatureObject* creatureObject);
+    void				sendCurrentHitpointDeltasCreo6_Multi(CreatureObject* creatureObject,uint16 barMask);
     void				sendWoundUpdateCreo3(CreatureObject* creatureObject,uint8 barIndex);
     void				sendBFUpdateCreo3(CreatureObject* playerObject);
 
@@ -483,6 +500,7 @@ public:
     void				sendHarvesterCurrentConditionUpdate(PlayerStructure* structure);
 
     void				sendConstructionComplete(PlayerObject* playerObject, PlayerStructure* Structure);
+    void				sendStructureMail(PlayerObject* playerObject, BString subject, BString attachments);
     void				SendUpdateHarvesterWorkAnimation(HarvesterObject* harvester);
 
     // Installation Messages
@@ -571,6 +589,13 @@ private:
     void				_sendToInstancedPlayersUnreliable(Message* message, uint16 priority, const PlayerObject* const player) const ;
     void				_sendToInstancedPlayers(Message* message, uint16 priority, const PlayerObject* const player) const ;
     void				_sendToAll(Message* message,uint16 priority,bool unreliable = false) const;
+
+    bool				_markTangibleDelta(TangibleObject* tangibleObject,PlayerObject* playerObject,uint16 index);
+    void				_sendDeltaPage(Object* object,DeltaRecord& record,uint8 page);
+    uint16				_writeDeltas(common::ByteBuffer& body,Object* object,DeltaRecord& record,uint8 page,uint32 mask);
+    void				_writeCreatureDelta(common::ByteBuffer& body,CreatureObject* creatureObject,DeltaRecord& record,uint8 page,uint16 index);
+    void				_writePlayerDelta(common::ByteBuffer& body,PlayerObject* playerObject,uint8 page,uint16 index);
+    void				_writeTangibleDelta(common::ByteBuffer& body,TangibleObject* tangibleObject,uint16 index);
    
     /**
      * Sends a spatial message to in-range players.
@@ -618,6 +643,9 @@ private:
     static bool			mInsFlag;
 
     MessageFactory*		mMessageFactory;
+
+    DeltaBatch				mDeltaBatch;
+    std::vector<DeltaRecord>	mDeltaRecords;
 };
 
 //======================================================================================================================
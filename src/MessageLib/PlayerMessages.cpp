@@ -405,21 +405,7 @@ bool MessageLib::sendBaselinesPLAY_9(PlayerObject* playerObject,PlayerObject* ta
 
 void MessageLib::sendFoodUpdate(PlayerObject* playerObject)
 {
-    // stomach
-    Stomach* stomach = playerObject->getStomach();
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(0x0a);
-    mMessageFactory->addUint32(stomach->getFood());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(), playerObject->getAccountId(), CR_Client, 5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,10);
 }
 
 //======================================================================================================================
@@ -430,21 +416,7 @@ void MessageLib::sendFoodUpdate(PlayerObject* playerObject)
 
 void MessageLib::sendDrinkUpdate(PlayerObject* playerObject)
 {
-    // stomach
-    Stomach* stomach = playerObject->getStomach();
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(0x0c);
-    mMessageFactory->addUint32(stomach->getDrink());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(), playerObject->getAccountId(), CR_Client, 5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,12);
 }
 
 //======================================================================================================================
@@ -455,18 +427,7 @@ void MessageLib::sendDrinkUpdate(PlayerObject* playerObject)
 
 void MessageLib::sendTitleUpdate(PlayerObject* playerObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(6 + playerObject->getTitle().getLength());
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(7);
-    mMessageFactory->addString(playerObject->getTitle());
-
-    _sendToInRange(mMessageFactory->EndMessage(),playerObject,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play3,7);
 }
 
 //======================================================================================================================
@@ -477,23 +438,7 @@ void MessageLib::sendTitleUpdate(PlayerObject* playerObject)
 
 void MessageLib::sendUpdatePlayerFlags(PlayerObject* playerObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(24);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(5);
-
-    mMessageFactory->addUint32(4);
-    mMessageFactory->addUint32(playerObject->getPlayerFlags());
-    mMessageFactory->addUint32(0);
-    mMessageFactory->addUint32(0);
-    mMessageFactory->addUint32(0);
-
-    _sendToInRange(mMessageFactory->EndMessage(),playerObject,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play3,5);
 }
 
 //======================================================================================================================
@@ -950,23 +895,7 @@ bool MessageLib::sendMatchPlay3(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(24);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(6);
-
-    mMessageFactory->addUint32(4); // unknown
-    mMessageFactory->addUint32(playerObject->getPlayerMatch(0));
-    mMessageFactory->addUint32(playerObject->getPlayerMatch(1));
-    mMessageFactory->addUint32(playerObject->getPlayerMatch(2));
-    mMessageFactory->addUint32(playerObject->getPlayerMatch(3));
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play3,6);
 
     return(true);
 }
@@ -982,18 +911,7 @@ bool MessageLib::sendUpdateCraftingStage(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(2);
-    mMessageFactory->addUint32(playerObject->getCraftingStage());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,2);
 
     return(true);
 }
@@ -1009,18 +927,7 @@ bool MessageLib::sendUpdateExperimentationFlag(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint32(playerObject->getExperimentationFlag());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,1);
 
     return(true);
 }
@@ -1036,18 +943,7 @@ bool MessageLib::sendUpdateExperimentationPoints(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(5);
-    mMessageFactory->addUint32(playerObject->getExperimentationPoints());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,5);
 
     return(true);
 }
@@ -1063,18 +959,7 @@ bool MessageLib::sendUpdateNearestCraftingStation(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(12);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(3);
-    mMessageFactory->addUint64(playerObject->getNearestCraftingStation());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,3);
 
     return(true);
 }
@@ -1087,19 +972,7 @@ bool MessageLib::sendUpdateNearestCraftingStation(PlayerObject* playerObject)
 
 void MessageLib::sendLanguagePlay9(PlayerObject* playerObject)
 {
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(9);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);//one var updated
-    mMessageFactory->addUint16(9);//var nr 9 updated
-
-    mMessageFactory->addUint32(playerObject->getLanguage());
-
-    _sendToInRange(mMessageFactory->EndMessage(),playerObject,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play9,9);
 }
 
 //======================================================================================================================
@@ -1113,18 +986,7 @@ bool MessageLib::sendUpdateCurrentForce(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(8);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(2);
-    mMessageFactory->addUint32(playerObject->getHam()->getCurrentForce());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play8,2);
 
     return(true);
 }
@@ -1140,18 +1002,7 @@ bool MessageLib::sendUpdateMaxForce(PlayerObject* playerObject)
     if(!(playerObject->isConnected()))
         return(false);
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(playerObject->getPlayerObjId());
-    mMessageFactory->addUint32(opPLAY);
-    mMessageFactory->addUint8(8);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-    mMessageFactory->addUint16(3);
-    mMessageFactory->addUint32(playerObject->getHam()->getMaxForce());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
+    mDeltaBatch.mark(playerObject->getId(),DeltaPage_Play8,3);
 
     return(true);
 }
@@ -252,4 +252,24 @@ void MessageLib::sendConstructionComplete(PlayerObject* playerObject, PlayerStru
 
 
 
+}
+
+//======================================================================================================================
+//
+// maintenance, damage and condemnation notices of the owners structures, the body comes assembled
+//
+
+void MessageLib::sendStructureMail(PlayerObject* playerObject, BString subject, BString attachments)
+{
+    mMessageFactory->StartMessage();
+    mMessageFactory->addUint32(opIsmSendSystemMailMessage);
+    mMessageFactory->addUint64(playerObject->getId());
+    mMessageFactory->addUint64(playerObject->getId());
+    mMessageFactory->addString(BString("@player_structure:management"));
+    mMessageFactory->addString(subject);
+    mMessageFactory->addUint32(0);
+    mMessageFactory->addString(attachments);
+
+    Message* newMessage = mMessageFactory->EndMessage();
+    playerObject->getClient()->SendChannelA(newMessage, playerObject->getAccountId(), CR_Chat, 6);
 }
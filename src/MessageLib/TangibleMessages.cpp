@@ -207,24 +207,7 @@ bool MessageLib::sendBaselinesTANO_9(const TangibleObject* const tangibleObject,
 
 bool MessageLib::sendUpdateComplexity(TangibleObject* tangibleObject,PlayerObject* playerObject)
 {
-    if(!(playerObject->isConnected()))
-        return(false);
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(tangibleObject->getId());
-    mMessageFactory->addUint32(opTANO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-
-    mMessageFactory->addUint16(0);
-    mMessageFactory->addFloat(tangibleObject->getComplexity());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
-
-    return(true);
+    return(_markTangibleDelta(tangibleObject,playerObject,0));
 }
 
 //======================================================================================================================
@@ -266,24 +249,7 @@ bool  MessageLib::sendUpdateCustomization_InRange(TangibleObject* tangibleObject
 
 bool MessageLib::sendUpdateTypeOption(TangibleObject* tangibleObject,PlayerObject* playerObject)
 {
-    if(!(playerObject->isConnected()))
-        return(false);
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(tangibleObject->getId());
-    mMessageFactory->addUint32(opTANO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(8);		//length
-
-    mMessageFactory->addUint16(1);	   //one update
-
-    mMessageFactory->addUint16(6);	   //nr 6 = type option.
-    mMessageFactory->addUint32(tangibleObject->getTypeOptions());
-
-    (playerObject->getClient())->SendChannelA(mMessageFactory->EndMessage(),playerObject->getAccountId(),CR_Client,5);
-    return(true);
+    return(_markTangibleDelta(tangibleObject,playerObject,6));
 }
 
 //======================================================================================================================
@@ -294,28 +260,7 @@ bool MessageLib::sendUpdateTypeOption(TangibleObject* tangibleObject,PlayerObjec
 
 bool MessageLib::sendUpdateTimer(TangibleObject* tangibleObject,PlayerObject* playerObject)
 {
-    if(!(playerObject->isConnected()))
-        return(false);
-
-    Message* newMessage;
-
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opDeltasMessage);
-    mMessageFactory->addUint64(tangibleObject->getId());
-    mMessageFactory->addUint32(opTANO);
-    mMessageFactory->addUint8(3);
-
-    mMessageFactory->addUint32(8);
-    mMessageFactory->addUint16(1);
-
-    mMessageFactory->addUint16(7);
-    mMessageFactory->addUint32(tangibleObject->getTimer());
-
-    newMessage = mMessageFactory->EndMessage();
-
-    (playerObject->getClient())->SendChannelA(newMessage,playerObject->getAccountId(),CR_Client,5);
-
-    return(true);
+    return(_markTangibleDelta(tangibleObject,playerObject,7));
 }
 
 //======================================================================================================================
@@ -0,0 +1,131 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "MessageLib/DeltaBatch.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+TEST(DeltaBatchTests, MarkingAPropertyTwiceKeepsOneRecord) {
+    DeltaBatch batch;
+
+    batch.mark(1, DeltaPage_Creo6, 13);
+    batch.mark(1, DeltaPage_Creo6, 13);
+
+    EXPECT_EQ(1u, batch.size());
+    EXPECT_EQ(2u, batch.getMarkCount());
+
+    std::vector<DeltaRecord> records;
+    batch.take(records);
+
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(uint32(1 << 13), records[0].mDirty[DeltaPage_Creo6]);
+}
+
+TEST(DeltaBatchTests, PagesAndBarsOfOneObjectAreMerged) {
+    DeltaBatch batch;
+
+    batch.mark(1, DeltaPage_Creo6, 13).mCurrentBars |= (1 << 0);
+    batch.mark(1, DeltaPage_Creo6, 13).mCurrentBars |= (1 << 3);
+    batch.mark(1, DeltaPage_Creo6, 14).mMaxBars |= (1 << 6);
+    batch.mark(1, DeltaPage_Creo3, 2);
+
+    std::vector<DeltaRecord> records;
+    batch.take(records);
+
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(uint32((1 << 13) | (1 << 14)), records[0].mDirty[DeltaPage_Creo6]);
+    EXPECT_EQ(uint32(1 << 2), records[0].mDirty[DeltaPage_Creo3]);
+    EXPECT_EQ(uint16((1 << 0) | (1 << 3)), records[0].mCurrentBars);
+    EXPECT_EQ(uint16(1 << 6), records[0].mMaxBars);
+}
+
+TEST(DeltaBatchTests, RecordsAreTakenInTheOrderObjectsWereFirstMarked) {
+    DeltaBatch batch;
+
+    batch.mark(30, DeltaPage_Creo6, 13);
+    batch.mark(10, DeltaPage_Creo6, 13);
+    batch.mark(30, DeltaPage_Creo4, 1);
+    batch.mark(20, DeltaPage_Play8, 0);
+
+    std::vector<DeltaRecord> records;
+    batch.take(records);
+
+    ASSERT_EQ(3u, records.size());
+    EXPECT_EQ(uint64(30), records[0].mObjectId);
+    EXPECT_EQ(uint64(10), records[1].mObjectId);
+    EXPECT_EQ(uint64(20), records[2].mObjectId);
+}
+
+TEST(DeltaBatchTests, TakeStartsANewBatch) {
+    DeltaBatch batch;
+    std::vector<DeltaRecord> records;
+
+    batch.mark(1, DeltaPage_Creo6, 13);
+    batch.take(records);
+
+    EXPECT_EQ(0u, batch.size());
+
+    // Marking the object again starts a fresh record.
+    batch.mark(1, DeltaPage_Creo3, 2);
+    batch.take(records);
+
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(0u, records[0].mDirty[DeltaPage_Creo6]);
+    EXPECT_EQ(uint32(1 << 2), records[0].mDirty[DeltaPage_Creo3]);
+}
+
+TEST(DeltaBatchTests, ForgottenObjectsAreSkipped) {
+    DeltaBatch batch;
+
+    batch.mark(1, DeltaPage_Creo6, 13);
+    batch.mark(2, DeltaPage_Creo6, 13);
+    batch.mark(3, DeltaPage_Creo6, 13);
+
+    // Object 2 is destroyed before the tick ends.
+    batch.forget(2);
+
+    std::vector<DeltaRecord> records;
+    batch.take(records);
+
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(uint64(1), records[0].mObjectId);
+    EXPECT_EQ(uint64(3), records[1].mObjectId);
+}
+
+TEST(DeltaBatchTests, MarkingAForgottenIdStartsAFreshRecord) {
+    DeltaBatch batch;
+
+    batch.mark(1, DeltaPage_Creo6, 13);
+    batch.forget(1);
+
+    // An object created under the same id within the tick only gets its own deltas.
+    batch.mark(1, DeltaPage_Creo3, 2);
+
+    std::vector<DeltaRecord> records;
+    batch.take(records);
+
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(0u, records[0].mDirty[DeltaPage_Creo6]);
+    EXPECT_EQ(uint32(1 << 2), records[0].mDirty[DeltaPage_Creo3]);
+}
+
+TEST(DeltaBatchTests, ForgettingAnUnmarkedObjectDoesNothing) {
+    DeltaBatch batch;
+
+    batch.mark(1, DeltaPage_Creo6, 13);
+    batch.forget(2);
+
+    std::vector<DeltaRecord> records;
+    batch.take(records);
+
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(uint64(1), records[0].mObjectId);
+}
+
+}  // namespace
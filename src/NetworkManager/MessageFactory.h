@@ -65,6 +65,9 @@ public:
     static MessageFactory*	getSingleton(void);
     static void             destroySingleton(void);
 
+    // creates the singleton with the given heap size instead of the configured one, for processes without a config
+    static MessageFactory*	Init(uint32 heapSize);
+
     // Data packing methods.
     void                    addInt8(int8 data);
     void                    addUint8(uint8 data);
@@ -138,6 +141,18 @@ inline MessageFactory* MessageFactory::getSingleton(void)
 
 //======================================================================================================================
 
+inline MessageFactory* MessageFactory::Init(uint32 heapSize)
+{
+    if(!mSingleton)
+    {
+        mSingleton = new MessageFactory(heapSize);
+    }
+
+    return mSingleton;
+}
+
+//======================================================================================================================
+
 inline void MessageFactory::destroySingleton(void)
 {
     if (mSingleton)
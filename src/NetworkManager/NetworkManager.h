@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <queue>
 #include "Utils/concurrent_queue.h"
+#include "Utils/EventLoop.h"
 #include "Utils/typedefs.h"
 #include "Service.h"
 
@@ -82,6 +83,12 @@ inline void NetworkManager::AddServiceToProcessQueue(Service* service)
 
         mServiceProcessQueue.push(service);
     }
+
+    // let the main loop know there are messages waiting
+    if(Anh_Utils::EventLoop* loop = gEventLoop)
+    {
+        loop->wakeup();
+    }
 }
 
 //======================================================================================================================
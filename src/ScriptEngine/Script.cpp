@@ -53,15 +53,22 @@ Script::Script(ScriptEngine* scriptEngine) :
     mEngine(scriptEngine),
     mState(SS_Not_Loaded),
     mWaitTimeStamp(0),
-    mTime(0),
-    mWaitFrame(0)
+    mWaitFrame(0),
+    mTutorial(NULL),
+    mThreadRef(0),
+    mStartTime(scriptEngine->getTime()),
+    mRunTime(0),
+    mPreempted(false),
+    mSlot(0),
+    mPriority(0)
 {
-    mThreadState = lua_newthread(mEngine->getMasterState());
+    mThreadState = mEngine->_acquireThread(mThreadRef);
 
     lua_pushlightuserdata(mEngine->getMasterState(),mThreadState);
     lua_pushlightuserdata(mEngine->getMasterState(),this);
     lua_settable(mEngine->getMasterState(),LUA_GLOBALSINDEX);
 
+    mFile[0] = 0;
     strcpy(mLastError,"None");
 }
 
@@ -79,7 +86,7 @@ void Script::run()
     assert(mEngine->getMasterState() && "Invalid engine master state");
     assert(mThreadState && "Invalid thread state");
 
-    if(luaL_loadfile(mThreadState,mFile) == 0)
+    if(mEngine->loadFile(mThreadState,mFile) == 0)
     {
         _resumeScript(0);
     }
@@ -96,7 +103,7 @@ void Script::runFile(const int8 *fileName)
     assert(mEngine->getMasterState() && "Invalid engine master state");
     assert(mThreadState && "Invalid thread state");
 
-    if(luaL_loadfile(mThreadState,fileName) == 0)
+    if(mEngine->loadFile(mThreadState,fileName) == 0)
     {
         _resumeScript(0);
     }
@@ -115,7 +122,11 @@ uint32 Script::runString(const int8 *cmdString)
 
     if(luaL_loadbuffer(mThreadState,cmdString,strlen(cmdString),"Console") == 0)
     {
-        if(lua_pcall(mThreadState,lua_gettop(mThreadState) - 1,0,0) != 0)
+        mEngine->_beginRun(this,false);
+        int ret = lua_pcall(mThreadState,lua_gettop(mThreadState) - 1,0,0);
+        mEngine->_endRun();
+
+        if(ret != 0)
         {
             _formatError();
             return(1);
@@ -132,39 +143,38 @@ uint32 Script::runString(const int8 *cmdString)
 
 //======================================================================================================================
 
-void Script::process(uint32 elTime)
+void Script::abortWait()
 {
-    mTime += elTime;
+    mEngine->_cancelWait(this);
 
-    switch(mState)
-    {
-    case SS_Wait_Time:
-    {
-        if(mTime >= mWaitTimeStamp)
-            _resumeScript(0);
-    }
-    break;
+    _resumeScript(1);
+}
 
-    case SS_Wait_Frame:
-    {
-        mWaitFrame--;
+//======================================================================================================================
 
-        if(mWaitFrame <= 0)
-            _resumeScript(0);
-    }
-    break;
+void Script::waitTime(uint32 timeStamp)
+{
+    mWaitTimeStamp	= timeStamp;
+    mState			= SS_Wait_Time;
 
-    case SS_Not_Loaded:
-    default:
-        break;
-    }
+    mEngine->_waitUntil(this,mStartTime + timeStamp);
 }
 
 //======================================================================================================================
 
-void Script::abortWait()
+void Script::waitFrames(int32 frames)
 {
-    _resumeScript(1);
+    mWaitFrame	= frames;
+    mState		= SS_Wait_Frame;
+
+    mEngine->_waitFrames(this);
+}
+
+//======================================================================================================================
+
+uint32 Script::getTime()
+{
+    return(static_cast<uint32>(mEngine->getTime() - mStartTime));
 }
 
 //======================================================================================================================
@@ -173,9 +183,23 @@ void Script::_resumeScript(uint32 param)
 {
     mState = SS_Running;
 
-    lua_pushnumber(mThreadState,param);
+    int args = 0;
 
-    int ret = lua_resume(mThreadState,1);
+    // a script the budget hook yielded just continues where it was, anything else starts a fresh run
+    if(mPreempted)
+    {
+        mPreempted = false;
+    }
+    else
+    {
+        mRunTime = 0;
+        lua_pushnumber(mThreadState,param);
+        args = 1;
+    }
+
+    mEngine->_beginRun(this,true);
+    int ret = lua_resume(mThreadState,args);
+    mEngine->_endRun();
 
     switch(ret)
     {
@@ -187,6 +211,8 @@ void Script::_resumeScript(uint32 param)
 
     default:
     {
+        // errors and budget kills leave a dead coroutine behind
+        mState = SS_Done;
         _formatError();
     }
     break;
@@ -254,7 +280,11 @@ endwhile:
 
         nres = strlen(sig);
 
-        if(lua_pcall(mThreadState,narg,nres,0) != 0)
+        mEngine->_beginRun(this,false);
+        int ret = lua_pcall(mThreadState,narg,nres,0);
+        mEngine->_endRun();
+
+        if(ret != 0)
         {
             _formatError();
         }
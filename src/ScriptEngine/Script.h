@@ -63,14 +63,19 @@ public:
     explicit Script(ScriptEngine* scriptEngine);
     ~Script();
 
-    void			createThread();
-    void			process(uint32 elTime);
     void			run();
     void			runFile(const int8* fileName);
     uint32			runString(const int8* cmdString);
     void			callFunction(const char *func,const char *sig,...);
     void			abortWait();
 
+    // suspend until the scripts clock reaches timeStamp / for a number of frames, the caller yields afterwards
+    void			waitTime(uint32 timeStamp);
+    void			waitFrames(int32 frames);
+
+    // milliseconds since the script was created, in steps of engine frames
+    uint32			getTime();
+
     uint32			getPriority() {
         return mPriority;
     }
@@ -97,7 +102,6 @@ public:
     ScriptEngine*	mEngine;
     ScriptState		mState;
     uint32			mWaitTimeStamp;
-    uint32			mTime;
     int32			mWaitFrame;
 
 private:
@@ -110,6 +114,14 @@ private:
     Tutorial*			mTutorial;
 
     lua_State*		mThreadState;
+    int				mThreadRef;
+    uint64			mStartTime;
+
+    // wall time (us) run since the script last waited on its own, preempted resumes add up
+    uint64			mRunTime;
+    bool			mPreempted;
+
+    uint32			mSlot;
     uint32			mPriority;
     int8			mFile[256];
     int8			mLastError[256];
@@ -41,6 +41,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <glog/logging.h>
 
 #include "Utils/clock.h"
+#include "Utils/TickProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+using Anh_Utils::TickProfiler;
 
 
 
@@ -53,7 +63,13 @@ ScriptEngine*	ScriptEngine::mSingleton  = NULL;
 //======================================================================================================================
 
 ScriptEngine::ScriptEngine() :
-    mScriptPool(sizeof(Script))
+    mScriptPool(sizeof(Script)),
+    mInstructionBudget(1000000),
+    mTimeBudget(10000),
+    mKillTime(1000000),
+    mRunCounter(0),
+    mSampleCounter(0),
+    mSampleCount(0)
 {
     mMasterState = luaL_newstate();
 
@@ -70,6 +86,8 @@ ScriptEngine::ScriptEngine() :
     // mClock = new Anh_Utils::Clock();
 
     mLastProcessTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    mWheel.start(mLastProcessTime);
 }
 
 //======================================================================================================================
@@ -101,14 +119,23 @@ void ScriptEngine::shutdown()
 {
     boost::mutex::scoped_lock lk(mScriptMutex);
 
-    ScriptList::iterator it = mScripts.begin();
+    ScriptSlots::iterator it = mSlots.begin();
 
-    while(it != mScripts.end())
+    while(it != mSlots.end())
     {
-        mScriptPool.free(*it);
-        it = mScripts.erase(it);
+        if(*it)
+        {
+            mScriptPool.free(*it);
+        }
+        ++it;
     }
 
+    mSlots.clear();
+    mFreeSlots.clear();
+    mFrameWaiters.clear();
+    mFreeThreads.clear();
+    mChunks.clear();
+
     lk.unlock();
 
     if(mMasterState)
@@ -121,24 +148,70 @@ void ScriptEngine::shutdown()
 }
 
 //======================================================================================================================
+//
+// only scripts with something to do are touched, the sleeping ones wait in the wheel
+//
 
 void ScriptEngine::process()
 {
     uint64	currentTime	= Anh_Utils::Clock::getSingleton()->getLocalTime();
-    uint32	elTime		= (uint32)(currentTime - mLastProcessTime);
     mLastProcessTime	= currentTime;
 
 
     boost::mutex::scoped_lock lk(mScriptMutex);
 
-    ScriptList::iterator it = mScripts.begin();
+    // scripts going back to WaitFrame while we run them, or preempted by the budget hook, start counting next frame
+    mFrameRunning.swap(mFrameWaiters);
+
+    ScriptSlots::iterator frameIt = mFrameRunning.begin();
 
-    while(it != mScripts.end())
+    while(frameIt != mFrameRunning.end())
     {
-        (*it)->process(elTime);
+        Script* script = (*frameIt);
 
-        ++it;
+        if(script->mState == SS_Wait_Frame)
+        {
+            if(--script->mWaitFrame <= 0)
+            {
+                script->_resumeScript(0);
+            }
+            else
+            {
+                mFrameWaiters.push_back(script);
+            }
+        }
+
+        ++frameIt;
+    }
+
+    mFrameRunning.clear();
+
+    mWheel.advance(currentTime,mExpired);
+
+    std::vector<uint32>::iterator expiredIt = mExpired.begin();
+
+    while(expiredIt != mExpired.end())
+    {
+        Script* script = mSlots[*expiredIt];
+
+        if(script && script->mState == SS_Wait_Time)
+        {
+            script->_resumeScript(0);
+        }
+
+        ++expiredIt;
     }
+
+    mExpired.clear();
+}
+
+//======================================================================================================================
+
+uint64 ScriptEngine::getNextDeadline()
+{
+    boost::mutex::scoped_lock lk(mScriptMutex);
+
+    return(mWheel.getNextDue());
 }
 
 //======================================================================================================================
@@ -149,7 +222,17 @@ Script* ScriptEngine::createScript()
 
     boost::mutex::scoped_lock lk(mScriptMutex);
 
-    mScripts.push_back(script);
+    if(mFreeSlots.empty())
+    {
+        script->mSlot = static_cast<uint32>(mSlots.size());
+        mSlots.push_back(script);
+    }
+    else
+    {
+        script->mSlot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+        mSlots[script->mSlot] = script;
+    }
 
     return(script);
 }
@@ -160,43 +243,493 @@ void ScriptEngine::removeScript(Script* script)
 {
     boost::mutex::scoped_lock lk(mScriptMutex);
 
-    ScriptList::iterator it = mScripts.begin();
+    if(script->mSlot >= mSlots.size() || mSlots[script->mSlot] != script)
+    {
+        return;
+    }
+
+    DLOG(INFO) << "ScriptEngine::removeScript found a script";
+
+    _cancelWait(script);
+
+    mSlots[script->mSlot] = NULL;
+    mFreeSlots.push_back(script->mSlot);
+
+    // drop the thread -> script link before the thread goes to the next script
+    lua_pushlightuserdata(mMasterState,script->mThreadState);
+    lua_pushnil(mMasterState);
+    lua_settable(mMasterState,LUA_GLOBALSINDEX);
+
+    _releaseThread(script->mThreadState,script->mThreadRef);
+
+    script->mState = SS_Not_Loaded;
+    mScriptPool.free(script);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_waitUntil(Script* script,uint64 due)
+{
+    mWheel.insert(script->mSlot,due);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_waitFrames(Script* script)
+{
+    mFrameWaiters.push_back(script);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_cancelWait(Script* script)
+{
+    mWheel.remove(script->mSlot);
+
+    ScriptSlots::iterator it = std::find(mFrameWaiters.begin(),mFrameWaiters.end(),script);
+
+    if(it != mFrameWaiters.end())
+    {
+        mFrameWaiters.erase(it);
+    }
+}
+
+//======================================================================================================================
+//
+// threads are anchored in the registry, the ones of removed scripts are handed out again
+//
+
+lua_State* ScriptEngine::_acquireThread(int& ref)
+{
+    if(!mFreeThreads.empty())
+    {
+        ScriptThread thread = mFreeThreads.back();
+        mFreeThreads.pop_back();
+
+        ref = thread.mRef;
+        return(thread.mState);
+    }
+
+    lua_State* thread = lua_newthread(mMasterState);
+
+    // pops the thread
+    ref = luaL_ref(mMasterState,LUA_REGISTRYINDEX);
+
+    // budgets and sampling, the hook stays with the thread when it is pooled
+    lua_sethook(thread,_hook,LUA_MASKCOUNT,HookSlice);
+
+    return(thread);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_releaseThread(lua_State* thread,int ref)
+{
+    // a coroutine suspended mid script or dead from an error can't be reset, leave it to the gc
+    if(lua_status(thread) != 0 || mFreeThreads.size() >= MaxPooledThreads)
+    {
+        luaL_unref(mMasterState,LUA_REGISTRYINDEX,ref);
+        return;
+    }
+
+    lua_settop(thread,0);
+
+    ScriptThread pooled;
+    pooled.mState	= thread;
+    pooled.mRef		= ref;
+
+    mFreeThreads.push_back(pooled);
+}
+
+//======================================================================================================================
+
+int ScriptEngine::loadFile(lua_State* l,const int8* fileName)
+{
+    struct stat fileInfo;
+
+    // missing file, let lua report it
+    if(stat(fileName,&fileInfo) != 0)
+    {
+        return(luaL_loadfile(l,fileName));
+    }
+
+    ScriptChunkMap::iterator it = mChunks.find(fileName);
+
+    if(it != mChunks.end() && (*it).second.mModified == fileInfo.st_mtime)
+    {
+        const ScriptChunk& chunk = (*it).second;
+
+        return(luaL_loadbuffer(l,chunk.mByteCode.data(),chunk.mByteCode.size(),chunk.mName.c_str()));
+    }
+
+    int ret = luaL_loadfile(l,fileName);
+
+    if(ret != 0)
+    {
+        return(ret);
+    }
+
+    ScriptChunk& chunk = mChunks[fileName];
+
+    // same chunk name luaL_loadfile uses, so errors still point at the file
+    chunk.mModified	= fileInfo.st_mtime;
+    chunk.mName		= std::string("@") + fileName;
+    chunk.mByteCode.clear();
+
+    if(lua_dump(l,_writeChunk,&chunk.mByteCode) != 0)
+    {
+        mChunks.erase(fileName);
+    }
+
+    return(0);
+}
+
+//======================================================================================================================
+
+int ScriptEngine::_writeChunk(lua_State* l,const void* data,size_t size,void* byteCode)
+{
+    reinterpret_cast<std::string*>(byteCode)->append(reinterpret_cast<const char*>(data),size);
+
+    return(0);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::setBudgets(uint32 instructions,uint32 timeBudget,uint32 killTime)
+{
+    mInstructionBudget	= instructions;
+    mTimeBudget			= static_cast<uint64>(timeBudget) * 1000;
+    mKillTime			= static_cast<uint64>(killTime) * 1000;
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_beginRun(Script* script,bool yieldable)
+{
+    ScriptRun run;
+    run.mScript			= script;
+    run.mStart			= TickProfiler::getMicroseconds();
+    run.mInstructions	= 0;
+    run.mYieldable		= yieldable;
+
+    // glue calls are timed for a sample of the outermost runs only, call hooks are not free
+    run.mSampled		= mRuns.empty() && (++mRunCounter % CallSampleRate) == 0;
+
+    if(run.mSampled)
+    {
+        lua_sethook(script->mThreadState,_hook,LUA_MASKCOUNT | LUA_MASKCALL | LUA_MASKRET,HookSlice);
+    }
+
+    mRuns.push_back(run);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_endRun()
+{
+    ScriptRun run = mRuns.back();
+    mRuns.pop_back();
+
+    uint64 elapsed = TickProfiler::getMicroseconds() - run.mStart;
+
+    if(run.mYieldable)
+    {
+        run.mScript->mRunTime += elapsed;
+    }
+
+    if(run.mSampled)
+    {
+        lua_sethook(run.mScript->mThreadState,_hook,LUA_MASKCOUNT,HookSlice);
+        mCalls.clear();
+    }
+
+    ScriptProfile& profile = _getProfile(run.mScript);
+
+    profile.mRuns++;
+    profile.mTime			+= elapsed;
+    profile.mInstructions	+= run.mInstructions;
+
+    if(elapsed > profile.mMaxTime)
+    {
+        profile.mMaxTime = elapsed;
+    }
+}
+
+//======================================================================================================================
+
+ScriptProfile& ScriptEngine::_getProfile(Script* script)
+{
+    if(!script->mFile[0])
+    {
+        return(mProfiles["Console"]);
+    }
+
+    return(mProfiles[script->mFile]);
+}
+
+//======================================================================================================================
+//
+// runs every HookSlice instructions and, during sampled runs, on every call and return
+//
+
+void ScriptEngine::_hook(lua_State* l,lua_Debug* ar)
+{
+    ScriptEngine* engine = mSingleton;
+
+    if(!engine || engine->mRuns.empty())
+    {
+        return;
+    }
+
+    if(ar->event != LUA_HOOKCOUNT)
+    {
+        engine->_profileCall(l,ar);
+        return;
+    }
+
+    bool kill = false;
+
+    if(!engine->_budgetExceeded(l,ar,engine->mRuns.back(),kill))
+    {
+        return;
+    }
+
+    // both leave through lua, nothing with a destructor may be alive in this frame
+    if(kill)
+    {
+        luaL_error(l,"script stopped, ran for more than %d ms without waiting",static_cast<int>(engine->mKillTime / 1000));
+        return;
+    }
 
-    while(it != mScripts.end())
+    lua_yield(l,0);
+}
+
+//======================================================================================================================
+//
+// true if the hook has to stop the script, kill tells whether it may continue next frame
+// a script inside a pcall or a glue callback can't be suspended, it only has the kill limit then
+//
+
+bool ScriptEngine::_budgetExceeded(lua_State* l,lua_Debug* ar,ScriptRun& run,bool& kill)
+{
+    run.mInstructions += HookSlice;
+
+    if(++mSampleCounter >= SampleRate)
     {
-        if((*it) == script)
+        mSampleCounter = 0;
+
+        if(lua_getinfo(l,"S",ar))
         {
-            DLOG(INFO) << "ScriptEngine::removeScript found a script";
-            (*it)->mState = SS_Not_Loaded;
-            mScriptPool.free(*it);
-            mScripts.erase(it);
-            break;
+            int8 function[LUA_IDSIZE + 16];
+            sprintf(function,"%s:%d",ar->short_src,ar->linedefined);
+
+            mSamples[function]++;
+            mSampleCount++;
         }
-        ++it;
+    }
+
+    Script*	script	= run.mScript;
+    uint64	elapsed	= TickProfiler::getMicroseconds() - run.mStart;
+
+    // calls through callFunction / runString can't be yielded, they only have the kill limit
+    if((run.mYieldable ? script->mRunTime + elapsed : elapsed) >= mKillTime)
+    {
+        _getProfile(script).mKills++;
+        kill = true;
+        return(true);
+    }
+
+    // coroutines the script created itself share the hook, only the scripts own thread is ours to yield
+    if(!run.mYieldable || l != script->mThreadState)
+    {
+        return(false);
+    }
+
+    if(run.mInstructions < mInstructionBudget && elapsed < mTimeBudget)
+    {
+        return(false);
+    }
+
+    if(!_canYield(l))
+    {
+        return(false);
+    }
+
+    // carries on next frame, the run time keeps adding up until it waits on its own
+    script->mPreempted	= true;
+    script->mWaitFrame	= 1;
+    script->mState		= SS_Wait_Frame;
+    _waitFrames(script);
+
+    _getProfile(script).mPreempts++;
+
+    return(true);
+}
+
+//======================================================================================================================
+//
+// lua can't yield across a c function on the stack, it would stop the script with an error instead
+//
+
+bool ScriptEngine::_canYield(lua_State* l)
+{
+    lua_Debug frame;
+
+    for(int level = 0; lua_getstack(l,level,&frame); level++)
+    {
+        if(lua_getinfo(l,"S",&frame) && strcmp(frame.what,"C") == 0)
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+//======================================================================================================================
+
+void ScriptEngine::_profileCall(lua_State* l,lua_Debug* ar)
+{
+    uint64 now = TickProfiler::getMicroseconds();
+
+    if(ar->event == LUA_HOOKCALL)
+    {
+        ScriptCall call;
+        call.mStart	= now;
+        call.mGlue	= false;
+
+        if(lua_getinfo(l,"nS",ar) && ar->what && strcmp(ar->what,"C") == 0)
+        {
+            call.mGlue = true;
+            call.mName = ar->name ? ar->name : "?";
+        }
+
+        mCalls.push_back(call);
+        return;
+    }
+
+    // LUA_HOOKRET and LUA_HOOKTAILRET, a run resumed mid function returns from frames we never saw
+    if(mCalls.empty())
+    {
+        return;
+    }
+
+    const ScriptCall& call = mCalls.back();
+
+    if(call.mGlue)
+    {
+        ScriptGlueProfile& glue = mGlueProfiles[call.mName];
+
+        glue.mCalls++;
+        glue.mTime += now - call.mStart;
+    }
+
+    mCalls.pop_back();
+}
+
+//======================================================================================================================
+
+void ScriptEngine::printProfile(std::ostream& out) const
+{
+    typedef std::vector<std::pair<uint64,std::string> > CostList;
+
+    CostList scripts;
+    ScriptProfileMap::const_iterator scriptIt = mProfiles.begin();
+
+    while(scriptIt != mProfiles.end())
+    {
+        scripts.push_back(std::make_pair((*scriptIt).second.mTime,(*scriptIt).first));
+        ++scriptIt;
+    }
+
+    std::sort(scripts.begin(),scripts.end(),std::greater<CostList::value_type>());
+
+    out << "scripts:" << std::endl;
+
+    for(uint32 i = 0; i < scripts.size(); i++)
+    {
+        const ScriptProfile& profile = mProfiles.find(scripts[i].second)->second;
+
+        out << "  " << scripts[i].second << ": runs=" << profile.mRuns
+            << " total=" << profile.mTime
+            << "us mean=" << (profile.mRuns ? profile.mTime / profile.mRuns : 0)
+            << "us max=" << profile.mMaxTime
+            << "us instructions~" << profile.mInstructions
+            << " preempted=" << profile.mPreempts
+            << " killed=" << profile.mKills << std::endl;
+    }
+
+    CostList functions;
+    ScriptSampleMap::const_iterator sampleIt = mSamples.begin();
+
+    while(sampleIt != mSamples.end())
+    {
+        functions.push_back(std::make_pair((*sampleIt).second,(*sampleIt).first));
+        ++sampleIt;
+    }
+
+    std::sort(functions.begin(),functions.end(),std::greater<CostList::value_type>());
+
+    out << "functions, " << mSampleCount << " samples every " << HookSlice * SampleRate << " instructions:" << std::endl;
+
+    for(uint32 i = 0; i < functions.size() && i < 20; i++)
+    {
+        out << "  " << functions[i].second << ": " << functions[i].first
+            << " (" << functions[i].first * 100 / mSampleCount << "%)" << std::endl;
+    }
+
+    CostList bindings;
+    ScriptGlueProfileMap::const_iterator glueIt = mGlueProfiles.begin();
+
+    while(glueIt != mGlueProfiles.end())
+    {
+        bindings.push_back(std::make_pair((*glueIt).second.mTime,(*glueIt).first));
+        ++glueIt;
+    }
+
+    std::sort(bindings.begin(),bindings.end(),std::greater<CostList::value_type>());
+
+    out << "glue bindings, 1 in " << CallSampleRate << " runs:" << std::endl;
+
+    for(uint32 i = 0; i < bindings.size() && i < 20; i++)
+    {
+        const ScriptGlueProfile& glue = mGlueProfiles.find(bindings[i].second)->second;
+
+        out << "  " << bindings[i].second << ": calls=" << glue.mCalls
+            << " total=" << glue.mTime
+            << "us mean=" << glue.mTime / glue.mCalls << "us" << std::endl;
     }
 }
 
 //======================================================================================================================
 
+void ScriptEngine::resetProfile()
+{
+    mProfiles.clear();
+    mSamples.clear();
+    mGlueProfiles.clear();
+    mSampleCount = 0;
+}
+
+//======================================================================================================================
+
 // Access member data from script class.
 
 //======================================================================================================================
 
 Tutorial* ScriptEngine::getTutorial(void* script)
 {
-    Tutorial* tutorial = NULL;
+    Tutorial*	tutorial	= NULL;
+    Script*		scriptObj	= reinterpret_cast<Script*>(script);
 
     boost::mutex::scoped_lock lk(mScriptMutex);
 
-    ScriptList::iterator it = mScripts.begin();
-    while(it != mScripts.end())
+    // only dereference it once it is known to be live
+    ScriptSlots::iterator it = std::find(mSlots.begin(),mSlots.end(),scriptObj);
+
+    if(it != mSlots.end() && scriptObj)
     {
-        if((*it) == reinterpret_cast<Script*>(script))
-        {
-            tutorial = (*it)->getTutorial();
-            break;
-        }
-        ++it;
+        tutorial = scriptObj->getTutorial();
     }
 
     return tutorial;
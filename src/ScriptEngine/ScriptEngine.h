@@ -39,16 +39,102 @@ extern "C"
 
 #include "Script.h"
 #include "Utils/typedefs.h"
+#include "Utils/TimingWheel.h"
 
 #include <boost/pool/pool.hpp>
 #include <boost/thread/mutex.hpp>
+#include <ctime>
 #include <list>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
 
 #define	 gScriptEngine	ScriptEngine::getSingletonPtr()
 
 class Tutorial;
 
 typedef std::list<Script*>	ScriptList;
+typedef std::vector<Script*>	ScriptSlots;
+
+//======================================================================================================================
+//
+// a compiled script file, reloaded from source when the file changes
+//
+
+struct ScriptChunk
+{
+    time_t			mModified;
+    std::string		mName;
+    std::string		mByteCode;
+};
+
+typedef std::map<std::string,ScriptChunk>	ScriptChunkMap;
+
+//======================================================================================================================
+//
+// a lua thread kept alive in the registry so it can be handed to the next script
+//
+
+struct ScriptThread
+{
+    lua_State*		mState;
+    int				mRef;
+};
+
+typedef std::vector<ScriptThread>	ScriptThreadList;
+
+//======================================================================================================================
+//
+// what runs of one script file cost, times in us
+//
+
+struct ScriptProfile
+{
+    ScriptProfile() : mRuns(0),mTime(0),mMaxTime(0),mInstructions(0),mPreempts(0),mKills(0) {}
+
+    uint64			mRuns;
+    uint64			mTime;
+    uint64			mMaxTime;
+    uint64			mInstructions;
+    uint32			mPreempts;
+    uint32			mKills;
+};
+
+// calls into the c++ glue, timed during sampled runs only
+struct ScriptGlueProfile
+{
+    ScriptGlueProfile() : mCalls(0),mTime(0) {}
+
+    uint64			mCalls;
+    uint64			mTime;
+};
+
+typedef std::map<std::string,ScriptProfile>		ScriptProfileMap;
+typedef std::map<std::string,ScriptGlueProfile>	ScriptGlueProfileMap;
+typedef std::map<std::string,uint64>			ScriptSampleMap;
+
+//======================================================================================================================
+//
+// a resume or call in progress, nested when a script calls into another one through the glue
+//
+
+struct ScriptRun
+{
+    Script*			mScript;
+    uint64			mStart;
+    uint64			mInstructions;
+    bool			mYieldable;
+    bool			mSampled;
+};
+
+// a frame of a sampled run, c functions are the glue bindings
+struct ScriptCall
+{
+    std::string		mName;
+    uint64			mStart;
+    bool			mGlue;
+};
 
 //======================================================================================================================
 
@@ -74,11 +160,74 @@ public:
     ~ScriptEngine();
     Tutorial*				getTutorial(void* script);
 
+    // luaL_loadfile through the chunk cache, the file is only parsed again when its mtime changes
+    int						loadFile(lua_State* l,const int8* fileName);
+
+    // time of the last process() call, what WaitTime / WaitMSec count in
+    uint64					getTime() {
+        return mLastProcessTime;
+    }
+
+    // earliest wakeup of a script sleeping in WaitTime / WaitMSec, in local time
+    // WaitFrame counts main loop ticks and does not keep the loop awake
+    uint64					getNextDeadline();
+
+    uint32					getScriptCount() {
+        return(static_cast<uint32>(mSlots.size() - mFreeSlots.size()));
+    }
+    uint32					getSleepingCount() {
+        return mWheel.size();
+    }
+    uint32					getPooledThreadCount() {
+        return(static_cast<uint32>(mFreeThreads.size()));
+    }
+
+    // a resume running longer than instructions / timeBudget (ms) is yielded until the next frame,
+    // a script that ran killTime (ms) without waiting on its own is stopped with an error
+    void					setBudgets(uint32 instructions,uint32 timeBudget,uint32 killTime);
+
+    // per script cost, sampled hot functions and glue bindings since the last reset
+    void					printProfile(std::ostream& out) const;
+    void					resetProfile();
 
 private:
 
+    friend class Script;
+
+    enum
+    {
+        MaxPooledThreads	= 64,
+
+        // the budget hook runs every HookSlice instructions, every SampleRate-th call samples the running function
+        HookSlice			= 1000,
+        SampleRate			= 10,
+
+        // every CallSampleRate-th run times its glue calls
+        CallSampleRate		= 32
+    };
+
     ScriptEngine();
 
+    // called from the running script when it yields in one of the Wait functions
+    void					_waitUntil(Script* script,uint64 due);
+    void					_waitFrames(Script* script);
+    void					_cancelWait(Script* script);
+
+    lua_State*				_acquireThread(int& ref);
+    void					_releaseThread(lua_State* thread,int ref);
+
+    static int				_writeChunk(lua_State* l,const void* data,size_t size,void* byteCode);
+
+    // around every lua_resume / lua_pcall of a script
+    void					_beginRun(Script* script,bool yieldable);
+    void					_endRun();
+
+    static void				_hook(lua_State* l,lua_Debug* ar);
+    bool					_budgetExceeded(lua_State* l,lua_Debug* ar,ScriptRun& run,bool& kill);
+    static bool				_canYield(lua_State* l);
+    void					_profileCall(lua_State* l,lua_Debug* ar);
+    ScriptProfile&			_getProfile(Script* script);
+
     static ScriptEngine*	mSingleton;
     static bool				mInsFlag;
 
@@ -87,8 +236,36 @@ private:
     uint64					mLastProcessTime;
     boost::mutex			mScriptMutex;
 
-    ScriptList				mScripts;
     boost::pool<boost::default_user_allocator_malloc_free>	mScriptPool;
+
+    // live scripts by slot, the slot is their entry in the wakeup wheel
+    ScriptSlots				mSlots;
+    std::vector<uint32>		mFreeSlots;
+
+    // sleeping in WaitTime / WaitMSec, only the due ones are touched per frame
+    Anh_Utils::TimingWheel	mWheel;
+    std::vector<uint32>		mExpired;
+
+    // counting down in WaitFrame
+    ScriptSlots				mFrameWaiters;
+    ScriptSlots				mFrameRunning;
+
+    ScriptChunkMap			mChunks;
+    ScriptThreadList		mFreeThreads;
+
+    uint64					mInstructionBudget;
+    uint64					mTimeBudget;
+    uint64					mKillTime;
+
+    std::vector<ScriptRun>	mRuns;
+    std::vector<ScriptCall>	mCalls;
+    uint32					mRunCounter;
+    uint32					mSampleCounter;
+
+    ScriptProfileMap		mProfiles;
+    ScriptSampleMap			mSamples;
+    uint64					mSampleCount;
+    ScriptGlueProfileMap	mGlueProfiles;
 };
 
 //======================================================================================================================
@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include    "ScriptEngine.h"
 #include    <stdio.h>
 #include    <string.h>
+#include    <sstream>
 
 extern "C"
 {
@@ -49,6 +50,8 @@ static int		luaWaitTime			(lua_State* l);
 static int		luaWaitMSec			(lua_State* l);
 static int		luagetScriptObject  (lua_State* l);
 static int		luaSplitString		(lua_State* l);
+static int		luaGetProfile		(lua_State* l);
+static int		luaResetProfile		(lua_State* l);
 
 //======================================================================================================================
 
@@ -59,6 +62,8 @@ static const luaL_reg scriptLib[] =
     {"WaitMSec",		luaWaitMSec},
     {"getScriptObj",	luagetScriptObject},
     {"splitString",		luaSplitString},
+    {"getProfile",		luaGetProfile},
+    {"resetProfile",	luaResetProfile},
     {NULL, NULL}
 };
 
@@ -75,8 +80,7 @@ static int luaWaitFrame(lua_State* l)
 {
     Script* script = getScriptObject(l);
 
-    script->mWaitFrame = (int32)luaL_checknumber(l,1);
-    script->mState     = SS_Wait_Frame;
+    script->waitFrames((int32)luaL_checknumber(l,1));
 
     return(lua_yield(l,1));
 }
@@ -87,8 +91,7 @@ static int luaWaitTime(lua_State* l)
 {
     Script* script = getScriptObject(l);
 
-    script->mWaitTimeStamp = (uint32)luaL_checknumber(l,1);
-    script->mState         = SS_Wait_Time;
+    script->waitTime((uint32)luaL_checknumber(l,1));
 
     return(lua_yield(l,1));
 }
@@ -99,8 +102,7 @@ static int luaWaitMSec(lua_State* l)
 {
     Script* script = getScriptObject(l);
 
-    script->mWaitTimeStamp = script->mTime + (uint32)luaL_checknumber(l,1);
-    script->mState         = SS_Wait_Time;
+    script->waitTime(script->getTime() + (uint32)luaL_checknumber(l,1));
 
     return(lua_yield(l,1));
 }
@@ -152,3 +154,29 @@ static int luaSplitString(lua_State* l)
 
 //======================================================================================================================
 
+//======================================================================================================================
+//
+// the script cost report as a string, so it can be looked at from a console script
+//
+
+static int luaGetProfile(lua_State* l)
+{
+    std::ostringstream report;
+    getScriptObject(l)->mEngine->printProfile(report);
+
+    lua_pushstring(l,report.str().c_str());
+
+    return(1);
+}
+
+//======================================================================================================================
+
+static int luaResetProfile(lua_State* l)
+{
+    getScriptObject(l)->mEngine->resetProfile();
+
+    return(0);
+}
+
+//======================================================================================================================
+
@@ -0,0 +1,367 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "DeadlineHeap.h"
+
+
+namespace Anh_Utils
+{
+//======================================================================================================================
+
+const uint64 DeadlineHeap::kNever;
+const uint32 DeadlineHeap::kNoSlot;
+
+DeadlineHeap::DeadlineHeap() : mSerial(0),mCount(0)
+{
+}
+
+//======================================================================================================================
+
+DeadlineHeap::~DeadlineHeap()
+{
+}
+
+//======================================================================================================================
+
+uint64 DeadlineHeap::insert(uint64 due,uint64 owner,void* data)
+{
+    uint32 slot;
+
+    if(!mFreeSlots.empty())
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(mNodes.size());
+        mNodes.push_back(Node());
+    }
+
+    Node& node		= mNodes[slot];
+    node.mHandle	= (static_cast<uint64>(++mSerial) << 32) | (slot + 1);
+    node.mDue		= due;
+    node.mOwner		= owner;
+    node.mData		= data;
+
+    _ownerLink(slot);
+    _heapPush(slot);
+    ++mCount;
+
+    return(node.mHandle);
+}
+
+//======================================================================================================================
+
+bool DeadlineHeap::remove(uint64 handle)
+{
+    uint32 slot = _slotOf(handle);
+
+    if(slot == kNoSlot)
+        return(false);
+
+    _release(slot);
+
+    return(true);
+}
+
+//======================================================================================================================
+
+uint32 DeadlineHeap::removeOwner(uint64 owner)
+{
+    OwnerMap::iterator it = mOwners.find(owner);
+
+    if(it == mOwners.end())
+        return(0);
+
+    uint32 slot		= it->second;
+    uint32 removed	= 0;
+
+    // _release unlinks from the front, so the map entry goes away with the last one
+    while(slot != kNoSlot)
+    {
+        uint32 next = mNodes[slot].mOwnerNext;
+
+        _release(slot);
+        ++removed;
+
+        slot = next;
+    }
+
+    return(removed);
+}
+
+//======================================================================================================================
+
+bool DeadlineHeap::reschedule(uint64 handle,uint64 due)
+{
+    uint32 slot = _slotOf(handle);
+
+    if(slot == kNoSlot)
+        return(false);
+
+    Node& node = mNodes[slot];
+
+    if(node.mHeapIndex == kNoSlot)
+    {
+        node.mDue = due;
+        _heapPush(slot);
+    }
+    else
+    {
+        uint64 old	= node.mDue;
+        node.mDue	= due;
+
+        if(due < old)
+            _siftUp(node.mHeapIndex);
+        else
+            _siftDown(node.mHeapIndex);
+    }
+
+    return(true);
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::popExpired(uint64 now,std::vector<uint64>& expired)
+{
+    while(!mHeap.empty() && mNodes[mHeap[0]].mDue <= now)
+    {
+        uint32 slot = mHeap[0];
+
+        expired.push_back(mNodes[slot].mHandle);
+        _heapErase(slot);
+    }
+}
+
+//======================================================================================================================
+
+bool DeadlineHeap::isQueued(uint64 handle) const
+{
+    uint32 slot = _slotOf(handle);
+
+    return(slot != kNoSlot && mNodes[slot].mHeapIndex != kNoSlot);
+}
+
+//======================================================================================================================
+
+uint64 DeadlineHeap::getDue(uint64 handle) const
+{
+    uint32 slot = _slotOf(handle);
+
+    return(slot == kNoSlot ? kNever : mNodes[slot].mDue);
+}
+
+//======================================================================================================================
+
+uint64 DeadlineHeap::getOwner(uint64 handle) const
+{
+    uint32 slot = _slotOf(handle);
+
+    return(slot == kNoSlot ? 0 : mNodes[slot].mOwner);
+}
+
+//======================================================================================================================
+
+void* DeadlineHeap::getData(uint64 handle) const
+{
+    uint32 slot = _slotOf(handle);
+
+    return(slot == kNoSlot ? NULL : mNodes[slot].mData);
+}
+
+//======================================================================================================================
+
+uint32 DeadlineHeap::_slotOf(uint64 handle) const
+{
+    uint32 slot = static_cast<uint32>(handle & 0xffffffff);
+
+    if(slot == 0 || slot > mNodes.size() || mNodes[slot - 1].mHandle != handle)
+        return(kNoSlot);
+
+    return(slot - 1);
+}
+
+//======================================================================================================================
+//
+// equal deadlines fire in insertion order, handles grow with every insert
+//
+
+bool DeadlineHeap::_less(uint32 a,uint32 b) const
+{
+    const Node& left	= mNodes[a];
+    const Node& right	= mNodes[b];
+
+    if(left.mDue != right.mDue)
+        return(left.mDue < right.mDue);
+
+    return((left.mHandle >> 32) < (right.mHandle >> 32));
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_place(uint32 position,uint32 slot)
+{
+    mHeap[position]			= slot;
+    mNodes[slot].mHeapIndex	= position;
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_siftUp(uint32 position)
+{
+    uint32 slot = mHeap[position];
+
+    while(position > 0)
+    {
+        uint32 parent = (position - 1) >> 1;
+
+        if(!_less(slot,mHeap[parent]))
+            break;
+
+        _place(position,mHeap[parent]);
+        position = parent;
+    }
+
+    _place(position,slot);
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_siftDown(uint32 position)
+{
+    uint32 count	= static_cast<uint32>(mHeap.size());
+    uint32 slot		= mHeap[position];
+
+    while(true)
+    {
+        uint32 child = (position << 1) + 1;
+
+        if(child >= count)
+            break;
+
+        if(child + 1 < count && _less(mHeap[child + 1],mHeap[child]))
+            ++child;
+
+        if(!_less(mHeap[child],slot))
+            break;
+
+        _place(position,mHeap[child]);
+        position = child;
+    }
+
+    _place(position,slot);
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_heapPush(uint32 slot)
+{
+    mHeap.push_back(slot);
+    _siftUp(static_cast<uint32>(mHeap.size() - 1));
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_heapErase(uint32 slot)
+{
+    uint32 position	= mNodes[slot].mHeapIndex;
+    uint32 last		= mHeap.back();
+
+    mHeap.pop_back();
+    mNodes[slot].mHeapIndex = kNoSlot;
+
+    if(last == slot)
+        return;
+
+    // fill the hole with the last leaf and let it settle in whichever direction it belongs
+    _place(position,last);
+
+    if(position > 0 && _less(last,mHeap[(position - 1) >> 1]))
+        _siftUp(position);
+    else
+        _siftDown(position);
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_ownerLink(uint32 slot)
+{
+    Node& node = mNodes[slot];
+
+    std::pair<OwnerMap::iterator,bool> result = mOwners.insert(std::make_pair(node.mOwner,slot));
+
+    node.mOwnerPrev = kNoSlot;
+
+    if(result.second)
+    {
+        node.mOwnerNext = kNoSlot;
+        return;
+    }
+
+    node.mOwnerNext = result.first->second;
+    mNodes[node.mOwnerNext].mOwnerPrev = slot;
+    result.first->second = slot;
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_ownerUnlink(uint32 slot)
+{
+    Node& node = mNodes[slot];
+
+    if(node.mOwnerNext != kNoSlot)
+        mNodes[node.mOwnerNext].mOwnerPrev = node.mOwnerPrev;
+
+    if(node.mOwnerPrev != kNoSlot)
+        mNodes[node.mOwnerPrev].mOwnerNext = node.mOwnerNext;
+    else if(node.mOwnerNext != kNoSlot)
+        mOwners[node.mOwner] = node.mOwnerNext;
+    else
+        mOwners.erase(node.mOwner);
+
+    node.mOwnerPrev = kNoSlot;
+    node.mOwnerNext = kNoSlot;
+}
+
+//======================================================================================================================
+
+void DeadlineHeap::_release(uint32 slot)
+{
+    if(mNodes[slot].mHeapIndex != kNoSlot)
+        _heapErase(slot);
+
+    _ownerUnlink(slot);
+
+    Node& node		= mNodes[slot];
+    node.mHandle	= 0;
+    node.mData		= NULL;
+
+    mFreeSlots.push_back(slot);
+    --mCount;
+}
+}
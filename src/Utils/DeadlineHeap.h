@@ -0,0 +1,134 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_UTILS_DEADLINEHEAP_H
+#define ANH_UTILS_DEADLINEHEAP_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "typedefs.h"
+
+
+namespace Anh_Utils
+{
+//======================================================================================================================
+//
+// Binary min-heap of deadlines with intrusive handles.
+// Every entry lives in a slot that remembers its position in the heap, so cancelling or moving one is O(log n)
+// without searching. Entries are also linked per owner, which lets all of a creatures effects be dropped at once.
+//
+// Handles are (serial << 32) | (slot + 1) and are never reused. popExpired takes entries out of the heap but keeps
+// their handles alive, the caller either reschedules them or removes them once it has run them. That way an entry
+// cancelled while its batch is being processed can be recognised and skipped.
+//
+
+class DeadlineHeap
+{
+public:
+
+    static const uint64 kNever = 0xffffffffffffffffULL;
+
+    DeadlineHeap();
+    ~DeadlineHeap();
+
+    uint64	insert(uint64 due,uint64 owner,void* data);
+    bool	remove(uint64 handle);
+
+    // removes every entry of owner, queued or popped, and returns how many were dropped
+    uint32	removeOwner(uint64 owner);
+
+    // moves a queued or popped entry to a new deadline, the handle stays the same
+    bool	reschedule(uint64 handle,uint64 due);
+
+    // appends the handles of all entries due at or before now, earliest first
+    void	popExpired(uint64 now,std::vector<uint64>& expired);
+
+    bool	contains(uint64 handle) const {
+        return(_slotOf(handle) != kNoSlot);
+    }
+    bool	isQueued(uint64 handle) const;
+
+    uint64	getDue(uint64 handle) const;
+    uint64	getOwner(uint64 handle) const;
+    void*	getData(uint64 handle) const;
+
+    uint64	getNextDue() const {
+        return(mHeap.empty() ? kNever : mNodes[mHeap[0]].mDue);
+    }
+
+    // live handles, including popped ones that were not released yet
+    uint32	size() const {
+        return mCount;
+    }
+    uint32	getQueuedCount() const {
+        return(static_cast<uint32>(mHeap.size()));
+    }
+
+private:
+
+    static const uint32 kNoSlot = 0xffffffff;
+
+    class Node
+    {
+    public:
+
+        Node() : mHandle(0),mDue(0),mOwner(0),mData(NULL),mHeapIndex(kNoSlot),mOwnerPrev(kNoSlot),mOwnerNext(kNoSlot) {}
+
+        uint64	mHandle;
+        uint64	mDue;
+        uint64	mOwner;
+        void*	mData;
+        uint32	mHeapIndex;
+        uint32	mOwnerPrev;
+        uint32	mOwnerNext;
+    };
+
+    typedef std::unordered_map<uint64,uint32> OwnerMap;
+
+    uint32	_slotOf(uint64 handle) const;
+    bool	_less(uint32 a,uint32 b) const;
+    void	_place(uint32 position,uint32 slot);
+    void	_siftUp(uint32 position);
+    void	_siftDown(uint32 position);
+    void	_heapPush(uint32 slot);
+    void	_heapErase(uint32 slot);
+    void	_ownerLink(uint32 slot);
+    void	_ownerUnlink(uint32 slot);
+    void	_release(uint32 slot);
+
+    std::vector<Node>	mNodes;
+    std::vector<uint32>	mHeap;
+    std::vector<uint32>	mFreeSlots;
+    OwnerMap			mOwners;
+    uint32				mSerial;
+    uint32				mCount;
+};
+}
+
+#endif
@@ -0,0 +1,169 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "EventLoop.h"
+
+#include <cassert>
+#include <climits>
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#else
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+using namespace Anh_Utils;
+
+//==============================================================================================================================
+
+EventLoop* EventLoop::mSingleton = NULL;
+
+//==============================================================================================================================
+
+EventLoop* EventLoop::Init()
+{
+    if(!mSingleton)
+    {
+        mSingleton = new EventLoop();
+    }
+
+    return mSingleton;
+}
+
+//==============================================================================================================================
+
+void EventLoop::destroySingleton()
+{
+    delete mSingleton;
+    mSingleton = NULL;
+}
+
+//==============================================================================================================================
+
+EventLoop::EventLoop()
+    : mWakeups(0)
+    , mTimeouts(0)
+{
+    mPending = 0;
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+    mSignaled = false;
+#else
+    mEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    assert(mEventFd != -1 && mEpollFd != -1 && "EventLoop::EventLoop unable to create eventfd/epoll");
+
+    epoll_event event;
+    event.events	= EPOLLIN;
+    event.data.fd	= mEventFd;
+    epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mEventFd, &event);
+#endif
+}
+
+//==============================================================================================================================
+
+EventLoop::~EventLoop()
+{
+#if(ANH_PLATFORM != ANH_PLATFORM_WIN32)
+    close(mEpollFd);
+    close(mEventFd);
+#endif
+}
+
+//==============================================================================================================================
+
+void EventLoop::wakeup()
+{
+    // someone already rang since the loop last woke up
+    if(mPending.compare_and_swap(1, 0) != 0)
+    {
+        return;
+    }
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+    boost::mutex::scoped_lock lock(mMutex);
+    mSignaled = true;
+    mCondition.notify_one();
+#else
+    uint64 one = 1;
+    ssize_t written;
+    do
+    {
+        written = write(mEventFd, &one, sizeof(one));
+    }
+    while(written == -1 && errno == EINTR);
+#endif
+}
+
+//==============================================================================================================================
+
+bool EventLoop::wait(uint64 timeout)
+{
+    bool woken;
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if(!mSignaled && timeout)
+        {
+            mCondition.timed_wait(lock, boost::posix_time::milliseconds(timeout));
+        }
+        woken = mSignaled;
+        mSignaled = false;
+        mPending = 0;
+    }
+#else
+    epoll_event event;
+    int timeoutMs = (timeout > INT_MAX) ? INT_MAX : static_cast<int>(timeout);
+    int count = epoll_wait(mEpollFd, &event, 1, timeoutMs);
+
+    woken = (count > 0);
+
+    if(woken)
+    {
+        uint64 value;
+        ssize_t result = read(mEventFd, &value, sizeof(value));
+        (void)result;
+    }
+
+    // re-arm only after draining, a producer that got skipped in between has queued its work before calling wakeup()
+    // and the caller processes that right after we return
+    mPending = 0;
+#endif
+
+    if(woken)
+        ++mWakeups;
+    else
+        ++mTimeouts;
+
+    return woken;
+}
+
+//==============================================================================================================================
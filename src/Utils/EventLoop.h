@@ -0,0 +1,102 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_UTILS_EVENTLOOP_H
+#define ANH_UTILS_EVENTLOOP_H
+
+#include "typedefs.h"
+
+#include <tbb/atomic.h>
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#endif
+
+//==============================================================================================================================
+
+#define	 gEventLoop	Anh_Utils::EventLoop::getSingleton()
+
+namespace Anh_Utils
+{
+//==============================================================================================================================
+//
+// Lets the main loop of a server sleep until there is something to do.
+// Producers on other threads (network reads, finished database jobs, timers) call wakeup(), the main thread blocks in
+// wait() for at most the time until its next scheduler deadline. Backed by an eventfd polled through epoll, wakeups
+// are coalesced so a burst of packets costs a single write.
+//
+
+class EventLoop
+{
+public:
+    static EventLoop* getSingleton() {
+        return mSingleton;
+    }
+    static EventLoop* Init();
+    static void	destroySingleton(void);
+
+    // safe to call from any thread
+    void	wakeup();
+
+    // blocks for at most timeout ms, returns true if woken up before that
+    bool	wait(uint64 timeout);
+
+    uint64	getWakeupCount() const {
+        return mWakeups;
+    }
+    uint64	getTimeoutCount() const {
+        return mTimeouts;
+    }
+
+protected:
+    EventLoop();
+    ~EventLoop();
+
+private:
+
+    tbb::atomic<uint32>	mPending;
+    uint64				mWakeups;
+    uint64				mTimeouts;
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+    boost::mutex				mMutex;
+    boost::condition_variable	mCondition;
+    bool						mSignaled;
+#else
+    int					mEventFd;
+    int					mEpollFd;
+#endif
+
+    static EventLoop*	mSingleton;
+};
+}
+
+//==============================================================================================================================
+
+#endif
+
@@ -27,6 +27,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/MathFunctions.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATHFUNCTIONS_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 bool IsPointInRectangle(const glm::vec2& check_point, const glm::vec2& rectangle_center, float width, float height) {
     // Get nobuild lower right and upper left corners.
     glm::vec2 lower_left(rectangle_center.x - (0.5*width), rectangle_center.y - (0.5*height));
@@ -42,3 +47,29 @@ bool IsPointInRectangle(const glm::vec2& check_point, const glm::vec2& rectangle
 
     return false;
 }
+
+void BilinearInterpolateBatch(const float* h00, const float* h01, const float* h10, const float* h11,
+                              const float* tx, const float* tz, float* results, size_t count) {
+    size_t i = 0;
+
+#ifdef MATHFUNCTIONS_USE_SSE
+    // Same operation order as the scalar version so both paths agree exactly.
+    for (; i + 4 <= count; i += 4) {
+        __m128 v00 = _mm_loadu_ps(h00 + i);
+        __m128 v01 = _mm_loadu_ps(h01 + i);
+        __m128 v10 = _mm_loadu_ps(h10 + i);
+        __m128 v11 = _mm_loadu_ps(h11 + i);
+        __m128 vtx = _mm_loadu_ps(tx + i);
+        __m128 vtz = _mm_loadu_ps(tz + i);
+
+        __m128 near_edge = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(v01, v00), vtx));
+        __m128 far_edge = _mm_add_ps(v10, _mm_mul_ps(_mm_sub_ps(v11, v10), vtx));
+
+        _mm_storeu_ps(results + i, _mm_add_ps(near_edge, _mm_mul_ps(_mm_sub_ps(far_edge, near_edge), vtz)));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        results[i] = BilinearInterpolate(h00[i], h01[i], h10[i], h11[i], tx[i], tz[i]);
+    }
+}
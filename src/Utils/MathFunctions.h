@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef SRC_UTILS_MATHFUNCTIONS_H_
 #define SRC_UTILS_MATHFUNCTIONS_H_
 
+#include <cstddef>
 #include <glm/glm.hpp>
 
 /**
@@ -41,4 +42,38 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 bool IsPointInRectangle(const glm::vec2& check_point, const glm::vec2& rectangle_center, float width, float height);
 
+/**
+ * Bilinear interpolation between the four corners of a grid cell.
+ *
+ * \param h00 Value at the cell origin.
+ * \param h01 Value one step along x.
+ * \param h10 Value one step along z.
+ * \param h11 Value one step along x and z.
+ * \param tx Fraction along x, in [0, 1].
+ * \param tz Fraction along z, in [0, 1].
+ * \returns The interpolated value.
+ */
+inline float BilinearInterpolate(float h00, float h01, float h10, float h11, float tx, float tz) {
+    float near_edge = h00 + (h01 - h00) * tx;
+    float far_edge = h10 + (h11 - h10) * tx;
+
+    return near_edge + (far_edge - near_edge) * tz;
+}
+
+/**
+ * Batched version of BilinearInterpolate over structure of arrays input, 4 lanes at a time
+ * where SSE is available. Produces the same results as the scalar version.
+ *
+ * \param h00 Values at the cell origins.
+ * \param h01 Values one step along x.
+ * \param h10 Values one step along z.
+ * \param h11 Values one step along x and z.
+ * \param tx Fractions along x.
+ * \param tz Fractions along z.
+ * \param results Receives count interpolated values, may alias none of the inputs.
+ * \param count The number of values to interpolate.
+ */
+void BilinearInterpolateBatch(const float* h00, const float* h01, const float* h10, const float* h11,
+                              const float* tx, const float* tz, float* results, size_t count);
+
 #endif  // SRC_UTILS_MATHFUNCTIONS_H_
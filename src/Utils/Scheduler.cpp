@@ -25,7 +25,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ---------------------------------------------------------------------------------------
 */
 
-
 #include "Scheduler.h"
 
 
@@ -33,7 +32,9 @@ namespace Anh_Utils
 {
 //======================================================================================================================
 
-Scheduler::Scheduler(uint64 processTimeLimit, uint64 throttleLimit) : mNextTask(0),mNextTaskId(1),mProcessTimeLimit(processTimeLimit),mThrottleLimit(throttleLimit)
+const uint32 Scheduler::kNoSlot;
+
+Scheduler::Scheduler(uint64 processTimeLimit, uint64 throttleLimit) : mNextTaskId(1),mProcessTimeLimit(processTimeLimit),mThrottleLimit(throttleLimit),mProfileSection(0)
 {
     mLastProcessTime = 0;
     // We do have a global clock object, don't use seperate clock and times for every process.
@@ -51,61 +52,60 @@ Scheduler::~Scheduler()
 
 uint64 Scheduler::addTask(FDCallback callback,uint8 priority,uint64 interval,void* async)
 {
-    mTasks.push(Task(mNextTaskId,priority,gClock->getLocalTime(),interval,callback,async));
-    return(mNextTaskId++);
-}
+    uint32 slot;
 
-//======================================================================================================================
+    if(!mFreeSlots.empty())
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(mTasks.size());
+        mTasks.push_back(Task(0,0,0,0,FDCallback(),NULL));
+    }
 
-void Scheduler::removeTask(uint64 id)
-{
-    if(!id)
-        return;
+    // upper half is a running serial, so ids of recycled slots never repeat
+    uint64 id			= (mNextTaskId++ << 32) | (slot + 1);
+    uint64 currentTime	= Anh_Utils::Clock::getSingleton()->getLocalTime();
 
-    TaskContainer::iterator it = mTasks.begin();
+    if(!mWheel.isStarted())
+        mWheel.start(currentTime);
 
-    while(it != mTasks.end())
-    {
-        if(it->mId == id)
-        {
-            mTasks.erase(it);
-            break;
-        }
+    mTasks[slot] = Task(id,priority,currentTime,interval,callback,async);
 
-        ++it;
-    }
+    if(mProfileSection && gTickProfiler)
+        mTasks[slot].mProfileSection = gTickProfiler->registerTask(mProfileSection,callback.GetMemento());
 
-    mTasks.assureHeap(true);
+    // a task is due once more than interval ms have passed since its last call
+    mWheel.insert(slot,currentTime + interval + 1);
+
+    return(id);
 }
 
-bool Scheduler::checkTask(uint64 id)
-{
-    if(!id)
-        return false;
+//======================================================================================================================
 
-    TaskContainer::iterator it = mTasks.begin();
+void Scheduler::removeTask(uint64 id)
+{
+    uint32 slot = _findSlot(id);
 
-    while(it != mTasks.end())
-    {
-        if(it->mId == id)
-        {
-            return true;
-        }
+    if(slot == kNoSlot)
+        return;
 
-        ++it;
-    }
+    // a queued entry in mReady is skipped once its id no longer matches
+    mWheel.remove(slot);
+    _releaseSlot(slot);
+}
 
-    //mTasks.assureHeap(true);
-    return false;
+bool Scheduler::checkTask(uint64 id)
+{
+    return(_findSlot(id) != kNoSlot);
 }
 
 //======================================================================================================================
 
 void Scheduler::process()
 {
-    // uint64	frameStartTime = mClock->UpdateAndGetTime();
-
-    // while(runTask() && ((mClock->UpdateAndGetTime() - frameStartTime) < mProcessTimeLimit));
     uint64	frameStartTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
 
     //Check for throttle
@@ -114,6 +114,20 @@ void Scheduler::process()
         return;
     }
 
+    ProfileScope processScope(mProfileSection);
+
+    mWheel.advance(frameStartTime,mExpired);
+
+    std::vector<uint32>::iterator it = mExpired.begin();
+
+    while(it != mExpired.end())
+    {
+        mReady.push(mTasks[*it].mPriority,mTasks[*it].mId);
+        ++it;
+    }
+
+    mExpired.clear();
+
     while(runTask() && ((Anh_Utils::Clock::getSingleton()->getLocalTime() - frameStartTime) < mProcessTimeLimit));
 
     //Set internal Clock so we know when the last call was
@@ -124,41 +138,89 @@ void Scheduler::process()
 
 bool Scheduler::runTask()
 {
-    if(!(mTasks.empty()))
+    uint64 id;
+
+    while(mReady.pop(id))
     {
-        Task&	task(mTasks[mNextTask]);
-        uint64	currentTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-        if((currentTime - task.mLastCallTime) > task.mInterval)
+        uint32 slot = _findSlot(id);
+
+        if(slot == kNoSlot)
+            continue;
+
         {
-            if(task.mCallback(currentTime,task.mAsync) == false)
+            // copy out, the callback may add tasks and grow the pool
+            FDCallback	callback	= mTasks[slot].mCallback;
+            void*			async		= mTasks[slot].mAsync;
+            uint64			currentTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+            bool			keep;
+
             {
-                removeTask(task.mId);
+                ProfileScope taskScope(mTasks[slot].mProfileSection);
+                keep = callback(currentTime,async);
+            }
+
+            // the task may have been removed from within its callback
+            if(mTasks[slot].mId != id)
+                continue;
+
+            if(keep == false)
+            {
+                _releaseSlot(slot);
             }
             else
             {
+                Task& task(mTasks[slot]);
                 task.mLastCallTime = currentTime;
-                ++mNextTask;
+                mWheel.insert(slot,currentTime + task.mInterval + 1);
             }
         }
-        else
-            ++mNextTask;
 
-        if(mNextTask >= mTasks.size())
-        {
-            reset();
-            return(false);
-        }
-        else
-            return(true);
-    }
-    else
-    {
-        reset();
-        return(false);
+        return(!mReady.empty());
     }
+
+    return(false);
 }
+
+//======================================================================================================================
+
+uint64 Scheduler::getNextDeadline() const
+{
+    uint64 deadline = mReady.empty() ? mWheel.getNextDue() : 0;
+
+    if(deadline == TimingWheel::kNever)
+        return(deadline);
+
+    // process() is throttled anyway
+    return(std::max(deadline,mLastProcessTime + mThrottleLimit));
+}
+
+//======================================================================================================================
+
+uint32 Scheduler::_findSlot(uint64 id) const
+{
+    uint32 slot = static_cast<uint32>(id & 0xffffffff);
+
+    if(slot == 0 || slot > mTasks.size())
+        return(kNoSlot);
+
+    --slot;
+
+    if(mTasks[slot].mId != id)
+        return(kNoSlot);
+
+    return(slot);
 }
 
 //======================================================================================================================
 
+void Scheduler::_releaseSlot(uint32 slot)
+{
+    mTasks[slot].mId		= 0;
+    mTasks[slot].mCallback	= FDCallback();
+    mTasks[slot].mAsync		= NULL;
 
+    mFreeSlots.push_back(slot);
+}
+}
+
+//======================================================================================================================
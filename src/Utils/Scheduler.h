@@ -29,9 +29,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_UTILS_SCHEDULER_H
 
 #include <algorithm>
+#include <vector>
+
 #include "typedefs.h"
 #include "FastDelegate.h"
-#include "PriorityVector.h"
+#include "TickProfiler.h"
+#include "TimingWheel.h"
 #include "clock.h"
 
 typedef fastdelegate::FastDelegate2<uint64,void*,bool> FDCallback;
@@ -46,7 +49,7 @@ class Task
 public:
 
     Task(uint64 id,uint8 priority,uint64 lastCallTime,uint64 interval,FDCallback callback,void* async)
-        : mId(id),mPriority(priority),mLastCallTime(lastCallTime),mInterval(interval),mCallback(callback),mAsync(async) {}
+        : mId(id),mPriority(priority),mLastCallTime(lastCallTime),mInterval(interval),mCallback(callback),mAsync(async),mProfileSection(0) {}
 
     ~Task() {}
 
@@ -61,13 +64,20 @@ public:
     uint64		mInterval;
     FDCallback	mCallback;
     void*		mAsync;
+    uint32		mProfileSection;
 };
 
 //======================================================================================================================
 
-typedef priority_vector<Task> TaskContainer;
+typedef std::vector<Task> TaskContainer;
 
 //======================================================================================================================
+//
+// Tasks sit in a timing wheel keyed by their deadline, so a process() call only touches the tasks that are due.
+// Task ids encode the pool slot in the lower 32 bits, which makes removeTask and checkTask O(1).
+// Due tasks are run highest priority first and in deadline order within a priority, whatever does not fit into
+// the process time limit stays queued for the next call.
+//
 
 class Scheduler
 {
@@ -79,20 +89,38 @@ public:
     uint64	addTask(FDCallback callback,uint8 priority,uint64 interval,void* async);
     void	removeTask(uint64 id);
     bool	checkTask(uint64 id);
-    void	reset() {
-        mNextTask = 0;
-    }
     void	process();
     bool	runTask();
 
+    // earliest time a process() call can have work, TimingWheel::kNever without tasks
+    uint64	getNextDeadline() const;
+
+    // time process() and every task callback under this TickProfiler section
+    void	setProfileSection(uint32 section) {
+        mProfileSection = section;
+    }
+
+    uint32	getTaskCount() const {
+        return(static_cast<uint32>(mTasks.size() - mFreeSlots.size()));
+    }
+
 protected:
 
+    static const uint32 kNoSlot = 0xffffffff;
+
+    uint32	_findSlot(uint64 id) const;
+    void	_releaseSlot(uint32 slot);
+
     TaskContainer		mTasks;
+    std::vector<uint32>	mFreeSlots;
+    TimingWheel			mWheel;
+    PriorityLanes		mReady;
+    std::vector<uint32>	mExpired;
 
-    uint32				mNextTask;
     uint64				mNextTaskId;
     // Anh_Utils::Clock*	mClock;
     uint64				mProcessTimeLimit, mThrottleLimit, mLastProcessTime;
+    uint32				mProfileSection;
 };
 }
 
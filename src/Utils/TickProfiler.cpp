@@ -0,0 +1,425 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "TickProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace Anh_Utils;
+
+//==============================================================================================================================
+
+static inline uint32 highestSetBit(uint64 word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index,word);
+    return(static_cast<uint32>(index));
+#else
+    return(static_cast<uint32>(63 - __builtin_clzll(word)));
+#endif
+}
+
+//==============================================================================================================================
+//
+// DelegateMemento keeps the bound method protected, this gets at it so tasks can be grouped by method
+//
+
+class TaskMethodKey : public fastdelegate::DelegateMemento
+{
+public:
+
+    explicit TaskMethodKey(const fastdelegate::DelegateMemento& memento) : fastdelegate::DelegateMemento(memento) {}
+
+    std::string getKey() const
+    {
+        std::string key(reinterpret_cast<const char*>(&m_pFunction),sizeof(m_pFunction));
+#if !defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+        key.append(reinterpret_cast<const char*>(&m_pStaticFunction),sizeof(m_pStaticFunction));
+#endif
+        return(key);
+    }
+
+    // code address for member functions, vtable offset for virtual ones on gcc
+    const void* getAddress() const
+    {
+        const void* address = NULL;
+#if !defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+        if(m_pStaticFunction)
+        {
+            memcpy(&address,&m_pStaticFunction,sizeof(address));
+            return(address);
+        }
+#endif
+        memcpy(&address,&m_pFunction,sizeof(address));
+        return(address);
+    }
+};
+
+//==============================================================================================================================
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+//==============================================================================================================================
+
+void LatencyHistogram::reset()
+{
+    memset(mCounts,0,sizeof(mCounts));
+    mCount	= 0;
+    mTotal	= 0;
+    mMin	= 0xffffffffffffffffULL;
+    mMax	= 0;
+}
+
+//==============================================================================================================================
+
+void LatencyHistogram::record(uint64 value)
+{
+    ++mCounts[_indexOf(value)];
+    ++mCount;
+    mTotal += value;
+
+    if(value < mMin)
+        mMin = value;
+    if(value > mMax)
+        mMax = value;
+}
+
+//==============================================================================================================================
+
+uint64 LatencyHistogram::getPercentile(double percent) const
+{
+    if(!mCount)
+        return(0);
+
+    uint64 target = static_cast<uint64>(ceil(percent / 100.0 * static_cast<double>(mCount)));
+
+    if(target < 1)
+        target = 1;
+
+    uint64 seen = 0;
+
+    for(uint32 i = 0; i < kBuckets; i++)
+    {
+        seen += mCounts[i];
+
+        // the last bucket also holds everything that got clamped
+        if(seen >= target)
+        {
+            uint64 value = _highestValueAt(i);
+            return((value < mMax && i + 1 < kBuckets) ? value : mMax);
+        }
+    }
+
+    return(mMax);
+}
+
+//==============================================================================================================================
+
+uint32 LatencyHistogram::_indexOf(uint64 value)
+{
+    if(value < kSubBuckets)
+        return(static_cast<uint32>(value));
+
+    if(value >= (1ULL << kValueBits))
+        value = (1ULL << kValueBits) - 1;
+
+    uint32 shift = highestSetBit(value) - kSubBucketBits;
+
+    return(kSubBuckets + shift * kSubBuckets + static_cast<uint32>((value >> shift) - kSubBuckets));
+}
+
+//==============================================================================================================================
+
+uint64 LatencyHistogram::_highestValueAt(uint32 index)
+{
+    if(index < kSubBuckets)
+        return(index);
+
+    uint32 shift	= (index - kSubBuckets) / kSubBuckets;
+    uint64 sub		= (index - kSubBuckets) % kSubBuckets;
+
+    return(((kSubBuckets + sub) << shift) + (1ULL << shift) - 1);
+}
+
+//==============================================================================================================================
+
+TickProfiler* TickProfiler::mSingleton = NULL;
+
+//==============================================================================================================================
+
+TickProfiler* TickProfiler::Init(uint64 slowTickThreshold)
+{
+    if(!mSingleton)
+    {
+        mSingleton = new TickProfiler(slowTickThreshold);
+    }
+
+    return mSingleton;
+}
+
+//==============================================================================================================================
+
+void TickProfiler::destroySingleton()
+{
+    delete mSingleton;
+    mSingleton = NULL;
+}
+
+//==============================================================================================================================
+
+TickProfiler::TickProfiler(uint64 slowTickThreshold)
+    : mTickStart(0)
+    , mInTick(false)
+    , mSlowTickThreshold(slowTickThreshold)
+{
+    // id 0 is 'not profiled'
+    mNames.push_back("");
+    mHistograms.push_back(LatencyHistogram());
+    mTickTimes.push_back(0);
+    mTickHits.push_back(0);
+}
+
+//==============================================================================================================================
+
+TickProfiler::~TickProfiler()
+{
+}
+
+//==============================================================================================================================
+
+uint64 TickProfiler::getMicroseconds()
+{
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+
+    if(!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    return(static_cast<uint64>(counter.QuadPart / frequency.QuadPart * 1000000
+                               + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart));
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+
+    return(static_cast<uint64>(now.tv_sec) * 1000000 + now.tv_nsec / 1000);
+#endif
+}
+
+//==============================================================================================================================
+
+uint32 TickProfiler::registerSection(const std::string& name)
+{
+    SectionMap::iterator it = mSections.find(name);
+
+    if(it != mSections.end())
+        return((*it).second);
+
+    uint32 section = static_cast<uint32>(mNames.size());
+
+    mSections.insert(std::make_pair(name,section));
+    mNames.push_back(name);
+    mHistograms.push_back(LatencyHistogram());
+    mTickTimes.push_back(0);
+    mTickHits.push_back(0);
+
+    return(section);
+}
+
+//==============================================================================================================================
+
+uint32 TickProfiler::registerTask(uint32 scheduler, const fastdelegate::DelegateMemento& callback)
+{
+    TaskMethodKey method(callback);
+    std::pair<uint32,std::string> key(scheduler,method.getKey());
+
+    TaskMap::iterator it = mTasks.find(key);
+
+    if(it != mTasks.end())
+        return((*it).second);
+
+    // delegates carry no names, the address resolves with addr2line / the map file
+    std::ostringstream name;
+    name << mNames[scheduler] << "/" << method.getAddress();
+
+    uint32 section = registerSection(name.str());
+    mTasks.insert(std::make_pair(key,section));
+
+    return(section);
+}
+
+//==============================================================================================================================
+
+void TickProfiler::beginTick()
+{
+    mTickStart	= getMicroseconds();
+    mInTick		= true;
+}
+
+//==============================================================================================================================
+
+bool TickProfiler::endTick()
+{
+    uint64 duration = getMicroseconds() - mTickStart;
+    bool slow		= (duration >= mSlowTickThreshold);
+
+    mTickHistogram.record(duration);
+    mInTick = false;
+
+    if(slow)
+    {
+        SlowTick tick;
+        tick.mStart		= mTickStart;
+        tick.mDuration	= duration;
+
+        std::vector<uint32>::iterator it = mTickSections.begin();
+
+        while(it != mTickSections.end())
+        {
+            tick.mSections.push_back(std::make_pair(*it,mTickTimes[*it]));
+            ++it;
+        }
+
+        // biggest first, nested sections show up next to their parents
+        std::sort(tick.mSections.begin(),tick.mSections.end(),
+                  [] (const std::pair<uint32,uint64>& a, const std::pair<uint32,uint64>& b) {
+            return(a.second > b.second);
+        });
+
+        if(tick.mSections.size() > kSlowTickSections)
+            tick.mSections.resize(kSlowTickSections);
+
+        mSlowTicks.push_back(tick);
+
+        if(mSlowTicks.size() > kSlowTickHistory)
+            mSlowTicks.pop_front();
+    }
+
+    std::vector<uint32>::iterator it = mTickSections.begin();
+
+    while(it != mTickSections.end())
+    {
+        mTickTimes[*it]	= 0;
+        mTickHits[*it]	= 0;
+        ++it;
+    }
+
+    mTickSections.clear();
+
+    return(slow);
+}
+
+//==============================================================================================================================
+
+void TickProfiler::record(uint32 section, uint64 elapsed)
+{
+    mHistograms[section].record(elapsed);
+
+    if(!mInTick)
+        return;
+
+    if(mTickHits[section]++ == 0)
+        mTickSections.push_back(section);
+
+    mTickTimes[section] += elapsed;
+}
+
+//==============================================================================================================================
+
+void TickProfiler::printReport(std::ostream& out) const
+{
+    out << "tick: n=" << mTickHistogram.getCount()
+        << " mean=" << mTickHistogram.getMean()
+        << "us p50=" << mTickHistogram.getPercentile(50.0)
+        << "us p99=" << mTickHistogram.getPercentile(99.0)
+        << "us p99.9=" << mTickHistogram.getPercentile(99.9)
+        << "us max=" << mTickHistogram.getMax() << "us" << std::endl;
+
+    for(uint32 section = 1; section < mNames.size(); section++)
+    {
+        const LatencyHistogram& histogram = mHistograms[section];
+
+        if(!histogram.getCount())
+            continue;
+
+        out << mNames[section] << ": n=" << histogram.getCount()
+            << " mean=" << histogram.getMean()
+            << "us p50=" << histogram.getPercentile(50.0)
+            << "us p99=" << histogram.getPercentile(99.0)
+            << "us p99.9=" << histogram.getPercentile(99.9)
+            << "us max=" << histogram.getMax() << "us" << std::endl;
+    }
+}
+
+//==============================================================================================================================
+
+void TickProfiler::printSlowTick(std::ostream& out, const SlowTick& tick) const
+{
+    out << "slow tick " << tick.mDuration << "us:";
+
+    std::vector<std::pair<uint32,uint64> >::const_iterator it = tick.mSections.begin();
+
+    while(it != tick.mSections.end())
+    {
+        out << " " << mNames[(*it).first] << "=" << (*it).second << "us";
+        ++it;
+    }
+}
+
+//==============================================================================================================================
+
+void TickProfiler::resetHistograms()
+{
+    mTickHistogram.reset();
+
+    std::vector<LatencyHistogram>::iterator it = mHistograms.begin();
+
+    while(it != mHistograms.end())
+    {
+        (*it).reset();
+        ++it;
+    }
+}
+
+//==============================================================================================================================
+
@@ -0,0 +1,230 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_UTILS_TICKPROFILER_H
+#define ANH_UTILS_TICKPROFILER_H
+
+#include "typedefs.h"
+#include "FastDelegate.h"
+
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//==============================================================================================================================
+
+#define	 gTickProfiler	Anh_Utils::TickProfiler::getSingleton()
+
+namespace Anh_Utils
+{
+//==============================================================================================================================
+//
+// HDR style latency histogram in microseconds.
+// Values below 16us get an exact bucket, above that every power of two is split into 16 linear sub buckets,
+// so any recorded value is off by at most 1/16th. Fixed size, recording is a couple of shifts and an increment.
+//
+
+class LatencyHistogram
+{
+public:
+
+    LatencyHistogram();
+
+    void	record(uint64 value);
+    void	reset();
+
+    // smallest value that percent % of all recorded values are less than or equal to
+    uint64	getPercentile(double percent) const;
+
+    uint64	getCount() const {
+        return(mCount);
+    }
+    uint64	getMin() const {
+        return(mCount ? mMin : 0);
+    }
+    uint64	getMax() const {
+        return(mMax);
+    }
+    uint64	getMean() const {
+        return(mCount ? mTotal / mCount : 0);
+    }
+
+private:
+
+    static const uint32	kSubBucketBits	= 4;
+    static const uint32	kSubBuckets		= 1 << kSubBucketBits;
+    static const uint32	kValueBits		= 36;	// ~19 hours, anything longer is clamped
+    static const uint32	kBuckets		= kSubBuckets + (kValueBits - kSubBucketBits) * kSubBuckets;
+
+    static uint32	_indexOf(uint64 value);
+    static uint64	_highestValueAt(uint32 index);
+
+    uint32	mCounts[kBuckets];
+    uint64	mCount;
+    uint64	mTotal;
+    uint64	mMin;
+    uint64	mMax;
+};
+
+//==============================================================================================================================
+//
+// Always on tick instrumentation for the main loop.
+// Code registers named sections once and times them with ProfileScope. Every section feeds its own histogram, and the
+// time spent per section during the current tick is kept so a tick running over the slow tick threshold can be
+// logged and kept with its full breakdown. Main thread only.
+//
+
+class TickProfiler
+{
+public:
+
+    struct SlowTick
+    {
+        uint64								mStart;
+        uint64								mDuration;
+        std::vector<std::pair<uint32,uint64> >	mSections;	// section, us spent in it during the tick
+    };
+
+    typedef std::deque<SlowTick>	SlowTickList;
+
+    static TickProfiler* getSingleton() {
+        return mSingleton;
+    }
+    static TickProfiler* Init(uint64 slowTickThreshold = 50000);
+    static void	destroySingleton(void);
+
+    // monotonic, in microseconds
+    static uint64	getMicroseconds();
+
+    // returns the existing id if the name is already known, ids start at 1
+    uint32	registerSection(const std::string& name);
+
+    // one section per scheduler and bound method, so per creature tasks share a histogram
+    uint32	registerTask(uint32 scheduler, const fastdelegate::DelegateMemento& callback);
+
+    void	beginTick();
+    // returns true if the tick went over the threshold and was added to the slow ticks
+    bool	endTick();
+
+    void	record(uint32 section, uint64 elapsed);
+
+    const std::string&		getSectionName(uint32 section) const {
+        return(mNames[section]);
+    }
+    const LatencyHistogram&	getSectionHistogram(uint32 section) const {
+        return(mHistograms[section]);
+    }
+    const LatencyHistogram&	getTickHistogram() const {
+        return(mTickHistogram);
+    }
+    const SlowTickList&		getSlowTicks() const {
+        return(mSlowTicks);
+    }
+
+    uint32	getSectionCount() const {
+        return(static_cast<uint32>(mNames.size() - 1));
+    }
+
+    void	setSlowTickThreshold(uint64 threshold) {
+        mSlowTickThreshold = threshold;
+    }
+
+    // percentiles of every section hit since the last reset, one line each
+    void	printReport(std::ostream& out) const;
+    void	printSlowTick(std::ostream& out, const SlowTick& tick) const;
+
+    // starts the histograms over, section ids stay valid
+    void	resetHistograms();
+
+protected:
+
+    TickProfiler(uint64 slowTickThreshold);
+    ~TickProfiler();
+
+private:
+
+    typedef std::map<std::string,uint32>					SectionMap;
+    typedef std::map<std::pair<uint32,std::string>,uint32>	TaskMap;
+
+    static const uint32	kSlowTickHistory	= 32;
+    static const uint32	kSlowTickSections	= 12;
+
+    SectionMap						mSections;
+    TaskMap							mTasks;
+    std::vector<std::string>		mNames;
+    std::vector<LatencyHistogram>	mHistograms;
+
+    // per tick accumulation
+    std::vector<uint64>				mTickTimes;
+    std::vector<uint32>				mTickHits;
+    std::vector<uint32>				mTickSections;
+    uint64							mTickStart;
+    bool							mInTick;
+
+    LatencyHistogram				mTickHistogram;
+    SlowTickList					mSlowTicks;
+    uint64							mSlowTickThreshold;
+
+    static TickProfiler*	mSingleton;
+};
+
+//==============================================================================================================================
+//
+// times its own lifetime into a section, does nothing for section 0 or without a profiler
+//
+
+class ProfileScope
+{
+public:
+
+    explicit ProfileScope(uint32 section)
+        : mSection(gTickProfiler ? section : 0)
+        , mStart(mSection ? TickProfiler::getMicroseconds() : 0) {}
+
+    ~ProfileScope()
+    {
+        if(mSection && gTickProfiler)
+            gTickProfiler->record(mSection,TickProfiler::getMicroseconds() - mStart);
+    }
+
+private:
+
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+
+    uint32	mSection;
+    uint64	mStart;
+};
+}
+
+//==============================================================================================================================
+
+#endif
+
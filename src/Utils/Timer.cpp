@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Timer.h"
 #include "TimerCallback.h"
+#include "EventLoop.h"
 
 //==============================================================================================================================
 
@@ -67,6 +68,10 @@ void Timer::Run()
         {
             mCallback->handleTimer(mId,mContainer);
             mLastTick = currentTick;
+
+            // timer handlers usually just queue an event for the main thread
+            if(Anh_Utils::EventLoop* loop = gEventLoop)
+                loop->wakeup();
         }
 
         boost::this_thread::sleep(boost::posix_time::milliseconds(10));
@@ -0,0 +1,376 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "TimingWheel.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace Anh_Utils
+{
+//======================================================================================================================
+
+static inline uint32 lowestSetBit(uint64 word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index,word);
+    return(static_cast<uint32>(index));
+#else
+    return(static_cast<uint32>(__builtin_ctzll(word)));
+#endif
+}
+
+//======================================================================================================================
+
+const uint32 TimingWheel::kNoEntry;
+const uint64 TimingWheel::kNever;
+
+TimingWheel::TimingWheel() : mCurrent(0),mCount(0),mStarted(false)
+{
+    for(uint32 i = 0; i < kBucketCount; ++i)
+    {
+        mHeads[i] = kNoEntry;
+        mTails[i] = kNoEntry;
+    }
+
+    for(uint32 i = 0; i < kSlots / 64; ++i)
+        mOccupied[i] = 0;
+}
+
+//======================================================================================================================
+
+TimingWheel::~TimingWheel()
+{
+}
+
+//======================================================================================================================
+
+void TimingWheel::insert(uint32 entry,uint64 due)
+{
+    if(entry >= mNodes.size())
+        mNodes.resize(entry + 1);
+
+    if(mNodes[entry].mBucket != kNoEntry)
+        _unlink(entry);
+
+    if(!mStarted)
+        start(due);
+
+    mNodes[entry].mDue = due;
+    _link(entry,_bucketFor(due));
+}
+
+//======================================================================================================================
+
+void TimingWheel::start(uint64 now)
+{
+    // only legal while empty, the buckets are relative to the current tick
+    if(mCount)
+        return;
+
+    mCurrent	= now;
+    mStarted	= true;
+}
+
+//======================================================================================================================
+
+void TimingWheel::remove(uint32 entry)
+{
+    if(contains(entry))
+        _unlink(entry);
+}
+
+//======================================================================================================================
+
+void TimingWheel::advance(uint64 now,std::vector<uint32>& expired)
+{
+    if(!mStarted)
+        start(now);
+
+    while(mCurrent <= now)
+    {
+        // entering a new block of level 0, pull the next block down from the upper levels
+        if((mCurrent & kSlotMask) == 0)
+            _cascade();
+
+        uint32 slot = static_cast<uint32>(mCurrent & kSlotMask);
+
+        while(mHeads[slot] != kNoEntry)
+        {
+            uint32 entry = mHeads[slot];
+            _unlink(entry);
+            expired.push_back(entry);
+        }
+
+        uint64 next = _nextTick();
+
+        if(next > now)
+        {
+            mCurrent = now + 1;
+            break;
+        }
+
+        mCurrent = next;
+    }
+}
+
+//======================================================================================================================
+//
+// level n holds entries sharing all bits above the first n+1 slot indices with the current tick
+//
+
+uint32 TimingWheel::_bucketFor(uint64 due) const
+{
+    if(due < mCurrent)
+        due = mCurrent;
+
+    for(uint32 level = 0; level < kLevels; ++level)
+    {
+        uint32 shift = kSlotBits * (level + 1);
+
+        if((due >> shift) == (mCurrent >> shift))
+            return(level * kSlots + static_cast<uint32>((due >> (kSlotBits * level)) & kSlotMask));
+    }
+
+    return(kOverflowBucket);
+}
+
+//======================================================================================================================
+
+void TimingWheel::_link(uint32 entry,uint32 bucket)
+{
+    Node& node = mNodes[entry];
+
+    node.mBucket	= bucket;
+    node.mNext		= kNoEntry;
+    node.mPrev		= mTails[bucket];
+
+    if(mTails[bucket] != kNoEntry)
+        mNodes[mTails[bucket]].mNext = entry;
+    else
+        mHeads[bucket] = entry;
+
+    mTails[bucket] = entry;
+
+    if(bucket < kSlots)
+        mOccupied[bucket >> 6] |= (static_cast<uint64>(1) << (bucket & 63));
+
+    ++mCount;
+}
+
+//======================================================================================================================
+
+void TimingWheel::_unlink(uint32 entry)
+{
+    Node&	node	= mNodes[entry];
+    uint32	bucket	= node.mBucket;
+
+    if(node.mPrev != kNoEntry)
+        mNodes[node.mPrev].mNext = node.mNext;
+    else
+        mHeads[bucket] = node.mNext;
+
+    if(node.mNext != kNoEntry)
+        mNodes[node.mNext].mPrev = node.mPrev;
+    else
+        mTails[bucket] = node.mPrev;
+
+    if(bucket < kSlots && mHeads[bucket] == kNoEntry)
+        mOccupied[bucket >> 6] &= ~(static_cast<uint64>(1) << (bucket & 63));
+
+    node.mBucket	= kNoEntry;
+    node.mNext		= kNoEntry;
+    node.mPrev		= kNoEntry;
+
+    --mCount;
+}
+
+//======================================================================================================================
+
+void TimingWheel::_cascade()
+{
+    for(uint32 level = 1; level < kLevels; ++level)
+    {
+        uint32 slot = static_cast<uint32>((mCurrent >> (kSlotBits * level)) & kSlotMask);
+
+        _relinkBucket(level * kSlots + slot);
+
+        if(slot != 0)
+            return;
+    }
+
+    _relinkBucket(kOverflowBucket);
+}
+
+//======================================================================================================================
+
+void TimingWheel::_relinkBucket(uint32 bucket)
+{
+    uint32 entry = mHeads[bucket];
+
+    mHeads[bucket] = kNoEntry;
+    mTails[bucket] = kNoEntry;
+
+    while(entry != kNoEntry)
+    {
+        uint32 next = mNodes[entry].mNext;
+
+        --mCount;
+        _link(entry,_bucketFor(mNodes[entry].mDue));
+
+        entry = next;
+    }
+}
+
+//======================================================================================================================
+
+uint64 TimingWheel::getNextDue() const
+{
+    if(!mCount)
+        return(kNever);
+
+    uint64 blockStart	= mCurrent & ~static_cast<uint64>(kSlotMask);
+    uint32 slot			= _findOccupiedSlot(static_cast<uint32>(mCurrent & kSlotMask));
+
+    if(slot < kSlots)
+        return(blockStart + slot);
+
+    // everything else sits in later blocks
+    return(blockStart + kSlots);
+}
+
+//======================================================================================================================
+//
+// next tick worth visiting, either an occupied level 0 slot or the start of the next block
+//
+
+uint64 TimingWheel::_nextTick() const
+{
+    uint64 blockStart	= mCurrent & ~static_cast<uint64>(kSlotMask);
+    uint32 slot			= _findOccupiedSlot(static_cast<uint32>(mCurrent & kSlotMask) + 1);
+
+    if(slot < kSlots)
+        return(blockStart + slot);
+
+    return(blockStart + kSlots);
+}
+
+//======================================================================================================================
+//
+// first occupied level 0 slot at or after slot, kSlots if there is none
+//
+
+uint32 TimingWheel::_findOccupiedSlot(uint32 slot) const
+{
+    if(slot >= kSlots)
+        return(kSlots);
+
+    uint32 word		= slot >> 6;
+    uint64 bits		= mOccupied[word] & (~static_cast<uint64>(0) << (slot & 63));
+
+    while(true)
+    {
+        if(bits)
+            return((word << 6) + lowestSetBit(bits));
+
+        if(++word >= kSlots / 64)
+            break;
+
+        bits = mOccupied[word];
+    }
+
+    return(kSlots);
+}
+
+//======================================================================================================================
+
+void PriorityLanes::push(uint8 priority,uint64 id)
+{
+    LaneList::iterator it = mLanes.begin();
+
+    while(it != mLanes.end() && it->mPriority > priority)
+        ++it;
+
+    if(it == mLanes.end() || it->mPriority != priority)
+        it = mLanes.insert(it,Lane(priority));
+
+    it->mIds.push_back(id);
+    ++mCount;
+}
+
+//======================================================================================================================
+
+bool PriorityLanes::pop(uint64& id)
+{
+    if(!mCount)
+        return(false);
+
+    LaneList::iterator it = mLanes.begin();
+
+    while(it != mLanes.end())
+    {
+        if(it->mHead < it->mIds.size())
+        {
+            id = it->mIds[it->mHead++];
+
+            if(it->mHead == it->mIds.size())
+            {
+                it->mIds.clear();
+                it->mHead = 0;
+            }
+
+            --mCount;
+            return(true);
+        }
+
+        ++it;
+    }
+
+    return(false);
+}
+
+//======================================================================================================================
+
+void PriorityLanes::clear()
+{
+    LaneList::iterator it = mLanes.begin();
+
+    while(it != mLanes.end())
+    {
+        it->mIds.clear();
+        it->mHead = 0;
+        ++it;
+    }
+
+    mCount = 0;
+}
+}
+
+//======================================================================================================================
@@ -0,0 +1,166 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_UTILS_TIMINGWHEEL_H
+#define ANH_UTILS_TIMINGWHEEL_H
+
+#include <vector>
+
+#include "typedefs.h"
+
+
+namespace Anh_Utils
+{
+//======================================================================================================================
+//
+// Hierarchical timing wheel with millisecond resolution.
+// Entries are plain indices chosen by the owner (usually a slot in its task pool), so insert, remove and
+// lookup are O(1) and advancing only touches the slots that actually hold due entries.
+// Four levels of 256 slots cover 2^32 ms, anything further out waits in an overflow list.
+//
+
+class TimingWheel
+{
+public:
+
+    static const uint32 kNoEntry = 0xffffffff;
+    static const uint64 kNever = 0xffffffffffffffffULL;
+
+    TimingWheel();
+    ~TimingWheel();
+
+    // anchors the wheel at the owners notion of now, done implicitly by the first advance
+    void	start(uint64 now);
+    bool	isStarted() const {
+        return mStarted;
+    }
+
+    void	insert(uint32 entry,uint64 due);
+    void	remove(uint32 entry);
+
+    bool	contains(uint32 entry) const {
+        return(entry < mNodes.size() && mNodes[entry].mBucket != kNoEntry);
+    }
+    uint64	getDue(uint32 entry) const {
+        return(mNodes[entry].mDue);
+    }
+    uint32	size() const {
+        return mCount;
+    }
+
+    // appends every entry due at or before now to expired, in deadline order
+    void	advance(uint64 now,std::vector<uint32>& expired);
+
+    // earliest tick advance() can have work at, exact within the current 256ms block and a lower bound beyond it
+    uint64	getNextDue() const;
+
+private:
+
+    enum
+    {
+        kLevels			= 4,
+        kSlotBits		= 8,
+        kSlots			= 1 << kSlotBits,
+        kSlotMask		= kSlots - 1,
+        kOverflowBucket	= kLevels * kSlots,
+        kBucketCount	= kOverflowBucket + 1
+    };
+
+    class Node
+    {
+    public:
+
+        Node() : mDue(0),mNext(kNoEntry),mPrev(kNoEntry),mBucket(kNoEntry) {}
+
+        uint64	mDue;
+        uint32	mNext;
+        uint32	mPrev;
+        uint32	mBucket;
+    };
+
+    uint32	_bucketFor(uint64 due) const;
+    void	_link(uint32 entry,uint32 bucket);
+    void	_unlink(uint32 entry);
+    void	_cascade();
+    void	_relinkBucket(uint32 bucket);
+    uint64	_nextTick() const;
+    uint32	_findOccupiedSlot(uint32 slot) const;
+
+    std::vector<Node>	mNodes;
+    uint32				mHeads[kBucketCount];
+    uint32				mTails[kBucketCount];
+    uint64				mOccupied[kSlots / 64];
+    uint64				mCurrent;
+    uint32				mCount;
+    bool				mStarted;
+};
+
+//======================================================================================================================
+//
+// Ready queue of a scheduler, one fifo lane per priority.
+// Expired tasks are pushed in deadline order and popped highest priority first.
+//
+
+class PriorityLanes
+{
+public:
+
+    PriorityLanes() : mCount(0) {}
+
+    void	push(uint8 priority,uint64 id);
+    bool	pop(uint64& id);
+    void	clear();
+
+    bool	empty() const {
+        return(mCount == 0);
+    }
+    uint32	size() const {
+        return mCount;
+    }
+
+private:
+
+    class Lane
+    {
+    public:
+
+        Lane(uint8 priority) : mPriority(priority),mHead(0) {}
+
+        uint8				mPriority;
+        uint32				mHead;
+        std::vector<uint64>	mIds;
+    };
+
+    typedef std::vector<Lane> LaneList;
+
+    LaneList	mLanes;
+    uint32		mCount;
+};
+}
+
+#endif
+
@@ -1,4 +1,3 @@
-
 /*
 ---------------------------------------------------------------------------------------
 This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
@@ -25,12 +24,17 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ---------------------------------------------------------------------------------------
 */
+
 #include "VariableTimeScheduler.h"
+
+
 namespace Anh_Utils
 {
 //======================================================================================================================
 
-VariableTimeScheduler::VariableTimeScheduler(uint64 processTimeLimit, uint64 throttleLimit) : mNextTask(0),mNextTaskId(1),mProcessTimeLimit(processTimeLimit),mThrottleLimit(throttleLimit)
+const uint32 VariableTimeScheduler::kNoSlot;
+
+VariableTimeScheduler::VariableTimeScheduler(uint64 processTimeLimit, uint64 throttleLimit) : mNextTaskId(1),mProcessTimeLimit(processTimeLimit),mThrottleLimit(throttleLimit),mProfileSection(0)
 {
     mLastProcessTime = 0;
     // We do have a global clock object, don't use seperate clock and times for every process.
@@ -48,52 +52,54 @@ VariableTimeScheduler::~VariableTimeScheduler()
 
 uint64 VariableTimeScheduler::addTask(VariableTimeCallback callback,uint8 priority,uint64 interval,void* async)
 {
-    mTasks.push(VariableTimeTask(mNextTaskId,priority,Anh_Utils::Clock::getSingleton()->getLocalTime(),interval,callback,async));
-    return(mNextTaskId++);
-}
+    uint32 slot;
 
-//======================================================================================================================
+    if(!mFreeSlots.empty())
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(mTasks.size());
+        mTasks.push_back(VariableTimeTask(0,0,0,0,VariableTimeCallback(),NULL));
+    }
 
-void VariableTimeScheduler::removeTask(uint64 id)
-{
-    if(!id)
-        return;
+    // upper half is a running serial, so ids of recycled slots never repeat
+    uint64 id			= (mNextTaskId++ << 32) | (slot + 1);
+    uint64 currentTime	= Anh_Utils::Clock::getSingleton()->getLocalTime();
 
-    VariableTaskContainer::iterator it = mTasks.begin();
+    if(!mWheel.isStarted())
+        mWheel.start(currentTime);
 
-    while(it != mTasks.end())
-    {
-        if(it->mId == id)
-        {
-            mTasks.erase(it);
-            break;
-        }
+    mTasks[slot] = VariableTimeTask(id,priority,currentTime,interval,callback,async);
 
-        ++it;
-    }
+    if(mProfileSection && gTickProfiler)
+        mTasks[slot].mProfileSection = gTickProfiler->registerTask(mProfileSection,callback.GetMemento());
 
-    mTasks.assureHeap(true);
+    // a task is due once more than interval ms have passed since its last call
+    mWheel.insert(slot,currentTime + interval + 1);
+
+    return(id);
 }
 
-bool VariableTimeScheduler::checkTask(uint64 id)
-{
-    if(!id)
-        return false;
+//======================================================================================================================
 
-    VariableTaskContainer::iterator it = mTasks.begin();
+void VariableTimeScheduler::removeTask(uint64 id)
+{
+    uint32 slot = _findSlot(id);
 
-    while(it != mTasks.end())
-    {
-        if(it->mId == id)
-        {
-            return true;
-        }
+    if(slot == kNoSlot)
+        return;
 
-        ++it;
-    }
+    // a queued entry in mReady is skipped once its id no longer matches
+    mWheel.remove(slot);
+    _releaseSlot(slot);
+}
 
-    //mTasks.assureHeap(true);
-    return false;
+bool VariableTimeScheduler::checkTask(uint64 id)
+{
+    return(_findSlot(id) != kNoSlot);
 }
 
 //======================================================================================================================
@@ -103,11 +109,25 @@ void VariableTimeScheduler::process()
     uint64	frameStartTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
 
     //Check for throttle
-    if(frameStartTime < mLastProcessTime + mThrottleLimit)
+    if(frameStartTime < (mLastProcessTime + mThrottleLimit))
     {
         return;
     }
 
+    ProfileScope processScope(mProfileSection);
+
+    mWheel.advance(frameStartTime,mExpired);
+
+    std::vector<uint32>::iterator it = mExpired.begin();
+
+    while(it != mExpired.end())
+    {
+        mReady.push(mTasks[*it].mPriority,mTasks[*it].mId);
+        ++it;
+    }
+
+    mExpired.clear();
+
     while(runTask() && ((Anh_Utils::Clock::getSingleton()->getLocalTime() - frameStartTime) < mProcessTimeLimit));
 
     //Set internal Clock so we know when the last call was
@@ -118,40 +138,89 @@ void VariableTimeScheduler::process()
 
 bool VariableTimeScheduler::runTask()
 {
-    if(!(mTasks.empty()))
+    uint64 id;
+
+    while(mReady.pop(id))
     {
-        VariableTimeTask&	task(mTasks[mNextTask]);
-        uint64	currentTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-        if((currentTime - task.mLastCallTime) > task.mInterval)
+        uint32 slot = _findSlot(id);
+
+        if(slot == kNoSlot)
+            continue;
+
         {
-            uint64 nextTick = task.mCallback(currentTime,task.mAsync);
+            // copy out, the callback may add tasks and grow the pool
+            VariableTimeCallback	callback	= mTasks[slot].mCallback;
+            void*			async		= mTasks[slot].mAsync;
+            uint64			currentTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+            uint64			nextTick;
+
+            {
+                ProfileScope taskScope(mTasks[slot].mProfileSection);
+                nextTick = callback(currentTime,async);
+            }
+
+            // the task may have been removed from within its callback
+            if(mTasks[slot].mId != id)
+                continue;
+
             if(nextTick == 0)
             {
-                removeTask(task.mId);
+                _releaseSlot(slot);
             }
             else
             {
+                VariableTimeTask& task(mTasks[slot]);
                 task.mInterval = nextTick;
                 task.mLastCallTime = currentTime;
-                ++mNextTask;
+                mWheel.insert(slot,currentTime + task.mInterval + 1);
             }
         }
-        else
-            ++mNextTask;
 
-        if(mNextTask >= mTasks.size())
-        {
-            reset();
-            return(false);
-        }
-        else
-            return(true);
-    }
-    else
-    {
-        reset();
-        return(false);
+        return(!mReady.empty());
     }
+
+    return(false);
+}
+
+//======================================================================================================================
+
+uint64 VariableTimeScheduler::getNextDeadline() const
+{
+    uint64 deadline = mReady.empty() ? mWheel.getNextDue() : 0;
+
+    if(deadline == TimingWheel::kNever)
+        return(deadline);
+
+    // process() is throttled anyway
+    return(std::max(deadline,mLastProcessTime + mThrottleLimit));
+}
+
+//======================================================================================================================
+
+uint32 VariableTimeScheduler::_findSlot(uint64 id) const
+{
+    uint32 slot = static_cast<uint32>(id & 0xffffffff);
+
+    if(slot == 0 || slot > mTasks.size())
+        return(kNoSlot);
+
+    --slot;
+
+    if(mTasks[slot].mId != id)
+        return(kNoSlot);
+
+    return(slot);
+}
+
+//======================================================================================================================
+
+void VariableTimeScheduler::_releaseSlot(uint32 slot)
+{
+    mTasks[slot].mId		= 0;
+    mTasks[slot].mCallback	= VariableTimeCallback();
+    mTasks[slot].mAsync		= NULL;
+
+    mFreeSlots.push_back(slot);
 }
 }
 
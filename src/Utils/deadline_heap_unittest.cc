@@ -0,0 +1,262 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "Utils/DeadlineHeap.h"
+#include "Utils/VariableTimeScheduler.h"
+#include "Utils/clock.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+using Anh_Utils::DeadlineHeap;
+using Anh_Utils::VariableTimeScheduler;
+
+TEST(DeadlineHeapTests, PopsInDeadlineThenInsertionOrder) {
+    DeadlineHeap heap;
+
+    uint64 late = heap.insert(300, 1, NULL);
+    uint64 first = heap.insert(100, 1, NULL);
+    uint64 second = heap.insert(100, 2, NULL);
+    uint64 middle = heap.insert(200, 3, NULL);
+
+    EXPECT_EQ(100u, heap.getNextDue());
+
+    std::vector<uint64> expired;
+    heap.popExpired(99, expired);
+    EXPECT_TRUE(expired.empty());
+
+    heap.popExpired(250, expired);
+    ASSERT_EQ(3u, expired.size());
+    EXPECT_EQ(first, expired[0]);
+    EXPECT_EQ(second, expired[1]);
+    EXPECT_EQ(middle, expired[2]);
+
+    // popped handles stay valid until released
+    EXPECT_TRUE(heap.contains(first));
+    EXPECT_FALSE(heap.isQueued(first));
+    EXPECT_EQ(4u, heap.size());
+    EXPECT_EQ(1u, heap.getQueuedCount());
+    EXPECT_EQ(300u, heap.getNextDue());
+    EXPECT_TRUE(heap.isQueued(late));
+}
+
+TEST(DeadlineHeapTests, RemovedHandlesAreNeverReused) {
+    DeadlineHeap heap;
+
+    uint64 first = heap.insert(10, 7, reinterpret_cast<void*>(1));
+    EXPECT_TRUE(heap.remove(first));
+    EXPECT_FALSE(heap.remove(first));
+
+    uint64 second = heap.insert(10, 7, reinterpret_cast<void*>(2));
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(heap.contains(first));
+    EXPECT_EQ(reinterpret_cast<void*>(2), heap.getData(second));
+    EXPECT_EQ(NULL, heap.getData(first));
+    EXPECT_EQ(DeadlineHeap::kNever, heap.getDue(first));
+}
+
+TEST(DeadlineHeapTests, RescheduleKeepsTheHandle) {
+    DeadlineHeap heap;
+
+    uint64 a = heap.insert(100, 1, NULL);
+    uint64 b = heap.insert(200, 1, NULL);
+
+    EXPECT_TRUE(heap.reschedule(a, 300));
+    EXPECT_EQ(200u, heap.getNextDue());
+
+    std::vector<uint64> expired;
+    heap.popExpired(200, expired);
+    ASSERT_EQ(1u, expired.size());
+    EXPECT_EQ(b, expired[0]);
+
+    // back into the heap after running
+    EXPECT_TRUE(heap.reschedule(b, 250));
+    EXPECT_TRUE(heap.isQueued(b));
+    EXPECT_EQ(250u, heap.getNextDue());
+}
+
+TEST(DeadlineHeapTests, RemoveOwnerDropsQueuedAndPoppedEntries) {
+    DeadlineHeap heap;
+
+    uint64 popped = heap.insert(10, 42, NULL);
+    heap.insert(20, 42, NULL);
+    heap.insert(30, 42, NULL);
+    uint64 other = heap.insert(15, 43, NULL);
+
+    std::vector<uint64> expired;
+    heap.popExpired(10, expired);
+    ASSERT_EQ(1u, expired.size());
+    ASSERT_EQ(popped, expired[0]);
+
+    EXPECT_EQ(3u, heap.removeOwner(42));
+    EXPECT_EQ(0u, heap.removeOwner(42));
+    EXPECT_FALSE(heap.contains(popped));
+
+    EXPECT_EQ(1u, heap.size());
+    EXPECT_TRUE(heap.contains(other));
+    EXPECT_EQ(15u, heap.getNextDue());
+    EXPECT_EQ(43u, heap.getOwner(other));
+}
+
+TEST(DeadlineHeapTests, MatchesOrderedReferenceUnderRandomLoad) {
+    DeadlineHeap heap;
+
+    std::multimap<uint64, uint64> reference;
+    std::map<uint64, uint64> live;
+    std::vector<uint64> handles;
+    std::vector<uint64> expired;
+    uint64 now = 0;
+
+    srand(42);
+
+    for (uint32_t step = 0; step < 50000; ++step) {
+        int action = rand() % 12;
+
+        if (action < 5 || handles.empty()) {
+            uint64 due = now + rand() % 5000;
+            uint64 handle = heap.insert(due, rand() % 64, NULL);
+            handles.push_back(handle);
+            live[handle] = due;
+            reference.insert(std::make_pair(due, handle));
+        } else if (action < 7) {
+            uint64 handle = handles[rand() % handles.size()];
+            bool alive = live.count(handle) != 0;
+            if (alive) {
+                reference.erase(reference.find(live[handle]));
+                live.erase(handle);
+            }
+            EXPECT_EQ(alive, heap.remove(handle));
+        } else if (action < 8) {
+            uint64 owner = rand() % 64;
+            uint32 dropped = 0;
+            for (std::map<uint64, uint64>::iterator it = live.begin(); it != live.end();) {
+                if (heap.getOwner(it->first) == owner) {
+                    std::multimap<uint64, uint64>::iterator ref = reference.lower_bound(it->second);
+                    while (ref->second != it->first) {
+                        ++ref;
+                    }
+                    reference.erase(ref);
+                    live.erase(it++);
+                    ++dropped;
+                } else {
+                    ++it;
+                }
+            }
+            EXPECT_EQ(dropped, heap.removeOwner(owner));
+        } else if (action < 10) {
+            uint64 handle = handles[rand() % handles.size()];
+            if (live.count(handle)) {
+                std::multimap<uint64, uint64>::iterator ref = reference.lower_bound(live[handle]);
+                while (ref->second != handle) {
+                    ++ref;
+                }
+                reference.erase(ref);
+                uint64 due = now + rand() % 5000;
+                live[handle] = due;
+                reference.insert(std::make_pair(due, handle));
+                EXPECT_TRUE(heap.reschedule(handle, due));
+            }
+        } else {
+            now += rand() % 1000;
+            heap.popExpired(now, expired);
+
+            uint64 last_due = 0;
+            for (size_t i = 0; i < expired.size(); ++i) {
+                ASSERT_TRUE(live.count(expired[i]) != 0);
+                uint64 due = live[expired[i]];
+                EXPECT_LE(due, now);
+                EXPECT_LE(last_due, due);
+                last_due = due;
+                live.erase(expired[i]);
+                EXPECT_TRUE(heap.remove(expired[i]));
+            }
+
+            size_t due_count = std::distance(reference.begin(), reference.upper_bound(now));
+            EXPECT_EQ(due_count, expired.size());
+            reference.erase(reference.begin(), reference.upper_bound(now));
+            expired.clear();
+        }
+
+        ASSERT_EQ(live.size(), heap.size());
+        ASSERT_EQ(reference.empty() ? DeadlineHeap::kNever : reference.begin()->first, heap.getNextDue());
+    }
+}
+
+class BuffTarget {
+public:
+    uint64 Update(uint64 call_time, void* ref) {
+        return 1000;
+    }
+};
+
+// The buff workload: tens of thousands of timed effects, most of them cancelled
+// before expiring and a creature dropping all of its effects at once on death.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST(DeadlineHeapTests, DISABLED_BenchmarkAgainstVariableTimeScheduler) {
+    const uint32_t creatures = 10000;
+    const uint32_t per_creature = 5;
+    const uint32_t count = creatures * per_creature;
+
+    Anh_Utils::Clock::Init();
+    srand(3);
+
+    std::vector<uint64> delays;
+    for (uint32_t i = 0; i < count; ++i) {
+        delays.push_back(60000 + rand() % 600000);
+    }
+
+    // scheduler: one task per buff, creature cancel is one removeTask per buff
+    BuffTarget target;
+    VariableTimeScheduler scheduler(100, 100);
+    std::vector<uint64> task_ids;
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (uint32_t i = 0; i < count; ++i) {
+        task_ids.push_back(scheduler.addTask(fastdelegate::MakeDelegate(&target, &BuffTarget::Update), 1, delays[i], NULL));
+    }
+    for (uint32_t i = 0; i < count; i += 2) {
+        scheduler.removeTask(task_ids[i]);
+    }
+    for (uint32_t i = 1; i < count; i += 2) {
+        scheduler.removeTask(task_ids[i]);
+    }
+    boost::posix_time::ptime scheduler_done = boost::posix_time::microsec_clock::universal_time();
+
+    // heap: cancel half one by one, the rest per creature
+    DeadlineHeap heap;
+    std::vector<uint64> handles;
+
+    boost::posix_time::ptime heap_start = boost::posix_time::microsec_clock::universal_time();
+    for (uint32_t i = 0; i < count; ++i) {
+        handles.push_back(heap.insert(delays[i], i / per_creature, NULL));
+    }
+    for (uint32_t i = 0; i < count; i += 2) {
+        heap.remove(handles[i]);
+    }
+    uint32_t dropped = 0;
+    for (uint32_t c = 0; c < creatures; ++c) {
+        dropped += heap.removeOwner(c);
+    }
+    boost::posix_time::ptime heap_done = boost::posix_time::microsec_clock::universal_time();
+
+    std::cout << count << " effects: scheduler "
+              << (scheduler_done - start).total_microseconds() * 1000.0 / count << " ns/add+cancel, heap "
+              << (heap_done - heap_start).total_microseconds() * 1000.0 / count << " ns/add+cancel" << std::endl;
+
+    EXPECT_EQ(0u, scheduler.getTaskCount());
+    EXPECT_EQ(count / 2, dropped);
+    EXPECT_EQ(0u, heap.size());
+}
+
+}  // namespace
@@ -0,0 +1,146 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "Utils/EventLoop.h"
+
+#include <ctime>
+#include <iostream>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+using Anh_Utils::EventLoop;
+
+class EventLoopTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        EventLoop::Init();
+    }
+
+    virtual void TearDown() {
+        EventLoop::destroySingleton();
+    }
+
+    static uint64_t Now() {
+        static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+        return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+    }
+};
+
+TEST_F(EventLoopTest, WaitTimesOutWithoutWakeup) {
+    uint64_t start = Now();
+    EXPECT_FALSE(gEventLoop->wait(15));
+    EXPECT_GE(Now() - start, 14000u);
+    EXPECT_EQ(1u, gEventLoop->getTimeoutCount());
+}
+
+TEST_F(EventLoopTest, PendingWakeupReturnsImmediately) {
+    gEventLoop->wakeup();
+
+    uint64_t start = Now();
+    EXPECT_TRUE(gEventLoop->wait(1000));
+    EXPECT_LT(Now() - start, 500000u);
+}
+
+TEST_F(EventLoopTest, WakeupsAreCoalescedUntilTheLoopRuns) {
+    gEventLoop->wakeup();
+    gEventLoop->wakeup();
+    gEventLoop->wakeup();
+
+    EXPECT_TRUE(gEventLoop->wait(1000));
+
+    // all three were drained by the first wait
+    EXPECT_FALSE(gEventLoop->wait(0));
+
+    // and the loop is armed again
+    gEventLoop->wakeup();
+    EXPECT_TRUE(gEventLoop->wait(1000));
+    EXPECT_EQ(2u, gEventLoop->getWakeupCount());
+}
+
+TEST_F(EventLoopTest, WakeupFromAnotherThreadInterruptsWait) {
+    boost::thread producer([] () {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+        gEventLoop->wakeup();
+    });
+
+    uint64_t start = Now();
+    EXPECT_TRUE(gEventLoop->wait(5000));
+    EXPECT_LT(Now() - start, 2000000u);
+
+    producer.join();
+}
+
+// Compares the old fixed 1ms sleep main loop with waiting on the event loop:
+// cpu time burned while idle and the delay between a producer handing over
+// work and the main loop noticing it.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(EventLoopTest, DISABLED_BenchmarkIdleCpuAndWakeLatency) {
+    const uint64_t idle_ms = 500;
+    const int rounds = 50;
+
+    // idle cpu, 1ms sleep poll
+    std::clock_t cpu_start = std::clock();
+    uint64_t until = Now() + idle_ms * 1000;
+    uint32_t polls = 0;
+    while (Now() < until) {
+        ++polls;
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    double poll_cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC * 1000.0;
+
+    // idle cpu, event loop capped at 20ms like the zone main loop
+    cpu_start = std::clock();
+    until = Now() + idle_ms * 1000;
+    uint32_t waits = 0;
+    while (Now() < until) {
+        ++waits;
+        gEventLoop->wait(20);
+    }
+    double wait_cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC * 1000.0;
+
+    // wake latency, both sides see the same handover flag
+    volatile uint64_t posted = 0;
+    uint64_t poll_latency = 0;
+    uint64_t wait_latency = 0;
+
+    for (int i = 0; i < rounds; ++i) {
+        posted = 0;
+        boost::thread poll_producer([&posted] () {
+            boost::this_thread::sleep(boost::posix_time::microseconds(1500));
+            posted = EventLoopTest::Now();
+        });
+        while (!posted) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+        poll_latency += Now() - posted;
+        poll_producer.join();
+
+        posted = 0;
+        boost::thread wait_producer([&posted] () {
+            boost::this_thread::sleep(boost::posix_time::microseconds(1500));
+            posted = EventLoopTest::Now();
+            gEventLoop->wakeup();
+        });
+        while (!posted) {
+            gEventLoop->wait(1000);
+        }
+        wait_latency += Now() - posted;
+        wait_producer.join();
+    }
+
+    std::cout << "idle " << idle_ms << "ms: sleep(1) poll " << polls << " iterations, " << poll_cpu << " ms cpu; "
+              << "event loop " << waits << " iterations, " << wait_cpu << " ms cpu" << std::endl;
+    std::cout << "wake latency: sleep(1) poll " << poll_latency / rounds << " us, "
+              << "event loop " << wait_latency / rounds << " us" << std::endl;
+
+    EXPECT_LT(waits, polls);
+}
+
+}  // namespace
@@ -4,6 +4,13 @@
 
 #include "Utils/MathFunctions.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <gtest/gtest.h>
 
 // Wrapping tests in an anonymous namespace prevents potential name conflicts
@@ -25,4 +32,109 @@ TEST(MathFunctionsTests, CanCheckIfPointIsInRectangleBoundries) {
     EXPECT_FALSE(IsPointInRectangle(player_pos2, rec_center, width, height));
 }
 
+TEST(MathFunctionsTests, BilinearInterpolateHitsCornersAndCenter) {
+    EXPECT_FLOAT_EQ(1.0f, BilinearInterpolate(1.0f, 2.0f, 3.0f, 4.0f, 0.0f, 0.0f));
+    EXPECT_FLOAT_EQ(2.0f, BilinearInterpolate(1.0f, 2.0f, 3.0f, 4.0f, 1.0f, 0.0f));
+    EXPECT_FLOAT_EQ(3.0f, BilinearInterpolate(1.0f, 2.0f, 3.0f, 4.0f, 0.0f, 1.0f));
+    EXPECT_FLOAT_EQ(4.0f, BilinearInterpolate(1.0f, 2.0f, 3.0f, 4.0f, 1.0f, 1.0f));
+    EXPECT_FLOAT_EQ(2.5f, BilinearInterpolate(1.0f, 2.0f, 3.0f, 4.0f, 0.5f, 0.5f));
+}
+
+// Samples a synthetic height grid the way the zone heightmap does: gather the
+// four corners of each cell, then interpolate.
+class BilinearBatchTest : public ::testing::Test {
+protected:
+    static const int kGridSize = 1024;
+    static const size_t kBatchSize = 256;
+
+    virtual void SetUp() {
+        srand(1);
+
+        grid_.resize(kGridSize * kGridSize);
+        for (size_t i = 0; i < grid_.size(); ++i) {
+            grid_[i] = static_cast<float>(rand() % 20000) / 10.0f;
+        }
+
+        x_.resize(1 << 20);
+        z_.resize(x_.size());
+        for (size_t i = 0; i < x_.size(); ++i) {
+            x_[i] = static_cast<float>(rand() % ((kGridSize - 1) * 100)) / 100.0f;
+            z_[i] = static_cast<float>(rand() % ((kGridSize - 1) * 100)) / 100.0f;
+        }
+    }
+
+    float GetHeight(float x, float z) const {
+        int column = static_cast<int>(x);
+        int row = static_cast<int>(z);
+        const float* cell = &grid_[row * kGridSize + column];
+
+        return BilinearInterpolate(cell[0], cell[1], cell[kGridSize], cell[kGridSize + 1], x - column, z - row);
+    }
+
+    void GetHeights(const float* x, const float* z, float* heights, size_t count) const {
+        float h00[kBatchSize], h01[kBatchSize], h10[kBatchSize], h11[kBatchSize];
+        float tx[kBatchSize], tz[kBatchSize];
+
+        for (size_t offset = 0; offset < count; offset += kBatchSize) {
+            size_t batch = std::min(kBatchSize, count - offset);
+
+            for (size_t i = 0; i < batch; ++i) {
+                int column = static_cast<int>(x[offset + i]);
+                int row = static_cast<int>(z[offset + i]);
+                const float* cell = &grid_[row * kGridSize + column];
+
+                h00[i] = cell[0];
+                h01[i] = cell[1];
+                h10[i] = cell[kGridSize];
+                h11[i] = cell[kGridSize + 1];
+                tx[i] = x[offset + i] - column;
+                tz[i] = z[offset + i] - row;
+            }
+
+            BilinearInterpolateBatch(h00, h01, h10, h11, tx, tz, heights + offset, batch);
+        }
+    }
+
+    std::vector<float> grid_;
+    std::vector<float> x_;
+    std::vector<float> z_;
+};
+
+TEST_F(BilinearBatchTest, BatchMatchesScalar) {
+    // An odd count exercises the scalar tail of the batch.
+    size_t count = 1001;
+    std::vector<float> heights(count);
+
+    GetHeights(&x_[0], &z_[0], &heights[0], count);
+
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_FLOAT_EQ(GetHeight(x_[i], z_[i]), heights[i]);
+    }
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(BilinearBatchTest, DISABLED_BenchmarkScalarVersusBatched) {
+    size_t count = x_.size();
+    std::vector<float> scalar_heights(count);
+    std::vector<float> batched_heights(count);
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (size_t i = 0; i < count; ++i) {
+        scalar_heights[i] = GetHeight(x_[i], z_[i]);
+    }
+    boost::posix_time::ptime middle = boost::posix_time::microsec_clock::universal_time();
+    GetHeights(&x_[0], &z_[0], &batched_heights[0], count);
+    boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time();
+
+    double scalar_seconds = (middle - start).total_microseconds() / 1000000.0;
+    double batched_seconds = (end - middle).total_microseconds() / 1000000.0;
+
+    if (scalar_seconds > 0.0 && batched_seconds > 0.0) {
+        std::cout << "scalar: " << static_cast<uint64_t>(count / scalar_seconds) << " heights/sec, "
+                  << "batched: " << static_cast<uint64_t>(count / batched_seconds) << " heights/sec" << std::endl;
+    }
+
+    EXPECT_FLOAT_EQ(scalar_heights[count - 1], batched_heights[count - 1]);
+}
+
 }  // namespace
@@ -0,0 +1,360 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "Utils/Scheduler.h"
+#include "Utils/TimingWheel.h"
+#include "Utils/VariableTimeScheduler.h"
+#include "Utils/clock.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+using Anh_Utils::PriorityLanes;
+using Anh_Utils::Scheduler;
+using Anh_Utils::TimingWheel;
+using Anh_Utils::VariableTimeScheduler;
+
+// Epoch based millisecond clock like the one the schedulers run on.
+const uint64_t kWheelStart = 1286000000000ULL;
+
+TEST(TimingWheelTests, FiresEntriesExactlyAtTheirDeadline) {
+    TimingWheel wheel;
+    wheel.start(kWheelStart);
+
+    // Spread across all levels, the overflow list and a few block boundaries.
+    const uint64_t offsets[] = { 0, 1, 255, 256, 257, 4000, 65535, 65536, 70000,
+                                 16777216, 20000000, 4294967296ULL, 5000000000ULL };
+    const uint32_t count = sizeof(offsets) / sizeof(offsets[0]);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        wheel.insert(i, kWheelStart + offsets[i]);
+    }
+
+    EXPECT_EQ(count, wheel.size());
+
+    std::vector<uint32> expired;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t due = kWheelStart + offsets[i];
+
+        if (due > kWheelStart) {
+            wheel.advance(due - 1, expired);
+            EXPECT_TRUE(expired.empty()) << "entry " << i << " fired early";
+        }
+
+        wheel.advance(due, expired);
+        ASSERT_EQ(1u, expired.size());
+        EXPECT_EQ(i, expired[0]);
+        expired.clear();
+    }
+
+    EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimingWheelTests, MatchesOrderedReferenceUnderRandomLoad) {
+    TimingWheel wheel;
+    wheel.start(kWheelStart);
+
+    std::multimap<uint64_t, uint32> reference;
+    std::map<uint32, uint64_t> live;
+    std::vector<uint32> expired;
+    uint64_t now = kWheelStart;
+
+    srand(42);
+
+    for (uint32_t step = 0; step < 20000; ++step) {
+        uint32 entry = rand() % 2048;
+        int action = rand() % 10;
+
+        if (action < 6) {
+            // Mostly short timers, some far out ones to exercise cascading.
+            uint64_t delay = (rand() % 4 == 0) ? (rand() % 300000) : (rand() % 3000);
+            if (live.count(entry)) {
+                reference.erase(reference.find(live[entry]));
+            }
+            wheel.insert(entry, now + delay);
+            live[entry] = now + delay;
+            reference.insert(std::make_pair(now + delay, entry));
+        } else if (action < 8) {
+            if (live.count(entry)) {
+                reference.erase(reference.find(live[entry]));
+                live.erase(entry);
+            }
+            wheel.remove(entry);
+        } else {
+            now += rand() % 5000;
+            wheel.advance(now, expired);
+
+            uint64_t last_due = 0;
+            for (size_t i = 0; i < expired.size(); ++i) {
+                ASSERT_TRUE(live.count(expired[i]) != 0);
+                uint64_t due = live[expired[i]];
+                EXPECT_LE(due, now);
+                EXPECT_LE(last_due, due);
+                last_due = due;
+                live.erase(expired[i]);
+            }
+
+            size_t due_count = std::distance(reference.begin(), reference.upper_bound(now));
+            EXPECT_EQ(due_count, expired.size());
+            reference.erase(reference.begin(), reference.upper_bound(now));
+            expired.clear();
+        }
+
+        ASSERT_EQ(live.size(), wheel.size());
+    }
+}
+
+TEST(TimingWheelTests, PriorityLanesPopHighestPriorityFirst) {
+    PriorityLanes lanes;
+
+    lanes.push(1, 10);
+    lanes.push(9, 90);
+    lanes.push(5, 50);
+    lanes.push(9, 91);
+
+    uint64 id;
+    ASSERT_TRUE(lanes.pop(id));
+    EXPECT_EQ(90u, id);
+    ASSERT_TRUE(lanes.pop(id));
+    EXPECT_EQ(91u, id);
+    ASSERT_TRUE(lanes.pop(id));
+    EXPECT_EQ(50u, id);
+    ASSERT_TRUE(lanes.pop(id));
+    EXPECT_EQ(10u, id);
+    EXPECT_FALSE(lanes.pop(id));
+    EXPECT_TRUE(lanes.empty());
+}
+
+class SchedulerTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        Anh_Utils::Clock::Init();
+        calls_ = 0;
+        remove_self_ = false;
+        self_id_ = 0;
+        next_interval_ = 0;
+    }
+
+    void Wait(uint64_t milliseconds) {
+        uint64_t until = gClock->getLocalTime() + milliseconds;
+        while (gClock->getLocalTime() <= until) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+    }
+
+    bool Count(uint64 call_time, void* ref) {
+        ++calls_;
+        order_.push_back(reinterpret_cast<uintptr_t>(ref));
+
+        if (remove_self_) {
+            scheduler_.removeTask(self_id_);
+        }
+        return true;
+    }
+
+    bool Once(uint64 call_time, void* ref) {
+        ++calls_;
+        return false;
+    }
+
+    uint64 Vary(uint64 call_time, void* ref) {
+        ++calls_;
+        return next_interval_;
+    }
+
+    Scheduler scheduler_;
+    VariableTimeScheduler variable_scheduler_;
+    int calls_;
+    bool remove_self_;
+    uint64 self_id_;
+    uint64 next_interval_;
+    std::vector<uintptr_t> order_;
+};
+
+TEST_F(SchedulerTest, RunsTaskOnlyAfterItsInterval) {
+    scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 1, 20, NULL);
+
+    scheduler_.process();
+    EXPECT_EQ(0, calls_);
+
+    Wait(25);
+    scheduler_.process();
+    EXPECT_EQ(1, calls_);
+
+    // Rescheduled relative to the last call.
+    scheduler_.process();
+    EXPECT_EQ(1, calls_);
+
+    Wait(25);
+    scheduler_.process();
+    EXPECT_EQ(2, calls_);
+}
+
+TEST_F(SchedulerTest, RemovedTaskIsGoneAndIdsAreNotRecycled) {
+    uint64 first = scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 1, 5, NULL);
+    EXPECT_TRUE(scheduler_.checkTask(first));
+
+    scheduler_.removeTask(first);
+    EXPECT_FALSE(scheduler_.checkTask(first));
+
+    // Reuses the freed slot but must not answer to the old id.
+    uint64 second = scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 1, 5, NULL);
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(scheduler_.checkTask(first));
+    EXPECT_TRUE(scheduler_.checkTask(second));
+
+    scheduler_.removeTask(first);
+    EXPECT_TRUE(scheduler_.checkTask(second));
+    EXPECT_EQ(1u, scheduler_.getTaskCount());
+}
+
+TEST_F(SchedulerTest, ReturningFalseRemovesTask) {
+    uint64 id = scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Once), 1, 5, NULL);
+
+    Wait(10);
+    scheduler_.process();
+    EXPECT_EQ(1, calls_);
+    EXPECT_FALSE(scheduler_.checkTask(id));
+
+    Wait(10);
+    scheduler_.process();
+    EXPECT_EQ(1, calls_);
+}
+
+TEST_F(SchedulerTest, TaskCanRemoveItselfFromItsCallback) {
+    self_id_ = scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 1, 5, NULL);
+    remove_self_ = true;
+
+    Wait(10);
+    scheduler_.process();
+    EXPECT_EQ(1, calls_);
+    EXPECT_FALSE(scheduler_.checkTask(self_id_));
+    EXPECT_EQ(0u, scheduler_.getTaskCount());
+}
+
+TEST_F(SchedulerTest, HigherPriorityRunsFirst) {
+    scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 1, 5, reinterpret_cast<void*>(1));
+    scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 9, 5, reinterpret_cast<void*>(9));
+    scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), 5, 5, reinterpret_cast<void*>(5));
+
+    Wait(10);
+    scheduler_.process();
+
+    ASSERT_EQ(3u, order_.size());
+    EXPECT_EQ(9u, order_[0]);
+    EXPECT_EQ(5u, order_[1]);
+    EXPECT_EQ(1u, order_[2]);
+}
+
+TEST_F(SchedulerTest, VariableTimeTaskUsesReturnedInterval) {
+    next_interval_ = 60;
+    uint64 id = variable_scheduler_.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Vary), 1, 5, NULL);
+
+    Wait(10);
+    variable_scheduler_.process();
+    EXPECT_EQ(1, calls_);
+
+    Wait(10);
+    variable_scheduler_.process();
+    EXPECT_EQ(1, calls_);
+
+    Wait(60);
+    next_interval_ = 0;
+    variable_scheduler_.process();
+    EXPECT_EQ(2, calls_);
+    EXPECT_FALSE(variable_scheduler_.checkTask(id));
+}
+
+// The walk the priority_vector backed Scheduler did on every process() call:
+// every task is visited and the clock read once per task, due or not.
+class LinearScanTasks {
+public:
+    explicit LinearScanTasks(uint32_t count) : last_call_(count, gClock->getLocalTime()), interval_(count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            interval_[i] = 60000 + rand() % 60000;
+        }
+    }
+
+    uint32_t Process() {
+        uint32_t due = 0;
+        for (size_t i = 0; i < last_call_.size(); ++i) {
+            uint64_t now = gClock->getLocalTime();
+            if ((now - last_call_[i]) > interval_[i]) {
+                last_call_[i] = now;
+                ++due;
+            }
+        }
+        return due;
+    }
+
+private:
+    std::vector<uint64_t> last_call_;
+    std::vector<uint64_t> interval_;
+};
+
+// Per tick overhead with many registered but mostly idle tasks, the usual
+// shape of the zone schedulers (one ham regen or buff task per creature).
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(SchedulerTest, DISABLED_BenchmarkTickOverhead) {
+    const uint32_t task_counts[] = { 10000, 50000, 100000 };
+    const uint32_t ticks = 2000;
+
+    srand(7);
+
+    for (uint32_t c = 0; c < sizeof(task_counts) / sizeof(task_counts[0]); ++c) {
+        Scheduler scheduler;
+        std::vector<uint64> ids;
+
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        for (uint32_t i = 0; i < task_counts[c]; ++i) {
+            ids.push_back(scheduler.addTask(fastdelegate::MakeDelegate(this, &SchedulerTest::Count), rand() % 10, 60000 + rand() % 60000, NULL));
+        }
+        boost::posix_time::ptime added = boost::posix_time::microsec_clock::universal_time();
+
+        for (uint32_t i = 0; i < ticks; ++i) {
+            scheduler.process();
+        }
+        boost::posix_time::ptime processed = boost::posix_time::microsec_clock::universal_time();
+
+        for (uint32_t i = 0; i < ids.size(); ++i) {
+            EXPECT_TRUE(scheduler.checkTask(ids[i]));
+        }
+        for (uint32_t i = 0; i < ids.size(); ++i) {
+            scheduler.removeTask(ids[i]);
+        }
+        boost::posix_time::ptime removed = boost::posix_time::microsec_clock::universal_time();
+
+        LinearScanTasks linear(task_counts[c]);
+        uint32_t linear_due = 0;
+        boost::posix_time::ptime linear_start = boost::posix_time::microsec_clock::universal_time();
+        for (uint32_t i = 0; i < ticks; ++i) {
+            linear_due += linear.Process();
+        }
+        boost::posix_time::ptime linear_end = boost::posix_time::microsec_clock::universal_time();
+        EXPECT_EQ(0u, linear_due);
+
+        std::cout << task_counts[c] << " tasks: "
+                  << (linear_end - linear_start).total_microseconds() / static_cast<double>(ticks) << " us/tick linear scan, "
+                  << (processed - added).total_microseconds() / static_cast<double>(ticks) << " us/tick, "
+                  << (added - start).total_microseconds() * 1000.0 / task_counts[c] << " ns/add, "
+                  << (removed - processed).total_microseconds() * 1000.0 / task_counts[c] << " ns/check+remove"
+                  << std::endl;
+
+        EXPECT_EQ(0u, scheduler.getTaskCount());
+    }
+
+    EXPECT_EQ(0, calls_);
+}
+
+}  // namespace
@@ -0,0 +1,217 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "Utils/Scheduler.h"
+#include "Utils/TickProfiler.h"
+#include "Utils/clock.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+using Anh_Utils::LatencyHistogram;
+using Anh_Utils::ProfileScope;
+using Anh_Utils::Scheduler;
+using Anh_Utils::TickProfiler;
+
+TEST(LatencyHistogramTests, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+
+    for (uint64_t i = 0; i < 16; ++i) {
+        histogram.record(i);
+    }
+
+    EXPECT_EQ(16u, histogram.getCount());
+    EXPECT_EQ(0u, histogram.getMin());
+    EXPECT_EQ(15u, histogram.getMax());
+    EXPECT_EQ(7u, histogram.getPercentile(50.0));
+    EXPECT_EQ(15u, histogram.getPercentile(100.0));
+}
+
+TEST(LatencyHistogramTests, PercentilesStayWithinBucketPrecision) {
+    LatencyHistogram histogram;
+    std::vector<uint64_t> values;
+
+    srand(11);
+    for (int i = 0; i < 100000; ++i) {
+        // long tailed, like tick times
+        uint64_t value = (rand() % 100 == 0) ? rand() % 2000000 : rand() % 5000;
+        values.push_back(value);
+        histogram.record(value);
+    }
+
+    std::sort(values.begin(), values.end());
+
+    const double percents[] = { 50.0, 90.0, 99.0, 99.9 };
+    for (int i = 0; i < 4; ++i) {
+        uint64_t exact = values[static_cast<size_t>(percents[i] / 100.0 * values.size()) - 1];
+        uint64_t reported = histogram.getPercentile(percents[i]);
+
+        EXPECT_GE(reported, exact);
+        EXPECT_LE(reported, exact + exact / 16 + 1) << "p" << percents[i];
+    }
+
+    EXPECT_EQ(values.back(), histogram.getMax());
+}
+
+TEST(LatencyHistogramTests, HugeValuesAreClamped) {
+    LatencyHistogram histogram;
+    histogram.record(0xffffffffffffULL);
+
+    EXPECT_EQ(1u, histogram.getCount());
+    EXPECT_EQ(0xffffffffffffULL, histogram.getMax());
+    EXPECT_EQ(0xffffffffffffULL, histogram.getPercentile(99.0));
+}
+
+class TaskTarget {
+public:
+    bool Sleep(uint64 call_time, void* ref) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(reinterpret_cast<uintptr_t>(ref)));
+        return true;
+    }
+
+    bool Noop(uint64 call_time, void* ref) {
+        return true;
+    }
+};
+
+class TickProfilerTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        Anh_Utils::Clock::Init();
+        TickProfiler::Init(5000);
+    }
+
+    virtual void TearDown() {
+        TickProfiler::destroySingleton();
+    }
+};
+
+TEST_F(TickProfilerTest, SectionsAreRegisteredOnce) {
+    uint32 first = gTickProfiler->registerSection("zone/world");
+    uint32 second = gTickProfiler->registerSection("zone/network");
+
+    EXPECT_NE(0u, first);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(first, gTickProfiler->registerSection("zone/world"));
+    EXPECT_EQ("zone/network", gTickProfiler->getSectionName(second));
+}
+
+TEST_F(TickProfilerTest, SectionZeroIsNotRecorded) {
+    {
+        ProfileScope scope(0);
+    }
+
+    EXPECT_EQ(0u, gTickProfiler->getSectionHistogram(0).getCount());
+}
+
+TEST_F(TickProfilerTest, SlowTickKeepsItsBreakdown) {
+    uint32 fast = gTickProfiler->registerSection("fast");
+    uint32 slow = gTickProfiler->registerSection("slow");
+
+    // below the 5ms threshold
+    gTickProfiler->beginTick();
+    {
+        ProfileScope scope(fast);
+    }
+    EXPECT_FALSE(gTickProfiler->endTick());
+    EXPECT_TRUE(gTickProfiler->getSlowTicks().empty());
+
+    gTickProfiler->beginTick();
+    {
+        ProfileScope scope(fast);
+    }
+    {
+        ProfileScope scope(slow);
+        boost::this_thread::sleep(boost::posix_time::milliseconds(8));
+    }
+    EXPECT_TRUE(gTickProfiler->endTick());
+
+    ASSERT_EQ(1u, gTickProfiler->getSlowTicks().size());
+    const TickProfiler::SlowTick& tick = gTickProfiler->getSlowTicks().back();
+
+    EXPECT_GE(tick.mDuration, 8000u);
+    ASSERT_EQ(2u, tick.mSections.size());
+    EXPECT_EQ(slow, tick.mSections[0].first);
+    EXPECT_GE(tick.mSections[0].second, 8000u);
+    EXPECT_EQ(fast, tick.mSections[1].first);
+
+    EXPECT_EQ(2u, gTickProfiler->getSectionHistogram(fast).getCount());
+    EXPECT_EQ(2u, gTickProfiler->getTickHistogram().getCount());
+
+    std::ostringstream out;
+    gTickProfiler->printSlowTick(out, tick);
+    EXPECT_NE(std::string::npos, out.str().find("slow="));
+}
+
+TEST_F(TickProfilerTest, SchedulerTasksAreGroupedByMethod) {
+    Scheduler scheduler;
+    scheduler.setProfileSection(gTickProfiler->registerSection("scheduler/test"));
+
+    TaskTarget first, second;
+
+    // same method on two targets, and a second method
+    scheduler.addTask(fastdelegate::MakeDelegate(&first, &TaskTarget::Sleep), 1, 1, reinterpret_cast<void*>(2));
+    scheduler.addTask(fastdelegate::MakeDelegate(&second, &TaskTarget::Sleep), 1, 1, reinterpret_cast<void*>(2));
+    scheduler.addTask(fastdelegate::MakeDelegate(&first, &TaskTarget::Noop), 1, 1, NULL);
+
+    // scheduler section plus one per method
+    EXPECT_EQ(3u, gTickProfiler->getSectionCount());
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+
+    gTickProfiler->beginTick();
+    scheduler.process();
+    gTickProfiler->endTick();
+
+    uint32 sleep_count = 0;
+    uint32 noop_count = 0;
+    for (uint32 section = 2; section <= gTickProfiler->getSectionCount(); ++section) {
+        const LatencyHistogram& histogram = gTickProfiler->getSectionHistogram(section);
+        if (histogram.getMin() >= 2000) {
+            sleep_count += static_cast<uint32>(histogram.getCount());
+        } else {
+            noop_count += static_cast<uint32>(histogram.getCount());
+        }
+    }
+
+    EXPECT_EQ(2u, sleep_count);
+    EXPECT_EQ(1u, noop_count);
+    EXPECT_EQ(1u, gTickProfiler->getSectionHistogram(1).getCount());
+    EXPECT_GE(gTickProfiler->getSectionHistogram(1).getMax(), 4000u);
+
+    std::ostringstream report;
+    gTickProfiler->printReport(report);
+    EXPECT_NE(std::string::npos, report.str().find("scheduler/test/"));
+}
+
+// What the always on instrumentation costs per timed section.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(TickProfilerTest, DISABLED_BenchmarkScopeOverhead) {
+    const uint32_t iterations = 1000000;
+    uint32 section = gTickProfiler->registerSection("bench");
+
+    uint64 start = TickProfiler::getMicroseconds();
+    gTickProfiler->beginTick();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        ProfileScope scope(section);
+    }
+    gTickProfiler->endTick();
+    uint64 elapsed = TickProfiler::getMicroseconds() - start;
+
+    std::cout << "ProfileScope: " << elapsed * 1000.0 / iterations << " ns per scope" << std::endl;
+
+    EXPECT_EQ(iterations, gTickProfiler->getSectionHistogram(section).getCount());
+}
+
+}  // namespace
@@ -79,6 +79,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_PLATFORM ANH_PLATFORM_LINUX
 #endif
 
+//=====================================================================================
+//
+// Cache prefetch hint for data that is about to be read
+//
+#if ANH_COMPILER == ANH_COMPILER_MSVC
+#include <xmmintrin.h>
+#define ANH_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define ANH_PREFETCH(address) __builtin_prefetch(address)
+#endif
+
 //=====================================================================================
 //
 // Common definitions
@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Inventory.h"
 #include "LairObject.h"
 #include "MessageLib/MessageLib.h"
+#include "NavigationManager.h"
 #include "NpcManager.h"
 #include "PlayerObject.h"
 #include "QuadTree.h"
@@ -63,6 +64,8 @@ AttackableCreature::AttackableCreature(uint64 templateId)
     , mReadyDelay(0)
     , mCombatTimer(0)
     , mRoamingSteps(-1)
+    , mRouteLeg(0)
+    , mRoutePending(false)
     , mAssistanceNeededWithId(0)
     , mAssistedTargetId(0)
     , mLairNeedAssistanceWithId(0)
@@ -337,6 +340,104 @@ void AttackableCreature::addKnownObject(Object* object)
 }
 
 
+//=============================================================================
+//
+//	Range precompute of an ai pass, runs in parallel with other npc's.
+//	Evaluates the range checks the state machine is about to make against the
+//	current world, without changing anything.
+//	Target selection itself is left to handleState, see NpcJobSystem.
+//
+
+void AttackableCreature::precomputeRanges(void)
+{
+    mPerception.begin(mPosition, getParentId());
+
+    if (this->isDead() || !this->isSpawned())
+    {
+        return;
+    }
+
+    for (uint32 range = 0; range < NpcPerception::Range_Count; ++range)
+    {
+        mPerception.setRadius((NpcPerception::Range)range, _rangeRadius((NpcPerception::Range)range));
+    }
+
+    PlayerObjectSet::iterator playerIt = mKnownPlayers.begin();
+    while (playerIt != mKnownPlayers.end())
+    {
+        uint64 playerId = (*playerIt)->getId();
+
+        mPerception.add(playerId, NpcPerception::Range_Attack, _computeTargetInRange(playerId, NpcPerception::Range_Attack));
+        mPerception.add(playerId, NpcPerception::Range_Warning, _computeTargetInRange(playerId, NpcPerception::Range_Warning));
+        mPerception.add(playerId, NpcPerception::Range_Home, _computeTargetInRange(playerId, NpcPerception::Range_Home));
+        ++playerIt;
+    }
+
+    ObjectIDList::iterator defenderIt = mDefenders.begin();
+    while (defenderIt != mDefenders.end())
+    {
+        mPerception.add(*defenderIt, NpcPerception::Range_Weapon, _computeTargetInRange(*defenderIt, NpcPerception::Range_Weapon));
+        mPerception.add(*defenderIt, NpcPerception::Range_Home, _computeTargetInRange(*defenderIt, NpcPerception::Range_Home));
+        mPerception.add(*defenderIt, NpcPerception::Range_Aggro, _computeTargetInRange(*defenderIt, NpcPerception::Range_Aggro));
+        ++defenderIt;
+    }
+
+    if (uint64 targetId = this->getTargetId())
+    {
+        mPerception.add(targetId, NpcPerception::Range_Weapon, _computeTargetInRange(targetId, NpcPerception::Range_Weapon));
+    }
+
+    mPerception.end();
+}
+
+//=============================================================================
+//
+//	Range check against a target, answered from the perception of this pass if possible.
+//
+
+bool AttackableCreature::_targetInRange(uint64 targetId, NpcPerception::Range range) const
+{
+    bool inRange;
+    if (mPerception.lookup(mPosition, getParentId(), targetId, range, _rangeRadius(range), inRange))
+    {
+        return inRange;
+    }
+    return _computeTargetInRange(targetId, range);
+}
+
+float AttackableCreature::_rangeRadius(NpcPerception::Range range) const
+{
+    switch (range)
+    {
+    case NpcPerception::Range_Attack:
+        return this->getAttackRange();
+    case NpcPerception::Range_Warning:
+        return this->getAttackWarningRange();
+    case NpcPerception::Range_Weapon:
+        return this->getWeaponMaxRange();
+    case NpcPerception::Range_Home:
+        return this->getStalkerDistanceMax() + this->getWeaponMaxRange();
+    case NpcPerception::Range_Aggro:
+        return this->getMaxAggroRange();
+    default:
+        return 0.0f;
+    }
+}
+
+bool AttackableCreature::_computeTargetInRange(uint64 targetId, NpcPerception::Range range) const
+{
+    if (range == NpcPerception::Range_Home)
+    {
+        // Measured from where we spawned, this version of objectsInRange expects the target to exist.
+        if (!gWorldManager->getObjectById(targetId))
+        {
+            return false;
+        }
+        return gWorldManager->objectsInRange(this->getHomePosition(), this->getCellIdForSpawn(), targetId, _rangeRadius(range));
+    }
+    return gWorldManager->objectsInRange(this->getId(), targetId, _rangeRadius(range));
+}
+
 //=============================================================================
 //
 //	Set new active target, if any in range.
@@ -382,7 +483,7 @@ bool AttackableCreature::setTargetInAttackRange(void)
 				*/
 				// Only test players not having aggro.
 
-				if ((!this->attackerHaveAggro((*it)->getId())) && gWorldManager->objectsInRange(this->getId(), (*it)->getId(), this->getAttackRange()))
+				if ((!this->attackerHaveAggro((*it)->getId())) && _targetInRange((*it)->getId(), NpcPerception::Range_Attack))
 				{
 					if (gWorldConfig->isInstance())
 					{
@@ -486,7 +587,7 @@ bool AttackableCreature::showWarningInRange(void)
                 // We only accepts new targets.
                 // if ((!this->getTarget() || ((*it) != this->getTarget())) &&
                 // 	(newTarget && gWorldManager->objectsInRange(this->getId(), (*it)->getId(), this->getAttackWarningRange())))
-                if (newTarget && gWorldManager->objectsInRange(this->getId(), (*it)->getId(), this->getAttackWarningRange()))
+                if (newTarget && _targetInRange((*it)->getId(), NpcPerception::Range_Warning))
                 {
                     if (!this->getTarget() || ((*it) != this->getTarget()))
                     {
@@ -550,7 +651,7 @@ bool AttackableCreature::setTargetDefenderWithinWeaponRange(void)
         {
             if (!defenderCreature->isIncapacitated() && !defenderCreature->isDead())
             {
-                if (gWorldManager->objectsInRange(this->getId(), *defenderIt, this->getWeaponMaxRange()))
+                if (_targetInRange(*defenderIt, NpcPerception::Range_Weapon))
                 {
                     // Do only attack objects that have build up enough aggro.
                     if (this->attackerHaveAggro(defenderCreature->getId()))
@@ -604,8 +705,7 @@ bool AttackableCreature::setTargetDefenderWithinMaxRange(void)
         {
             if (!defenderCreature->isIncapacitated() && !defenderCreature->isDead())
             {
-                if (gWorldManager->objectsInRange(this->getHomePosition(), this->getCellIdForSpawn(), *defenderIt,
-                                                  this->getStalkerDistanceMax() + this->getWeaponMaxRange()))
+                if (_targetInRange(*defenderIt, NpcPerception::Range_Home))
                 {
                     // Do only attack objects that have build up enough aggro.
                     if (this->attackerHaveAggro(defenderCreature->getId()))
@@ -639,8 +739,7 @@ bool AttackableCreature::isTargetWithinMaxRange(uint64 targetId)
     {
         if (!creature->isIncapacitated() && !creature->isDead())
         {
-            if (gWorldManager->objectsInRange(this->getHomePosition(), this->getCellIdForSpawn(), targetId,
-                                              this->getStalkerDistanceMax() + this->getWeaponMaxRange()))
+            if (_targetInRange(targetId, NpcPerception::Range_Home))
             {
                 foundTarget = true;
             }
@@ -694,7 +793,7 @@ uint64 AttackableCreature::getDefenderOutOfAggroRange(void)
             //if (!defenderCreature->isDead())
             //{
             if (defenderCreature->isIncapacitated() || defenderCreature->isDead() ||
-                    (!gWorldManager->objectsInRange(this->getId(), defenderCreature->getId(), this->getMaxAggroRange())))
+                    (!_targetInRange(defenderCreature->getId(), NpcPerception::Range_Aggro)))
             {
                 targetOutOfRange = defenderCreature->getId();
                 break;
@@ -712,7 +811,7 @@ bool AttackableCreature::isTargetWithinWeaponRange(void) const
     bool inRange = false;
     if (CreatureObject* targetCreature = dynamic_cast<CreatureObject*>(this->getTarget()))
     {
-        inRange = gWorldManager->objectsInRange(this->getId(), targetCreature->getId(), this->getWeaponMaxRange());
+        inRange = _targetInRange(targetCreature->getId(), NpcPerception::Range_Weapon);
     }
     /*
     if (inRange)
@@ -1319,6 +1418,12 @@ uint64 AttackableCreature::handleState(uint64 timeOverdue)
         // Are we supposed to do any roaming?
         if (this->isRoaming())
         {
+            // Waiting for a path search slot?
+            if (mRoutePending)
+            {
+                this->planRoute();
+            }
+
             // Yes, continue roaming
             int32 movementCounter = this->getRoamingSteps();
             if (movementCounter > 0)
@@ -1327,9 +1432,11 @@ uint64 AttackableCreature::handleState(uint64 timeOverdue)
                 movementCounter--;
                 if (movementCounter == 0)
                 {
-                    // Do the final move
-                    // this->mPosition = this->getDestination();
-                    this->updatePosition(this->getParentId(), this->getDestination());
+                    // Do the final move of this leg, continue with the next one if any.
+                    if (this->finishRouteLeg())
+                    {
+                        movementCounter = this->getRoamingSteps();
+                    }
                 }
                 else
                 {
@@ -1395,6 +1502,12 @@ uint64 AttackableCreature::handleState(uint64 timeOverdue)
 
         if (this->isHoming())
         {
+            // Waiting for a path search slot?
+            if (mRoutePending)
+            {
+                this->planRoute();
+            }
+
             // We are moving home, may still have defenders, but current target was out of range when we hit our max stalking range.
             int32 movementCounter = this->getRoamingSteps();
             if (movementCounter > 0)
@@ -1404,11 +1517,15 @@ uint64 AttackableCreature::handleState(uint64 timeOverdue)
                 movementCounter--;
                 if (movementCounter == 0)
                 {
-                    this->disableHoming();
-
-                    // Do the final move
-                    // this->mPosition = this->getDestination();
-                    this->updatePosition(this->getParentId(), this->getDestination());
+                    // Do the final move of this leg, we are home when there is no next one.
+                    if (this->finishRouteLeg())
+                    {
+                        movementCounter = this->getRoamingSteps();
+                    }
+                    else
+                    {
+                        this->disableHoming();
+                    }
                 }
                 else
                 {
@@ -1424,7 +1541,7 @@ uint64 AttackableCreature::handleState(uint64 timeOverdue)
                 }
                 this->setRoamingSteps(movementCounter);
             }
-            else
+            else if (!mRoutePending)
             {
                 this->disableHoming();
             }
@@ -1687,6 +1804,54 @@ void AttackableCreature::setupRoaming(int32 maxRangeX, int32 maxRangeZ)
         }
     }
 
+    // Walk there along a route around obstacles.
+    mRouteGoal = destination;
+    planRoute();
+}
+
+//=============================================================================
+//
+//	Search a route to mRouteGoal and start walking its first leg.
+//	Returns false if the search had to be deferred, we try again next tick.
+//
+
+bool AttackableCreature::planRoute(void)
+{
+    NavigationSearchResult result = gWorldManager->getNavigation()->findPath(getParentId(), mPosition, getParentId(), mRouteGoal, mRoute);
+
+    mRouteLeg = 0;
+    mRoutePending = (result == NavigationSearch_Deferred);
+
+    if (result == NavigationSearch_NoPath && isHoming())
+    {
+        // Never strand a homing npc away from its spawn, walk home the old straight way.
+        mRoute.clear();
+        mRoute.push_back(NavigationWaypoint(mRouteGoal, getParentId()));
+        result = NavigationSearch_Found;
+    }
+
+    if (result != NavigationSearch_Found || mRoute.empty())
+    {
+        // Stay where we are until the next roaming sequence.
+        mRoute.clear();
+        setDestination(mPosition);
+        setRoamingSteps(0);
+        return !mRoutePending;
+    }
+
+    setupRouteLeg();
+    return true;
+}
+
+//=============================================================================
+//
+//	Setup the movement towards the current waypoint of the route.
+//
+
+void AttackableCreature::setupRouteLeg(void)
+{
+    glm::vec3 destination = mRoute[mRouteLeg].position;
+
     setDestination(destination);
 
     // Update the direction of the npc in the world.
@@ -1706,6 +1871,9 @@ void AttackableCreature::setupRoaming(int32 maxRangeX, int32 maxRangeZ)
         steps = distanceToMove/getRoamingSpeed();
     }
 
+    // Every leg takes at least one update, the last one puts us on the waypoint.
+    steps = std::max(steps, 1.0f);
+
     float xOffset = (destination.x - mPosition.x) / steps;
     float yOffset = (destination.y - mPosition.y) / steps;
     float zOffset = (destination.z - mPosition.z) / steps;
@@ -1716,6 +1884,34 @@ void AttackableCreature::setupRoaming(int32 maxRangeX, int32 maxRangeZ)
     setPositionOffset(glm::vec3(xOffset, yOffset, zOffset));
 }
 
+//=============================================================================
+//
+//	Put us on the waypoint we walked to. Returns true if the next leg of
+//	the route has been set up.
+//
+
+bool AttackableCreature::finishRouteLeg(void)
+{
+    uint64 cellId = getParentId();
+    if (mRouteLeg < mRoute.size())
+    {
+        cellId = mRoute[mRouteLeg].cellId;
+    }
+
+    // this->mPosition = this->getDestination();
+    this->updatePosition(cellId, this->getDestination());
+
+    if (++mRouteLeg < mRoute.size())
+    {
+        setupRouteLeg();
+        return true;
+    }
+
+    mRoute.clear();
+    mRouteLeg = 0;
+    return false;
+}
+
 
 bool AttackableCreature::atStalkLimit() const
 {
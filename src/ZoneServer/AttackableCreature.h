@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_ZONESERVER_ATTACKABLECREATURE_H
 
 #include "NPCObject.h"
+#include "NavigationGrid.h"
 
 // #include "SpawnData.h"
 
@@ -80,6 +81,7 @@ public:
 
     virtual void	addKnownObject(Object* object);
 
+    virtual void	precomputeRanges(void);
     virtual void	handleEvents(void);
     virtual uint64	handleState(uint64 timeOverdue);
     virtual void	inPeace(void);
@@ -216,6 +218,10 @@ private:
     // Default constructor, should not be used.
     AttackableCreature();
 
+    bool	_targetInRange(uint64 targetId, NpcPerception::Range range) const;
+    float	_rangeRadius(NpcPerception::Range range) const;
+    bool	_computeTargetInRange(uint64 targetId, NpcPerception::Range range) const;
+
     bool	needAssist(void);
     void	executeAssist(void);
     bool	needToAssistLair(void);
@@ -225,6 +231,9 @@ private:
     // void	sendAttackersWeaponXp(PlayerObject* playerObject, uint32 weaponMask, int32 xp);
     // void	updateAttackersWeaponAndCombatXp(uint64 playerId, uint64 groupId, int32 damageDone, int32 weaponUsedMask);
     void	setupRoaming(int32 maxRangeX, int32 maxRangeZ);
+    bool	planRoute(void);
+    void	setupRouteLeg(void);
+    bool	finishRouteLeg(void);
     void	stalk(void);
     bool	atStalkLimit() const;
     bool	insideRoamingLimit() const;
@@ -427,6 +436,10 @@ private:
     int64							mReadyDelay;
     int64							mCombatTimer;
     int32		mRoamingSteps; 		// Number of updates before we are done roaming.
+    NavigationPath	mRoute;			// Waypoints towards mRouteGoal, mRouteLeg is the one we walk to.
+    glm::vec3	mRouteGoal;
+    uint32		mRouteLeg;
+    bool		mRoutePending;		// The route search was deferred to a later tick.
     uint64	mAssistanceNeededWithId;
     uint64	mAssistedTargetId;
     uint64	mLairNeedAssistanceWithId;
@@ -27,16 +27,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "BadgeRegion.h"
 #include "PlayerObject.h"
-#include "QTRegion.h"
-#include "QuadTree.h"
-#include "WorldManager.h"
-#include "ZoneTree.h"
 
 //=============================================================================
 
-BadgeRegion::BadgeRegion() : RegionObject(),
-    mSI(gWorldManager->getSI()),
-    mQTRegion(NULL)
+BadgeRegion::BadgeRegion() : RegionObject()
 {
     mActive		= true;
     mRegionType = Region_Badge;
@@ -49,43 +43,23 @@ BadgeRegion::~BadgeRegion()
 }
 
 //=============================================================================
-//every 2 secs were querying the si for players in our region
 
-void BadgeRegion::update()
+void BadgeRegion::onObjectEnter(Object* object)
 {
-    if(!mSubZoneId)
-    {
-        mQTRegion	= mSI->getQTRegion(mPosition.x, mPosition.z);
-        mSubZoneId	= (uint32)mQTRegion->getId();
-        mQueryRect	= Anh_Math::Rectangle(mPosition.x - mWidth, mPosition.z - mHeight, mWidth * 2, mHeight * 2);
-    }
+    PlayerObject* player = dynamic_cast<PlayerObject*>(object);
 
-    Object*		object;
-    ObjectSet	objList;
-
-    if(mParentId)
+    if(player && !(player->checkBadges(mBadgeId)))
     {
-        mSI->getObjectsInRange(this, &objList, ObjType_Player, mWidth);
-    }
-
-    if(mQTRegion)
-    {
-        mQTRegion->mTree->getObjectsInRange(this, &objList, ObjType_Player, &mQueryRect);
+        player->addBadge(mBadgeId);
     }
+}
 
-    ObjectSet::iterator objIt = objList.begin();
+//=============================================================================
 
-    while(objIt != objList.end())
-    {
-        object = *objIt;
+bool BadgeRegion::checkTrigger(const Object* object, const glm::vec3& position) const
+{
+    return (object->getParentId() == mParentId) && RegionObject::checkTrigger(object, position);
+}
 
-        if(object->getParentId() == mParentId)
-        {
-            PlayerObject* player = dynamic_cast<PlayerObject*>((*objIt));
+//=============================================================================
 
-            if(player && !(player->checkBadges(mBadgeId)))
-                player->addBadge(mBadgeId);
-        }
-        ++objIt;
-    }
-}
\ No newline at end of file
@@ -29,14 +29,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_ZONESERVER_BADGEREGION_H
 
 #include "RegionObject.h"
-#include "MathLib/Rectangle.h"
 #include "Utils/typedefs.h"
 
 //=============================================================================
 
-class ZoneTree;
 class PlayerObject;
-class QTRegion;
 
 //=============================================================================
 
@@ -56,14 +53,12 @@ public:
         mBadgeId = id;
     }
 
-    virtual void	update();
+    virtual void	onObjectEnter(Object* object);
+    virtual bool	checkTrigger(const Object* object, const glm::vec3& position) const;
 
 protected:
 
     uint32				mBadgeId;
-    ZoneTree*			mSI;
-    std::shared_ptr<QTRegion>   mQTRegion;
-    Anh_Math::Rectangle mQueryRect;
 };
 
 
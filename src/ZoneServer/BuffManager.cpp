@@ -277,6 +277,9 @@ bool BuffManager::SaveBuffsAsync(WMAsyncContainer* asyncContainer,DatabaseCallba
 
         playerObject->SetBuffAsyncCount(0);
 
+        //Remove all of them from the Process Queue
+        gWorldManager->removeBuffsToProcess(playerObject->getId());
+
         //count the calls necessary
         BuffList::iterator it = playerObject->GetBuffList()->begin();
         while(it != playerObject->GetBuffList()->end())
@@ -286,14 +289,12 @@ bool BuffManager::SaveBuffsAsync(WMAsyncContainer* asyncContainer,DatabaseCallba
             {
                 //TODO Check whether this is a buff that needs saving or just undoing or neither or both
 
-                gWorldManager->removeBuffToProcess((*it)->GetID());
-
                 //store the amount of async calls so we know when the last call finished
                 playerObject->IncBuffAsyncCount(); //this is the buff
 
                 playerObject->IncBuffAsyncCount(); //all attributes of a buff are stored in a single query
 
-                //Save to DB, and remove from the Process Queue
+                //Save to DB
                 if(AddBuffToDB(asyncContainer, callback, *it, currenttime))
                     buffCount++;
             }
@@ -309,6 +310,9 @@ void BuffManager::SaveBuffs(PlayerObject* playerObject, uint64 currenttime)
     //RemovedDeleted Buffs
     playerObject->CleanUpBuffs();
 
+    //Remove all of them from the Process Queue
+    gWorldManager->removeBuffsToProcess(playerObject->getId());
+
     BuffList::iterator it = playerObject->GetBuffList()->begin();
     while(it != playerObject->GetBuffList()->end())
     {
@@ -316,9 +320,8 @@ void BuffManager::SaveBuffs(PlayerObject* playerObject, uint64 currenttime)
         //Check if it is an active Buff
         if(!temp->GetIsMarkedForDeletion())
         {
-            //Save to DB, and remove from the Process Queue
+            //Save to DB
             AddBuffToDB(temp, currenttime);
-            gWorldManager->removeBuffToProcess(temp->GetID());
         }
 
         //Free up Memory
@@ -33,10 +33,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Camp.h"
 #include "PlayerObject.h"
-#include "QTRegion.h"
-#include "QuadTree.h"
 #include "WorldManager.h"
-#include "ZoneTree.h"
 
 //=============================================================================
 struct CampRegion::campLink
@@ -48,9 +45,7 @@ struct CampRegion::campLink
 
 //=============================================================================
 
-CampRegion::CampRegion() : RegionObject(),
-    mSI(gWorldManager->getSI()),
-    mQTRegion(NULL)
+CampRegion::CampRegion() : RegionObject()
 {
     mActive			= true;
     mDestroyed		= false;
@@ -105,31 +100,12 @@ void CampRegion::update()
         return;
     }
 
-    if(!mSubZoneId)
-    {
-        mQTRegion	= mSI->getQTRegion(mPosition.x,mPosition.z);
-        mSubZoneId	= (uint32)mQTRegion->getId();
-        mQueryRect	= Anh_Math::Rectangle(mPosition.x - mWidth,mPosition.z - mHeight,mWidth*2,mHeight*2);
-    }
+    // membership is maintained by the region triggers, we only tick our visitors
+    PlayerObjectSet::iterator objIt = mKnownPlayers.begin();
 
-    Object*		object;
-    ObjectSet	objList;
-
-    if(mParentId)
+    while(objIt != mKnownPlayers.end())
     {
-        mSI->getObjectsInRange(this,&objList,ObjType_Player,mWidth);
-    }
-
-    if(mQTRegion)
-    {
-        mQTRegion->mTree->getObjectsInRangeContains(this,&objList,ObjType_Player,&mQueryRect);
-    }
-
-    ObjectSet::iterator objIt = objList.begin();
-
-    while(objIt != objList.end())
-    {
-        object = (*objIt);
+        Object* object = (*objIt);
 
         //one xp per player in camp every 2 seconds
         if(!mAbandoned)
@@ -138,82 +114,31 @@ void CampRegion::update()
             mXp++;
         }
 
-        if(!(checkKnownObjects(object)))
-        {
-            onObjectEnter(object);
-
-            std::list<campLink*>::iterator i;
-            bool alreadyExists = false;
-
-            for(i = links.begin(); i != links.end(); i++)
-            {
-                if((*i)->objectID == object->getId())
-                {
-                    alreadyExists = true;
-                }
-            }
+        //Find the right link
+        std::list<campLink*>::iterator i;
 
-            if(!alreadyExists)
-            {
-                campLink* temp = new campLink;
-                temp->objectID = object->getId();
-                temp->lastSeenTime = gWorldManager->GetCurrentGlobalTick();
-                temp->tickCount = 0;
-
-                links.push_back(temp);
-            }
-        }
-        else
+        for(i = links.begin(); i != links.end(); i++)
         {
-            //Find the right link
-            std::list<campLink*>::iterator i;
-
-            for(i = links.begin(); i != links.end(); i++)
+            if((*i)->objectID == object->getId())
             {
-                if((*i)->objectID == object->getId())
-                {
-
-                    (*i)->lastSeenTime = gWorldManager->GetCurrentGlobalTick();
 
-                    if((*i)->tickCount == 15)
-                    {
-                        applyWoundHealing(object);
-                        (*i)->tickCount = 0;
-                    }
-                    else
-                        (*i)->tickCount++;
+                (*i)->lastSeenTime = gWorldManager->GetCurrentGlobalTick();
 
-                    break;
+                if((*i)->tickCount == 15)
+                {
+                    applyWoundHealing(object);
+                    (*i)->tickCount = 0;
                 }
-            }
-
+                else
+                    (*i)->tickCount++;
 
-            /*
-            //This code causes the Zone Server to print relational position and rotation info
-            //to allow the adding of items without much effort.
-            int8 text[256];
-            sprintf(text,"Position: mX=%f mY=%f mZ=%f\nDirection: mX=%f mY=%f mZ=%f mW=%f", (object->mPosition.x - this->mPosition.x), (object->mPosition.y - this->mPosition.y), (object->mPosition.z - this->mPosition.z), object->mDirection.x,object->mDirection.y,object->mDirection.z,object->mDirection.w);
-            */
+                break;
+            }
         }
 
         ++objIt;
     }
 
-    PlayerObjectSet oldKnownObjects = mKnownPlayers;
-    PlayerObjectSet::iterator objSetIt = oldKnownObjects.begin();
-
-    while(objSetIt != oldKnownObjects.end())
-    {
-        object = dynamic_cast<Object*>(*objSetIt);
-
-        if(objList.find(object) == objList.end())
-        {
-            onObjectLeave(object);
-        }
-
-        ++objSetIt;
-    }
-
     //prune the list
     std::list<campLink*>::iterator i = links.begin();
 
@@ -247,6 +172,27 @@ void CampRegion::onObjectEnter(Object* object)
         if(it == mVisitorSet.end())
             mVisitorSet.insert(object->getId());
 
+        std::list<campLink*>::iterator i;
+        bool alreadyExists = false;
+
+        for(i = links.begin(); i != links.end(); i++)
+        {
+            if((*i)->objectID == object->getId())
+            {
+                alreadyExists = true;
+            }
+        }
+
+        if(!alreadyExists)
+        {
+            campLink* temp = new campLink;
+            temp->objectID = object->getId();
+            temp->lastSeenTime = gWorldManager->GetCurrentGlobalTick();
+            temp->tickCount = 0;
+
+            links.push_back(temp);
+        }
+
         PlayerObject* owner = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(mOwnerId));
 
         if(owner && (owner->getId() != object->getId()))
@@ -302,6 +248,13 @@ void CampRegion::onObjectLeave(Object* object)
 
 //=============================================================================
 
+bool CampRegion::checkTrigger(const Object* object, const glm::vec3& position) const
+{
+    return (object->getParentId() == mParentId) && RegionObject::checkTrigger(object, position);
+}
+
+//=============================================================================
+
 
 void	CampRegion::despawnCamp()
 {
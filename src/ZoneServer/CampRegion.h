@@ -30,15 +30,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "RegionObject.h"
 #include "WorldManager.h"
-#include "MathLib/Rectangle.h"
 #include "Utils/typedefs.h"
 
 
 //=============================================================================
 
-class ZoneTree;
 class PlayerObject;
-class QTRegion;
 
 //=============================================================================
 
@@ -55,6 +52,7 @@ public:
     virtual void	update();
     virtual void	onObjectEnter(Object* object);
     virtual void	onObjectLeave(Object* object);
+    virtual bool	checkTrigger(const Object* object, const glm::vec3& position) const;
 
     void	setOwner(uint64 owner) {
         mOwnerId = owner;
@@ -117,9 +115,6 @@ public:
 
 protected:
 
-    ZoneTree*			mSI;
-    std::shared_ptr<QTRegion>   mQTRegion;
-    Anh_Math::Rectangle mQueryRect;
     uint64				mCampId;
     uint64				mOwnerId;
     bool				mAbandoned;
@@ -29,14 +29,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_ZONESERVER_CITY_H
 
 #include "RegionObject.h"
-#include "MathLib/Rectangle.h"
 #include "Utils/typedefs.h"
 
 //=============================================================================
 
-class ZoneTree;
 class PlayerObject;
-class QTRegion;
 
 //=============================================================================
 
@@ -56,16 +53,12 @@ public:
         mCityName = cityName;
     }
 
-    virtual void	update();
     virtual void	onObjectEnter(Object* object);
     virtual void	onObjectLeave(Object* object);
 
 protected:
 
     std::string			mCityName;
-    ZoneTree*			mSI;
-    std::shared_ptr<QTRegion>   mQTRegion;
-    Anh_Math::Rectangle mQueryRect;
 };
 
 
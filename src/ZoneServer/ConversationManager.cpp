@@ -56,7 +56,7 @@ ConversationManager::ConversationManager(Database* database) :
     mActiveConversationPool(sizeof(ActiveConversation)),
     mDBAsyncPool(sizeof(CVAsyncContainer))
 {
-    mDatabase->executeSqlAsync(this,new(mDBAsyncPool.malloc()) CVAsyncContainer(ConvQuery_Conversations),"SELECT id FROM conversations ORDER BY id");
+    mDatabase->executeStaticSqlAsync(this,new(mDBAsyncPool.malloc()) CVAsyncContainer(ConvQuery_Conversations),"SELECT id FROM conversations ORDER BY id");
     
 }
 
@@ -112,7 +112,7 @@ void ConversationManager::handleDatabaseJobComplete(void* ref, DatabaseResult* r
             asCont = new(mDBAsyncPool.malloc()) CVAsyncContainer(ConvQuery_Pages);
             asCont->mConversation = conv;
 
-            mDatabase->executeSqlAsync(this,asCont,"SELECT * FROM conversation_pages WHERE conversation_id=%u ORDER BY page", insertId);
+            mDatabase->executeStaticSqlAsync(this,asCont,"SELECT * FROM conversation_pages WHERE conversation_id=%u ORDER BY page", insertId);
             
         }
 
@@ -158,7 +158,7 @@ void ConversationManager::handleDatabaseJobComplete(void* ref, DatabaseResult* r
             asCont = new(mDBAsyncPool.malloc()) CVAsyncContainer(ConvQuery_Page_OptionBatch);
             asCont->mConversationPage = page;
 
-            mDatabase->executeSqlAsync(this,asCont,"SELECT conversation_options.id,conversation_options.customText,conversation_options.stf_file,"
+            mDatabase->executeStaticSqlAsync(this,asCont,"SELECT conversation_options.id,conversation_options.customText,conversation_options.stf_file,"
                                        "conversation_options.stf_variable,conversation_options.event,conversation_options.pageLink "
                                        "FROM "
                                        "conversation_option_batches "
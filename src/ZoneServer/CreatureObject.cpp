@@ -586,11 +586,13 @@ void CreatureObject::RemoveBuff(Buff* buff)
 //
 void CreatureObject::ClearAllBuffs()
 {
+    gWorldManager->removeBuffsToProcess(this->getId());
+
     BuffList::iterator it = mBuffList.begin();
     while(it != mBuffList.end())
     {
         (*it)->FinalChanges();
-        gWorldManager->removeBuffToProcess((*it)->GetID());
+        (*it)->SetID(0);
         (*it)->MarkForDeletion();
         ++it;
     }
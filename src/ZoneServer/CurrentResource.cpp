@@ -26,7 +26,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 #include "CurrentResource.h"
 #include "ResourceType.h"
-#include "Common/ConfigManager.h"
+#include "ZoneServer/noiseutils.h"
+
+#include <noise/noise.h>
 
 // Fix for issues with glog redefining this constant
 #ifdef _WIN32
@@ -35,6 +37,29 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+
+//=============================================================================
+
+static const uint32	kMapFileMagic		= 0x50414d52;	// "RMAP"
+static const uint32	kMapFileVersion		= 1;
+
+// the noise output is quantized over [-2,2], which leaves headroom for
+// octave sums above 1 before the harvest code clamps them
+static const float	kDistributionMin	= -2.0f;
+static const float	kDistributionRange	= 4.0f;
+static const float	kDistributionStep	= kDistributionRange / 65535.0f;
 
 //=============================================================================
 
@@ -53,64 +78,213 @@ CurrentResource::~CurrentResource()
 float CurrentResource::getDistribution(int x,int z)
 {
     // translates to 1:32
-    return mResourceDistributionMap.GetValue((x >> 6),(z >> 6));
+    x >>= 6;
+    z >>= 6;
+
+    // outside of the map, same as the old noise map border value
+    if(x < 0 || z < 0 || x >= (int)DistributionMapSize || z >= (int)DistributionMapSize || mDistributionMap.empty())
+        return(0.0f);
+
+    return(kDistributionMin + mDistributionMap[(z * DistributionMapSize) + x] * kDistributionStep);
 }
 
 //=============================================================================
+//
+//	fnv-1a over everything the generated map depends on
+//
 
-void CurrentResource::buildDistributionMap()
+uint32 CurrentResource::getNoiseSettingsHash()
 {
-    noise::utils::NoiseMapBuilderPlane	mapBuilder;
+    double settings[9] =
+    {
+        mNoiseMapBoundsX1,mNoiseMapBoundsX2,mNoiseMapBoundsY1,mNoiseMapBoundsY2,
+        (double)mNoiseMapOctaves,mNoiseMapFrequency,mNoiseMapPersistence,mNoiseMapScale,mNoiseMapBias
+    };
+
+    const uint8* data = reinterpret_cast<const uint8*>(settings);
+    uint32 hash = 2166136261u;
+
+    for(uint32 i = 0; i < sizeof(settings); i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    hash ^= DistributionMapSize;
+    hash *= 16777619u;
+
+    return(hash);
+}
+
+//=============================================================================
+//
+//	all noise modules are local, so several resources can be built at once
+//
+
+void CurrentResource::buildDistributionMap(const std::string& cacheDir)
+{
+    std::stringstream fileName;
+    fileName << cacheDir << "/" << mId << "_" << std::hex << getNoiseSettingsHash() << ".rmap";
+
+    if(_loadDistributionMap(fileName.str()))
+        return;
+
+    noise::module::Perlin				noiseModule;
     noise::module::ScaleBias			flattenModule;
+    noise::utils::NoiseMapBuilderPlane	mapBuilder;
+    noise::utils::NoiseMap				noiseMap;
+
+    noiseModule.SetPersistence(mNoiseMapPersistence);
+    noiseModule.SetOctaveCount(mNoiseMapOctaves);
+    noiseModule.SetFrequency(mNoiseMapFrequency);
 
-    flattenModule.SetSourceModule(0,mNoiseModule);
+    flattenModule.SetSourceModule(0,noiseModule);
     flattenModule.SetScale(mNoiseMapScale);
     flattenModule.SetBias(mNoiseMapBias);
 
-    _verifyNoiseSettings();
-
-    mNoiseModule.SetPersistence(mNoiseMapPersistence);
-    mNoiseModule.SetOctaveCount(mNoiseMapOctaves);
-    mNoiseModule.SetFrequency(mNoiseMapFrequency);
-
     mapBuilder.SetSourceModule(flattenModule);
-    mapBuilder.SetDestNoiseMap(mResourceDistributionMap);
+    mapBuilder.SetDestNoiseMap(noiseMap);
 
     // translates to 1:32
-    mapBuilder.SetDestSize(512,512);
+    mapBuilder.SetDestSize(DistributionMapSize,DistributionMapSize);
     mapBuilder.SetBounds(mNoiseMapBoundsX1,mNoiseMapBoundsX2,mNoiseMapBoundsY1,mNoiseMapBoundsY2);
-
-    LOG(INFO) << "Building DistributionMap for " << mName.getAnsi() << " " << mType->getName().getAnsi();
     mapBuilder.Build();
 
-    if(gConfig->read<int>("writeResourceMaps"))
+    mDistributionMap.resize(DistributionMapSize * DistributionMapSize);
+
+    for(uint32 z = 0; z < DistributionMapSize; z++)
     {
-        BString fileName = (int8*)(gConfig->read<std::string>("ZoneName")).c_str();
-        fileName << "_" << mName.getAnsi() << ".bmp";
-
-        LOG(INFO) << "Writing File " << fileName.getAnsi();
-
-        noise::utils::RendererImage renderer;
-        noise::utils::Image image;
-        renderer.SetSourceNoiseMap(mResourceDistributionMap);
-        renderer.SetDestImage(image);
-
-        renderer.ClearGradient();
-        renderer.AddGradientPoint(-1.0000,noise::utils::Color(0,0,0,255));
-        renderer.AddGradientPoint(-0.9999,noise::utils::Color(0,0,0,255));
-        renderer.AddGradientPoint(0.0000,noise::utils::Color(255,255,0,255));
-        renderer.AddGradientPoint(1.0000,noise::utils::Color(255,0,0,255));
-
-        renderer.EnableLight();
-        renderer.SetLightContrast(1.5);
-        renderer.SetLightBrightness(2.0);
-        renderer.Render();
-
-        noise::utils::WriterBMP writer;
-        writer.SetSourceImage(image);
-        writer.SetDestFilename(fileName.getAnsi());
-        writer.WriteDestFile();
+        for(uint32 x = 0; x < DistributionMapSize; x++)
+        {
+            float value = std::min(std::max(noiseMap.GetValue(x,z) - kDistributionMin,0.0f),kDistributionRange);
+            mDistributionMap[(z * DistributionMapSize) + x] = (uint16)floor((value / kDistributionStep) + 0.5f);
+        }
     }
+
+    _saveDistributionMap(fileName.str());
+}
+
+//=============================================================================
+
+bool CurrentResource::_loadDistributionMap(const std::string& fileName)
+{
+    FILE* mapFile = fopen(fileName.c_str(),"rb");
+    if(!mapFile)
+        return(false);
+
+    DistributionMapHeader header;
+    bool valid = (fread(&header,sizeof(header),1,mapFile) == 1)
+                 && (header.magic == kMapFileMagic)
+                 && (header.version == kMapFileVersion)
+                 && (header.resourceId == mId)
+                 && (header.settingsHash == getNoiseSettingsHash())
+                 && (header.size == DistributionMapSize);
+
+    if(valid)
+    {
+        mDistributionMap.resize(DistributionMapSize * DistributionMapSize);
+        valid = (fread(&mDistributionMap[0],sizeof(uint16),mDistributionMap.size(),mapFile) == mDistributionMap.size());
+    }
+
+    fclose(mapFile);
+
+    if(!valid)
+    {
+        LOG(WARNING) << "CurrentResource: cached distribution map [ " << fileName << " ] is invalid, rebuilding";
+        mDistributionMap.clear();
+    }
+
+    return(valid);
+}
+
+//=============================================================================
+//
+//	written to a temp file first, zones sharing the cache never see a partial map
+//
+
+bool CurrentResource::_saveDistributionMap(const std::string& fileName)
+{
+    DistributionMapHeader header;
+    header.magic		= kMapFileMagic;
+    header.version		= kMapFileVersion;
+    header.resourceId	= mId;
+    header.settingsHash	= getNoiseSettingsHash();
+    header.size			= DistributionMapSize;
+
+    std::stringstream tempFileName;
+#ifdef _WIN32
+    tempFileName << fileName << "." << _getpid() << ".tmp";
+#else
+    tempFileName << fileName << "." << getpid() << ".tmp";
+#endif
+
+    std::ofstream out(tempFileName.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!out)
+    {
+        LOG(WARNING) << "CurrentResource: unable to create [ " << tempFileName.str() << " ]";
+        return(false);
+    }
+
+    out.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    out.write(reinterpret_cast<const char*>(&mDistributionMap[0]),mDistributionMap.size() * sizeof(uint16));
+    out.close();
+
+    if(out.fail())
+    {
+        LOG(WARNING) << "CurrentResource: failed writing [ " << tempFileName.str() << " ]";
+        remove(tempFileName.str().c_str());
+        return(false);
+    }
+
+    remove(fileName.c_str());
+    if(rename(tempFileName.str().c_str(),fileName.c_str()) != 0)
+    {
+        LOG(WARNING) << "CurrentResource: unable to rename [ " << tempFileName.str() << " ]";
+        remove(tempFileName.str().c_str());
+        return(false);
+    }
+
+    return(true);
+}
+
+//=============================================================================
+
+void CurrentResource::writeDistributionImage(const std::string& fileName)
+{
+    noise::utils::NoiseMap noiseMap;
+    noiseMap.SetSize(DistributionMapSize,DistributionMapSize);
+
+    for(uint32 z = 0; z < DistributionMapSize; z++)
+    {
+        for(uint32 x = 0; x < DistributionMapSize; x++)
+        {
+            noiseMap.SetValue(x,z,getDistribution(x << 6,z << 6));
+        }
+    }
+
+    LOG(INFO) << "Writing File " << fileName;
+
+    noise::utils::RendererImage renderer;
+    noise::utils::Image image;
+    renderer.SetSourceNoiseMap(noiseMap);
+    renderer.SetDestImage(image);
+
+    renderer.ClearGradient();
+    renderer.AddGradientPoint(-1.0000,noise::utils::Color(0,0,0,255));
+    renderer.AddGradientPoint(-0.9999,noise::utils::Color(0,0,0,255));
+    renderer.AddGradientPoint(0.0000,noise::utils::Color(255,255,0,255));
+    renderer.AddGradientPoint(1.0000,noise::utils::Color(255,0,0,255));
+
+    renderer.EnableLight();
+    renderer.SetLightContrast(1.5);
+    renderer.SetLightBrightness(2.0);
+    renderer.Render();
+
+    noise::utils::WriterBMP writer;
+    writer.SetSourceImage(image);
+    writer.SetDestFilename(fileName);
+    writer.WriteDestFile();
 }
 
 //=============================================================================
@@ -30,11 +30,24 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/typedefs.h"
 #include "Resource.h"
-#include "ZoneServer/noiseutils.h"
-#include <noise/noise.h>
 #include <string>
+#include <vector>
 
 
+//=============================================================================
+//
+//	header of a cached distribution map, followed by the quantized samples
+//
+
+struct DistributionMapHeader
+{
+    uint32	magic;
+    uint32	version;
+    uint64	resourceId;
+    uint32	settingsHash;
+    uint32	size;
+};
+
 //=============================================================================
 
 class CurrentResource : public Resource
@@ -43,16 +56,26 @@ class CurrentResource : public Resource
 
 public:
 
+    // samples per side, one sample covers 64m
+    static const uint32	DistributionMapSize = 512;
+
     CurrentResource();
     ~CurrentResource();
 
-    void	buildDistributionMap();
+    // loads the map from cacheDir or builds and caches it, safe to run for
+    // different resources in parallel, the settings must be verified first
+    void	buildDistributionMap(const std::string& cacheDir);
+    void	writeDistributionImage(const std::string& fileName);
 
     float	getDistribution(int x,int z);
 
+    uint32	getNoiseSettingsHash();
+
 private:
 
     void	_verifyNoiseSettings();
+    bool	_loadDistributionMap(const std::string& fileName);
+    bool	_saveDistributionMap(const std::string& fileName);
 
     double	mNoiseMapBoundsX1,mNoiseMapBoundsX2;
     double	mNoiseMapBoundsY1,mNoiseMapBoundsY2;
@@ -64,8 +87,8 @@ private:
     uint64	mUnitsTotal;
     uint64	mUnitsLeft;
 
-    noise::module::Perlin	mNoiseModule;
-    noise::utils::NoiseMap	mResourceDistributionMap;
+    // quantized, row major, see getDistribution
+    std::vector<uint16>		mDistributionMap;
 };
 
 #endif
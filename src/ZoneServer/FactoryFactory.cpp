@@ -256,6 +256,12 @@ void FactoryFactory::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
             factory->addInternalAttribute(attribute.mKey,std::string(attribute.mValue.getAnsi()));
         }
 
+        // the maintenance pool is settled by the structure manager, it works on the regular attribute
+        if(factory->hasInternalAttribute("examine_maintenance"))
+        {
+            factory->addAttribute("examine_maintenance",factory->getInternalAttribute<std::string>("examine_maintenance"));
+        }
+
 
         QueryContainerBase* asContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(asyncContainer->mOfCallback,FFQuery_Hopper,asyncContainer->mClient);
         asContainer->mObject = factory;
@@ -363,8 +369,9 @@ void FactoryFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,u
     int8 sql[1024];
     sprintf(sql,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,"
             "std.type,std.object_string,std.stf_name, std.stf_file, s.name,"
-            "std.lots_used, f.active, std.maint_cost_wk, std.power_used, std.schematicMask, s.condition, std.max_condition, f.ManSchematicId "
+            "std.lots_used, f.active, std.maint_cost_wk, std.power_used, std.schematicMask, s.condition, std.max_condition, f.ManSchematicId, std.repair_cost, IFNULL(ss.settled_at,UNIX_TIMESTAMP()) "
             "FROM structures s INNER JOIN structure_type_data std ON (s.type = std.type) INNER JOIN factories f ON (s.id = f.id) "
+            "LEFT JOIN structure_settlement ss ON (ss.structure_id = s.id) "
             "WHERE (s.id = %"PRIu64")",id);
     QueryContainerBase* asynContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,FFQuery_MainData,client,id);
 
@@ -385,7 +392,7 @@ void FactoryFactory::upDateHopper(ObjectFactoryCallback* ofCallback,uint64 hoppe
 
 void FactoryFactory::_setupDatabindings()
 {
-    mFactoryBinding = mDatabase->createDataBinding(22);
+    mFactoryBinding = mDatabase->createDataBinding(24);
     mFactoryBinding->addField(DFT_uint64,offsetof(FactoryObject,mId),8,0);
     mFactoryBinding->addField(DFT_uint64,offsetof(FactoryObject,mOwner),8,1);
     mFactoryBinding->addField(DFT_float,offsetof(FactoryObject,mDirection.x),4,2);
@@ -412,6 +419,8 @@ void FactoryFactory::_setupDatabindings()
     mFactoryBinding->addField(DFT_uint32,offsetof(FactoryObject,mDamage),4,19);
     mFactoryBinding->addField(DFT_uint32,offsetof(FactoryObject,mMaxCondition),4,20);
     mFactoryBinding->addField(DFT_uint64,offsetof(FactoryObject,mManSchematicID),8,21);
+    mFactoryBinding->addField(DFT_uint32,offsetof(FactoryObject,mRepairCost),4,22);
+    mFactoryBinding->addField(DFT_uint64,offsetof(FactoryObject,mSettledAt),8,23);
 }
 
 //=============================================================================
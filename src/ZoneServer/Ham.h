@@ -64,6 +64,7 @@ class Ham
     friend class NonPersistentNpcFactory;
     friend class ShuttleFactory;
     friend class ObjectController;
+    friend class HamRegenerator;
 
 public:
 
@@ -128,7 +129,6 @@ public:
 
     void			calcAllModifiedHitPoints();
 
-    bool			regenerate(uint64 time,void*);
     uint64			getLastRegenTick() {
         return mLastRegenTick;
     }
@@ -188,11 +188,6 @@ public:
 
 private:
 
-    bool			_regenHealth();
-    bool			_regenAction();
-    bool			_regenMind();
-    bool			_regenForce();
-
     CreatureObject*	mParent;
 
     uint64			mLastRegenTick;
@@ -0,0 +1,258 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "HamRegenerator.h"
+
+#include "CreatureObject.h"
+#include "Ham.h"
+#include "PlayerObject.h"
+#include "MessageLib/MessageLib.h"
+
+//=============================================================================
+
+const uint32 HamRegenerator::kNoIndex;
+
+//=============================================================================
+
+HamRegenerator::HamRegenerator()
+    : mNextSerial(1)
+{
+}
+
+//=============================================================================
+
+HamRegenerator::~HamRegenerator()
+{
+}
+
+//=============================================================================
+
+uint64 HamRegenerator::add(Ham* ham)
+{
+    uint32 slot;
+
+    if(!mFreeSlots.empty())
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(mSlotIds.size());
+        mSlotIds.push_back(0);
+        mSlotIndex.push_back(kNoIndex);
+    }
+
+    uint64 id = (mNextSerial++ << 32) | (slot + 1);
+
+    mSlotIds[slot]		= id;
+    mSlotIndex[slot]	= static_cast<uint32>(mHams.size());
+
+    mHams.push_back(ham);
+    mSlots.push_back(slot);
+
+    return(id);
+}
+
+//=============================================================================
+
+void HamRegenerator::remove(uint64 id)
+{
+    if(!contains(id))
+        return;
+
+    _removeAt(mSlotIndex[static_cast<uint32>(id & 0xffffffff) - 1]);
+}
+
+//=============================================================================
+
+bool HamRegenerator::contains(uint64 id) const
+{
+    uint32 slot = static_cast<uint32>(id & 0xffffffff);
+
+    if(slot == 0 || slot > mSlotIds.size())
+        return(false);
+
+    return(mSlotIds[slot - 1] == id);
+}
+
+//=============================================================================
+
+void HamRegenerator::_removeAt(uint32 index)
+{
+    uint32 slot = mSlots[index];
+
+    mSlotIds[slot]		= 0;
+    mSlotIndex[slot]	= kNoIndex;
+    mFreeSlots.push_back(slot);
+
+    // keep the columns dense, the last entry takes the free place
+    uint32 last = static_cast<uint32>(mHams.size() - 1);
+
+    if(index != last)
+    {
+        mHams[index]				= mHams[last];
+        mSlots[index]				= mSlots[last];
+        mSlotIndex[mSlots[index]]	= index;
+    }
+
+    mHams.pop_back();
+    mSlots.pop_back();
+}
+
+//=============================================================================
+
+void HamRegenerator::process()
+{
+    if(mHams.empty())
+        return;
+
+    _gather();
+
+    uint32 count = static_cast<uint32>(mHams.size());
+
+    for(uint32 pool = 0; pool < RegenPool_Count; pool++)
+    {
+        regenerateColumn(&mCurrent[pool][0],&mMaximum[pool][0],&mRate[pool][0],&mNext[pool][0],count);
+    }
+
+    _apply();
+
+    // back to front, so swapping in the last entry does not skip anything
+    std::vector<uint32>::reverse_iterator it = mFinished.rbegin();
+
+    while(it != mFinished.rend())
+    {
+        _removeAt(*it);
+        ++it;
+    }
+
+    mFinished.clear();
+}
+
+//=============================================================================
+
+void HamRegenerator::_gather()
+{
+    uint32 count = static_cast<uint32>(mHams.size());
+
+    for(uint32 pool = 0; pool < RegenPool_Count; pool++)
+    {
+        mCurrent[pool].resize(count);
+        mMaximum[pool].resize(count);
+        mRate[pool].resize(count);
+        mNext[pool].resize(count);
+    }
+
+    for(uint32 i = 0; i < count; i++)
+    {
+        Ham* ham = mHams[i];
+
+        mCurrent[RegenPool_Health][i]	= ham->mHealth.getCurrentHitPoints();
+        mMaximum[RegenPool_Health][i]	= ham->mHealth.getModifiedHitPoints();
+        mRate[RegenPool_Health][i]		= ham->mHealthRegenRate;
+
+        mCurrent[RegenPool_Action][i]	= ham->mAction.getCurrentHitPoints();
+        mMaximum[RegenPool_Action][i]	= ham->mAction.getModifiedHitPoints();
+        mRate[RegenPool_Action][i]		= ham->mActionRegenRate;
+
+        mCurrent[RegenPool_Mind][i]		= ham->mMind.getCurrentHitPoints();
+        mMaximum[RegenPool_Mind][i]		= ham->mMind.getModifiedHitPoints();
+        mRate[RegenPool_Mind][i]		= ham->mMindRegenRate;
+
+        mCurrent[RegenPool_Force][i]	= ham->mCurrentForce;
+        mMaximum[RegenPool_Force][i]	= ham->mMaxForce;
+        mRate[RegenPool_Force][i]		= ham->mForceRegenRate;
+    }
+}
+
+//=============================================================================
+//
+// write the new values back, send one delta per creature for the bars that moved
+//
+
+void HamRegenerator::_apply()
+{
+    uint32 count = static_cast<uint32>(mHams.size());
+
+    for(uint32 i = 0; i < count; i++)
+    {
+        Ham*	ham		= mHams[i];
+        uint16	bars	= 0;
+
+        if(mNext[RegenPool_Health][i] != mCurrent[RegenPool_Health][i])
+        {
+            ham->mHealth.setCurrentHitPoints(mNext[RegenPool_Health][i]);
+            bars |= (1 << HamBar_Health);
+        }
+        if(mNext[RegenPool_Action][i] != mCurrent[RegenPool_Action][i])
+        {
+            ham->mAction.setCurrentHitPoints(mNext[RegenPool_Action][i]);
+            bars |= (1 << HamBar_Action);
+        }
+        if(mNext[RegenPool_Mind][i] != mCurrent[RegenPool_Mind][i])
+        {
+            ham->mMind.setCurrentHitPoints(mNext[RegenPool_Mind][i]);
+            bars |= (1 << HamBar_Mind);
+        }
+
+        if(bars && ham->getParent())
+        {
+            gMessageLib->sendCurrentHitpointDeltasCreo6_Multi(ham->getParent(),bars);
+        }
+
+        if(mNext[RegenPool_Force][i] != mCurrent[RegenPool_Force][i])
+        {
+            ham->mCurrentForce = mNext[RegenPool_Force][i];
+
+            if(PlayerObject* player = dynamic_cast<PlayerObject*>(ham->getParent()))
+            {
+                gMessageLib->sendUpdateCurrentForce(player);
+            }
+        }
+
+        bool full = true;
+
+        for(uint32 pool = 0; pool < RegenPool_Count; pool++)
+        {
+            if(mNext[pool][i] < mMaximum[pool][i])
+            {
+                full = false;
+                break;
+            }
+        }
+
+        if(full)
+        {
+            ham->setTaskId(0);
+            mFinished.push_back(i);
+        }
+    }
+}
+
+//=============================================================================
+
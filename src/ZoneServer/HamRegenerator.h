@@ -0,0 +1,123 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_HAM_REGENERATOR_H
+#define ANH_ZONESERVER_HAM_REGENERATOR_H
+
+#include <vector>
+
+#include "Utils/typedefs.h"
+
+//=============================================================================
+
+class Ham;
+
+//=============================================================================
+//
+// Regenerates the pools of every creature that is below max in one pass per
+// regen tick, instead of one scheduler task per creature.
+//
+// The HamProperty values stay authoritative, combat and buffs write them all
+// over the place. Each tick the pools, max values and rates of all registered
+// hams are gathered into one column per pool, the columns run through a
+// branch free kernel the compiler can vectorize, and the results are written
+// back. Bars that changed go out as one delta per creature, hams that are
+// full again leave the batch.
+//
+
+class HamRegenerator
+{
+public:
+
+    HamRegenerator();
+    ~HamRegenerator();
+
+    // ids are never 0 and never repeat, so they can be kept as the hams task id
+    uint64	add(Ham* ham);
+    void	remove(uint64 id);
+    bool	contains(uint64 id) const;
+
+    // one regeneration tick for all registered hams
+    void	process();
+
+    uint32	getCount() const {
+        return(static_cast<uint32>(mHams.size()));
+    }
+
+    // next = min(current + rate, max) for every pool still below its max
+    static void	regenerateColumn(const int32* current, const int32* maximum, const int32* rate, int32* next, uint32 count)
+    {
+        for(uint32 i = 0; i < count; i++)
+        {
+            int32 grown		= current[i] + rate[i];
+            int32 capped	= (grown < maximum[i]) ? grown : maximum[i];
+
+            // a full (or overfull) pool is left alone, like HamProperty::updateCurrentHitpoints does
+            next[i] = (current[i] < maximum[i]) ? capped : current[i];
+        }
+    }
+
+private:
+
+    enum RegenPool
+    {
+        RegenPool_Health	= 0,
+        RegenPool_Action	= 1,
+        RegenPool_Mind		= 2,
+        RegenPool_Force		= 3,
+
+        RegenPool_Count		= 4
+    };
+
+    static const uint32 kNoIndex = 0xffffffff;
+
+    void	_gather();
+    void	_apply();
+    void	_removeAt(uint32 index);
+
+    // dense, one entry per regenerating ham
+    std::vector<Ham*>	mHams;
+    std::vector<uint32>	mSlots;
+
+    std::vector<int32>	mCurrent[RegenPool_Count];
+    std::vector<int32>	mMaximum[RegenPool_Count];
+    std::vector<int32>	mRate[RegenPool_Count];
+    std::vector<int32>	mNext[RegenPool_Count];
+
+    std::vector<uint32>	mFinished;
+
+    // sparse, maps the lower half of an id to the dense index
+    std::vector<uint64>	mSlotIds;
+    std::vector<uint32>	mSlotIndex;
+    std::vector<uint32>	mFreeSlots;
+    uint64				mNextSerial;
+};
+
+//=============================================================================
+
+#endif
+
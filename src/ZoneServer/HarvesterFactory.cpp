@@ -65,6 +65,12 @@ HarvesterFactory*	HarvesterFactory::Init(Database* database)
 
 HarvesterFactory::HarvesterFactory(Database* database) : FactoryBase(database)
 {
+    // the time a structure was last settled up to, written behind by the structure manager
+    DatabaseResult* result = mDatabase->executeSynchSql("CREATE TABLE IF NOT EXISTS structure_settlement ("
+                             " structure_id BIGINT(20) UNSIGNED NOT NULL,"
+                             " settled_at BIGINT(20) UNSIGNED NOT NULL,"
+                             " PRIMARY KEY (structure_id))");
+    mDatabase->destroyResult(result);
 
     _setupDatabindings();
 }
@@ -101,7 +107,7 @@ void HarvesterFactory::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
             binding->addField(DFT_float,offsetof(HarvesterHopperItem,Quantity),4,1);
 
             HResourceList*	hRList = harvester->getResourceList();
-            hRList->resize(hRList->size()+count);
+            hRList->reserve(hRList->size()+count);
 
             HarvesterHopperItem hopperTemp;
             for(uint64 i=0; i <count; i++)
@@ -140,6 +146,16 @@ void HarvesterFactory::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
             harvester->addInternalAttribute(attribute.mKey,std::string(attribute.mValue.getAnsi()));
         }
 
+        // the pools and specs the simulation works on are read from the regular attributes
+        const char* simulated[] = {"examine_power","examine_maintenance","examine_hoppersize","examine_extractionrate"};
+        for(uint32 i = 0; i < 4; i++)
+        {
+            if(harvester->hasInternalAttribute(simulated[i]))
+            {
+                harvester->addAttribute(simulated[i],harvester->getInternalAttribute<std::string>(simulated[i]));
+            }
+        }
+
         harvester->setLoadState(LoadState_Loaded);
 
         LOG(INFO) << "Loaded harvester with id [" << harvester->getId() << "]";
@@ -202,8 +218,9 @@ void HarvesterFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id
     //request the harvesters Data first
 
     int8 sql2[1024];
-    sprintf(sql2,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,std.type,std.object_string,std.stf_name, std.stf_file, s.name, std.lots_used, std.resource_Category, h.ResourceID, h.active, h.rate, std.maint_cost_wk, std.power_used, s.condition, std.max_condition, std.repair_cost "
+    sprintf(sql2,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,std.type,std.object_string,std.stf_name, std.stf_file, s.name, std.lots_used, std.resource_Category, h.ResourceID, h.active, h.rate, std.maint_cost_wk, std.power_used, s.condition, std.max_condition, std.repair_cost, IFNULL(ss.settled_at,UNIX_TIMESTAMP()) "
             "FROM structures s INNER JOIN structure_type_data std ON (s.type = std.type) INNER JOIN harvesters h ON (s.id = h.id) "
+            "LEFT JOIN structure_settlement ss ON (ss.structure_id = s.id) "
             "WHERE (s.id = %"PRIu64")",id);
     QueryContainerBase* asynContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,HFQuery_MainData,client,id);
 
@@ -216,7 +233,7 @@ void HarvesterFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id
 
 void HarvesterFactory::_setupDatabindings()
 {
-    mHarvesterBinding = mDatabase->createDataBinding(24);
+    mHarvesterBinding = mDatabase->createDataBinding(25);
     mHarvesterBinding->addField(DFT_uint64,offsetof(HarvesterObject,mId),8,0);
     mHarvesterBinding->addField(DFT_uint64,offsetof(HarvesterObject,mOwner),8,1);
     mHarvesterBinding->addField(DFT_float,offsetof(HarvesterObject,mDirection.x),4,2);
@@ -243,6 +260,7 @@ void HarvesterFactory::_setupDatabindings()
     mHarvesterBinding->addField(DFT_uint32,offsetof(HarvesterObject,mDamage),4,21);
     mHarvesterBinding->addField(DFT_uint32,offsetof(HarvesterObject,mMaxCondition),4,22);
     mHarvesterBinding->addField(DFT_uint32,offsetof(HarvesterObject,mRepairCost),4,23);
+    mHarvesterBinding->addField(DFT_uint64,offsetof(HarvesterObject,mSettledAt),8,24);
 
 }
 
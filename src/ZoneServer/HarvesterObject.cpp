@@ -37,10 +37,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "MessageLib/MessageLib.h"
 
 #include "DatabaseManager/Database.h"
-#include "DatabaseManager/DatabaseResult.h"
-#include "DatabaseManager/DataBinding.h"
 
-#include <cassert>
+#include <algorithm>
+#include <cmath>
 
 //=============================================================================
 
@@ -48,7 +47,10 @@ HarvesterObject::HarvesterObject() : PlayerStructure()
 {
     mType = ObjType_Structure;
     mCurrentExtractionRate = 0.0;
+    mActive = false;
 
+    mPowerCarry			= 0.0;
+    mExtracted			= 0.0;
 }
 
 //=============================================================================
@@ -61,7 +63,7 @@ HarvesterObject::~HarvesterObject()
 
 
 //=============================================================================
-// gets the spec extractionrate
+// checks whether the resource is in the hopper
 bool HarvesterObject::checkResourceList(uint64 id)
 {
 
@@ -79,6 +81,174 @@ bool HarvesterObject::checkResourceList(uint64 id)
 }
 
 
+//=============================================================================
+// amount of a resource in the hopper
+
+float HarvesterObject::getResourceAmount(uint64 id)
+{
+    HResourceList::iterator it = mResourceList.begin();
+    while (it != mResourceList.end())
+    {
+        if((*it).first == id)
+        {
+            return (*it).second;
+        }
+        it++;
+    }
+    return 0.0;
+}
+
+//=============================================================================
+// takes resources out of the hopper, an emptied entry is removed
+
+bool HarvesterObject::removeResource(uint64 id, float amount)
+{
+    HResourceList::iterator it = mResourceList.begin();
+    while (it != mResourceList.end())
+    {
+        if((*it).first == id)
+        {
+            if((*it).second < amount)
+            {
+                return false;
+            }
+
+            (*it).second -= amount;
+
+            if((*it).second < 1.0)
+            {
+                mResourceList.erase(it);
+            }
+            return true;
+        }
+        it++;
+    }
+    return false;
+}
+
+//=============================================================================
+// generators produce power and dont need any
+
+bool HarvesterObject::needsPower()
+{
+    return((mHarvesterFamily != HarvesterFamily_Fusion) && (mHarvesterFamily != HarvesterFamily_Solar) && (mHarvesterFamily != HarvesterFamily_Wind));
+}
+
+//=============================================================================
+//
+// maintenance is paid the whole time, power only while the harvester runs
+// the harvester runs until it is out of maintenance or power or its hopper
+// is full, maintenance that couldnt be paid turns into damage at the repair cost
+// power and maintenance rates are per hour, the extraction rate per minute
+//
+
+bool HarvesterObject::settle(uint64 now)
+{
+    if(now <= mSettledAt)
+    {
+        return false;
+    }
+
+    double elapsed	= static_cast<double>(now - mSettledAt);
+    uint32 damage	= mDamage;
+    mSettledAt		= now;
+
+    double runTime	= _settleMaintenance(elapsed);
+
+    if(!mActive)
+    {
+        return(damage != mDamage);
+    }
+
+    // power
+    double powerRate	= needsPower() ? (getPowerConsumption() / 3600.0) : 0.0;
+    double power		= getCurrentPower() + mPowerCarry;
+    if(powerRate > 0.0)
+    {
+        runTime = std::min(runTime, power / powerRate);
+    }
+
+    // hopper
+    double extractionRate = mCurrentResource ? (mCurrentExtractionRate / 60.0) : 0.0;
+    if(extractionRate > 0.0)
+    {
+        double space = std::max(static_cast<double>(getHopperSize() - getCurrentHopperSize()), 0.0);
+        runTime = std::min(runTime, space / extractionRate);
+
+        HResourceList::iterator it = mResourceList.begin();
+        while((it != mResourceList.end()) && ((*it).first != mCurrentResource))
+        {
+            it++;
+        }
+
+        if(it == mResourceList.end())
+        {
+            mResourceList.push_back(std::make_pair(mCurrentResource,0.0f));
+            it = mResourceList.end() - 1;
+        }
+
+        (*it).second += static_cast<float>(extractionRate * runTime);
+        mExtracted   += extractionRate * runTime;
+    }
+
+    if(powerRate > 0.0)
+    {
+        power = std::max(power - (powerRate * runTime), 0.0);
+        setCurrentPower(static_cast<uint32>(power));
+        mPowerCarry = power - floor(power);
+    }
+
+    if(runTime < elapsed)
+    {
+        mActive = false;
+        return true;
+    }
+
+    return(damage != mDamage);
+}
+
+//=============================================================================
+//
+// a running harvester stops when its power runs out or its hopper is full
+//
+
+uint64 HarvesterObject::getNextThreshold()
+{
+    uint64 next = PlayerStructure::getNextThreshold();
+
+    if(!mActive)
+    {
+        return next;
+    }
+
+    double powerRate = needsPower() ? (getPowerConsumption() / 3600.0) : 0.0;
+    if(powerRate > 0.0)
+    {
+        uint64 powerOut = mSettledAt + static_cast<uint64>(ceil((getCurrentPower() + mPowerCarry) / powerRate));
+        next = next ? std::min(next, powerOut) : powerOut;
+    }
+
+    double extractionRate = mCurrentResource ? (mCurrentExtractionRate / 60.0) : 0.0;
+    if(extractionRate > 0.0)
+    {
+        double space	= std::max(static_cast<double>(getHopperSize() - getCurrentHopperSize()), 0.0);
+        uint64 full		= mSettledAt + static_cast<uint64>(ceil(space / extractionRate));
+        next = next ? std::min(next, full) : full;
+    }
+
+    return next;
+}
+
+//=============================================================================
+
+uint32 HarvesterObject::takeExtracted()
+{
+    uint32 units = static_cast<uint32>(mExtracted);
+    mExtracted -= units;
+
+    return units;
+}
+
 //=============================================================================
 // gets the spec extractionrate
 
@@ -349,216 +519,3 @@ void HarvesterObject::createResourceContainer(uint64 resID, PlayerObject* player
 
 
 }
-
-void HarvesterObject::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
-{
-    StructureManagerAsyncContainer* asynContainer = (StructureManagerAsyncContainer*)ref;
-
-    switch(asynContainer->mQueryType)
-    {
-
-    case Structure_ResourceRetrieve:
-    {
-        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(asynContainer->mPlayerId));
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(asynContainer->mStructureId));
-
-        DataBinding* binding = gWorldManager->getDatabase()->createDataBinding(1);
-        binding->addField(DFT_uint32,0,4);
-
-        uint64 count;
-        uint32 error;
-        count = result->getRowCount();
-
-        if(!count)
-        {
-            assert(false && "HarvesterObject::handleDatabaseJobComplete Structure_ResourceRetrieve did not find any resources");
-            return;
-        }
-
-        result->getNextRow(binding,&error);
-        if(error > 0)
-        {
-            //mmh there was something fishy ... no changes db side
-            gMessageLib->sendResourceEmptyHopperResponse(harvester,player,error, asynContainer->command.b1, asynContainer->command.b2);
-            return;
-        }
-
-        createResourceContainer(asynContainer->command.ResourceId, player, asynContainer->command.Amount);
-
-
-        StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_ResourceDiscardUpdateHopper,player->getClient());
-        asyncContainer->mStructureId	= asynContainer->mStructureId;
-        asyncContainer->mPlayerId		= asynContainer->mPlayerId;
-        asyncContainer->command			= asynContainer->command;
-
-        gWorldManager->getDatabase()->executeSqlAsync(harvester,asyncContainer,"SELECT hr.resourceID, hr.quantity FROM harvester_resources hr WHERE hr.ID = '%"PRIu64"' ", harvester->getId());
-        
-
-    }
-    break;
-
-    case Structure_ResourceDiscard:
-    {
-        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(asynContainer->mPlayerId));
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(asynContainer->mStructureId));
-
-        DataBinding* binding = gWorldManager->getDatabase()->createDataBinding(1);
-        binding->addField(DFT_uint32,0,4);
-
-        uint64 count;
-        uint32 error;
-        count = result->getRowCount();
-
-        if(!count)
-        {
-            assert(false && "HarvesterObject::handleDatabaseJobComplete Structure_ResourceDiscard did not find resource");
-            return;
-        }
-
-        result->getNextRow(binding,&error);
-        if(result > 0)
-        {
-            //mmh there was something fishy ... no changes db side
-            gMessageLib->sendResourceEmptyHopperResponse(harvester,player,error, asynContainer->command.b1, asynContainer->command.b2);
-            return;
-        }
-
-        StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_ResourceDiscardUpdateHopper,player->getClient());
-        asyncContainer->mStructureId	= asynContainer->mStructureId;
-        asyncContainer->mPlayerId		= asynContainer->mPlayerId;
-        asyncContainer->command			= asyncContainer->command;
-
-        gWorldManager->getDatabase()->executeSqlAsync(harvester,asyncContainer,"SELECT hr.resourceID, hr.quantity FROM harvester_resources hr WHERE hr.ID = '%"PRIu64"' ",harvester->getId());
-        
-    }
-    break;
-
-    case Structure_ResourceDiscardUpdateHopper:
-    {
-        uint64 count = result->getRowCount();
-
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(asynContainer->mStructureId));
-        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(asynContainer->mPlayerId));
-
-        DataBinding* binding = gWorldManager->getDatabase()->createDataBinding(2);
-        binding->addField(DFT_uint64,offsetof(HarvesterHopperItem,ResourceID),8,0);
-        binding->addField(DFT_float,offsetof(HarvesterHopperItem,Quantity),4,1);
-
-        HResourceList*	hRList = harvester->getResourceList();
-
-        hRList->clear();
-
-        HarvesterHopperItem hopperTemp;
-        for(uint64 i=0; i <count; i++)
-        {
-            result->getNextRow(binding,&hopperTemp);
-            hRList->push_back(std::make_pair(hopperTemp.ResourceID,hopperTemp.Quantity));
-        }
-
-        //now send the update to the client
-        gMessageLib->SendHarvesterHopperUpdate(harvester,player);
-
-        gMessageLib->sendResourceEmptyHopperResponse(harvester,player,0, asynContainer->command.b2, asynContainer->command.b2);
-
-        gWorldManager->getDatabase()->destroyDataBinding(binding);
-
-    }
-    break;
-
-    case Structure_GetResourceData:
-    {
-        uint64 count = result->getRowCount();
-
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(asynContainer->mStructureId));
-        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(asynContainer->mPlayerId));
-
-        DataBinding* binding = gWorldManager->getDatabase()->createDataBinding(2);
-        binding->addField(DFT_uint64,offsetof(HarvesterHopperItem,ResourceID),8,0);
-        binding->addField(DFT_float,offsetof(HarvesterHopperItem,Quantity),4,1);
-
-        HResourceList*	hRList = harvester->getResourceList();
-
-        hRList->clear();
-
-        HarvesterHopperItem hopperTemp;
-        for(uint64 i=0; i <count; i++)
-        {
-            result->getNextRow(binding,&hopperTemp);
-            hRList->push_back(std::make_pair(hopperTemp.ResourceID,hopperTemp.Quantity));
-        }
-
-        //now send the update to the client
-        gMessageLib->sendHarvesterResourceData(harvester,player);
-        gMessageLib->sendBaselinesHINO_7(harvester,player);
-
-        gWorldManager->getDatabase()->destroyDataBinding(binding);
-
-    }
-    break;
-
-    //read in the current resource hoppers contents
-    case Structure_HopperUpdate:
-    {
-        uint64 count = result->getRowCount();
-
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(asynContainer->mStructureId));
-        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(asynContainer->mPlayerId));
-
-        DataBinding* binding = gWorldManager->getDatabase()->createDataBinding(2);
-        binding->addField(DFT_uint64,offsetof(HarvesterHopperItem,ResourceID),8,0);
-        binding->addField(DFT_float,offsetof(HarvesterHopperItem,Quantity),4,1);
-
-        HResourceList*	hRList = harvester->getResourceList();
-
-        hRList->clear();
-
-        HarvesterHopperItem hopperTemp;
-        for(uint64 i=0; i <count; i++)
-        {
-            result->getNextRow(binding,&hopperTemp);
-            hRList->push_back(std::make_pair(hopperTemp.ResourceID,hopperTemp.Quantity));
-        }
-
-        //now send the update to the client
-        gMessageLib->SendHarvesterHopperUpdate(harvester,player);
-
-        gWorldManager->getDatabase()->destroyDataBinding(binding);
-    }
-    break;
-
-    case Structure_HopperDiscard:
-    {
-        //PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(asynContainer->mStructureId));
-
-        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(asynContainer->mPlayerId));
-        if(!player)
-        {
-            return;
-        }
-
-        StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_HopperUpdate,player->getClient());
-
-        asyncContainer->mStructureId	= this->getId();
-        asyncContainer->mPlayerId		= player->getId();
-
-        int8 sql[250];
-        sprintf(sql,"SELECT hr.resourceID, hr.quantity FROM harvester_resources hr WHERE hr.ID = '%"PRIu64"' ",this->getId());
-
-        gWorldManager->getDatabase()->executeSqlAsync(this,asyncContainer,sql);
-        
-
-    }
-    break;
-
-
-    default:
-        break;
-
-    }
-
-    SAFE_DELETE(asynContainer);
-}
-
-
-
-
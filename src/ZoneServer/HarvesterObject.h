@@ -46,7 +46,13 @@ struct HarvesterHopperItem
     float			Quantity;
 };
 
-class HarvesterObject :	public PlayerStructure, public DatabaseCallback
+//=============================================================================
+//
+//	harvesters are simulated by the zone, extraction, power and maintenance
+//	are worked out from the time passed whenever the harvester is settled
+//
+
+class HarvesterObject :	public PlayerStructure
 {
     friend class HarvesterFactory;
 
@@ -55,7 +61,18 @@ public:
     HarvesterObject();
     ~HarvesterObject();
 
-    virtual void	handleDatabaseJobComplete(void* ref,DatabaseResult* result);
+    // brings hopper and power up to now along with the upkeep
+    // returns true if the harvester shut down or lost condition on the way
+    bool			settle(uint64 now);
+
+    // earliest of running out of maintenance or power and the hopper filling up
+    uint64			getNextThreshold();
+
+    // whole units extracted since the last call, they still have to leave the spawn
+    uint32			takeExtracted();
+
+    // generators run without power
+    bool			needsPower();
 
     HarvesterFamily	getHarvesterFamily() {
         return mHarvesterFamily;
@@ -124,6 +141,9 @@ public:
         mRListUpdateCounter = value;
     }
     bool			checkResourceList(uint64 id);
+    float			getResourceAmount(uint64 id);
+    // returns false if the hopper holds less than amount
+    bool			removeResource(uint64 id, float amount);
 
 
 private:
@@ -145,6 +165,9 @@ private:
     HResourceList	mResourceList;
     uint32			mRListUpdateCounter;
 
+    double			mPowerCarry;
+    double			mExtracted;
+
 };
 
 //=============================================================================
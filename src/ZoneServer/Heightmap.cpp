@@ -32,17 +32,33 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 
 #include <glog/logging.h>
+#include "Utils/EventLoop.h"
 #include "Utils/utils.h"
+#include "Utils/MathFunctions.h"
+#include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
 #include <cfloat>
+#include <cstdio>
+#include <fstream>
+#include <vector>
 #include "math.h"
+
+using namespace boost::interprocess;
+
 //=============================================================================
-Heightmap::Heightmap(const char* planet_name, uint16 resolution)
-    : mResolution(resolution)
-	, mHeightmapCache(nullptr)
-    , mCacheHeight(0)
-    , mCacheWidth(0)
-    , mCacheResoulutionDivider(3)
+
+static const uint32 kTileFileMagic		= 0x54504d48;	// "HMPT"
+static const uint32 kTileFileVersion	= 1;
+static const int32	kTileSize			= 64;
+static const uint16	kWaterBit			= 0x8000;
+
+//=============================================================================
+Heightmap::Heightmap(const char* planet_name, bool useTiles)
+    : mExit(false)
+    , mSamples(NULL)
+    , mTiled(false)
+    , mTilesPerRow(0)
     , WIDTH(15361)
     , HEIGHT(15361)
     , mReady(false)
@@ -50,12 +66,41 @@ Heightmap::Heightmap(const char* planet_name, uint16 resolution)
     mFilename = "heightmaps/";
     mFilename += planet_name;
     mFilename += ".hmpw";
-    Connect();
+
+    std::string tileFilename = mFilename.substr(0, mFilename.size() - 5) + ".hmpt";
+
+    bool mapped = false;
+
+    if (useTiles)
+    {
+        if (_checkTileFile(tileFilename) || _buildTileFile(tileFilename))
+        {
+            mapped = _mapFile(tileFilename, true);
+        }
+        else
+        {
+            LOG(WARNING) << "Heightmap: unable to use tiled heightmap [ " << tileFilename << " ], falling back to the raw file";
+        }
+    }
+
+    if (!mapped)
+    {
+        mapped = _mapFile(mFilename, false);
+    }
+
+    if (!mapped)
+    {
+        LOG(FATAL) << "Heightmap::Heightmap not found [ "<<mFilename.c_str()<<" ], exiting...";
+    }
+
+    mCacheAvaliable = mapped;
+
+    mReadyMutex.lock();
+    mReady = true;
+    mReadyMutex.unlock();
 
     boost::thread t(std::bind(&Heightmap::RunThread, this));
     mThread = boost::move(t);
-
-    mExit = false;
 }
 
 bool Heightmap::isReady()
@@ -82,19 +127,8 @@ Heightmap::~Heightmap()
     mThread.interrupt();
     mThread.join();
 
-    if(Open())
-    {
-        fclose(hmp);
-    }
-    if (mHeightmapCache)
-    {
-        for (int i = 0; i < mCacheHeight; i++)
-        {
-            delete [] mHeightmapCache[i];
-        }
-        delete [] mHeightmapCache;
-        mHeightmapCache = NULL;
-    }
+    mSamples = NULL;
+    mCacheAvaliable = false;
 
     mInstance = NULL;
 }
@@ -106,417 +140,353 @@ bool Heightmap::mCacheAvaliable = false;
 
 //======================================================================================================================
 
-Heightmap* Heightmap::Instance(uint16 resolution)
+Heightmap* Heightmap::Instance(bool useTiles)
 {
     if (!mInstance)
     {
-        mInstance = new Heightmap(gWorldManager->getPlanetNameThis(), resolution);
+        mInstance = new Heightmap(gWorldManager->getPlanetNameThis(), useTiles);
     }
     return mInstance;
 }
 
 //=============================================================================
-//	DO NOT AND I REPEAT DO NOT USE THIS FOR ---ANYTHING---
-//	EXCEPT FOR ONE TIME READS LIKE GETTING THE HEIGHT FOR
-//	PLAYER BUILDING PLACEMENT!!!
+//
+//	maps the given file read only, tiled files are validated against the
+//	expected dimensions
 //
 
-void Heightmap::fillInIterator(HeightResultMap::iterator it)
+bool Heightmap::_mapFile(const std::string& filename, bool tiled)
 {
-    if(!Open())
+    try
     {
-        Connect();
-        if(!Open())
-        {
-            DLOG(WARNING) << "Heightmap::ERROR: Unable to retrieve height. A connection to the zone heightmap was not established!";
-            return;
-        }
-    }
+        file_mapping mapping(filename.c_str(), read_only);
+        mapped_region region(mapping, read_only);
 
-    short height;
-    fseek(hmp,getOffset(it->first.first,it->first.second),SEEK_SET);
-    size_t result = fread(&height,2,1,hmp);
-    if (! result) {
-        DLOG(WARNING) << "Heightmap::ERROR: Unable to read height!";
-        return;
-    }
+        const unsigned char* data = static_cast<const unsigned char*>(region.get_address());
+        uint64 dataSize = region.get_size();
+
+        if (tiled)
+        {
+            const HeightmapTileHeader* header = reinterpret_cast<const HeightmapTileHeader*>(data);
+            int32 tilesPerRow = (WIDTH + kTileSize - 1) / kTileSize;
+
+            if ((dataSize < sizeof(HeightmapTileHeader))
+                    || (header->magic != kTileFileMagic)
+                    || (header->version != kTileFileVersion)
+                    || (header->width != WIDTH) || (header->height != HEIGHT)
+                    || (header->tileSize != kTileSize) || (header->tilesPerRow != tilesPerRow)
+                    || (dataSize < sizeof(HeightmapTileHeader) + (uint64)tilesPerRow * tilesPerRow * kTileSize * kTileSize * 2))
+            {
+                LOG(WARNING) << "Heightmap: tiled heightmap [ " << filename << " ] is invalid";
+                return false;
+            }
 
-    heightResult* heightRes = new heightResult;
+            mTilesPerRow = tilesPerRow;
+            data += sizeof(HeightmapTileHeader);
+        }
+        else if (dataSize < (uint64)WIDTH * HEIGHT * 2)
+        {
+            LOG(WARNING) << "Heightmap: heightmap [ " << filename << " ] is truncated";
+            return false;
+        }
 
-    if(height & 0x4000)//15th bit
-        heightRes->hasWater = true;
-    else
-        heightRes->hasWater = false;
+        mFileMapping.swap(mapping);
+        mMappedRegion.swap(region);
 
-    height &= 0x7FFF;
-    heightRes->height = ((float)height)/10;
+        mSamples	= reinterpret_cast<const uint16*>(data);
+        mTiled		= tiled;
+    }
+    catch (interprocess_exception& e)
+    {
+        LOG(WARNING) << "Heightmap: unable to map [ " << filename << " ]: " << e.what();
+        return false;
+    }
 
-    it->second = heightRes;
+    LOG(WARNING) << "Heightmap succesfully mapped [ " << filename << " ]";
+    return true;
 }
 
+//=============================================================================
+//
+//	a tiled file is usable if it was built from the current raw file
+//
 
-void Heightmap::RunThread()
+bool Heightmap::_checkTileFile(const std::string& tileFilename)
 {
-    // create a height-map cashe.
-    DLOG(WARNING) << "Height map resolution = " << mResolution;
-
-    DLOG(WARNING) << "Starting Heightmap Cache Creation. This might take a while!";
-    if (setupCache(mResolution))
-    {
-        DLOG(WARNING) << "Height map cache setup successfully with resolution " << mResolution;
-    }
-    else
+    struct stat rawStat;
+    if (stat(mFilename.c_str(), &rawStat) != 0)
     {
-        DLOG(WARNING) << "WorldManager::_handleLoadComplete heigthmap cache setup FAILED";
+        return false;
     }
 
-    mReadyMutex.lock();
-    mReady = true;
-    mReadyMutex.unlock();
-
-    while(!mExit)
+    FILE* tileFile = fopen(tileFilename.c_str(), "rb");
+    if (!tileFile)
     {
-        mJobMutex.lock();
-
-        HeightmapAsyncContainer* job;
-        if(Jobs.size() != 0)
-        {
-            job = Jobs.front();
-            Jobs.pop();
-        }
-        else
-            job = NULL;
-
-        mJobMutex.unlock();
+        return false;
+    }
 
-        if(job)
-        {
-            HeightResultMap* map = job->getResults();
-            for(HeightResultMap::iterator it=map->begin(); it != map->end(); it++)
-                fillInIterator(it);
+    HeightmapTileHeader header;
+    size_t result = fread(&header, sizeof(header), 1, tileFile);
+    fclose(tileFile);
 
-            job->getCallback()->heightMapCallback(job);
-        }
-        else
-        {
-            //We sleep if there is no work!
-            boost::this_thread::sleep(boost::posix_time::milliseconds(20));
-        }
-    }
-    LOG(WARNING) << "HeightMap Thread Down!";
+    return (result == 1)
+           && (header.magic == kTileFileMagic)
+           && (header.version == kTileFileVersion)
+           && (header.sourceSize == (uint64)rawStat.st_size)
+           && (header.sourceTime == (uint64)rawStat.st_mtime);
 }
 
-
 //=============================================================================
 //
-//	Dumps raw height variables. After recieving the data to get a proper height
-//	value one must make sure the water bit is 0, cast to a float, then divide by 10.
-//	see getHeight for an example how this is done.
+//	one time conversion of the row major .hmpw into 64x64 tiles, the edge
+//	samples are repeated to pad the last row and column of tiles
+//
 
-bool Heightmap::getRow(unsigned char* buffer, int32 x, int32 z, int32 length)
+bool Heightmap::_buildTileFile(const std::string& tileFilename)
 {
-    if ((x < -(WIDTH - 1)/2) || (x > (WIDTH- 1)/2))
+    struct stat rawStat;
+    if (stat(mFilename.c_str(), &rawStat) != 0)
     {
-        LOG(WARNING) << "Heightmap::ERROR: Invalid input: x out of range x = "<< x<< ",  -WIDTH/2 = "<< -WIDTH/2;
-        assert(false && "Heightmap::getRow x out of range");
         return false;
     }
-    if ((z < -(HEIGHT- 1)/2) || (z > (HEIGHT - 1)/2))
+
+    if (!_mapFile(mFilename, false))
     {
-        LOG(WARNING) << "Heightmap::ERROR: Invalid input: x out of range z = "<< z<< ",  -WIDTH/2 = "<< -WIDTH/2;
-        assert(false && "Heightmap::getRow z out of range");
         return false;
     }
-    if (length < 0)
+
+    LOG(WARNING) << "Heightmap: building tiled heightmap [ " << tileFilename << " ], this is only done once";
+
+    HeightmapTileHeader header;
+    header.magic		= kTileFileMagic;
+    header.version		= kTileFileVersion;
+    header.width		= WIDTH;
+    header.height		= HEIGHT;
+    header.tileSize		= kTileSize;
+    header.tilesPerRow	= (WIDTH + kTileSize - 1) / kTileSize;
+    header.sourceSize	= (uint64)rawStat.st_size;
+    header.sourceTime	= (uint64)rawStat.st_mtime;
+
+    std::string tempFilename = tileFilename + ".tmp";
+    std::ofstream out(tempFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!out)
     {
-        LOG(WARNING) << "Heightmap::ERROR: Invalid input: length is negative";
-        assert(false && "Heightmap::getRow length is negative");
+        LOG(WARNING) << "Heightmap: unable to create [ " << tempFilename << " ]";
         return false;
     }
-    if (length == 0)
-    {
-        // That's fine, we are done.
-        return true;
-    }
 
-    if(!Open())
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint16> tile(kTileSize * kTileSize);
+
+    for (int32 tileZ = 0; tileZ < header.tilesPerRow && out; tileZ++)
     {
-        Connect();
-        if(!Open())
+        for (int32 tileX = 0; tileX < header.tilesPerRow && out; tileX++)
         {
-            LOG(WARNING) << "Heightmap::ERROR: Unable to retrieve height data.";
-            assert(false && "Heightmap::getRow Missing heightmap, contact a SWG:ANH Developer for info.");
-            return false;
+            for (int32 z = 0; z < kTileSize; z++)
+            {
+                int32 row = std::min<int32>(tileZ * kTileSize + z, HEIGHT - 1);
+
+                for (int32 x = 0; x < kTileSize; x++)
+                {
+                    int32 column = std::min<int32>(tileX * kTileSize + x, WIDTH - 1);
+                    tile[z * kTileSize + x] = mSamples[(row * WIDTH) + column];
+                }
+            }
+
+            out.write(reinterpret_cast<const char*>(&tile[0]), tile.size() * sizeof(uint16));
         }
     }
-    int32 startOffset = 2 * (((HEIGHT/2 - z) * WIDTH) + (x + WIDTH/2));
-    int32 endOffset = startOffset + (2 * length);
 
-    if (endOffset > (int32)(2 * WIDTH * HEIGHT))
-    {
-        LOG(WARNING) << "Heightmap::ERROR: Invalid input: length out of range endOffset = " << endOffset << ", (2 * WIDTH * HEIGHT) = "<< (int32)(2 * WIDTH * HEIGHT);
-        assert(false && "Heightmap::getRow length out of range");
-        return false;
-    }
-    int32 len = (endOffset - startOffset);
-    if (len != (2 * length))
-    {
-        assert(false);
-    }
+    out.close();
+
+    // drop the raw mapping again, the tiled one replaces it
+    mSamples = NULL;
+    mapped_region().swap(mMappedRegion);
+    file_mapping().swap(mFileMapping);
 
-    if (fseek(hmp,startOffset,SEEK_SET) != 0)
+    if (out.fail())
     {
-        DLOG(WARNING) << "Heightmap::ERROR: File seek error";
-        assert(false);
+        LOG(WARNING) << "Heightmap: failed writing [ " << tempFilename << " ]";
+        remove(tempFilename.c_str());
         return false;
     }
 
-    int32 bytesRead = fread(buffer,1, len, hmp);
-    if (bytesRead != len)
+    remove(tileFilename.c_str());
+    if (rename(tempFilename.c_str(), tileFilename.c_str()) != 0)
     {
-        DLOG(WARNING) << "Heightmap::ERROR: File read error";
-        assert(false);
+        LOG(WARNING) << "Heightmap: unable to rename [ " << tempFilename << " ]";
+        remove(tempFilename.c_str());
         return false;
     }
+
     return true;
 }
 
 //=============================================================================
-//
-
-void Heightmap::Connect(void)
-{
-
-    hmp = fopen(mFilename.c_str(),"r+b");
-    if(!hmp)
-    {
-        LOG(FATAL) << "Heightmap::Heightmap not found [ "<<mFilename.c_str()<<" ], exiting...";
-    }
-    else
-    {
-        LOG(WARNING) << "Heightmap succesfully opened!";
-    }
-    return;
-}
 
 //=============================================================================
 //
-
-unsigned long Heightmap::getOffset(float x, float y) const
-{
-    unsigned int x_trans = round_coord(x) + (WIDTH>>1);
-    unsigned int y_trans = (HEIGHT>>1) - round_coord(y);
-    return (y_trans*WIDTH + x_trans)<<1;
-}
-
-//=============================================================================
+//	all points of the queued jobs are resolved as one batch, then the jobs are
+//	handed back to their callbacks in order
 //
 
-int32 Heightmap::round_coord(float coord) const
-{
-    return coord >= 0 ? (int32)(coord+0.5) : (int32)(coord-0.5);
-}
-
-
-static const int32 heightMapHeight = 15361;
-static const int32 heightMapWidth = 15361;
-
-bool Heightmap::setupCache(int16 cacheResoulutionDivider)
+void Heightmap::_processJobs(std::queue<HeightmapAsyncContainer*>& jobs)
 {
+    std::vector<HeightmapAsyncContainer*> batchJobs;
+    std::vector<float> x;
+    std::vector<float> z;
 
-    bool status = false;
-
-    // for test
-    float min = FLT_MAX;
-    float max = FLT_MIN;
-    int32 xPosMin = 0;
-    int32 zPosMin = 0;
-    int32 xPosMax = 0;
-    int32 zPosMax = 0;
-
-    if (mCacheAvaliable)
-    {
-        assert (false && "Heightmap::setupCache cache already setup");		// Should only be initialized once
-        return status;
-    }
-    if ((cacheResoulutionDivider < 0) || (cacheResoulutionDivider > 3))
-    {
-        // Invalid input.
-        assert(false && "Heightmap::setupCache invalid input");
-        return status;
-    }
-
-    if (cacheResoulutionDivider == 0)
-    {
-        // We do not want to use any cache.
-        return true;
-    }
-
-    mCacheResoulutionDivider = cacheResoulutionDivider;
-
-    mCacheHeight = ((heightMapHeight - 1)/mCacheResoulutionDivider) + 1;
-    mCacheWidth = ((heightMapWidth -1)/mCacheResoulutionDivider) + 1;
-
-    // static int32 cacheHeight = 7681;
-    // static int32 cacheWidth = 7681;
+    batchJobs.reserve(jobs.size());
 
-    // Allocate memory for the heightmap.
-    mHeightmapCache = new float*[mCacheHeight];
-    if (!mHeightmapCache)
+    while(!jobs.empty())
     {
-        assert (mHeightmapCache != NULL && "Heightmap::setupCache unable to allocate memory for heightmap");
-        return false;
-    }
+        HeightmapAsyncContainer* job = jobs.front();
+        jobs.pop();
 
-    for (int i = 0; i < mCacheWidth; i++)
-    {
-        mHeightmapCache[i] = new float[mCacheWidth];
-        if (!mHeightmapCache[i])
+        HeightResultMap* map = job->getResults();
+        for(HeightResultMap::iterator it=map->begin(); it != map->end(); it++)
         {
-            return false;
+            x.push_back(it->first.first);
+            z.push_back(it->first.second);
         }
+
+        batchJobs.push_back(job);
     }
 
-    // Allocate array for the temporarily data contained in one line.
-    uint16 *heightMapRow = NULL;
-    heightMapRow = new uint16[heightMapWidth];
-    if (!heightMapRow)
+    std::vector<float> heights(x.size());
+
+    if(!x.empty())
     {
-        assert (heightMapRow != NULL && "Heightmap::setupCache unable to allocate memory for heightmap row");
-        return false;
+        getHeights(&x[0], &z[0], &heights[0], x.size());
     }
 
-    int32 zPos = 0;
-    int32 xPos = 0;
-
-    // int64 noOfIgnored = 0;
+    uint32 index = 0;
 
-    // Let's read all height map data from file, and store some of it in memory.
-    // for (int32 heightMapLine = -(heightMapHeight/2); heightMapLine <= (heightMapHeight/2); heightMapLine += 2)
-    for (int32 heightMapLine = -(heightMapHeight/2); heightMapLine <= (heightMapHeight/2); heightMapLine += mCacheResoulutionDivider)
+    std::vector<HeightmapAsyncContainer*>::iterator jobIt = batchJobs.begin();
+    while(jobIt != batchJobs.end())
     {
-        status = getRow((unsigned char *)heightMapRow, -(heightMapWidth/2), heightMapLine, heightMapWidth);
-        if (status)
+        HeightResultMap* map = (*jobIt)->getResults();
+        for(HeightResultMap::iterator it=map->begin(); it != map->end(); it++, index++)
         {
-            xPos = 0;
-            for (int i = 0; i < heightMapWidth; i += mCacheResoulutionDivider)
-            {
-                if (heightMapRow[i] & 0x80000)
-                {
-                    DLOG(INFO) << "Found water, at position " << (-heightMapWidth/2) + i << " " << heightMapLine;
-                }
-
-                // Let's do this the right way, shall we? Pretend that we have a 15 bits signed value...
+            heightResult* heightRes = new heightResult;
 
-                // Remove the water bit.
-                uint16 unsignedFix = (heightMapRow[i] & 0x7FFF);
+            heightRes->height	= heights[index];
+            heightRes->hasWater	= hasWater(x[index], z[index]);
 
-                // Shift all bits to the left.
-                unsignedFix = unsignedFix << 1;
+            it->second = heightRes;
+        }
 
-                // Now make the data signed.
-                int16 signedFix = (int16)unsignedFix;
+        (*jobIt)->getCallback()->heightMapCallback(*jobIt);
+        ++jobIt;
+    }
 
-                // Convert it to float.
-                float value = (float)(signedFix);
+    if(Anh_Utils::EventLoop* loop = gEventLoop)
+        loop->wakeup();
+}
 
-                // Normalize data.
-                value = value/20;
 
-                // if ((x != 0) && (x != heightMapWidth - 1) && (z != 0) && (z != heightMapHeight - 1))
-                {
+void Heightmap::RunThread()
+{
+    std::queue<HeightmapAsyncContainer*> jobs;
 
-                    // float value = (float)(heightMapRow[x] & 0x7FFF)/10;
-                    if (value < min)
-                    {
-                        min = value;
-                        xPosMin = (-heightMapWidth/2) + i;
-                        zPosMin = heightMapLine;
-                    }
-
-                    /*
-                    if (value < -135)
-                    {
-                    	noOfIgnored++;
-                    }
-
-                    if (value > 431)
-                    {
-                    	noOfIgnored++;
-                    }
-                    */
-
-                    if (value > max)
-                    {
-                        max = value;
-                        xPosMax = (-heightMapWidth/2) + i;
-                        zPosMax = heightMapLine;
-                    }
-                }
+    while(!mExit)
+    {
+        mJobMutex.lock();
+        std::swap(jobs, Jobs);
+        mJobMutex.unlock();
 
-                mHeightmapCache[zPos][xPos] = value;
-                xPos++;
-                // heightMapCache[z][x/2] = (float)(heightMapRow[x] &= 0x7FFF)/10;
-            }
-            zPos++;
+        if(!jobs.empty())
+        {
+            _processJobs(jobs);
         }
         else
         {
-            // Not all zones support heightmaps
-            // assert(false);
+            //We sleep if there is no work!
+            boost::this_thread::sleep(boost::posix_time::milliseconds(20));
         }
     }
-    delete [] heightMapRow;
+    LOG(WARNING) << "HeightMap Thread Down!";
+}
 
-    mCacheAvaliable = status;
+//=============================================================================
+//
+//	Retrieve the bilinear interpolated height for a given 2D x,z position.
+//
 
-    if (status)
+float Heightmap::getHeight(float x, float z) const
+{
+    if (!mSamples)
     {
-        DLOG(INFO) << "Min height = " << min<<" at position "<< xPosMin << ","<< zPosMin;
-        DLOG(INFO) << "Min height = " << max<<" at position "<< xPosMax << ","<< zPosMax;
+        return FLT_MIN;
     }
-    return status;
+
+    int32 column, row;
+    float tx, tz;
+    _getCell(x, z, column, row, tx, tz);
+
+    return BilinearInterpolate(_decodeHeight(_getSample(column, row)),
+                               _decodeHeight(_getSample(column + 1, row)),
+                               _decodeHeight(_getSample(column, row + 1)),
+                               _decodeHeight(_getSample(column + 1, row + 1)),
+                               tx, tz);
 }
 
 //=============================================================================
 //
-//	Retrieve the height from the cache for a given 2D x,z position.
+//	Batched height lookup. The samples are gathered in chunks into separate
+//	corner arrays, so the interpolation itself runs vectorized.
 //
 
-float Heightmap::getCachedHeightAt2DPosition(float xPos, float zPos) const
+void Heightmap::getHeights(const float* x, const float* z, float* heights, uint32 count) const
 {
-    float yPos = FLT_MIN;
-    if (mCacheAvaliable)
+    if (!mSamples)
     {
-        int32 x = round_coord(xPos) + (heightMapHeight/2);
-        int32 z = round_coord(zPos) + (heightMapWidth/2);
-
-        yPos = mHeightmapCache[z/mCacheResoulutionDivider][x/mCacheResoulutionDivider];
+        std::fill(heights, heights + count, FLT_MIN);
+        return;
     }
-    return yPos;
-}
 
-float Heightmap::getHeight(float x, float y)
-{
-    if(!Open())
+    const uint32 kChunkSize = 256;
+
+    float h00[kChunkSize], h01[kChunkSize], h10[kChunkSize], h11[kChunkSize];
+    float tx[kChunkSize], tz[kChunkSize];
+
+    for (uint32 offset = 0; offset < count; offset += kChunkSize)
     {
-        Connect();
-        if(!Open())
+        uint32 chunk = std::min(kChunkSize, count - offset);
+
+        for (uint32 i = 0; i < chunk; i++)
         {
-            DLOG(WARNING) << "Heightmap::ERROR: Unable to retrieve height. A connection to the zone heightmap was not established!";
-            return FLT_MIN;
+            int32 column, row;
+            _getCell(x[offset + i], z[offset + i], column, row, tx[i], tz[i]);
+
+            h00[i] = _decodeHeight(_getSample(column, row));
+            h01[i] = _decodeHeight(_getSample(column + 1, row));
+            h10[i] = _decodeHeight(_getSample(column, row + 1));
+            h11[i] = _decodeHeight(_getSample(column + 1, row + 1));
         }
+
+        BilinearInterpolateBatch(h00, h01, h10, h11, tx, tz, heights + offset, chunk);
     }
+}
 
-    short height;
-    fseek(hmp,getOffset(x,y),SEEK_SET);
-    size_t result = fread(&height,2,1,hmp);
-    if (! result) {
-        DLOG(WARNING) << "Heightmap::ERROR: Unable to read height!";
-        return FLT_MIN;
+//=============================================================================
+
+bool Heightmap::hasWater(float x, float z) const
+{
+    if (!mSamples)
+    {
+        return false;
     }
-    height &= 0x7FFF;
-    return ((float)height)/10;
+
+    int32 column	= (int32)floor(x + 0.5f) + (WIDTH >> 1);
+    int32 row		= (HEIGHT >> 1) - (int32)floor(z + 0.5f);
+
+    column	= std::max<int32>(0, std::min<int32>(column, WIDTH - 1));
+    row		= std::max<int32>(0, std::min<int32>(row, HEIGHT - 1));
+
+    return (_getSample(column, row) & kWaterBit) != 0;
 }
 
 //=============================================================================
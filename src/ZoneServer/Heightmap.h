@@ -31,16 +31,44 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define     gHeightmap    Heightmap::getSingletonPtr()
 
 #include "Utils/typedefs.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include "HeightmapAsyncContainer.h"
 #include <queue>
 
+//=============================================================================
+//
+// The planets height samples are served straight from a read only memory
+// mapping, so all zone processes on a host share the same physical pages and
+// there is no cache to build at startup.
+//
+// Samples are 16 bit: the top bit flags water, the remaining 15 bits are a
+// signed height in 1/10 m. By default the raw .hmpw file is converted once into
+// a tiled .hmpt file (64x64 sample tiles) next to it, which keeps the 4 samples
+// of a bilinear lookup - and an npc's path - within the same page or two.
+//
+
+struct HeightmapTileHeader
+{
+    uint32	magic;
+    uint32	version;
+    int32	width;
+    int32	height;
+    int32	tileSize;
+    int32	tilesPerRow;
+    uint64	sourceSize;
+    uint64	sourceTime;
+};
+
 class Heightmap
 {
 
 public:
-    static Heightmap*  Instance(uint16 resolution);
+    static Heightmap*  Instance(bool useTiles = true);
     static Heightmap*  getSingletonPtr() {
         return mInstance;
     }
@@ -61,44 +89,70 @@ public:
 
     void RunThread();
 
-    void Connect();
     bool Open(void) {
-        if(hmp) return true;
-        else return false;
+        return (mSamples != NULL);
     }
-    bool setupCache(int16 cacheResoulutionDivider);
     static inline bool isHeightmapCacheAvaliable(void) {
         return mCacheAvaliable;
     }
+    // the mapping always holds the full 1m resolution
     inline bool isHighResCache(void) {
-        return (mCacheResoulutionDivider == 1);
+        return true;
     }
-    float getCachedHeightAt2DPosition(float xPos, float zPos) const;
-    float getHeight(float x, float y);
+    float getCachedHeightAt2DPosition(float xPos, float zPos) const {
+        return getHeight(xPos, zPos);
+    }
+    // bilinear interpolated height, FLT_MIN if no heightmap is available
+    float getHeight(float x, float z) const;
+    // batched getHeight, fills count heights for the given x/z arrays
+    void getHeights(const float* x, const float* z, float* heights, uint32 count) const;
+    bool hasWater(float x, float z) const;
     bool isReady();
     float compensateForInvalidHeightmap(float hmapRes, float clientRes, float allowedDeviation);//TODO: Re-evaluate need once heightmaps are corrected
 protected:
-    Heightmap(const char* planet_name, uint16 resolution);
+    Heightmap(const char* planet_name, bool useTiles);
     ~Heightmap();
 
 private:
     // This constructor prevents the default constructor to be used, since it is private.
     Heightmap();
 
+    void _processJobs(std::queue<HeightmapAsyncContainer*>& jobs);
+
+    // clamps a position to the cell it lies in and returns the fractions within it
+    inline void _getCell(float x, float z, int32& column, int32& row, float& tx, float& tz) const
+    {
+        // map space, column grows east, row grows south
+        float mapColumn	= x + (float)(WIDTH >> 1);
+        float mapRow	= (float)(HEIGHT >> 1) - z;
 
-    //DO NOT AND I REPEAT DO NOT USE THIS FOR ---ANYTHING---
-    //EXCEPT FOR ONE TIME READS LIKE GETTING THE HEIGHT FOR
-    //PLAYER BUILDING PLACEMENT!!!
-    void fillInIterator(HeightResultMap::iterator it);
+        column	= std::max<int32>(0, std::min<int32>((int32)floor(mapColumn), WIDTH - 2));
+        row		= std::max<int32>(0, std::min<int32>((int32)floor(mapRow), HEIGHT - 2));
 
-    //Dumps raw height variables. After recieving the data to get a proper height
-    //value one must make sure the water bit is 0, cast to a float, then divide by 10.
-    //see getHeight for an example how this is done.
-    bool getRow(unsigned char* buffer, int32 x, int32 y, int32 length);
+        tx = std::max(0.0f, std::min(mapColumn - (float)column, 1.0f));
+        tz = std::max(0.0f, std::min(mapRow - (float)row, 1.0f));
+    }
 
-    //DO NOT AND I REPEAT DO NOT USE THIS FOR ---ANYTHING---
-    //EXCEPT FOR ONE TIME READS LIKE GETTING THE HEIGHT FOR
-    //PLAYER BUILDING PLACEMENT!!!
+    bool _mapFile(const std::string& filename, bool tiled);
+    bool _buildTileFile(const std::string& tileFilename);
+    bool _checkTileFile(const std::string& tileFilename);
+
+    // row 0 is the northern edge, column 0 the western edge of the map
+    inline uint16 _getSample(int32 column, int32 row) const
+    {
+        if (mTiled)
+        {
+            uint32 tile = ((row >> 6) * mTilesPerRow) + (column >> 6);
+            return mSamples[(tile << 12) + ((row & 63) << 6) + (column & 63)];
+        }
+        return mSamples[(row * WIDTH) + column];
+    }
+
+    static inline float _decodeHeight(uint16 sample)
+    {
+        // strip the water bit and sign extend the remaining 15 bits
+        return ((float)((int16)(sample << 1))) / 20.0f;
+    }
 
     const char* getFilename() const {
         return mFilename.c_str();
@@ -108,27 +162,22 @@ private:
         mFilename = filename;
     }
 
-    unsigned long getOffset(float x, float y) const ;
-
-    int32 round_coord(float coord) const;
-
-    uint16  mResolution;
-    float	**mHeightmapCache;
-    int32	mCacheHeight;
-    int32	mCacheWidth;
-    int16	mCacheResoulutionDivider;
-
     static bool	mCacheAvaliable;
 
     boost::thread			    mThread;
     bool						  mExit;
 
+    boost::interprocess::file_mapping	mFileMapping;
+    boost::interprocess::mapped_region	mMappedRegion;
+    const uint16*						mSamples;
+    bool								mTiled;
+    int32								mTilesPerRow;
+
 protected:
 
     static Heightmap*  mInstance;
     // static bool        mInsFlag;
     std::string mFilename;
-    FILE * hmp; //file pointer to the highmap
 
     int32		WIDTH;
     int32   HEIGHT;
@@ -180,6 +180,12 @@ void HouseFactory::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
             house->addInternalAttribute(attribute.mKey,std::string(attribute.mValue.getAnsi()));
         }
 
+        // the maintenance pool is settled by the structure manager, it works on the regular attribute
+        if(house->hasInternalAttribute("examine_maintenance"))
+        {
+            house->addAttribute("examine_maintenance",house->getInternalAttribute<std::string>("examine_maintenance"));
+        }
+
         QueryContainerBase* asContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(asyncContainer->mOfCallback,HOFQuery_CellData,asyncContainer->mClient);
         asContainer->mObject = house;
 
@@ -249,8 +255,9 @@ void HouseFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uin
     int8 sql[1024];
     sprintf(sql,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z, "
             "std.type,std.object_string,std.stf_name, std.stf_file, s.name, "
-            "std.lots_used, h.private, std.maint_cost_wk, s.condition, std.max_condition, std.max_storage "
+            "std.lots_used, h.private, std.maint_cost_wk, s.condition, std.max_condition, std.max_storage, std.repair_cost, IFNULL(ss.settled_at,UNIX_TIMESTAMP()) "
             "FROM structures s INNER JOIN structure_type_data std ON (s.type = std.type) INNER JOIN houses h ON (s.id = h.id) "
+            "LEFT JOIN structure_settlement ss ON (ss.structure_id = s.id) "
             "WHERE (s.id = %"PRIu64")",id);
 
     QueryContainerBase* asynContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,HOFQuery_MainData,client,id);
@@ -263,7 +270,7 @@ void HouseFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uin
 
 void HouseFactory::_setupDatabindings()
 {
-    mHouseBinding = mDatabase->createDataBinding(20);
+    mHouseBinding = mDatabase->createDataBinding(22);
     mHouseBinding->addField(DFT_uint64,offsetof(HouseObject,mId),8,0);
     mHouseBinding->addField(DFT_uint64,offsetof(HouseObject,mOwner),8,1);
     mHouseBinding->addField(DFT_float,offsetof(HouseObject,mDirection.x),4,2);
@@ -286,6 +293,8 @@ void HouseFactory::_setupDatabindings()
     mHouseBinding->addField(DFT_uint32,offsetof(HouseObject,mDamage),4,17);
     mHouseBinding->addField(DFT_uint32,offsetof(HouseObject,mMaxCondition),4,18);
     mHouseBinding->addField(DFT_uint32,offsetof(HouseObject,mMaxStorage),4,19);
+    mHouseBinding->addField(DFT_uint32,offsetof(HouseObject,mRepairCost),4,20);
+    mHouseBinding->addField(DFT_uint64,offsetof(HouseObject,mSettledAt),8,21);
 
 }
 
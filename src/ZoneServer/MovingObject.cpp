@@ -31,6 +31,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "MovingObject.h"
 #include "PlayerObject.h"
 #include "QuadTree.h"
+#include "RegionTriggerGrid.h"
 #include "VehicleController.h"
 #include "WorldManager.h"
 #include "ZoneTree.h"
@@ -240,6 +241,8 @@ void MovingObject::updatePosition(uint64 parentId, const glm::vec3& newPosition)
 
         player->getController()->playerWorldUpdate(true);
 
+        gWorldManager->getRegionTriggers()->updateObject(player);
+
         //dismount us if we were moved inside
         if(player->checkIfMounted() && player->getMount() && parentId)
         {
@@ -46,7 +46,7 @@ public:
     virtual ~MovingObject();
 
     //NPC Player movement through server (warping, elevators)
-    void updatePosition(uint64 parentId, const glm::vec3& newPosition);
+    virtual void updatePosition(uint64 parentId, const glm::vec3& newPosition);
     void updatePositionInCell(uint64 parentId, const glm::vec3& newPosition);
     void updatePositionOutside(uint64 parentId, const glm::vec3& newPosition);
 
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "NPCObject.h"
+#include "NpcManager.h"
 
 #include "Heightmap.h"
 #include "CellObject.h"
@@ -71,6 +72,7 @@ NPCObject::NPCObject()
     , mLootGroupId(0)
     , mNpcTemplateId(0)
     , mRespawnDelay(0)
+    , mQueuedMove(0)
 {
     mType = ObjType_NPC;
     mCreoGroup = CreoGroup_PersistentNpc;
@@ -209,16 +211,29 @@ void NPCObject::moveAndUpdatePosition(void)
     }
     else
     {
-        // Testing to actually use a somewhat real height value.
+        // The position is taken right away, the height, the spatial index and the
+        // position update are done for all moving npc's at once at the end of the current handler pass.
         position.x += this->getPositionOffset().x;
         position.z += this->getPositionOffset().z;
-        position.y = gHeightmap->getCachedHeightAt2DPosition(position.x, position.z);
+        NpcManager::Instance()->queueMove(this, position);
+        return;
     }
     // send out position updates to known players
     this->updatePosition(this->getParentId(),position);
 
 }
 
+//=============================================================================
+//
+//	A direct move replaces the step queued in this pass.
+//
+
+void NPCObject::updatePosition(uint64 parentId, const glm::vec3& newPosition)
+{
+    NpcManager::Instance()->dropMove(this);
+    MovingObject::updatePosition(parentId, newPosition);
+}
+
 
 //=============================================================================
 //
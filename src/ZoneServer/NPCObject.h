@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "CreatureObject.h"
 #include "NPC_Enums.h"
+#include "NpcPerception.h"
 
 #define NPC_CHAT_SPAM_PROTECTION_TIME	10000
 
@@ -128,6 +129,12 @@ public:
     }
     virtual void	restorePosition(PlayerObject* player) {}
 
+    // range checks of an ai pass, read only, may run on a worker thread
+    virtual void	precomputeRanges(void) { }
+    void			clearPerception(void) {
+        mPerception.invalidate();
+    }
+
     virtual void	handleEvents(void) { }
     virtual uint64	handleState(uint64 timeOverdue) {
         return 0;
@@ -152,6 +159,17 @@ public:
 
     void			moveAndUpdatePosition(void);
 
+    // A step still queued with the NpcManager is dropped first, whoever moves the npc.
+    virtual void	updatePosition(uint64 parentId, const glm::vec3& newPosition);
+
+    // Slot+1 of the step queued with the NpcManager, 0 if none.
+    uint32			getQueuedMove(void) const {
+        return mQueuedMove;
+    }
+    void			setQueuedMove(uint32 slot) {
+        mQueuedMove = slot;
+    }
+
     uint64			getLastConversationTarget()const {
         return mLastConversationTarget;
     }
@@ -190,7 +208,7 @@ private:
 
 
 protected:
-    float	getAttackRange(void) {
+    float	getAttackRange(void) const {
         return mAttackRange;
     }
     void	setAttackRange(float attackRange) {
@@ -208,6 +226,8 @@ protected:
     uint64  mSpeciesId;
     uint32	mNpcFamily;
 
+    NpcPerception	mPerception;
+
 
 private:
 
@@ -231,6 +251,7 @@ private:
     uint64	mNpcTemplateId;
     uint64 mRespawnDelay;		// Delay before the object will respawn. Period time taken from time of destruction from world (not the same as when you "die").
     int32	mWeaponXp;
+    uint32	mQueuedMove;
 };
 
 //=============================================================================
@@ -0,0 +1,669 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "NavigationGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+#include "Heightmap.h"
+
+//=============================================================================
+
+static const float	kNavCellSize		= 8.0f;
+static const int32	kNavGridCells		= 2048;
+static const int32	kNavSectorCells		= 32;
+static const int32	kNavSectors			= kNavGridCells / kNavSectorCells;
+static const float	kNavGridOrigin		= -(kNavGridCells * kNavCellSize) / 2.0f;
+static const float	kNavMapHalfSize		= 7680.0f;
+
+enum NavigationSectorLink
+{
+    NavigationLink_East		= 0x01,
+    NavigationLink_West		= 0x02,
+    NavigationLink_North	= 0x04,
+    NavigationLink_South	= 0x08
+};
+
+typedef std::pair<float, int32>		NavigationOpenNode;
+typedef std::priority_queue<NavigationOpenNode, std::vector<NavigationOpenNode>, std::greater<NavigationOpenNode> >	NavigationOpenList;
+
+class NavigationNodeRecord
+{
+public:
+    NavigationNodeRecord() : cost(0.0f), parent(-1), closed(false) {}
+
+    float	cost;
+    int32	parent;
+    bool	closed;
+};
+
+//=============================================================================
+
+NavigationGrid::NavigationSector::NavigationSector()
+    : mTerrain(kNavSectorCells * kNavSectorCells, 1)
+    , mBlockers(kNavSectorCells * kNavSectorCells, 0)
+    , mTerrainBuilt(false)
+    , mLinksValid(false)
+    , mLinks(0)
+{
+}
+
+//=============================================================================
+
+NavigationGrid::NavigationGrid(float maxSlope)
+    : mSectors(kNavSectors * kNavSectors, reinterpret_cast<NavigationSector*>(0))
+    , mMaxSlope(maxSlope)
+    , mVersion(0)
+{
+}
+
+//=============================================================================
+
+NavigationGrid::~NavigationGrid()
+{
+    std::vector<NavigationSector*>::iterator it = mSectors.begin();
+    while(it != mSectors.end())
+    {
+        delete(*it);
+        ++it;
+    }
+    mSectors.clear();
+}
+
+//=============================================================================
+
+int32 NavigationGrid::getCellIndex(float x, float z) const
+{
+    int32 cellX = static_cast<int32>(floor((x - kNavGridOrigin) / kNavCellSize));
+    int32 cellZ = static_cast<int32>(floor((z - kNavGridOrigin) / kNavCellSize));
+
+    if(cellX < 0 || cellZ < 0 || cellX >= kNavGridCells || cellZ >= kNavGridCells)
+    {
+        return -1;
+    }
+
+    return (cellZ * kNavGridCells) + cellX;
+}
+
+//=============================================================================
+
+glm::vec3 NavigationGrid::_getCellCenter(int32 cellIndex) const
+{
+    return glm::vec3(kNavGridOrigin + ((cellIndex % kNavGridCells) + 0.5f) * kNavCellSize,
+                     0.0f,
+                     kNavGridOrigin + ((cellIndex / kNavGridCells) + 0.5f) * kNavCellSize);
+}
+
+//=============================================================================
+
+NavigationGrid::NavigationSector* NavigationGrid::_getSector(int32 sectorX, int32 sectorZ)
+{
+    NavigationSector*& sector = mSectors[(sectorZ * kNavSectors) + sectorX];
+
+    if(!sector)
+    {
+        sector = new NavigationSector();
+    }
+
+    if(!sector->mTerrainBuilt)
+    {
+        _buildTerrain(sector, sectorX, sectorZ);
+    }
+
+    return sector;
+}
+
+//=============================================================================
+//
+// a cell is walkable if no edge between its corners is steeper than mMaxSlope,
+// all corner heights of the sector are fetched as one batch
+//
+
+void NavigationGrid::_buildTerrain(NavigationSector* sector, int32 sectorX, int32 sectorZ)
+{
+    sector->mTerrainBuilt = true;
+
+    const int32 corners = kNavSectorCells + 1;
+
+    float originX = kNavGridOrigin + (sectorX * kNavSectorCells) * kNavCellSize;
+    float originZ = kNavGridOrigin + (sectorZ * kNavSectorCells) * kNavCellSize;
+
+    // off the map nothing is walkable
+    for(int32 z = 0; z < kNavSectorCells; ++z)
+    {
+        for(int32 x = 0; x < kNavSectorCells; ++x)
+        {
+            float centerX = originX + (x + 0.5f) * kNavCellSize;
+            float centerZ = originZ + (z + 0.5f) * kNavCellSize;
+
+            if(fabs(centerX) > kNavMapHalfSize || fabs(centerZ) > kNavMapHalfSize)
+            {
+                sector->mTerrain[(z * kNavSectorCells) + x] = 0;
+            }
+        }
+    }
+
+    // no heightmap (tutorial), the terrain is flat
+    if(!gHeightmap || !gHeightmap->Open())
+    {
+        return;
+    }
+
+    std::vector<float> cornerX(corners * corners);
+    std::vector<float> cornerZ(corners * corners);
+    std::vector<float> heights(corners * corners);
+
+    for(int32 z = 0; z < corners; ++z)
+    {
+        for(int32 x = 0; x < corners; ++x)
+        {
+            cornerX[(z * corners) + x] = originX + x * kNavCellSize;
+            cornerZ[(z * corners) + x] = originZ + z * kNavCellSize;
+        }
+    }
+
+    gHeightmap->getHeights(&cornerX[0], &cornerZ[0], &heights[0], corners * corners);
+
+    float maxRise = mMaxSlope * kNavCellSize;
+
+    for(int32 z = 0; z < kNavSectorCells; ++z)
+    {
+        for(int32 x = 0; x < kNavSectorCells; ++x)
+        {
+            float h00 = heights[(z * corners) + x];
+            float h01 = heights[(z * corners) + x + 1];
+            float h10 = heights[((z + 1) * corners) + x];
+            float h11 = heights[((z + 1) * corners) + x + 1];
+
+            float rise = std::max(std::max(fabs(h01 - h00), fabs(h10 - h00)), std::max(fabs(h11 - h01), fabs(h11 - h10)));
+
+            if(rise > maxRise)
+            {
+                sector->mTerrain[(z * kNavSectorCells) + x] = 0;
+            }
+        }
+    }
+}
+
+//=============================================================================
+
+bool NavigationGrid::_isCellWalkable(int32 cellX, int32 cellZ)
+{
+    if(cellX < 0 || cellZ < 0 || cellX >= kNavGridCells || cellZ >= kNavGridCells)
+    {
+        return false;
+    }
+
+    NavigationSector* sector = _getSector(cellX / kNavSectorCells, cellZ / kNavSectorCells);
+    int32 local = ((cellZ % kNavSectorCells) * kNavSectorCells) + (cellX % kNavSectorCells);
+
+    return sector->mTerrain[local] && !sector->mBlockers[local];
+}
+
+//=============================================================================
+
+bool NavigationGrid::isWalkable(float x, float z)
+{
+    int32 cell = getCellIndex(x, z);
+
+    if(cell < 0)
+    {
+        return false;
+    }
+
+    return _isCellWalkable(cell % kNavGridCells, cell / kNavGridCells);
+}
+
+//=============================================================================
+
+void NavigationGrid::addFootprint(float x, float z, float halfWidth, float halfLength)
+{
+    _markFootprint(x, z, halfWidth, halfLength, 1);
+}
+
+//=============================================================================
+
+void NavigationGrid::removeFootprint(float x, float z, float halfWidth, float halfLength)
+{
+    _markFootprint(x, z, halfWidth, halfLength, -1);
+}
+
+//=============================================================================
+//
+// every cell the rectangle overlaps is blocked, the affected sectors and their
+// neighbours have to recheck their borders
+//
+
+void NavigationGrid::_markFootprint(float x, float z, float halfWidth, float halfLength, int32 delta)
+{
+    int32 lowX	= std::max<int32>(0, static_cast<int32>(floor((x - halfWidth - kNavGridOrigin) / kNavCellSize)));
+    int32 lowZ	= std::max<int32>(0, static_cast<int32>(floor((z - halfLength - kNavGridOrigin) / kNavCellSize)));
+    int32 highX	= std::min<int32>(kNavGridCells - 1, static_cast<int32>(floor((x + halfWidth - kNavGridOrigin) / kNavCellSize)));
+    int32 highZ	= std::min<int32>(kNavGridCells - 1, static_cast<int32>(floor((z + halfLength - kNavGridOrigin) / kNavCellSize)));
+
+    for(int32 cellZ = lowZ; cellZ <= highZ; ++cellZ)
+    {
+        for(int32 cellX = lowX; cellX <= highX; ++cellX)
+        {
+            NavigationSector*& sector = mSectors[((cellZ / kNavSectorCells) * kNavSectors) + (cellX / kNavSectorCells)];
+
+            // the terrain is built lazily, the blockers are kept from the start
+            if(!sector)
+            {
+                sector = new NavigationSector();
+            }
+
+            uint8& blockers = sector->mBlockers[((cellZ % kNavSectorCells) * kNavSectorCells) + (cellX % kNavSectorCells)];
+            blockers = static_cast<uint8>(std::max<int32>(0, std::min<int32>(255, blockers + delta)));
+        }
+    }
+
+    for(int32 sectorZ = std::max<int32>(0, (lowZ / kNavSectorCells) - 1); sectorZ <= std::min<int32>(kNavSectors - 1, (highZ / kNavSectorCells) + 1); ++sectorZ)
+    {
+        for(int32 sectorX = std::max<int32>(0, (lowX / kNavSectorCells) - 1); sectorX <= std::min<int32>(kNavSectors - 1, (highX / kNavSectorCells) + 1); ++sectorX)
+        {
+            if(NavigationSector* sector = mSectors[(sectorZ * kNavSectors) + sectorX])
+            {
+                sector->mLinksValid = false;
+            }
+        }
+    }
+
+    ++mVersion;
+}
+
+//=============================================================================
+//
+// two sectors are linked if at least one pair of cells along their shared
+// border is walkable
+//
+
+uint8 NavigationGrid::_getSectorLinks(int32 sectorX, int32 sectorZ)
+{
+    NavigationSector* sector = _getSector(sectorX, sectorZ);
+
+    if(sector->mLinksValid)
+    {
+        return sector->mLinks;
+    }
+
+    int32 baseX = sectorX * kNavSectorCells;
+    int32 baseZ = sectorZ * kNavSectorCells;
+
+    uint8 links = 0;
+
+    for(int32 i = 0; i < kNavSectorCells; ++i)
+    {
+        if(!(links & NavigationLink_East) && _isCellWalkable(baseX + kNavSectorCells - 1, baseZ + i) && _isCellWalkable(baseX + kNavSectorCells, baseZ + i))
+            links |= NavigationLink_East;
+
+        if(!(links & NavigationLink_West) && _isCellWalkable(baseX, baseZ + i) && _isCellWalkable(baseX - 1, baseZ + i))
+            links |= NavigationLink_West;
+
+        if(!(links & NavigationLink_North) && _isCellWalkable(baseX + i, baseZ + kNavSectorCells - 1) && _isCellWalkable(baseX + i, baseZ + kNavSectorCells))
+            links |= NavigationLink_North;
+
+        if(!(links & NavigationLink_South) && _isCellWalkable(baseX + i, baseZ) && _isCellWalkable(baseX + i, baseZ - 1))
+            links |= NavigationLink_South;
+    }
+
+    sector->mLinks		= links;
+    sector->mLinksValid	= true;
+
+    return links;
+}
+
+//=============================================================================
+//
+// walks the line between the cell centers in half cell steps
+//
+
+bool NavigationGrid::_hasLineOfSight(int32 fromCell, int32 toCell)
+{
+    glm::vec3 from	= _getCellCenter(fromCell);
+    glm::vec3 to	= _getCellCenter(toCell);
+
+    float distance	= glm::distance(from, to);
+    int32 steps		= static_cast<int32>(ceil(distance / (kNavCellSize * 0.5f)));
+
+    for(int32 i = 1; i < steps; ++i)
+    {
+        float t = static_cast<float>(i) / steps;
+
+        int32 cell = getCellIndex(from.x + (to.x - from.x) * t, from.z + (to.z - from.z) * t);
+        if(cell < 0 || (cell != fromCell && !_isCellWalkable(cell % kNavGridCells, cell / kNavGridCells)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================
+
+NavigationSearchResult NavigationGrid::findPath(const glm::vec3& start, const glm::vec3& goal, NavigationPath& path, uint32& budget)
+{
+    path.clear();
+
+    int32 startCell	= getCellIndex(start.x, start.z);
+    int32 goalCell	= getCellIndex(goal.x, goal.z);
+
+    if(startCell < 0 || goalCell < 0 || !_isCellWalkable(goalCell % kNavGridCells, goalCell / kNavGridCells))
+    {
+        return NavigationSearch_NoPath;
+    }
+
+    std::vector<int32> cells;
+
+    // most roaming moves are short and unobstructed
+    if(startCell == goalCell || _hasLineOfSight(startCell, goalCell))
+    {
+        cells.push_back(startCell);
+        cells.push_back(goalCell);
+    }
+    else
+    {
+        int32 startSector	= ((startCell / kNavGridCells / kNavSectorCells) * kNavSectors) + ((startCell % kNavGridCells) / kNavSectorCells);
+        int32 goalSector	= ((goalCell / kNavGridCells / kNavSectorCells) * kNavSectors) + ((goalCell % kNavGridCells) / kNavSectorCells);
+
+        SectorCorridor corridor;
+
+        NavigationSearchResult result = _findCorridor(startSector, goalSector, corridor, budget);
+        if(result != NavigationSearch_Found)
+        {
+            return result;
+        }
+
+        result = _findCells(startCell, goalCell, corridor, cells, budget);
+
+        // the sector graph only knows borders are crossable, the cells behind
+        // them may still be cut off, give the search some room and try once more
+        if(result == NavigationSearch_NoPath)
+        {
+            SectorCorridor widened(corridor);
+
+            SectorCorridor::iterator it = corridor.begin();
+            while(it != corridor.end())
+            {
+                int32 sectorX = (*it) % kNavSectors;
+                int32 sectorZ = (*it) / kNavSectors;
+
+                for(int32 z = std::max<int32>(0, sectorZ - 1); z <= std::min<int32>(kNavSectors - 1, sectorZ + 1); ++z)
+                    for(int32 x = std::max<int32>(0, sectorX - 1); x <= std::min<int32>(kNavSectors - 1, sectorX + 1); ++x)
+                        widened.insert((z * kNavSectors) + x);
+
+                ++it;
+            }
+
+            result = _findCells(startCell, goalCell, widened, cells, budget);
+        }
+
+        if(result != NavigationSearch_Found)
+        {
+            return result;
+        }
+    }
+
+    // string pulling, keep only the cells that are needed to stay in sight
+    uint32 anchor = 0;
+    uint32 index = 1;
+
+    while(index < cells.size())
+    {
+        if(index + 1 < cells.size() && _hasLineOfSight(cells[anchor], cells[index + 1]))
+        {
+            ++index;
+            continue;
+        }
+
+        path.push_back(NavigationWaypoint(_getCellCenter(cells[index]), 0));
+        anchor = index;
+        ++index;
+    }
+
+    if(gHeightmap && gHeightmap->Open())
+    {
+        std::vector<float> x(path.size()), z(path.size()), heights(path.size());
+
+        for(uint32 i = 0; i < path.size(); ++i)
+        {
+            x[i] = path[i].position.x;
+            z[i] = path[i].position.z;
+        }
+
+        gHeightmap->getHeights(&x[0], &z[0], &heights[0], static_cast<uint32>(path.size()));
+
+        for(uint32 i = 0; i < path.size(); ++i)
+        {
+            path[i].position.y = heights[i];
+        }
+    }
+
+    return NavigationSearch_Found;
+}
+
+//=============================================================================
+//
+// A* over the sector graph, the corridor is the set of sectors on the result
+//
+
+NavigationSearchResult NavigationGrid::_findCorridor(int32 startSector, int32 goalSector, SectorCorridor& corridor, uint32& budget)
+{
+    corridor.clear();
+
+    if(startSector == goalSector)
+    {
+        corridor.insert(startSector);
+        return NavigationSearch_Found;
+    }
+
+    int32 goalX = goalSector % kNavSectors;
+    int32 goalZ = goalSector / kNavSectors;
+
+    std::unordered_map<int32, NavigationNodeRecord> nodes;
+    NavigationOpenList open;
+
+    nodes[startSector].cost = 0.0f;
+    open.push(NavigationOpenNode(0.0f, startSector));
+
+    while(!open.empty())
+    {
+        int32 current = open.top().second;
+        open.pop();
+
+        NavigationNodeRecord& record = nodes[current];
+        if(record.closed)
+        {
+            continue;
+        }
+        record.closed = true;
+
+        if(current == goalSector)
+        {
+            while(current != -1)
+            {
+                corridor.insert(current);
+                current = nodes[current].parent;
+            }
+            return NavigationSearch_Found;
+        }
+
+        if(budget == 0)
+        {
+            return NavigationSearch_Deferred;
+        }
+        --budget;
+
+        int32 sectorX	= current % kNavSectors;
+        int32 sectorZ	= current / kNavSectors;
+        uint8 links		= _getSectorLinks(sectorX, sectorZ);
+        float cost		= nodes[current].cost;
+
+        const int32 neighbours[4][3] =
+        {
+            { 1,  0, NavigationLink_East },
+            {-1,  0, NavigationLink_West },
+            { 0,  1, NavigationLink_North },
+            { 0, -1, NavigationLink_South }
+        };
+
+        for(uint32 i = 0; i < 4; ++i)
+        {
+            if(!(links & neighbours[i][2]))
+            {
+                continue;
+            }
+
+            int32 next = ((sectorZ + neighbours[i][1]) * kNavSectors) + sectorX + neighbours[i][0];
+
+            std::unordered_map<int32, NavigationNodeRecord>::iterator it = nodes.find(next);
+            if(it != nodes.end() && (it->second.closed || it->second.cost <= cost + 1.0f))
+            {
+                continue;
+            }
+
+            NavigationNodeRecord& nextRecord = nodes[next];
+            nextRecord.cost		= cost + 1.0f;
+            nextRecord.parent	= current;
+
+            float dx = static_cast<float>(goalX - (sectorX + neighbours[i][0]));
+            float dz = static_cast<float>(goalZ - (sectorZ + neighbours[i][1]));
+
+            open.push(NavigationOpenNode(nextRecord.cost + sqrt(dx * dx + dz * dz), next));
+        }
+    }
+
+    return NavigationSearch_NoPath;
+}
+
+//=============================================================================
+//
+// A* over the cells of the corridor, 8 way movement without cutting corners
+//
+
+NavigationSearchResult NavigationGrid::_findCells(int32 startCell, int32 goalCell, const SectorCorridor& corridor, std::vector<int32>& cells, uint32& budget)
+{
+    cells.clear();
+
+    int32 goalX = goalCell % kNavGridCells;
+    int32 goalZ = goalCell / kNavGridCells;
+
+    std::unordered_map<int32, NavigationNodeRecord> nodes;
+    NavigationOpenList open;
+
+    nodes[startCell].cost = 0.0f;
+    open.push(NavigationOpenNode(0.0f, startCell));
+
+    while(!open.empty())
+    {
+        int32 current = open.top().second;
+        open.pop();
+
+        NavigationNodeRecord& record = nodes[current];
+        if(record.closed)
+        {
+            continue;
+        }
+        record.closed = true;
+
+        if(current == goalCell)
+        {
+            while(current != -1)
+            {
+                cells.push_back(current);
+                current = nodes[current].parent;
+            }
+            std::reverse(cells.begin(), cells.end());
+            return NavigationSearch_Found;
+        }
+
+        if(budget == 0)
+        {
+            return NavigationSearch_Deferred;
+        }
+        --budget;
+
+        int32 cellX	= current % kNavGridCells;
+        int32 cellZ	= current / kNavGridCells;
+        float cost	= nodes[current].cost;
+
+        for(int32 dz = -1; dz <= 1; ++dz)
+        {
+            for(int32 dx = -1; dx <= 1; ++dx)
+            {
+                if(!dx && !dz)
+                {
+                    continue;
+                }
+
+                int32 nextX = cellX + dx;
+                int32 nextZ = cellZ + dz;
+
+                if(nextX < 0 || nextZ < 0 || nextX >= kNavGridCells || nextZ >= kNavGridCells)
+                {
+                    continue;
+                }
+
+                if(!corridor.count(((nextZ / kNavSectorCells) * kNavSectors) + (nextX / kNavSectorCells)) || !_isCellWalkable(nextX, nextZ))
+                {
+                    continue;
+                }
+
+                if(dx && dz && (!_isCellWalkable(cellX + dx, cellZ) || !_isCellWalkable(cellX, cellZ + dz)))
+                {
+                    continue;
+                }
+
+                int32 next		= (nextZ * kNavGridCells) + nextX;
+                float nextCost	= cost + ((dx && dz) ? 1.41421356f : 1.0f);
+
+                std::unordered_map<int32, NavigationNodeRecord>::iterator it = nodes.find(next);
+                if(it != nodes.end() && (it->second.closed || it->second.cost <= nextCost))
+                {
+                    continue;
+                }
+
+                NavigationNodeRecord& nextRecord = nodes[next];
+                nextRecord.cost		= nextCost;
+                nextRecord.parent	= current;
+
+                // octile distance
+                float distX = static_cast<float>(abs(goalX - nextX));
+                float distZ = static_cast<float>(abs(goalZ - nextZ));
+
+                open.push(NavigationOpenNode(nextCost + std::max(distX, distZ) + 0.41421356f * std::min(distX, distZ), next));
+            }
+        }
+    }
+
+    return NavigationSearch_NoPath;
+}
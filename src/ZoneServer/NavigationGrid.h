@@ -0,0 +1,131 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_NAVIGATION_GRID_H
+#define ANH_ZONESERVER_NAVIGATION_GRID_H
+
+#include <unordered_set>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Utils/typedefs.h"
+
+//=============================================================================
+
+enum NavigationSearchResult
+{
+    NavigationSearch_Found		= 0,
+    NavigationSearch_NoPath		= 1,
+    NavigationSearch_Deferred	= 2	// the search budget ran out, ask again next tick
+};
+
+class NavigationWaypoint
+{
+public:
+    NavigationWaypoint() : cellId(0) {}
+    NavigationWaypoint(const glm::vec3& pos, uint64 cell) : position(pos), cellId(cell) {}
+
+    glm::vec3	position;
+    uint64		cellId;		// the cell we are in once the waypoint is reached, 0 = outside
+};
+
+typedef std::vector<NavigationWaypoint>		NavigationPath;
+
+//=============================================================================
+//
+// Coarse walkability grid covering a whole planet, 8m cells grouped into
+// 32x32 cell sectors. A sectors terrain is derived from the heightmap slope
+// the first time a search touches it, static structure footprints are laid
+// over it as they spawn.
+//
+// Searches are hierarchical: an A* over the sectors picks a corridor, a cell
+// level A* restricted to that corridor finds the route, which is then reduced
+// to the waypoints that can see each other. Each expanded node costs one unit
+// of the budget handed in.
+//
+
+class NavigationGrid
+{
+public:
+
+    NavigationGrid(float maxSlope = 1.0f);
+    ~NavigationGrid();
+
+    // footprints are reference counted per cell, remove with the same rectangle
+    void		addFootprint(float x, float z, float halfWidth, float halfLength);
+    void		removeFootprint(float x, float z, float halfWidth, float halfLength);
+
+    bool		isWalkable(float x, float z);
+
+    // -1 if the position is off the map
+    int32		getCellIndex(float x, float z) const;
+
+    // bumped whenever footprints change, paths computed before are stale
+    uint32		getVersion() const {
+        return mVersion;
+    }
+
+    // the path excludes the start, its last waypoint is the center of the goals cell
+    NavigationSearchResult	findPath(const glm::vec3& start, const glm::vec3& goal, NavigationPath& path, uint32& budget);
+
+private:
+
+    typedef std::unordered_set<int32>	SectorCorridor;
+
+    class NavigationSector
+    {
+    public:
+        NavigationSector();
+
+        std::vector<uint8>	mTerrain;	// 1 = slope allows walking
+        std::vector<uint8>	mBlockers;	// number of footprints covering the cell
+        bool				mTerrainBuilt;
+        bool				mLinksValid;
+        uint8				mLinks;		// walkable borders to the neighbour sectors
+    };
+
+    NavigationSector*	_getSector(int32 sectorX, int32 sectorZ);
+    void				_buildTerrain(NavigationSector* sector, int32 sectorX, int32 sectorZ);
+    bool				_isCellWalkable(int32 cellX, int32 cellZ);
+    uint8				_getSectorLinks(int32 sectorX, int32 sectorZ);
+    void				_markFootprint(float x, float z, float halfWidth, float halfLength, int32 delta);
+    glm::vec3			_getCellCenter(int32 cellIndex) const;
+    bool				_hasLineOfSight(int32 fromCell, int32 toCell);
+
+    NavigationSearchResult	_findCorridor(int32 startSector, int32 goalSector, SectorCorridor& corridor, uint32& budget);
+    NavigationSearchResult	_findCells(int32 startCell, int32 goalCell, const SectorCorridor& corridor, std::vector<int32>& cells, uint32& budget);
+
+    std::vector<NavigationSector*>	mSectors;
+    float							mMaxSlope;
+    uint32							mVersion;
+};
+
+//=============================================================================
+
+#endif
+
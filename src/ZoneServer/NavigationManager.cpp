@@ -0,0 +1,184 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "NavigationManager.h"
+
+#include "PlayerStructure.h"
+
+//=============================================================================
+
+NavigationManager::NavigationManager(uint32 searchBudget, uint32 maxDeferrals, uint32 cacheSize)
+    : mGrid(new NavigationGrid())
+    , mSearchBudget(searchBudget)
+    , mBudget(searchBudget)
+    , mMaxDeferrals(maxDeferrals)
+    , mCacheSize(cacheSize)
+{
+}
+
+//=============================================================================
+
+NavigationManager::~NavigationManager()
+{
+    mCache.clear();
+    mCacheOrder.clear();
+    mDeferrals.clear();
+
+    delete(mGrid);
+}
+
+//=============================================================================
+
+NavigationSearchResult NavigationManager::findPath(uint64 startCell, const glm::vec3& start, uint64 goalCell, const glm::vec3& goal, NavigationPath& path)
+{
+    path.clear();
+
+    // no portal data, indoors we walk straight
+    if(startCell || goalCell)
+    {
+        path.push_back(NavigationWaypoint(goal, goalCell));
+        return NavigationSearch_Found;
+    }
+
+    int32 startIndex	= mGrid->getCellIndex(start.x, start.z);
+    int32 goalIndex		= mGrid->getCellIndex(goal.x, goal.z);
+
+    if(startIndex < 0 || goalIndex < 0)
+    {
+        return NavigationSearch_NoPath;
+    }
+
+    uint64 key = (static_cast<uint64>(static_cast<uint32>(startIndex)) << 32) | static_cast<uint32>(goalIndex);
+
+    NavigationCache::iterator it = mCache.find(key);
+    if(it == mCache.end() || it->second.mVersion != mGrid->getVersion())
+    {
+        NavigationCacheEntry entry;
+        entry.mResult	= mGrid->findPath(start, goal, entry.mPath, mBudget);
+        entry.mVersion	= mGrid->getVersion();
+
+        if(entry.mResult == NavigationSearch_Deferred)
+        {
+            // every retry starts over, a search this big will not fit in a
+            // tick any better next time, so don't let it eat every tick's budget
+            uint32& deferrals = mDeferrals[key];
+            if(++deferrals < mMaxDeferrals)
+            {
+                return NavigationSearch_Deferred;
+            }
+
+            entry.mResult = NavigationSearch_Found;
+            entry.mPath.clear();
+            entry.mPath.push_back(NavigationWaypoint(goal, 0));
+        }
+
+        mDeferrals.erase(key);
+
+        _cacheEntry(key, entry);
+        it = mCache.find(key);
+    }
+
+    if(it->second.mResult != NavigationSearch_Found)
+    {
+        return it->second.mResult;
+    }
+
+    // the cached route ends in the center of the goals cell, we want the exact spot
+    path = it->second.mPath;
+    path.back().position = goal;
+
+    return NavigationSearch_Found;
+}
+
+//=============================================================================
+
+void NavigationManager::_cacheEntry(uint64 key, const NavigationCacheEntry& entry)
+{
+    NavigationCache::iterator it = mCache.find(key);
+    if(it != mCache.end())
+    {
+        it->second = entry;
+        return;
+    }
+
+    // evict the oldest entries, stale ones go the same way
+    while(mCache.size() >= mCacheSize && !mCacheOrder.empty())
+    {
+        mCache.erase(mCacheOrder.front());
+        mCacheOrder.pop_front();
+    }
+
+    mCacheOrder.push_back(key);
+    mCache.insert(std::make_pair(key, entry));
+
+    // creatures that gave up on a search leave their count behind
+    if(mDeferrals.size() > mCacheSize)
+    {
+        mDeferrals.clear();
+    }
+}
+
+//=============================================================================
+
+void NavigationManager::addStructure(Object* object)
+{
+    PlayerStructure* structure = dynamic_cast<PlayerStructure*>(object);
+
+    if(!structure || structure->getParentId() || mFootprints.count(object->getId()))
+    {
+        return;
+    }
+
+    NavigationFootprint footprint;
+    footprint.x				= structure->mPosition.x;
+    footprint.z				= structure->mPosition.z;
+    footprint.halfWidth		= structure->getWidth();
+    footprint.halfLength	= structure->getHeight();
+
+    if(footprint.halfWidth <= 0.0f || footprint.halfLength <= 0.0f)
+    {
+        return;
+    }
+
+    mFootprints.insert(std::make_pair(object->getId(), footprint));
+    mGrid->addFootprint(footprint.x, footprint.z, footprint.halfWidth, footprint.halfLength);
+}
+
+//=============================================================================
+
+void NavigationManager::removeStructure(Object* object)
+{
+    NavigationFootprintMap::iterator it = mFootprints.find(object->getId());
+
+    if(it == mFootprints.end())
+    {
+        return;
+    }
+
+    mGrid->removeFootprint(it->second.x, it->second.z, it->second.halfWidth, it->second.halfLength);
+    mFootprints.erase(it);
+}
@@ -0,0 +1,116 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_NAVIGATION_MANAGER_H
+#define ANH_ZONESERVER_NAVIGATION_MANAGER_H
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "NavigationGrid.h"
+
+//=============================================================================
+
+class Object;
+
+//=============================================================================
+//
+// Pathfinding front end for npc movement. Outdoor searches go to the planets
+// NavigationGrid. The tree has no cell portal data, so indoor moves stay the
+// straight line they always were.
+//
+// Results of the grid are cached by start and goal cell, so creatures of the
+// same lair roaming between the same spots share one search. All searches of
+// a tick draw from one budget, if it is used up the caller is told to come
+// back next tick instead of stalling the zone. A search that was deferred
+// maxDeferrals times in a row is given up and the straight line is used.
+//
+
+class NavigationManager
+{
+public:
+
+    NavigationManager(uint32 searchBudget = 20000, uint32 maxDeferrals = 3, uint32 cacheSize = 4096);
+    ~NavigationManager();
+
+    // startCell / goalCell are the parent ids, 0 = outside
+    NavigationSearchResult	findPath(uint64 startCell, const glm::vec3& start, uint64 goalCell, const glm::vec3& goal, NavigationPath& path);
+
+    // static structures and buildings block the grid with their footprint
+    void		addStructure(Object* object);
+    void		removeStructure(Object* object);
+
+    // called once per npc tick
+    void		resetBudget() {
+        mBudget = mSearchBudget;
+    }
+
+    NavigationGrid*	getGrid() {
+        return mGrid;
+    }
+
+private:
+
+    class NavigationCacheEntry
+    {
+    public:
+        NavigationPath			mPath;
+        NavigationSearchResult	mResult;
+        uint32					mVersion;
+    };
+
+    class NavigationFootprint
+    {
+    public:
+        float	x;
+        float	z;
+        float	halfWidth;
+        float	halfLength;
+    };
+
+    typedef std::unordered_map<uint64, NavigationCacheEntry>	NavigationCache;
+    typedef std::unordered_map<uint64, NavigationFootprint>		NavigationFootprintMap;
+    typedef std::unordered_map<uint64, uint32>					NavigationDeferralMap;
+
+    void		_cacheEntry(uint64 key, const NavigationCacheEntry& entry);
+
+    NavigationGrid*				mGrid;
+    NavigationCache				mCache;
+    std::deque<uint64>			mCacheOrder;
+    NavigationFootprintMap		mFootprints;
+    NavigationDeferralMap		mDeferrals;		// searches that ran out of budget, by cache key
+    uint32						mSearchBudget;
+    uint32						mBudget;
+    uint32						mMaxDeferrals;
+    uint32						mCacheSize;
+};
+
+//=============================================================================
+
+#endif
+
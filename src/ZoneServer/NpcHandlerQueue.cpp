@@ -0,0 +1,189 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "NpcHandlerQueue.h"
+
+#include "Utils/clock.h"
+
+//=============================================================================
+
+NpcHandlerQueue::NpcHandlerQueue()
+    : mPasses(0)
+    , mQueued(0)
+    , mEvaluated(0)
+    , mHandled(0)
+{
+}
+
+//=============================================================================
+
+NpcHandlerQueue::~NpcHandlerQueue()
+{
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::add(uint64 npcId,uint64 due)
+{
+    if(contains(npcId))
+        return;
+
+    // anchor the wheel at now, not at the first deadline, earlier ones would be clamped to it
+    if(!mWheel.isStarted())
+        mWheel.start(Anh_Utils::Clock::getSingleton()->getLocalTime());
+
+    uint32 slot;
+
+    if(!mFreeSlots.empty())
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(mSlotIds.size());
+        mSlotIds.push_back(0);
+    }
+
+    mSlotIds[slot] = npcId;
+    mSlots.insert(std::make_pair(npcId,slot));
+
+    mWheel.insert(slot,due);
+}
+
+//=============================================================================
+
+bool NpcHandlerQueue::remove(uint64 npcId)
+{
+    SlotMap::iterator it = mSlots.find(npcId);
+
+    if(it == mSlots.end())
+        return(false);
+
+    mWheel.remove(it->second);
+    mFreeSlots.push_back(it->second);
+    mSlots.erase(it);
+
+    return(true);
+}
+
+//=============================================================================
+
+bool NpcHandlerQueue::reschedule(uint64 npcId,uint64 due)
+{
+    SlotMap::iterator it = mSlots.find(npcId);
+
+    if(it == mSlots.end())
+        return(false);
+
+    mWheel.insert(it->second,due);
+
+    return(true);
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::clear()
+{
+    SlotMap::iterator it = mSlots.begin();
+
+    while(it != mSlots.end())
+    {
+        mWheel.remove(it->second);
+        ++it;
+    }
+
+    mSlots.clear();
+    mSlotIds.clear();
+    mFreeSlots.clear();
+}
+
+//=============================================================================
+
+uint64 NpcHandlerQueue::getDue(uint64 npcId) const
+{
+    SlotMap::const_iterator it = mSlots.find(npcId);
+
+    if(it == mSlots.end())
+        return(Anh_Utils::TimingWheel::kNever);
+
+    return(mWheel.getDue(it->second));
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::popDue(uint64 now,std::vector<uint64>& npcIds)
+{
+    mWheel.advance(now,mExpired);
+
+    std::vector<uint32>::iterator it = mExpired.begin();
+
+    while(it != mExpired.end())
+    {
+        npcIds.push_back(mSlotIds[*it]);
+        ++it;
+    }
+
+    mExpired.clear();
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::recordPass(uint32 evaluated,uint32 handled)
+{
+    ++mPasses;
+
+    mQueued		+= mSlots.size();
+    mEvaluated	+= evaluated;
+    mHandled	+= handled;
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::printStats(std::ostream& out,const char* name) const
+{
+    if(!mPasses)
+    {
+        out << name << ": no passes" << std::endl;
+        return;
+    }
+
+    out << name << ": " << mPasses << " passes, per pass "
+        << mQueued / mPasses << " queued, "
+        << mEvaluated / mPasses << " evaluated, "
+        << mHandled / mPasses << " due" << std::endl;
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::resetStats()
+{
+    mPasses		= 0;
+    mQueued		= 0;
+    mEvaluated	= 0;
+    mHandled	= 0;
+}
@@ -0,0 +1,98 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_NPC_HANDLER_QUEUE_H
+#define ANH_ZONESERVER_NPC_HANDLER_QUEUE_H
+
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/TimingWheel.h"
+#include "Utils/typedefs.h"
+
+//=============================================================================
+//
+// One lane (dormant, ready or active) of npc handlers, ordered by the time
+// the npc wants to be handled next.
+// The npcs sit in a timing wheel, so a pass only pops the entries that are
+// due instead of walking every spawned npc, and moving an npc between lanes
+// is a remove plus an add, both O(1).
+//
+
+class NpcHandlerQueue
+{
+public:
+
+    NpcHandlerQueue();
+    ~NpcHandlerQueue();
+
+    // does nothing if the npc is queued already, like inserting into the old map
+    void	add(uint64 npcId,uint64 due);
+    bool	remove(uint64 npcId);
+    bool	reschedule(uint64 npcId,uint64 due);
+    void	clear();
+
+    bool	contains(uint64 npcId) const {
+        return(mSlots.find(npcId) != mSlots.end());
+    }
+
+    // TimingWheel::kNever if the npc is not queued
+    uint64	getDue(uint64 npcId) const;
+
+    // appends the ids of all npcs due at or before now, they stay in the queue until rescheduled or removed
+    void	popDue(uint64 now,std::vector<uint64>& npcIds);
+
+    uint64	getNextDue() const {
+        return(mWheel.getNextDue());
+    }
+    uint32	size() const {
+        return(static_cast<uint32>(mSlots.size()));
+    }
+
+    // evaluated: entries a pass had to look at, handled: npcs that actually ran
+    void	recordPass(uint32 evaluated,uint32 handled);
+    void	printStats(std::ostream& out,const char* name) const;
+    void	resetStats();
+
+private:
+
+    typedef std::unordered_map<uint64,uint32> SlotMap;
+
+    Anh_Utils::TimingWheel	mWheel;
+    SlotMap					mSlots;
+    std::vector<uint64>		mSlotIds;
+    std::vector<uint32>		mFreeSlots;
+    std::vector<uint32>		mExpired;
+
+    uint64					mPasses;
+    uint64					mQueued;
+    uint64					mEvaluated;
+    uint64					mHandled;
+};
+
+#endif
@@ -25,31 +25,67 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ---------------------------------------------------------------------------------------
 */
 
-#ifndef ANH_ZONESERVER_ENQUEUE_VALIDATOR_H
-#define ANH_ZONESERVER_ENQUEUE_VALIDATOR_H
+#include "NpcJobSystem.h"
 
-#include "Utils/typedefs.h"
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
-class ObjectController;
-class ObjectControllerCmdProperties;
+#include "NPCObject.h"
 
+//=============================================================================
 
-//=======================================================================
-
-class EnqueueValidator
+namespace
+{
+class NpcRangeBody
 {
 public:
-    explicit EnqueueValidator(ObjectController* controller);
-    virtual ~EnqueueValidator();
 
-    virtual bool validate(uint32 &reply1, uint32 &reply2, uint64 targetId, uint32 opcode, ObjectControllerCmdProperties*& cmdProperties) = 0;
+    NpcRangeBody(const NpcJobList& npcs) : mNpcs(npcs) {}
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t i = range.begin(); i != range.end(); ++i)
+        {
+            mNpcs[i]->precomputeRanges();
+        }
+    }
 
-protected:
-    ObjectController* mController;
+private:
+
+    const NpcJobList& mNpcs;
 };
+}
 
-//=======================================================================
+//=============================================================================
 
-#endif
+NpcJobSystem::NpcJobSystem(uint32 serialThreshold, uint32 grainSize)
+    : mSerialThreshold(serialThreshold)
+    , mGrainSize(grainSize ? grainSize : 1)
+    , mParallelPasses(0)
+    , mSerialPasses(0)
+{
+}
 
+//=============================================================================
 
+NpcJobSystem::~NpcJobSystem()
+{
+}
+
+//=============================================================================
+
+void NpcJobSystem::precomputeRanges(const NpcJobList& npcs)
+{
+    if (npcs.size() < mSerialThreshold)
+    {
+        NpcRangeBody body(npcs);
+        body(tbb::blocked_range<size_t>(0, npcs.size()));
+        ++mSerialPasses;
+        return;
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, npcs.size(), mGrainSize), NpcRangeBody(npcs));
+    ++mParallelPasses;
+}
+
+//=============================================================================
@@ -25,44 +25,52 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ---------------------------------------------------------------------------------------
 */
 
-#ifndef ANH_ZONESERVER_PROCESS_VALIDATOR_H
-#define ANH_ZONESERVER_PROCESS_VALIDATOR_H
+#ifndef ANH_ZONESERVER_NPC_JOB_SYSTEM_H
+#define ANH_ZONESERVER_NPC_JOB_SYSTEM_H
+
+#include <vector>
 
 #include "Utils/typedefs.h"
 
-class ObjectController;
-class ObjectControllerCmdProperties;
+//=============================================================================
+
+class NPCObject;
+
+typedef std::vector<NPCObject*>	NpcJobList;
 
-//=======================================================================
+//=============================================================================
+//
+// Precomputes the range checks of an ai pass on tbb's work stealing
+// scheduler. Npc's only measure their distance to known players, defenders
+// and their target here and record it in their perception. Everything else,
+// target selection included, happens afterwards in the serial pass on the
+// main thread, which answers its range checks from the perception.
+// Small passes are not worth the hand off and are run inline.
+//
 
-class ProcessValidator
+class NpcJobSystem
 {
 public:
-    explicit ProcessValidator(ObjectController* controller);
-    virtual ~ProcessValidator();
-
-    virtual bool validate(uint32 &reply1, uint32 &reply2, uint64 targetId, uint32 opcode, ObjectControllerCmdProperties*& cmdProperties) = 0;
-
-    uint32	inline getLowestCommonBit(uint64 playerMask, uint64 cmdPropertiesMask)
-    {
-        // checks each bit and returns the value
-        bool bFound = false;
-        uint32 i = 0;
-        for (; i < 64 && !bFound; ++i) {
-            bFound = (playerMask & (cmdPropertiesMask << i)) != 0;
-        }
-        if (bFound) {
-            return i;
-        }
-        return 0;
+
+    NpcJobSystem(uint32 serialThreshold = 64, uint32 grainSize = 16);
+    ~NpcJobSystem();
+
+    void	precomputeRanges(const NpcJobList& npcs);
+
+    uint64	getParallelPasses() const {
+        return mParallelPasses;
+    }
+    uint64	getSerialPasses() const {
+        return mSerialPasses;
     }
 
-protected:
-    ObjectController* mController;
-};
+private:
 
-//=======================================================================
+    uint32	mSerialThreshold;
+    uint32	mGrainSize;
+    uint64	mParallelPasses;
+    uint64	mSerialPasses;
+};
 
 #endif
 
-
@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "AttackableCreature.h"
 #include "CombatManager.h"
 #include "CreatureObject.h"
+#include "Heightmap.h"
 #include "PlayerObject.h"
 #include "Weapon.h"
 #include "WorldConfig.h"
@@ -132,6 +133,99 @@ void NpcManager::addCreature(uint64 creatureId, const SpawnData *spawn)
 }
 */
 
+//=============================================================================
+//
+//	The height is filled in when the batch is flushed, by then the npc may be gone.
+//	Checks later in the pass already see the new x/z.
+//
+
+void NpcManager::queueMove(NPCObject* npc, const glm::vec3& position)
+{
+    if (uint32 slot = npc->getQueuedMove())
+    {
+        // moved twice in one pass, the spatial index still has it at the first origin
+        mMoveX[slot - 1] = position.x;
+        mMoveZ[slot - 1] = position.z;
+    }
+    else
+    {
+        mMoveIds.push_back(npc->getId());
+        mMoveFrom.push_back(npc->mPosition);
+        mMoveX.push_back(position.x);
+        mMoveZ.push_back(position.z);
+        npc->setQueuedMove(static_cast<uint32>(mMoveIds.size()));
+    }
+
+    npc->mPosition.x = position.x;
+    npc->mPosition.z = position.z;
+}
+
+//=============================================================================
+//
+//	Puts the npc back where the spatial index has it, before it is moved some other way.
+//
+
+void NpcManager::dropMove(NPCObject* npc)
+{
+    uint32 slot = npc->getQueuedMove();
+    if (!slot)
+    {
+        return;
+    }
+
+    npc->mPosition = mMoveFrom[slot - 1];
+    npc->setQueuedMove(0);
+    mMoveIds[slot - 1] = 0;
+}
+
+//=============================================================================
+
+void NpcManager::flushMoves(void)
+{
+    if (mMoveIds.empty())
+    {
+        return;
+    }
+
+    mMoveHeights.resize(mMoveIds.size());
+    gHeightmap->getHeights(&mMoveX[0], &mMoveZ[0], &mMoveHeights[0], static_cast<uint32>(mMoveIds.size()));
+
+    for (uint32 i = 0; i < mMoveIds.size(); i++)
+    {
+        if (!mMoveIds[i])
+        {
+            continue;
+        }
+
+        NPCObject* npc = gWorldManager->getObjectRegistry()->findNpc(mMoveIds[i]);
+        if (npc && (npc->getQueuedMove() == i + 1))
+        {
+            npc->setQueuedMove(0);
+
+            // the spatial index is updated from the old position
+            npc->mPosition = mMoveFrom[i];
+
+            // send out position updates to known players
+            npc->MovingObject::updatePosition(npc->getParentId(), glm::vec3(mMoveX[i], mMoveHeights[i], mMoveZ[i]));
+        }
+    }
+
+    mMoveIds.clear();
+    mMoveFrom.clear();
+    mMoveX.clear();
+    mMoveZ.clear();
+}
+
+//=============================================================================
+//
+//	Parallel range precompute of an ai pass, see NpcJobSystem.
+//
+
+void NpcManager::precomputeNpcRanges(const NpcJobList& npcs)
+{
+    mJobSystem.precomputeRanges(npcs);
+}
+
 //=============================================================================
 //
 //	Handle npc.
@@ -171,6 +265,9 @@ uint64 NpcManager::handleNpc(NPCObject* npc, uint64 timeOverdue)
             assert(false && "NpcManager::handleNpc invalid AI state");
         }
     }
+
+    // The precomputed ranges are stale from now on.
+    npc->clearPerception();
     return waitTime;
 }
 
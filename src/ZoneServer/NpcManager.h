@@ -31,7 +31,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "DatabaseManager/DatabaseCallback.h"
 #include "Utils/typedefs.h"
+#include "NpcJobSystem.h"
 #include "ObjectFactoryCallback.h"
+#include <glm/glm.hpp>
+#include <vector>
 
 //=============================================================================
 
@@ -88,8 +91,16 @@ public:
     // void	removeNpc(uint64 npcId);
     bool	handleAttack(CreatureObject *attacker, uint64 targetId);
 
+    // An ai pass first precomputes the range checks of all due npc's in parallel, then handles them one by one.
+    void	precomputeNpcRanges(const NpcJobList& npcs);
     uint64	handleNpc(NPCObject* npc, uint64 timeOverdue);
 
+    // Npc steps of a handler pass are collected and their terrain heights resolved as one batch.
+    // The npc's x/z change right away, the height, the spatial index and the update to the known players follow at the flush.
+    void	queueMove(NPCObject* npc, const glm::vec3& position);
+    void	dropMove(NPCObject* npc);
+    void	flushMoves(void);
+
     void	loadLairs(void);
 
 
@@ -112,6 +123,14 @@ private:
 
     static NpcManager* mInstance;
     Database* mDatabase;
+
+    NpcJobSystem		mJobSystem;
+
+    std::vector<uint64>	mMoveIds;
+    std::vector<glm::vec3>	mMoveFrom;	// where the spatial index still has the npc
+    std::vector<float>	mMoveX;
+    std::vector<float>	mMoveZ;
+    std::vector<float>	mMoveHeights;
     // DataBinding*	mItemIdentifierBinding;
     // DataBinding*	mItemBinding;
 };
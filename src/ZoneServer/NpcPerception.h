@@ -0,0 +1,164 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_NPC_PERCEPTION_H
+#define ANH_ZONESERVER_NPC_PERCEPTION_H
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Utils/typedefs.h"
+
+//=============================================================================
+//
+// Range checks of a npc against its known players and defenders, evaluated
+// in the parallel range precompute of an ai pass and consumed by the serial
+// pass. An answer is only given while the npc is still where it was when the
+// snapshot was taken and the asked radius matches, otherwise the caller has to
+// ask the world.
+//
+
+class NpcPerception
+{
+public:
+
+    enum Range
+    {
+        Range_Attack = 0,
+        Range_Warning,
+        Range_Weapon,
+        Range_Home,
+        Range_Aggro,
+        Range_Count
+    };
+
+    NpcPerception() : mParentId(0), mValid(false) {}
+
+    void	begin(const glm::vec3& position, uint64 parentId)
+    {
+        mEntries.clear();
+        mPosition	= position;
+        mParentId	= parentId;
+        mValid		= false;
+
+        for (uint32 i = 0; i < Range_Count; ++i)
+        {
+            mRadius[i] = -1.0f;
+        }
+    }
+
+    void	setRadius(Range range, float radius) {
+        mRadius[range] = radius;
+    }
+
+    void	add(uint64 targetId, Range range, bool inRange)
+    {
+        Entry entry;
+        entry.mId		= targetId;
+        entry.mTested	= (uint8)(1 << range);
+        entry.mInRange	= inRange ? entry.mTested : 0;
+        mEntries.push_back(entry);
+    }
+
+    // sorts the collected answers and merges duplicate targets
+    void	end()
+    {
+        std::sort(mEntries.begin(), mEntries.end());
+
+        if (!mEntries.empty())
+        {
+            EntryList::iterator out = mEntries.begin();
+            EntryList::iterator it = out + 1;
+            while (it != mEntries.end())
+            {
+                if (it->mId == out->mId)
+                {
+                    out->mTested |= it->mTested;
+                    out->mInRange |= it->mInRange;
+                }
+                else
+                {
+                    *(++out) = *it;
+                }
+                ++it;
+            }
+            mEntries.erase(out + 1, mEntries.end());
+        }
+        mValid = true;
+    }
+
+    void	invalidate() {
+        mValid = false;
+    }
+
+    bool	lookup(const glm::vec3& position, uint64 parentId, uint64 targetId, Range range, float radius, bool& inRange) const
+    {
+        if (!mValid || (mRadius[range] != radius) || (parentId != mParentId) || (position != mPosition))
+        {
+            return false;
+        }
+
+        Entry key;
+        key.mId = targetId;
+
+        EntryList::const_iterator it = std::lower_bound(mEntries.begin(), mEntries.end(), key);
+        if ((it == mEntries.end()) || (it->mId != targetId) || !(it->mTested & (1 << range)))
+        {
+            return false;
+        }
+
+        inRange = (it->mInRange & (1 << range)) != 0;
+        return true;
+    }
+
+private:
+
+    class Entry
+    {
+    public:
+        bool operator< (const Entry& right) const {
+            return mId < right.mId;
+        }
+
+        uint64	mId;
+        uint8	mTested;
+        uint8	mInRange;
+    };
+
+    typedef std::vector<Entry> EntryList;
+
+    EntryList	mEntries;
+    glm::vec3	mPosition;
+    uint64		mParentId;
+    float		mRadius[Range_Count];
+    bool		mValid;
+};
+
+#endif
+
@@ -1656,7 +1656,7 @@ bool HandleBurstRun(Object* object, Object* target, Message* message, ObjectCont
 
     // Trigger a pre-command execute event and get the result. This allows
     // any listeners a last chance to veto the processing of the command.
-    if (!gEventDispatcher.Deliver(pre_execute_event).get()) {
+    if (!gEventDispatcher.DeliverNow(pre_execute_event)) {
         return false;
     }
 
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "PlayerObject.h"
 #include "FactoryObject.h"
 #include "QuadTree.h"
+#include "RegionTriggerGrid.h"
 #include "Tutorial.h"
 #include "WorldConfig.h"
 #include "WorldManager.h"
@@ -240,6 +241,9 @@ void ObjectController::handleDataTransform(Message* message,bool inRangeUpdate)
     player->mDirection = dir;
     player->setCurrentSpeed(speed);
 
+    // fire region enter / leave events if we crossed a boundary
+    gWorldManager->getRegionTriggers()->updateObject(player);
+
     // destroy the instanced instrument if out of range
     if (player->getPlacedInstrumentId())
     {
@@ -440,6 +444,9 @@ void ObjectController::handleDataTransformWithParent(Message* message,bool inRan
         player->mPosition  = pos;
         player->setCurrentSpeed(speed);
 
+        // fire region enter / leave events if we crossed a boundary
+        gWorldManager->getRegionTriggers()->updateObject(player);
+
         // destroy the instanced instrument if out of range
         if (player->getPlacedInstrumentId())
         {
@@ -576,6 +583,7 @@ void ObjectController::_findInRangeObjectsOutside(bool updateAll)
 
     // Update the iterator to start of Set.
     mObjectSetIt = mInRangeObjects.begin();
+    _captureInRangeHandles();
 }
 
 //=========================================================================================
@@ -591,22 +599,8 @@ bool ObjectController::_updateInRangeObjectsOutside()
 
     while ((mObjectSetIt != mInRangeObjects.end()) && (updatedObjects < objectSendLimit))
     {
-        //BEWARE Object is at this time possibly not valid anymore!
-        //this actually causes a lot of crashes!!!!
-        Object* object = nullptr;
-        try
-        {
-            //the object might no exist anymore - the first cast to object actually might still work
-            //got alot of crashes that way ... -leave until we use smartpointers
-            object = dynamic_cast<Object*>(*mObjectSetIt);
-            uint64 id = object->getId();
-            object = dynamic_cast<Object*>(gWorldManager->getObjectById(id));
-
-        }
-        catch (...)
-        {
-        }
-        // Just simplified the code a little. Good find Schmunzel.
+        // The object may have been destroyed since we found it, the handle resolves to NULL then.
+        Object* object = gWorldManager->getObjectByHandle(mInRangeHandles[mInRangeHandleIndex]);
 
         // only add it if its also outside
         // see if its already observed, if yes, just send a position update out, if its a player
@@ -665,6 +659,7 @@ bool ObjectController::_updateInRangeObjectsOutside()
             }
         }
         ++mObjectSetIt;
+        ++mInRangeHandleIndex;
     }
     return (mObjectSetIt == mInRangeObjects.end());
 }
@@ -741,9 +736,30 @@ void ObjectController::_findInRangeObjectsInside(bool updateAll)
     }
     // Update the iterator to start of Set.
     mObjectSetIt = mInRangeObjects.begin();
+    _captureInRangeHandles();
 }
 
 
+//=========================================================================================
+//
+// Remember the found objects by handle, the set itself holds raw pointers.
+//
+
+void ObjectController::_captureInRangeHandles()
+{
+    mInRangeHandles.clear();
+    mInRangeHandles.reserve(mInRangeObjects.size());
+
+    ObjectSet::iterator it = mInRangeObjects.begin();
+    while (it != mInRangeObjects.end())
+    {
+        mInRangeHandles.push_back((*it)->getHandle());
+        ++it;
+    }
+
+    mInRangeHandleIndex = 0;
+}
+
 //=========================================================================================
 //
 // Update the objects observed/known objects when inside
@@ -764,13 +780,10 @@ bool ObjectController::_updateInRangeObjectsInside()
     uint32 updatedObjects = 0;
     const uint32 objectSendLimit = 50;
 
-    //what do we do if the object has been deleted in the meantime?
-    //TODO
     while ((mObjectSetIt != mInRangeObjects.end()) && (updatedObjects < objectSendLimit))
     {
-        // Object* object = (*mObjectSetIt);
         // Needed since object may be invalid due to the multi-session approach of this function.
-        Object* object = dynamic_cast<Object*>(*mObjectSetIt);
+        Object* object = gWorldManager->getObjectByHandle(mInRangeHandles[mInRangeHandleIndex]);
 
         // Create objects that are in the same building as we are OR outside near the building.
         if ((object) && (!player->checkKnownObjects(object)))
@@ -829,6 +842,7 @@ bool ObjectController::_updateInRangeObjectsInside()
             }
         }
         ++mObjectSetIt;
+        ++mInRangeHandleIndex;
     }
     return (mObjectSetIt == mInRangeObjects.end());
 }
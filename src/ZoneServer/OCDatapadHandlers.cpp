@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Datapad.h"
 #include "Item.h"
 #include "NPCObject.h"
+#include "ObjectFactory.h"
 #include "ObjectController.h"
 #include "ObjectControllerOpcodes.h"
 #include "ObjectControllerCommandMap.h"
@@ -133,7 +134,10 @@ void ObjectController::_handleSetWaypointActiveStatus(uint64 targetId,Message* m
     if(waypoint)
     {
         waypoint->toggleActive();
-        mDatabase->executeSqlAsync(0,0,"UPDATE waypoints set active=%u WHERE waypoint_id=%"PRIu64"",(uint8)waypoint->getActive(),targetId);
+
+        int8 sql[128];
+        sprintf(sql,"UPDATE waypoints set active=%u WHERE waypoint_id=%"PRIu64"",(uint8)waypoint->getActive(),targetId);
+        gObjectFactory->executeRowSql(targetId,sql);
     }
     else
     {
@@ -231,7 +235,7 @@ void ObjectController::_handleSetWaypointName(uint64 targetId,Message* message,O
     sprintf(restStr,"' WHERE waypoint_id=%"PRIu64"",targetId);
     strcat(sql,restStr);
 
-    mDatabase->executeSqlAsync(NULL,NULL,sql);
+    gObjectFactory->executeRowSql(targetId,sql);
     
 
     gMessageLib->sendUpdateWaypoint(waypoint,ObjectUpdateChange,player);
@@ -367,7 +367,6 @@ void	ObjectController::_handleHarvesterGetResourceData(uint64 targetId,Message*
     //harvester->getTTS()->todo		= ttE_UpdateHopper;
     //harvester->getTTS()->playerId	= player->getId();
     //structure->getTTS()->projectedTime = 5000 + Anh_Utils::Clock::getSingleton()->getLocalTime();
-    //gStructureManager->addStructureforHopperUpdate(harvester->getId());
 
     // this needs to be handled zoneserverside - otherwise the addition of a res will trigger a racecondition
     // between the sql write query and the sql read please note that the harvesting itself happens through stored procedures
@@ -427,10 +426,15 @@ void	ObjectController::_handleHarvesterSelectResource(uint64 targetId,Message* m
         return;
     }
 
-    harvester->setCurrentResource(resourceId);
+    if(!harvester)
+    {
+        return;
+    }
 
-    // update the current resource in the db
-    mDatabase->executeSqlAsync(0,0,"UPDATE harvesters SET ResourceID=%"PRIu64" WHERE id=%"PRIu64" ",resourceId,harvester->getId());
+    //whatever was harvested so far goes to the old resource
+    gStructureManager->settleStructure(harvester);
+
+    harvester->setCurrentResource(resourceId);
 
     CurrentResource* cR = reinterpret_cast<CurrentResource*>(tmpResource);
     //resource = reinterpret_cast<CurrentResource*>(gResourceManager->getResourceByNameCRC(resourceName.getCrc()));
@@ -462,16 +466,12 @@ void	ObjectController::_handleHarvesterSelectResource(uint64 targetId,Message* m
 
     if(!harvester->checkResourceList(resourceId))
     {
-        //do *not* add to list - otherwise we get a racecondition with the asynch update from db !!!
-        //harvester->getResourceList()->push_back(std::make_pair(resourceId,float(0.0)));
-        //add to db
-        mDatabase->executeSqlAsync(0,0,"INSERT INTO harvester_resources VALUES(%"PRIu64",%"PRIu64",0,0)",harvester->getId(),resourceId);
-     
+        //the hopper is only kept by the zone now, the db gets the resource with the next save
+        harvester->getResourceList()->push_back(std::make_pair(resourceId,float(0.0)));
     }
 
-    // update the current extractionrate in the db for the stored procedure handling the harvesting
-    mDatabase->executeSqlAsync(0,0,"UPDATE harvesters SET rate=%f WHERE id=%"PRIu64" ",(ber*ratio),harvester->getId());
-    
+    //the new resource, its rate and the time the hopper fills up are saved together
+    gStructureManager->saveStructure(harvester);
 
     //now send the updates
     gMessageLib->sendCurrentResourceUpdate(harvester,player);
@@ -515,13 +515,21 @@ void	ObjectController::_handleHarvesterActivate(uint64 targetId,Message* message
 
     HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
 
+    if(!harvester)
+    {
+        return;
+    }
+
+    //the time it stood still only costs maintenance
+    gStructureManager->settleStructure(harvester);
+
     harvester->setActive(true);
 
     //send the respective delta
     gMessageLib->sendHarvesterActive(harvester);
 
-    //send the db update
-    mDatabase->executeSqlAsync(0,0,"UPDATE harvesters SET active= 1 WHERE id=%"PRIu64" ",harvester->getId());
+    //write it and plan for its power and hopper running out
+    gStructureManager->saveStructure(harvester);
     
 
 }
@@ -561,13 +569,21 @@ void	ObjectController::_handleHarvesterDeActivate(uint64 targetId,Message* messa
 
     HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
 
+    if(!harvester)
+    {
+        return;
+    }
+
+    //harvest up to now before it stops
+    gStructureManager->settleStructure(harvester);
+
     harvester->setActive(false);
 
     //send the respective delta
     gMessageLib->sendHarvesterActive(harvester);
 
-    //send the db update
-    mDatabase->executeSqlAsync(0,0,"UPDATE harvesters SET active = 0 WHERE id=%"PRIu64" ",harvester->getId());
+    //write it, a stopped harvester only pays maintenance
+    gStructureManager->saveStructure(harvester);
     
 
 }
@@ -44,6 +44,7 @@ Object::Object()
     , mLoadState(LoadState_Loading)
     , mId(0)
     , mParentId(0)
+    , mHandle(kInvalidObjectHandle)
     , mPrivateOwner(0)
     , mEquipSlots(0)
     , mSubZoneId(0)
@@ -65,6 +66,7 @@ Object::Object(uint64 id,uint64 parentId,BString model,ObjectType type)
     , mType(type)
     , mId(id)
     , mParentId(parentId)
+    , mHandle(kInvalidObjectHandle)
     , mPrivateOwner(0)
     , mEquipSlots(0)
     , mSubZoneId(0)
@@ -49,6 +49,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <glog/logging.h>
 
 #include "ObjectController.h"
+#include "ObjectRegistry.h"
 #include "RadialMenu.h"
 #include "UICallback.h"
 #include "Object_Enums.h"
@@ -101,6 +102,14 @@ public:
         mId = id;
     }
 
+    // handle of our slot in the world managers object registry
+    ObjectHandle				getHandle() const {
+        return mHandle;
+    }
+    void						setHandle(ObjectHandle handle) {
+        mHandle = handle;
+    }
+
     uint64						getParentId() const {
         return mParentId;
     }
@@ -370,6 +379,7 @@ protected:
 
     uint64					mId;
     uint64					mParentId;
+    ObjectHandle			mHandle;
 
     // If object is used as a private object in an Instance, this references the instances (objects) owner
     uint64					mPrivateOwner;
@@ -25,22 +25,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ---------------------------------------------------------------------------------------
 */
 #include "CombatManager.h"
-#include "EVQueueSize.h"
-#include "EVCmdProperty.h"
-#include "EVAbility.h"
-#include "EVState.h"
-#include "EVSurveySample.h"
-#include "EVWeapon.h"
-#include "EVPosture.h"
+#include "CreatureObject.h"
+#include "Ham.h"
+#include "Item.h"
 #include "ObjectController.h"
 #include "ObjectControllerOpcodes.h"
 #include "ObjectControllerCommandMap.h"
 #include "objcontrollercommandmessage.h"
 #include "PlayerObject.h"
-#include "PVHam.h"
-#include "PVPosture.h"
-#include "PVState.h"
 #include "StateManager.h"
+#include "Weapon.h"
 #include "WorldConfig.h"
 #include "WorldManager.h"
 
@@ -60,6 +54,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "NetworkManager/MessageFactory.h"
 #include "NetworkManager/Message.h"
 #include "Utils/clock.h"
+#include "Utils/TickProfiler.h"
 
 #include "SwgProtocol/ObjectControllerEvents.h"
 
@@ -77,6 +72,8 @@ ObjectController::ObjectController()
     : mCmdMsgPool(sizeof(ObjControllerCommandMessage))
     , mDBAsyncContainerPool(sizeof(ObjControllerAsyncContainer))
     , mEventPool(sizeof(ObjControllerEvent))
+    , mEnqueueChecks(0)
+    , mProcessChecks(0)
     , mDatabase(gWorldManager->getDatabase())
     , mObject(NULL)
     , mCommandQueueProcessTimeLimit(5)
@@ -90,6 +87,7 @@ ObjectController::ObjectController()
     , mInUseCommandQueue(false)
     , mRemoveCommandQueue(false)
     , mUpdatingObjects(false)
+    , mInRangeHandleIndex(0)
 {
     mSI		= gWorldManager->getSI();
     // We do have a global clock object, don't use seperate clock and times for every process.
@@ -105,6 +103,8 @@ ObjectController::ObjectController(Object* object)
     : mCmdMsgPool(sizeof(ObjControllerCommandMessage))
     , mDBAsyncContainerPool(sizeof(ObjControllerAsyncContainer))
     , mEventPool(sizeof(ObjControllerEvent))
+    , mEnqueueChecks(0)
+    , mProcessChecks(0)
     , mDatabase(gWorldManager->getDatabase())
     , mObject(object)
     , mCommandQueueProcessTimeLimit(5)
@@ -118,6 +118,7 @@ ObjectController::ObjectController(Object* object)
     , mInUseCommandQueue(false)
     , mRemoveCommandQueue(false)
     , mUpdatingObjects(false)
+    , mInRangeHandleIndex(0)
 {
     mSI		= gWorldManager->getSI();
 }
@@ -132,22 +133,6 @@ ObjectController::~ObjectController()
     // Have to kill whats in there...
     mInUseCommandQueue = false;
     clearQueues();
-
-    EnqueueValidators::iterator it = mEnqueueValidators.begin();
-
-    while(it != mEnqueueValidators.end())
-    {
-        delete(*it);
-        it = mEnqueueValidators.erase(it);
-    }
-
-    ProcessValidators::iterator pIt = mProcessValidators.begin();
-
-    while(pIt != mProcessValidators.end())
-    {
-        delete(*pIt);
-        pIt = mProcessValidators.erase(pIt);
-    }
 }
 
 //=============================================================================
@@ -240,6 +225,29 @@ bool ObjectController::process(uint64 callTime,void*)
     return(true);
 }
 
+//=============================================================================
+//
+// prefetch the creature data the checks of the next command read
+//
+
+void ObjectController::prefetchValidationInput()
+{
+    // only creatures have checks enabled
+    if(!mProcessChecks)
+        return;
+
+    CreatureObject* creature = static_cast<CreatureObject*>(mObject);
+
+    ANH_PREFETCH(&creature->states);
+    ANH_PREFETCH(&creature->getHam()->mHealth);
+    ANH_PREFETCH(&creature->getHam()->mMind);
+
+    if(!mCommandQueue.empty())
+    {
+        ANH_PREFETCH(mCommandQueue.front());
+    }
+}
+
 //=============================================================================
 //
 // remove message from queue
@@ -367,13 +375,15 @@ bool ObjectController::_processCommandQueue()
 
                 bool cmdExecutedOk = true;
 
+                Anh_Utils::ProfileScope commandScope(gObjectControllerCommands->getProfileSection(cmdProperties));
+
+                const ObjectControllerCommandMap::CommandEntry& commandEntry = gObjectControllerCommands->getCommandEntry(cmdProperties->mCommandIndex);
+
                 // call the proper handler
                 switch(cmdProperties->mCmdGroup)
                 {
                 case ObjControllerCmdGroup_Common:
                 {
-                    // Check the new style of handlers first.
-                    CommandMap::const_iterator it = gObjectControllerCommands->getCommandMap().find(command);
 
                     // Find the target object (if one is given) and pass it in.
                     Object* target = NULL;
@@ -382,8 +392,8 @@ bool ObjectController::_processCommandQueue()
                         target = gWorldManager->getObjectById(targetId);
                     }
 
-                    // If a new style handler is found process it.
-                    if (message && it != gObjectControllerCommands->getCommandMap().end()) {
+                    // Check the new style of handlers first, if one is found process it.
+                    if (message && commandEntry.mHandler) {
                         // Create a pre-command processing event.
                         auto pre_event = std::make_shared<PreCommandEvent>(mObject->getId());
                         pre_event->target_id(targetId);
@@ -392,18 +402,16 @@ bool ObjectController::_processCommandQueue()
                         // Trigger a pre-command processing event and get the result. This allows
                         // any listeners to veto the processing of the command (such as validators).
                         // Only process the command if it passed validation.
-                        if (gEventDispatcher.Deliver(pre_event).get()) {
-                            ((*it).second)(mObject, target, message, cmdProperties);
+                        if (gEventDispatcher.DeliverNow(pre_event)) {
+                            (*commandEntry.mHandler)(mObject, target, message, cmdProperties);
 
                             auto post_event = std::make_shared<PostCommandEvent>(mObject->getId());
-                            gEventDispatcher.Deliver(post_event);
+                            gEventDispatcher.DeliverNow(post_event);
                         }
                     } else {
                         // Otherwise, process the old style handler.
-                        OriginalCommandMap::iterator it = gObjControllerCmdMap.find(command);
-
-                        if (message && it != gObjControllerCmdMap.end()) {
-                            ((*it).second)(this, targetId, message, cmdProperties);
+                        if (message && commandEntry.mOriginalHandler) {
+                            (*commandEntry.mOriginalHandler)(this, targetId, message, cmdProperties);
                             //(this->*((*it).second))(targetId,message,cmdProperties);
                         } else {
                             DLOG(WARNING) << "ObjectController::processCommandQueue: ObjControllerCmdGroup_Common Unhandled Cmd 0"<<command<<" for "<<mObject->getId();
@@ -847,33 +855,40 @@ void ObjectController::removeMsgFromCommandQueueBySequence(uint32 sequence)
 
 bool ObjectController::_validateEnqueueCommand(uint32 &reply1,uint32 &reply2,uint64 targetId,uint32 opcode,ObjectControllerCmdProperties*& cmdProperties)
 {
-    EnqueueValidators::iterator it = mEnqueueValidators.begin();
+    PlayerObject* player = dynamic_cast<PlayerObject*>(mObject);
 
-    while(it != mEnqueueValidators.end())
+    if(mCommandQueue.size() >= COMMAND_QUEUE_MAX_SIZE)
     {
-        PlayerObject* player = dynamic_cast<PlayerObject*>(mObject);
-        if(this->getCommandQueue()->size() >= COMMAND_QUEUE_MAX_SIZE)
-        {
-            gMessageLib->SendSystemMessage(::common::OutOfBand("client", "too_many_commands_queued_generic"),player);
-            return(false);
-        }
-        if(!((*it)->validate(reply1,reply2,targetId,opcode,cmdProperties)))
-        {
-            if(opcode == opOCRequestCraftingSession)
-            {
-                gMessageLib->sendCraftAcknowledge(opCraftCancelResponse,0,0,player);
-            }
-            // we still failed the check but we're not sending anything back
-            // send this generic message
-            if((reply1 == 0 && reply2 == 0))
-                gMessageLib->SendSystemMessage(::common::OutOfBand("error_message", "wrong_state"), player);
-            return(false);
-        }
+        gMessageLib->SendSystemMessage(::common::OutOfBand("client", "too_many_commands_queued_generic"),player);
+        return(false);
+    }
+
+    // get the command properties
+    cmdProperties = gObjectControllerCommands->findCommand(opcode);
+
+    if(!cmdProperties)
+    {
+        // don't want to parse the annoying error, lets log it though
+        // @todo find root cause of why command isn't in the map
+        DLOG(INFO) <<  "Unknown command found " << opcode;
+        reply1 = 0;
+        reply2 = 1;
+    }
+    else if(!_checkCommand(cmdProperties,mEnqueueChecks,false,reply1,reply2))
+    {
+        return(true);
+    }
 
-        ++it;
+    if(opcode == opOCRequestCraftingSession)
+    {
+        gMessageLib->sendCraftAcknowledge(opCraftCancelResponse,0,0,player);
     }
+    // we still failed the check but we're not sending anything back
+    // send this generic message
+    if((reply1 == 0 && reply2 == 0))
+        gMessageLib->SendSystemMessage(::common::OutOfBand("error_message", "wrong_state"), player);
 
-    return(true);
+    return(false);
 }
 
 //=============================================================================
@@ -884,55 +899,159 @@ bool ObjectController::_validateEnqueueCommand(uint32 &reply1,uint32 &reply2,uin
 
 bool ObjectController::_validateProcessCommand(uint32 &reply1,uint32 &reply2,uint64 targetId,uint32 opcode,ObjectControllerCmdProperties*& cmdProperties)
 {
-    ProcessValidators::iterator it = mProcessValidators.begin();
+    if(!_checkCommand(cmdProperties,mProcessChecks,true,reply1,reply2))
+    {
+        return(true);
+    }
 
-    while(it != mProcessValidators.end())
+    PlayerObject* player = dynamic_cast<PlayerObject*>(mObject);
+    if(opcode == opOCRequestCraftingSession)
     {
-        if(!((*it)->validate(reply1,reply2,targetId,opcode,cmdProperties)))
+        gMessageLib->sendCraftAcknowledge(opCraftCancelResponse,0,0,player);
+    }
+    // we still failed the check but we're not sending anything back
+    // send this generic message
+    if(! (reply1 && reply2) )
+        gMessageLib->SendSystemMessage(::common::OutOfBand("error_message", "wrong_state"), player);
+
+    return(false);
+}
+
+//=============================================================================
+//
+// runs the command's rule against the creature
+// the replies are the ones of the first failed check, in CommandCheck order
+// http://wiki.swganh.org/index.php/CommandQueueRemove_(00000117)
+//
+
+uint32 ObjectController::_checkCommand(ObjectControllerCmdProperties* cmdProperties,uint32 checks,bool processing,uint32 &reply1,uint32 &reply2)
+{
+    const CommandRule& rule = cmdProperties->mRule;
+
+    checks &= rule.mChecks;
+
+    if(!checks)
+        return(0);
+
+    CommandValidationInput input;
+    _gatherValidationInput(cmdProperties,checks,input);
+
+    uint32 failed = rule.getFailedChecks(input,checks);
+
+    switch(failed & (~failed + 1))
+    {
+    case 0:
+        break;
+
+    case CommandCheck_Posture:
+    {
+        reply1 = kCannotDoWhileLocomotion;
+        reply2 = processing ? getLowestCommonBit(input.mPosture,rule.mPostureMask) : getLocoValidator(input.mLocomotion);
+    }
+    break;
+
+    case CommandCheck_Ability:
+    {
+        reply1 = 2;
+        reply2 = 0;
+    }
+    break;
+
+    case CommandCheck_Ham:
+    {
+        reply1 = 0;
+        reply2 = 0;
+    }
+    break;
+
+    case CommandCheck_State:
+    {
+        reply1 = kCannotDoWhileState;
+        reply2 = getLowestCommonBit(input.mActionStates,rule.mDenyStates);
+    }
+    break;
+
+    case CommandCheck_Locomotion:
+    case CommandCheck_LocomotionInState:
+    {
+        reply1 = kCannotDoWhileLocomotion;
+        reply2 = getLocoValidator(input.mLocomotion);
+    }
+    break;
+
+    case CommandCheck_Weapon:
+    {
+        reply1 = 0;
+        reply2 = 1;
+
+        if(PlayerObject* player = dynamic_cast<PlayerObject*>(mObject))
         {
-            PlayerObject* player = dynamic_cast<PlayerObject*>(mObject);
-            if(opcode == opOCRequestCraftingSession)
-            {
-                gMessageLib->sendCraftAcknowledge(opCraftCancelResponse,0,0,player);
-            }
-            // we still failed the check but we're not sending anything back
-            // send this generic message
-            if(! (reply1 && reply2) )
-                gMessageLib->SendSystemMessage(::common::OutOfBand("error_message", "wrong_state"), player);
-            return(false);
+            gMessageLib->SendSystemMessage(::common::OutOfBand("cbt_spam", "no_attack_wrong_weapon"), player);
         }
+    }
+    break;
+    }
+
+    return(failed);
+}
 
-        ++it;
+//=============================================================================
+//
+// reads what the given checks need, the ability and weapon lookups only when asked for
+//
+
+void ObjectController::_gatherValidationInput(ObjectControllerCmdProperties* cmdProperties,uint32 checks,CommandValidationInput& input)
+{
+    // only creatures have checks enabled
+    CreatureObject* creature = static_cast<CreatureObject*>(mObject);
+
+    input.mActionStates	= creature->states.action;
+    input.mPosture		= creature->states.posture;
+    input.mLocomotion	= creature->states.locomotion;
+
+    if(checks & CommandCheck_Ham)
+    {
+        Ham* ham = creature->getHam();
+
+        input.mHealth	= ham->mHealth.getCurrentHitPoints();
+        input.mAction	= ham->mAction.getCurrentHitPoints();
+        input.mMind		= ham->mMind.getCurrentHitPoints();
     }
 
-    return(true);
+    if(checks & CommandCheck_Ability)
+    {
+        input.mHasAbility = creature->verifyAbility(cmdProperties->mRule.mAbilityCrc);
+    }
+
+    if(checks & CommandCheck_Weapon)
+    {
+        input.mWeaponGroup = WeaponGroup_Unarmed;
+
+        if(Item* weapon = dynamic_cast<Item*>(creature->getEquipManager()->getEquippedObject(CreatureEquipSlot_Hold_Left)))
+        {
+            // could be an instrument
+            if(weapon->getItemFamily() == ItemFamily_Weapon)
+            {
+                input.mWeaponGroup = dynamic_cast<Weapon*>(weapon)->getGroup();
+            }
+        }
+    }
 }
 
 //=============================================================================
 //
-// setup enqueue cmd validators
-// make sure to keep the order sane
-// http://wiki.swganh.org/index.php/CommandQueueRemove_(00000117)
+// setup enqueue cmd checks, the command properties are always looked up
+//
 
 void ObjectController::initEnqueueValidators()
 {
-    //mEnqueueValidators.push_back(new EVQueueSize(this));
-    mEnqueueValidators.push_back(new EVCmdProperty(this));
-
     switch(mObject->getType())
     {
     case ObjType_Player:
-    {
-        //mEnqueueValidators.push_back(new EVSurveySample(this));
-    }
     case ObjType_NPC:
     case ObjType_Creature:
     {
-        mEnqueueValidators.push_back(new EVPosture(this));
-        mEnqueueValidators.push_back(new EVAbility(this));
-        mEnqueueValidators.push_back(new EVState(this));
-        mEnqueueValidators.push_back(new EVWeapon(this));
-        //mEnqueueValidators.push_back(new EVTarget(this));
+        mEnqueueChecks = CommandChecks_Enqueue;
     }
     break;
 
@@ -943,8 +1062,7 @@ void ObjectController::initEnqueueValidators()
 
 //=============================================================================
 //
-// setup process cmd validators
-// make sure to keep the order sane
+// setup process cmd checks
 //
 
 void ObjectController::initProcessValidators()
@@ -955,9 +1073,7 @@ void ObjectController::initProcessValidators()
     case ObjType_NPC:
     case ObjType_Creature:
     {
-        mProcessValidators.push_back(new PVPosture(this));
-        mProcessValidators.push_back(new PVHam(this));
-        mProcessValidators.push_back(new PVState(this));
+        mProcessChecks = CommandChecks_Process;
     }
     break;
 
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ObjectFactoryCallback.h"
 #include "HeightMapCallback.h"
 #include "ObjControllerEvent.h"
+#include "ObjectRegistry.h"
 #include <boost/pool/pool.hpp>
 
 // maximum commands allowed to be queued
@@ -49,6 +50,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 class Message;
 class Object;
 class ObjectControllerCmdProperties;
+class CommandValidationInput;
 class ObjectControllerCommandMap;
 class ObjControllerCommandMessage;
 class ObjectFactory;
@@ -57,8 +59,6 @@ class DatabaseResult;
 class ZoneTree;
 class ObjControllerAsyncContainer;
 class UIWindow;
-class EnqueueValidator;
-class ProcessValidator;
 class PlayerObject;
 class CraftingTool;
 class Item;
@@ -67,9 +67,6 @@ class StructureHeightmapAsyncContainer;
 
 typedef std::set<Object*>				ObjectSet;
 
-typedef std::vector<EnqueueValidator*>	EnqueueValidators;
-typedef std::vector<ProcessValidator*>	ProcessValidators;
-
 // typedef Anh_Utils::priority_vector<ObjControllerCommandMessage*,CompareCommandMsg >	CommandQueue;
 typedef std::deque<ObjControllerCommandMessage*>	CommandQueue;
 typedef Anh_Utils::priority_vector<ObjControllerEvent*,CompareEvent >				EventQueue;
@@ -196,6 +193,9 @@ public:
     // process the command queues
     bool					process(uint64 callTime,void*);
 
+    // pulls the data the command checks read into the cache, called ahead of process() in a batch
+    void					prefetchValidationInput();
+
     // inherited callbacks
     virtual void			handleDatabaseJobComplete(void* ref,DatabaseResult* result);
 
@@ -223,7 +223,7 @@ public:
     }
     void					addEvent(Anh_Utils::Event* event,uint64 timeDelta);
 
-    // command queue
+    // command queue, enable the command checks matching the object type
     void					initEnqueueValidators();
     void					initProcessValidators();
     void					enqueueCommandMessage(Message* message);
@@ -330,6 +330,10 @@ private:
     bool	_validateEnqueueCommand(uint32 &reply1,uint32 &reply2,uint64 targetId,uint32 opcode,ObjectControllerCmdProperties*& cmdProperties);
     bool	_validateProcessCommand(uint32 &reply1,uint32 &reply2,uint64 targetId,uint32 opcode,ObjectControllerCmdProperties*& cmdProperties);
 
+    // the CommandCheck bits out of checks the command fails, sets the replies for the first one
+    uint32	_checkCommand(ObjectControllerCmdProperties* cmdProperties,uint32 checks,bool processing,uint32 &reply1,uint32 &reply2);
+    void	_gatherValidationInput(ObjectControllerCmdProperties* cmdProperties,uint32 checks,CommandValidationInput& input);
+
     // process queues
     bool	_processCommandQueue();
     bool	_processEventQueue();
@@ -781,6 +785,7 @@ private:
     bool	_updateInRangeObjectsOutside();
     void	_findInRangeObjectsInside(bool updateAll);
     bool	_updateInRangeObjectsInside();
+    void	_captureInRangeHandles();
     bool	_destroyOutOfRangeObjects(ObjectSet* inRangeObjects);
 
 
@@ -796,9 +801,13 @@ private:
     EventQueue					mEventQueue;
     ObjectSet						mInRangeObjects;
     ObjectSet::iterator mObjectSetIt;
+    // handles of mInRangeObjects in set order, the updates may span several
+    // ticks and objects can be destroyed in between
+    std::vector<ObjectHandle>	mInRangeHandles;
+    uint32						mInRangeHandleIndex;
 
-    EnqueueValidators	mEnqueueValidators;
-    ProcessValidators	mProcessValidators;
+    uint32				mEnqueueChecks;
+    uint32				mProcessChecks;
 
     Database*			mDatabase;
     ZoneTree*			mSI;
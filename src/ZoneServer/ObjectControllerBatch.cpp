@@ -0,0 +1,200 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "ObjectControllerBatch.h"
+
+#include "ObjectController.h"
+
+#include "Utils/TickProfiler.h"
+#include "Utils/clock.h"
+
+//=============================================================================
+
+ObjectControllerBatch::ObjectControllerBatch(uint64 interval,uint64 processTimeLimit)
+    : mNextId(1)
+    , mInterval(interval)
+    , mProcessTimeLimit(processTimeLimit)
+    , mProfileSection(0)
+{
+}
+
+//=============================================================================
+
+ObjectControllerBatch::~ObjectControllerBatch()
+{
+}
+
+//=============================================================================
+
+uint64 ObjectControllerBatch::add(ObjectController* controller)
+{
+    uint32 slot;
+
+    if(!mFreeSlots.empty())
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32>(mEntries.size());
+        mEntries.push_back(Entry());
+    }
+
+    // upper half is a running serial, so ids of recycled slots never repeat
+    uint64 id			= (mNextId++ << 32) | (slot + 1);
+    uint64 currentTime	= Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    if(!mWheel.isStarted())
+        mWheel.start(currentTime);
+
+    mEntries[slot].mId			= id;
+    mEntries[slot].mController	= controller;
+
+    mWheel.insert(slot,currentTime + mInterval + 1);
+
+    return(id);
+}
+
+//=============================================================================
+
+void ObjectControllerBatch::remove(uint64 id)
+{
+    uint32 slot = _findSlot(id);
+
+    if(slot == kNoSlot)
+        return;
+
+    // an id still waiting in mBatch is skipped once it no longer matches
+    mWheel.remove(slot);
+    _releaseSlot(slot);
+}
+
+//=============================================================================
+
+bool ObjectControllerBatch::contains(uint64 id) const
+{
+    return(_findSlot(id) != kNoSlot);
+}
+
+//=============================================================================
+
+void ObjectControllerBatch::process()
+{
+    uint64 startTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    Anh_Utils::ProfileScope processScope(mProfileSection);
+
+    mWheel.advance(startTime,mExpired);
+
+    // take the ids now, slots may be released and reused while the batch runs
+    std::vector<uint32>::iterator expiredIt = mExpired.begin();
+
+    while(expiredIt != mExpired.end())
+    {
+        mBatch.push_back(mEntries[*expiredIt].mId);
+        ++expiredIt;
+    }
+
+    mExpired.clear();
+
+    uint32 done = 0;
+
+    while(done < mBatch.size())
+    {
+        uint64 id	= mBatch[done++];
+        uint32 slot	= _findSlot(id);
+
+        if(slot == kNoSlot)
+            continue;
+
+        if(done < mBatch.size())
+        {
+            uint32 nextSlot = _findSlot(mBatch[done]);
+
+            if(nextSlot != kNoSlot)
+            {
+                mEntries[nextSlot].mController->prefetchValidationInput();
+            }
+        }
+
+        uint64	currentTime	= Anh_Utils::Clock::getSingleton()->getLocalTime();
+        bool	keep		= mEntries[slot].mController->process(currentTime,NULL);
+
+        // the controller may have been removed while it ran
+        if(mEntries[slot].mId == id)
+        {
+            if(keep)
+            {
+                mWheel.insert(slot,currentTime + mInterval + 1);
+            }
+            else
+            {
+                _releaseSlot(slot);
+            }
+        }
+
+        if((Anh_Utils::Clock::getSingleton()->getLocalTime() - startTime) >= mProcessTimeLimit)
+            break;
+    }
+
+    mBatch.erase(mBatch.begin(),mBatch.begin() + done);
+}
+
+//=============================================================================
+
+uint64 ObjectControllerBatch::getNextDeadline() const
+{
+    return(mBatch.empty() ? mWheel.getNextDue() : 0);
+}
+
+//=============================================================================
+
+uint32 ObjectControllerBatch::_findSlot(uint64 id) const
+{
+    uint32 slot = static_cast<uint32>(id & 0xffffffff);
+
+    if(slot == 0 || slot > mEntries.size())
+        return(kNoSlot);
+
+    --slot;
+
+    if(mEntries[slot].mId != id)
+        return(kNoSlot);
+
+    return(slot);
+}
+
+//=============================================================================
+
+void ObjectControllerBatch::_releaseSlot(uint32 slot)
+{
+    mEntries[slot].mId			= 0;
+    mEntries[slot].mController	= NULL;
+
+    mFreeSlots.push_back(slot);
+}
@@ -0,0 +1,103 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_OBJECT_CONTROLLER_BATCH_H
+#define ANH_ZONESERVER_OBJECT_CONTROLLER_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Utils/TimingWheel.h"
+#include "Utils/typedefs.h"
+
+class ObjectController;
+
+//=============================================================================
+//
+// The object controllers with queued commands or events.
+// Every controller that is due is run in one pass, in deadline order, and the
+// creature data the next controller's command checks read is prefetched while
+// the current one runs.
+// Ids encode the slot in the lower 32 bits like the scheduler task ids, so a
+// controller can be removed from within the pass.
+//
+
+class ObjectControllerBatch
+{
+public:
+
+    ObjectControllerBatch(uint64 interval,uint64 processTimeLimit);
+    ~ObjectControllerBatch();
+
+    uint64	add(ObjectController* controller);
+    void	remove(uint64 id);
+    bool	contains(uint64 id) const;
+
+    // controllers left over when the time limit is hit run first on the next call
+    void	process();
+
+    // earliest time a process() call can have work, TimingWheel::kNever if empty
+    uint64	getNextDeadline() const;
+
+    uint32	size() const {
+        return(static_cast<uint32>(mEntries.size() - mFreeSlots.size()));
+    }
+
+    void	setProfileSection(uint32 section) {
+        mProfileSection = section;
+    }
+
+private:
+
+    static const uint32 kNoSlot = 0xffffffff;
+
+    class Entry
+    {
+    public:
+
+        Entry() : mId(0),mController(NULL) {}
+
+        uint64				mId;
+        ObjectController*	mController;
+    };
+
+    uint32	_findSlot(uint64 id) const;
+    void	_releaseSlot(uint32 slot);
+
+    std::vector<Entry>		mEntries;
+    std::vector<uint32>		mFreeSlots;
+    Anh_Utils::TimingWheel	mWheel;
+    std::vector<uint32>		mExpired;
+    std::vector<uint64>		mBatch;
+
+    uint64					mNextId;
+    uint64					mInterval;
+    uint64					mProcessTimeLimit;
+    uint32					mProfileSection;
+};
+
+#endif
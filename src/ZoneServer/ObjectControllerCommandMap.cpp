@@ -40,6 +40,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/DataBinding.h"
 #include "DatabaseManager/DatabaseResult.h"
 #include "NetworkManager/Message.h"
+#include "Utils/TickProfiler.h"
 #include "ArtisanManager.h"
 #include "OCCommonHandlers.h"
 #include "OCStructureHandlers.h"
@@ -174,6 +175,8 @@ void ObjectControllerCommandMap::handleDatabaseJobComplete(void* ref,DatabaseRes
 
     mDatabase->destroyDataBinding(binding);
 
+    _buildCommandTable();
+
     LOG_IF(INFO, !mCmdPropertyMap.empty()) << "Mapped " << mCmdPropertyMap.size() << " commands";
 }
 
@@ -181,6 +184,135 @@ const CommandMap& ObjectControllerCommandMap::getCommandMap() {
     return command_map_;
 }
 
+//======================================================================================================================
+
+ObjectControllerCmdProperties* ObjectControllerCommandMap::findCommand(uint32 cmdCrc) const
+{
+    std::unordered_map<uint32,uint32>::const_iterator it = mCommandIndices.find(cmdCrc);
+
+    if(it == mCommandIndices.end())
+    {
+        return(NULL);
+    }
+
+    return(mCommandTable[(*it).second].mProperties);
+}
+
+//======================================================================================================================
+//
+// The handler maps are filled in the constructor, so both are complete once the properties arrive.
+//
+
+void ObjectControllerCommandMap::_buildCommandTable()
+{
+    mCommandTable.clear();
+    mCommandIndices.clear();
+
+    mCommandTable.reserve(mCmdPropertyMap.size());
+
+    CmdPropertyMap::iterator it = mCmdPropertyMap.begin();
+
+    while(it != mCmdPropertyMap.end())
+    {
+        ObjectControllerCmdProperties* cmdProperties = (*it).second;
+
+        CommandEntry entry;
+        entry.mProperties = cmdProperties;
+
+        CommandMap::const_iterator handlerIt = command_map_.find(cmdProperties->mCmdCrc);
+
+        if(handlerIt != command_map_.end())
+        {
+            entry.mHandler = &(*handlerIt).second;
+        }
+
+        OriginalCommandMap::const_iterator originalIt = mCommandMap.find(cmdProperties->mCmdCrc);
+
+        if(originalIt != mCommandMap.end())
+        {
+            entry.mOriginalHandler = &(*originalIt).second;
+        }
+
+        cmdProperties->mCommandIndex = static_cast<uint32>(mCommandTable.size());
+        cmdProperties->mRule.compile(cmdProperties);
+
+        mCommandIndices.insert(std::make_pair(cmdProperties->mCmdCrc,cmdProperties->mCommandIndex));
+        mCommandTable.push_back(entry);
+
+        ++it;
+    }
+}
+
+//======================================================================================================================
+
+void CommandRule::compile(const ObjectControllerCmdProperties* cmdProperties)
+{
+    mPostureMask			= cmdProperties->mPostureMask;
+    mDenyStates				= cmdProperties->mStates;
+    mDenyLocomotion			= cmdProperties->mLocomotionMask;
+    mAbilityCrc				= cmdProperties->mAbilityCrc;
+    mRequiredWeaponGroup	= cmdProperties->mRequiredWeaponGroup;
+    mHealthCost				= cmdProperties->mHealthCost;
+    mActionCost				= cmdProperties->mActionCost;
+    mMindCost				= cmdProperties->mMindCost;
+
+    // the posture mask is checked for every command
+    mChecks = CommandCheck_Posture;
+
+    if(mAbilityCrc)
+        mChecks |= CommandCheck_Ability;
+
+    if(mHealthCost || mActionCost || mMindCost)
+        mChecks |= CommandCheck_Ham;
+
+    if(mDenyStates)
+        mChecks |= CommandCheck_State;
+
+    if(mDenyLocomotion)
+        mChecks |= CommandCheck_Locomotion;
+
+    if(mDenyStates && mDenyLocomotion)
+        mChecks |= CommandCheck_LocomotionInState;
+
+    if(mRequiredWeaponGroup)
+        mChecks |= CommandCheck_Weapon;
+}
+
+//======================================================================================================================
+//
+// All checks are evaluated as plain flag arithmetic, the ones that don't apply are masked off at the end.
+//
+
+uint32 CommandRule::getFailedChecks(const CommandValidationInput& input,uint32 checks) const
+{
+    uint32 postureBit		= 1 << input.mPosture;
+    uint64 deniedStates		= input.mActionStates & mDenyStates;
+    uint32 deniedLocomotion	= static_cast<uint32>((mDenyLocomotion & input.mLocomotion) != 0);
+    uint32 failed			= 0;
+
+    failed |= static_cast<uint32>((mPostureMask & postureBit) != postureBit) * CommandCheck_Posture;
+    failed |= static_cast<uint32>(!input.mHasAbility) * CommandCheck_Ability;
+    failed |= static_cast<uint32>((input.mHealth <= mHealthCost) | (input.mAction <= mActionCost) | (input.mMind <= mMindCost)) * CommandCheck_Ham;
+    failed |= static_cast<uint32>(deniedStates == mDenyStates) * CommandCheck_State;
+    failed |= deniedLocomotion * CommandCheck_Locomotion;
+    failed |= (deniedLocomotion & static_cast<uint32>(deniedStates != 0)) * CommandCheck_LocomotionInState;
+    failed |= static_cast<uint32>((input.mWeaponGroup & mRequiredWeaponGroup) != input.mWeaponGroup) * CommandCheck_Weapon;
+
+    return(failed & mChecks & checks);
+}
+
+//======================================================================================================================
+
+uint32 ObjectControllerCommandMap::getProfileSection(ObjectControllerCmdProperties* cmdProperties)
+{
+    if(!cmdProperties->mProfileSection && gTickProfiler)
+    {
+        cmdProperties->mProfileSection = gTickProfiler->registerSection(std::string("command/") + cmdProperties->mCommandStr.getAnsi());
+    }
+
+    return(cmdProperties->mProfileSection);
+}
+
 //======================================================================================================================
 //
 // setup cpp hooks
@@ -31,6 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <functional>  // NOLINT
@@ -68,6 +70,78 @@ typedef std::map<uint32,ObjectControllerHandler> CommandMap;
 
 typedef std::map<uint32_t,ObjectControllerCmdProperties*>	CmdPropertyMap;
 
+//======================================================================================================================
+//
+// The checks a command can fail before it is queued or run.
+// The bits follow the order the checks are reported in, so the lowest failed bit is the one the client gets told about.
+//
+
+enum CommandCheck
+{
+    CommandCheck_Posture			= 0x01,
+    CommandCheck_Ability			= 0x02,
+    CommandCheck_Ham				= 0x04,
+    CommandCheck_State				= 0x08,
+    CommandCheck_Locomotion			= 0x10,
+    CommandCheck_LocomotionInState	= 0x20,	// locomotion, only looked at while one of the denied states is set
+    CommandCheck_Weapon				= 0x40,
+
+    CommandChecks_Enqueue			= CommandCheck_Posture | CommandCheck_Ability | CommandCheck_State | CommandCheck_Locomotion | CommandCheck_Weapon,
+    CommandChecks_Process			= CommandCheck_Posture | CommandCheck_Ham | CommandCheck_State | CommandCheck_LocomotionInState
+};
+
+//======================================================================================================================
+//
+// everything about the creature the command checks look at, gathered once per command
+//
+
+class CommandValidationInput
+{
+public:
+
+    CommandValidationInput()
+        : mActionStates(0),mPosture(0),mLocomotion(0),mWeaponGroup(0),mHealth(0),mAction(0),mMind(0),mHasAbility(true) {}
+
+    uint64	mActionStates;
+    uint32	mPosture;
+    uint32	mLocomotion;
+    uint32	mWeaponGroup;
+    int32	mHealth;
+    int32	mAction;
+    int32	mMind;
+    bool	mHasAbility;
+};
+
+//======================================================================================================================
+//
+// A command's validation data, compiled from its properties when the command table is loaded.
+// mChecks only holds the checks the command can fail at all.
+//
+
+class CommandRule
+{
+public:
+
+    CommandRule()
+        : mPostureMask(0),mDenyStates(0),mDenyLocomotion(0),mAbilityCrc(0),mRequiredWeaponGroup(0)
+        , mHealthCost(0),mActionCost(0),mMindCost(0),mChecks(0) {}
+
+    void	compile(const ObjectControllerCmdProperties* cmdProperties);
+
+    // the CommandCheck bits out of checks this command fails for the given input
+    uint32	getFailedChecks(const CommandValidationInput& input,uint32 checks) const;
+
+    uint64	mPostureMask;
+    uint64	mDenyStates;
+    uint64	mDenyLocomotion;
+    uint32	mAbilityCrc;
+    uint32	mRequiredWeaponGroup;
+    int32	mHealthCost;
+    int32	mActionCost;
+    int32	mMindCost;
+    uint32	mChecks;
+};
+
 //======================================================================================================================
 
 class ObjectControllerCommandMap : public DatabaseCallback
@@ -85,6 +159,29 @@ public:
 
     const CommandMap& getCommandMap();
 
+    // a loaded command and its handlers, indexed by ObjectControllerCmdProperties::mCommandIndex
+    class CommandEntry
+    {
+    public:
+
+        CommandEntry()
+            : mProperties(NULL),mHandler(NULL),mOriginalHandler(NULL) {}
+
+        ObjectControllerCmdProperties*			mProperties;
+        const ObjectControllerHandler*			mHandler;
+        const OriginalObjectControllerHandler*	mOriginalHandler;
+    };
+
+    // NULL if the command is unknown
+    ObjectControllerCmdProperties*		findCommand(uint32 cmdCrc) const;
+
+    const CommandEntry&					getCommandEntry(uint32 commandIndex) const {
+        return(mCommandTable[commandIndex]);
+    }
+
+    // TickProfiler section timing this command's handler, registered on first use
+    uint32								getProfileSection(ObjectControllerCmdProperties* cmdProperties);
+
     ~ObjectControllerCommandMap();
 
     OriginalCommandMap				mCommandMap;
@@ -97,6 +194,9 @@ private:
 
     void								_registerCppHooks();
 
+    // remaps the loaded commands to dense indices and resolves their handlers and rules
+    void								_buildCommandTable();
+
     // This is here for utility purposes during the transition and is used to load
     // up the new command map.
     void RegisterCppHooks_();
@@ -105,6 +205,9 @@ private:
     static ObjectControllerCommandMap*	mSingleton;
     CommandMap  command_map_;
     Database*							mDatabase;
+
+    std::vector<CommandEntry>			mCommandTable;
+    std::unordered_map<uint32,uint32>	mCommandIndices;
 };
 
 //======================================================================================================================
@@ -114,10 +217,10 @@ class ObjectControllerCmdProperties
 public:
 
     ObjectControllerCmdProperties()
-        :mCmdCrc(0),mAbilityCrc(0),mStates(0),mCmdGroup(0) {}
+        :mCmdCrc(0),mAbilityCrc(0),mStates(0),mCmdGroup(0),mProfileSection(0),mCommandIndex(0) {}
 
     ObjectControllerCmdProperties(uint32 cmdCrc,uint32 abilityCrc,uint64 states,uint8 cmdGroup)
-        : mCmdCrc(cmdCrc),mAbilityCrc(abilityCrc),mStates(states),mCmdGroup(cmdGroup) {}
+        : mCmdCrc(cmdCrc),mAbilityCrc(abilityCrc),mStates(states),mCmdGroup(cmdGroup),mProfileSection(0),mCommandIndex(0) {}
 
     ~ObjectControllerCmdProperties() {}
 
@@ -128,6 +231,9 @@ public:
     uint32	mAbilityCrc;
     uint64	mStates;
     uint8	mCmdGroup;
+    uint32	mProfileSection;
+    uint32	mCommandIndex;
+    CommandRule	mRule;
     BString	mScriptHook;
     BString	mFailScriptHook;
     BString	mCommandStr;
@@ -57,6 +57,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "IntangibleFactory.h"
 #include "ManufacturingSchematic.h"
 #include "ObjectFactoryCallback.h"
+#include "ObjectIdLease.h"
 #include "PlayerObject.h"
 #include "Inventory.h"
 #include "PlayerObjectFactory.h"
@@ -66,6 +67,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TangibleFactory.h"
 #include "TravelMapHandler.h"
 #include "WaypointFactory.h"
+#include "WaypointObject.h"
+#include "WorldConfig.h"
 #include "WorldManager.h"
 
 using std::stringstream;
@@ -93,6 +96,7 @@ ObjectFactory*	ObjectFactory::Init(Database* database)
 
 ObjectFactory::ObjectFactory(Database* database) :
     mDatabase(database),
+    mIdLease(NULL),
     mDbAsyncPool(sizeof(OFAsyncContainer))
 {
     mPlayerObjectFactory	= PlayerObjectFactory::Init(mDatabase);
@@ -111,6 +115,9 @@ ObjectFactory::ObjectFactory(Database* database) :
 
 ObjectFactory::~ObjectFactory()
 {
+    delete(mIdLease);
+    mIdLease = NULL;
+
     mInsFlag = false;
     delete(mSingleton);
 }
@@ -120,6 +127,171 @@ ObjectFactory::~ObjectFactory()
 void ObjectFactory::handleDatabaseJobComplete(void* ref,DatabaseResult* result)
 {}
 
+//=============================================================================
+
+bool ObjectFactory::startIdLease(uint32 zoneId,uint64 base)
+{
+    ObjectIdLease* idLease = new ObjectIdLease(mDatabase,zoneId,base);
+
+    if(!idLease->init())
+    {
+        delete(idLease);
+        return(false);
+    }
+
+    mIdLease = idLease;
+    return(true);
+}
+
+//=============================================================================
+
+void ObjectFactory::process()
+{
+    while(mIdLease && !mNewWaypoints.empty())
+    {
+        uint64 id = mIdLease->getNextId();
+        if(!id)
+            break;
+
+        NewWaypoint& newWaypoint = mNewWaypoints.front();
+
+        // the requesting datapad may be gone by now
+        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(newWaypoint.mOwnerId));
+        if(player && player->getDataPad())
+        {
+            _createWaypoint(player->getDataPad(),id,newWaypoint);
+        }
+
+        mNewWaypoints.pop_front();
+    }
+
+    _flushRows();
+}
+
+//=============================================================================
+//
+// rows of objects created in memory, written once per tick with one insert
+// per table. the objects are known to the clients before the rows exist, so
+// anything touching them in the db has to go through executeRowSql
+//
+
+void ObjectFactory::_queueRow(const std::string& insert,uint64 id,const std::string& values)
+{
+    mPendingRows[insert].push_back(std::make_pair(id,values));
+    mUnwrittenRows[id];
+}
+
+//=============================================================================
+//
+// runs a statement on the row of an object, once its insert is done if the
+// row is still queued or being written
+//
+
+void ObjectFactory::executeRowSql(uint64 id,const std::string& sql)
+{
+    Database* database = mDatabase;
+
+    _afterRowWritten(id,[=] () {
+        database->executeAsyncSql(sql);
+    });
+}
+
+//=============================================================================
+
+void ObjectFactory::_afterRowWritten(uint64 id,const RowStatement& statement)
+{
+    RowStatementMap::iterator it = mUnwrittenRows.find(id);
+
+    if(it == mUnwrittenRows.end())
+    {
+        statement();
+        return;
+    }
+
+    (*it).second.push_back(statement);
+}
+
+//=============================================================================
+
+void ObjectFactory::_rowsWritten(const std::vector<uint64>& ids)
+{
+    for(uint32 i = 0; i < ids.size(); i++)
+    {
+        RowStatementMap::iterator it = mUnwrittenRows.find(ids[i]);
+
+        if(it == mUnwrittenRows.end())
+            continue;
+
+        RowStatements statements;
+        statements.swap((*it).second);
+        mUnwrittenRows.erase(it);
+
+        for(uint32 j = 0; j < statements.size(); j++)
+        {
+            statements[j]();
+        }
+    }
+}
+
+//=============================================================================
+
+bool ObjectFactory::_dropPendingRow(uint64 id)
+{
+    PendingRowMap::iterator tableIt = mPendingRows.begin();
+    while(tableIt != mPendingRows.end())
+    {
+        PendingRows::iterator rowIt = (*tableIt).second.begin();
+        while(rowIt != (*tableIt).second.end())
+        {
+            if((*rowIt).first == id)
+            {
+                // nothing reached the db yet, neither does anything waiting on the row
+                (*tableIt).second.erase(rowIt);
+                mUnwrittenRows.erase(id);
+                return(true);
+            }
+            ++rowIt;
+        }
+        ++tableIt;
+    }
+
+    return(false);
+}
+
+//=============================================================================
+
+void ObjectFactory::_flushRows()
+{
+    PendingRowMap::iterator tableIt = mPendingRows.begin();
+    while(tableIt != mPendingRows.end())
+    {
+        PendingRows& rows = (*tableIt).second;
+
+        for(uint32 first = 0; first < rows.size(); first += MaxRowsPerInsert)
+        {
+            uint32 last = std::min<uint32>(first + MaxRowsPerInsert,static_cast<uint32>(rows.size()));
+
+            stringstream query_stream;
+            query_stream << (*tableIt).first;
+
+            std::vector<uint64> ids;
+
+            for(uint32 i = first; i < last; i++)
+            {
+                query_stream << (i == first ? "" : ",") << rows[i].second;
+                ids.push_back(rows[i].first);
+            }
+
+            mDatabase->executeAsyncSql(query_stream,[=] (DatabaseResult* result) {
+                _rowsWritten(ids);
+            });
+        }
+
+        rows.clear();
+        ++tableIt;
+    }
+}
+
 //=============================================================================
 //
 // create a new manufacture schematic with default values
@@ -204,6 +376,9 @@ void ObjectFactory::requestNewDefaultItem(ObjectFactoryCallback* ofCallback, uin
 //=============================================================================
 //
 // create a new item with default attributes
+// TODO: still created by the db, sf_DefaultItemCreate fills the item and its
+// attributes from the template tables. moving it to leased ids means building
+// those rows here and queueing them with _queueRow like waypoints
 //
 void ObjectFactory::requestNewDefaultItem(ObjectFactoryCallback* ofCallback,uint32 familyId,uint32 typeId,uint64 parentId,uint16 planetId, const glm::vec3& position, const BString& customName)
 {
@@ -300,6 +475,7 @@ void ObjectFactory::requestNewTravelTicket(ObjectFactoryCallback* ofCallback,Tic
 //=============================================================================
 //
 // create a new resource container
+// TODO: still created by the db like requestNewDefaultItem
 //
 void ObjectFactory::requestNewResourceContainer(ObjectFactoryCallback* ofCallback,uint64 resourceId,uint64 parentId,uint16 planetId,uint32 amount)
 {
@@ -628,6 +804,30 @@ void ObjectFactory::requestnewHousebyDeed(ObjectFactoryCallback* ofCallback,Deed
 void ObjectFactory::requestNewWaypoint(ObjectFactoryCallback* ofCallback,BString name, const glm::vec3& coords,uint16 planetId,uint64 ownerId,uint8 wpType)
 {
     PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(ownerId));
+
+    // leased ids, the waypoint exists right away and its row follows
+    if(mIdLease)
+    {
+        NewWaypoint newWaypoint;
+        newWaypoint.mName		= name;
+        newWaypoint.mCoords		= coords;
+        newWaypoint.mOwnerId	= ownerId;
+        newWaypoint.mPlanetId	= planetId;
+        newWaypoint.mType		= wpType;
+
+        // waypoints never go through sf_WaypointCreate once we lease, its auto increment
+        // ids would end up in the leased range. so if we ran dry wait for the next block
+        uint64 id = mNewWaypoints.empty() ? mIdLease->getNextId() : 0;
+        if(!id)
+        {
+            mNewWaypoints.push_back(newWaypoint);
+            return;
+        }
+
+        _createWaypoint(ofCallback,id,newWaypoint);
+        return;
+    }
+
     BString newBStr(name);
     newBStr.convert(BSTRType_ANSI);
     std::string strName(mDatabase->escapeString(newBStr.getAnsi()));
@@ -650,6 +850,37 @@ void ObjectFactory::requestNewWaypoint(ObjectFactoryCallback* ofCallback,BString
         mWaypointFactory->requestObject(ofCallback, result_set->getUInt64(1) ,0,0, player->getClient());
     });
 }
+
+//=============================================================================
+
+void ObjectFactory::_createWaypoint(ObjectFactoryCallback* ofCallback,uint64 id,const NewWaypoint& newWaypoint)
+{
+    PlayerObject*	player		= dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(newWaypoint.mOwnerId));
+    BString			planetName	= gWorldManager->getPlanetNameById(static_cast<uint8>(newWaypoint.mPlanetId));
+
+    WaypointObject* waypoint = mWaypointFactory->createWaypoint(id,newWaypoint.mOwnerId,newWaypoint.mName,newWaypoint.mCoords,planetName,newWaypoint.mType);
+
+    BString newBStr(newWaypoint.mName);
+    newBStr.convert(BSTRType_ANSI);
+
+    stringstream row_stream;
+    row_stream << "(" << id << "," << newWaypoint.mOwnerId << "," << newWaypoint.mCoords.x << ","
+               << newWaypoint.mCoords.y << "," << newWaypoint.mCoords.z << ",'"
+               << mDatabase->escapeString(newBStr.getAnsi()) << "'," << newWaypoint.mPlanetId << ","
+               << (int)waypoint->getActive() << "," << (int)newWaypoint.mType << ")";
+
+    _queueRow("INSERT INTO waypoints (waypoint_id,owner_id,x,y,z,name,planet_id,active,type) VALUES ",id,row_stream.str());
+
+    // can't check waypoints on other planets in tutorial
+    if(gWorldConfig->isTutorial())
+    {
+        delete(waypoint);
+        return;
+    }
+
+    ofCallback->handleObjectReady(waypoint,player ? player->getClient() : NULL);
+}
+
 //=============================================================================
 //
 // update existing waypoint
@@ -665,25 +896,30 @@ void ObjectFactory::requestUpdatedWaypoint(ObjectFactoryCallback* ofCallback,uin
     query_stream << "CALL sp_WaypointUpdate('" << strName << "',"
                  << wpId << "," << coords.x << "," << coords.y << ","
                  << coords.z << "," << planetId << "," << activeStatus << ")";
-    mDatabase->executeAsyncProcedure(query_stream, [=](DatabaseResult* result) {
-        if (!result) {
-            return;
-        }
+    std::string query = query_stream.str();
 
-        std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+    // a waypoint created this tick has to be written before it can be updated
+    _afterRowWritten(wpId,[=] () {
+        mDatabase->executeAsyncProcedure(query, [=](DatabaseResult* result) {
+            if (!result) {
+                return;
+            }
 
-        if (!result_set->next()) {
-            LOG(WARNING) << "Unable to update waypoint ";
-            return;
-        }
-        if (result_set->getInt(1) != 0)
-        {
-            LOG(WARNING) << "Unable to update waypoint, sql failed with error: " << result_set->getInt(1);
-        }
-        else
-        {
-            mWaypointFactory->requestObject(ofCallback,wpId,0,0,player->getClient());
-        }
+            std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+            if (!result_set->next()) {
+                LOG(WARNING) << "Unable to update waypoint ";
+                return;
+            }
+            if (result_set->getInt(1) != 0)
+            {
+                LOG(WARNING) << "Unable to update waypoint, sql failed with error: " << result_set->getInt(1);
+            }
+            else
+            {
+                mWaypointFactory->requestObject(ofCallback,wpId,0,0,player->getClient());
+            }
+        });
     });
 }
 //=============================================================================
@@ -962,6 +1198,11 @@ void ObjectFactory::deleteObjectFromDB(Object* object)
         query_stream.str(std::string());
         query_stream << "DELETE FROM structure_attributes WHERE Structure_id = " <<  object->getId();
         mDatabase->executeAsyncSql(query_stream);
+
+        //last settlement
+        query_stream.str(std::string());
+        query_stream << "DELETE FROM structure_settlement WHERE structure_id = " <<  object->getId();
+        mDatabase->executeAsyncSql(query_stream);
     }
     break;
     case ObjType_Structure:
@@ -993,13 +1234,22 @@ void ObjectFactory::deleteObjectFromDB(Object* object)
         query_stream.str(std::string());
         query_stream << "DELETE FROM harvester_resources WHERE ID = " <<  object->getId();
         mDatabase->executeAsyncSql(query_stream);
+
+        //last settlement
+        query_stream.str(std::string());
+        query_stream << "DELETE FROM structure_settlement WHERE structure_id = " <<  object->getId();
+        mDatabase->executeAsyncSql(query_stream);
     }
     break;
 
     case ObjType_Waypoint:
     {
+        // created this tick, the row was not written yet
+        if(_dropPendingRow(object->getId()))
+            break;
+
         query_stream << "DELETE FROM waypoints WHERE waypoint_id = " <<  object->getId();
-        mDatabase->executeAsyncSql(query_stream);
+        executeRowSql(object->getId(),query_stream.str());
     }
     break;
 
@@ -37,6 +37,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <glm/glm.hpp>
 #include <boost/pool/pool.hpp>
 
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
 #define 	gObjectFactory	ObjectFactory::getSingletonPtr()
 
 class BuildingFactory;
@@ -52,6 +58,7 @@ class IntangibleFactory;
 class OFAsyncContainer;
 class Object;
 class ObjectFactoryCallback;
+class ObjectIdLease;
 class PlayerObject;
 class PlayerObjectFactory;
 class RegionFactory;
@@ -115,10 +122,52 @@ public:
 
     void					releaseAllPoolsMemory();
 
+    // new objects that can be built in memory get their ids from leased blocks,
+    // without a lease they are created by the db as before
+    // TODO: only waypoints are so far, items and resource containers still wait on
+    // sf_DefaultItemCreate / sf_ResourceContainerCreate (see requestNewDefaultItem)
+    bool					startIdLease(uint32 zoneId,uint64 base);
+
+    // creates queued objects once ids are available again and writes the
+    // rows of the objects created this tick
+    void					process();
+
+    // for statements on the row of an object that may have been created in
+    // memory, they wait for its insert if it was not written yet
+    void					executeRowSql(uint64 id,const std::string& sql);
+
 private:
 
+    enum
+    {
+        MaxRowsPerInsert = 64
+    };
+
+    struct NewWaypoint
+    {
+        BString		mName;
+        glm::vec3	mCoords;
+        uint64		mOwnerId;
+        uint16		mPlanetId;
+        uint8		mType;
+    };
+
+    typedef std::deque<NewWaypoint>							NewWaypointQueue;
+    typedef std::vector<std::pair<uint64,std::string> >	PendingRows;
+    typedef std::map<std::string,PendingRows>				PendingRowMap;	// insert statement head, rows
+    typedef std::function<void ()>							RowStatement;
+    typedef std::vector<RowStatement>						RowStatements;
+    typedef std::map<uint64,RowStatements>					RowStatementMap;	// unwritten row, what waits on it
+
     ObjectFactory(Database* database);
 
+    void					_createWaypoint(ObjectFactoryCallback* ofCallback,uint64 id,const NewWaypoint& newWaypoint);
+    void					_queueRow(const std::string& insert,uint64 id,const std::string& values);
+    bool					_dropPendingRow(uint64 id);
+    void					_flushRows();
+    void					_afterRowWritten(uint64 id,const RowStatement& statement);
+    void					_rowsWritten(const std::vector<uint64>& ids);
+
     static ObjectFactory*	mSingleton;
     static bool			mInsFlag;
 
@@ -135,6 +184,11 @@ private:
     FactoryFactory*			mFactoryFactory;
     HouseFactory*			mHouseFactory;
 
+    ObjectIdLease*			mIdLease;
+    NewWaypointQueue		mNewWaypoints;
+    PendingRowMap			mPendingRows;
+    RowStatementMap			mUnwrittenRows;
+
     boost::pool<boost::default_user_allocator_malloc_free>	mDbAsyncPool;
 };
 
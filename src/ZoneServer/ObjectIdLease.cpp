@@ -0,0 +1,193 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "ObjectIdLease.h"
+
+#ifdef _WIN32
+#undef ERROR
+#endif
+#include <glog/logging.h>
+
+#include "DatabaseManager/Database.h"
+#include "DatabaseManager/DatabaseResult.h"
+
+#include <cppconn/resultset.h>
+
+#include <sstream>
+
+//=============================================================================
+
+ObjectIdLease::ObjectIdLease(Database* database,uint32 zoneId,uint64 base)
+    : mDatabase(database)
+    , mBase(base)
+    , mZoneId(zoneId)
+    , mLeaseCount(0)
+    , mRequestPending(false)
+{
+}
+
+//=============================================================================
+
+ObjectIdLease::~ObjectIdLease()
+{
+}
+
+//=============================================================================
+
+bool ObjectIdLease::init()
+{
+    DatabaseResult* result = mDatabase->executeSynchSql("CREATE TABLE IF NOT EXISTS object_id_leases ("
+                             "lease_id BIGINT UNSIGNED NOT NULL AUTO_INCREMENT,"
+                             "zone_id INT UNSIGNED NOT NULL,"
+                             "leased_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+                             "PRIMARY KEY (lease_id)) ENGINE=InnoDB");
+    mDatabase->destroyResult(result);
+
+    // synchronous queries share one connection, so the insert id can be read right after
+    result = mDatabase->executeSynchSql("INSERT INTO object_id_leases (zone_id) VALUES (%u)",mZoneId);
+    mDatabase->destroyResult(result);
+
+    result = mDatabase->executeSynchSql("SELECT ROW_COUNT(), LAST_INSERT_ID()");
+
+    uint64 leaseId = _readLease(result);
+
+    mDatabase->destroyResult(result);
+
+    if(!leaseId)
+    {
+        LOG(ERROR) << "ObjectIdLease: unable to lease object ids";
+        return(false);
+    }
+
+    _addLease(leaseId);
+    return(true);
+}
+
+//=============================================================================
+
+uint64 ObjectIdLease::getNextId()
+{
+    if(mBlocks.empty())
+    {
+        if(!mRequestPending)
+            _requestLease();
+
+        return(0);
+    }
+
+    std::pair<uint64,uint64>& block = mBlocks.front();
+    uint64 id = block.first++;
+
+    if(block.first == block.second)
+    {
+        mBlocks.pop_front();
+    }
+
+    if(!mRequestPending && getAvailableCount() < LowWatermark)
+    {
+        _requestLease();
+    }
+
+    return(id);
+}
+
+//=============================================================================
+
+uint64 ObjectIdLease::getAvailableCount() const
+{
+    uint64 count = 0;
+
+    LeaseBlocks::const_iterator it = mBlocks.begin();
+    while(it != mBlocks.end())
+    {
+        count += (*it).second - (*it).first;
+        ++it;
+    }
+
+    return(count);
+}
+
+//=============================================================================
+//
+// the result holds the rows the lease insert affected and the lease id it generated
+//
+
+uint64 ObjectIdLease::_readLease(DatabaseResult* result)
+{
+    if(!result || !result->getResultSet() || !result->getResultSet()->next())
+    {
+        return(0);
+    }
+
+    std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+    if(result_set->getInt64(1) != 1)
+    {
+        LOG(WARNING) << "ObjectIdLease: lease insert affected " << result_set->getInt64(1) << " rows";
+        return(0);
+    }
+
+    return(result_set->getUInt64(2));
+}
+
+//=============================================================================
+
+void ObjectIdLease::_requestLease()
+{
+    mRequestPending = true;
+
+    std::stringstream insert_stream;
+    insert_stream << "INSERT INTO object_id_leases (zone_id) VALUES (" << mZoneId << ")";
+
+    mDatabase->executeAsyncInsert(insert_stream.str(), [=] (DatabaseResult* result) {
+        mRequestPending = false;
+
+        uint64 leaseId = _readLease(result);
+
+        if(!leaseId)
+        {
+            LOG(WARNING) << "ObjectIdLease: lease failed";
+            return;
+        }
+
+        _addLease(leaseId);
+    });
+}
+
+//=============================================================================
+
+void ObjectIdLease::_addLease(uint64 leaseId)
+{
+    uint64 first = mBase + (leaseId - 1) * BlockSize;
+
+    mBlocks.push_back(std::make_pair(first,first + BlockSize));
+    mLeaseCount++;
+
+    DLOG(INFO) << "ObjectIdLease: leased ids " << first << " - " << first + BlockSize - 1;
+}
+
+//=============================================================================
@@ -0,0 +1,90 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_OBJECT_ID_LEASE_H
+#define ANH_ZONESERVER_OBJECT_ID_LEASE_H
+
+#include "Utils/typedefs.h"
+
+#include <deque>
+
+class Database;
+class DatabaseResult;
+
+//=============================================================================
+//
+// hands out persistent object ids from blocks leased from the db, so new
+// objects can be created in memory right away and written later
+//
+// every lease is a row in object_id_leases, lease n covers the ids
+// [base + (n - 1) * BlockSize, base + n * BlockSize). a block is only used
+// once its lease row is committed and lease rows are never deleted, so no id
+// is handed out twice, not even after a crash. whatever was left of the
+// blocks of a crashed zone is simply never used
+//
+
+class ObjectIdLease
+{
+public:
+
+    enum
+    {
+        BlockSize		= 1024,
+        // a new block is requested once fewer ids than this are left
+        LowWatermark	= 256
+    };
+
+    ObjectIdLease(Database* database,uint32 zoneId,uint64 base);
+    ~ObjectIdLease();
+
+    // leases the first block, blocking, on startup
+    bool		init();
+
+    // returns 0 if all leased ids are used up, a new block is on its way then
+    uint64		getNextId();
+
+    uint64		getAvailableCount() const;
+    uint32		getLeaseCount() const { return mLeaseCount; }
+
+private:
+
+    typedef std::deque<std::pair<uint64,uint64> > LeaseBlocks;	// first id, one past the last
+
+    uint64		_readLease(DatabaseResult* result);
+    void		_requestLease();
+    void		_addLease(uint64 leaseId);
+
+    LeaseBlocks		mBlocks;
+    Database*		mDatabase;
+    uint64			mBase;
+    uint32			mZoneId;
+    uint32			mLeaseCount;
+    bool			mRequestPending;
+};
+
+#endif
+
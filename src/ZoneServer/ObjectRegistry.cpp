@@ -0,0 +1,307 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "ObjectRegistry.h"
+
+#include <algorithm>
+
+#include "BuildingObject.h"
+#include "CellObject.h"
+#include "NPCObject.h"
+#include "PlayerObject.h"
+
+//=============================================================================
+
+const uint32 ObjectRegistry::kNoSlot;
+
+//=============================================================================
+
+ObjectRegistry::ObjectRegistry(uint32 capacity)
+    : mMask(0)
+    , mCount(0)
+{
+    // the table size has to be a power of two
+    uint32 tableSize = 16;
+    while(tableSize < capacity)
+    {
+        tableSize <<= 1;
+    }
+
+    mTableKeys.resize(tableSize, 0);
+    mTableSlots.resize(tableSize, kNoSlot);
+    mMask = tableSize - 1;
+}
+
+//=============================================================================
+
+ObjectRegistry::~ObjectRegistry()
+{
+    clear();
+}
+
+//=============================================================================
+
+bool ObjectRegistry::insert(Object* object, bool owned)
+{
+    uint64 id = object->getId();
+
+    if(contains(id))
+    {
+        return false;
+    }
+
+    uint32 slot;
+    if(!mFreeSlots.empty())
+    {
+        // reuse the slot freed longest ago, old handles to it are long gone
+        slot = mFreeSlots.front();
+        mFreeSlots.pop_front();
+    }
+    else
+    {
+        if(mSlots.size() > kObjectHandleIndexMask)
+        {
+            LOG(ERROR) << "ObjectRegistry::insert: out of slots, unable to add object " << id;
+            return false;
+        }
+
+        slot = static_cast<uint32>(mSlots.size());
+        mSlots.push_back(ObjectSlot());
+    }
+
+    ObjectSlot& entry = mSlots[slot];
+    entry.object	= object;
+    entry.owned		= owned;
+    entry.tags		= 0;
+
+    if(dynamic_cast<CreatureObject*>(object))
+        entry.tags |= ObjectTag_Creature;
+    if(dynamic_cast<NPCObject*>(object))
+        entry.tags |= ObjectTag_Npc;
+    if(dynamic_cast<PlayerObject*>(object))
+        entry.tags |= ObjectTag_Player;
+    if(dynamic_cast<CellObject*>(object))
+        entry.tags |= ObjectTag_Cell;
+    if(dynamic_cast<BuildingObject*>(object))
+        entry.tags |= ObjectTag_Building;
+
+    object->setHandle((static_cast<uint32>(entry.generation) << kObjectHandleIndexBits) | slot);
+
+    // keep the load factor at or below 1/2
+    if((mCount + 1) * 2 > mTableSlots.size())
+    {
+        _grow();
+    }
+
+    _insertKey(id, slot);
+    ++mCount;
+
+    return true;
+}
+
+//=============================================================================
+
+void ObjectRegistry::_insertKey(uint64 id, uint32 slot)
+{
+    uint32 pos = _hash(id) & mMask;
+
+    while(mTableSlots[pos] != kNoSlot)
+    {
+        pos = (pos + 1) & mMask;
+    }
+
+    mTableKeys[pos]		= id;
+    mTableSlots[pos]	= slot;
+}
+
+//=============================================================================
+
+void ObjectRegistry::_grow()
+{
+    std::vector<uint64> keys;
+    std::vector<uint32> slots;
+
+    keys.swap(mTableKeys);
+    slots.swap(mTableSlots);
+
+    mTableKeys.resize(keys.size() * 2, 0);
+    mTableSlots.resize(slots.size() * 2, kNoSlot);
+    mMask = static_cast<uint32>(mTableSlots.size()) - 1;
+
+    for(uint32 i = 0; i < slots.size(); ++i)
+    {
+        if(slots[i] != kNoSlot)
+        {
+            _insertKey(keys[i], slots[i]);
+        }
+    }
+}
+
+//=============================================================================
+//
+// removes the key by shifting the following entries of its probe sequence
+// back, so lookups never have to skip tombstones
+//
+
+bool ObjectRegistry::erase(uint64 id)
+{
+    uint32 pos = _hash(id) & mMask;
+
+    while(mTableSlots[pos] != kNoSlot && mTableKeys[pos] != id)
+    {
+        pos = (pos + 1) & mMask;
+    }
+
+    if(mTableSlots[pos] == kNoSlot)
+    {
+        return false;
+    }
+
+    uint32 slot = mTableSlots[pos];
+
+    uint32 hole = pos;
+    uint32 next = (pos + 1) & mMask;
+
+    while(mTableSlots[next] != kNoSlot)
+    {
+        uint32 home = _hash(mTableKeys[next]) & mMask;
+
+        // move the entry into the hole unless its home lies cyclically in (hole, next]
+        if(((next - home) & mMask) >= ((next - hole) & mMask))
+        {
+            mTableKeys[hole]	= mTableKeys[next];
+            mTableSlots[hole]	= mTableSlots[next];
+            hole = next;
+        }
+        next = (next + 1) & mMask;
+    }
+
+    mTableSlots[hole] = kNoSlot;
+    --mCount;
+
+    ObjectSlot& entry = mSlots[slot];
+
+    Object* object	= entry.object;
+    bool owned		= entry.owned;
+
+    entry.object	= NULL;
+    entry.owned		= false;
+    entry.tags		= 0;
+    entry.generation = (entry.generation + 1) & kObjectHandleGenerationMask;
+    if(!entry.generation)
+    {
+        entry.generation = 1;
+    }
+
+    mFreeSlots.push_back(slot);
+
+    // the registry is consistent again before any destructor gets to run
+    if(owned)
+    {
+        delete object;
+    }
+
+    return true;
+}
+
+//=============================================================================
+
+void ObjectRegistry::clear()
+{
+    std::vector<Object*> owned;
+
+    std::vector<ObjectSlot>::iterator it = mSlots.begin();
+    while(it != mSlots.end())
+    {
+        if((*it).object && (*it).owned)
+        {
+            owned.push_back((*it).object);
+        }
+        ++it;
+    }
+
+    mSlots.clear();
+    mFreeSlots.clear();
+    std::fill(mTableSlots.begin(), mTableSlots.end(), kNoSlot);
+    mCount = 0;
+
+    std::vector<Object*>::iterator ownedIt = owned.begin();
+    while(ownedIt != owned.end())
+    {
+        delete(*ownedIt);
+        ++ownedIt;
+    }
+}
+
+//=============================================================================
+
+ObjectHandle ObjectRegistry::getHandle(uint64 id) const
+{
+    uint32 slot = _findSlot(id);
+
+    if(slot == kNoSlot)
+    {
+        return kInvalidObjectHandle;
+    }
+
+    return (static_cast<uint32>(mSlots[slot].generation) << kObjectHandleIndexBits) | slot;
+}
+
+//=============================================================================
+
+CreatureObject* ObjectRegistry::findCreature(uint64 id) const
+{
+    return static_cast<CreatureObject*>(_findTagged(id, ObjectTag_Creature));
+}
+
+//=============================================================================
+
+NPCObject* ObjectRegistry::findNpc(uint64 id) const
+{
+    return static_cast<NPCObject*>(_findTagged(id, ObjectTag_Npc));
+}
+
+//=============================================================================
+
+PlayerObject* ObjectRegistry::findPlayer(uint64 id) const
+{
+    return static_cast<PlayerObject*>(_findTagged(id, ObjectTag_Player));
+}
+
+//=============================================================================
+
+CellObject* ObjectRegistry::findCell(uint64 id) const
+{
+    return static_cast<CellObject*>(_findTagged(id, ObjectTag_Cell));
+}
+
+//=============================================================================
+
+BuildingObject* ObjectRegistry::findBuilding(uint64 id) const
+{
+    return static_cast<BuildingObject*>(_findTagged(id, ObjectTag_Building));
+}
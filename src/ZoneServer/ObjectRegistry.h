@@ -0,0 +1,186 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_OBJECT_REGISTRY_H
+#define ANH_ZONESERVER_OBJECT_REGISTRY_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "Utils/typedefs.h"
+
+//=============================================================================
+
+class BuildingObject;
+class CellObject;
+class CreatureObject;
+class NPCObject;
+class Object;
+class PlayerObject;
+
+// index into the slot table in the low bits, the slots generation above
+typedef uint32	ObjectHandle;
+
+static const ObjectHandle	kInvalidObjectHandle		= 0;
+static const uint32			kObjectHandleIndexBits		= 22;
+static const uint32			kObjectHandleIndexMask		= (1 << kObjectHandleIndexBits) - 1;
+static const uint32			kObjectHandleGenerationMask	= (1 << (32 - kObjectHandleIndexBits)) - 1;
+
+//=============================================================================
+//
+// The world managers object table. Ids are looked up in an open addressing
+// hash table (linear probing, no tombstones) that points into a slot array
+// holding the objects.
+//
+// A slot is identified by a handle made from its index and a generation that
+// is bumped whenever the slot is freed, so code holding on to an object across
+// ticks can keep the handle and resolve it in O(1) - a destroyed object
+// resolves to NULL instead of a dangling pointer.
+//
+// The most common downcasts are done once on insert and stored as tags, the
+// typed finders use them instead of a dynamic_cast per lookup.
+//
+
+class ObjectRegistry
+{
+public:
+
+    ObjectRegistry(uint32 capacity = 65536);
+    ~ObjectRegistry();
+
+    // owned objects are deleted when erased, false if the id is already known
+    bool			insert(Object* object, bool owned = true);
+    bool			erase(uint64 id);
+    void			clear();
+
+    Object*			find(uint64 id) const {
+        uint32 slot = _findSlot(id);
+        return (slot != kNoSlot) ? mSlots[slot].object : NULL;
+    }
+    bool			contains(uint64 id) const {
+        return _findSlot(id) != kNoSlot;
+    }
+
+    ObjectHandle	getHandle(uint64 id) const;
+
+    Object*			resolve(ObjectHandle handle) const {
+        uint32 index = handle & kObjectHandleIndexMask;
+
+        if(index >= mSlots.size() || mSlots[index].generation != (handle >> kObjectHandleIndexBits))
+        {
+            return NULL;
+        }
+        return mSlots[index].object;
+    }
+
+    CreatureObject*	findCreature(uint64 id) const;
+    NPCObject*		findNpc(uint64 id) const;
+    PlayerObject*	findPlayer(uint64 id) const;
+    CellObject*		findCell(uint64 id) const;
+    BuildingObject*	findBuilding(uint64 id) const;
+
+    uint32			size() const {
+        return mCount;
+    }
+
+    // for the rare full scans, empty slots return NULL
+    uint32			getSlotCount() const {
+        return static_cast<uint32>(mSlots.size());
+    }
+    Object*			getSlotObject(uint32 index) const {
+        return mSlots[index].object;
+    }
+
+private:
+
+    enum ObjectTag
+    {
+        ObjectTag_Creature	= 0x01,
+        ObjectTag_Npc		= 0x02,
+        ObjectTag_Player	= 0x04,
+        ObjectTag_Cell		= 0x08,
+        ObjectTag_Building	= 0x10
+    };
+
+    class ObjectSlot
+    {
+    public:
+        ObjectSlot() : object(NULL), generation(1), tags(0), owned(false) {}
+
+        Object*	object;
+        uint16	generation;
+        uint8	tags;
+        bool	owned;
+    };
+
+    static const uint32 kNoSlot = 0xffffffff;
+
+    static uint32	_hash(uint64 id) {
+        // 64 bit finalizer, ids are sequential and would cluster otherwise
+        id ^= id >> 33;
+        id *= 0xff51afd7ed558ccdULL;
+        id ^= id >> 33;
+        id *= 0xc4ceb9fe1a85ec53ULL;
+        id ^= id >> 33;
+        return static_cast<uint32>(id);
+    }
+
+    uint32			_findSlot(uint64 id) const {
+        uint32 pos = _hash(id) & mMask;
+
+        while(mTableSlots[pos] != kNoSlot)
+        {
+            if(mTableKeys[pos] == id)
+            {
+                return mTableSlots[pos];
+            }
+            pos = (pos + 1) & mMask;
+        }
+        return kNoSlot;
+    }
+
+    Object*			_findTagged(uint64 id, uint8 tag) const {
+        uint32 slot = _findSlot(id);
+        return (slot != kNoSlot && (mSlots[slot].tags & tag)) ? mSlots[slot].object : NULL;
+    }
+
+    void			_insertKey(uint64 id, uint32 slot);
+    void			_grow();
+
+    std::vector<ObjectSlot>		mSlots;
+    std::deque<uint32>			mFreeSlots;
+    std::vector<uint64>			mTableKeys;
+    std::vector<uint32>			mTableSlots;
+    uint32						mMask;
+    uint32						mCount;
+};
+
+//=============================================================================
+
+#endif
+
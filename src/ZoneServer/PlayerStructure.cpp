@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "PlayerObject.h"
 #include "Inventory.h"
 #include "CellObject.h"
+#include "HarvesterObject.h"
 #include "Bank.h"
 #include "UICallback.h"
 #include "UIManager.h"
@@ -39,6 +40,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/Database.h"
 #include "DatabaseManager/DatabaseResult.h"
 #include "DatabaseManager/DataBinding.h"
+
+#include <algorithm>
+#include <cmath>
+
 //=============================================================================
 
 PlayerStructure::PlayerStructure() : TangibleObject()
@@ -49,6 +54,10 @@ PlayerStructure::PlayerStructure() : TangibleObject()
 
     mState			= 0;
 
+    mSettledAt			= 0;
+    mMaintenanceCarry	= 0.0;
+    mDamageCarry		= 0.0;
+
     mHousingAdminList.clear();
 }
 
@@ -126,6 +135,95 @@ void PlayerStructure::setCurrentPower(uint32 power)
 
 }
 
+//=============================================================================
+//
+// maintenance rates are per hour, the pools keep whole credits and the fractions are carried
+//
+
+double PlayerStructure::_settleMaintenance(double elapsed)
+{
+    double rate = getMaintenanceRate() / 3600.0;
+    if(rate <= 0.0)
+    {
+        return elapsed;
+    }
+
+    double covered	= elapsed;
+    double pool		= getCurrentMaintenance() + mMaintenanceCarry;
+    double due		= rate * elapsed;
+
+    if(due > pool)
+    {
+        covered = pool / rate;
+
+        if(getRepairCost())
+        {
+            double damage	= mDamage + mDamageCarry + ((due - pool) / getRepairCost());
+            damage			= std::min(damage, static_cast<double>(getMaxCondition()));
+            mDamage			= static_cast<uint32>(damage);
+            mDamageCarry	= damage - mDamage;
+        }
+        pool = 0.0;
+    }
+    else
+    {
+        pool -= due;
+    }
+
+    setCurrentMaintenance(static_cast<uint32>(pool));
+    mMaintenanceCarry = pool - floor(pool);
+
+    return covered;
+}
+
+//=============================================================================
+//
+//
+
+bool PlayerStructure::settle(uint64 now)
+{
+    if(now <= mSettledAt)
+    {
+        return false;
+    }
+
+    double elapsed	= static_cast<double>(now - mSettledAt);
+    uint32 damage	= mDamage;
+    mSettledAt		= now;
+
+    _settleMaintenance(elapsed);
+
+    return(damage != mDamage);
+}
+
+//=============================================================================
+//
+// out of maintenance first, then the time until the damage used up the condition
+//
+
+uint64 PlayerStructure::getNextThreshold()
+{
+    double rate = getMaintenanceRate() / 3600.0;
+    if(rate <= 0.0)
+    {
+        return 0;
+    }
+
+    double pool = getCurrentMaintenance() + mMaintenanceCarry;
+    if(pool > 0.0)
+    {
+        return mSettledAt + static_cast<uint64>(ceil(pool / rate));
+    }
+
+    if(!getRepairCost() || (mDamage >= getMaxCondition()))
+    {
+        return 0;
+    }
+
+    double left = (getMaxCondition() - mDamage - mDamageCarry) * getRepairCost();
+    return mSettledAt + static_cast<uint64>(ceil(left / rate));
+}
+
 //=============================================================================
 //
 //
@@ -224,6 +322,9 @@ void PlayerStructure::handleUIEvent(BString strCharacterCash, BString strHarvest
         return;
     }
 
+    //a structure has to be run up to now before its pools change
+    gStructureManager->settleStructure(this);
+
     switch(window->getWindowType())
     {
     case SUI_Window_Deposit_Power:
@@ -239,8 +340,11 @@ void PlayerStructure::handleUIEvent(BString strCharacterCash, BString strHarvest
         gStructureManager->deductPower(player,harvesterPowerDelta);
         this->setCurrentPower(getCurrentPower()+harvesterPowerDelta);
 
-        gWorldManager->getDatabase()->executeSqlAsync(0,0,"UPDATE structure_attributes SET value='%u' WHERE structure_id=%"PRIu64" AND attribute_id=384",getCurrentPower(),this->getId());
-        
+        //a harvesters power is saved with the structure, everything else has its power used up by the chatserver
+        if(!dynamic_cast<HarvesterObject*>(this))
+        {
+            gWorldManager->getDatabase()->executeSqlAsync(0,0,"UPDATE structure_attributes SET value=value+%i WHERE structure_id=%"PRIu64" AND attribute_id=384",harvesterPowerDelta,this->getId());
+        }
     }
     break;
 
@@ -321,9 +425,6 @@ void PlayerStructure::handleUIEvent(BString strCharacterCash, BString strHarvest
                 damage = 0;
             }
 
-            //update the remaining damage in the db
-            gWorldManager->getDatabase()->executeSqlAsync(0,0,"UPDATE structures s SET s.condition= %u WHERE s.ID=%"PRIu64"",damage,this->getId());
-            
             this->setDamage(damage);
 
             //Update the structures Condition
@@ -331,9 +432,6 @@ void PlayerStructure::handleUIEvent(BString strCharacterCash, BString strHarvest
 
         }
 
-        gWorldManager->getDatabase()->executeSqlAsync(0,0,"UPDATE structure_attributes SET value='%u' WHERE structure_id=%"PRIu64" AND attribute_id=382",maintenance,this->getId());
-        
-
         this->setCurrentMaintenance(maintenance);
 
 
@@ -341,6 +439,9 @@ void PlayerStructure::handleUIEvent(BString strCharacterCash, BString strHarvest
     break;
 
     }
+
+    //the new pools, the condition and the settlement time are written together
+    gStructureManager->saveStructure(this);
 }
 
 
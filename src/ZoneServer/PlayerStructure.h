@@ -308,9 +308,30 @@ public:
         return((mState & states) != 0);
     }
 
+    // upkeep is accounted lazily, from the time the structure was last settled up to now (unix time)
+    // settle returns true if the structures condition or operating state changed on the way
+    virtual bool			settle(uint64 now);
+
+    // unix time the next state change (out of maintenance, condition gone) is expected at, 0 if none is coming
+    virtual uint64			getNextThreshold();
+
+    uint64					getSettledAt() {
+        return mSettledAt;
+    }
+
+protected:
+
+    // pays the maintenance for the elapsed seconds, what cant be paid turns into damage at the repair cost
+    // returns the seconds the maintenance pool covered
+    double					_settleMaintenance(double elapsed);
+
+    uint64						mSettledAt;
 
 private:
 
+    double						mMaintenanceCarry;
+    double						mDamageCarry;
+
 
     PlayerStructureFamily		mPlayerStructureFamily;
 
@@ -37,6 +37,12 @@ RegionObject::~RegionObject()
 {
 }
 
+bool RegionObject::checkTrigger(const Object* object, const glm::vec3& position) const
+{
+    return (position.x >= mPosition.x - mWidth) && (position.x <= mPosition.x + mWidth)
+           && (position.z >= mPosition.z - mHeight) && (position.z <= mPosition.z + mHeight);
+}
+
 std::shared_ptr<RegionObject> RegionObject::getSharedFromThis() {
     return std::static_pointer_cast<RegionObject>(Object::shared_from_this());
 }
@@ -97,6 +97,10 @@ public:
     virtual void		update() {}
     virtual void		onObjectEnter(Object* object) {}
     virtual void		onObjectLeave(Object* object) {}
+
+    // trigger volume test used by the RegionTriggerGrid, position is in world space
+    // for a region in the world and cell local for a region inside a building
+    virtual bool		checkTrigger(const Object* object, const glm::vec3& position) const;
     
     std::shared_ptr<RegionObject> getSharedFromThis();
 
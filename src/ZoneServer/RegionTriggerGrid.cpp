@@ -0,0 +1,368 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "RegionTriggerGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Object.h"
+#include "RegionObject.h"
+#include "WorldManager.h"
+
+//=============================================================================
+
+RegionTriggerGrid::RegionTriggerGrid(float cellSize)
+    : mCellSize(cellSize)
+    , mRegionCount(0)
+{
+}
+
+//=============================================================================
+
+RegionTriggerGrid::~RegionTriggerGrid()
+{
+    mMembership.clear();
+    mCells.clear();
+}
+
+//=============================================================================
+
+int32 RegionTriggerGrid::_cellCoord(float coord) const
+{
+    return static_cast<int32>(floor(coord / mCellSize));
+}
+
+//=============================================================================
+
+uint64 RegionTriggerGrid::_cellKey(int32 cellX, int32 cellZ) const
+{
+    return (static_cast<uint64>(static_cast<uint32>(cellX)) << 32) | static_cast<uint32>(cellZ);
+}
+
+//=============================================================================
+
+bool RegionTriggerGrid::_removeFromCell(TriggerCellMap& cells, uint64 key, const std::shared_ptr<RegionObject>& region)
+{
+    TriggerCellMap::iterator cellIt = cells.find(key);
+
+    if(cellIt == cells.end())
+    {
+        return false;
+    }
+
+    RegionTriggerList& cell = cellIt->second;
+    RegionTriggerList::iterator it = std::find(cell.begin(), cell.end(), region);
+
+    bool found = (it != cell.end());
+
+    if(found)
+    {
+        cell.erase(it);
+    }
+
+    if(cell.empty())
+    {
+        cells.erase(cellIt);
+    }
+
+    return found;
+}
+
+//=============================================================================
+//
+// registers the regions bounding rectangle with every cell it overlaps
+// a region inside a building is kept with its cell, its position is cell local
+//
+
+void RegionTriggerGrid::addRegion(std::shared_ptr<RegionObject> region)
+{
+    if(uint64 parentId = region->getParentId())
+    {
+        RegionTriggerList& cell = mParentedRegions[parentId];
+
+        if(std::find(cell.begin(), cell.end(), region) == cell.end())
+        {
+            cell.push_back(region);
+        }
+
+        ++mRegionCount;
+        return;
+    }
+
+    int32 lowX	= _cellCoord(region->mPosition.x - region->getWidth());
+    int32 lowZ	= _cellCoord(region->mPosition.z - region->getHeight());
+    int32 highX	= _cellCoord(region->mPosition.x + region->getWidth());
+    int32 highZ	= _cellCoord(region->mPosition.z + region->getHeight());
+
+    for(int32 x = lowX; x <= highX; ++x)
+    {
+        for(int32 z = lowZ; z <= highZ; ++z)
+        {
+            RegionTriggerList& cell = mCells[_cellKey(x, z)];
+
+            if(std::find(cell.begin(), cell.end(), region) == cell.end())
+            {
+                cell.push_back(region);
+            }
+        }
+    }
+
+    ++mRegionCount;
+}
+
+//=============================================================================
+//
+// unregisters the region and lets everybody still inside leave it
+//
+
+void RegionTriggerGrid::removeRegion(std::shared_ptr<RegionObject> region)
+{
+    bool found = false;
+
+    if(uint64 parentId = region->getParentId())
+    {
+        found = _removeFromCell(mParentedRegions, parentId, region);
+    }
+    else
+    {
+        int32 lowX	= _cellCoord(region->mPosition.x - region->getWidth());
+        int32 lowZ	= _cellCoord(region->mPosition.z - region->getHeight());
+        int32 highX	= _cellCoord(region->mPosition.x + region->getWidth());
+        int32 highZ	= _cellCoord(region->mPosition.z + region->getHeight());
+
+        for(int32 x = lowX; x <= highX; ++x)
+        {
+            for(int32 z = lowZ; z <= highZ; ++z)
+            {
+                if(_removeFromCell(mCells, _cellKey(x, z), region))
+                {
+                    found = true;
+                }
+            }
+        }
+    }
+
+    if(!found)
+    {
+        return;
+    }
+
+    --mRegionCount;
+
+    // collect the members first, the leave handlers may move objects around
+    ObjectIDList members;
+
+    TriggerMembershipMap::iterator memberIt = mMembership.begin();
+
+    while(memberIt != mMembership.end())
+    {
+        RegionTriggerList& regions = memberIt->second;
+        RegionTriggerList::iterator it = std::find(regions.begin(), regions.end(), region);
+
+        if(it != regions.end())
+        {
+            regions.erase(it);
+            members.push_back(memberIt->first);
+        }
+
+        if(regions.empty())
+        {
+            memberIt = mMembership.erase(memberIt);
+        }
+        else
+        {
+            ++memberIt;
+        }
+    }
+
+    ObjectIDList::iterator it = members.begin();
+
+    while(it != members.end())
+    {
+        if(Object* object = gWorldManager->getObjectById(*it))
+        {
+            region->onObjectLeave(object);
+        }
+
+        ++it;
+    }
+}
+
+//=============================================================================
+//
+// diffs the regions containing the objects current position against the ones
+// it was in before and fires the according enter / leave events
+// regions in the world are tested against the world position, the ones in
+// the objects cell against its cell local position
+//
+
+void RegionTriggerGrid::updateObject(Object* object)
+{
+    TriggerMembershipMap::iterator memberIt = mMembership.find(object->getId());
+
+    glm::vec3 position = object->getWorldPosition();
+
+    TriggerCellMap::iterator cellIt		= mCells.find(_cellKey(_cellCoord(position.x), _cellCoord(position.z)));
+    TriggerCellMap::iterator parentIt	= object->getParentId() ? mParentedRegions.find(object->getParentId()) : mParentedRegions.end();
+
+    // nothing around and nothing to leave
+    if(cellIt == mCells.end() && parentIt == mParentedRegions.end() && memberIt == mMembership.end())
+    {
+        return;
+    }
+
+    RegionTriggerList inside;
+
+    if(cellIt != mCells.end())
+    {
+        RegionTriggerList::iterator it = cellIt->second.begin();
+
+        while(it != cellIt->second.end())
+        {
+            if((*it)->checkTrigger(object, position))
+            {
+                inside.push_back(*it);
+            }
+
+            ++it;
+        }
+    }
+
+    if(parentIt != mParentedRegions.end())
+    {
+        RegionTriggerList::iterator it = parentIt->second.begin();
+
+        while(it != parentIt->second.end())
+        {
+            if((*it)->checkTrigger(object, object->mPosition))
+            {
+                inside.push_back(*it);
+            }
+
+            ++it;
+        }
+    }
+
+    RegionTriggerList entered;
+    RegionTriggerList left;
+
+    if(memberIt != mMembership.end())
+    {
+        RegionTriggerList& before = memberIt->second;
+        RegionTriggerList::iterator it = before.begin();
+
+        while(it != before.end())
+        {
+            if(std::find(inside.begin(), inside.end(), *it) == inside.end())
+            {
+                left.push_back(*it);
+            }
+
+            ++it;
+        }
+
+        it = inside.begin();
+
+        while(it != inside.end())
+        {
+            if(std::find(before.begin(), before.end(), *it) == before.end())
+            {
+                entered.push_back(*it);
+            }
+
+            ++it;
+        }
+
+        // same regions as before, by far the most common case
+        if(entered.empty() && left.empty())
+        {
+            return;
+        }
+    }
+    else
+    {
+        entered = inside;
+    }
+
+    // update our state before calling out, handlers may trigger further updates
+    if(inside.empty())
+    {
+        if(memberIt != mMembership.end())
+        {
+            mMembership.erase(memberIt);
+        }
+    }
+    else
+    {
+        mMembership[object->getId()].swap(inside);
+    }
+
+    RegionTriggerList::iterator it = left.begin();
+
+    while(it != left.end())
+    {
+        (*it)->onObjectLeave(object);
+        ++it;
+    }
+
+    it = entered.begin();
+
+    while(it != entered.end())
+    {
+        (*it)->onObjectEnter(object);
+        ++it;
+    }
+}
+
+//=============================================================================
+
+void RegionTriggerGrid::removeObject(Object* object)
+{
+    TriggerMembershipMap::iterator memberIt = mMembership.find(object->getId());
+
+    if(memberIt == mMembership.end())
+    {
+        return;
+    }
+
+    RegionTriggerList left;
+    left.swap(memberIt->second);
+
+    mMembership.erase(memberIt);
+
+    RegionTriggerList::iterator it = left.begin();
+
+    while(it != left.end())
+    {
+        (*it)->onObjectLeave(object);
+        ++it;
+    }
+}
+
+//=============================================================================
+
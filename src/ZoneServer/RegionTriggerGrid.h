@@ -0,0 +1,93 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_REGION_TRIGGER_GRID_H
+#define ANH_ZONESERVER_REGION_TRIGGER_GRID_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/typedefs.h"
+
+//=============================================================================
+
+class Object;
+class RegionObject;
+
+typedef std::vector<std::shared_ptr<RegionObject>>			RegionTriggerList;
+
+//=============================================================================
+//
+// Trigger volumes for active regions, bucketed into a coarse uniform grid.
+// Instead of every region querying the si for players on a timer, movement
+// updates test the objects position against the few regions overlapping its
+// grid cell and fire onObjectEnter / onObjectLeave when a boundary is crossed.
+// Regions inside a building are positioned in their cell, they are kept per
+// cell and only tested against objects in that cell.
+//
+
+class RegionTriggerGrid
+{
+public:
+
+    RegionTriggerGrid(float cellSize = 256.0f);
+    ~RegionTriggerGrid();
+
+    void		addRegion(std::shared_ptr<RegionObject> region);
+    void		removeRegion(std::shared_ptr<RegionObject> region);
+
+    // call whenever an object changed its position or cell
+    void		updateObject(Object* object);
+
+    // fires leave events for all regions the object is in and forgets about it
+    void		removeObject(Object* object);
+
+    uint32		getRegionCount() const {
+        return mRegionCount;
+    }
+
+private:
+
+    typedef std::unordered_map<uint64, RegionTriggerList>	TriggerCellMap;
+    typedef std::unordered_map<uint64, RegionTriggerList>	TriggerMembershipMap;
+
+    int32		_cellCoord(float coord) const;
+    uint64		_cellKey(int32 cellX, int32 cellZ) const;
+    bool		_removeFromCell(TriggerCellMap& cells, uint64 key, const std::shared_ptr<RegionObject>& region);
+
+    TriggerCellMap			mCells;
+    TriggerCellMap			mParentedRegions;
+    TriggerMembershipMap	mMembership;
+    float					mCellSize;
+    uint32					mRegionCount;
+};
+
+//=============================================================================
+
+#endif
+
@@ -39,6 +39,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/DatabaseResult.h"
 #include "DatabaseManager/DataBinding.h"
 #include "Common/ConfigManager.h"
+#include "Utils/clock.h"
+
+#include <algorithm>
+#include <boost/thread/thread.hpp>
 
 //======================================================================================================================
 
@@ -68,7 +72,7 @@ ResourceManager::ResourceManager(Database* database,uint32 zoneId) :
     _setupDatabindings();
 
     // load resource types
-    mDatabase->executeSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) RMAsyncContainer(RMQuery_ResourceTypes),
+    mDatabase->executeStaticSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) RMAsyncContainer(RMQuery_ResourceTypes),
                                "SELECT id,category_id,namefile_name,type_name,type_swg,tang,bazaar_catID,type FROM resource_template ORDER BY id");
  
 }
@@ -222,7 +226,7 @@ void ResourceManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result
         }
 
         // query categories
-        mDatabase->executeSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) RMAsyncContainer(RMQuery_Categories),"SELECT * FROM resource_categories ORDER BY id");
+        mDatabase->executeStaticSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) RMAsyncContainer(RMQuery_Categories),"SELECT * FROM resource_categories ORDER BY id");
     }
     break;
 
@@ -306,6 +310,7 @@ void ResourceManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result
     case RMQuery_CurrentResources:
     {
         CurrentResource* resource;
+        std::vector<CurrentResource*> resources;
 
         uint64 count = result->getRowCount();
         for(uint64 i = 0; i < count; i++)
@@ -315,11 +320,14 @@ void ResourceManager::handleDatabaseJobComplete(void* ref,DatabaseResult* result
             result->getNextRow(mCurrentResourceBinding,resource);
             resource->mType = getResourceTypeById(resource->mTypeId);
             resource->mCurrent = 1;
-            resource->buildDistributionMap();
+            resource->_verifyNoiseSettings();
+            resources.push_back(resource);
             mResourceCRCNameMap.insert(std::make_pair(resource->mName.getCrc(),resource));
             (getResourceCategoryById(resource->mType->mCatId))->insertResource(resource);
         }
 
+        _buildDistributionMaps(resources);
+
         LOG_IF(INFO, count) << "Generated " << count << " resource maps";
 
         // query old and current resources not from this planet
@@ -451,3 +459,57 @@ void ResourceManager::releaseAllPoolsMemory()
 {
     mDBAsyncPool.release_memory();
 }
+
+//======================================================================================================================
+//
+// the maps are independent, so they are spread over worker threads, each map is
+// loaded from the cache directory or generated and stored there for the next boot
+//
+
+void ResourceManager::_buildDistributionMaps(std::vector<CurrentResource*>& resources)
+{
+    if(resources.empty())
+        return;
+
+    std::string cacheDir = "resourcemaps";
+    if(gConfig->keyExists("ResourceMapCache"))
+        cacheDir = gConfig->read<std::string>("ResourceMapCache");
+
+    uint32 threadCount = boost::thread::hardware_concurrency();
+    if(gConfig->keyExists("ResourceMapThreads"))
+        threadCount = gConfig->read<uint32>("ResourceMapThreads");
+
+    threadCount = std::max<uint32>(1,std::min<uint32>(threadCount,resources.size()));
+
+    uint64 start = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    boost::thread_group workers;
+    for(uint32 i = 0; i < threadCount; i++)
+    {
+        workers.create_thread([&resources, &cacheDir, i, threadCount] () {
+            for(uint32 j = i; j < resources.size(); j += threadCount)
+            {
+                resources[j]->buildDistributionMap(cacheDir);
+            }
+        });
+    }
+    workers.join_all();
+
+    LOG(INFO) << "Built " << resources.size() << " distribution maps on " << threadCount << " threads in "
+              << Anh_Utils::Clock::getSingleton()->getLocalTime() - start << "ms";
+
+    if(gConfig->read<int>("writeResourceMaps"))
+    {
+        std::vector<CurrentResource*>::iterator it = resources.begin();
+        while(it != resources.end())
+        {
+            BString fileName = (int8*)(gConfig->read<std::string>("ZoneName")).c_str();
+            fileName << "_" << (*it)->mName.getAnsi() << ".bmp";
+
+            (*it)->writeDistributionImage(fileName.getAnsi());
+            ++it;
+        }
+    }
+}
+
+//======================================================================================================================
@@ -32,12 +32,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/typedefs.h"
 #include <map>
+#include <vector>
 #include <boost/pool/pool.hpp>
 #include "DatabaseManager/DatabaseCallback.h"
 
 
 //======================================================================================================================
 
+class CurrentResource;
 class Database;
 class DatabaseCallback;
 class DatabaseResult;
@@ -113,6 +115,7 @@ private:
 
     void						_setupDatabindings();
     void						_destroyDatabindings();
+    void						_buildDistributionMaps(std::vector<CurrentResource*>& resources);
 
     static bool					mInsFlag;
     static ResourceManager*		mSingleton;
@@ -59,12 +59,12 @@ SchematicManager::SchematicManager(Database* database)
 {
     // load skillschematicgroups
     //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Groups.");
-    mDatabase->executeSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_SchematicGroups),"SELECT * FROM schematic_groups ORDER BY id");
+    mDatabase->executeStaticSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_SchematicGroups),"SELECT * FROM schematic_groups ORDER BY id");
     
 
     // load experimentation groups
     //gLogger->log(LogManager::DEBUG,"Finished Loading Experimentation Groups.");
-    mDatabase->executeSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_ExperimentationGroups),"SELECT * FROM draft_experiment_groups ORDER BY id");
+    mDatabase->executeStaticSqlAsync(this,new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_ExperimentationGroups),"SELECT * FROM draft_experiment_groups ORDER BY id");
     
 }
 
@@ -150,7 +150,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
 
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematics");
         asContainer = new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_GroupSchematics);
-        mDatabase->executeSqlAsync(this,asContainer,"SELECT object_string,weightsbatch_id,complexity,datasize,subCategory,craftEnabled,group_id FROM draft_schematics");
+        mDatabase->executeStaticSqlAsync(this,asContainer,"SELECT object_string,weightsbatch_id,complexity,datasize,subCategory,craftEnabled,group_id FROM draft_schematics");
         
 
         //gLogger->log(LogManager::DEBUG,"Finished Loading Schematic Groups.");
@@ -223,7 +223,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
                 " INNER JOIN draft_schematics_slots ON (draft_slots.id = draft_schematics_slots.draft_slot_id)"
                 " INNER JOIN schem_crc ON (draft_schematics_slots.schematic_id = schem_crc.crc)"
                 " INNER JOIN draft_schematics ON (schem_crc.object_string = draft_schematics.object_string)");
-        mDatabase->executeSqlAsync(this,asContainer,sql);
+        mDatabase->executeStaticSqlAsync(this,asContainer,sql);
         
 
 
@@ -234,7 +234,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
                 " FROM draft_weights"
                 " INNER JOIN draft_assembly_batches ON (draft_weights.assembly_batch_id = draft_assembly_batches.id)"
                 " ORDER BY draft_weights.id");
-        mDatabase->executeSqlAsync(this,asContainer,sql);
+        mDatabase->executeStaticSqlAsync(this,asContainer,sql);
         
 
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Experimentation Batches.");
@@ -246,7 +246,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
                 " INNER JOIN draft_schematics ON(draft_weights.id = draft_schematics.weightsbatch_id) "
                 " ORDER BY draft_experiment_batches.list_id ");
 
-        mDatabase->executeSqlAsync(this,asContainer,sql);
+        mDatabase->executeStaticSqlAsync(this,asContainer,sql);
         
 
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Crafting Batches.");
@@ -257,7 +257,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
                 " INNER JOIN draft_craft_batches ON (draft_weights.craft_batch_id = draft_craft_batches.id) "
                 " INNER JOIN draft_schematics ON(draft_weights.id = draft_schematics.weightsbatch_id) "
                 " ORDER BY draft_craft_batches.list_id ");
-        mDatabase->executeSqlAsync(this,asContainer,sql);
+        mDatabase->executeStaticSqlAsync(this,asContainer,sql);
         
 
         if(!--mGroupLoadCount)
@@ -345,7 +345,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
         //asContainer->mSchematic = schematic;
         //asContainer->mBatchId = batch->getListId();
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Assembly Weights.");
-        mDatabase->executeSqlAsync(this,asContainer,"SELECT datatype,distribution,draft_weights.id,draft_assembly_batches.list_id"
+        mDatabase->executeStaticSqlAsync(this,asContainer,"SELECT datatype,distribution,draft_weights.id,draft_assembly_batches.list_id"
                                    " FROM draft_assembly_lists"
                                    " INNER JOIN draft_assembly_batches ON(draft_assembly_batches.list_id = draft_assembly_lists.id)"
                                    " INNER JOIN draft_weights ON(draft_weights.assembly_batch_id = draft_assembly_batches.id)"
@@ -387,7 +387,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
         // query list items
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Experimentation Weights.");
         ScMAsyncContainer* asContainer = new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_SchematicExperimentWeights);
-        mDatabase->executeSqlAsync(this,asContainer,"SELECT datatype,distribution,draft_weights.id,draft_experiment_batches.list_id "
+        mDatabase->executeStaticSqlAsync(this,asContainer,"SELECT datatype,distribution,draft_weights.id,draft_experiment_batches.list_id "
                                    " FROM draft_experiment_lists "
                                    " INNER JOIN draft_experiment_batches ON(draft_experiment_batches.list_id = draft_experiment_lists.id)"
                                    " INNER JOIN draft_weights ON (draft_weights.experiment_batch_id = draft_experiment_batches.id)"
@@ -430,7 +430,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
         // query weight distribution
         ScMAsyncContainer* asContainer = new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_SchematicCraftWeights);
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Craft Weights.");
-        mDatabase->executeSqlAsync(this,asContainer,"SELECT type,distribution,draft_weights.id,draft_craft_batches.list_id "
+        mDatabase->executeStaticSqlAsync(this,asContainer,"SELECT type,distribution,draft_weights.id,draft_craft_batches.list_id "
                                    " FROM draft_craft_attribute_weights"
                                    " INNER JOIN draft_craft_batches ON(draft_craft_attribute_weights.id = draft_craft_batches.list_id)"
                                    " INNER JOIN draft_weights ON(draft_weights.craft_batch_id = draft_craft_batches.id)"
@@ -442,7 +442,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
         // query attribute links and ranges
         asContainer = new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_SchematicCraftAttributeLinks);
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Craft Attribute Links.");
-        mDatabase->executeSqlAsync(this,asContainer,
+        mDatabase->executeStaticSqlAsync(this,asContainer,
                                    "SELECT attributes.name,dcial.item_attribute,dcial.attribute_min,dcial.attribute_max,dcial.attribute_type,draft_craft_batches.id,dcial.list_id "
                                    " FROM draft_craft_item_attribute_link as dcial"
                                    " INNER JOIN attributes ON (dcial.item_attribute = attributes.id)"
@@ -453,7 +453,7 @@ void SchematicManager::handleDatabaseJobComplete(void* ref,DatabaseResult* resul
         // query attribute weighting for component crafting
         asContainer = new(mDBAsyncPool.ordered_malloc()) ScMAsyncContainer(ScMQuery_SchematicCraftAttributeWeights);
         //gLogger->log(LogManager::DEBUG,"Started Loading Schematic Craft Attribute Weights.");
-        mDatabase->executeSqlAsync(this,asContainer,
+        mDatabase->executeStaticSqlAsync(this,asContainer,
                                    "SELECT dsam.Attribute, dsam.AffectedAttribute, dsam.Manipulation, a.name, b.name,draft_schematics.weightsbatch_id "
                                    " FROM draft_schematic_attribute_manipulation as dsam"
                                    " INNER JOIN attributes as a ON (dsam.attribute = a.id)"
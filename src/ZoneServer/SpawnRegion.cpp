@@ -27,17 +27,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "SpawnRegion.h"
 #include "PlayerObject.h"
-#include "QTRegion.h"
-#include "QuadTree.h"
-#include "WorldManager.h"
-#include "ZoneTree.h"
 
 //=============================================================================
 
 SpawnRegion::SpawnRegion()
     : RegionObject()
-    , mQTRegion(NULL)
-    , mSI(gWorldManager->getSI())
     , mMission(0)
 {
     mActive		= true;
@@ -52,63 +46,6 @@ SpawnRegion::~SpawnRegion()
 
 //=============================================================================
 
-void SpawnRegion::update()
-{
-    //this is very problematic - currently we assume an object entered us when it is in the same qtregion we are in
-
-    //run about every 4.5 seconds
-    if(!mSubZoneId)
-    {
-        mQTRegion	= mSI->getQTRegion(mPosition.x,mPosition.z);
-        mSubZoneId	= (uint32)mQTRegion->getId();
-        mQueryRect	= Anh_Math::Rectangle(mPosition.x - mWidth,mPosition.z - mHeight,mWidth * 2,mHeight * 2);
-    }
-
-    Object*		object;
-    ObjectSet	objList;
-
-    if(mParentId)
-    {
-        mSI->getObjectsInRange(this,&objList,ObjType_Player,mWidth);
-    }
-
-    if(mQTRegion)
-    {
-        mQTRegion->mTree->getObjectsInRange(this,&objList,ObjType_Player,&mQueryRect);
-    }
-
-    ObjectSet::iterator objIt = objList.begin();
-
-    while(objIt != objList.end())
-    {
-        object = dynamic_cast<Object*>(*objIt);
-
-        if(!(checkKnownObjects(object)))
-        {
-            onObjectEnter(object);
-        }
-
-        ++objIt;
-    }
-
-    PlayerObjectSet oldKnownObjects = mKnownPlayers;
-    PlayerObjectSet::iterator objSetIt = oldKnownObjects.begin();
-
-    while(objSetIt != oldKnownObjects.end())
-    {
-        object = dynamic_cast<Object*>(*objSetIt);
-
-        if(objList.find(object) == objList.end())
-        {
-            onObjectLeave(object);
-        }
-
-        ++objSetIt;
-    }
-}
-
-//=============================================================================
-
 void SpawnRegion::onObjectEnter(Object* object)
 {
     if(object->getParentId() == mParentId)
@@ -128,3 +65,10 @@ void SpawnRegion::onObjectLeave(Object* object)
 
 //=============================================================================
 
+bool SpawnRegion::checkTrigger(const Object* object, const glm::vec3& position) const
+{
+    return (object->getParentId() == mParentId) && RegionObject::checkTrigger(object, position);
+}
+
+//=============================================================================
+
@@ -29,14 +29,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_ZONESERVER_SPAWNREGION_H
 
 #include "RegionObject.h"
-#include "MathLib/Rectangle.h"
 #include "Utils/typedefs.h"
 
 //=============================================================================
 
-class ZoneTree;
 class PlayerObject;
-class QTRegion;
 
 //=============================================================================
 
@@ -63,15 +60,12 @@ public:
         return (mMission != 0);
     }
 
-    virtual void	update();
     virtual void	onObjectEnter(Object* object);
     virtual void	onObjectLeave(Object* object);
+    virtual bool	checkTrigger(const Object* object, const glm::vec3& position) const;
 
 protected:
 
-    Anh_Math::Rectangle mQueryRect;
-    std::shared_ptr<QTRegion>   mQTRegion;
-    ZoneTree*			mSI;
     uint32				mMission;
     uint32				mSpawnType;
 };
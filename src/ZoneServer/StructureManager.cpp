@@ -35,12 +35,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "PlayerStructureTerminal.h"
 #include "FactoryFactory.h"
 #include "nonPersistantObjectFactory.h"
+#include "Bank.h"
 #include "HarvesterObject.h"
 #include "HouseObject.h"
 #include "FactoryObject.h"
 #include "Inventory.h"
 #include "Datapad.h"
+#include "Resource.h"
 #include "ResourceContainer.h"
+#include "ResourceManager.h"
 #include "ResourceType.h"
 #include "ObjectFactory.h"
 #include "ManufacturingSchematic.h"
@@ -58,11 +61,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Common/OutOfBand.h"
 #include "MessageLib/MessageLib.h"
+#include "Common/atMacroString.h"
 #include "DatabaseManager/Database.h"
+#include "DatabaseManager/DatabaseResult.h"
+#include "DatabaseManager/Transaction.h"
 #include "Utils/rand.h"
 #include "Utils/MathFunctions.h"
+#include "Utils/VariableTimeScheduler.h"
+
+#include <cppconn/resultset.h>
 
 #include <cassert>
+#include <cmath>
+#include <ctime>
 
 using ::common::OutOfBand;
 
@@ -77,8 +88,8 @@ StructureManager::StructureManager(Database* database,MessageDispatch* dispatch)
     LOG(INFO) << "Beginning structure manager initialization";
     
     mBuildingFenceInterval = gWorldConfig->getConfiguration<uint16>("Zone_BuildingFenceInterval",(uint16)10000);
-    //uint32 structureCheckIntervall = gWorldConfig->getConfiguration("Zone_structureCheckIntervall",(uint32)3600);
-    uint32 structureCheckIntervall = gWorldConfig->getConfiguration<uint32>("Zone_structureCheckIntervall",(uint32)30);
+    mSettleBatchInterval	= gWorldConfig->getConfiguration<uint32>("Zone_structureSettleBatch",(uint32)86400);
+    mWriteBehindInterval	= gWorldConfig->getConfiguration<uint32>("Zone_structureWriteBehind",(uint32)300);
 
     mDatabase = database;
     mMessageDispatch = dispatch;
@@ -108,9 +119,10 @@ StructureManager::StructureManager(Database* database,MessageDispatch* dispatch)
     mDatabase->executeProcedureAsync(this,asyncContainer,"CALL sp_PlanetNoBuildRegions");
 
     //=========================
-    //check regularly the harvesters - they might have been turned off by the db, harvesters without condition might need to be deleted
-    //do so every hour if no other timeframe is set
-    gWorldManager->getPlayerScheduler()->addTask(fastdelegate::MakeDelegate(this,&StructureManager::_handleStructureDBCheck),7,structureCheckIntervall*1000,NULL);
+    //structures are settled whenever they are used, the timeline only visits a structure
+    //when one of its pools runs out, its hopper fills up, a write is due or once a day
+    mSettleScheduler = new Anh_Utils::VariableTimeScheduler();
+    gWorldManager->getPlayerScheduler()->addTask(fastdelegate::MakeDelegate(this,&StructureManager::_handleSettleScheduler),7,1000,NULL);
     
     LOG(INFO) << "Structure Manager initialization complete";
 }
@@ -141,7 +153,23 @@ StructureManager*	StructureManager::Init(Database* database, MessageDispatch* di
 
 void StructureManager::Shutdown()
 {
+    //write all structures as far as they are settled, the next start picks the timeline up from there
+    //settling here could need a bank draw whose answer would never be processed
+    std::map<uint64,uint64>::iterator it = mSettleTasks.begin();
+    while(it != mSettleTasks.end())
+    {
+        PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById((*it).first));
+        if(structure && _hasUpkeep(structure))
+        {
+            _writeStructure(structure);
+        }
+        ++it;
+    }
+
+    mSettleTasks.clear();
 
+    delete(mSettleScheduler);
+    mSettleScheduler = NULL;
 }
 
 
@@ -271,12 +299,33 @@ void StructureManager::addNametoPermissionList(uint64 structureId, uint64 player
 //=======================================================================================================================
 void StructureManager::getDeleteStructureMaintenanceData(uint64 structureId, uint64 playerId)
 {
+    //a settled structure holds its maintenance itself, a harvester its power as well
+    PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(structureId));
+    if(structure && _hasUpkeep(structure))
+    {
+        settleStructure(structure);
+
+        if(dynamic_cast<HarvesterObject*>(structure))
+        {
+            structure->deleteStructureDBDataRead(playerId);
+            return;
+        }
+    }
+
     // load our structures maintenance data
     // that means the maintenance attribute and the energy attribute
+    // the zone holds the maintenance of a structure it settles, only its power is read
 
     StructureManagerAsyncContainer* asyncContainer;
     asyncContainer = new StructureManagerAsyncContainer(Structure_UpdateAttributes, 0);
-    mDatabase->executeSqlAsync(this,asyncContainer, "(SELECT \'power\', sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 384) UNION (SELECT \'maintenance\'	, sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 382)  ",structureId, structureId);
+    if(structure && _hasUpkeep(structure))
+    {
+        mDatabase->executeSqlAsync(this,asyncContainer, "SELECT \'power\', sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 384",structureId);
+    }
+    else
+    {
+        mDatabase->executeSqlAsync(this,asyncContainer, "(SELECT \'power\', sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 384) UNION (SELECT \'maintenance\'	, sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 382)  ",structureId, structureId);
+    }
 
 
     asyncContainer->mStructureId = structureId;
@@ -544,158 +593,115 @@ BString StructureManager::getCode()
 //======================================================================================================================
 //
 // Handle deletion of destroyed Structures / building fences and other stuff
+// the order is done with once it was carried out or turned down
 //
 
-bool StructureManager::_handleStructureObjectTimers(uint64 callTime, void* ref)
+bool StructureManager::_handleStructureTodo(PlayerStructure* structure)
 {
-    //iterate through all harvesters to delete
-    ObjectIDList* objectList = gStructureManager->getStrucureDeleteList();
-    ObjectIDList::iterator it = objectList->begin();
+    timerTodoStruct* tts = structure->getTTS();
 
-    while(it != objectList->end())
+    if(tts->todo == ttE_Delete)
     {
-        PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById((*it)));
+        tts->todo = ttE_Nothing;
 
-        if(!structure)
-        {
-            it = objectList->erase(it);
-            continue;
+        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById( tts->playerId ));
+        if(!player)
+        {   //Crash bug patch: http://paste.swganh.org/viewp.php?id=20100627004133-026ea7b07136cfad7a5463216da5ab96
+            LOG(WARNING) << "StructureManager::_handleStructureTodo could not find the player with ID:" << tts->playerId;
+            return(false);
         }
-
-
-        if(structure->getTTS()->todo == ttE_Delete)
+        if(structure->canRedeed())
         {
-
-            PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById( structure->getTTS()->playerId ));
-            if(!player)
-            {   //Crash bug patch: http://paste.swganh.org/viewp.php?id=20100627004133-026ea7b07136cfad7a5463216da5ab96
-                LOG(WARNING) << "StructureManager::_handleStructureObjectTimers could not find the player with ID:" << structure->getTTS()->playerId;
-                it = objectList->erase(it);
-                continue;
-            }
-            if(structure->canRedeed())
+            Inventory* inventory	= dynamic_cast<Inventory*>(player->getEquipManager()->getEquippedObject(CreatureEquipSlot_Inventory));
+            if((!inventory)||(!inventory->checkSlots(1)))
             {
-                Inventory* inventory	= dynamic_cast<Inventory*>(player->getEquipManager()->getEquippedObject(CreatureEquipSlot_Inventory));
-                if((!inventory)||(!inventory->checkSlots(1)))
-                {
-                    gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "inventory_full"), player);
-                    it = objectList->erase(it);
-                    continue;
-                }
-                //if its a playerstructure boot all players and pets inside
-                HouseObject* house = dynamic_cast<HouseObject*>(structure);
-                if(house)
-                {
-                    if (house->getCellContentCount() > 0)
-                    {
-                        house->toggleStateOff(PlayerStructureState_Destroy);
-                        gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "clear_building_for_delete"), player);
-                        it = objectList->erase(it);
-                        continue;
-                    }
-                }
-                gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "deed_reclaimed"), player);
-                UpdateCharacterLots(structure->getOwner());
-                //update the deeds attributes and set the new owner id (owners inventory = characterid +1)
-                //enum INVENTORY_OFFSET
-                StructureManagerAsyncContainer* asyncContainer;
-                asyncContainer = new StructureManagerAsyncContainer(Structure_UpdateStructureDeed, 0);
-                asyncContainer->mPlayerId		= structure->getOwner();
-                asyncContainer->mStructureId	= structure->getId();
-                int8 sql[150];
-                sprintf(sql,"select sf_DefaultHarvesterUpdateDeed(%"PRIu64",%"PRIu64")", structure->getId(),structure->getOwner()+INVENTORY_OFFSET);
-                mDatabase->executeSqlAsync(this,asyncContainer,sql);
-
-
+                gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "inventory_full"), player);
+                return(false);
             }
-            else
-                //delete the deed
+            //if its a playerstructure boot all players and pets inside
+            HouseObject* house = dynamic_cast<HouseObject*>(structure);
+            if(house)
             {
-
-                //if its a playerstructure boot all players and pets inside
-                HouseObject* house = dynamic_cast<HouseObject*>(structure);
-                if(house)
+                if (house->getCellContentCount() > 0)
                 {
-                    if (house->getCellContentCount() > 0)
-                    {
-                        house->toggleStateOff(PlayerStructureState_Destroy);
-                        gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "clear_building_for_delete"), player);
-                        it = objectList->erase(it);
-                        continue;
-                    }
-                    house->prepareDestruction();
+                    house->toggleStateOff(PlayerStructureState_Destroy);
+                    gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "clear_building_for_delete"), player);
+                    return(false);
                 }
-
-                gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "structure_destroyed"), player);
-                int8 sql[200];
-                sprintf(sql,"DELETE FROM items WHERE parent_id = %"PRIu64" AND item_family = 15",structure->getId());
-                mDatabase->executeSqlAsync(NULL,NULL,sql);
-                gObjectFactory->deleteObjectFromDB(structure);
-                gMessageLib->sendDestroyObject_InRangeofObject(structure);
-                gWorldManager->destroyObject(structure);
-                UpdateCharacterLots(structure->getOwner());
-
             }
-
+            gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "deed_reclaimed"), player);
+            UpdateCharacterLots(structure->getOwner());
+            //update the deeds attributes and set the new owner id (owners inventory = characterid +1)
+            //enum INVENTORY_OFFSET
+            StructureManagerAsyncContainer* asyncContainer;
+            asyncContainer = new StructureManagerAsyncContainer(Structure_UpdateStructureDeed, 0);
+            asyncContainer->mPlayerId		= structure->getOwner();
+            asyncContainer->mStructureId	= structure->getId();
+            int8 sql[150];
+            sprintf(sql,"select sf_DefaultHarvesterUpdateDeed(%"PRIu64",%"PRIu64")", structure->getId(),structure->getOwner()+INVENTORY_OFFSET);
+            mDatabase->executeSqlAsync(this,asyncContainer,sql);
+
+            return(false);
         }
 
-        if(structure->getTTS()->todo == ttE_BuildingFence)
+        //delete the deed
+        //if its a playerstructure boot all players and pets inside
+        HouseObject* house = dynamic_cast<HouseObject*>(structure);
+        if(house)
         {
-            if(Anh_Utils::Clock::getSingleton()->getLocalTime() < structure->getTTS()->projectedTime)
+            if (house->getCellContentCount() > 0)
             {
-                it = objectList->erase(it);
-                continue;
+                house->toggleStateOff(PlayerStructureState_Destroy);
+                gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "clear_building_for_delete"), player);
+                return(false);
             }
+            house->prepareDestruction();
+        }
 
-            //gLogger->log(LogManager::DEBUG,"StructureManager::_handleStructureObjectTimers: building fence");
-
-            PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById( structure->getTTS()->playerId ));
-            PlayerStructure* fence = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(structure->getTTS()->buildingFence));
-
-            if(!player)
-            {
-                gMessageLib->sendDestroyObject_InRangeofObject(fence);
-                gWorldManager->destroyObject(fence);
-                gWorldManager->handleObjectReady(structure,player->getClient());
-                it = objectList->erase(it);
-                continue;
-            }
+        gMessageLib->SendSystemMessage(::common::OutOfBand("player_structure", "structure_destroyed"), player);
+        int8 sql[200];
+        sprintf(sql,"DELETE FROM items WHERE parent_id = %"PRIu64" AND item_family = 15",structure->getId());
+        mDatabase->executeSqlAsync(NULL,NULL,sql);
+        gObjectFactory->deleteObjectFromDB(structure);
+        UpdateCharacterLots(structure->getOwner());
+        gMessageLib->sendDestroyObject_InRangeofObject(structure);
+        gWorldManager->destroyObject(structure);
 
-            if(!fence)
-            {
-                it = objectList->erase(it);
-                continue;
-            }
+        return(true);
+    }
 
-            //delete the fence
-            gMessageLib->sendDestroyObject_InRangeofObject(fence);
-            gWorldManager->destroyObject(fence);
+    if(tts->todo == ttE_BuildingFence)
+    {
+        tts->todo = ttE_Nothing;
 
-            gWorldManager->createObjectinWorld(player,structure);
-            gMessageLib->sendConstructionComplete(player,structure);
+        PlayerObject* player = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById( tts->playerId ));
+        PlayerStructure* fence = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(tts->buildingFence));
 
-            /*
-            if(structure->getPlayerStructureFamily() == PlayerStructure_House)
+        if(!player)
+        {
+            if(fence)
             {
-                float x,y,z;
-                x = structure->mPosition.x+7;
-                y = structure->mPosition.y+1;
-                z = structure->mPosition.z+7;
-                PlayerStructure* sign = gNonPersistantObjectFactory->requestBuildingSignObject(x,y,z,player,"sign","sign_name",structure->getCustomName());
-                HouseObject* house = dynamic_cast<HouseObject*>(structure);
-                house->setSign(sign);
+                gMessageLib->sendDestroyObject_InRangeofObject(fence);
+                gWorldManager->destroyObject(fence);
             }
-            */
-
-
+            gWorldManager->handleObjectReady(structure,NULL);
+            return(false);
         }
 
+        if(!fence)
+        {
+            return(false);
+        }
 
-        it = objectList->erase(it);
+        //delete the fence
+        gMessageLib->sendDestroyObject_InRangeofObject(fence);
+        gWorldManager->destroyObject(fence);
 
+        gWorldManager->createObjectinWorld(player,structure);
+        gMessageLib->sendConstructionComplete(player,structure);
     }
 
-    return (false);
+    return(false);
 }
 
 
@@ -1146,6 +1152,25 @@ void StructureManager::processVerification(StructureAsyncCommand command, bool o
         asyncContainer->mPlayerId		= command.PlayerId;
         asyncContainer->command			= command;
 
+        //harvesters know their power and maintenance, only the owners name is needed
+        //houses and factories know their maintenance, a factorys power is used up by the chatserver
+        if(_hasUpkeep(structure))
+        {
+            settleStructure(structure);
+
+            if(dynamic_cast<HarvesterObject*>(structure))
+            {
+                mDatabase->executeSqlAsync(this,asyncContainer,"SELECT \'name\', c.firstname FROM characters c WHERE c.id = %"PRIu64"",structure->getOwner());
+                break;
+            }
+
+            mDatabase->executeSqlAsync(this,asyncContainer,
+                                       "(SELECT \'name\', c.firstname  FROM characters c WHERE c.id = %"PRIu64")"
+                                       "UNION (SELECT \'power\', sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 384)"
+                                       " ",structure->getOwner(),command.StructureId);
+            break;
+        }
+
         mDatabase->executeSqlAsync(this,asyncContainer,
                                    "(SELECT \'name\', c.firstname  FROM characters c WHERE c.id = %"PRIu64")"
                                    "UNION (SELECT \'power\', sa.value FROM structure_attributes sa WHERE sa.structure_id = %"PRIu64" AND sa.attribute_id = 384)"
@@ -1159,6 +1184,14 @@ void StructureManager::processVerification(StructureAsyncCommand command, bool o
     {
         PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(command.StructureId));
 
+        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
+        if(harvester)
+        {
+            settleStructure(harvester);
+            createPowerTransferBox(player,harvester);
+            break;
+        }
+
         StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_UpdateAttributes,player->getClient());
         asyncContainer->mStructureId	= command.StructureId;
         asyncContainer->mPlayerId		= command.PlayerId;
@@ -1174,6 +1207,13 @@ void StructureManager::processVerification(StructureAsyncCommand command, bool o
     {
         PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(command.StructureId));
 
+        if(structure && _hasUpkeep(structure))
+        {
+            settleStructure(structure);
+            createPayMaintenanceTransferBox(player,structure);
+            break;
+        }
+
         StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_UpdateAttributes,player->getClient());
         asyncContainer->mStructureId	= command.StructureId;
         asyncContainer->mPlayerId		= command.PlayerId;
@@ -1183,35 +1223,33 @@ void StructureManager::processVerification(StructureAsyncCommand command, bool o
     }
     break;
 
-    // callback for retrieving a variable amount of the selected resource
+    // retrieves a variable amount of the selected resource
     case Structure_Command_RetrieveResource:
+    case Structure_Command_DiscardResource:
     {
         HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(command.StructureId));
 
-        StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_ResourceRetrieve,player->getClient());
-        asyncContainer->mStructureId	= command.StructureId;
-        asyncContainer->mPlayerId		= command.PlayerId;
-        asyncContainer->command 		= command;
-
-        mDatabase->executeSqlAsync(harvester,asyncContainer,"SELECT sf_DiscardResource(%"PRIu64",%"PRIu64",%u) ",harvester->getId(),command.ResourceId,command.Amount);
-
-
-    }
-    break;
+        if(!harvester)
+            return;
 
-    // callback for discarding a variable amount of the selected resource
-    case Structure_Command_DiscardResource:
-    {
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(command.StructureId));
+        settleStructure(harvester);
 
-        StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_ResourceDiscard,player->getClient());
-        asyncContainer->mStructureId	= command.StructureId;
-        asyncContainer->mPlayerId		= command.PlayerId;
-        asyncContainer->command 		= command;
+        if(!harvester->removeResource(command.ResourceId,static_cast<float>(command.Amount)))
+        {
+            gMessageLib->sendResourceEmptyHopperResponse(harvester,player,1, command.b1, command.b2);
+            return;
+        }
 
-        mDatabase->executeSqlAsync(harvester,asyncContainer,"SELECT sf_DiscardResource(%"PRIu64",%"PRIu64",%u) ",harvester->getId(),command.ResourceId,command.Amount);
+        if(command.Command == Structure_Command_RetrieveResource)
+        {
+            harvester->createResourceContainer(command.ResourceId, player, command.Amount);
+        }
 
+        //the resource left the world, so dont leave it to the write behind
+        saveStructure(harvester);
 
+        gMessageLib->SendHarvesterHopperUpdate(harvester,player);
+        gMessageLib->sendResourceEmptyHopperResponse(harvester,player,0, command.b1, command.b2);
     }
     break;
 
@@ -1222,28 +1260,26 @@ void StructureManager::processVerification(StructureAsyncCommand command, bool o
         if(!harvester)
             return;
 
-        StructureManagerAsyncContainer* asyncContainer = new StructureManagerAsyncContainer(Structure_GetResourceData,player->getClient());
-        asyncContainer->mStructureId	= command.StructureId;
-        asyncContainer->mPlayerId		= command.PlayerId;
-        mDatabase->executeSqlAsync(harvester,asyncContainer,"SELECT hr.resourceID, hr.quantity FROM harvester_resources hr WHERE hr.ID = '%"PRIu64"' ",harvester->getId());
-
+        settleStructure(harvester);
 
+        gMessageLib->sendHarvesterResourceData(harvester,player);
+        gMessageLib->sendBaselinesHINO_7(harvester,player);
     }
     break;
 
     case Structure_Command_DiscardHopper:
     {
-        //send the db update
-        StructureManagerAsyncContainer* asyncContainer;
-
         HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(command.StructureId));
 
-        asyncContainer = new StructureManagerAsyncContainer(Structure_HopperDiscard, 0);
-        asyncContainer->mStructureId	= command.StructureId;
-        asyncContainer->mPlayerId		= command.PlayerId;
-        mDatabase->executeSqlAsync(harvester,asyncContainer,"select sf_DiscardHopper(%"PRIu64")",command.StructureId);
+        if(!harvester)
+            return;
 
+        settleStructure(harvester);
 
+        harvester->getResourceList()->clear();
+        saveStructure(harvester);
+
+        gMessageLib->SendHarvesterHopperUpdate(harvester,player);
     }
     break;
 
@@ -1514,23 +1550,583 @@ uint32 StructureManager::deductPower(PlayerObject* player, uint32 amount)
 
 //======================================================================================================================
 //
-// Handle deletion of destroyed Structures / building fences and other stuff
+// the settle timeline holds one task per structure, a task sleeps until the next thing that can
+// change about its structure and is moved whenever a player changes the structure
+// so a tick only pays for the structures that are due, not for all structures of the zone
 //
 
-bool StructureManager::_handleStructureDBCheck(uint64 callTime, void* ref)
+void StructureManager::addStructureforDestruction(uint64 iD)
 {
-    //iterate through all harvesters which are marked inactive in the db
+    PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(iD));
+    if(!structure)
+    {
+        return;
+    }
 
-    StructureManagerAsyncContainer* asyncContainer;
-    asyncContainer = new StructureManagerAsyncContainer(Structure_GetInactiveHarvesters, 0);
-    mDatabase->executeSqlAsync(this,asyncContainer,"SELECT h.ID, s.condition FROM harvesters h INNER JOIN structures s ON (h.ID = s.ID) WHERE active = 0 AND s.zone = %u", gWorldManager->getZoneId());
+    structure->getTTS()->projectedTime = Anh_Utils::Clock::getSingleton()->getLocalTime() + 1000;
+    _scheduleStructure(structure);
+}
+
+void StructureManager::addStructureforConstruction(uint64 iD)
+{
+    //the fence time was set together with the order
+    PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(iD));
+    if(structure)
+    {
+        _scheduleStructure(structure);
+    }
+}
+
+void StructureManager::addStructure(PlayerStructure* structure)
+{
+    if(_hasUpkeep(structure))
+    {
+        _scheduleStructure(structure);
+    }
+}
+
+void StructureManager::removeStructure(uint64 id)
+{
+    std::map<uint64,uint64>::iterator it = mSettleTasks.find(id);
+    if(it != mSettleTasks.end())
+    {
+        if(mSettleScheduler)
+        {
+            mSettleScheduler->removeTask((*it).second);
+        }
+        mSettleTasks.erase(it);
+    }
+
+    mDirtyStructures.erase(id);
+    mStructureMails.erase(id);
+}
+
+//======================================================================================================================
+//
+// brings a structure up to now, a structure that shut down or lost condition on the way is written right away
+// everything else is written behind
+//
+
+void StructureManager::settleStructure(PlayerStructure* structure)
+{
+    if(!_hasUpkeep(structure))
+    {
+        return;
+    }
+
+    if(_settle(structure,time(NULL),true))
+    {
+        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
+        if(harvester)
+        {
+            gMessageLib->sendHarvesterActive(harvester);
+            gMessageLib->sendHarvesterCurrentConditionUpdate(harvester);
+        }
+        saveStructure(structure);
+        return;
+    }
+
+    mDirtyStructures.insert(structure->getId());
+    _scheduleStructure(structure);
+}
+
+//======================================================================================================================
+//
+// writes a settled structure to the db and moves its next visit, its pools or its state may have changed
+//
+
+void StructureManager::saveStructure(PlayerStructure* structure)
+{
+    _writeStructure(structure);
+
+    if(_hasUpkeep(structure))
+    {
+        _scheduleStructure(structure);
+    }
+}
+
+//======================================================================================================================
+//
+// a structure is written in one transaction, so its writes cant overtake each other on the worker connections
+// the hopper is written as a whole, that takes care of new resources and a discarded hopper alike
+//
+
+void StructureManager::_writeStructure(PlayerStructure* structure)
+{
+    uint64 id = structure->getId();
+
+    Transaction* transaction = mDatabase->startTransaction(NULL,NULL);
+
+    //382 = examine_maintenance
+    transaction->addQuery("UPDATE structures s SET s.condition= %u WHERE s.ID=%"PRIu64"",structure->getDamage(),id);
+    transaction->addQuery("UPDATE structure_attributes SET value='%u' WHERE structure_id=%"PRIu64" AND attribute_id=382",structure->getCurrentMaintenance(),id);
+
+    //384 = examine_power, only a harvester uses its power in the zone
+    HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
+    if(harvester)
+    {
+        transaction->addQuery("UPDATE structure_attributes SET value='%u' WHERE structure_id=%"PRIu64" AND attribute_id=384",harvester->getCurrentPower(),id);
+        transaction->addQuery("UPDATE harvesters SET active = %u, ResourceID = %"PRIu64", rate = %f WHERE id=%"PRIu64"",harvester->getActive() ? 1 : 0,harvester->getCurrentResource(),harvester->getCurrentExtractionRate(),id);
+        transaction->addQuery("DELETE FROM harvester_resources WHERE ID = %"PRIu64"",id);
+
+        HResourceList*			hRList	= harvester->getResourceList();
+        HResourceList::iterator	it		= hRList->begin();
+        while(it != hRList->end())
+        {
+            transaction->addQuery("INSERT INTO harvester_resources VALUES(%"PRIu64",%"PRIu64",%f,0)",id,(*it).first,(*it).second);
+            ++it;
+        }
+    }
+
+    if(_hasUpkeep(structure))
+    {
+        transaction->addQuery("INSERT INTO structure_settlement VALUES (%"PRIu64",%"PRIu64") ON DUPLICATE KEY UPDATE settled_at = VALUES(settled_at)",id,structure->getSettledAt());
+    }
+
+    transaction->execute();
+
+    mDirtyStructures.erase(id);
+}
+
+//======================================================================================================================
+//
+// the zone accounts the upkeep of harvesters, houses and factories
+// all of them share the block wise, asynchronous bank draw in _settle, so the bank costs scale with the days
+// a structure lives off it and not with the number of houses in the zone
+// a factorys production run and the power it uses are still left to the chatserver
+//
+
+bool StructureManager::_hasUpkeep(PlayerStructure* structure)
+{
+    return((dynamic_cast<HarvesterObject*>(structure) != NULL) || (dynamic_cast<HouseObject*>(structure) != NULL) || (dynamic_cast<FactoryObject*>(structure) != NULL));
+}
+
+//======================================================================================================================
+//
+// time in ms until the structure has to be looked at again, 0 if never
+// the earliest of a pending order, a predicted threshold, a pending write and the daily settlement
+//
+
+uint64 StructureManager::_getNextVisit(PlayerStructure* structure, uint64 now)
+{
+    uint64 next = 0;
+
+    if(_hasUpkeep(structure))
+    {
+        next = static_cast<uint64>(mSettleBatchInterval) * 1000;
+
+        //a structure waiting for its bank is visited again once the bank answered
+        uint64 threshold = structure->getNextThreshold();
+        if(threshold && (mPendingDraws.find(structure->getId()) == mPendingDraws.end()))
+        {
+            next = std::min(next,(threshold > now) ? (threshold - now) * 1000 : 0);
+        }
+
+        if(mDirtyStructures.find(structure->getId()) != mDirtyStructures.end())
+        {
+            next = std::min(next,static_cast<uint64>(mWriteBehindInterval) * 1000);
+        }
+    }
+
+    //orders run on the local clock
+    timerTodoStruct* tts = structure->getTTS();
+    if((tts->todo == ttE_Delete) || (tts->todo == ttE_BuildingFence))
+    {
+        uint64 local	= Anh_Utils::Clock::getSingleton()->getLocalTime();
+        uint64 due		= (tts->projectedTime > local) ? (tts->projectedTime - local) : 0;
 
-    asyncContainer = new StructureManagerAsyncContainer(Structure_GetDestructionStructures, 0);
-    mDatabase->executeSqlAsync(this,asyncContainer,"SELECT h.ID, s.condition FROM harvesters h INNER JOIN structures s ON (h.ID = s.ID) WHERE active = 0 AND( s.condition >= 1000) AND s.zone = %u", gWorldManager->getZoneId());
+        next = next ? std::min(next,due) : std::max(due,(uint64)1);
+    }
+
+    if(!next && !_hasUpkeep(structure))
+    {
+        return(0);
+    }
+
+    //thresholds are in whole seconds, a structure settled this second cant change before the next
+    return(std::max(next,(uint64)1000));
+}
+
+//======================================================================================================================
+
+void StructureManager::_scheduleStructure(PlayerStructure* structure)
+{
+    if(!mSettleScheduler)
+    {
+        return;
+    }
+
+    uint64 id = structure->getId();
+
+    std::map<uint64,uint64>::iterator it = mSettleTasks.find(id);
+    if(it != mSettleTasks.end())
+    {
+        mSettleScheduler->removeTask((*it).second);
+        mSettleTasks.erase(it);
+    }
+
+    uint64 next = _getNextVisit(structure,time(NULL));
+    if(!next)
+    {
+        return;
+    }
+
+    //the task goes with the structure in removeStructure, so it never outlives it
+    mSettleTasks.insert(std::make_pair(id,mSettleScheduler->addTask(fastdelegate::MakeDelegate(this,&StructureManager::_handleStructureSettle),1,next,structure)));
+}
+
+//======================================================================================================================
 
-    return (true);
+bool StructureManager::_handleSettleScheduler(uint64 callTime, void* ref)
+{
+    if(mSettleScheduler)
+    {
+        mSettleScheduler->process();
+    }
+
+    return(true);
 }
 
+//======================================================================================================================
+//
+// a structure is due, carry out its order and settle it
+//
+
+uint64 StructureManager::_handleStructureSettle(uint64 callTime, void* ref)
+{
+    PlayerStructure* structure	= reinterpret_cast<PlayerStructure*>(ref);
+    uint64 id					= structure->getId();
+
+    timerTodoStruct* tts = structure->getTTS();
+    if(((tts->todo == ttE_Delete) || (tts->todo == ttE_BuildingFence)) && (callTime >= tts->projectedTime))
+    {
+        //the structure took its task along
+        if(_handleStructureTodo(structure))
+        {
+            return(0);
+        }
+    }
+
+    if(_hasUpkeep(structure))
+    {
+        bool changed = _settle(structure,time(NULL),true);
+
+        //a worn harvester is removed, a condemned house or factory stands until it is paid for
+        if(structure->getMaxCondition() && (structure->getDamage() >= structure->getMaxCondition()))
+        {
+            if(dynamic_cast<HarvesterObject*>(structure))
+            {
+                _destroyWornStructure(structure);
+                return(0);
+            }
+
+            if(_canMailOwner(structure,time(NULL)))
+            {
+                _sendCondemnedMail(structure);
+            }
+        }
+
+        if(changed)
+        {
+            HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
+            if(harvester)
+            {
+                gMessageLib->sendHarvesterActive(harvester);
+                gMessageLib->sendHarvesterCurrentConditionUpdate(harvester);
+            }
+
+            _writeStructure(structure);
+        }
+        else if(mDirtyStructures.find(id) != mDirtyStructures.end())
+        {
+            _writeStructure(structure);
+        }
+    }
+
+    uint64 next = _getNextVisit(structure,time(NULL));
+    if(!next)
+    {
+        mSettleTasks.erase(id);
+    }
+
+    return(next);
+}
+
+//======================================================================================================================
+//
+// a structure without condition is removed together with its deed
+//
+
+void StructureManager::_destroyWornStructure(PlayerStructure* structure)
+{
+    //the owner is told either way
+    _sendCondemnedMail(structure);
+
+    //delete the deed in the db
+    //the parent is the structure and the item family is 15
+    mDatabase->executeSqlAsync(NULL,NULL,"DELETE FROM items WHERE parent_id = %"PRIu64" AND item_family = 15",structure->getId());
+
+    //delete the structure db side with all power and all resources
+    gObjectFactory->deleteObjectFromDB(structure);
+    UpdateCharacterLots(structure->getOwner());
+
+    //delete it in the world
+    gMessageLib->sendDestroyObject_InRangeofObject(structure);
+    gWorldManager->destroyObject(structure);
+}
+
+//======================================================================================================================
+//
+// maintenance the pool cant pay for is drawn from the owners bank first, only what the bank cant cover
+// turns into damage. the bank is asked for a block that lasts until the next daily settlement, so a
+// structure on a bank fed pool comes back for it once a day, not every time another credit is due.
+// an offline owners bank is drawn on a worker, the structure holds its settlement until the answer is in.
+// the owner gets a mail when the bank steps in and when the structure takes damage,
+// the spawn the hopper was filled from is depleted by what was extracted
+//
+
+bool StructureManager::_settle(PlayerStructure* structure, uint64 now, bool drawBank)
+{
+    uint64 settledAt	= structure->getSettledAt();
+    uint32 damage		= structure->getDamage();
+    double rate			= structure->getMaintenanceRate() / 3600.0;
+    uint32 drawn		= 0;
+
+    if((now > settledAt) && (rate > 0.0))
+    {
+        double due = rate * static_cast<double>(now - settledAt);
+
+        if(mPendingDraws.find(structure->getId()) != mPendingDraws.end())
+        {
+            return(false);
+        }
+
+        if(drawBank && (due > structure->getCurrentMaintenance()))
+        {
+            drawn = _drawFromBank(structure,static_cast<uint32>(ceil(due - structure->getCurrentMaintenance() + rate * mSettleBatchInterval)));
+
+            if(mPendingDraws.find(structure->getId()) != mPendingDraws.end())
+            {
+                return(false);
+            }
+
+            if(drawn)
+            {
+                structure->setCurrentMaintenance(structure->getCurrentMaintenance() + drawn);
+                _sendBankDrawMail(structure);
+            }
+        }
+    }
+
+    HarvesterObject*	harvester	= dynamic_cast<HarvesterObject*>(structure);
+    uint64				resourceId	= harvester ? harvester->getCurrentResource() : 0;
+
+    bool changed = structure->settle(now);
+
+    if(harvester)
+    {
+        uint32		extracted	= harvester->takeExtracted();
+        Resource*	resource	= extracted ? gResourceManager->getResourceById(resourceId) : NULL;
+
+        //a spawn that despawned meanwhile has nothing left to deplete
+        if(resource && resource->getCurrent())
+        {
+            gResourceManager->setResourceDepletion(resource,extracted);
+        }
+    }
+
+    uint32 maxCondition = structure->getMaxCondition();
+    if((structure->getDamage() > damage) && (structure->getDamage() < maxCondition) && _canMailOwner(structure,now))
+    {
+        atMacroString* aMS = new atMacroString();
+        aMS->addMBstf("player_structure","mail_structure_damage");
+        aMS->addTTstf(structure->getNameFile(),structure->getName());
+        aMS->addDI((structure->getCondition() * 100) / maxCondition);
+        aMS->addTextModule();
+        _sendStructureMail(structure,aMS,"@player_structure:mail_structure_damage_sub");
+    }
+
+    //the bank was charged, so the pool cant wait for the write behind
+    return(changed || drawn);
+}
+
+//======================================================================================================================
+//
+// takes up to amount from the bank of an owner in this zone and returns what was taken
+// an offline owners bank is drawn on a worker, it returns 0 and the structure is marked as waiting
+//
+
+uint32 StructureManager::_drawFromBank(PlayerStructure* structure, uint32 amount)
+{
+    uint64 ownerId = structure->getOwner();
+
+    //an owner in this zone has the bank in memory
+    PlayerObject* owner = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(ownerId));
+    if(owner)
+    {
+        Bank* bank = dynamic_cast<Bank*>(owner->getEquipManager()->getEquippedObject(CreatureEquipSlot_Bank));
+        if(!bank || (bank->getCredits() <= 0))
+        {
+            return(0);
+        }
+
+        uint32 drawn = std::min(amount,static_cast<uint32>(bank->getCredits()));
+        if(!bank->updateCredits(-static_cast<int32>(drawn)))
+        {
+            return(0);
+        }
+
+        return(drawn);
+    }
+
+    uint64 structureId = structure->getId();
+    mPendingDraws.insert(structureId);
+
+    int8 sql[256];
+    sprintf(sql,"UPDATE banks SET credits = credits - (@drawn := LEAST(credits,%u)) WHERE id=%"PRIu64" AND credits > 0",amount,ownerId + BANK_OFFSET);
+
+    //what was drawn can only be read on the connection that drew it
+    mDatabase->executeAsyncUpdate(sql,"SELECT ROW_COUNT(), @drawn",[=] (DatabaseResult* result) {
+        _handleBankDraw(structureId,ownerId,result);
+    });
+
+    return(0);
+}
+
+//======================================================================================================================
+//
+// an offline owners bank answered, the pool is credited and the structure settled up to now
+//
+
+void StructureManager::_handleBankDraw(uint64 structureId, uint64 ownerId, DatabaseResult* result)
+{
+    uint32 drawn = 0;
+
+    if(result && result->getResultSet() && result->getResultSet()->next() && (result->getResultSet()->getInt64(1) == 1))
+    {
+        drawn = result->getResultSet()->getUInt(2);
+    }
+
+    mPendingDraws.erase(structureId);
+
+    PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(structureId));
+    if(!structure)
+    {
+        //the structure was removed meanwhile, the owner gets the credits back
+        if(drawn)
+        {
+            mDatabase->executeSqlAsync(NULL,NULL,"UPDATE banks SET credits = credits + %u WHERE id=%"PRIu64"",drawn,ownerId + BANK_OFFSET);
+        }
+        return;
+    }
+
+    if(drawn)
+    {
+        structure->setCurrentMaintenance(structure->getCurrentMaintenance() + drawn);
+        _sendBankDrawMail(structure);
+    }
+
+    //the bank had its say, what it couldnt cover turns into damage
+    _settle(structure,time(NULL),false);
+
+    HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(structure);
+    if(harvester && structure->getMaxCondition() && (structure->getDamage() >= structure->getMaxCondition()))
+    {
+        _destroyWornStructure(structure);
+        return;
+    }
+
+    if(harvester)
+    {
+        gMessageLib->sendHarvesterActive(harvester);
+        gMessageLib->sendHarvesterCurrentConditionUpdate(harvester);
+    }
+
+    saveStructure(structure);
+}
+
+//======================================================================================================================
+
+void StructureManager::_sendBankDrawMail(PlayerStructure* structure)
+{
+    if(!_canMailOwner(structure,time(NULL)))
+    {
+        return;
+    }
+
+    atMacroString* aMS = new atMacroString();
+    aMS->addMBstf("player_structure","structure_maintenance_empty_body");
+    aMS->addTTstf(structure->getNameFile(),structure->getName());
+    aMS->addTextModule();
+    _sendStructureMail(structure,aMS,"@player_structure:structure_maintenance_empty_subject");
+}
+
+//======================================================================================================================
+//
+// an owner hears about the same structure at most once a day
+//
+
+bool StructureManager::_canMailOwner(PlayerStructure* structure, uint64 now)
+{
+    std::map<uint64,uint64>::iterator it = mStructureMails.find(structure->getId());
+    if((it != mStructureMails.end()) && (now < (*it).second + 24*3600))
+    {
+        return(false);
+    }
+
+    mStructureMails[structure->getId()] = now;
+    return(true);
+}
+
+//======================================================================================================================
+
+void StructureManager::_sendCondemnedMail(PlayerStructure* structure)
+{
+    atMacroString* aMS = new atMacroString();
+    aMS->addMBstf("player_structure","structure_condemned_body");
+    aMS->addTTstf(structure->getNameFile(),structure->getName());
+    aMS->addDI(structure->getMaxCondition() * structure->getMaintenanceRate());
+    aMS->addTextModule();
+    _sendStructureMail(structure,aMS,"@player_structure:structure_condemned_subject");
+}
+
+//======================================================================================================================
+//
+// an online owner gets the mail through the chatserver right away, otherwise it is waiting at the next login
+//
+
+void StructureManager::_sendStructureMail(PlayerStructure* structure, atMacroString* aMS, BString subject)
+{
+    BString planet = gWorldManager->getPlanetNameThis();
+    planet.toLowerFirst();
+
+    aMS->setPlanetString(planet);
+    aMS->setWP(structure->mPosition.x,0,structure->mPosition.z,"Structure");
+    aMS->addWaypoint();
+
+    BString attachments = aMS->assemble();
+    delete aMS;
+
+    PlayerObject* owner = dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(structure->getOwner()));
+    if(owner && owner->isConnected())
+    {
+        gMessageLib->sendStructureMail(owner,subject,attachments);
+        return;
+    }
+
+    BString sender = "@player_structure:management";
+
+    int8	sql[8192],*sqlPointer;
+    sqlPointer  = sql + sprintf(sql,"SELECT sf_MailCreate('");
+    sqlPointer += mDatabase->escapeString(sqlPointer,sender.getAnsi(),sender.getLength());
+    sqlPointer += sprintf(sqlPointer,"',%"PRIu64",'",structure->getOwner());
+    sqlPointer += mDatabase->escapeString(sqlPointer,subject.getAnsi(),subject.getLength());
+    sqlPointer += sprintf(sqlPointer,"','','");
+    sqlPointer += mDatabase->escapeString(sqlPointer,attachments.getRawData(),(attachments.getLength() << 1));
+    sqlPointer += sprintf(sqlPointer,"',%u,%"PRIu32")",(attachments.getLength() << 1),static_cast<uint32>(time(NULL)));
+
+    mDatabase->executeSqlAsyncNoArguments(NULL,NULL,sql);
+}
 
 //==========================================================================================0
 //asynchronously updates the lot count of a player
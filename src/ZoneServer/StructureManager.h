@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <vector>
 #include <list>
+#include <map>
 
 #include "DatabaseManager/DatabaseCallback.h"
 #include "ObjectFactoryCallback.h"
@@ -46,17 +47,19 @@ class MessageDispatch;
 class PlayerObject;
 class FactoryObject;
 class PlayerStructure;
+class HarvesterObject;
 class UIWindow;
 class StructureManagerCommandMapClass;
 class StructureHeightmapAsyncContainer;
 class NoBuildRegion;
 class ObjectController;
+class atMacroString;
 
 namespace Anh_Utils
 {
 // class Clock;
 class Scheduler;
-//class VariableTimeScheduler;
+class VariableTimeScheduler;
 }
 //======================================================================================================================
 
@@ -75,15 +78,7 @@ enum Structure_QueryType
     Structure_Query_Check_Permission			=	7,
     Structure_StructureTransfer_Lots_Recipient	=	8,
     Structure_StructureTransfer_Lots_Donor		=	9,
-    Structure_HopperUpdate						=	10,
-    Structure_HopperDiscard						=	11,
-    Structure_GetResourceData					=	12,
-    Structure_ResourceDiscardUpdateHopper		=	13,
-    Structure_ResourceDiscard					=	14,
-    Structure_ResourceRetrieve					=	15,
-
-    Structure_GetInactiveHarvesters	 			=	16,
-    Structure_GetDestructionStructures			=	17,
+
     Structure_UpdateStructureDeed				=	18,
     Structure_UpdateCharacterLots				=	19,
     Structure_UpdateAttributes					=	20,
@@ -343,30 +338,16 @@ public:
     //returns a confirmatioon code for structure destruction
     BString					getCode();
 
-    //
-    ObjectIDList*			getStrucureDeleteList() {
-        return &mStructureDeleteList;
-    }
-    void					addStructureforDestruction(uint64 iD)
-    {
-        mStructureDeleteList.push_back(iD);
-        gWorldManager->getPlayerScheduler()->addTask(fastdelegate::MakeDelegate(this,&StructureManager::_handleStructureObjectTimers),7,1000,NULL);
-    }
-
-    void					addStructureforConstruction(uint64 iD)
-    {
-        mStructureDeleteList.push_back(iD);
-        gWorldManager->getPlayerScheduler()->addTask(fastdelegate::MakeDelegate(this,&StructureManager::_handleStructureObjectTimers),7,mBuildingFenceInterval,NULL);
-    }
-
-    void					addStructureforHopperUpdate(uint64 iD)
-    {
-        mStructureDeleteList.insert(mStructureDeleteList.begin(),iD);// .push_back(iD);
-        gWorldManager->getPlayerScheduler()->addTask(fastdelegate::MakeDelegate(this,&StructureManager::_handleStructureObjectTimers),7,5000,NULL);
-    }
+    //timed destruction and construction orders, see the structures timerTodoStruct
+    void					addStructureforDestruction(uint64 iD);
+    void					addStructureforConstruction(uint64 iD);
 
-    //check all active harvesters once in a while they might have been turned off by the db
-    bool					_handleStructureDBCheck(uint64 callTime, void* ref);
+    //every harvester, house and factory has its own entry on the settle timeline, it is only visited
+    //when something is due. settle a structure before its state is shown or changed and save it afterwards
+    void					addStructure(PlayerStructure* structure);
+    void					removeStructure(uint64 id);
+    void					settleStructure(PlayerStructure* structure);
+    void					saveStructure(PlayerStructure* structure);
 
     void					OpenStructureAdminList(uint64 structureId, uint64 playerId);
     void					OpenStructureEntryList(uint64 structureId, uint64 playerId);
@@ -402,8 +383,6 @@ private:
     void				_HandleQueryBanPermissionData(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
     void				_HandleUpdateCharacterLots(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
     void				_HandleStructureRedeedCallBack(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
-    void				_HandleStructureDestruction(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
-    void				_HandleGetInactiveHarvesters(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
     void				_HandleStructureTransferLotsRecipient(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
     void				_HandleQueryLoadDeedData(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
     void				_HandleRemovePermission(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result);
@@ -418,7 +397,34 @@ private:
 
     StructureManager(Database* database,MessageDispatch* dispatch);
 
-    bool	_handleStructureObjectTimers(uint64 callTime, void* ref);
+    //runs the settle timeline
+    bool	_handleSettleScheduler(uint64 callTime, void* ref);
+
+    //a structures visit on the timeline, returns the time to its next visit in ms
+    uint64	_handleStructureSettle(uint64 callTime, void* ref);
+
+    //carries out a due destruction or construction order, returns true if the structure is gone
+    bool	_handleStructureTodo(PlayerStructure* structure);
+
+    bool	_hasUpkeep(PlayerStructure* structure);
+    uint64	_getNextVisit(PlayerStructure* structure, uint64 now);
+    void	_scheduleStructure(PlayerStructure* structure);
+    void	_writeStructure(PlayerStructure* structure);
+    void	_destroyWornStructure(PlayerStructure* structure);
+
+    //settles a structure, unpaid maintenance is drawn from the owners bank before it turns into damage
+    //returns true if the structures condition or operating state changed or the bank paid for it
+    bool	_settle(PlayerStructure* structure, uint64 now, bool drawBank);
+
+    //takes a block from an owner in the zone right away, an offline owners bank answers in _handleBankDraw
+    uint32	_drawFromBank(PlayerStructure* structure, uint32 amount);
+    void	_handleBankDraw(uint64 structureId, uint64 ownerId, DatabaseResult* result);
+    void	_sendBankDrawMail(PlayerStructure* structure);
+
+    //adds the structures location to the body and sends it to the owner, online or not
+    void	_sendStructureMail(PlayerStructure* structure, atMacroString* aMS, BString subject);
+    void	_sendCondemnedMail(PlayerStructure* structure);
+    bool	_canMailOwner(PlayerStructure* structure, uint64 now);
 
     static StructureManager*	mSingleton;
     static bool					mInsFlag;
@@ -428,9 +434,16 @@ private:
 
     DeedLinkList				mDeedLinkList;
     StructureItemList			mItemTemplate;
-    ObjectIDList				mStructureDeleteList;
     uint32						mBuildingFenceInterval;
 
+    Anh_Utils::VariableTimeScheduler*	mSettleScheduler;
+    std::map<uint64,uint64>		mSettleTasks;
+    ObjectIDSet					mDirtyStructures;
+    uint32						mSettleBatchInterval;
+    uint32						mWriteBehindInterval;
+    std::map<uint64,uint64>		mStructureMails;
+    ObjectIDSet					mPendingDraws;
+
     NoBuildRegionList			mNoBuildList;
 
 };
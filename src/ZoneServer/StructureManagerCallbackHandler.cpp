@@ -325,106 +325,6 @@ void StructureManager::_HandleStructureRedeedCallBack(StructureManagerAsyncConta
     mDatabase->destroyDataBinding(binding);
 }
 
-//==================================================================================================
-//
-// handles the callback of the destruction of structures when condition wears of.
-//
-
-void StructureManager::_HandleStructureDestruction(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result)
-{
-    struct structData
-    {
-        uint64 id;
-        uint32 condition;
-    };
-
-    structData sd;
-
-    DataBinding* binding = mDatabase->createDataBinding(2);
-    binding->addField(DFT_uint64,offsetof(structData,id),8,0);
-    binding->addField(DFT_uint32,offsetof(structData,condition),4,1);
-
-    uint64 count;
-    count = result->getRowCount();
-
-    for(uint64 i = 0; i < count; i++)
-    {
-        result->getNextRow(binding,&sd);
-
-        PlayerStructure* structure = dynamic_cast<PlayerStructure*>(gWorldManager->getObjectById(sd.id));
-        if(structure)
-        {
-            //delete the deed in the db
-            //the parent is the structure and the item family is 15
-            int8 sql[100];
-            sprintf(sql,"DELETE FROM items WHERE parent_id = %"PRIu64" AND item_family = 15",structure->getId());
-            mDatabase->executeSqlAsync(NULL,NULL,sql);
-            
-
-            //delete harvester db side with all power and all resources
-            gObjectFactory->deleteObjectFromDB(structure);
-            UpdateCharacterLots(structure->getOwner());
-
-            //delete it in the world
-            gMessageLib->sendDestroyObject_InRangeofObject(structure);
-            gWorldManager->destroyObject(structure);
-
-
-
-        }
-    }
-
-    mDatabase->destroyDataBinding(binding);
-}
-
-//==================================================================================================
-//
-// handles the callback of the destruction of structures when condition wears of.
-//
-
-void StructureManager::_HandleGetInactiveHarvesters(StructureManagerAsyncContainer* asynContainer,DatabaseResult* result)
-{
-
-    struct structData
-    {
-        uint64 id;
-        uint32 condition;
-    };
-
-    structData sd;
-
-    DataBinding* binding = mDatabase->createDataBinding(2);
-    binding->addField(DFT_uint64,offsetof(structData,id),8,0);
-    binding->addField(DFT_uint32,offsetof(structData,condition),4,1);
-
-    uint64 count;
-    count = result->getRowCount();
-
-    for(uint64 i = 0; i < count; i++)
-    {
-        result->getNextRow(binding,&sd);
-
-        HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(gWorldManager->getObjectById(sd.id));
-        if(harvester)
-        {
-            //if the harvesters status is changed we need to alter it
-            if(harvester->getActive())
-            {
-                harvester->setActive(false);
-                harvester->setDamage(sd.condition);
-
-                gMessageLib->sendHarvesterActive(harvester);
-
-            }
-            //Now update the condition
-            gMessageLib->sendHarvesterCurrentConditionUpdate(harvester);
-        }
-
-    }
-
-    mDatabase->destroyDataBinding(binding);
-}
-
 //==================================================================================================
 //
 // tests the amount of lots for the recipient of a structure during a structure transfer
@@ -54,8 +54,6 @@ StructureManagerCommandMapClass::StructureManagerCommandMapClass()
     mCommandMap.insert(std::make_pair(Structure_Query_Entry_Permission_Data,&StructureManager::_HandleQueryEntryPermissionData));
     mCommandMap.insert(std::make_pair(Structure_UpdateCharacterLots,&StructureManager::_HandleUpdateCharacterLots));
     mCommandMap.insert(std::make_pair(Structure_UpdateStructureDeed,&StructureManager::_HandleStructureRedeedCallBack));
-    mCommandMap.insert(std::make_pair(Structure_GetDestructionStructures,&StructureManager::_HandleStructureDestruction));
-    mCommandMap.insert(std::make_pair(Structure_GetInactiveHarvesters,&StructureManager::_HandleGetInactiveHarvesters));
     mCommandMap.insert(std::make_pair(Structure_StructureTransfer_Lots_Recipient,&StructureManager::_HandleStructureTransferLotsRecipient));
     mCommandMap.insert(std::make_pair(Structure_Query_LoadDeedData,&StructureManager::_HandleQueryLoadDeedData));
     mCommandMap.insert(std::make_pair(Structure_Query_Remove_Permission,&StructureManager::_HandleRemovePermission));
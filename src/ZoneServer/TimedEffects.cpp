@@ -0,0 +1,172 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "TimedEffects.h"
+
+#include <algorithm>
+
+#include "Buff.h"
+#include "CreatureObject.h"
+#include "Utils/clock.h"
+#include "Utils/TickProfiler.h"
+
+//=============================================================================
+
+static bool ownerLess(const std::pair<uint64,uint64>& left,const std::pair<uint64,uint64>& right)
+{
+    return(left.first < right.first);
+}
+
+//=============================================================================
+
+TimedEffects::TimedEffects(uint64 tickLength,uint64 processTimeLimit)
+    : mTickLength(tickLength ? tickLength : 1)
+    , mProcessTimeLimit(processTimeLimit)
+    , mProfileSection(0)
+{
+}
+
+//=============================================================================
+
+TimedEffects::~TimedEffects()
+{
+}
+
+//=============================================================================
+
+uint64 TimedEffects::addBuff(Buff* buff,uint64 delay)
+{
+    uint64 now		= Anh_Utils::Clock::getSingleton()->getLocalTime();
+    uint64 ownerId	= buff->GetTarget() ? buff->GetTarget()->getId() : 0;
+
+    return(mHeap.insert(_alignToTick(now + delay + 1),ownerId,buff));
+}
+
+//=============================================================================
+
+void TimedEffects::remove(uint64 id)
+{
+    mHeap.remove(id);
+}
+
+//=============================================================================
+
+uint32 TimedEffects::removeOwner(uint64 ownerId)
+{
+    return(mHeap.removeOwner(ownerId));
+}
+
+//=============================================================================
+
+void TimedEffects::process()
+{
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    if(mHeap.getNextDue() > now)
+        return;
+
+    Anh_Utils::ProfileScope processScope(mProfileSection);
+
+    mHeap.popExpired(now,mExpired);
+
+    std::vector<uint64>::iterator it = mExpired.begin();
+
+    while(it != mExpired.end())
+    {
+        mBatch.push_back(std::make_pair(mHeap.getOwner(*it),*it));
+        ++it;
+    }
+
+    mExpired.clear();
+
+    // one run per creature, its buffs stay in deadline order
+    std::stable_sort(mBatch.begin(),mBatch.end(),ownerLess);
+
+    Batch::iterator groupStart = mBatch.begin();
+
+    while(groupStart != mBatch.end())
+    {
+        Batch::iterator groupEnd = groupStart;
+
+        while(groupEnd != mBatch.end() && groupEnd->first == groupStart->first)
+            ++groupEnd;
+
+        _runOwner(groupStart,groupEnd,now);
+
+        groupStart = groupEnd;
+
+        // out of time, whatever is left goes back to the heap and runs first next tick
+        if(Anh_Utils::Clock::getSingleton()->getLocalTime() - now >= mProcessTimeLimit)
+        {
+            while(groupStart != mBatch.end())
+            {
+                mHeap.reschedule(groupStart->second,mHeap.getDue(groupStart->second));
+                ++groupStart;
+            }
+        }
+    }
+
+    mBatch.clear();
+}
+
+//=============================================================================
+
+void TimedEffects::_runOwner(Batch::iterator begin,Batch::iterator end,uint64 now)
+{
+    for(Batch::iterator it = begin; it != end; ++it)
+    {
+        // an earlier buff of this batch may have cancelled it
+        if(!mHeap.contains(it->second))
+            continue;
+
+        Buff* buff = reinterpret_cast<Buff*>(mHeap.getData(it->second));
+
+        uint64 due		= mHeap.getDue(it->second);
+        uint64 nextTick	= buff->Update(now,NULL);
+
+        // removed from within its update
+        if(!mHeap.contains(it->second))
+            continue;
+
+        if(nextTick == 0)
+        {
+            mHeap.remove(it->second);
+        }
+        else
+        {
+            // count from the deadline, not from when we got to it, so ticks don't drift
+            mHeap.reschedule(it->second,_alignToTick(std::max(due + nextTick,now + 1)));
+        }
+    }
+}
+
+//=============================================================================
+
+uint64 TimedEffects::_alignToTick(uint64 time) const
+{
+    return(((time + mTickLength - 1) / mTickLength) * mTickLength);
+}
@@ -0,0 +1,98 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2010 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_TIMED_EFFECTS_H
+#define ANH_ZONESERVER_TIMED_EFFECTS_H
+
+#include <utility>
+#include <vector>
+
+#include "Utils/DeadlineHeap.h"
+#include "Utils/typedefs.h"
+
+//=============================================================================
+
+class Buff;
+
+//=============================================================================
+//
+// Runs the ticks of all active buffs off one deadline heap.
+//
+// Deadlines are rounded up to the tick length, so everything expiring in the
+// same tick is popped together and grouped per creature. The hitpoint deltas
+// of a creature's buffs are merged by the delta batch of MessageLib, so the
+// client gets one delta per creature and tick instead of two per bar and buff.
+// Entries are keyed by the creature they affect, so a dying or logging out
+// creature drops all of its effects in one call.
+//
+
+class TimedEffects
+{
+public:
+
+    TimedEffects(uint64 tickLength,uint64 processTimeLimit);
+    ~TimedEffects();
+
+    // handles are never 0 and never repeat, they are kept as the buffs id
+    uint64	addBuff(Buff* buff,uint64 delay);
+    void	remove(uint64 id);
+    uint32	removeOwner(uint64 ownerId);
+    bool	contains(uint64 id) const {
+        return(mHeap.contains(id));
+    }
+
+    void	process();
+
+    uint64	getNextDeadline() const {
+        return(mHeap.getNextDue());
+    }
+    uint32	getCount() const {
+        return(mHeap.size());
+    }
+
+    void	setProfileSection(uint32 section) {
+        mProfileSection = section;
+    }
+
+private:
+
+    // owner id, handle
+    typedef std::pair<uint64,uint64>	BatchEntry;
+    typedef std::vector<BatchEntry>		Batch;
+
+    uint64	_alignToTick(uint64 time) const;
+    void	_runOwner(Batch::iterator begin,Batch::iterator end,uint64 now);
+
+    Anh_Utils::DeadlineHeap	mHeap;
+    std::vector<uint64>		mExpired;
+    Batch					mBatch;
+    uint64					mTickLength;
+    uint64					mProcessTimeLimit;
+    uint32					mProfileSection;
+};
+
+#endif
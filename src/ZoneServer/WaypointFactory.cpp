@@ -122,6 +122,28 @@ WaypointObject* WaypointFactory::_createWaypoint(DatabaseResult* result)
 
 //=============================================================================
 
+WaypointObject* WaypointFactory::createWaypoint(uint64 id,uint64 ownerId,const BString& name,const glm::vec3& coords,const BString& planetName,uint8 wpType)
+{
+    WaypointObject*	waypoint = new WaypointObject();
+
+    waypoint->mId		= id;
+    waypoint->mParentId	= ownerId;
+    waypoint->mCoords	= coords;
+    waypoint->mName		= name;
+    waypoint->mModel	= planetName;
+    waypoint->mActive	= true;
+    waypoint->mWPType	= wpType;
+
+    // the db keeps names as ansi
+    waypoint->mName.convert(BSTRType_ANSI);
+    waypoint->mName.convert(BSTRType_Unicode16);
+    waypoint->setPlanetCRC(waypoint->getModelString().getCrc());
+
+    return waypoint;
+}
+
+//=============================================================================
+
 void WaypointFactory::_setupDatabindings()
 {
     mWaypointBinding = mDatabase->createDataBinding(9);
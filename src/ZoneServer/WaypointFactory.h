@@ -29,6 +29,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define ANH_ZONESERVER_WAYPOINT_OBJECT_FACTORY_H
 
 #include "FactoryBase.h"
+#include "Utils/bstring.h"
+
+#include <glm/glm.hpp>
 
 #define	 gWaypointFactory	WaypointFactory::getSingletonPtr()
 
@@ -63,6 +66,9 @@ public:
     void			handleDatabaseJobComplete(void* ref,DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+    // builds a waypoint that is not in the db yet, like it would be loaded
+    WaypointObject*	createWaypoint(uint64 id,uint64 ownerId,const BString& name,const glm::vec3& coords,const BString& planetName,uint8 wpType);
+
 private:
 
     WaypointFactory(Database* database);
@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "WorldManager.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <cppconn/resultset.h>
@@ -37,7 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <glog/logging.h>
 
 #include "Utils/Scheduler.h"
-#include "Utils/VariableTimeScheduler.h"
+#include "Utils/TickProfiler.h"
 #include "Utils/utils.h"
 
 #include "Common/ConfigManager.h"
@@ -70,6 +71,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ForageManager.h"
 #include "GroupManager.h"
 #include "GroupObject.h"
+#include "HamRegenerator.h"
 #include "HarvesterFactory.h"
 #include "HarvesterObject.h"
 #include "Heightmap.h"
@@ -78,14 +80,18 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "MissionObject.h"
 #include "NpcManager.h"
 #include "NPCObject.h"
+#include "ObjectControllerBatch.h"
 #include "ObjectFactory.h"
 #include "PlayerObject.h"
 #include "PlayerStructure.h"
 #include "QuadTree.h"
+#include "RegionTriggerGrid.h"
+#include "NavigationManager.h"
 #include "ResourceManager.h"
 #include "SchematicManager.h"
 #include "Shuttle.h"
 #include "TicketCollector.h"
+#include "TimedEffects.h"
 #include "TreasuryManager.h"
 #include "WorldConfig.h"
 #include "ZoneOpcodes.h"
@@ -121,23 +127,55 @@ WorldManager::WorldManager(uint32 zoneId,ZoneServer* zoneServer,Database* databa
                         2,
                         gConfig->read<float>("Horizon"));
 
+    mRegionTriggers = new RegionTriggerGrid();
+
+    // path searches of all npc's share one budget per npc tick
+    uint32 navigationBudget = 20000;
+    if (gConfig->keyExists("NavigationSearchBudget"))
+        navigationBudget = static_cast<uint32>(gConfig->read<int>("NavigationSearchBudget"));
+
+    // searches deferred this often fall back to the straight line
+    uint32 navigationDeferrals = 3;
+    if (gConfig->keyExists("NavigationSearchRetries"))
+        navigationDeferrals = static_cast<uint32>(gConfig->read<int>("NavigationSearchRetries"));
+
+    mNavigation = new NavigationManager(navigationBudget, navigationDeferrals);
 
     // load planet names and terrain files so we can start heightmap loading
     _loadPlanetNamesAndFiles();
 
     // create schedulers
     mSubsystemScheduler		= new Anh_Utils::Scheduler();
-    mObjControllerScheduler = new Anh_Utils::Scheduler();
+    mObjControllerBatch		= new ObjectControllerBatch(125,100);
     mHamRegenScheduler		= new Anh_Utils::Scheduler();
     mStomachFillingScheduler= new Anh_Utils::Scheduler();
     mPlayerScheduler		= new Anh_Utils::Scheduler();
     mEntertainerScheduler	= new Anh_Utils::Scheduler();
     //mImagedesignerScheduler	= new Anh_Utils::Scheduler();
-    mBuffScheduler			= new Anh_Utils::VariableTimeScheduler(100, 100);
+    mBuffEffects			= new TimedEffects(100, 100);
     mMissionScheduler		= new Anh_Utils::Scheduler();
     mNpcManagerScheduler	= new Anh_Utils::Scheduler();
     mAdminScheduler			= new Anh_Utils::Scheduler();
 
+    // time every scheduler and its tasks per tick
+    if(gTickProfiler)
+    {
+        mSubsystemScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/subsystem"));
+        mObjControllerBatch->setProfileSection(gTickProfiler->registerSection("scheduler/objController"));
+        mHamRegenScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/hamRegen"));
+        mStomachFillingScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/stomachFilling"));
+        mPlayerScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/player"));
+        mEntertainerScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/entertainer"));
+        mBuffEffects->setProfileSection(gTickProfiler->registerSection("scheduler/buff"));
+        mMissionScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/mission"));
+        mNpcManagerScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/npcManager"));
+        mAdminScheduler->setProfileSection(gTickProfiler->registerSection("scheduler/admin"));
+    }
+
+    // all regenerating hams are handled by a single task
+    mHamRegenerator = new HamRegenerator();
+    mHamRegenScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleHamRegen),1,1000,NULL);
+
     LoadCurrentGlobalTick();
 
     // load up subsystems
@@ -226,14 +264,15 @@ void WorldManager::Shutdown()
     // timers
     delete(mAdminScheduler);
     delete(mNpcManagerScheduler);
-    delete(mObjControllerScheduler);
+    delete(mObjControllerBatch);
     delete(mStomachFillingScheduler);
     delete(mHamRegenScheduler);
+    delete(mHamRegenerator);
     delete(mMissionScheduler);
     delete(mPlayerScheduler);
     //delete(mImagedesignerScheduler);
     delete(mEntertainerScheduler);
-    delete(mBuffScheduler);
+    delete(mBuffEffects);
 
 
 
@@ -297,22 +336,22 @@ void WorldManager::Shutdown()
     ObjectIDList::iterator itStruct = mStructureList.begin();
     while(itStruct != mStructureList.end())
     {
-        ObjectMap::iterator objMapIt = mObjectMap.find(*itStruct);
-
-        if(objMapIt != mObjectMap.end())
-        {
-            mObjectMap.erase(objMapIt);
-        }
+        mObjectRegistry.erase(*itStruct);
         itStruct++;
     }
 
+    // drop the region triggers before the regions go away
+    mActiveRegions.clear();
+    delete(mRegionTriggers);
+    delete(mNavigation);
+
     // shutdown SI
     mSpatialIndex->ShutDown();
     delete(mSpatialIndex);
 
     // finally delete them
     mQTRegionMap.clear();
-    mObjectMap.clear();
+    mObjectRegistry.clear();
 
 
 
@@ -333,7 +372,7 @@ void WorldManager::handleObjectReady(Object* object,DispatchClient* client)
     addObject(object);
 
     // check if we done loading
-    if ((mState == WMState_StartUp) && (mObjectMap.size() + mQTRegionMap.size() + mCreatureSpawnRegionMap.size() >= mTotalObjectCount))
+    if ((mState == WMState_StartUp) && (mObjectRegistry.size() + mQTRegionMap.size() + mCreatureSpawnRegionMap.size() >= mTotalObjectCount))
     {
         _handleLoadComplete();
     }
@@ -411,24 +450,6 @@ bool	WorldManager::_handleTick(uint64 callTime,void* ref)
     return true;
 }
 
-//======================================================================================================================
-//
-//
-
-Object*	WorldManager::getObjectById(uint64 objId)
-{
-    ObjectMap::iterator it = mObjectMap.find(objId);
-
-    if(it != mObjectMap.end())
-    {
-        return((*it).second);
-    }
-
-    return(NULL);
-}
-
-
-
 //======================================================================================================================
 
 void WorldManager::Process()
@@ -443,16 +464,47 @@ void WorldManager::_processSchedulers()
     mHamRegenScheduler->process();
     mStomachFillingScheduler->process();
     mSubsystemScheduler->process();
-    mObjControllerScheduler->process();
+    mObjControllerBatch->process();
     //mImagedesignerScheduler->process();
     mPlayerScheduler->process();
     mEntertainerScheduler->process();
-    mBuffScheduler->process();
+    mBuffEffects->process();
     mMissionScheduler->process();
     mNpcManagerScheduler->process();
     mAdminScheduler->process();
 }
 
+//======================================================================================================================
+//
+// earliest time any of our schedulers has work to do, 0 if there are tasks ready to run right now
+//
+
+uint64 WorldManager::getNextDeadline() const
+{
+    uint64 deadlines[] =
+    {
+        mHamRegenScheduler->getNextDeadline(),
+        mStomachFillingScheduler->getNextDeadline(),
+        mSubsystemScheduler->getNextDeadline(),
+        mObjControllerBatch->getNextDeadline(),
+        mPlayerScheduler->getNextDeadline(),
+        mEntertainerScheduler->getNextDeadline(),
+        mBuffEffects->getNextDeadline(),
+        mMissionScheduler->getNextDeadline(),
+        mNpcManagerScheduler->getNextDeadline(),
+        mAdminScheduler->getNextDeadline()
+    };
+
+    uint64 next = Anh_Utils::TimingWheel::kNever;
+
+    for(uint32 i = 0; i < sizeof(deadlines) / sizeof(deadlines[0]); i++)
+    {
+        next = std::min(next, deadlines[i]);
+    }
+
+    return next;
+}
+
 //======================================================================================================================
 
 bool WorldManager::_handleDisconnectUpdate(uint64 callTime,void* ref)
@@ -932,6 +984,7 @@ void WorldManager::_handleLoadComplete()
     mNpcManagerScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleDormantNpcs),5,2500,NULL);
     mNpcManagerScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleReadyNpcs),5,1000,NULL);
     mNpcManagerScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleActiveNpcs),5,250,NULL);
+    mNpcManagerScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleNavigationBudget),5,250,NULL);
 
     // Initialize static creature lairs.
     mAdminScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleAdminRequests),5,5000,NULL);
@@ -939,6 +992,14 @@ void WorldManager::_handleLoadComplete()
 
 //======================================================================================================================
 
+void WorldManager::addActiveRegion(shared_ptr<RegionObject> regionObject)
+{
+    mActiveRegions.push_back(regionObject);
+    mRegionTriggers->addRegion(regionObject);
+}
+
+//======================================================================================================================
+
 void WorldManager::removeActiveRegion(shared_ptr<RegionObject> regionObject)
 {
     ActiveRegions::iterator it = mActiveRegions.begin();
@@ -948,6 +1009,7 @@ void WorldManager::removeActiveRegion(shared_ptr<RegionObject> regionObject)
         if(*it == regionObject)
         {
             mActiveRegions.erase(it);
+            mRegionTriggers->removeRegion(regionObject);
             break;
         }
 
@@ -957,6 +1019,11 @@ void WorldManager::removeActiveRegion(shared_ptr<RegionObject> regionObject)
 
 //======================================================================================================================
 
+//
+// enter / leave is driven by the region triggers on position updates,
+// this only ticks regions with timed behaviour of their own (camps)
+//
+
 bool WorldManager::_handleRegionUpdate(uint64 callTime,void* ref)
 {
     ActiveRegions::iterator it = mActiveRegions.begin();
@@ -968,14 +1035,13 @@ bool WorldManager::_handleRegionUpdate(uint64 callTime,void* ref)
     }
 
     //now delete any camp regions that are due
-    //RegionDeleteList::iterator itR = mRegionDeleteList.begin();
+    RegionDeleteList::iterator itR = mRegionDeleteList.begin();
 
-    //while(itR != mRegionDeleteList.end())
-    //{
-    //    removeActiveRegion((*itR));
-    //    //now remove region entries
-    //    itR++;
-    //}
+    while(itR != mRegionDeleteList.end())
+    {
+        removeActiveRegion((*itR));
+        itR++;
+    }
 
     mRegionDeleteList.clear();
     return(true);
@@ -1069,7 +1135,7 @@ bool WorldManager::checkStomachTask(uint64 id)
 //
 uint64 WorldManager::addCreatureHamToProccess(Ham* ham)
 {
-    return((mHamRegenScheduler->addTask(fastdelegate::MakeDelegate(ham,&Ham::regenerate),1,1000,NULL)));
+    return(mHamRegenerator->add(ham));
 }
 
 
@@ -1080,7 +1146,7 @@ uint64 WorldManager::addCreatureHamToProccess(Ham* ham)
 
 void WorldManager::removeCreatureHamToProcess(uint64 taskId)
 {
-    mHamRegenScheduler->removeTask(taskId);
+    mHamRegenerator->remove(taskId);
 }
 
 
@@ -1088,7 +1154,15 @@ void WorldManager::removeCreatureHamToProcess(uint64 taskId)
 
 bool WorldManager::checkTask(uint64 id)
 {
-    return mHamRegenScheduler->checkTask(id);
+    return mHamRegenerator->contains(id);
+}
+
+//======================================================================================================================
+
+bool WorldManager::_handleHamRegen(uint64 callTime,void* ref)
+{
+    mHamRegenerator->process();
+    return(true);
 }
 
 
@@ -1114,7 +1188,7 @@ uint64 WorldManager::addObjControllerToProcess(ObjectController* objController)
         if ((player->getConnectionState() == PlayerConnState_LinkDead) || (player->getConnectionState() == PlayerConnState_Destroying))
             return 0;
     }
-    return((mObjControllerScheduler->addTask(fastdelegate::MakeDelegate(objController,&ObjectController::process),1,125,NULL)));
+    return(mObjControllerBatch->add(objController));
 }
 
 
@@ -1125,7 +1199,7 @@ uint64 WorldManager::addObjControllerToProcess(ObjectController* objController)
 
 void WorldManager::removeObjControllerToProcess(uint64 taskId)
 {
-    mObjControllerScheduler->removeTask(taskId);
+    mObjControllerBatch->remove(taskId);
 }
 
 
@@ -1173,7 +1247,7 @@ bool WorldManager::existObject(Object* object)
 {
     if (object)
     {
-        return (mObjectMap.find(object->getId()) != mObjectMap.end());
+        return mObjectRegistry.contains(object->getId());
     }
     else
     {
@@ -1318,23 +1392,28 @@ bool WorldManager::addNpId(uint64 id)
 
 void WorldManager::removeBuffToProcess(uint64 taskId)
 {
-    mBuffScheduler->removeTask(taskId);
+    mBuffEffects->remove(taskId);
 }
 
+//======================================================================================================================
+//
+// remove all Buffs ticking on a creature
+//
+
+void WorldManager::removeBuffsToProcess(uint64 creatureId)
+{
+    mBuffEffects->removeOwner(creatureId);
+}
+
+//======================================================================================================================
+
 uint64 WorldManager::addBuffToProcess(Buff* buff)
 {
     //Create a copy of Buff* which can be Destructed when task completes (leaving the original ptr intact)
-    //Buff** pBuff = &buff;
     Buff* DestructibleBuff = new Buff(*buff);
 
-    //Create Event
-    //BuffEvent* bEvent = new BuffEvent(buff);
-
-    //Create Callback
-    VariableTimeCallback callback = fastdelegate::MakeDelegate(DestructibleBuff,&Buff::Update);
-
-    //Add Callback to Scheduler
-    uint64 temp = mBuffScheduler->addTask(callback,1,buff->GetTickLength(),NULL);
+    //Add it to the timed effects, keyed by the creature it ticks on
+    uint64 temp = mBuffEffects->addBuff(DestructibleBuff,buff->GetTickLength());
 
     //Give Buff the ID from Scheduler
     buff->SetID(temp);
@@ -33,7 +33,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <unordered_map>
 #include <vector>
 
-#include <boost/ptr_container/ptr_unordered_map.hpp>
 
 #include "Utils/TimerCallback.h"
 #include "Utils/typedefs.h"
@@ -44,7 +43,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "ScriptEngine/ScriptEventListener.h"
 
+#include "ZoneServer/NpcHandlerQueue.h"
 #include "ZoneServer/ObjectFactoryCallback.h"
+#include "ZoneServer/ObjectRegistry.h"
 #include "ZoneServer/QTRegion.h"
 #include "ZoneServer/TangibleEnums.h"
 #include "ZoneServer/Weather.h"
@@ -57,6 +58,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 //======================================================================================================================
 
 class DispatchClient;
+class RegionTriggerGrid;
+class NavigationManager;
 class WMAsyncContainer;
 class Script;
 class NPCObject;
@@ -66,6 +69,9 @@ class NpcConversionTime;
 class CharacterLoadingContainer;
 class ZoneServer;
 class Ham;
+class HamRegenerator;
+class TimedEffects;
+class ObjectControllerBatch;
 class Buff;
 class MissionObject;
 class Stomach;
@@ -76,11 +82,9 @@ namespace Anh_Utils
 {
 class Clock;
 class Scheduler;
-class VariableTimeScheduler;
 }
 
 // pwns all objects
-typedef boost::ptr_unordered_map<uint64,Object>			ObjectMap;
 
 // seperate map for qt regions, since ids may match object ids
 typedef std::unordered_map<uint32,std::shared_ptr<QTRegion>>	QTRegionMap;
@@ -106,13 +110,10 @@ typedef std::vector<uint64>						CraftTools;
 // Creature spawn regions.
 typedef std::map<uint64, const std::shared_ptr<CreatureSpawnRegion>>	CreatureSpawnRegionMap;
 
-// Containers with handlers to Npc-objects handled by the NpcManager (or what we are going to call it its final version).
-// The active container will be the most often checked, and the Dormant the less checked container.
+// Handlers to Npc-objects handled by the NpcManager (or what we are going to call it its final version) are kept
+// in NpcHandlerQueue's, one per lane. The active lane will be the most often checked, and the Dormant the less checked one.
 
 // And yes. Handlers... handlers... no object refs that will be invalid all the time.
-typedef std::map<uint64, uint64>				NpcDormantHandlers;
-typedef std::map<uint64, uint64>				NpcReadyHandlers;
-typedef std::map<uint64, uint64>				NpcActiveHandlers;
 typedef std::map<uint64, uint64>				AdminRequestHandlers;
 
 // AttributeKey map
@@ -176,6 +177,9 @@ public:
 
     void					Process();
 
+    // earliest scheduler deadline (local time), used by the main loop to know how long it may sleep
+    uint64					getNextDeadline() const;
+
     uint32					getZoneId() {
         return mZoneId;
     }
@@ -213,7 +217,13 @@ public:
     void					createObjectForKnownPlayers(PlayerObjectSet* knownPlayers, Object* object);
     void					createObjectinWorld(PlayerObject* player, Object* object);
     void					createObjectinWorld(Object* object);
-    Object*					getObjectById(uint64 objId);
+    Object*					getObjectById(uint64 objId) {
+        return mObjectRegistry.find(objId);
+    }
+    // O(1), NULL once the object has been destroyed
+    Object*					getObjectByHandle(ObjectHandle handle) {
+        return mObjectRegistry.resolve(handle);
+    }
     void					eraseObject(uint64 key);
 
     // Find object owned by "player"
@@ -253,6 +263,8 @@ public:
     // adds a Buff which Ticks
     uint64					addBuffToProcess(Buff* buff);
     void					removeBuffToProcess(uint64 taskId);
+    // drops every ticking buff on the creature in one go
+    void					removeBuffsToProcess(uint64 creatureId);
 
     // adds a save process
     uint64					getSaveTaskId() {
@@ -327,14 +339,18 @@ public:
     void					addActiveNpc(uint64 creature, uint64 when);
     void					removeActiveNpc(uint64 creature);
 
+    // per pass averages of the npc lanes since the last reset
+    void					printNpcQueueStats(std::ostream& out);
+    void					resetNpcQueueStats();
+
     void					addAdminRequest(uint64 requestId, uint64 when);
     void					cancelAdminRequest(int32 requestId);
 
     const					Anh_Math::Rectangle getSpawnArea(uint64 spawnRegionId);
 
     // retrieve object maps
-    ObjectMap*				getWorldObjectMap() {
-        return &mObjectMap;
+    ObjectRegistry*			getObjectRegistry() {
+        return &mObjectRegistry;
     }
     const PlayerAccMap*		getPlayerAccMap() {
         return &mPlayerAccMap;
@@ -351,6 +367,16 @@ public:
         return mSpatialIndex;
     }
 
+    // trigger volumes of the active regions, feed position updates in here
+    RegionTriggerGrid*		getRegionTriggers() {
+        return mRegionTriggers;
+    }
+
+    // npc pathfinding over the outdoor grid
+    NavigationManager*		getNavigation() {
+        return mNavigation;
+    }
+
     // removes player from the current scene, and starts a new one after updating his position
     void					warpPlanet(PlayerObject* playerObject, const glm::vec3& destination,uint64 parentId, const glm::quat& direction = glm::quat());
 
@@ -420,9 +446,7 @@ public:
         return mRegionMap;
     }
     //
-    void					addActiveRegion(std::shared_ptr<RegionObject> regionObject) {
-        mActiveRegions.push_back(regionObject);
-    }
+    void					addActiveRegion(std::shared_ptr<RegionObject> regionObject);
     void					removeActiveRegion(std::shared_ptr<RegionObject> regionObject);
     std::shared_ptr<QTRegion>	getQTRegion(uint32 id);
 
@@ -457,6 +481,9 @@ public:
     void					LoadCurrentGlobalTick();
 
     bool					_handleTick(uint64 callTime,void* ref);
+
+    // one regeneration pass over all hams below max
+    bool					_handleHamRegen(uint64 callTime,void* ref);
     
 
     void					removePlayerMovementUpdateTime(PlayerObject* player);
@@ -502,6 +529,10 @@ private:
     bool	_handleDormantNpcs(uint64 callTime, void* ref);
     bool	_handleReadyNpcs(uint64 callTime, void* ref);
     bool	_handleActiveNpcs(uint64 callTime, void* ref);
+    bool	_handleNavigationBudget(uint64 callTime, void* ref);
+
+    // runs one ai pass over the due npc's of a handler queue
+    void	_handleNpcQueue(NpcHandlerQueue& handlers, uint64 callTime);
 
     bool	_handleAdminRequests(uint64 callTime, void* ref);
 
@@ -556,11 +587,13 @@ private:
     AdminRequestHandlers		mAdminRequestHandlers;
     CreatureObjectDeletionMap	mCreatureObjectDeletionMap;
     CreatureSpawnRegionMap		mCreatureSpawnRegionMap;
-    NpcActiveHandlers			mNpcActiveHandlers;
-    NpcDormantHandlers			mNpcDormantHandlers;
-    NpcReadyHandlers			mNpcReadyHandlers;
+    NpcHandlerQueue				mNpcActiveHandlers;
+    NpcHandlerQueue				mNpcDormantHandlers;
+    NpcHandlerQueue				mNpcReadyHandlers;
+    std::vector<uint64>			mNpcPassIds;
+    std::vector<NPCObject*>		mNpcPassNpcs;
     ObjectIDList			    mStructureList;
-    ObjectMap					mObjectMap;
+    ObjectRegistry				mObjectRegistry;
     PlayerAccMap				mPlayerAccMap;
     PlayerMovementUpdateMap		mPlayerMovementUpdateMap;
     PlayerObjectReviveMap		mPlayerObjectReviveMap;
@@ -585,17 +618,20 @@ private:
     Weather						mCurrentWeather;
     ScriptEventListener			mWorldScriptsListener;
     Anh_Utils::Scheduler*		mAdminScheduler;
-    Anh_Utils::VariableTimeScheduler* mBuffScheduler;
+    TimedEffects*							mBuffEffects;
     Database*								mDatabase;
     Anh_Utils::Scheduler*		mEntertainerScheduler;
     Anh_Utils::Scheduler*		mScoutScheduler;
     Anh_Utils::Scheduler*		mHamRegenScheduler;
+    HamRegenerator*							mHamRegenerator;
     Anh_Utils::Scheduler*		mStomachFillingScheduler;
     Anh_Utils::Scheduler*		mMissionScheduler;
     Anh_Utils::Scheduler*		mNpcManagerScheduler;
-    Anh_Utils::Scheduler*		mObjControllerScheduler;
+    ObjectControllerBatch*					mObjControllerBatch;
     Anh_Utils::Scheduler*		mPlayerScheduler;
     ZoneTree*								mSpatialIndex;
+    RegionTriggerGrid*						mRegionTriggers;
+    NavigationManager*						mNavigation;
     Anh_Utils::Scheduler*		mSubsystemScheduler;
     ZoneServer*					mZoneServer;
     WMState						mState;
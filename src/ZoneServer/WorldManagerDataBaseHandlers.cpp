@@ -84,39 +84,59 @@ void WorldManager::_loadWorldObjects()
         }
         // load client effects
         int8 sql[128] ;
-        sprintf(sql, "SELECT * FROM clienteffects ORDER BY id;");
-        mDatabase->executeAsyncSql(sql, [=] (DatabaseResult* result) {
+        sprintf(sql, "SELECT effect FROM clienteffects ORDER BY id;");
+        mDatabase->executeStaticAsyncSql(sql, [=] (DatabaseResult* result) {
             if (! result) {
                 return;
             }
 
-            std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+            DataBinding* binding = mDatabase->createDataBinding(1);
+            binding->addField(DFT_bstring,0,128,0);
+
+            BString effect;
+            uint64 count = result->getRowCount();
 
             // tell vector how much space we need to stop unecessary allocation.
-            mvClientEffects.reserve(result_set->rowsCount());
-            while(result_set->next())
+            mvClientEffects.reserve(static_cast<uint32>(count));
+            for(uint64 i = 0; i < count; i++)
             {
-                mvClientEffects.push_back(result_set->getString("effect"));
+                result->getNextRow(binding,&effect);
+                mvClientEffects.push_back(effect.getAnsi());
             }
+
+            mDatabase->destroyDataBinding(binding);
             LOG_IF(INFO, mvClientEffects.size()) << "Loaded " << mvClientEffects.size() << " Client Effects";
         });
 
         // load attribute keys
         sql[0] = 0 ;
         sprintf(sql, "SELECT id, name FROM attributes ORDER BY id;");
-        mDatabase->executeAsyncSql(sql, [=] (DatabaseResult* result) {
+        mDatabase->executeStaticAsyncSql(sql, [=] (DatabaseResult* result) {
             if (! result) {
                 return;
             }
 
-            std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+            struct AttributeRow
+            {
+                uint32	mId;
+                BString	mName;
+            };
 
-            while(result_set->next())
+            DataBinding* binding = mDatabase->createDataBinding(2);
+            binding->addField(DFT_uint32,offsetof(AttributeRow,mId),4,0);
+            binding->addField(DFT_bstring,offsetof(AttributeRow,mName),64,1);
+
+            AttributeRow attribute;
+            uint64 count = result->getRowCount();
+
+            for(uint64 i = 0; i < count; i++)
             {
-                BString name = result_set->getString("name").c_str();
-                mObjectAttributeKeyMap.insert(std::make_pair(name.getCrc(), name));
-                mObjectAttributeIDMap.insert(std::make_pair(name.getCrc(), result_set->getInt("id")));
+                result->getNextRow(binding,&attribute);
+                mObjectAttributeKeyMap.insert(std::make_pair(attribute.mName.getCrc(), attribute.mName));
+                mObjectAttributeIDMap.insert(std::make_pair(attribute.mName.getCrc(), attribute.mId));
             }
+
+            mDatabase->destroyDataBinding(binding);
             LOG_IF(INFO, mObjectAttributeKeyMap.size()) << "Loaded " << mObjectAttributeKeyMap.size() << " Attributes";
         });
 
@@ -447,11 +467,11 @@ void    WorldManager::_loadPlanetNamesAndFiles()
         //start loading heightmap
         if(mZoneId != 41)
         {
-            int16 resolution = 0;
-            if (gConfig->keyExists("heightMapResolution"))
-                resolution = gConfig->read<int>("heightMapResolution");
+            bool useTiles = true;
+            if (gConfig->keyExists("heightMapTiles"))
+                useTiles = (gConfig->read<int>("heightMapTiles") != 0);
 
-            if (!Heightmap::Instance(resolution))
+            if (!Heightmap::Instance(useTiles))
                 assert(false && "WorldManager::_handleLoadComplete Missing heightmap, look for it on the forums.");
         }
     } ) ;
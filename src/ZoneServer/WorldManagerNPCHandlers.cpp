@@ -31,12 +31,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ConversationManager.h"
 #include "NpcManager.h"
 #include "NPCObject.h"
+#include "NavigationManager.h"
 #include "Inventory.h"
 #include "ScriptEngine/ScriptEngine.h"
 #include "ScriptEngine/ScriptSupport.h"
 #include "Utils/utils.h"
 #include "Utils/clock.h"
 
+#include <algorithm>
+
 
 //======================================================================================================================
 //
@@ -48,7 +51,7 @@ void WorldManager::addDormantNpc(uint64 creature, uint64 when)
     // gLogger->log(LogManager::DEBUG,"Adding dormant NPC handler... %"PRIu64"",  creature);
 
     uint64 expireTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-    mNpcDormantHandlers.insert(std::make_pair(creature, expireTime + when));
+    mNpcDormantHandlers.add(creature, expireTime + when);
 }
 
 //======================================================================================================================
@@ -58,12 +61,7 @@ void WorldManager::addDormantNpc(uint64 creature, uint64 when)
 
 void WorldManager::removeDormantNpc(uint64 creature)
 {
-    NpcDormantHandlers::iterator it = mNpcDormantHandlers.find(creature);
-    if (it != mNpcDormantHandlers.end())
-    {
-        // Remove creature.
-        mNpcDormantHandlers.erase(it);
-    }
+    mNpcDormantHandlers.remove(creature);
 }
 
 //======================================================================================================================
@@ -73,13 +71,9 @@ void WorldManager::removeDormantNpc(uint64 creature)
 
 void WorldManager::forceHandlingOfDormantNpc(uint64 creature)
 {
-    NpcDormantHandlers::iterator it = mNpcDormantHandlers.find(creature);
-    if (it != mNpcDormantHandlers.end())
-    {
-        // Change the event time to NOW.
-        uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
-        (*it).second = now;
-    }
+    // Change the event time to NOW.
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    mNpcDormantHandlers.reschedule(creature, now);
 }
 //======================================================================================================================
 //
@@ -88,44 +82,7 @@ void WorldManager::forceHandlingOfDormantNpc(uint64 creature)
 
 bool WorldManager::_handleDormantNpcs(uint64 callTime, void* ref)
 {
-    NpcDormantHandlers::iterator it = mNpcDormantHandlers.begin();
-    while (it != mNpcDormantHandlers.end())
-    {
-        //  The timer has expired?
-        if (callTime >= ((*it).second))
-        {
-            // Yes, handle it.
-            NPCObject* npc = dynamic_cast<NPCObject*>(this->getObjectById((*it).first));
-            if (npc)
-            {
-                // uint64 waitTime = NpcManager::Instance()->handleDormantNpc(creature, callTime - (*it).second);
-                // gLogger->log(LogManager::DEBUG,"Dormant... ID = %"PRIu64"",  (*it).first);
-                uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - (*it).second);
-
-                if (waitTime)
-                {
-                    // Set next execution time.
-                    (*it).second = callTime + waitTime;
-                }
-                else
-                {
-                    // gLogger->log(LogManager::DEBUG,"Removed dormant NPC handler... %"PRIu64"",  (*it).first);
-
-                    // Requested to remove the handler.
-                    mNpcDormantHandlers.erase(it++);
-                }
-            }
-            else
-            {
-                // Remove the expired object...
-                mNpcDormantHandlers.erase(it++);
-            }
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    _handleNpcQueue(mNpcDormantHandlers, callTime);
     return true;
 }
 
@@ -138,7 +95,7 @@ void WorldManager::addReadyNpc(uint64 creature, uint64 when)
 {
     uint64 expireTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
 
-    mNpcReadyHandlers.insert(std::make_pair(creature, expireTime + when));
+    mNpcReadyHandlers.add(creature, expireTime + when);
 }
 
 //======================================================================================================================
@@ -148,12 +105,7 @@ void WorldManager::addReadyNpc(uint64 creature, uint64 when)
 
 void WorldManager::removeReadyNpc(uint64 creature)
 {
-    NpcReadyHandlers::iterator it = mNpcReadyHandlers.find(creature);
-    if (it != mNpcReadyHandlers.end())
-    {
-        // Remove creature.
-        mNpcReadyHandlers.erase(it);
-    }
+    mNpcReadyHandlers.remove(creature);
 }
 
 //======================================================================================================================
@@ -163,13 +115,9 @@ void WorldManager::removeReadyNpc(uint64 creature)
 
 void WorldManager::forceHandlingOfReadyNpc(uint64 creature)
 {
-    NpcReadyHandlers::iterator it = mNpcReadyHandlers.find(creature);
-    if (it != mNpcReadyHandlers.end())
-    {
-        // Change the event time to NOW.
-        uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
-        (*it).second = now;
-    }
+    // Change the event time to NOW.
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    mNpcReadyHandlers.reschedule(creature, now);
 }
 
 //======================================================================================================================
@@ -179,44 +127,7 @@ void WorldManager::forceHandlingOfReadyNpc(uint64 creature)
 
 bool WorldManager::_handleReadyNpcs(uint64 callTime, void* ref)
 {
-    NpcReadyHandlers::iterator it = mNpcReadyHandlers.begin();
-    while (it != mNpcReadyHandlers.end())
-    {
-        //  The timer has expired?
-        if (callTime >= ((*it).second))
-        {
-            // Yes, handle it.
-            NPCObject* npc = dynamic_cast<NPCObject*>(this->getObjectById((*it).first));
-            if (npc)
-            {
-                // uint64 waitTime = NpcManager::Instance()->handleReadyNpc(creature, callTime - (*it).second);
-                // gLogger->log(LogManager::DEBUG,"Ready...");
-                // gLogger->log(LogManager::DEBUG,"Ready... ID = %"PRIu64"",  (*it).first);
-                uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - (*it).second);
-                if (waitTime)
-                {
-                    // Set next execution time.
-                    (*it).second = callTime + waitTime;
-                }
-                else
-                {
-                    // Requested to remove the handler.
-                    mNpcReadyHandlers.erase(it++);
-                    // gLogger->log(LogManager::DEBUG,"Removed ready NPC handler...");
-                }
-            }
-            else
-            {
-                // Remove the expired object...
-                mNpcReadyHandlers.erase(it++);
-                // gLogger->log(LogManager::DEBUG,"Removed ready NPC handler...");
-            }
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    _handleNpcQueue(mNpcReadyHandlers, callTime);
     return true;
 }
 
@@ -229,7 +140,7 @@ void WorldManager::addActiveNpc(uint64 creature, uint64 when)
 {
     uint64 expireTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
 
-    mNpcActiveHandlers.insert(std::make_pair(creature, expireTime + when));
+    mNpcActiveHandlers.add(creature, expireTime + when);
 }
 
 //======================================================================================================================
@@ -239,12 +150,7 @@ void WorldManager::addActiveNpc(uint64 creature, uint64 when)
 
 void WorldManager::removeActiveNpc(uint64 creature)
 {
-    NpcActiveHandlers::iterator it = mNpcActiveHandlers.find(creature);
-    if (it != mNpcActiveHandlers.end())
-    {
-        // Remove creature.
-        mNpcActiveHandlers.erase(it);
-    }
+    mNpcActiveHandlers.remove(creature);
 }
 
 //======================================================================================================================
@@ -253,44 +159,125 @@ void WorldManager::removeActiveNpc(uint64 creature)
 //
 bool WorldManager::_handleActiveNpcs(uint64 callTime, void* ref)
 {
-    NpcActiveHandlers::iterator it = mNpcActiveHandlers.begin();
-    while (it != mNpcActiveHandlers.end())
+    _handleNpcQueue(mNpcActiveHandlers, callTime);
+    return true;
+}
+
+//======================================================================================================================
+//
+// One ai pass over a handler queue.
+// Only the due npc's are popped from the queue. Their range checks are precomputed in parallel first, then they are
+// handled one at a time in id order, target selection included, so state changes and messages come out the same way
+// as before. Handlers can add or remove queue entries
+// of other npc's, hence every entry is looked up again before it is touched.
+//
+
+void WorldManager::_handleNpcQueue(NpcHandlerQueue& handlers, uint64 callTime)
+{
+    mNpcPassIds.clear();
+    mNpcPassNpcs.clear();
+
+    handlers.popDue(callTime, mNpcPassIds);
+
+    uint32 evaluated = mNpcPassIds.size();
+
+    std::sort(mNpcPassIds.begin(), mNpcPassIds.end());
+
+    uint32 kept = 0;
+    for (uint32 i = 0; i < mNpcPassIds.size(); ++i)
     {
-        //  The timer has expired?
-        if (callTime >= ((*it).second))
+        NPCObject* npc = mObjectRegistry.findNpc(mNpcPassIds[i]);
+        if (npc)
         {
-            // Yes, handle it.
-            NPCObject* npc = dynamic_cast<NPCObject*>(this->getObjectById((*it).first));
-            if (npc)
-            {
-                // uint64 waitTime = NpcManager::Instance()->handleActiveNpc(creature, callTime - (*it).second);
-                // gLogger->log(LogManager::DEBUG,"Active...");
-                // gLogger->log(LogManager::DEBUG,"Active... ID = %"PRIu64"",  (*it).first);
-                uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - (*it).second);
-                if (waitTime)
-                {
-                    // Set next execution time.
-                    (*it).second = callTime + waitTime;
-                }
-                else
-                {
-                    // Requested to remove the handler.
-                    mNpcActiveHandlers.erase(it++);
-                    // gLogger->log(LogManager::DEBUG,"Removed active NPC handler...");
-                }
-            }
-            else
-            {
-                // Remove the expired object...
-                mNpcActiveHandlers.erase(it++);
-                // gLogger->log(LogManager::DEBUG,"Removed active NPC handler...");
-            }
+            mNpcPassIds[kept++] = mNpcPassIds[i];
+            mNpcPassNpcs.push_back(npc);
         }
         else
         {
-            ++it;
+            // Remove the expired object...
+            handlers.remove(mNpcPassIds[i]);
+        }
+    }
+    mNpcPassIds.resize(kept);
+
+    handlers.recordPass(evaluated, mNpcPassIds.size());
+
+    if (mNpcPassIds.empty())
+    {
+        return;
+    }
+
+    NpcManager::Instance()->precomputeNpcRanges(mNpcPassNpcs);
+
+    for (uint32 i = 0; i < mNpcPassIds.size(); ++i)
+    {
+        uint64 npcId = mNpcPassIds[i];
+
+        uint64 due = handlers.getDue(npcId);
+        if (due == Anh_Utils::TimingWheel::kNever)
+        {
+            continue;
+        }
+
+        // May have been destroyed by an npc handled before.
+        NPCObject* npc = mObjectRegistry.findNpc(npcId);
+        if (!npc)
+        {
+            handlers.remove(npcId);
+            continue;
+        }
+
+        uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - due);
+
+        if (!handlers.contains(npcId))
+        {
+            continue;
+        }
+
+        if (waitTime)
+        {
+            // Set next execution time.
+            handlers.reschedule(npcId, callTime + waitTime);
+        }
+        else
+        {
+            // Requested to remove the handler.
+            handlers.remove(npcId);
         }
     }
+
+    NpcManager::Instance()->flushMoves();
+}
+
+//======================================================================================================================
+//
+// Dump how much work the npc lanes did per pass.
+//
+
+void WorldManager::printNpcQueueStats(std::ostream& out)
+{
+    mNpcActiveHandlers.printStats(out, "npc/active");
+    mNpcReadyHandlers.printStats(out, "npc/ready");
+    mNpcDormantHandlers.printStats(out, "npc/dormant");
+}
+
+//======================================================================================================================
+
+void WorldManager::resetNpcQueueStats()
+{
+    mNpcActiveHandlers.resetStats();
+    mNpcReadyHandlers.resetStats();
+    mNpcDormantHandlers.resetStats();
+}
+
+//======================================================================================================================
+//
+// Refill the path search budget of the npc's.
+//
+
+bool WorldManager::_handleNavigationBudget(uint64 callTime, void* ref)
+{
+    mNavigation->resetBudget();
     return true;
 }
 
@@ -70,11 +70,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "NPCObject.h"
 #include "ObjectFactory.h"
 #include "PlayerStructure.h"
+#include "NavigationManager.h"
 #include "QuadTree.h"
+#include "RegionTriggerGrid.h"
 #include "ResourceManager.h"
 #include "SchematicManager.h"
 #include "Shuttle.h"
 #include "SpawnPoint.h"
+#include "StructureManager.h"
 #include "Terminal.h"
 #include "TicketCollector.h"
 #include "TreasuryManager.h"
@@ -93,17 +96,16 @@ using std::shared_ptr;
 // This function is not used yet.
 uint64 WorldManager::getObjectOwnedBy(uint64 theOwner)
 {
-    ObjectMap::iterator it = mObjectMap.begin();
     uint64 ownerId = 0;
 
-    while (it != mObjectMap.end())
+    for (uint32 slot = 0; slot < mObjectRegistry.getSlotCount(); slot++)
     {
-        if ( ((*it).second)->getPrivateOwner() == theOwner)
+        Object* object = mObjectRegistry.getSlotObject(slot);
+        if (object && object->getPrivateOwner() == theOwner)
         {
-            ownerId = (*it).first;
+            ownerId = object->getId();
             break;
         }
-        it++;
     }
     return ownerId;
 }
@@ -125,7 +127,7 @@ bool WorldManager::addObject(Object* object,bool manual)
         return false;
     }
 
-    mObjectMap.insert(key,object);
+    mObjectRegistry.insert(object);
 
     // if we want to set the parent manually or the object is from the snapshots and not a building, return
     if(manual)
@@ -200,6 +202,9 @@ bool WorldManager::addObject(Object* object,bool manual)
         initObjectsInRange(player);
         gMessageLib->sendCreatePlayer(player,player);
 
+        // check the region triggers at our spawn position
+        mRegionTriggers->updateObject(player);
+
         // add ham to regeneration scheduler
         player->getHam()->updateRegenRates();	// ERU: Note sure if this is needed here.
         player->getHam()->checkForRegen();
@@ -218,9 +223,15 @@ bool WorldManager::addObject(Object* object,bool manual)
 
     case ObjType_Structure:
     {
-        //	HarvesterObject* harvester = dynamic_cast<HarvesterObject*>(object);
         mStructureList.push_back(object->getId());
+
+        //structures get settled by the structure manager
+        if(gStructureManager)
+        {
+            gStructureManager->addStructure(dynamic_cast<PlayerStructure*>(object));
+        }
         mSpatialIndex->InsertPoint(key,object->mPosition.x,object->mPosition.z);
+        mNavigation->addStructure(object);
 
     }
     break;
@@ -231,6 +242,13 @@ bool WorldManager::addObject(Object* object,bool manual)
         BuildingObject* building = dynamic_cast<BuildingObject*>(object);
 
         mSpatialIndex->InsertRegion(key,building->mPosition.x,building->mPosition.z,building->getWidth(),building->getHeight());
+        mNavigation->addStructure(object);
+
+        //player houses get settled by the structure manager
+        if(gStructureManager)
+        {
+            gStructureManager->addStructure(building);
+        }
     }
     break;
 
@@ -348,7 +366,8 @@ bool WorldManager::addObject(std::shared_ptr<Object> object, bool manual)
 {
     uint64 key = object->getId();
 
-    mObjectMap.insert(key,object.get());
+    // the shared pointers own it, the registry only indexes it
+    mObjectRegistry.insert(object.get(), false);
 
     auto region = dynamic_pointer_cast<RegionObject>(object);
 
@@ -356,6 +375,9 @@ bool WorldManager::addObject(std::shared_ptr<Object> object, bool manual)
 
     mSpatialIndex->InsertRegion(key,region->mPosition.x,region->mPosition.z,region->getWidth(),region->getHeight());
 
+    if(region->getActive())
+        addActiveRegion(region);
+
     return true;
 }
 
@@ -546,22 +568,7 @@ void WorldManager::destroyObject(Object* object)
         removePlayerfromAccountMap(player->getId());
 
         // remove us from active regions we are in
-        ObjectSet regions;
-        getSI()->getObjectsInRange(player,&regions,ObjType_Region,20);
-
-        ObjectSet::iterator objListIt = regions.begin();
-
-        while(objListIt != regions.end())
-        {
-            RegionObject* region = dynamic_cast<RegionObject*>(*objListIt);
-
-            if(region->getActive())
-            {
-                region->onObjectLeave(player);
-            }
-
-            ++objListIt;
-        }
+        mRegionTriggers->removeObject(player);
 
         // remove any timers we got running
         gWorldManager->removeObjControllerToProcess(player->getController()->getTaskId());
@@ -662,6 +669,12 @@ void WorldManager::destroyObject(Object* object)
         // remove any timers we got running
         removeCreatureHamToProcess(creature->getHam()->getTaskId());
 
+        // a step of this pass is not in the SI yet
+        if (NPCObject* npc = dynamic_cast<NPCObject*>(object))
+        {
+            NpcManager::Instance()->dropMove(npc);
+        }
+
         // remove from cell / SI
         if (!object->getParentId())
         {
@@ -732,7 +745,13 @@ void WorldManager::destroyObject(Object* object)
         }
 
         object->destroyKnownObjects();
+        mNavigation->removeStructure(object);
+
 
+        if(gStructureManager)
+        {
+            gStructureManager->removeStructure(object->getId());
+        }
 
         //remove it out of the worldmanagers structurelist now that it is deleted
         ObjectIDList::iterator itStruct = mStructureList.begin();
@@ -766,6 +785,12 @@ void WorldManager::destroyObject(Object* object)
                 //mSpatialIndex->InsertRegion(key,building->mPosition.x,building->mPosition.z,building->getWidth(),building->getHeight());
                 mSpatialIndex->RemoveRegion(object->getId(),object->mPosition.x-building->getWidth(),object->mPosition.z-building->getHeight(),object->mPosition.x+building->getWidth(),object->mPosition.z+building->getHeight());
             }
+            mNavigation->removeStructure(object);
+
+            if(gStructureManager)
+            {
+                gStructureManager->removeStructure(object->getId());
+            }
 
             //remove it out of the worldmanagers structurelist now that it is deleted
             ObjectIDList::iterator itStruct = mStructureList.begin();
@@ -837,6 +862,7 @@ void WorldManager::destroyObject(Object* object)
 
         if(it != mRegionMap.end())
         {
+            removeActiveRegion(it->second);
             mRegionMap.erase(it);
         }
         else
@@ -883,15 +909,11 @@ void WorldManager::destroyObject(Object* object)
 
     object->destroyKnownObjects();
 
+    // nobody is left to send its pending deltas to
+    gMessageLib->forgetDeltas(object->getId());
 
     // finally delete it
-    ObjectMap::iterator objMapIt = mObjectMap.find(object->getId());
-
-    if(objMapIt != mObjectMap.end())
-    {
-        mObjectMap.erase(objMapIt);
-    }
-    else
+    if(!mObjectRegistry.erase(object->getId()))
     {
         LOG(WARNING) << "WorldManager::destroyObject: error removing from objectmap: " << object->getId();
     }
@@ -913,13 +935,7 @@ void WorldManager::eraseObject(uint64 key)
 {
 
     // finally delete it
-    ObjectMap::iterator objMapIt = mObjectMap.find(key);
-
-    if(objMapIt != mObjectMap.end())
-    {
-        mObjectMap.erase(objMapIt);
-    }
-    else
+    if(!mObjectRegistry.erase(key))
     {
         DLOG(INFO) << "WorldManager::destroyObject: error removing from objectmap: " << key;
     }
@@ -79,10 +79,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Common/ConfigManager.h"
 #include "Utils/utils.h"
 #include "Utils/clock.h"
+#include "Utils/EventLoop.h"
 #include "Utils/Singleton.h"
+#include "Utils/TickProfiler.h"
 
 #include "ZoneServer/HamService.h"
 
+#include <algorithm>
+#include <sstream>
+
 #include <boost/thread/thread.hpp>
 
 using utils::Singleton;
@@ -102,6 +107,7 @@ ZoneServer* gZoneServer = NULL;
 ZoneServer::ZoneServer(int8* zoneName)
     : mZoneName(zoneName)
     , mLastHeartbeat(0)
+    , mMaxIdleTime(20)
     , mNetworkManager(0)
     , mDatabaseManager(0)
     , mRouterService(0)
@@ -109,6 +115,36 @@ ZoneServer::ZoneServer(int8* zoneName)
     , ham_service_(nullptr)
 {
     Anh_Utils::Clock::Init();
+    Anh_Utils::EventLoop::Init();
+
+    // upper bound for a main loop sleep, WaitFrame scripts and polled services only run once per tick
+    if(gConfig->keyExists("MainLoopMaxWait"))
+        mMaxIdleTime = gConfig->read<uint32>("MainLoopMaxWait");
+
+    // ticks taking longer than this (ms) get logged with their breakdown
+    uint32 slowTickThreshold = 50;
+    if(gConfig->keyExists("SlowTickThreshold"))
+        slowTickThreshold = gConfig->read<uint32>("SlowTickThreshold");
+
+    Anh_Utils::TickProfiler::Init(slowTickThreshold * 1000);
+
+    const char* tickPhases[ZoneTickPhase_Count] =
+    {
+        "zone/objectController",
+        "zone/world",
+        "zone/script",
+        "zone/messageDispatch",
+        "zone/events",
+        "zone/deltas",
+        "zone/router",
+        "zone/database",
+        "zone/network"
+    };
+
+    for(uint32 i = 0; i < ZoneTickPhase_Count; i++)
+    {
+        mTickPhases[i] = gTickProfiler->registerSection(tickPhases[i]);
+    }
 
     LOG(INFO) << "ZoneServer startup sequence for [" << zoneName << "]";
 
@@ -125,6 +161,17 @@ ZoneServer::ZoneServer(int8* zoneName)
                                           (int8*)(gConfig->read<std::string>("DBPass")).c_str(),
                                           (int8*)(gConfig->read<std::string>("DBName")).c_str());
 
+    // static game data (skills, schematics, conversations, ...) is shared by all zones on this host
+    // through a read only image, tables changed in the db since it was written are loaded again
+    std::string staticDataImage = "staticdata.img";
+    bool staticDataRebuild = false;
+    if(gConfig->keyExists("StaticDataImage"))
+        staticDataImage = gConfig->read<std::string>("StaticDataImage");
+    if(gConfig->keyExists("StaticDataRebuild"))
+        staticDataRebuild = gConfig->read<bool>("StaticDataRebuild");
+
+    mDatabase->openStaticDataImage(staticDataImage,staticDataRebuild);
+
     // increase the server start that will help us to organize our logs to the corresponding serverstarts (mostly for errors)
     mDatabase->executeProcedureAsync(0, 0, "CALL sp_ServerStatusUpdate('%s', NULL, NULL, NULL);", zoneName);
     
@@ -165,6 +212,19 @@ ZoneServer::ZoneServer(int8* zoneName)
     MessageLib::Init();
     ObjectFactory::Init(mDatabase);
 
+    // ids for objects created in memory come from blocks leased by all zones,
+    // the base has to be above every id the db hands out itself
+    uint64 objectIdLeaseBase = 0x0000100000000000ULL;
+    if(gConfig->keyExists("ObjectIdLeaseBase"))
+        objectIdLeaseBase = gConfig->read<uint64>("ObjectIdLeaseBase");
+
+    if(!gObjectFactory->startIdLease(zoneId,objectIdLeaseBase))
+    {
+        LOG(ERROR) << "Unable to lease object ids for [" << zoneName << "]";
+
+        abort();
+    }
+
 	//attribute commands for food buffs
     FoodCommandMapClass::Init();
 
@@ -209,6 +269,20 @@ ZoneServer::ZoneServer(int8* zoneName)
 
     ScriptEngine::Init();
 
+    // a script resume running over these gets yielded until the next frame (instructions, ms),
+    // one that runs longer than the kill time without waiting is stopped (ms)
+    uint32 scriptInstructionBudget = 1000000;
+    uint32 scriptTimeBudget = 10;
+    uint32 scriptKillTime = 1000;
+    if(gConfig->keyExists("ScriptInstructionBudget"))
+        scriptInstructionBudget = gConfig->read<uint32>("ScriptInstructionBudget");
+    if(gConfig->keyExists("ScriptTimeBudget"))
+        scriptTimeBudget = gConfig->read<uint32>("ScriptTimeBudget");
+    if(gConfig->keyExists("ScriptKillTime"))
+        scriptKillTime = gConfig->read<uint32>("ScriptKillTime");
+
+    gScriptEngine->setBudgets(scriptInstructionBudget,scriptTimeBudget,scriptKillTime);
+
     mCharacterLoginHandler = new CharacterLoginHandler(mDatabase,mMessageDispatch);
 
     mObjectControllerDispatch = new ObjectControllerDispatch(mDatabase,mMessageDispatch);
@@ -230,6 +304,10 @@ ZoneServer::~ZoneServer(void)
     delete mObjectControllerDispatch;
     AdminManager::deleteManager();
 
+    // write the harvesters up to now before the world goes away
+    if(gStructureManager)
+        gStructureManager->Shutdown();
+
     gWorldManager->Shutdown();	// Should be closed before script engine and script support, due to halting of scripts.
     gScriptEngine->shutdown();
     ScriptSupport::Instance()->destroyInstance();
@@ -269,6 +347,9 @@ void ZoneServer::handleWMReady()
     _updateDBServerList(2);
     LOG(WARNING) << "ZoneServer startup complete";
 
+    // everything static is loaded now, share it with the zones started after us
+    mDatabase->saveStaticDataImage();
+
     // Connect to the ConnectionServer;
     _connectToConnectionServer();
 }
@@ -278,26 +359,116 @@ void ZoneServer::handleWMReady()
 void ZoneServer::Process(void)
 {
     uint64_t current_timestep = Anh_Utils::Clock::getSingleton()->getGlobalTime();
+
+    gTickProfiler->beginTick();
+
     // Process our game modules
-    mObjectControllerDispatch->Process();
-    gWorldManager->Process();
-    gScriptEngine->process();
-    mMessageDispatch->Process();
-    gEventDispatcher.Tick(current_timestep);
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_ObjectController]);
+        mObjectControllerDispatch->Process();
+    }
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_World]);
+        gWorldManager->Process();
+    }
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_Script]);
+        gScriptEngine->process();
+    }
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_MessageDispatch]);
+        mMessageDispatch->Process();
+    }
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_Events]);
+        gEventDispatcher.Tick(current_timestep);
+    }
+    {
+        // everything marked dirty this tick goes out as one delta per object and page
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_Deltas]);
+        gMessageLib->sendDeltas();
+    }
 
     //is there stalling ?
-    mRouterService->Process();
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_Router]);
+        mRouterService->Process();
+    }
 
     //  Process our core services
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_Database]);
+        gObjectFactory->process();
+        mDatabaseManager->process();
+    }
+    {
+        Anh_Utils::ProfileScope scope(mTickPhases[ZoneTickPhase_Network]);
+        mNetworkManager->Process();
+    }
 
-    mDatabaseManager->process();
-    mNetworkManager->Process();
+    if(gTickProfiler->endTick())
+    {
+        std::ostringstream slowTick;
+        gTickProfiler->printSlowTick(slowTick, gTickProfiler->getSlowTicks().back());
+        LOG(WARNING) << slowTick.str();
+    }
 
     // Heartbeat once in awhile
     if (Anh_Utils::Clock::getSingleton()->getLocalTime() - mLastHeartbeat > 180000)
     {
         mLastHeartbeat = static_cast<uint32>(Anh_Utils::Clock::getSingleton()->getLocalTime());
+
+        // dump the timings of the last interval
+        std::ostringstream report;
+        gTickProfiler->printReport(report);
+        LOG(INFO) << "Tick profile:" << std::endl << report.str();
+
+        std::ostringstream npcQueues;
+        gWorldManager->printNpcQueueStats(npcQueues);
+        LOG(INFO) << "Npc queues:" << std::endl << npcQueues.str();
+
+        std::ostringstream scripts;
+        gScriptEngine->printProfile(scripts);
+        LOG(INFO) << "Script profile:" << std::endl << scripts.str();
+
+        gTickProfiler->resetHistograms();
+        gWorldManager->resetNpcQueueStats();
+        gScriptEngine->resetProfile();
+
+        // static data loaded on demand after startup
+        mDatabase->saveStaticDataImage();
+    }
+}
+
+//======================================================================================================================
+
+uint64 ZoneServer::getIdleTime(void)
+{
+    if(!gWorldManager)
+        return(mMaxIdleTime);
+
+    uint64 now		= Anh_Utils::Clock::getSingleton()->getLocalTime();
+    uint64 deadline = std::min(gWorldManager->getNextDeadline(),gScriptEngine->getNextDeadline());
+
+    if(deadline <= now)
+        return(0);
+
+    uint64 idleTime = std::min<uint64>(deadline - now,mMaxIdleTime);
+
+    // the event dispatcher runs on global time
+    uint64 eventDeadline = gEventDispatcher.NextDeadline();
+
+    if(eventDeadline != EventDispatcher::kNoDeadline)
+    {
+        uint64 globalNow = Anh_Utils::Clock::getSingleton()->getGlobalTime();
+
+        if(eventDeadline <= globalNow)
+            return(0);
+
+        idleTime = std::min<uint64>(eventDeadline - globalNow,idleTime);
     }
+
+    return(idleTime);
 }
 
 //======================================================================================================================
@@ -426,8 +597,8 @@ int main(int argc, char* argv[])
         gZoneServer->Process();
         gMessageFactory->Process(); //Garbage Collection
 
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
-
+        // sleep until the next scheduler deadline or until network / database work comes in
+        gEventLoop->wait(gZoneServer->getIdleTime());
     }
 
     // Shut things down
@@ -435,6 +606,9 @@ int main(int argc, char* argv[])
     delete gZoneServer;
     gZoneServer = NULL;
 
+    Anh_Utils::EventLoop::destroySingleton();
+    Anh_Utils::TickProfiler::destroySingleton();
+
     return 0;
 }
 
@@ -52,6 +52,24 @@ class HamService;
 
 //======================================================================================================================
 
+// the parts of a zone tick that get their own TickProfiler section
+enum ZoneTickPhase
+{
+    ZoneTickPhase_ObjectController	= 0,
+    ZoneTickPhase_World				= 1,
+    ZoneTickPhase_Script			= 2,
+    ZoneTickPhase_MessageDispatch	= 3,
+    ZoneTickPhase_Events			= 4,
+    ZoneTickPhase_Deltas			= 5,
+    ZoneTickPhase_Router			= 6,
+    ZoneTickPhase_Database			= 7,
+    ZoneTickPhase_Network			= 8,
+
+    ZoneTickPhase_Count				= 9
+};
+
+//======================================================================================================================
+
 class ProcessAddress
 {
 public:
@@ -74,6 +92,9 @@ public:
 
     void	Process(void);
 
+    // how long the main loop may sleep before something is due
+    uint64	getIdleTime(void);
+
     void	handleWMReady();
 
     BString  getZoneName()  {
@@ -91,6 +112,7 @@ private:
 
     BString                        mZoneName;
     uint32						  mLastHeartbeat;
+    uint32						  mMaxIdleTime;
 
     NetworkManager*               mNetworkManager;
     DatabaseManager*              mDatabaseManager;
@@ -103,6 +125,8 @@ private:
     ObjectControllerDispatch*     mObjectControllerDispatch;
 
     std::unique_ptr<zone::HamService>   ham_service_;
+
+    uint32						  mTickPhases[ZoneTickPhase_Count];
 };
 
 //======================================================================================================================
@@ -0,0 +1,120 @@
+// Copyright (c) 2010 ApathyStudios. All rights reserved.
+// Use of this source code is governed by a GPL-style license that can be
+// found in the COPYING file.
+
+#include "ZoneServer/HamRegenerator.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <gtest/gtest.h>
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+TEST(HamRegeneratorTests, RegenerateColumnAddsRateBelowMax) {
+    int32 current[] = { 100, 250 };
+    int32 maximum[] = { 500, 500 };
+    int32 rate[]    = { 10, 25 };
+    int32 next[2];
+
+    HamRegenerator::regenerateColumn(current, maximum, rate, next, 2);
+
+    EXPECT_EQ(110, next[0]);
+    EXPECT_EQ(275, next[1]);
+}
+
+TEST(HamRegeneratorTests, RegenerateColumnCapsAtMax) {
+    int32 current[] = { 495 };
+    int32 maximum[] = { 500 };
+    int32 rate[]    = { 10 };
+    int32 next[1];
+
+    HamRegenerator::regenerateColumn(current, maximum, rate, next, 1);
+
+    EXPECT_EQ(500, next[0]);
+}
+
+TEST(HamRegeneratorTests, RegenerateColumnLeavesFullAndOverfullPoolsAlone) {
+    // An overfull pool (buffed max that ran out) must not be pulled down to max.
+    int32 current[] = { 500, 600 };
+    int32 maximum[] = { 500, 500 };
+    int32 rate[]    = { 10, 10 };
+    int32 next[2];
+
+    HamRegenerator::regenerateColumn(current, maximum, rate, next, 2);
+
+    EXPECT_EQ(500, next[0]);
+    EXPECT_EQ(600, next[1]);
+}
+
+// One pool of a creature as the per creature regen task walked them.
+struct RegenPool {
+    int32 current;
+    int32 maximum;
+    int32 rate;
+};
+
+// One regen tick of the four pools of 5000 regenerating creatures, column
+// pass against walking the pools creature by creature.
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST(HamRegeneratorTests, DISABLED_BenchmarkRegenerationPass) {
+    const uint32_t creatures = 5000;
+    const uint32_t pools = 4;
+    const uint32_t ticks = 2000;
+
+    srand(7);
+
+    std::vector<RegenPool> rows(creatures * pools);
+    std::vector<int32> current(creatures * pools), maximum(creatures * pools), rate(creatures * pools), next(creatures * pools);
+
+    for (uint32_t i = 0; i < rows.size(); ++i) {
+        // Mostly far from max, so every tick has work to do.
+        rows[i].maximum = 2000 + rand() % 8000;
+        rows[i].current = rand() % 1000;
+        rows[i].rate    = 1 + rand() % 5;
+
+        // Column layout, one column per pool like HamRegenerator keeps them.
+        uint32_t column = (i % pools) * creatures + i / pools;
+        current[column] = rows[i].current;
+        maximum[column] = rows[i].maximum;
+        rate[column]    = rows[i].rate;
+    }
+
+    boost::posix_time::ptime row_start = boost::posix_time::microsec_clock::universal_time();
+    for (uint32_t t = 0; t < ticks; ++t) {
+        for (uint32_t i = 0; i < rows.size(); ++i) {
+            RegenPool& pool = rows[i];
+            if (pool.current < pool.maximum) {
+                pool.current += pool.rate;
+                if (pool.current > pool.maximum) {
+                    pool.current = pool.maximum;
+                }
+            }
+        }
+    }
+    boost::posix_time::ptime row_end = boost::posix_time::microsec_clock::universal_time();
+
+    boost::posix_time::ptime column_start = boost::posix_time::microsec_clock::universal_time();
+    for (uint32_t t = 0; t < ticks; ++t) {
+        for (uint32_t pool = 0; pool < pools; ++pool) {
+            HamRegenerator::regenerateColumn(&current[pool * creatures], &maximum[pool * creatures], &rate[pool * creatures], &next[pool * creatures], creatures);
+        }
+        current.swap(next);
+    }
+    boost::posix_time::ptime column_end = boost::posix_time::microsec_clock::universal_time();
+
+    // Both passes have to end up with the same pools.
+    for (uint32_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(rows[i].current, current[(i % pools) * creatures + i / pools]);
+    }
+
+    std::cout << creatures << " creatures: "
+              << (row_end - row_start).total_microseconds() / static_cast<double>(ticks) << " us/tick per creature, "
+              << (column_end - column_start).total_microseconds() / static_cast<double>(ticks) << " us/tick column pass" << std::endl;
+}
+
+}  // namespace
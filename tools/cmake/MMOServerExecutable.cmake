@@ -9,6 +9,7 @@
 #                        MMOSERVER_DEPS [ARGS] [args1...]           # Dependencies on other MMOServer projects
 #                        ADDITIONAL_INCLUDE_DIRS [ARGS] [args1...]  # Additional directories to search for includes
 #                        ADDITIONAL_SOURCE_DIRS [ARGS] [args1...]   # Additional directories to search for files to include in the project
+#                        UNIT_TEST_SOURCES [ARGS] [args1...]        # Sources of the executable its unit tests are built with
 #                        DEBUG_LIBRARIES [ARGS] [args1....]         # Additional debug libraries to link the project against
 #                        OPTIMIZED_LIBRARIES [ARGS] [args1...])     # Additional optimized libraries to link the project against
 #
@@ -39,6 +40,8 @@
 #         ${TOLUAPP_INCLUDE_DIR}
 #     ADDITIONAL_SOURCE_DIRS
 #         ${CMAKE_CURRENT_SOURCE_DIR}/objects
+#     UNIT_TEST_SOURCES
+#         ${CMAKE_CURRENT_SOURCE_DIR}/HamRegenerator.h
 #     DEBUG_LIBRARIES 
 #         ${LUA_LIBRARY_DEBUG}
 #         ${NOISE_LIBRARY_DEBUG}
@@ -51,11 +54,16 @@
 #         ${TOLUAPP_LIBRARY_RELEASE}
 # )
 #
+# Unit tests (*_unittest.cc / *_unittest.cpp) are left out of the executable.
+# An executable can't be linked against, so they are built into ${name}Tests
+# together with the UNIT_TEST_SOURCES, which should be the parts of the
+# executable that stand on their own.
+#
 
 INCLUDE(CMakeMacroParseArguments)
 
 FUNCTION(AddMMOServerExecutable name)
-    PARSE_ARGUMENTS(MMOSERVERLIB "MMOSERVER_DEPS;ADDITIONAL_INCLUDE_DIRS;ADDITIONAL_SOURCE_DIRS;DEBUG_LIBRARIES;OPTIMIZED_LIBRARIES" "" ${ARGN})
+    PARSE_ARGUMENTS(MMOSERVERLIB "MMOSERVER_DEPS;ADDITIONAL_INCLUDE_DIRS;ADDITIONAL_SOURCE_DIRS;UNIT_TEST_SOURCES;DEBUG_LIBRARIES;OPTIMIZED_LIBRARIES" "" ${ARGN})
     
     # Get information about the data passed in, helpful for checking if a value
     # has been set or not.
@@ -68,17 +76,25 @@ FUNCTION(AddMMOServerExecutable name)
     # Load up all of the source and header files for the project.
     FILE(GLOB SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/*.cc ${CMAKE_CURRENT_SOURCE_DIR}/*.cpp)   
     FILE(GLOB HEADERS ${CMAKE_CURRENT_SOURCE_DIR}/*.h)       
+    FILE(GLOB TEST_SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/*_unittest.cc ${CMAKE_CURRENT_SOURCE_DIR}/*_unittest.cpp)
     
     IF(_sources_list_length GREATER 0)
         FOREACH(_source_dir ${MMOSERVERLIB_ADDITIONAL_SOURCE_DIRS})
             FILE(GLOB ADDITIONAL_SOURCES ${_source_dir}/*.cc ${_source_dir}/*.cpp)
             FILE(GLOB ADDITIONAL_HEADERS ${_source_dir}/*.h)
+            FILE(GLOB ADDITIONAL_TEST_SOURCES ${_source_dir}/*_unittest.cc ${_source_dir}/*_unittest.cpp)
             
             LIST(APPEND SOURCES ${ADDITIONAL_SOURCES})
             LIST(APPEND HEADERS ${ADDITIONAL_HEADERS})
+            LIST(APPEND TEST_SOURCES ${ADDITIONAL_TEST_SOURCES})
         ENDFOREACH()
     ENDIF()
     
+    LIST(LENGTH TEST_SOURCES _tests_list_length)    
+    IF(_tests_list_length GREATER 0)
+        LIST(REMOVE_ITEM SOURCES ${TEST_SOURCES}) # Remove the unit tests from the sources list.        
+    ENDIF()
+    
     IF(_includes_list_length GREATER 0)
         INCLUDE_DIRECTORIES(${MMOSERVERLIB_ADDITIONAL_INCLUDE_DIRS})
     ENDIF()
@@ -128,6 +144,57 @@ FUNCTION(AddMMOServerExecutable name)
         INSTALL(TARGETS ${name} RUNTIME DESTINATION bin)
     ENDIF()
     
+    IF(_tests_list_length GREATER 0)
+        # Create an executable for the tests, built from the tested sources and linked like the executable
+        INCLUDE_DIRECTORIES(${GTEST_INCLUDE_DIRS})
+        ADD_EXECUTABLE(${name}Tests ${TEST_SOURCES} ${MMOSERVERLIB_UNIT_TEST_SOURCES})
+        TARGET_LINK_LIBRARIES(${name}Tests 
+            ${MMOSERVERLIB_MMOSERVER_DEPS}
+            NetworkManager
+            DatabaseManager
+            Common
+            Utils
+            ${GTEST_BOTH_LIBRARIES}
+            debug ${Boost_DATE_TIME_LIBRARY_DEBUG}
+            debug ${Boost_REGEX_LIBRARY_DEBUG}
+            debug ${Boost_SYSTEM_LIBRARY_DEBUG}
+            debug ${Boost_THREAD_LIBRARY_DEBUG}
+            debug ${GLOG_LIBRARY_DEBUG}
+            debug ${MysqlConnectorCpp_LIBRARY_DEBUG}
+            debug ${TBB_LIBRARY_DEBUG}
+            debug ${TBB_MALLOC_LIBRARY_DEBUG}      
+            debug ${ZLIB_LIBRARY_DEBUG}        
+            optimized ${Boost_DATE_TIME_LIBRARY_RELEASE}
+            optimized ${Boost_REGEX_LIBRARY_RELEASE}
+            optimized ${Boost_SYSTEM_LIBRARY_RELEASE}
+            optimized ${Boost_THREAD_LIBRARY_RELEASE}
+            optimized ${GLOG_LIBRARY_RELEASE}
+            optimized ${MysqlConnectorCpp_LIBRARY_RELEASE}
+            optimized ${TBB_LIBRARY}
+            optimized ${TBB_MALLOC_LIBRARY}
+            optimized ${ZLIB_LIBRARY_RELEASE})
+        
+        IF(_debug_list_length GREATER 0)
+            TARGET_LINK_LIBRARIES(${name}Tests debug ${MMOSERVERLIB_DEBUG_LIBRARIES})
+        ENDIF()
+    
+        IF(_optimized_list_length GREATER 0)
+            TARGET_LINK_LIBRARIES(${name}Tests optimized ${MMOSERVERLIB_OPTIMIZED_LIBRARIES})
+        ENDIF()
+        
+        IF(WIN32)
+            SET_TARGET_PROPERTIES(${name}Tests PROPERTIES RUNTIME_OUTPUT_DIRECTORY "${PROJECT_BINARY_DIR}/bin/${CMAKE_BUILD_TYPE}")
+            SET_TARGET_PROPERTIES(${name}Tests PROPERTIES LINK_FLAGS "/NODEFAULTLIB:LIBCMT")
+            TARGET_LINK_LIBRARIES(${name}Tests "winmm.lib" "ws2_32.lib")
+    	ENDIF()
+        
+        GTEST_ADD_TESTS(${name}Tests "" ${TEST_SOURCES})
+      
+        IF(ENABLE_TEST_REPORT)
+            ADD_TEST(NAME All${name}Tests COMMAND ${name}Tests "--gtest_output=xml:${PROJECT_BINARY_DIR}/$<CONFIGURATION>/")
+        ENDIF()
+    ENDIF()
+    
     TARGET_LINK_LIBRARIES(${name}    
         NetworkManager
         DatabaseManager